@@ -0,0 +1,76 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     bench_ambi_bin.c
+ * Description:
+ *     Benchmark sweep of ambi_bin over the input orders 1..BENCH_MAX_SH_ORDER, and of head
+ *     tracking (the rotation changing every frame) at the highest order.
+ * Dependencies:
+ *     saf_bench, ambi_bin
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include "saf_bench.h"
+#include "ambi_bin.h"
+
+static void bench_ambi_bin_process(void* hMod, float** inputs, float** outputs, int nInputs, int nOutputs)
+{
+    ambi_bin_process(hMod, inputs, outputs, nInputs, nOutputs, FRAME_SIZE, 1);
+}
+
+/* head tracking: the rotation changes every frame */
+static void bench_ambi_bin_automate(void* hMod, int frame)
+{
+    ambi_bin_setYaw(hMod, (float)((3*frame)%360) - 180.0f);
+    ambi_bin_setPitch(hMod, (float)(frame%60) - 30.0f);
+    ambi_bin_setRoll(hMod, (float)(frame%20) - 10.0f);
+}
+
+void bench_ambi_bin(void)
+{
+    void* hAmbi;
+    bench_case bc;
+    int order;
+
+    for(order=1; order<=BENCH_MAX_SH_ORDER; order++){
+        ambi_bin_create(&hAmbi);
+        ambi_bin_init(hAmbi, BENCH_SAMPLERATE);
+        ambi_bin_setInputOrderPreset(hAmbi, (INPUT_ORDERS)(order+1));
+        ambi_bin_setYaw(hAmbi, 30.0f);
+        ambi_bin_waitForCodecInit(hAmbi);
+        bc.module = "ambi_bin";
+        bc.order = order;
+        bc.nInputs = (order+1)*(order+1);
+        bc.nOutputs = 2;
+        bc.automation = NULL;
+        bench_run(&bc, hAmbi, bench_ambi_bin_process, NULL);
+        ambi_bin_destroy(&hAmbi);
+    }
+
+    /* head tracking */
+    ambi_bin_create(&hAmbi);
+    ambi_bin_init(hAmbi, BENCH_SAMPLERATE);
+    ambi_bin_setInputOrderPreset(hAmbi, (INPUT_ORDERS)(BENCH_MAX_SH_ORDER+1));
+    ambi_bin_waitForCodecInit(hAmbi);
+    bc.module = "ambi_bin";
+    bc.order = BENCH_MAX_SH_ORDER;
+    bc.nInputs = (BENCH_MAX_SH_ORDER+1)*(BENCH_MAX_SH_ORDER+1);
+    bc.nOutputs = 2;
+    bc.automation = "rotation changed every frame";
+    bench_run(&bc, hAmbi, bench_ambi_bin_process, bench_ambi_bin_automate);
+    ambi_bin_destroy(&hAmbi);
+}
@@ -0,0 +1,82 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     bench_ambi_dec.c
+ * Description:
+ *     Benchmark sweep of ambi_dec over the decoding orders 1..BENCH_MAX_SH_ORDER and the
+ *     t-design loudspeaker layouts (4..60 loudspeakers), and of switching the decoding order
+ *     (the decoder being rebuilt on the worker thread) whilst decoding to 24 loudspeakers.
+ * Dependencies:
+ *     saf_bench, ambi_dec
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include "saf_bench.h"
+#include "ambi_dec.h"
+
+static void bench_ambi_dec_process(void* hMod, float** inputs, float** outputs, int nInputs, int nOutputs)
+{
+    ambi_dec_process(hMod, inputs, outputs, nInputs, nOutputs, FRAME_SIZE, 1);
+}
+
+/* the decoding order is switched between 1 and BENCH_MAX_SH_ORDER every 25 frames */
+static void bench_ambi_dec_automate(void* hMod, int frame)
+{
+    if(frame%25==0)
+        ambi_dec_setDecOrderAllBands(hMod, (frame/25)%2 ? BENCH_MAX_SH_ORDER : 1);
+}
+
+void bench_ambi_dec(void)
+{
+    const int layouts[] = { PRESET_T_DESIGN_4, PRESET_T_DESIGN_12, PRESET_T_DESIGN_24,
+                            PRESET_T_DESIGN_36, PRESET_T_DESIGN_48, PRESET_T_DESIGN_60 };
+    const int nLoudspeakers[] = { 4, 12, 24, 36, 48, 60 }; /* (applied on the first frame) */
+    void* hAmbi;
+    bench_case bc;
+    int order, i;
+
+    for(order=1; order<=BENCH_MAX_SH_ORDER; order++){
+        for(i=0; i<(int)(sizeof(layouts)/sizeof(layouts[0])); i++){
+            ambi_dec_create(&hAmbi);
+            ambi_dec_init(hAmbi, BENCH_SAMPLERATE);
+            ambi_dec_setOutputConfigPreset(hAmbi, layouts[i]);
+            ambi_dec_setDecOrderAllBands(hAmbi, order);
+            ambi_dec_waitForCodecInit(hAmbi);
+            bc.module = "ambi_dec";
+            bc.order = order;
+            bc.nInputs = (order+1)*(order+1);
+            bc.nOutputs = nLoudspeakers[i];
+            bc.automation = NULL;
+            bench_run(&bc, hAmbi, bench_ambi_dec_process, NULL);
+            ambi_dec_destroy(&hAmbi);
+        }
+    }
+
+    /* switching the decoding order */
+    ambi_dec_create(&hAmbi);
+    ambi_dec_init(hAmbi, BENCH_SAMPLERATE);
+    ambi_dec_setOutputConfigPreset(hAmbi, PRESET_T_DESIGN_24);
+    ambi_dec_setDecOrderAllBands(hAmbi, BENCH_MAX_SH_ORDER);
+    ambi_dec_waitForCodecInit(hAmbi);
+    bc.module = "ambi_dec";
+    bc.order = BENCH_MAX_SH_ORDER;
+    bc.nInputs = (BENCH_MAX_SH_ORDER+1)*(BENCH_MAX_SH_ORDER+1);
+    bc.nOutputs = 24;
+    bc.automation = "decoding order switched every 25 frames";
+    bench_run(&bc, hAmbi, bench_ambi_dec_process, bench_ambi_dec_automate);
+    ambi_dec_destroy(&hAmbi);
+}
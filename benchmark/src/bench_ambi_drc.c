@@ -0,0 +1,73 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     bench_ambi_drc.c
+ * Description:
+ *     Benchmark sweep of ambi_drc over the input orders 1..BENCH_MAX_SH_ORDER, and of the
+ *     threshold and ratio changing every frame at the highest order.
+ * Dependencies:
+ *     saf_bench, ambi_drc
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include "saf_bench.h"
+#include "ambi_drc.h"
+
+static void bench_ambi_drc_process(void* hMod, float** inputs, float** outputs, int nInputs, int nOutputs)
+{
+    ambi_drc_process(hMod, inputs, outputs, nInputs, FRAME_SIZE, 1);
+}
+
+/* the threshold and ratio change every frame */
+static void bench_ambi_drc_automate(void* hMod, int frame)
+{
+    ambi_drc_setThreshold(hMod, -40.0f + (float)(frame%30));
+    ambi_drc_setRatio(hMod, 2.0f + (float)(frame%8));
+}
+
+void bench_ambi_drc(void)
+{
+    void* hAmbi;
+    bench_case bc;
+    int order;
+
+    for(order=1; order<=BENCH_MAX_SH_ORDER; order++){
+        ambi_drc_create(&hAmbi);
+        ambi_drc_init(hAmbi, BENCH_SAMPLERATE);
+        ambi_drc_setInputPreset(hAmbi, (INPUT_ORDER)(order+1));
+        ambi_drc_setThreshold(hAmbi, -30.0f);
+        ambi_drc_waitForInit(hAmbi);
+        bc.module = "ambi_drc";
+        bc.order = order;
+        bc.nInputs = bc.nOutputs = (order+1)*(order+1);
+        bc.automation = NULL;
+        bench_run(&bc, hAmbi, bench_ambi_drc_process, NULL);
+        ambi_drc_destroy(&hAmbi);
+    }
+
+    /* changing threshold and ratio */
+    ambi_drc_create(&hAmbi);
+    ambi_drc_init(hAmbi, BENCH_SAMPLERATE);
+    ambi_drc_setInputPreset(hAmbi, (INPUT_ORDER)(BENCH_MAX_SH_ORDER+1));
+    ambi_drc_waitForInit(hAmbi);
+    bc.module = "ambi_drc";
+    bc.order = BENCH_MAX_SH_ORDER;
+    bc.nInputs = bc.nOutputs = (BENCH_MAX_SH_ORDER+1)*(BENCH_MAX_SH_ORDER+1);
+    bc.automation = "threshold and ratio changed every frame";
+    bench_run(&bc, hAmbi, bench_ambi_drc_process, bench_ambi_drc_automate);
+    ambi_drc_destroy(&hAmbi);
+}
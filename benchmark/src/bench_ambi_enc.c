@@ -0,0 +1,80 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     bench_ambi_enc.c
+ * Description:
+ *     Benchmark sweep of ambi_enc over the output orders 1..BENCH_MAX_SH_ORDER and the
+ *     number of sources (1..64), and of 16 sources moving every frame at the highest order.
+ * Dependencies:
+ *     saf_bench, ambi_enc
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include "saf_bench.h"
+#include "ambi_enc.h"
+
+static void bench_ambi_enc_process(void* hMod, float** inputs, float** outputs, int nInputs, int nOutputs)
+{
+    ambi_enc_process(hMod, inputs, outputs, nInputs, nOutputs, FRAME_SIZE, 1);
+}
+
+/* all sources move every frame */
+static void bench_ambi_enc_automate(void* hMod, int frame)
+{
+    int i;
+
+    for(i=0; i<ambi_enc_getNumSources(hMod); i++){
+        ambi_enc_setSourceAzi_deg(hMod, i, (float)((3*frame + 20*i)%360) - 180.0f);
+        ambi_enc_setSourceElev_deg(hMod, i, (float)((frame + 10*i)%90) - 45.0f);
+    }
+}
+
+void bench_ambi_enc(void)
+{
+    void* hAmbi;
+    bench_case bc;
+    int order, i;
+
+    for(order=1; order<=BENCH_MAX_SH_ORDER; order++){
+        for(i=0; i<BENCH_NUM_CHANNEL_COUNTS && bench_channelCounts[i]<=ambi_enc_getMaxNumSources(); i++){
+            ambi_enc_create(&hAmbi);
+            ambi_enc_init(hAmbi, BENCH_SAMPLERATE);
+            ambi_enc_setOutputOrder(hAmbi, order+1);
+            ambi_enc_setNumSources(hAmbi, bench_channelCounts[i]);
+            bc.module = "ambi_enc";
+            bc.order = order;
+            bc.nInputs = bench_channelCounts[i];
+            bc.nOutputs = (order+1)*(order+1);
+            bc.automation = NULL;
+            bench_run(&bc, hAmbi, bench_ambi_enc_process, NULL);
+            ambi_enc_destroy(&hAmbi);
+        }
+    }
+
+    /* moving sources */
+    ambi_enc_create(&hAmbi);
+    ambi_enc_init(hAmbi, BENCH_SAMPLERATE);
+    ambi_enc_setOutputOrder(hAmbi, BENCH_MAX_SH_ORDER+1);
+    ambi_enc_setNumSources(hAmbi, 16);
+    bc.module = "ambi_enc";
+    bc.order = BENCH_MAX_SH_ORDER;
+    bc.nInputs = 16;
+    bc.nOutputs = (BENCH_MAX_SH_ORDER+1)*(BENCH_MAX_SH_ORDER+1);
+    bc.automation = "sources moved every frame";
+    bench_run(&bc, hAmbi, bench_ambi_enc_process, bench_ambi_enc_automate);
+    ambi_enc_destroy(&hAmbi);
+}
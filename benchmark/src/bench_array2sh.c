@@ -0,0 +1,101 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     bench_array2sh.c
+ * Description:
+ *     Benchmark sweep of array2sh over the microphone array presets available for the
+ *     current SH_ORDER (the encoding order is always SH_ORDER), and of changing the
+ *     regularisation (the encoding matrix being rebuilt on the worker thread, and crossfaded
+ *     to on the audio thread) with the default preset.
+ * Dependencies:
+ *     saf_bench, array2sh
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include "saf_bench.h"
+#include "array2sh.h"
+
+static void bench_array2sh_process(void* hMod, float** inputs, float** outputs, int nInputs, int nOutputs)
+{
+    array2sh_process(hMod, inputs, outputs, nInputs, nOutputs, FRAME_SIZE, 1);
+}
+
+/* the regularisation changes every 25 frames */
+static void bench_array2sh_automate(void* hMod, int frame)
+{
+    if(frame%25==0)
+        array2sh_setRegPar(hMod, (frame/25)%2 ? 10.0f : 15.0f);
+}
+
+void bench_array2sh(void)
+{
+    const int presets[] = { PRESET_DEFAULT
+#ifdef ENABLE_AALTO_HYDROPHONE_PRESET
+                            , PRESET_AALTO_HYDROPHONE
+#endif
+#ifdef ENABLE_SENNHEISER_AMBEO_PRESET
+                            , PRESET_SENNHEISER_AMBEO
+#endif
+#ifdef ENABLE_CORE_SOUND_TETRAMIC_PRESET
+                            , PRESET_CORE_SOUND_TETRAMIC
+#endif
+#ifdef ENABLE_SOUND_FIELD_SPS200_PRESET
+                            , PRESET_SOUND_FIELD_SPS200
+#endif
+#ifdef ENABLE_ZYLIA_1D_PRESET
+                            , PRESET_ZYLIA_1D
+#endif
+#ifdef ENABLE_EIGENMIKE32_PRESET
+                            , PRESET_EIGENMIKE32
+#endif
+#ifdef ENABLE_DTU_MIC_PRESET
+                            , PRESET_DTU_MIC
+#endif
+                          };
+    void* hA2sh;
+    bench_case bc;
+    int i;
+
+    for(i=0; i<(int)(sizeof(presets)/sizeof(presets[0])); i++){
+        array2sh_create(&hA2sh);
+        array2sh_init(hA2sh, BENCH_SAMPLERATE);
+        array2sh_setPreset(hA2sh, presets[i]);
+        array2sh_waitForCodecInit(hA2sh);
+        bc.module = "array2sh";
+        bc.order = SH_ORDER;
+        bc.nInputs = array2sh_getNumSensors(hA2sh);
+        bc.nOutputs = (SH_ORDER+1)*(SH_ORDER+1);
+        bc.automation = NULL;
+        if(bc.nInputs<=BENCH_MAX_NUM_CHANNELS && bc.nOutputs<=BENCH_MAX_NUM_CHANNELS)
+            bench_run(&bc, hA2sh, bench_array2sh_process, NULL);
+        array2sh_destroy(&hA2sh);
+    }
+
+    /* changing regularisation */
+    array2sh_create(&hA2sh);
+    array2sh_init(hA2sh, BENCH_SAMPLERATE);
+    array2sh_setPreset(hA2sh, PRESET_DEFAULT);
+    array2sh_waitForCodecInit(hA2sh);
+    bc.module = "array2sh";
+    bc.order = SH_ORDER;
+    bc.nInputs = array2sh_getNumSensors(hA2sh);
+    bc.nOutputs = (SH_ORDER+1)*(SH_ORDER+1);
+    bc.automation = "regularisation changed every 25 frames";
+    if(bc.nInputs<=BENCH_MAX_NUM_CHANNELS && bc.nOutputs<=BENCH_MAX_NUM_CHANNELS)
+        bench_run(&bc, hA2sh, bench_array2sh_process, bench_array2sh_automate);
+    array2sh_destroy(&hA2sh);
+}
@@ -0,0 +1,87 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     bench_binauraliser.c
+ * Description:
+ *     Benchmark sweep of binauraliser over the number of sources (1..64); first on the calling
+ *     thread only, then with the sources spread over a thread pool ("binauraliser_pool").
+ *     Finally, 8 sources moving every frame (on the calling thread only).
+ * Dependencies:
+ *     saf_bench, binauraliser
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include "saf_bench.h"
+#include "saf.h"
+#include "binauraliser.h"
+
+#define BENCH_BINAURALISER_NUM_THREADS ( 3 )  /* worker threads of the pool (the calling thread takes part as well) */
+
+static void bench_binauraliser_process(void* hMod, float** inputs, float** outputs, int nInputs, int nOutputs)
+{
+    binauraliser_process(hMod, inputs, outputs, nInputs, nOutputs, FRAME_SIZE, 1);
+}
+
+/* all sources move every frame */
+static void bench_binauraliser_automate(void* hMod, int frame)
+{
+    int i;
+
+    for(i=0; i<binauraliser_getNumSources(hMod); i++){
+        binauraliser_setSourceAzi_deg(hMod, i, (float)((3*frame + 45*i)%360) - 180.0f);
+        binauraliser_setSourceElev_deg(hMod, i, (float)((frame + 10*i)%90) - 45.0f);
+    }
+}
+
+void bench_binauraliser(void)
+{
+    void* hBin, *hPool;
+    bench_case bc;
+    int i, usePool;
+
+    saf_pool_create(&hPool, BENCH_BINAURALISER_NUM_THREADS);
+    for(usePool=0; usePool<2; usePool++){
+        for(i=0; i<BENCH_NUM_CHANNEL_COUNTS && bench_channelCounts[i]<=binauraliser_getMaxNumSources(); i++){
+            binauraliser_create(&hBin);
+            binauraliser_init(hBin, BENCH_SAMPLERATE);
+            binauraliser_setNumSources(hBin, bench_channelCounts[i]);
+            binauraliser_setThreadPool(hBin, usePool ? hPool : NULL);
+            binauraliser_waitForCodecInit(hBin);
+            bc.module = usePool ? "binauraliser_pool" : "binauraliser";
+            bc.order = -1;
+            bc.nInputs = bench_channelCounts[i];
+            bc.nOutputs = 2;
+            bc.automation = NULL;
+            bench_run(&bc, hBin, bench_binauraliser_process, NULL);
+            binauraliser_destroy(&hBin);
+        }
+    }
+    saf_pool_destroy(&hPool);
+
+    /* moving sources */
+    binauraliser_create(&hBin);
+    binauraliser_init(hBin, BENCH_SAMPLERATE);
+    binauraliser_setNumSources(hBin, 8);
+    binauraliser_waitForCodecInit(hBin);
+    bc.module = "binauraliser";
+    bc.order = -1;
+    bc.nInputs = 8;
+    bc.nOutputs = 2;
+    bc.automation = "sources moved every frame";
+    bench_run(&bc, hBin, bench_binauraliser_process, bench_binauraliser_automate);
+    binauraliser_destroy(&hBin);
+}
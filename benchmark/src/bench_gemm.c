@@ -0,0 +1,169 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     bench_gemm.c
+ * Description:
+ *     Benchmark of the inlined small-matrix kernels of saf_veclib ("utility_?gemm_small")
+ *     against cblas_?gemm, for square products and for the shapes found in the examples.
+ *     Each record gives the time per product of both; the kernels are timed with run-time
+ *     dimensions, and additionally with constant dimensions for the tiny products of the
+ *     HRTF interpolation and VBAP, which the compiler then fully unrolls.
+ * Dependencies:
+ *     saf_bench, saf_utilities
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include "saf_bench.h"
+#include "saf.h"
+
+#define BENCH_GEMM_MAX_DIM ( 64 )             /* largest M, N and K */
+#define BENCH_GEMM_NUM_TRIALS ( 5 )           /* the fastest of this many trials is reported */
+#define BENCH_GEMM_NUM_MACS ( 4000000 )       /* multiply-adds per trial */
+
+/* M x N x K of the products timed */
+static const int bench_gemm_shapes[][3] = {
+    /* square */
+    { 1, 1, 1 }, { 2, 2, 2 }, { 3, 3, 3 }, { 4, 4, 4 }, { 6, 6, 6 }, { 8, 8, 8 }, { 12, 12, 12 }, { 16, 16, 16 },
+    { 24, 24, 24 }, { 32, 32, 32 }, { 48, 48, 48 }, { 64, 64, 64 },
+    /* HRTF interpolation and VBAP gains */
+    { 1, 1, 3 }, { 1, 2, 3 }, { 1, 1, 2 },
+    /* binaural decoding (NUM_EARS x time slots x nSH), orders 1, 3 and 7 */
+    { 2, 16, 4 }, { 2, 16, 16 }, { 2, 16, 64 },
+    /* loudspeaker decoding (nLoudspeakers x time slots x nSH) */
+    { 8, 16, 4 }, { 22, 16, 16 }, { 64, 16, 64 },
+    /* sector patterns (4 x time slots x nSH) */
+    { 4, 16, 4 }, { 4, 16, 16 }, { 4, 16, 64 }
+};
+
+/* times "nReps" products of one shape, with the kernel (useBLAS=0) or with BLAS (useBLAS=1); returns seconds */
+static double bench_gemm_time(int isComplex, int useBLAS, int M, int N, int K, int nReps, float* A, float* B, float* C)
+{
+    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
+    double t0;
+    int r;
+
+    t0 = bench_now();
+    for(r=0; r<nReps; r++){
+        if(isComplex && useBLAS)
+            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, M, N, K, &calpha,
+                        (float_complex*)A, K, (float_complex*)B, N, &cbeta, (float_complex*)C, N);
+        else if(isComplex)
+            utility_cgemm_small(NO_TRANSPOSE, NO_TRANSPOSE, M, N, K, calpha,
+                                (float_complex*)A, K, (float_complex*)B, N, cbeta, (float_complex*)C, N);
+        else if(useBLAS)
+            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, M, N, K, 1.0f, A, K, B, N, 0.0f, C, N);
+        else
+            utility_sgemm_small(NO_TRANSPOSE, NO_TRANSPOSE, M, N, K, 1.0f, A, K, B, N, 0.0f, C, N);
+    }
+    return bench_now() - t0;
+}
+
+/* as "bench_gemm_time" with useBLAS=0, but with the dimensions as compile-time constants; returns seconds, or -1 if
+ * the shape is not one of those the examples use with constant dimensions */
+static double bench_gemm_timeConst(int isComplex, int M, int N, int K, int nReps, float* A, float* B, float* C)
+{
+    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
+    double t0;
+    int r, shape;
+
+    shape = M==1 && N==1 && K==3 ? 0 : (M==1 && N==2 && K==3 ? 1 : (M==1 && N==1 && K==2 ? 2 : -1));
+    if(shape<0)
+        return -1.0;
+    t0 = bench_now();
+    for(r=0; r<nReps; r++){
+        switch(shape){
+            case 0:
+                if(isComplex)
+                    utility_cgemm_small(NO_TRANSPOSE, NO_TRANSPOSE, 1, 1, 3, calpha, (float_complex*)A, 3,
+                                        (float_complex*)B, 1, cbeta, (float_complex*)C, 1);
+                else
+                    utility_sgemm_small(NO_TRANSPOSE, NO_TRANSPOSE, 1, 1, 3, 1.0f, A, 3, B, 1, 0.0f, C, 1);
+                break;
+            case 1:
+                if(isComplex)
+                    utility_cgemm_small(NO_TRANSPOSE, NO_TRANSPOSE, 1, 2, 3, calpha, (float_complex*)A, 3,
+                                        (float_complex*)B, 2, cbeta, (float_complex*)C, 2);
+                else
+                    utility_sgemm_small(NO_TRANSPOSE, NO_TRANSPOSE, 1, 2, 3, 1.0f, A, 3, B, 2, 0.0f, C, 2);
+                break;
+            case 2:
+                if(isComplex)
+                    utility_cgemm_small(NO_TRANSPOSE, NO_TRANSPOSE, 1, 1, 2, calpha, (float_complex*)A, 2,
+                                        (float_complex*)B, 1, cbeta, (float_complex*)C, 1);
+                else
+                    utility_sgemm_small(NO_TRANSPOSE, NO_TRANSPOSE, 1, 1, 2, 1.0f, A, 2, B, 1, 0.0f, C, 1);
+                break;
+        }
+        /* (the result is fed back into A, so that the products cannot be hoisted out of the loop) */
+        A[r%2] = C[0];
+    }
+    return bench_now() - t0;
+}
+
+void bench_gemm(void)
+{
+    float* A, *B, *C;
+    double t, t_small, t_const, t_blas;
+    int i, s, trial, isComplex, M, N, K, nReps, nShapes;
+
+    /* (complex matrices take twice the floats) */
+    A = (float*)malloc1d(2*BENCH_GEMM_MAX_DIM*BENCH_GEMM_MAX_DIM, sizeof(float));
+    B = (float*)malloc1d(2*BENCH_GEMM_MAX_DIM*BENCH_GEMM_MAX_DIM, sizeof(float));
+    C = (float*)malloc1d(2*BENCH_GEMM_MAX_DIM*BENCH_GEMM_MAX_DIM, sizeof(float));
+    srand(1);
+    for(i=0; i<2*BENCH_GEMM_MAX_DIM*BENCH_GEMM_MAX_DIM; i++){
+        A[i] = (float)rand()/(float)RAND_MAX - 0.5f;
+        B[i] = (float)rand()/(float)RAND_MAX - 0.5f;
+    }
+
+    utility_blasThreadsBegin(); /* as in the real-time code */
+    nShapes = (int)(sizeof(bench_gemm_shapes)/sizeof(bench_gemm_shapes[0]));
+    for(isComplex=0; isComplex<2; isComplex++){
+        for(s=0; s<nShapes; s++){
+            M = bench_gemm_shapes[s][0];
+            N = bench_gemm_shapes[s][1];
+            K = bench_gemm_shapes[s][2];
+            nReps = BENCH_GEMM_NUM_MACS/(M*N*K) > 1 ? BENCH_GEMM_NUM_MACS/(M*N*K) : 1;
+            t_small = t_const = t_blas = 1.0e9;
+            for(trial=0; trial<BENCH_GEMM_NUM_TRIALS; trial++){
+                t = bench_gemm_time(isComplex, 0, M, N, K, nReps, A, B, C);
+                t_small = t < t_small ? t : t_small;
+                t = bench_gemm_timeConst(isComplex, M, N, K, nReps, A, B, C);
+                t_const = t < t_const ? t : t_const;
+                t = bench_gemm_time(isComplex, 1, M, N, K, nReps, A, B, C);
+                t_blas = t < t_blas ? t : t_blas;
+            }
+
+            /* write the record */
+            bench_beginRecord();
+            printf("{\"module\": \"gemm\", \"type\": \"%s\", \"M\": %d, \"N\": %d, \"K\": %d, \"MNK\": %d, ",
+                   isComplex ? "cgemm" : "sgemm", M, N, K, M*N*K);
+            printf("\"nsSmall\": %.2f, ", 1.0e9*t_small/(double)nReps);
+            if(t_const>=0.0)
+                printf("\"nsSmallConst\": %.2f, ", 1.0e9*t_const/(double)nReps);
+            else
+                printf("\"nsSmallConst\": null, ");
+            printf("\"nsBLAS\": %.2f, \"speedup\": %.3f}", 1.0e9*t_blas/(double)nReps, t_blas/t_small);
+            fflush(stdout);
+        }
+    }
+    utility_blasThreadsEnd();
+
+    free(A);
+    free(B);
+    free(C);
+}
@@ -0,0 +1,81 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     bench_mceq.c
+ * Description:
+ *     Benchmark sweep of mceq over the number of channels (1..64), with four peak filters, and
+ *     of switching the number of channels (the TFT being reinitialised on the audio thread).
+ * Dependencies:
+ *     saf_bench, mceq
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include "saf_bench.h"
+#include "mceq.h"
+#include <math.h>
+
+static void bench_mceq_process(void* hMod, float** inputs, float** outputs, int nInputs, int nOutputs)
+{
+    mceq_process(hMod, inputs, outputs, nInputs, nOutputs, FRAME_SIZE, 1);
+}
+
+/* the number of channels is switched between 8 and 16 every 50 frames */
+static void bench_mceq_automate(void* hMod, int frame)
+{
+    if(frame%50==0)
+        mceq_setNumChannels(hMod, (frame/50)%2 ? 8 : 16);
+}
+
+void bench_mceq(void)
+{
+    void* hMEQ;
+    bench_case bc;
+    int i, j;
+
+    for(i=0; i<BENCH_NUM_CHANNEL_COUNTS; i++){
+        mceq_create(&hMEQ);
+        mceq_init(hMEQ, BENCH_SAMPLERATE);
+        mceq_setNumChannels(hMEQ, bench_channelCounts[i]);
+        for(j=0; j<4; j++){
+            mceq_addFilter(hMEQ);
+            mceq_setFc(hMEQ, 125.0f*powf(4.0f, (float)j), j);
+        }
+        mceq_waitForInit(hMEQ);
+        bc.module = "mceq";
+        bc.order = -1;
+        bc.nInputs = bc.nOutputs = bench_channelCounts[i];
+        bc.automation = NULL;
+        bench_run(&bc, hMEQ, bench_mceq_process, NULL);
+        mceq_destroy(&hMEQ);
+    }
+
+    /* switching the number of channels */
+    mceq_create(&hMEQ);
+    mceq_init(hMEQ, BENCH_SAMPLERATE);
+    mceq_setNumChannels(hMEQ, 16);
+    for(j=0; j<4; j++){
+        mceq_addFilter(hMEQ);
+        mceq_setFc(hMEQ, 125.0f*powf(4.0f, (float)j), j);
+    }
+    mceq_waitForInit(hMEQ);
+    bc.module = "mceq";
+    bc.order = -1;
+    bc.nInputs = bc.nOutputs = 16;
+    bc.automation = "number of channels switched every 50 frames";
+    bench_run(&bc, hMEQ, bench_mceq_process, bench_mceq_automate);
+    mceq_destroy(&hMEQ);
+}
@@ -0,0 +1,86 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     bench_panner.c
+ * Description:
+ *     Benchmark sweep of panner over the number of sources (1..64) and the t-design
+ *     loudspeaker layouts (4..60 loudspeakers), and of 8 sources moving every frame over 24
+ *     loudspeakers.
+ * Dependencies:
+ *     saf_bench, panner
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include "saf_bench.h"
+#include "panner.h"
+
+static void bench_panner_process(void* hMod, float** inputs, float** outputs, int nInputs, int nOutputs)
+{
+    panner_process(hMod, inputs, outputs, nInputs, nOutputs, FRAME_SIZE, 1);
+}
+
+/* all sources move every frame */
+static void bench_panner_automate(void* hMod, int frame)
+{
+    int i;
+
+    for(i=0; i<panner_getNumSources(hMod); i++){
+        panner_setSourceAzi_deg(hMod, i, (float)((3*frame + 45*i)%360) - 180.0f);
+        panner_setSourceElev_deg(hMod, i, (float)((frame + 10*i)%90) - 45.0f);
+    }
+}
+
+void bench_panner(void)
+{
+    const int layouts[] = { PRESET_T_DESIGN_4, PRESET_T_DESIGN_12, PRESET_T_DESIGN_24,
+                            PRESET_T_DESIGN_36, PRESET_T_DESIGN_48, PRESET_T_DESIGN_60 };
+    const int nLoudspeakers[] = { 4, 12, 24, 36, 48, 60 };
+    void* hPan;
+    bench_case bc;
+    int i, j;
+
+    for(j=0; j<(int)(sizeof(layouts)/sizeof(layouts[0])); j++){
+        for(i=0; i<BENCH_NUM_CHANNEL_COUNTS && bench_channelCounts[i]<=panner_getMaxNumSources(); i++){
+            panner_create(&hPan);
+            panner_init(hPan, BENCH_SAMPLERATE);
+            panner_setOutputConfigPreset(hPan, layouts[j]);
+            panner_setNumSources(hPan, bench_channelCounts[i]);
+            panner_waitForCodecInit(hPan);
+            bc.module = "panner";
+            bc.order = -1;
+            bc.nInputs = bench_channelCounts[i];
+            bc.nOutputs = nLoudspeakers[j];
+            bc.automation = NULL;
+            bench_run(&bc, hPan, bench_panner_process, NULL);
+            panner_destroy(&hPan);
+        }
+    }
+
+    /* moving sources */
+    panner_create(&hPan);
+    panner_init(hPan, BENCH_SAMPLERATE);
+    panner_setOutputConfigPreset(hPan, PRESET_T_DESIGN_24);
+    panner_setNumSources(hPan, 8);
+    panner_waitForCodecInit(hPan);
+    bc.module = "panner";
+    bc.order = -1;
+    bc.nInputs = 8;
+    bc.nOutputs = 24;
+    bc.automation = "sources moved every frame";
+    bench_run(&bc, hPan, bench_panner_process, bench_panner_automate);
+    panner_destroy(&hPan);
+}
@@ -0,0 +1,74 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     bench_powermap.c
+ * Description:
+ *     Benchmark sweep of powermap over the analysis orders 1..BENCH_MAX_SH_ORDER, and of
+ *     switching the analysis order (the beamformers being rebuilt on the worker thread).
+ * Dependencies:
+ *     saf_bench, powermap
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include "saf_bench.h"
+#include "powermap.h"
+
+static void bench_powermap_analysis(void* hMod, float** inputs, float** outputs, int nInputs, int nOutputs)
+{
+    powermap_analysis(hMod, inputs, nInputs, FRAME_SIZE, 1);
+}
+
+/* the analysis order is switched between 1 and BENCH_MAX_SH_ORDER every 25 frames */
+static void bench_powermap_automate(void* hMod, int frame)
+{
+    if(frame%25==0)
+        powermap_setAnaOrderAllBands(hMod, (frame/25)%2 ? BENCH_MAX_SH_ORDER : 1);
+}
+
+void bench_powermap(void)
+{
+    void* hPm;
+    bench_case bc;
+    int order;
+
+    for(order=1; order<=BENCH_MAX_SH_ORDER; order++){
+        powermap_create(&hPm);
+        powermap_init(hPm, (float)BENCH_SAMPLERATE);
+        powermap_setAnaOrderAllBands(hPm, order);
+        powermap_waitForCodecInit(hPm);
+        bc.module = "powermap";
+        bc.order = order;
+        bc.nInputs = (order+1)*(order+1);
+        bc.nOutputs = 0;
+        bc.automation = NULL;
+        bench_run(&bc, hPm, bench_powermap_analysis, NULL);
+        powermap_destroy(&hPm);
+    }
+
+    /* switching the analysis order */
+    powermap_create(&hPm);
+    powermap_init(hPm, (float)BENCH_SAMPLERATE);
+    powermap_setAnaOrderAllBands(hPm, BENCH_MAX_SH_ORDER);
+    powermap_waitForCodecInit(hPm);
+    bc.module = "powermap";
+    bc.order = BENCH_MAX_SH_ORDER;
+    bc.nInputs = (BENCH_MAX_SH_ORDER+1)*(BENCH_MAX_SH_ORDER+1);
+    bc.nOutputs = 0;
+    bc.automation = "analysis order switched every 25 frames";
+    bench_run(&bc, hPm, bench_powermap_analysis, bench_powermap_automate);
+    powermap_destroy(&hPm);
+}
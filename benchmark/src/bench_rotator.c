@@ -0,0 +1,73 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     bench_rotator.c
+ * Description:
+ *     Benchmark sweep of rotator over the orders 1..BENCH_MAX_SH_ORDER, and of the rotation
+ *     changing every frame at the highest order.
+ * Dependencies:
+ *     saf_bench, rotator
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include "saf_bench.h"
+#include "rotator.h"
+
+static void bench_rotator_process(void* hMod, float** inputs, float** outputs, int nInputs, int nOutputs)
+{
+    rotator_process(hMod, inputs, outputs, nInputs, nOutputs, FRAME_SIZE, 1);
+}
+
+/* the rotation changes every frame */
+static void bench_rotator_automate(void* hMod, int frame)
+{
+    rotator_setYaw(hMod, (float)((3*frame)%360) - 180.0f);
+    rotator_setPitch(hMod, (float)(frame%60) - 30.0f);
+    rotator_setRoll(hMod, (float)(frame%20) - 10.0f);
+}
+
+void bench_rotator(void)
+{
+    void* hRot;
+    bench_case bc;
+    int order;
+
+    for(order=1; order<=BENCH_MAX_SH_ORDER; order++){
+        rotator_create(&hRot);
+        rotator_init(hRot, BENCH_SAMPLERATE);
+        rotator_setOrder(hRot, order+1);
+        rotator_setYaw(hRot, 30.0f);
+        rotator_setPitch(hRot, 10.0f);
+        bc.module = "rotator";
+        bc.order = order;
+        bc.nInputs = bc.nOutputs = (order+1)*(order+1);
+        bc.automation = NULL;
+        bench_run(&bc, hRot, bench_rotator_process, NULL);
+        rotator_destroy(&hRot);
+    }
+
+    /* changing rotation */
+    rotator_create(&hRot);
+    rotator_init(hRot, BENCH_SAMPLERATE);
+    rotator_setOrder(hRot, BENCH_MAX_SH_ORDER+1);
+    bc.module = "rotator";
+    bc.order = BENCH_MAX_SH_ORDER;
+    bc.nInputs = bc.nOutputs = (BENCH_MAX_SH_ORDER+1)*(BENCH_MAX_SH_ORDER+1);
+    bc.automation = "rotation changed every frame";
+    bench_run(&bc, hRot, bench_rotator_process, bench_rotator_automate);
+    rotator_destroy(&hRot);
+}
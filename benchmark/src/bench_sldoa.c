@@ -0,0 +1,74 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     bench_sldoa.c
+ * Description:
+ *     Benchmark sweep of sldoa over the analysis orders 1..BENCH_MAX_SH_ORDER, and of
+ *     switching the analysis order and changing the averaging.
+ * Dependencies:
+ *     saf_bench, sldoa
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include "saf_bench.h"
+#include "sldoa.h"
+
+static void bench_sldoa_analysis(void* hMod, float** inputs, float** outputs, int nInputs, int nOutputs)
+{
+    sldoa_analysis(hMod, inputs, nInputs, FRAME_SIZE, 1);
+}
+
+/* the analysis order is switched between 1 and BENCH_MAX_SH_ORDER every 25 frames, and the averaging changes every
+ * frame */
+static void bench_sldoa_automate(void* hMod, int frame)
+{
+    if(frame%25==0)
+        sldoa_setAnaOrderAllBands(hMod, (frame/25)%2 ? BENCH_MAX_SH_ORDER : 1);
+    sldoa_setAvg(hMod, 100.0f + (float)(10*(frame%50)));
+}
+
+void bench_sldoa(void)
+{
+    void* hSld;
+    bench_case bc;
+    int order;
+
+    for(order=1; order<=BENCH_MAX_SH_ORDER; order++){
+        sldoa_create(&hSld);
+        sldoa_init(hSld, (float)BENCH_SAMPLERATE);
+        sldoa_setAnaOrderAllBands(hSld, order);
+        bc.module = "sldoa";
+        bc.order = order;
+        bc.nInputs = (order+1)*(order+1);
+        bc.nOutputs = 0;
+        bc.automation = NULL;
+        bench_run(&bc, hSld, bench_sldoa_analysis, NULL);
+        sldoa_destroy(&hSld);
+    }
+
+    /* switching the analysis order */
+    sldoa_create(&hSld);
+    sldoa_init(hSld, (float)BENCH_SAMPLERATE);
+    sldoa_setAnaOrderAllBands(hSld, BENCH_MAX_SH_ORDER);
+    bc.module = "sldoa";
+    bc.order = BENCH_MAX_SH_ORDER;
+    bc.nInputs = (BENCH_MAX_SH_ORDER+1)*(BENCH_MAX_SH_ORDER+1);
+    bc.nOutputs = 0;
+    bc.automation = "analysis order switched every 25 frames, averaging changed every frame";
+    bench_run(&bc, hSld, bench_sldoa_analysis, bench_sldoa_automate);
+    sldoa_destroy(&hSld);
+}
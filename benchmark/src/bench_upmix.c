@@ -0,0 +1,65 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     bench_upmix.c
+ * Description:
+ *     Benchmark of upmix (stereo to 5.x; there is nothing to sweep), in steady state and with
+ *     its parameters changing every frame.
+ * Dependencies:
+ *     saf_bench, upmix
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include "saf_bench.h"
+#include "upmix.h"
+
+static void bench_upmix_process(void* hMod, float** inputs, float** outputs, int nInputs, int nOutputs)
+{
+    upmix_process(hMod, inputs, outputs, nInputs, nOutputs, FRAME_SIZE, 1);
+}
+
+/* the parameters change every frame */
+static void bench_upmix_automate(void* hMod, int frame)
+{
+    upmix_setPValueCoeff(hMod, 0.1f*(float)(frame%10));
+    upmix_setScaleDoAwidth(hMod, 1.0f + 0.1f*(float)(frame%10));
+}
+
+void bench_upmix(void)
+{
+    void* hUpmx;
+    bench_case bc;
+
+    upmix_create(&hUpmx);
+    upmix_init(hUpmx, BENCH_SAMPLERATE);
+    upmix_waitForCodecInit(hUpmx);
+    bc.module = "upmix";
+    bc.order = -1;
+    bc.nInputs = 2;
+    bc.nOutputs = 5;
+    bc.automation = NULL;
+    bench_run(&bc, hUpmx, bench_upmix_process, NULL);
+    upmix_destroy(&hUpmx);
+
+    /* changing parameters */
+    upmix_create(&hUpmx);
+    upmix_init(hUpmx, BENCH_SAMPLERATE);
+    upmix_waitForCodecInit(hUpmx);
+    bc.automation = "parameters changed every frame";
+    bench_run(&bc, hUpmx, bench_upmix_process, bench_upmix_automate);
+    upmix_destroy(&hUpmx);
+}
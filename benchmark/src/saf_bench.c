@@ -0,0 +1,197 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     saf_bench.c
+ * Description:
+ *     A standalone benchmark of the processing functions of all examples (see saf_bench.h).
+ *     Usage:
+ *         saf_bench [-module <name>] [-frames <nFrames>] [-warmup <nFrames>]
+ *     For every configuration, the record holds the mean processing time per sample (ns),
+ *     and the mean and worst-case real-time factors (processing time divided by the
+ *     duration of the audio processed; values below 1 are faster than real-time).
+ * Dependencies:
+ *     saf_utilities, all examples
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include "saf_bench.h"
+#include "saf.h"
+#include <string.h>
+#ifdef _WIN32
+  #include <windows.h>
+#elif defined(__APPLE__)
+  #include <mach/mach_time.h>
+#else
+  #include <time.h>
+#endif
+
+const int bench_channelCounts[BENCH_NUM_CHANNEL_COUNTS] = { 1, 2, 4, 8, 16, 32, 64 };
+
+static int bench_nFrames = 200;               /* number of timed frames per configuration */
+static int bench_nWarmupFrames = 20;          /* number of untimed frames run beforehand */
+static int bench_nRecords = 0;                /* number of records written so far */
+
+double bench_now(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (double)count.QuadPart / (double)freq.QuadPart;
+#elif defined(__APPLE__)
+    static mach_timebase_info_data_t tb;
+    if(tb.denom==0)
+        mach_timebase_info(&tb);
+    return (double)mach_absolute_time() * (double)tb.numer / ((double)tb.denom * 1.0e9);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1.0e-9;
+#endif
+}
+
+void bench_beginRecord(void)
+{
+    printf("%s\n    ", bench_nRecords>0 ? "," : "");
+    bench_nRecords++;
+}
+
+void bench_run
+(
+    const bench_case* bc,
+    void* hMod,
+    bench_process process,
+    bench_automate automate
+)
+{
+    float** inputs, **outputs;
+    double t0, t_frame, t_total, t_max, frameDuration;
+    int i, ch, f, nAllocs;
+
+    /* synthetic input: uniform white noise, fixed seed */
+    inputs = (float**)malloc2d(BENCH_MAX_NUM_CHANNELS, FRAME_SIZE, sizeof(float));
+    outputs = (float**)malloc2d(BENCH_MAX_NUM_CHANNELS, FRAME_SIZE, sizeof(float));
+    srand(1);
+    for(ch=0; ch<BENCH_MAX_NUM_CHANNELS; ch++)
+        for(i=0; i<FRAME_SIZE; i++)
+            inputs[ch][i] = 0.5f*((float)rand()/(float)RAND_MAX - 0.5f);
+
+    /* warm-up */
+    for(f=0; f<bench_nWarmupFrames; f++)
+        process(hMod, inputs, outputs, bc->nInputs, bc->nOutputs);
+
+    /* timed frames; everything called within "process" is treated as real-time code */
+#ifdef SAF_ENABLE_RT_ALLOC_CHECK
+    saf_rt_resetNumAllocs();
+#endif
+    t_total = t_max = 0.0;
+    for(f=0; f<bench_nFrames; f++){
+        if(automate!=NULL)
+            automate(hMod, f);
+        t0 = bench_now();
+        SAF_RT_SCOPE_BEGIN;
+        process(hMod, inputs, outputs, bc->nInputs, bc->nOutputs);
+        SAF_RT_SCOPE_END;
+        t_frame = bench_now() - t0;
+        t_total += t_frame;
+        t_max = t_frame > t_max ? t_frame : t_max;
+    }
+#ifdef SAF_ENABLE_RT_ALLOC_CHECK
+    nAllocs = saf_rt_getNumAllocs();
+#else
+    nAllocs = -1;
+#endif
+
+    /* write the record */
+    frameDuration = (double)FRAME_SIZE/(double)BENCH_SAMPLERATE;
+    bench_beginRecord();
+    printf("{\"module\": \"%s\", ", bc->module);
+    if(bc->order>=0)
+        printf("\"order\": %d, ", bc->order);
+    else
+        printf("\"order\": null, ");
+    printf("\"nInputs\": %d, \"nOutputs\": %d, \"frameSize\": %d, \"nFrames\": %d, ",
+           bc->nInputs, bc->nOutputs, FRAME_SIZE, bench_nFrames);
+    if(bc->automation!=NULL)
+        printf("\"automation\": \"%s\", ", bc->automation);
+    else
+        printf("\"automation\": null, ");
+    printf("\"nsPerSample\": %.3f, \"rtf\": %.6f, \"rtfMax\": %.6f, ",
+           1.0e9*t_total/((double)bench_nFrames*(double)FRAME_SIZE),
+           t_total/((double)bench_nFrames*frameDuration), t_max/frameDuration);
+    if(nAllocs>=0)
+        printf("\"allocs\": %d}", nAllocs);
+    else
+        printf("\"allocs\": null}");
+    fflush(stdout);
+
+    free2d((void**)inputs, BENCH_MAX_NUM_CHANNELS);
+    free2d((void**)outputs, BENCH_MAX_NUM_CHANNELS);
+}
+
+static const struct {
+    const char* name;
+    void (*sweep)(void);
+} bench_modules[] = {
+    { "ambi_bin",     bench_ambi_bin },
+    { "ambi_dec",     bench_ambi_dec },
+    { "ambi_drc",     bench_ambi_drc },
+    { "ambi_enc",     bench_ambi_enc },
+    { "array2sh",     bench_array2sh },
+    { "binauraliser", bench_binauraliser },
+    { "mceq",         bench_mceq },
+    { "panner",       bench_panner },
+    { "powermap",     bench_powermap },
+    { "rotator",      bench_rotator },
+    { "sldoa",        bench_sldoa },
+    { "upmix",        bench_upmix },
+    { "gemm",         bench_gemm }
+};
+
+int main(int argc, char** argv)
+{
+    const char* module;
+    int i, nModules;
+
+    /* options */
+    module = NULL;
+    for(i=1; i<argc-1; i+=2){
+        if(strcmp(argv[i], "-module")==0)
+            module = argv[i+1];
+        else if(strcmp(argv[i], "-frames")==0)
+            bench_nFrames = atoi(argv[i+1]) > 1 ? atoi(argv[i+1]) : 1;
+        else if(strcmp(argv[i], "-warmup")==0)
+            bench_nWarmupFrames = atoi(argv[i+1]) > 0 ? atoi(argv[i+1]) : 0;
+        else
+            break;
+    }
+    if(i<argc){
+        fprintf(stderr, "usage: %s [-module <name>] [-frames <nFrames>] [-warmup <nFrames>]\n", argv[0]);
+        return 1;
+    }
+
+    /* run the sweeps */
+    nModules = (int)(sizeof(bench_modules)/sizeof(bench_modules[0]));
+    printf("{\n  \"frameSize\": %d,\n  \"maxOrder\": %d,\n  \"samplerate\": %d,\n  \"results\": [",
+           FRAME_SIZE, BENCH_MAX_SH_ORDER, BENCH_SAMPLERATE);
+    for(i=0; i<nModules; i++)
+        if((module==NULL && bench_modules[i].sweep!=bench_gemm) || (module!=NULL && strcmp(module, bench_modules[i].name)==0))
+            bench_modules[i].sweep();
+    printf("\n  ]\n}\n");
+
+    return 0;
+}
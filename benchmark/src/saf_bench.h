@@ -0,0 +1,122 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     saf_bench.h
+ * Description:
+ *     A standalone benchmark of the processing functions of all examples, which are fed with
+ *     synthetic (noise) input; no host, plug-in wrapper or audio device is involved. Each
+ *     example is swept over the spherical harmonic orders 1..SH_ORDER (up to 7) and/or
+ *     its channel/source counts (1..64), and the results are written to stdout as JSON.
+ *     Since FRAME_SIZE and SH_ORDER are compile-time constants of the framework, sweeping
+ *     the frame size requires one build per FRAME_SIZE, e.g.:
+ *         for N in 128 256 512 1024 2048; do
+ *             cc -O2 -DFRAME_SIZE=$N -DSH_ORDER=7 -DSAF_ENABLE_SOFA_READER \
+ *                -Iframework/include -Iexamples/<name>/include -Iexamples/<name>/src \
+ *                <framework sources> <example sources> benchmark/src/<all sources> \
+ *                <BLAS/LAPACK and netcdf libraries> -o saf_bench_$N
+ *         done
+ *     with the include paths and sources of all examples.
+ *     Besides the steady-state sweeps, each example has at least one configuration in which
+ *     parameters are changed, or sources are moved, between the timed frames (as a host would;
+ *     see "bench_automate"), so that the cost of reacting to them is part of the timing too.
+ *     Building with SAF_ENABLE_RT_ALLOC_CHECK defined additionally reports the number of
+ *     heap operations made during the timed frames.
+ *     Each example is compiled into its own translation unit (bench_<name>.c), since the
+ *     example headers may not be included together.
+ *     "-module gemm" (not part of the default run) instead compares the inlined
+ *     small-matrix kernels of saf_veclib with BLAS over a range of matrix sizes, in
+ *     order to find the crossover that SAF_GEMM_BLAS_THRESHOLD should be set to.
+ * Dependencies:
+ *     saf_utilities, all examples
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#ifndef __SAF_BENCH_H_INCLUDED__
+#define __SAF_BENCH_H_INCLUDED__
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BENCH_SAMPLERATE ( 48000 )            /* sample rate passed to all examples */
+#define BENCH_MAX_SH_ORDER ( SH_ORDER < 7 ? SH_ORDER : 7 ) /* highest order swept */
+#define BENCH_MAX_NUM_CHANNELS ( 64 )         /* maximum number of inputs/outputs of any configuration */
+#define BENCH_NUM_CHANNEL_COUNTS ( 7 )        /* number of entries in "bench_channelCounts" */
+
+/* channel/source counts swept by the examples that support them: 1, 2, 4, ..., 64 */
+extern const int bench_channelCounts[BENCH_NUM_CHANNEL_COUNTS];
+
+/* one configuration of an example */
+typedef struct _bench_case {
+    const char* module;                       /* example name */
+    int order;                                /* spherical harmonic order; -1: not applicable */
+    int nInputs;                              /* number of input channels */
+    int nOutputs;                             /* number of output channels; 0: analysis only */
+    const char* automation;                   /* description of the parameter changes made between the timed frames;
+                                               * NULL: none (steady state) */
+}bench_case;
+
+/* processes one frame of FRAME_SIZE samples; wraps the "_process"/"_analysis" function of an example */
+typedef void (*bench_process)(void* hMod,                    /* example handle */
+                              float** inputs,                /* input channels; nInputs x FRAME_SIZE */
+                              float** outputs,               /* output channels; nOutputs x FRAME_SIZE */
+                              int nInputs,                   /* number of input channels */
+                              int nOutputs);                 /* number of output channels */
+
+/* changes the parameters of an example before one of the timed frames, as a host would (i.e. outside of the timing
+ * and real-time region, which then cover the processing of the change) */
+typedef void (*bench_automate)(void* hMod,                   /* example handle */
+                               int frame);                   /* index of the timed frame about to be processed */
+
+/* returns a monotonic time stamp in seconds */
+double bench_now(void);
+
+/* starts the next JSON record of the "results" array on stdout */
+void bench_beginRecord(void);
+
+/* runs the warm-up frames (which also carry out any pending initialisations), then times the processing of the
+ * given, already configured, example instance and writes one JSON record to stdout */
+void bench_run(const bench_case* bc,          /* configuration being benchmarked */
+               void* hMod,                    /* example handle */
+               bench_process process,         /* frame processing function */
+               bench_automate automate);      /* parameter changes before each timed frame; NULL: none */
+
+/* sweeps of the individual examples (bench_<name>.c) */
+void bench_ambi_bin(void);
+void bench_ambi_dec(void);
+void bench_ambi_drc(void);
+void bench_ambi_enc(void);
+void bench_array2sh(void);
+void bench_binauraliser(void);
+void bench_mceq(void);
+void bench_panner(void);
+void bench_powermap(void);
+void bench_rotator(void);
+void bench_sldoa(void);
+void bench_upmix(void);
+
+/* sweep of the small-matrix kernels of saf_veclib against BLAS (bench_gemm.c) */
+void bench_gemm(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SAF_BENCH_H_INCLUDED__ */
@@ -80,6 +80,49 @@ void ambi_bin_process(void* const hAmbi,                /* ambi_bin handle */
                       int nSamples,                     /* number of samples in 'inputs' matrix */
                       int isPlaying);                   /* flag, 1: if there is signal in the buffers */
 
+/* blocks until the worker thread has finished (re)computing the codec parameters, which are then picked up by the
+ * next call to "ambi_bin_process" (e.g. for offline rendering or benchmarking). Must not be called from the audio
+ * thread */
+void ambi_bin_waitForCodecInit(void* const hAmbi);      /* ambi_bin handle */
+
+    
+/*******************/
+/* Batch Functions */
+/*******************/
+    
+/* A batch holds several instances with the same configuration (e.g. one per listener), which are processed together
+ * by "ambi_bin_processBatch": the binaural decoding matrices are computed once and shared, the time-frequency data of
+ * all instances are interleaved per band, and the work is spread over a thread pool (see "saf_pool_create"). The
+ * configuration (order, HRIRs, normalisation etc.) is taken from the first instance, whereas the rotation may be set
+ * for each instance individually. The codec parameters are those built by the worker thread of the first instance (see
+ * "ambi_bin_waitForCodecInit") */
+    
+/* creates a batch of ambi_bin instances */
+void ambi_bin_createBatch(void** const phBatch,         /* address of ambi_bin batch handle */
+                          int nInstances);              /* number of instances */
+
+/* destroys a batch of ambi_bin instances */
+void ambi_bin_destroyBatch(void** const phBatch);       /* address of ambi_bin batch handle */
+
+/* initialises all instances of a batch */
+void ambi_bin_initBatch(void* const hBatch,             /* ambi_bin batch handle */
+                        int samplerate);                /* host sample rate */
+
+/* returns the ambi_bin handle of one instance of a batch, for the set/get functions; NULL if out of range */
+void* ambi_bin_getBatchInstance(void* const hBatch,     /* ambi_bin batch handle */
+                                int index);             /* instance index */
+
+/* decodes the input spherical harmonic signals of all instances of a batch to binaural; the output of each instance
+ * is the same as "ambi_bin_process" would produce (up to rounding) */
+void ambi_bin_processBatch(void* const hBatch,          /* ambi_bin batch handle */
+                           float*** const inputs,       /* input channels, [nInstances][nInputs][nSamples] */
+                           float*** const outputs,      /* output channels, [nInstances][nOutputs][nSamples] */
+                           int nInputs,                 /* number of channels in each 'inputs' matrix */
+                           int nOutputs,                /* number of channels in each 'outputs' matrix */
+                           int nSamples,                /* number of samples in each 'inputs' matrix */
+                           int isPlaying,               /* flag, 1: if there is signal in the buffers */
+                           void* const hPool);          /* thread pool handle; NULL: calling thread only */
+
     
 /*****************/
 /* Set Functions */
@@ -151,6 +194,13 @@ int ambi_bin_getHRIRlength(void* const hAmbi);
 int ambi_bin_getHRIRsamplerate(void* const hAmbi);
  
 int ambi_bin_getDAWsamplerate(void* const hAmbi);
+
+/* returns the processing delay in samples, introduced by the time-frequency transform and by decoding the previous
+ * frame */
+int ambi_bin_getProcessingDelay(void);
+
+/* returns the profiler handle, for "saf_profiler_getStats" (NULL, unless built with SAF_ENABLE_PROFILER) */
+void* ambi_bin_getProfiler(void* const hAmbi);
     
     
 #ifdef __cplusplus
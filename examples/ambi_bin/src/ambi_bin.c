@@ -34,49 +34,54 @@ void ambi_bin_create
     ambi_bin_data* pData = (ambi_bin_data*)malloc(sizeof(ambi_bin_data));
     if (pData == NULL) { return;/*error*/ }
     *phAmbi = (void*)pData;
+    saf_profiler_create(&(pData->hProf));
     int t, ch, band;
+    userPars* up;
     
-    /* afSTFT stuff */
-    pData->hSTFT = NULL;
-    pData->STFTOutputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, NUM_EARS, sizeof(complexVector));
-    for(t=0; t<TIME_SLOTS; t++) {
-        for(ch=0; ch< NUM_EARS; ch++) {
-            pData->STFTOutputFrameTF[t][ch].re = (float*)calloc(HYBRID_BANDS, sizeof(float));
-            pData->STFTOutputFrameTF[t][ch].im = (float*)calloc(HYBRID_BANDS, sizeof(float));
-        }
+    /* afSTFT stuff; allocated once, for the maximum order (see "ambi_bin_initTFT") */
+    pData->STFTOutputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, NUM_EARS, sizeof(complexVector));
+    for(t=0; t<TIME_SLOTS; t++) {
+        for(ch=0; ch< NUM_EARS; ch++) {
+            pData->STFTOutputFrameTF[t][ch].re = (float*)calloc(HYBRID_BANDS, sizeof(float));
+            pData->STFTOutputFrameTF[t][ch].im = (float*)calloc(HYBRID_BANDS, sizeof(float));
+        }
     }
-    pData->STFTInputFrameTF = NULL;
-    pData->tempHopFrameTD = NULL;
-
-    /* codec data */
-    pData->pars = (codecPars*)malloc(sizeof(codecPars));
-    codecPars* pars = pData->pars; 
-    pars->sofa_filepath = NULL;
-    pars->hrirs = NULL;
-    pars->hrir_dirs_deg = NULL;
-    pars->itds_s = NULL;
-    pars->hrtf_fb = NULL;
+    ambi_bin_initTFT(pData);
+
+    /* codec data; built on the worker thread (once the sampling rate is known, see ambi_bin_init) */
+    pData->pars = NULL;
+    pData->pendingPars = NULL;
+    pData->retiredPars = NULL;
+    pData->sofa_filepath = NULL;
+    pData->new_sofa_filepath = NULL;
+    pData->worker_sofa_filepath = NULL;
+    pData->N_hrir_dirs = pData->hrir_len = pData->hrir_fs = 0;
+    saf_worker_create(&(pData->hWorker), ambi_bin_codecWorker, (void*)pData);
     
     /* flags */
     pData->reInitCodec = 1;
-    pData->reInitTFT = 1;
+    pData->applyFadeIn = 1;
     
     /* default user parameters */
     for(band=0; band<HYBRID_BANDS; band++)
         pData->EQ[band] = 1.0f;
-    pData->useDefaultHRIRsFLAG = 1; /* pars->sofa_filepath must be valid to set this to 0 */
-    pData->chOrdering = CH_ACN;
-    pData->norm = NORM_N3D;
-    pData->rE_WEIGHT = 0;
-    pData->yaw = 0.0f;
-    pData->pitch = 0.0f;
-    pData->roll = 0.0f;
-    pData->bFlipYaw = 0;
-    pData->bFlipPitch = 0;
-    pData->bFlipRoll = 0;
-    ambi_bin_setInputOrderPreset(*phAmbi, INPUT_ORDER_FIRST);
-    pData->nSH = pData->new_nSH;
-    
+    pData->useDefaultHRIRsFLAG = 1; /* pData->sofa_filepath must be valid to set this to 0 */
+    saf_paramBlock_create(&(pData->hUserPars), sizeof(userPars), 2);
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->chOrdering = CH_ACN;
+    up->norm = NORM_N3D;
+    up->rE_WEIGHT = 0;
+    up->enableEQ = 0;
+    up->yaw = 0.0f;
+    up->pitch = 0.0f;
+    up->roll = 0.0f;
+    up->bFlipYaw = 0;
+    up->bFlipPitch = 0;
+    up->bFlipRoll = 0;
+    up->orderSelected = INPUT_ORDER_FIRST; /* (set directly, as the codec is only built once initialised) */
+    up->order = 1;
+    saf_paramBlock_publish(pData->hUserPars);
+    pData->rotationOrder = -1;
 }
 
 void ambi_bin_destroy
@@ -85,18 +90,18 @@ void ambi_bin_destroy
 )
 {
     ambi_bin_data *pData = (ambi_bin_data*)(*phAmbi);
-    codecPars *pars = pData->pars;
+    codecPars *pars, *next;
     int t, ch;
     
     if (pData != NULL) {
-        if(pData->hSTFT!=NULL)
-            afSTFTfree(pData->hSTFT);
+        /* stop the worker thread first (waits for it to finish any initialisation in progress) */
+        saf_worker_destroy(&(pData->hWorker));
+        
+        afSTFTfree(pData->hSTFT);
         for (t = 0; t<TIME_SLOTS; t++) {
-            if(pData->STFTInputFrameTF!=NULL){
-                for (ch = 0; ch< pData->nSH; ch++) {
-                    free(pData->STFTInputFrameTF[t][ch].re);
-                    free(pData->STFTInputFrameTF[t][ch].im);
-                }
+            for (ch = 0; ch< MAX_NUM_SH_SIGNALS; ch++) {
+                free(pData->STFTInputFrameTF[t][ch].re);
+                free(pData->STFTInputFrameTF[t][ch].im);
             }
             for (ch = 0; ch< NUM_EARS; ch++) {
                 free(pData->STFTOutputFrameTF[t][ch].re);
@@ -105,18 +110,21 @@ void ambi_bin_destroy
         }
         free2d((void**)pData->STFTInputFrameTF, TIME_SLOTS);
         free2d((void**)pData->STFTOutputFrameTF, TIME_SLOTS);
-        if(pData->tempHopFrameTD!=NULL)
-            free2d((void**)pData->tempHopFrameTD, MAX(NUM_EARS, pData->nSH));
+        free2d((void**)pData->tempHopFrameTD, MAX(NUM_EARS, MAX_NUM_SH_SIGNALS));
         
-        if(pars->hrtf_fb!= NULL)
-            free(pars->hrtf_fb);
-        if(pars->itds_s!= NULL)
-            free(pars->itds_s);
-        if(pars->hrirs!= NULL)
-            free(pars->hrirs);
-        if(pars->hrir_dirs_deg!= NULL)
-            free(pars->hrir_dirs_deg);
+        ambi_bin_freeCodecPars(&(pData->pars));
+        pars = (codecPars*)pData->pendingPars;
+        ambi_bin_freeCodecPars(&pars);
+        for(pars = (codecPars*)pData->retiredPars; pars!=NULL; pars = next){
+            next = pars->next;
+            ambi_bin_freeCodecPars(&pars);
+        }
+        free(pData->sofa_filepath);
+        free(pData->new_sofa_filepath);
+        free(pData->worker_sofa_filepath);
+        saf_paramBlock_destroy(&(pData->hUserPars));
 
+        saf_profiler_destroy(&(pData->hProf));
         free(pData);
         pData = NULL;
     }
@@ -146,6 +154,9 @@ void ambi_bin_init
     memset(pData->current_M, 0, HYBRID_BANDS*NUM_EARS*MAX_NUM_SH_SIGNALS*sizeof(float_complex));
     memset(pData->prev_M, 0, HYBRID_BANDS*NUM_EARS*MAX_NUM_SH_SIGNALS*sizeof(float_complex));
     memset(pData->prev_SHframeTF, 0, HYBRID_BANDS*MAX_NUM_SH_SIGNALS*TIME_SLOTS*sizeof(float_complex));
+    
+    /* (re)build the codec parameters for this sampling rate */
+    ambi_bin_requestCodecInit(hAmbi);
 }
 
 void ambi_bin_process
@@ -160,162 +171,287 @@ void ambi_bin_process
 )
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    codecPars* pars = pData->pars;
-    int n, t, sample, ch, i, j, band;
-    int o[MAX_SH_ORDER+2];
-    const float_complex calpha = cmplxf(1.0f,0.0f), cbeta = cmplxf(0.0f, 0.0f);
-    float Rxyz[3][3];
-    float_complex M_rot[MAX_NUM_SH_SIGNALS][MAX_NUM_SH_SIGNALS];
+    const userPars* up;
+    codecPars* pars;
+    int ch, i, band, nSH;
     float_complex temp_binframeTF[NUM_EARS][TIME_SLOTS];
-    float* M_rot_tmp;
     
-#ifdef ENABLE_FADE_IN_OUT
-    int applyFadeIn;
-    if(pData->reInitTFT || pData->reInitCodec)
-        applyFadeIn = 1;
-    else
-        applyFadeIn = 0;
-#endif
-    /* local copies of user parameters */
-    int order, nSH, rE_WEIGHT;
-    NORM_TYPES norm;
+    /* consistent snapshot of the user parameters for this frame */
+    up = (const userPars*)saf_paramBlock_read(pData->hUserPars, USER_PARS_AUDIO);
     
-    /* reinitialise if needed */
-    if(pData->reInitTFT==1){
-        pData->reInitTFT = 2;
-        ambi_bin_initTFT(hAmbi); /* always init before codec or hrtfs (will do this better in future release) */
-        pData->reInitTFT = 0;
-    }
-    if(pData->reInitCodec==1){
-        pData->reInitCodec = 2;
-        ambi_bin_initCodec(hAmbi);
-        pData->reInitCodec = 0;
-    }
+    /* pick up newly published codec parameters (these are built on the worker thread, see "ambi_bin_codecWorker");
+     * switching from the previous decoding matrices is crossfaded by "ambi_bin_decodeBand", so the output is not
+     * muted. The TFT covers any order, so an order change needs no reinitialisation here */
+    ambi_bin_updateCodecPars(hAmbi);
+    pars = pData->pars;
     
     /* decode audio to loudspeakers or headphones */
-    if ( (nSamples == FRAME_SIZE) && (isPlaying) && (pData->reInitCodec==0) && (pData->reInitTFT==0) ) {
-        /* copy user parameters to local variables */
-        for(n=0; n<MAX_SH_ORDER+2; n++){  o[n] = n*n;  }
-        norm = pData->norm;
-        rE_WEIGHT = pData->rE_WEIGHT;
-        order = pData->order;
-        nSH = (order+1)*(order+1);
-        
-        /* Load time-domain data */
-        for(i=0; i < MIN(MAX_NUM_SH_SIGNALS, nInputs); i++)
-            memcpy(pData->SHFrameTD[i], inputs[i], FRAME_SIZE * sizeof(float));
-        for(; i<MAX_NUM_SH_SIGNALS; i++)
-            memset(pData->SHFrameTD[i], 0, FRAME_SIZE * sizeof(float)); /* fill remaining channels with zeros, to avoid funky behaviour */
-#ifdef ENABLE_FADE_IN_OUT
-        if(applyFadeIn)
-            for(ch=0; ch < MAX_NUM_SH_SIGNALS;ch++)
-                for(i=0; i<FRAME_SIZE; i++)
-                    pData->SHFrameTD[ch][i] *= (float)i/(float)FRAME_SIZE;
-#endif
-        
-        /* account for input normalisation scheme */
-        switch(norm){
-            case NORM_N3D:  /* already in N3D, do nothing */
-                break;
-            case NORM_SN3D: /* convert to N3D */
-                for (n = 0; n<order+1; n++)
-                    for (ch = o[n]; ch<o[n+1]; ch++)
-                        for(i = 0; i<FRAME_SIZE; i++)
-                            pData->SHFrameTD[ch][i] *= sqrtf(2.0f*(float)n+1.0f);
-                break;
-        }
+    if ( (nSamples == FRAME_SIZE) && (isPlaying) && (pars!=NULL) && (pars->order==up->order) ) {
+        SAF_RT_SCOPE_BEGIN;
+        SAF_PROFILE_BEGIN(pData->hProf, "total");
+        nSH = (up->order+1)*(up->order+1);
         
-        /* Apply time-frequency transform (TFT) */
-        for ( t=0; t< TIME_SLOTS; t++) {
-            for( ch=0; ch < nSH; ch++)
-                for ( sample=0; sample < HOP_SIZE; sample++)
-                    pData->tempHopFrameTD[ch][sample] = pData->SHFrameTD[ch][sample + t*HOP_SIZE];
-            afSTFTforward(pData->hSTFT, (float**)pData->tempHopFrameTD, (complexVector*)pData->STFTInputFrameTF[t]);
-        }
-        for(band=0; band<HYBRID_BANDS; band++)
-            for( ch=0; ch < nSH; ch++)
-                for ( t=0; t<TIME_SLOTS; t++)
-                    pData->SHframeTF[band][ch][t] = cmplxf(pData->STFTInputFrameTF[t][ch].re[band], pData->STFTInputFrameTF[t][ch].im[band]);
+        /* Load time-domain data and apply time-frequency transform (TFT) */
+        SAF_PROFILE_BEGIN(pData->hProf, "afSTFTforward");
+        ambi_bin_analysis(hAmbi, up, inputs, nInputs, pData->applyFadeIn, (float_complex*)pData->SHframeTF, MAX_NUM_SH_SIGNALS*TIME_SLOTS, TIME_SLOTS);
+        pData->applyFadeIn = 0;
+        SAF_PROFILE_END(pData->hProf, "afSTFTforward");
     
-        /* Specify rotation matrix */
-		if (order > 0) {
-			M_rot_tmp = malloc(nSH*nSH * sizeof(float));
-			yawPitchRoll2Rzyx(pData->yaw, pData->pitch, pData->roll, Rxyz);
-			getSHrotMtxReal(Rxyz, M_rot_tmp, order);
-			for (i = 0; i < nSH; i++)
-				for (j = 0; j < nSH; j++)
-					M_rot[i][j] = cmplxf(M_rot_tmp[i*nSH + j], 0.0f);
-			free(M_rot_tmp);
-		}
-        
-        /* Define mixing matrix per band */
-        for (band = 0; band < HYBRID_BANDS; band++) {
-			if (order > 0) { 
-				cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, NUM_EARS, nSH, nSH, &calpha,
-					pars->M_dec[band], MAX_NUM_SH_SIGNALS,
-					M_rot, MAX_NUM_SH_SIGNALS, &cbeta,
-					pData->current_M[band], MAX_NUM_SH_SIGNALS);
-			}
-			else
-				for(i=0; i<NUM_EARS; i++)
-					memcpy(pData->current_M[band][i], pars->M_dec[band][i], nSH * sizeof(float_complex));
-        }
-        
-        /* mix to headphones */
-        for (band = 0; band < HYBRID_BANDS; band++) {
-            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, NUM_EARS, TIME_SLOTS, nSH, &calpha,
-                        pData->prev_M[band], MAX_NUM_SH_SIGNALS,
-                        pData->prev_SHframeTF[band], TIME_SLOTS, &cbeta,
-                        temp_binframeTF, TIME_SLOTS);
-            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, NUM_EARS, TIME_SLOTS, nSH, &calpha,
-                        pData->current_M[band], MAX_NUM_SH_SIGNALS,
-                        pData->prev_SHframeTF[band], TIME_SLOTS, &cbeta,
-                        pData->binframeTF[band], TIME_SLOTS);
-            for (i=0; i < NUM_EARS; i++)
-                for(j=0; j<TIME_SLOTS; j++)
-                    pData->binframeTF[band][i][j] = ccaddf(crmulf(pData->binframeTF[band][i][j], pData->interpolator[j]),
-                                                           crmulf(temp_binframeTF[i][j], (1.0f-pData->interpolator[j])));
-        }
+        /* Specify rotation matrix, and mix to headphones */
+        SAF_PROFILE_BEGIN(pData->hProf, "decode");
+        ambi_bin_updateRotation(hAmbi, up, up->order);
+        for (band = 0; band < HYBRID_BANDS; band++)
+            ambi_bin_decodeBand(hAmbi, pars, band, TIME_SLOTS, (float_complex*)pData->prev_SHframeTF[band],
+                                (float_complex*)pData->binframeTF[band], TIME_SLOTS, (float_complex*)temp_binframeTF);
         
         /* TODO: Apply order-dependent EQ curve */
         
         
         /* for next frame */
-        for (band = 0; band < HYBRID_BANDS; band++){
+        for (band = 0; band < HYBRID_BANDS; band++)
             for (i = 0; i < nSH; i++)
                 memcpy(pData->prev_SHframeTF[band][i], pData->SHframeTF[band][i], TIME_SLOTS*sizeof(float_complex));
-            for (i = 0; i < NUM_EARS; i++)
-                memcpy(pData->prev_M[band][i], pData->current_M[band][i], nSH*sizeof(float_complex));
-        }
+        SAF_PROFILE_END(pData->hProf, "decode");
         
         /* inverse-TFT */
-        for (band = 0; band < HYBRID_BANDS; band++) {
-            for (ch = 0; ch < NUM_EARS; ch++) {
-                for (t = 0; t < TIME_SLOTS; t++) {
-                    pData->STFTOutputFrameTF[t][ch].re[band] = crealf(pData->binframeTF[band][ch][t]);
-                    pData->STFTOutputFrameTF[t][ch].im[band] = cimagf(pData->binframeTF[band][ch][t]);
-                }
-            }
-        }
-        for (t = 0; t < TIME_SLOTS; t++) {
-            afSTFTinverse(pData->hSTFT, pData->STFTOutputFrameTF[t], pData->tempHopFrameTD);
-            for (ch = 0; ch < MIN(NUM_EARS, nOutputs); ch++)
-                for (sample = 0; sample < HOP_SIZE; sample++)
-                    outputs[ch][sample + t* HOP_SIZE] = pData->tempHopFrameTD[ch][sample];
-            for (; ch < nOutputs; ch++) /* fill remaining channels with zeros */
-                for (sample = 0; sample < HOP_SIZE; sample++)
-                    outputs[ch][sample + t* HOP_SIZE] = 0.0f;
-        }
-#ifdef ENABLE_FADE_IN_OUT
-        if(pData->reInitTFT || pData->reInitCodec)
-            for(ch=0; ch < nOutputs; ch++)
-                for(i=0; i<FRAME_SIZE; i++)
-                    outputs[ch][i] *= (1.0f - (float)(i+1)/(float)FRAME_SIZE);
-#endif
+        SAF_PROFILE_BEGIN(pData->hProf, "afSTFTinverse");
+        ambi_bin_synthesis(hAmbi, (float_complex*)pData->binframeTF, NUM_EARS*TIME_SLOTS, TIME_SLOTS, outputs, nOutputs);
+        SAF_PROFILE_END(pData->hProf, "afSTFTinverse");
+        SAF_PROFILE_END(pData->hProf, "total");
+        SAF_RT_SCOPE_END;
     }
-    else
+    else{
         for (ch=0; ch < nOutputs; ch++)
             memset(outputs[ch],0, FRAME_SIZE*sizeof(float));
+        pData->applyFadeIn = 1;
+    }
+}
+
+void ambi_bin_waitForCodecInit(void* const hAmbi)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    saf_worker_wait(pData->hWorker);
+}
+
+
+/* Batch Functions */
+
+void ambi_bin_createBatch
+(
+    void ** const phBatch,
+    int           nInstances
+)
+{
+    ambi_bin_batch* pBatch = (ambi_bin_batch*)malloc(sizeof(ambi_bin_batch));
+    int i;
+    size_t nBytes;
+    
+    if (pBatch == NULL) { return;/*error*/ }
+    *phBatch = (void*)pBatch;
+    pBatch->nInstances = MAX(nInstances, 1);
+    pBatch->hInstances = (void**)malloc(pBatch->nInstances*sizeof(void*));
+    pBatch->applyFadeIn = (int*)calloc(pBatch->nInstances, sizeof(int));
+    pBatch->up = (const userPars**)calloc(pBatch->nInstances, sizeof(const userPars*));
+    for(i=0; i<pBatch->nInstances; i++)
+        ambi_bin_create(&(pBatch->hInstances[i]));
+    
+    /* time-frequency buffers, for the maximum order; they are packed for the current order (see "ambi_bin_processBatch") */
+    nBytes = HYBRID_BANDS*(pBatch->nInstances)*TIME_SLOTS*sizeof(float_complex);
+    pBatch->nSH = 0;
+    pBatch->SHframeTF = (float_complex*)malloc(MAX_NUM_SH_SIGNALS*nBytes);
+    pBatch->prev_SHframeTF = (float_complex*)calloc(MAX_NUM_SH_SIGNALS, nBytes);
+    pBatch->binframeTF = (float_complex*)malloc(NUM_EARS*nBytes);
+    pBatch->tempTF = (float_complex*)malloc(NUM_EARS*nBytes);
+    pBatch->sharedRotation = 0;
+    pBatch->prevSameRotation = 1; /* (all mixing matrices start at zero) */
+}
+
+void ambi_bin_destroyBatch
+(
+    void ** const phBatch
+)
+{
+    ambi_bin_batch* pBatch = (ambi_bin_batch*)(*phBatch);
+    int i;
+    
+    if (pBatch != NULL) {
+        for(i=0; i<pBatch->nInstances; i++)
+            ambi_bin_destroy(&(pBatch->hInstances[i]));
+        free(pBatch->hInstances);
+        free(pBatch->applyFadeIn);
+        free(pBatch->up);
+        free(pBatch->SHframeTF);
+        free(pBatch->prev_SHframeTF);
+        free(pBatch->binframeTF);
+        free(pBatch->tempTF);
+        free(pBatch);
+        *phBatch = NULL;
+    }
+}
+
+void ambi_bin_initBatch
+(
+    void * const hBatch,
+    int          sampleRate
+)
+{
+    ambi_bin_batch* pBatch = (ambi_bin_batch*)(hBatch);
+    int i;
+    
+    for(i=0; i<pBatch->nInstances; i++)
+        ambi_bin_init(pBatch->hInstances[i], sampleRate);
+    memset(pBatch->prev_SHframeTF, 0, HYBRID_BANDS*MAX_NUM_SH_SIGNALS*(pBatch->nInstances)*TIME_SLOTS*sizeof(float_complex));
+    pBatch->prevSameRotation = 1;
+}
+
+void* ambi_bin_getBatchInstance
+(
+    void * const hBatch,
+    int          index
+)
+{
+    ambi_bin_batch* pBatch = (ambi_bin_batch*)(hBatch);
+    if(index<0 || index>=pBatch->nInstances)
+        return NULL;
+    return pBatch->hInstances[index];
+}
+
+/* pool task: loads and transforms the input of one instance, and computes its rotation matrix */
+static void ambi_bin_batchAnalysis(void* arg, int index)
+{
+    ambi_bin_batch* pBatch = (ambi_bin_batch*)arg;
+    const int ld = pBatch->nInstances*TIME_SLOTS;
+    
+    ambi_bin_analysis(pBatch->hInstances[index], pBatch->up[0], pBatch->inputs[index], pBatch->nInputs,
+                      pBatch->applyFadeIn[index], pBatch->SHframeTF + index*TIME_SLOTS, (pBatch->nSH)*ld, ld);
+    ambi_bin_updateRotation(pBatch->hInstances[index], pBatch->up[index], pBatch->up[0]->order);
+}
+
+/* pool task: decodes one band of all instances */
+static void ambi_bin_batchDecode(void* arg, int band)
+{
+    ambi_bin_batch* pBatch = (ambi_bin_batch*)arg;
+    ambi_bin_data* pMaster = (ambi_bin_data*)(pBatch->hInstances[0]);
+    ambi_bin_data* pData;
+    int i, ear;
+    const int ld = pBatch->nInstances*TIME_SLOTS;
+    float_complex* SHframeTF, *binframeTF;
+    float_complex temp_binframeTF[NUM_EARS][TIME_SLOTS];
+    
+    SHframeTF = pBatch->prev_SHframeTF + band*(pBatch->nSH)*ld;
+    binframeTF = pBatch->binframeTF + band*NUM_EARS*ld;
+    if(pBatch->sharedRotation){
+        /* one multiplication spanning the time slots of all instances */
+        ambi_bin_decodeBand(pMaster, pMaster->pars, band, ld, SHframeTF, binframeTF, ld, pBatch->tempTF + band*NUM_EARS*ld);
+        for(i=1; i<pBatch->nInstances; i++){
+            pData = (ambi_bin_data*)(pBatch->hInstances[i]);
+            for(ear=0; ear<NUM_EARS; ear++)
+                memcpy(pData->prev_M[band][ear], pMaster->prev_M[band][ear], (pBatch->nSH)*sizeof(float_complex));
+        }
+    }
+    else {
+        for(i=0; i<pBatch->nInstances; i++)
+            ambi_bin_decodeBand(pBatch->hInstances[i], pMaster->pars, band, TIME_SLOTS, SHframeTF + i*TIME_SLOTS,
+                                binframeTF + i*TIME_SLOTS, ld, (float_complex*)temp_binframeTF);
+    }
+}
+
+/* pool task: transforms the output of one instance back to the time-domain */
+static void ambi_bin_batchSynthesis(void* arg, int index)
+{
+    ambi_bin_batch* pBatch = (ambi_bin_batch*)arg;
+    ambi_bin_data* pData = (ambi_bin_data*)(pBatch->hInstances[index]);
+    const int ld = pBatch->nInstances*TIME_SLOTS;
+    
+    ambi_bin_synthesis(pData, pBatch->binframeTF + index*TIME_SLOTS, NUM_EARS*ld, ld, pBatch->outputs[index], pBatch->nOutputs);
+}
+
+void ambi_bin_processBatch
+(
+    void   *  const hBatch,
+    float *** const inputs,
+    float *** const outputs,
+    int             nInputs,
+    int             nOutputs,
+    int             nSamples,
+    int             isPlaying,
+    void   *  const hPool
+)
+{
+    ambi_bin_batch* pBatch = (ambi_bin_batch*)(hBatch);
+    ambi_bin_data* pMaster = (ambi_bin_data*)(pBatch->hInstances[0]);
+    ambi_bin_data* pData;
+    const userPars* up;
+    int i, ch, band, ld, nSH, sameRotation;
+    float_complex* tempTF;
+    
+    /* consistent snapshots of the user parameters for this frame; the configuration of the first instance applies to
+     * all of them, only the rotation is their own */
+    for(i=0; i<pBatch->nInstances; i++)
+        pBatch->up[i] = (const userPars*)saf_paramBlock_read(((ambi_bin_data*)(pBatch->hInstances[i]))->hUserPars, USER_PARS_AUDIO);
+    up = pBatch->up[0];
+    
+    /* pick up newly published codec parameters (only those of the first instance are used) */
+    ambi_bin_updateCodecPars(pMaster);
+    
+    /* the buffers are packed for the current number of SH signals (they were allocated for the maximum order); if it
+     * changes, the previous frame is repacked in place, band by band, with any added channels starting from silence */
+    nSH = (up->order+1)*(up->order+1);
+    if(nSH != pBatch->nSH){
+        ld = pBatch->nInstances*TIME_SLOTS;
+        for(i=0; i<HYBRID_BANDS; i++){
+            band = nSH > pBatch->nSH ? HYBRID_BANDS-1-i : i; /* (so that no band overwrites one yet to be moved) */
+            memmove(pBatch->prev_SHframeTF + band*nSH*ld, pBatch->prev_SHframeTF + band*(pBatch->nSH)*ld,
+                    MIN(nSH, pBatch->nSH)*ld*sizeof(float_complex));
+            if(nSH > pBatch->nSH)
+                memset(pBatch->prev_SHframeTF + (band*nSH + pBatch->nSH)*ld, 0, (nSH - pBatch->nSH)*ld*sizeof(float_complex));
+        }
+        pBatch->nSH = nSH;
+    }
+    
+    /* decode audio to headphones */
+    if ( (nSamples == FRAME_SIZE) && (isPlaying) && (pMaster->pars!=NULL) && (pMaster->pars->order==up->order) ) {
+        SAF_RT_SCOPE_BEGIN;
+        for(i=0; i<pBatch->nInstances; i++){
+            pData = (ambi_bin_data*)(pBatch->hInstances[i]);
+            pBatch->applyFadeIn[i] = pData->applyFadeIn;
+            pData->applyFadeIn = 0;
+        }
+        pBatch->inputs = inputs;
+        pBatch->outputs = outputs;
+        pBatch->nInputs = nInputs;
+        pBatch->nOutputs = nOutputs;
+        
+        /* per instance: time-frequency transform and rotation matrix */
+        saf_pool_run(hPool, ambi_bin_batchAnalysis, (void*)pBatch, pBatch->nInstances);
+        
+        /* if all instances have the same rotation, in this frame and the last, then they also share the mixing
+         * matrices of the first instance; each band is then decoded for all of them at once */
+        sameRotation = 1;
+        for(i=1; i<pBatch->nInstances && sameRotation; i++){
+            pData = (ambi_bin_data*)(pBatch->hInstances[i]);
+            sameRotation = !memcmp(pData->rotation, pMaster->rotation, 3*sizeof(float));
+        }
+        pBatch->sharedRotation = sameRotation && pBatch->prevSameRotation;
+        pBatch->prevSameRotation = sameRotation;
+        
+        /* per band: decoding to binaural (using the previous frame, as in "ambi_bin_process") */
+        saf_pool_run(hPool, ambi_bin_batchDecode, (void*)pBatch, HYBRID_BANDS);
+        tempTF = pBatch->prev_SHframeTF;
+        pBatch->prev_SHframeTF = pBatch->SHframeTF;
+        pBatch->SHframeTF = tempTF;
+        
+        /* per instance: inverse time-frequency transform */
+        saf_pool_run(hPool, ambi_bin_batchSynthesis, (void*)pBatch, pBatch->nInstances);
+        SAF_RT_SCOPE_END;
+    }
+    else{
+        for(i=0; i<pBatch->nInstances; i++){
+            for (ch=0; ch < nOutputs; ch++)
+                memset(outputs[i][ch], 0, FRAME_SIZE*sizeof(float));
+            ((ambi_bin_data*)(pBatch->hInstances[i]))->applyFadeIn = 1;
+        }
+    }
 }
 
 
@@ -323,122 +459,151 @@ void ambi_bin_process
 
 void ambi_bin_refreshSettings(void* const hAmbi)
 {
-    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    pData->reInitCodec = 1;
-    pData->reInitTFT = 1;
+    ambi_bin_requestCodecInit(hAmbi);
 }
 
 void ambi_bin_setUseDefaultHRIRsflag(void* const hAmbi, int newState)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
     
-    if((!pData->useDefaultHRIRsFLAG) && (newState)){
-        pData->useDefaultHRIRsFLAG = newState;
-        pData->reInitCodec = 1;
+    if((!saf_atomic_loadi(&(pData->useDefaultHRIRsFLAG))) && (newState)){
+        saf_atomic_storei(&(pData->useDefaultHRIRsFLAG), newState);
+        ambi_bin_requestCodecInit(hAmbi);
     }
 }
 
 void ambi_bin_setSofaFilePath(void* const hAmbi, const char* path)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    codecPars* pars = pData->pars;
+    char* new_sofa_filepath;
     
-    pars->sofa_filepath = malloc(strlen(path) + 1);
-    strcpy(pars->sofa_filepath, path);
-    pData->useDefaultHRIRsFLAG = 0;
-    pData->reInitCodec = 1;
+    free(pData->sofa_filepath);
+    pData->sofa_filepath = malloc(strlen(path) + 1);
+    strcpy(pData->sofa_filepath, path);
+    new_sofa_filepath = malloc(strlen(path) + 1);
+    strcpy(new_sofa_filepath, path);
+    free(saf_atomic_exchangep(&(pData->new_sofa_filepath), (void*)new_sofa_filepath));
+    saf_atomic_storei(&(pData->useDefaultHRIRsFLAG), 0);
+    ambi_bin_requestCodecInit(hAmbi);
 }
 
 void ambi_bin_setInputOrderPreset(void* const hAmbi, INPUT_ORDERS newPreset)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    if(pData->orderSelected != (INPUT_ORDERS)newPreset ){
-        pData->orderSelected = (INPUT_ORDERS)newPreset;
-        switch(pData->orderSelected){
-            case INPUT_OMNI:          pData->order = 0; break;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    if(up->orderSelected != (INPUT_ORDERS)newPreset ){
+        up->orderSelected = (INPUT_ORDERS)newPreset;
+        switch(up->orderSelected){
+            case INPUT_OMNI:          up->order = 0; break;
             default:
-            case INPUT_ORDER_FIRST:   pData->order = 1; break;
-            case INPUT_ORDER_SECOND:  pData->order = 2; break;
-            case INPUT_ORDER_THIRD:   pData->order = 3; break;
-            case INPUT_ORDER_FOURTH:  pData->order = 4; break;
-            case INPUT_ORDER_FIFTH:   pData->order = 5; break;
-            case INPUT_ORDER_SIXTH:   pData->order = 6; break;
-            case INPUT_ORDER_SEVENTH: pData->order = 7; break;
+            case INPUT_ORDER_FIRST:   up->order = 1; break;
+            case INPUT_ORDER_SECOND:  up->order = 2; break;
+            case INPUT_ORDER_THIRD:   up->order = 3; break;
+            case INPUT_ORDER_FOURTH:  up->order = 4; break;
+            case INPUT_ORDER_FIFTH:   up->order = 5; break;
+            case INPUT_ORDER_SIXTH:   up->order = 6; break;
+            case INPUT_ORDER_SEVENTH: up->order = 7; break;
         }
-        pData->new_nSH = (pData->order+1)*(pData->order+1);
-        if(pData->new_nSH!=pData->nSH)
-            pData->reInitTFT = 1;
-        pData->reInitCodec = 1;
+        saf_paramBlock_publish(pData->hUserPars);
+        ambi_bin_requestCodecInit(hAmbi); /* (afSTFT is reinitialised by the audio thread, if the number of SH signals changes) */
     }
+    else
+        saf_paramBlock_release(pData->hUserPars);
 }
 
 void ambi_bin_setChOrder(void* const hAmbi, int newOrder)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    pData->chOrdering = (CH_ORDER)newOrder;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->chOrdering = (CH_ORDER)newOrder;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_bin_setNormType(void* const hAmbi, int newType)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    pData->norm = (NORM_TYPES)newType;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->norm = (NORM_TYPES)newType;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_bin_setDecEnableMaxrE(void* const hAmbi, int newState)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    pData->rE_WEIGHT = newState;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->rE_WEIGHT = newState;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_bin_setEnableEQ(void* const hAmbi, int newState)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    pData->enableEQ = newState;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->enableEQ = newState;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_bin_setYaw(void  * const hAmbi, float newYaw)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    pData->yaw = pData->bFlipYaw == 1 ? -DEG2RAD(newYaw) : DEG2RAD(newYaw);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->yaw = up->bFlipYaw == 1 ? -DEG2RAD(newYaw) : DEG2RAD(newYaw);
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_bin_setPitch(void* const hAmbi, float newPitch)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    pData->pitch = pData->bFlipPitch == 1 ? -DEG2RAD(newPitch) : DEG2RAD(newPitch);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->pitch = up->bFlipPitch == 1 ? -DEG2RAD(newPitch) : DEG2RAD(newPitch);
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_bin_setRoll(void* const hAmbi, float newRoll)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    pData->roll = pData->bFlipRoll == 1 ? -DEG2RAD(newRoll) : DEG2RAD(newRoll);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->roll = up->bFlipRoll == 1 ? -DEG2RAD(newRoll) : DEG2RAD(newRoll);
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_bin_setFlipYaw(void* const hAmbi, int newState)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    if(newState !=pData->bFlipYaw ){
-        pData->bFlipYaw = newState;
-        ambi_bin_setYaw(hAmbi, -ambi_bin_getYaw(hAmbi));
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    if(newState !=up->bFlipYaw ){
+        up->bFlipYaw = newState;
+        up->yaw = -(up->yaw); /* (the angle in degrees is unchanged) */
+        saf_paramBlock_publish(pData->hUserPars);
     }
+    else
+        saf_paramBlock_release(pData->hUserPars);
 }
 
 void ambi_bin_setFlipPitch(void* const hAmbi, int newState)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    if(newState !=pData->bFlipPitch ){
-        pData->bFlipPitch = newState;
-        ambi_bin_setPitch(hAmbi, -ambi_bin_getPitch(hAmbi));
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    if(newState !=up->bFlipPitch ){
+        up->bFlipPitch = newState;
+        up->pitch = -(up->pitch); /* (the angle in degrees is unchanged) */
+        saf_paramBlock_publish(pData->hUserPars);
     }
+    else
+        saf_paramBlock_release(pData->hUserPars);
 }
 
 void ambi_bin_setFlipRoll(void* const hAmbi, int newState)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    if(newState !=pData->bFlipRoll ){
-        pData->bFlipRoll = newState;
-        ambi_bin_setRoll(hAmbi, -ambi_bin_getRoll(hAmbi));
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    if(newState !=up->bFlipRoll ){
+        up->bFlipRoll = newState;
+        up->roll = -(up->roll); /* (the angle in degrees is unchanged) */
+        saf_paramBlock_publish(pData->hUserPars);
     }
+    else
+        saf_paramBlock_release(pData->hUserPars);
 }
 
 /* Get Functions */
@@ -446,21 +611,21 @@ void ambi_bin_setFlipRoll(void* const hAmbi, int newState)
 int ambi_bin_getUseDefaultHRIRsflag(void* const hAmbi)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    return pData->useDefaultHRIRsFLAG;
+    return saf_atomic_loadi(&(pData->useDefaultHRIRsFLAG));
 }
 
 int ambi_bin_getInputOrderPreset(void* const hAmbi)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    return (int)pData->orderSelected;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->orderSelected;
 }
 
 char* ambi_bin_getSofaFilePath(void* const hAmbi)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    codecPars* pars = pData->pars;
-    if(pars->sofa_filepath!=NULL)
-        return pars->sofa_filepath;
+    if(pData->sofa_filepath!=NULL)
+        return pData->sofa_filepath;
     else
         return "no_file";
 }
@@ -468,82 +633,89 @@ char* ambi_bin_getSofaFilePath(void* const hAmbi)
 int ambi_bin_getChOrder(void* const hAmbi)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    return (int)pData->chOrdering;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->chOrdering;
 }
 
 int ambi_bin_getNormType(void* const hAmbi)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    return (int)pData->norm;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->norm;
 }
 
 int ambi_bin_getDecEnableMaxrE(void* const hAmbi)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    return pData->rE_WEIGHT;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->rE_WEIGHT;
 }
 
 int ambi_bin_getEnableEQ(void* const hAmbi)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    return pData->enableEQ;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->enableEQ;
 }
 
 float ambi_bin_getYaw(void* const hAmbi)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    return pData->bFlipYaw == 1 ? -RAD2DEG(pData->yaw) : RAD2DEG(pData->yaw);
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->bFlipYaw == 1 ? -RAD2DEG(up->yaw) : RAD2DEG(up->yaw);
 }
 
 float ambi_bin_getPitch(void* const hAmbi)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    return pData->bFlipPitch == 1 ? -RAD2DEG(pData->pitch) : RAD2DEG(pData->pitch);
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->bFlipPitch == 1 ? -RAD2DEG(up->pitch) : RAD2DEG(up->pitch);
 }
 
 float ambi_bin_getRoll(void* const hAmbi)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    return pData->bFlipRoll == 1 ? -RAD2DEG(pData->roll) : RAD2DEG(pData->roll);
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->bFlipRoll == 1 ? -RAD2DEG(up->roll) : RAD2DEG(up->roll);
 }
 
 int ambi_bin_getFlipYaw(void* const hAmbi)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    return pData->bFlipYaw;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->bFlipYaw;
 }
 
 int ambi_bin_getFlipPitch(void* const hAmbi)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    return pData->bFlipPitch;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->bFlipPitch;
 }
 
 int ambi_bin_getFlipRoll(void* const hAmbi)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    return pData->bFlipRoll;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->bFlipRoll;
 }
 
 int ambi_bin_getNDirs(void* const hAmbi)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    codecPars* pars = pData->pars;
-    return pars->N_hrir_dirs;
+    return saf_atomic_loadi(&(pData->N_hrir_dirs));
 }
 
 int ambi_bin_getHRIRlength(void* const hAmbi)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    codecPars* pars = pData->pars;
-    return pars->hrir_len;
+    return saf_atomic_loadi(&(pData->hrir_len));
 }
 
 int ambi_bin_getHRIRsamplerate(void* const hAmbi)
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    codecPars* pars = pData->pars;
-    return pars->hrir_fs;
+    return saf_atomic_loadi(&(pData->hrir_fs));
 }
 
 int ambi_bin_getDAWsamplerate(void* const hAmbi)
@@ -552,4 +724,15 @@ int ambi_bin_getDAWsamplerate(void* const hAmbi)
     return pData->fs;
 }
 
+int ambi_bin_getProcessingDelay(void)
+{
+    return FRAME_SIZE + afSTFTdelay(HOP_SIZE, 0, 1);
+}
+
+void* ambi_bin_getProfiler(void* const hAmbi)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    return pData->hProf;
+}
+
 
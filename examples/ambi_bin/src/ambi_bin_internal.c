@@ -31,78 +31,134 @@
   #include "saf_sofa_reader.h"
 //#endif
 
+void ambi_bin_requestCodecInit(void* const hAmbi)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    
+    saf_atomic_storei(&(pData->reInitCodec), 1);
+    saf_worker_post(pData->hWorker);
+}
+
+void ambi_bin_codecWorker(void* hAmbi)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    codecPars* pars, *next;
+    char* new_sofa_filepath;
+    
+    saf_atomic_storei(&(pData->reInitCodec), 2);
+    
+    /* free the codec parameters the audio thread is no longer using */
+    pars = (codecPars*)saf_atomic_exchangep(&(pData->retiredPars), NULL);
+    for(; pars!=NULL; pars = next){
+        next = pars->next;
+        ambi_bin_freeCodecPars(&pars);
+    }
+    
+    /* take ownership of a newly set sofa file path */
+    new_sofa_filepath = (char*)saf_atomic_exchangep(&(pData->new_sofa_filepath), NULL);
+    if(new_sofa_filepath!=NULL){
+        free(pData->worker_sofa_filepath);
+        pData->worker_sofa_filepath = new_sofa_filepath;
+    }
+    
+    /* build fresh codec parameters for the current order (if the configuration is changed in the meantime, the job is
+     * posted again and these will be superseded) */
+    pars = ambi_bin_createCodecPars();
+    pars->order = ((const userPars*)saf_paramBlock_read(pData->hUserPars, USER_PARS_WORKER))->order;
+    ambi_bin_initCodec(hAmbi, pars);
+    saf_atomic_storei(&(pData->N_hrir_dirs), pars->N_hrir_dirs);
+    saf_atomic_storei(&(pData->hrir_len), pars->hrir_len);
+    saf_atomic_storei(&(pData->hrir_fs), pars->hrir_fs);
+    
+    /* publish them; if the audio thread never picked up the previously published ones, they are not needed anymore */
+    pars = (codecPars*)saf_atomic_exchangep(&(pData->pendingPars), (void*)pars);
+    ambi_bin_freeCodecPars(&pars);
+    
+    /* done, unless another reinitialisation has been requested in the meantime */
+    saf_atomic_casi(&(pData->reInitCodec), 2, 0);
+}
+
+codecPars* ambi_bin_createCodecPars(void)
+{
+    return (codecPars*)calloc(1, sizeof(codecPars));
+}
+
+void ambi_bin_freeCodecPars(codecPars** const ppars)
+{
+    codecPars* pars = *ppars;
+    
+    if(pars!=NULL){
+        hrtfResource_release(&(pars->hrtfRes));
+        free(pars);
+        *ppars = NULL;
+    }
+}
+
+void ambi_bin_updateCodecPars(void* const hAmbi)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    codecPars* newPars, *pars;
+    void* head;
+    
+    newPars = (codecPars*)saf_atomic_exchangep(&(pData->pendingPars), NULL);
+    if(newPars==NULL)
+        return;
+    pars = pData->pars;
+    pData->pars = newPars;
+    if(pars==NULL)
+        return;
+    /* lock-free push; the worker thread only ever takes the whole list at once, so there is no ABA problem */
+    do{
+        head = saf_atomic_loadp(&(pData->retiredPars));
+        pars->next = (codecPars*)head;
+    } while(!saf_atomic_casp(&(pData->retiredPars), head, (void*)pars));
+}
+
 void ambi_bin_initCodec
 (
-    void* const hAmbi
+    void* const hAmbi,
+    codecPars* const pars
 )
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
-    codecPars* pars = pData->pars;
-    int i, j, k, nSH, band, t, nDirs_td;
+    int i, order, nSH, band, t, nDirs_td;
     int* hrir_closest_idx;
     float scale;
     float* Y_td, *t_dirs;
+    hrtfResource* hrtfRes;
     float_complex* M_dec_t, *hrtf_fb_short;
     const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
     
-    nSH = (pData->order+1)*(pData->order+1);
+    order = pars->order;
+    nSH = (order+1)*(order+1);
     
-    /* Convert HRIRs into Filterbank coefficients */ 
-    /* load sofa file or load default hrir data */
-    if(!pData->useDefaultHRIRsFLAG && pars->sofa_filepath!=NULL){
+    /* acquire the HRTF data for the sofa file or the default HRIR set; this is loaded and processed only once, and
+     * then shared (read-only) with any other instance using the same HRIRs */
+    hrtfRes = NULL;
 #ifdef SAF_ENABLE_SOFA_READER
-        loadSofaFile(pars->sofa_filepath,
-                     &pars->hrirs,
-                     &pars->hrir_dirs_deg,
-                     &pars->N_hrir_dirs,
-                     &pars->hrir_len,
-                     &pars->hrir_fs);
-        if((pars->hrirs==NULL) || (pars->hrir_dirs_deg == NULL))
-            pData->useDefaultHRIRsFLAG = 1;
-#else
-        pData->useDefaultHRIRsFLAG = 1;
+    if(!saf_atomic_loadi(&(pData->useDefaultHRIRsFLAG)) && pData->worker_sofa_filepath!=NULL)
+        hrtfResource_acquire(pData->worker_sofa_filepath, loadSofaFile, (float*)pData->freqVector, HYBRID_BANDS, &hrtfRes);
 #endif
+    if(hrtfRes==NULL){
+        /* the sofa file could not be loaded or triangulated, use the default HRIR set */
+        saf_atomic_storei(&(pData->useDefaultHRIRsFLAG), 1);
+        hrtfResource_acquire(NULL, NULL, (float*)pData->freqVector, HYBRID_BANDS, &hrtfRes);
     }
-    if(pData->useDefaultHRIRsFLAG){
-        /* load defaults */
-        pars->N_hrir_dirs = __default_N_hrir_dirs;
-        pars->hrir_len = __default_hrir_len;
-        pars->hrir_fs = __default_hrir_fs;
-        if(pars->hrirs != NULL)
-            free(pars->hrirs);
-        pars->hrirs = malloc(pars->N_hrir_dirs * NUM_EARS * (pars->hrir_len)*sizeof(float));
-        for(i=0; i<pars->N_hrir_dirs; i++)
-            for(j=0; j<NUM_EARS; j++)
-                for(k=0; k< pars->hrir_len; k++)
-                    pars->hrirs[i*NUM_EARS*(pars->hrir_len) + j*(pars->hrir_len) + k] = (float)__default_hrirs[i][j][k];
-        if(pars->hrir_dirs_deg != NULL)
-            free(pars->hrir_dirs_deg);
-        pars->hrir_dirs_deg = malloc(pars->N_hrir_dirs * NUM_EARS * sizeof(float));
-        for(i=0; i<pars->N_hrir_dirs; i++)
-            for(j=0; j<2; j++)
-                pars->hrir_dirs_deg[i*2+j] = (float)__default_hrir_dirs_deg[i][j];
-    }
-    
-    /* estimate the ITDs for each HRIR */
-    if(pars->itds_s!= NULL){
-        free(pars->itds_s);
-        pars->itds_s = NULL;
-    }
-    estimateITDs(pars->hrirs, pars->N_hrir_dirs, pars->hrir_len, pars->hrir_fs, &(pars->itds_s));
-    
-    /* convert hrirs to filterbank coefficients */
-    if(pars->hrtf_fb!= NULL){
-        free(pars->hrtf_fb);
-        pars->hrtf_fb = NULL;
-    }
-    HRIRs2FilterbankHRTFs(pars->hrirs, pars->N_hrir_dirs, pars->hrir_len, pars->itds_s, (float*)pData->freqVector, HYBRID_BANDS, &(pars->hrtf_fb));
+    hrtfResource_release(&(pars->hrtfRes));
+    pars->hrtfRes = hrtfRes;
+    pars->hrir_dirs_deg = hrtfRes->hrir_dirs_deg;
+    pars->N_hrir_dirs = hrtfRes->N_hrir_dirs;
+    pars->hrir_len = hrtfRes->hrir_len;
+    pars->hrir_fs = hrtfRes->hrir_fs;
+    pars->itds_s = hrtfRes->itds_s;
+    pars->hrtf_fb = hrtfRes->hrtf_fb;
     
     /* calculate binaural ambisonic decoding matrix */
-    t = 2*(pData->order+1);
+    t = 2*(order+1);
     Y_td = NULL;
     nDirs_td = __Tdesign_nPoints_per_degree[t-1];
     t_dirs = (float*)__HANDLES_Tdesign_dirs_deg[t-1];
-    getRSH(pData->order, t_dirs, nDirs_td, &Y_td);
+    getRSH(order, t_dirs, nDirs_td, &Y_td);
     M_dec_t = malloc(nSH*nDirs_td*sizeof(float_complex));
     scale = 1.0f/(float)nDirs_td;
     for(i=0; i<nDirs_td*nSH; i++)
@@ -138,38 +194,222 @@ void ambi_bin_initTFT
 {
     ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
     int t, ch;
-
-    /* free afSTFT + buffers, if already allocated */
-    if (pData->hSTFT != NULL){
-        afSTFTfree(pData->hSTFT);
-        pData->hSTFT = NULL;
-        for (t = 0; t<TIME_SLOTS; t++) {
-            for (ch = 0; ch< pData->nSH; ch++) {
-                free(pData->STFTInputFrameTF[t][ch].re);
-                free(pData->STFTInputFrameTF[t][ch].im);
-            }
-        }
-        free2d((void**)pData->tempHopFrameTD, MAX(pData->nSH, NUM_EARS));
-        free2d((void**)pData->STFTInputFrameTF, TIME_SLOTS);
-    }
-    
-    /* reallocate afSTFT + buffers */
-    if (pData->hSTFT == NULL){
-        afSTFTinit(&(pData->hSTFT), HOP_SIZE, pData->new_nSH, NUM_EARS, 0, 1);
-        pData->STFTInputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, pData->new_nSH, sizeof(complexVector));
-        for(t=0; t<TIME_SLOTS; t++) {
-            for(ch=0; ch< pData->new_nSH; ch++) {
-                pData->STFTInputFrameTF[t][ch].re = (float*)calloc(HYBRID_BANDS, sizeof(float));
-                pData->STFTInputFrameTF[t][ch].im = (float*)calloc(HYBRID_BANDS, sizeof(float));
-            }
+
+    /* afSTFT + buffers for the maximum number of SH signals; "ambi_bin_analysis" only transforms those of the current
+     * order, so changing the order does not require reallocating them (on the audio thread) */
+    afSTFTinit(&(pData->hSTFT), HOP_SIZE, MAX_NUM_SH_SIGNALS, NUM_EARS, 0, 1);
+    pData->STFTInputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, MAX_NUM_SH_SIGNALS, sizeof(complexVector));
+    for(t=0; t<TIME_SLOTS; t++) {
+        for(ch=0; ch< MAX_NUM_SH_SIGNALS; ch++) {
+            pData->STFTInputFrameTF[t][ch].re = (float*)calloc(HYBRID_BANDS, sizeof(float));
+            pData->STFTInputFrameTF[t][ch].im = (float*)calloc(HYBRID_BANDS, sizeof(float));
         }
-        pData->tempHopFrameTD = (float**)malloc2d( MAX(pData->new_nSH, NUM_EARS), HOP_SIZE, sizeof(float));
-        pData->nSH = pData->new_nSH;
     }
+    pData->tempHopFrameTD = (float**)malloc2d( MAX(MAX_NUM_SH_SIGNALS, NUM_EARS), HOP_SIZE, sizeof(float));
+    pData->nSH = 0;
 }
 
+void ambi_bin_analysis
+(
+    void* const hAmbi,
+    const userPars* up,
+    float** const inputs,
+    int nInputs,
+    int applyFadeIn,
+    float_complex* SHframeTF,
+    int bandStride,
+    int chStride
+)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    int n, i, t, ch, band, sample, order, nSH;
+    
+    order = up->order;
+    nSH = (order+1)*(order+1);
+    
+    /* Load time-domain data */
+    for(i=0; i < MIN(MAX_NUM_SH_SIGNALS, nInputs); i++)
+        memcpy(pData->SHFrameTD[i], inputs[i], FRAME_SIZE * sizeof(float));
+    for(; i<MAX_NUM_SH_SIGNALS; i++)
+        memset(pData->SHFrameTD[i], 0, FRAME_SIZE * sizeof(float)); /* fill remaining channels with zeros, to avoid funky behaviour */
+#ifdef ENABLE_FADE_IN_OUT
+    if(applyFadeIn)
+        for(ch=0; ch < MAX_NUM_SH_SIGNALS;ch++)
+            for(i=0; i<FRAME_SIZE; i++)
+                pData->SHFrameTD[ch][i] *= (float)i/(float)FRAME_SIZE;
+#endif
+    
+    /* account for input normalisation scheme */
+    switch(up->norm){
+        case NORM_N3D:  /* already in N3D, do nothing */
+            break;
+        case NORM_SN3D: /* convert to N3D */
+            for (n = 0; n<order+1; n++)
+                for (ch = n*n; ch<(n+1)*(n+1); ch++)
+                    for(i = 0; i<FRAME_SIZE; i++)
+                        pData->SHFrameTD[ch][i] *= sqrtf(2.0f*(float)n+1.0f);
+            break;
+    }
+    
+    /* Apply time-frequency transform (TFT), to the SH signals of the current order only; channels that were skipped
+     * in the previous frame (at a lower order) start again from silence */
+    for( ch=pData->nSH; ch < nSH; ch++)
+        afSTFTclearChannel(pData->hSTFT, ch);
+    pData->nSH = nSH;
+    for ( t=0; t< TIME_SLOTS; t++) {
+        for( ch=0; ch < nSH; ch++)
+            for ( sample=0; sample < HOP_SIZE; sample++)
+                pData->tempHopFrameTD[ch][sample] = pData->SHFrameTD[ch][sample + t*HOP_SIZE];
+        afSTFTforwardChannels(pData->hSTFT, (float**)pData->tempHopFrameTD, (complexVector*)pData->STFTInputFrameTF[t], NULL, nSH);
+    }
+    for(band=0; band<HYBRID_BANDS; band++)
+        for( ch=0; ch < nSH; ch++)
+            for ( t=0; t<TIME_SLOTS; t++)
+                SHframeTF[band*bandStride + ch*chStride + t] = cmplxf(pData->STFTInputFrameTF[t][ch].re[band], pData->STFTInputFrameTF[t][ch].im[band]);
+}
 
+void ambi_bin_updateRotation
+(
+    void* const hAmbi,
+    const userPars* up,
+    int order
+)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    float Rxyz[3][3];
+    
+    if(order==pData->rotationOrder && pData->rotation[0]==up->yaw && pData->rotation[1]==up->pitch &&
+       pData->rotation[2]==up->roll)
+        return;
+    pData->rotation[0] = up->yaw;
+    pData->rotation[1] = up->pitch;
+    pData->rotation[2] = up->roll;
+    pData->rotationOrder = order;
+    if (order > 0) {
+        yawPitchRoll2Rzyx(pData->rotation[0], pData->rotation[1], pData->rotation[2], Rxyz);
+        getSHrotMtxReal(Rxyz, pData->M_rot, order);
+    }
+}
 
+void ambi_bin_decodeBand
+(
+    void* const hAmbi,
+    codecPars* pars,
+    int band,
+    int nCols,
+    const float_complex* SHframeTF,
+    float_complex* binframeTF,
+    int ld,
+    float_complex* tempTF
+)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    int i, j, k, n, order, nSH, changed;
+    float re, im, c_re, c_im, d_re, d_im, w;
+    float* cur, *bin, *diff;
+    const float* dec, *prev, *sh;
+    
+    order = pars->order;
+    nSH = (order+1)*(order+1);
+    
+    /* Define mixing matrix; the SH rotation matrix is block-diagonal, with one (2n+1)x(2n+1) block per order n, so each
+     * rotated coefficient of order n only sums over the 2n+1 coefficients of its own block. Per ear, this is
+     * sum_n (2n+1)^2 = (N+1)(2N+1)(2N+3)/3 multiply-adds for order N, i.e. fewer than nSH x (2N+1) = O(nSH*order),
+     * rather than nSH x nSH. The interleaved real/imaginary parts are used directly, as the rotation is real */
+    for(i=0; i<NUM_EARS; i++){
+        dec = (const float*)pars->M_dec[band][i];
+        cur = (float*)pData->current_M[band][i];
+        cur[0] = dec[0];
+        cur[1] = dec[1];
+        for(n=1; n<=order; n++){
+            for(j=n*n; j<(n+1)*(n+1); j++){
+                re = im = 0.0f;
+                for(k=n*n; k<(n+1)*(n+1); k++){
+                    re += dec[2*k]   * pData->M_rot[k*nSH+j];
+                    im += dec[2*k+1] * pData->M_rot[k*nSH+j];
+                }
+                cur[2*j] = re;
+                cur[2*j+1] = im;
+            }
+        }
+    }
+    
+    /* mix to headphones, interpolating from the previous mixing matrix to the current one over the time slots. Since
+     * (1-w)*prev + w*cur = cur + (1-w)*(prev-cur), the signals decoded with the current matrix and with the difference
+     * are accumulated in one pass over the SH signals; the latter only if the mixing matrix has changed */
+    for (i=0; i < NUM_EARS; i++){
+        cur = (float*)pData->current_M[band][i];
+        prev = (const float*)pData->prev_M[band][i];
+        changed = memcmp(prev, cur, nSH*sizeof(float_complex));
+        bin = (float*)&binframeTF[i*ld];
+        diff = (float*)&tempTF[i*nCols];
+        memset(bin, 0, nCols*sizeof(float_complex));
+        if(changed)
+            memset(diff, 0, nCols*sizeof(float_complex));
+        for(k=0; k<nSH; k++){
+            sh = (const float*)&SHframeTF[k*ld];
+            c_re = cur[2*k];
+            c_im = cur[2*k+1];
+            if(changed){
+                d_re = prev[2*k] - c_re;
+                d_im = prev[2*k+1] - c_im;
+                for(j=0; j<nCols; j++){
+                    bin[2*j]    += c_re*sh[2*j] - c_im*sh[2*j+1];
+                    bin[2*j+1]  += c_re*sh[2*j+1] + c_im*sh[2*j];
+                    diff[2*j]   += d_re*sh[2*j] - d_im*sh[2*j+1];
+                    diff[2*j+1] += d_re*sh[2*j+1] + d_im*sh[2*j];
+                }
+            }
+            else{
+                for(j=0; j<nCols; j++){
+                    bin[2*j]    += c_re*sh[2*j] - c_im*sh[2*j+1];
+                    bin[2*j+1]  += c_re*sh[2*j+1] + c_im*sh[2*j];
+                }
+            }
+        }
+        if(changed){
+            for(j=0; j<nCols; j++){
+                w = 1.0f - pData->interpolator[j%TIME_SLOTS];
+                bin[2*j]   += w*diff[2*j];
+                bin[2*j+1] += w*diff[2*j+1];
+            }
+        }
+    }
+    
+    /* for next frame */
+    for (i = 0; i < NUM_EARS; i++)
+        memcpy(pData->prev_M[band][i], pData->current_M[band][i], nSH*sizeof(float_complex));
+}
 
-
-
+void ambi_bin_synthesis
+(
+    void* const hAmbi,
+    const float_complex* binframeTF,
+    int bandStride,
+    int chStride,
+    float** const outputs,
+    int nOutputs
+)
+{
+    ambi_bin_data *pData = (ambi_bin_data*)(hAmbi);
+    int t, ch, band, sample;
+    
+    /* inverse-TFT */
+    for (band = 0; band < HYBRID_BANDS; band++) {
+        for (ch = 0; ch < NUM_EARS; ch++) {
+            for (t = 0; t < TIME_SLOTS; t++) {
+                pData->STFTOutputFrameTF[t][ch].re[band] = crealf(binframeTF[band*bandStride + ch*chStride + t]);
+                pData->STFTOutputFrameTF[t][ch].im[band] = cimagf(binframeTF[band*bandStride + ch*chStride + t]);
+            }
+        }
+    }
+    for (t = 0; t < TIME_SLOTS; t++) {
+        afSTFTinverse(pData->hSTFT, pData->STFTOutputFrameTF[t], pData->tempHopFrameTD);
+        for (ch = 0; ch < MIN(NUM_EARS, nOutputs); ch++)
+            for (sample = 0; sample < HOP_SIZE; sample++)
+                outputs[ch][sample + t* HOP_SIZE] = pData->tempHopFrameTD[ch][sample];
+        for (; ch < nOutputs; ch++) /* fill remaining channels with zeros */
+            for (sample = 0; sample < HOP_SIZE; sample++)
+                outputs[ch][sample + t* HOP_SIZE] = 0.0f;
+    }
+}
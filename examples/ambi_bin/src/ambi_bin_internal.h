@@ -31,7 +31,6 @@
 #include <math.h>
 #include <string.h>
 #include "ambi_bin.h"
-#include "ambi_bin_database.h"
 #define SAF_ENABLE_AFSTFT   /* for time-frequency transform */
 #define SAF_ENABLE_HOA      /* for ambisonic decoding matrices and max_rE weigting */
 #define SAF_ENABLE_SH       /* for spherical harmonic weights */
@@ -54,6 +53,8 @@ extern "C" {
 #define NUM_EARS ( 2 )                                      /* true for most humans */
 #define MAX_SH_ORDER ( 7 )                                  /* 7->64 channels; maximum for most hosts */
 #define MAX_NUM_SH_SIGNALS ( (MAX_SH_ORDER+1)*(MAX_SH_ORDER+1) )
+#define USER_PARS_AUDIO ( 0 )                               /* user parameter block reader index of the audio thread */
+#define USER_PARS_WORKER ( 1 )                              /* user parameter block reader index of the worker thread */
     
 #ifndef DEG2RAD
   #define DEG2RAD(x) (x * PI / 180.0f)
@@ -66,14 +67,28 @@ extern "C" {
 /* Structs */
 /***********/
     
+typedef struct _userPars
+{
+    INPUT_ORDERS orderSelected;                               /* current decoding order PRESET */
+    int order;                                                /* current decoding order */
+    int rE_WEIGHT;                                            /* 0:disabled, 1: enable max_rE weight */
+    int enableEQ;                                             /* 0:disabled, 1: enable EQ */
+    CH_ORDER chOrdering;                                      /* only ACN is supported */
+    NORM_TYPES norm;                                          /* N3D or SN3D */
+    float yaw, roll, pitch;                                   /* rotation angles in radians (negated if flipped) */
+    int bFlipYaw, bFlipPitch, bFlipRoll;
+    
+}userPars;
+    
 typedef struct _codecPars
 {
+    int order;                                                /* decoding order the codec parameters were built for */
+    
     /* Decoder */
     float_complex M_dec[HYBRID_BANDS][NUM_EARS][MAX_NUM_SH_SIGNALS];
     
     /* sofa file info */
-    char* sofa_filepath;                                      /* absolute/relevative file path for a sofa file */
-    float* hrirs;                                             /* time domain HRIRs; N_hrir_dirs x 2 x hrir_len */
+    hrtfResource* hrtfRes;                                    /* shared HRTF data; the HRIR/HRTF pointers below all reference it (do not free) */
     float* hrir_dirs_deg;                                     /* directions of the HRIRs in degrees [azi elev]; N_hrir_dirs x 2 */
     int N_hrir_dirs;                                          /* number of HRIR directions in the current sofa file */
     int hrir_len;                                             /* length of the HRIRs, this can be truncated, see "saf_sofa_reader.h" */
@@ -83,6 +98,8 @@ typedef struct _codecPars
     float* itds_s;                                            /* interaural-time differences for each HRIR (in seconds); N_hrirs x 1 */
     float_complex* hrtf_fb;                                   /* HRTF filterbank coefficients; nBands x nCH x N_hrirs */
     
+    struct _codecPars* next;                                  /* next entry in the list of retired codec parameters */
+    
 }codecPars;
 
 typedef struct _ambi_bin
@@ -101,45 +118,139 @@ typedef struct _ambi_bin
     float freqVector[HYBRID_BANDS];                           /* frequency vector for time-frequency transform, in Hz */
     
     /* our codec configuration */
-    codecPars* pars;                                          /* codec parameters */
+    codecPars* pars;                                          /* codec parameters currently used for rendering (audio thread only) */
+    void* volatile pendingPars;                               /* new codec parameters published by the worker thread (codecPars*) */
+    void* volatile retiredPars;                               /* codec parameters no longer used by the audio thread, freed by the worker thread (codecPars*) */
+    void* hWorker;                                            /* worker thread, which (re)initialises the codec parameters */
+    
+    /* sofa file info */
+    char* sofa_filepath;                                      /* absolute/relevative file path for a sofa file */
+    void* volatile new_sofa_filepath;                         /* copy of a newly set sofa file path, handed over to the worker thread (char*) */
+    char* worker_sofa_filepath;                               /* the worker thread's copy of the sofa file path */
+    volatile int N_hrir_dirs;                                 /* number of HRIR directions of the most recently built codec parameters */
+    volatile int hrir_len;                                    /* length of the HRIRs of the most recently built codec parameters */
+    volatile int hrir_fs;                                     /* sampling rate of the HRIRs of the most recently built codec parameters */
     
     /* internal variables */
     float interpolator[TIME_SLOTS];
     float_complex current_M[HYBRID_BANDS][NUM_EARS][MAX_NUM_SH_SIGNALS];
     float_complex prev_M[HYBRID_BANDS][NUM_EARS][MAX_NUM_SH_SIGNALS];
-    int order;                                                /* current decoding order */
-    int new_nSH;                                              /* if new_nSH != nSH, afSTFT is reinitialised */
-    int nSH;                                                  /* number of spherical harmonic signals */
+    float M_rot[MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS];        /* real rotation matrix of the current frame; FLAT: nSH x nSH */
+    float rotation[3];                                        /* yaw, pitch, roll (radians) that "M_rot" corresponds to */
+    int rotationOrder;                                        /* order that "M_rot" was computed for; -1: not yet computed */
+    int nSH;                                                  /* number of spherical harmonic signals transformed in the previous frame */
     
     /* flags */
-    int reInitCodec;                                          /* 0: no init required, 1: init required, 2: init in progress */
-    int reInitTFT;                                            /* 0: no init required, 1: init required, 2: init in progress */
+    volatile int reInitCodec;                                 /* 0: no init required, 1: init required, 2: init in progress (on the worker thread) */
+    int applyFadeIn;                                          /* 1: fade-in the next rendered frame, as the output was muted */
     
     /* user parameters */
+    void* hUserPars;                                          /* parameter block of "userPars"; edited by the set functions, read by the audio and worker threads */
     float EQ[HYBRID_BANDS];                                   /* EQ curve */
-    int rE_WEIGHT;                                            /* 0:disabled, 1: enable max_rE weight */
-    int enableEQ;                                             /* 0:disabled, 1: enable EQ */
-    int useDefaultHRIRsFLAG;                                  /* 1: use default HRIRs in database, 0: use those from SOFA file */
-    CH_ORDER chOrdering;                                      /* only ACN is supported */
-    NORM_TYPES norm;                                          /* N3D or SN3D */
-    INPUT_ORDERS orderSelected;                               /* current decoding order PRESET */
-    float yaw, roll, pitch;                                   /* rotation angles in degrees */
-    int bFlipYaw, bFlipPitch, bFlipRoll;
+    volatile int useDefaultHRIRsFLAG;                         /* 1: use default HRIRs in database, 0: use those from SOFA file */
+    void* hProf;                                              /* per-stage timing of the processing loop (see saf_profiler.h) */
     
 } ambi_bin_data;
 
+/* a batch of instances, which share the configuration and codec of the first one (see "ambi_bin_processBatch") */
+typedef struct _ambi_bin_batch
+{
+    int nInstances;                                           /* number of instances */
+    void** hInstances;                                        /* instance handles; nInstances x 1 */
+    int* applyFadeIn;                                         /* 1: fade in the current frame of an instance; nInstances x 1 */
+    const userPars** up;                                      /* user parameters of each instance for the current frame; only the
+                                                               * rotation is taken from instances other than the first; nInstances x 1 */
+    
+    /* time-frequency buffers, allocated for MAX_NUM_SH_SIGNALS; the time slots of all instances are interleaved per band
+     * and channel, packed for the current number of spherical harmonic signals */
+    int nSH;                                                  /* number of spherical harmonic signals the buffers hold */
+    float_complex* SHframeTF;                                 /* current frame; FLAT: HYBRID_BANDS x nSH x nInstances x TIME_SLOTS */
+    float_complex* prev_SHframeTF;                            /* previous frame; FLAT: HYBRID_BANDS x nSH x nInstances x TIME_SLOTS */
+    float_complex* binframeTF;                                /* FLAT: HYBRID_BANDS x NUM_EARS x nInstances x TIME_SLOTS */
+    float_complex* tempTF;                                    /* FLAT: HYBRID_BANDS x NUM_EARS x nInstances x TIME_SLOTS */
+    int sharedRotation;                                       /* 1: all instances use the mixing matrices of the first */
+    int prevSameRotation;                                     /* 1: all instances had the same rotation in the previous frame */
+    
+    /* arguments of the current "ambi_bin_processBatch" call, for the thread pool tasks */
+    float*** inputs;
+    float*** outputs;
+    int nInputs;
+    int nOutputs;
+    
+} ambi_bin_batch;
+
 
 /**********************/
 /* Internal functions */
 /**********************/
     
-/* Intialises the codec parameters */
-/* Note: take care to initalise time-frequency transform "ambi_bin_initTFT" first */
-void ambi_bin_initCodec(void* const hAmbi);                   /* ambi_bin handle */
+/* Flags the codec parameters for reinitialisation, which is carried out on the worker thread. Not for the audio thread */
+void ambi_bin_requestCodecInit(void* const hAmbi);            /* ambi_bin handle */
+
+/* Worker thread job: builds a fresh set of codec parameters for the current order and HRIRs and publishes them to the
+ * audio thread. Also frees any codec parameters the audio thread has since retired */
+void ambi_bin_codecWorker(void* hAmbi);                       /* ambi_bin handle */
+
+/* Allocates an empty set of codec parameters */
+codecPars* ambi_bin_createCodecPars(void);
 
-/* Initialise the filterbank used by ambiDEC */
+/* Frees a set of codec parameters (releasing its HRTFs) */
+void ambi_bin_freeCodecPars(codecPars** const ppars);         /* & address of codec parameters */
+
+/* Picks up the codec parameters most recently published by the worker thread (if any), and hands the previous ones
+ * back to it for freeing; lock-free, for the audio thread. The decoding matrices of the previous parameters live on in
+ * "prev_M", so the change is crossfaded over the next frame by "ambi_bin_decodeBand" */
+void ambi_bin_updateCodecPars(void* const hAmbi);             /* ambi_bin handle */
+
+/* Intialises the binaural decoding matrices and HRTFs, for the order in "pars" */
+void ambi_bin_initCodec(void* const hAmbi,                    /* ambi_bin handle */
+                        codecPars* const pars);               /* codec parameters to initialise */
+
+/* Allocates the filterbank and its buffers for up to MAX_NUM_SH_SIGNALS input channels; called once, on creation */
 void ambi_bin_initTFT(void* const hAmbi);                     /* ambi_bin handle */
     
+/* Loads a frame of input (applying the fade-in and normalisation) and transforms the SH signals of the current order
+ * into the time-frequency domain, writing TF sample (band, ch, t) to SHframeTF[band*bandStride + ch*chStride + t] */
+void ambi_bin_analysis(void* const hAmbi,                     /* ambi_bin handle */
+                       const userPars* up,                    /* user parameters of this frame (order and normalisation) */
+                       float** const inputs,                  /* input channels; nInputs x FRAME_SIZE */
+                       int nInputs,                           /* number of input channels */
+                       int applyFadeIn,                       /* 1: fade in this frame */
+                       float_complex* SHframeTF,              /* time-frequency frame */
+                       int bandStride,                        /* distance between bands in "SHframeTF" */
+                       int chStride);                         /* distance between channels in "SHframeTF" */
+    
+/* Computes the rotation matrix of the current frame, "M_rot" (unless the rotation and order are unchanged) */
+void ambi_bin_updateRotation(void* const hAmbi,               /* ambi_bin handle */
+                             const userPars* up,              /* user parameters of this frame (rotation) */
+                             int order);                      /* decoding order */
+    
+/* Decodes one band to binaural (at the order of "pars"), cross-fading from the mixing matrix of the previous frame
+ * to that of the current one. SH sample (ch, col) is read from SHframeTF[ch*ld + col], and binaural sample (ear, col) written to
+ * binframeTF[ear*ld + col]; where col is any of "nCols" time slots (of one or more consecutive instances). The
+ * current mixing matrix is the decoding matrix rotated order by order, using the block-diagonal structure of the SH
+ * rotation matrix: (N+1)(2N+1)(2N+3)/3 multiply-adds per ear for order N, which is below nSH x (2N+1), i.e.
+ * O(nSH*order), instead of nSH x nSH. This is deliberately the exact block-by-block product; the rotation itself is not
+ * factorised any further (e.g. into per-axis rotations). Both mixing matrices are then applied in a single pass over
+ * the SH signals */
+void ambi_bin_decodeBand(void* const hAmbi,                   /* ambi_bin handle */
+                         codecPars* pars,                     /* codec parameters holding the decoding matrices */
+                         int band,                            /* band index */
+                         int nCols,                           /* number of time slots; a multiple of TIME_SLOTS */
+                         const float_complex* SHframeTF,      /* SH signals of this band */
+                         float_complex* binframeTF,           /* binaural signals of this band */
+                         int ld,                              /* distance between channels/ears in both */
+                         float_complex* tempTF);              /* scratch; NUM_EARS x nCols */
+    
+/* Transforms a binaural time-frequency frame, with sample (band, ear, t) at binframeTF[band*bandStride +
+ * ear*chStride + t], back to the time-domain */
+void ambi_bin_synthesis(void* const hAmbi,                    /* ambi_bin handle */
+                        const float_complex* binframeTF,      /* time-frequency frame */
+                        int bandStride,                       /* distance between bands in "binframeTF" */
+                        int chStride,                         /* distance between ears in "binframeTF" */
+                        float** const outputs,                /* output channels; nOutputs x FRAME_SIZE */
+                        int nOutputs);                        /* number of output channels */
+    
 
 #ifdef __cplusplus
 }
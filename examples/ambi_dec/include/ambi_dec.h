@@ -179,6 +179,11 @@ void ambi_dec_process(void* const hAmbi,                /* ambi_dec handle */
                       int nSamples,                     /* number of samples in 'inputs' matrix */
                       int isPlaying);                   /* flag, 1: if there is signal in the buffers */
 
+/* blocks until the worker thread has finished (re)computing the codec parameters, which are then picked up by the
+ * next call to "ambi_dec_process" (e.g. for offline rendering or benchmarking). Must not be called from the audio
+ * thread */
+void ambi_dec_waitForCodecInit(void* const hAmbi);      /* ambi_dec handle */
+
     
 /*****************/
 /* Set Functions */
@@ -186,6 +191,12 @@ void ambi_dec_process(void* const hAmbi,                /* ambi_dec handle */
     
 void ambi_dec_refreshParams(void* const hAmbi);
     
+/* sets the thread pool (see "saf_pool_create") over which "ambi_dec_process" spreads the decoding of the bands; NULL
+ * (default): the audio thread decodes all bands. The pool may be shared with other instances/modules, and must not
+ * be destroyed whilst it is still set */
+void ambi_dec_setThreadPool(void* const hAmbi,         /* ambi_dec handle */
+                            void* const hPool);        /* thread pool handle; NULL: none */
+    
 void ambi_dec_setDecOrder(void* const hAmbi,  int newValue, int bandIdx);
 
 void ambi_dec_setDecOrderAllBands(void* const hAmbi,  int newValue);
@@ -227,6 +238,8 @@ int ambi_dec_getDecOrder(void* const hAmbi, int bandIdx);
     
 int ambi_dec_getDecOrderAllBands(void* const hAmbi);
 
+/* Note: values written via the returned handle take effect once the next set function (or ambi_dec_refreshSettings)
+ * is called, as this is when the user parameters are passed on to the audio thread */
 void ambi_dec_getDecOrderHandle(void* const hAmbi,
                                 float** pX_vector,
                                 int** pY_values,
@@ -263,6 +276,12 @@ int ambi_dec_getDecEnableMaxrE(void* const hAmbi, int index);
 int ambi_dec_getDecNormType(void* const hAmbi, int index);
     
 float ambi_dec_getTransitionFreq(void* const hAmbi);
+
+/* returns the processing delay in samples, introduced by the time-frequency transform */
+int ambi_dec_getProcessingDelay(void);
+
+/* returns the profiler handle, for "saf_profiler_getStats" (NULL, unless built with SAF_ENABLE_PROFILER) */
+void* ambi_dec_getProfiler(void* const hAmbi);
     
     
 #ifdef __cplusplus
@@ -39,71 +39,49 @@ void ambi_dec_create
     ambi_dec_data* pData = (ambi_dec_data*)malloc(sizeof(ambi_dec_data));
     if (pData == NULL) { return;/*error*/ }
     *phAmbi = (void*)pData;
-    int i, j, t, ch, band;
+    saf_profiler_create(&(pData->hProf));
+    pData->hPool = NULL;
+    userPars* up;
+    int band;
     
-    /* afSTFT stuff */
-    pData->hSTFT = NULL;
-    pData->STFTInputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, MAX_NUM_SH_SIGNALS, sizeof(complexVector));
-    for(t=0; t<TIME_SLOTS; t++) {
-        for(ch=0; ch< MAX_NUM_SH_SIGNALS; ch++) {
-            pData->STFTInputFrameTF[t][ch].re = (float*)calloc(HYBRID_BANDS, sizeof(float));
-            pData->STFTInputFrameTF[t][ch].im = (float*)calloc(HYBRID_BANDS, sizeof(float));
-        }
-    }
-    pData->STFTOutputFrameTF = NULL;
-    pData->tempHopFrameTD = NULL;
-    
-    /* time-frequency domain frame per order (starting at 1st) */
-    for(i=1; i<=SH_ORDER; i++)
-        for(band=0; band<HYBRID_BANDS; band++)
-            pData->SHframeTF[i-1][band] = malloc( (i+1)*(i+1)*TIME_SLOTS*sizeof(float_complex));
+    /* afSTFT stuff; allocated once, for the maximum number of loudspeakers (see "ambi_dec_initTFT") */
+    ambi_dec_initTFT(pData);
     
-    /* codec data */
-    pData->pars = (codecPars*)malloc(sizeof(codecPars));
-    codecPars* pars = pData->pars;
-    for (i=0; i<NUM_DECODERS; i++){
-        for(j=0; j<SH_ORDER; j++){
-            pars->M_dec[i][j] = NULL;
-            pars->M_dec_cmplx[i][j] = NULL;
-            pars->M_dec_maxrE[i][j] = NULL;
-            pars->M_dec_cmplx_maxrE[i][j] = NULL;
-        }
-    }
-    pars->sofa_filepath = NULL;
-    pars->hrirs = NULL;
-    pars->hrir_dirs_deg = NULL;
-    pars->hrtf_vbap_gtableIdx = NULL;
-    pars->hrtf_vbap_gtableComp = NULL;
-    pars->itds_s = NULL;
-    pars->hrtf_fb = NULL;
-    pars->hrtf_fb_mag = NULL;
+    /* codec data; built on the worker thread (once the sampling rate is known, see ambi_dec_init) */
+    pData->pars = NULL;
+    pData->pendingPars = NULL;
+    pData->retiredPars = NULL;
+    pData->sofa_filepath = NULL;
+    pData->new_sofa_filepath = NULL;
+    pData->worker_sofa_filepath = NULL;
+    saf_worker_create(&(pData->hWorker), ambi_dec_codecWorker, (void*)pData);
     
     /* internal parameters */
-    pData->new_binauraliseLS = 0;
-    pData->binauraliseLS = pData->new_binauraliseLS;
+    pData->binauraliseLS = 0;
     
     /* flags */
     pData->reInitCodec = 1;
-    pData->reInitTFT = 1;
-    pData->reInitHRTFs = 1;
-    for(ch=0; ch<MAX_NUM_LOUDSPEAKERS; ch++)
-        pData->recalc_hrtf_interpFLAG[ch] = 1;
+    pData->applyFadeIn = 1;
     
     /* default user parameters */
+    saf_paramBlock_create(&(pData->hUserPars), sizeof(userPars), 2);
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
     for(band=0; band<HYBRID_BANDS; band++)
-        pData->orderPerBand[band] = SH_ORDER;
-    pData->useDefaultHRIRsFLAG = 1; /* pars->sofa_filepath must be valid to set this to 0 */
-    ambi_dec_loadPreset(PRESET_T_DESIGN_24, pData->loudpkrs_dirs_deg, &(pData->new_nLoudpkrs), &(pData->loudpkrs_nDims)); 
-    pData->nLoudpkrs = pData->new_nLoudpkrs;
-    pData->chOrdering = CH_ACN;
-    pData->norm = NORM_N3D; 
-    pData->dec_method[0] = DECODER_MMD;
-    pData->dec_method[1] = DECODER_ALLRAD;
-    pData->rE_WEIGHT[0] = 0;
-    pData->rE_WEIGHT[1] = 1;
-    pData->diffEQmode[0] = AMPLITUDE_PRESERVING;
-    pData->diffEQmode[1] = ENERGY_PRESERVING;
-    pData->transitionFreq = 1000.0f;
+        up->orderPerBand[band] = SH_ORDER;
+    pData->useDefaultHRIRsFLAG = 1; /* pData->sofa_filepath must be valid to set this to 0 */
+    ambi_dec_loadPreset(PRESET_T_DESIGN_24, up->loudpkrs_dirs_deg, &(up->nLoudpkrs), &(up->loudpkrs_nDims)); 
+    up->binauraliseLS = pData->binauraliseLS;
+    up->chOrdering = CH_ACN;
+    up->norm = NORM_N3D; 
+    up->dec_method[0] = DECODER_MMD;
+    up->dec_method[1] = DECODER_ALLRAD;
+    up->rE_WEIGHT[0] = 0;
+    up->rE_WEIGHT[1] = 1;
+    up->diffEQmode[0] = AMPLITUDE_PRESERVING;
+    up->diffEQmode[1] = ENERGY_PRESERVING;
+    up->transitionFreq = 1000.0f;
+    memcpy(&(pData->prevUp), up, sizeof(userPars));
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_dec_destroy
@@ -112,66 +90,41 @@ void ambi_dec_destroy
 )
 {
     ambi_dec_data *pData = (ambi_dec_data*)(*phAmbi);
-    codecPars *pars = pData->pars;
-    int i, j, t, ch, band;
+    codecPars *pars, *next;
+    int t, ch;
     
     if (pData != NULL) {
-        if(pData->hSTFT!=NULL)
-            afSTFTfree(pData->hSTFT);
+        /* stop the worker thread first (waits for it to finish any initialisation in progress) */
+        saf_worker_destroy(&(pData->hWorker));
+        
+        afSTFTfree(pData->hSTFT);
         for (t = 0; t<TIME_SLOTS; t++) {
-            if(pData->STFTInputFrameTF!=NULL){
-                for (ch = 0; ch< MAX_NUM_SH_SIGNALS; ch++) {
-                    free(pData->STFTInputFrameTF[t][ch].re);
-                    free(pData->STFTInputFrameTF[t][ch].im);
-                }
+            for (ch = 0; ch< MAX_NUM_SH_SIGNALS; ch++) {
+                free(pData->STFTInputFrameTF[t][ch].re);
+                free(pData->STFTInputFrameTF[t][ch].im);
             }
-            if(pData->binauraliseLS &&  (pData->STFTOutputFrameTF!=NULL) ){
-                for (ch = 0; ch< NUM_EARS; ch++) {
-                    free(pData->STFTOutputFrameTF[t][ch].re);
-                    free(pData->STFTOutputFrameTF[t][ch].im);
-                }
-            }
-            else if((pData->STFTOutputFrameTF!=NULL)){
-                for (ch = 0; ch< pData->nLoudpkrs; ch++) {
-                    free(pData->STFTOutputFrameTF[t][ch].re);
-                    free(pData->STFTOutputFrameTF[t][ch].im);
-                }
+            for (ch = 0; ch< MAX_NUM_LOUDSPEAKERS; ch++) {
+                free(pData->STFTOutputFrameTF[t][ch].re);
+                free(pData->STFTOutputFrameTF[t][ch].im);
             }
         }
         free2d((void**)pData->STFTInputFrameTF, TIME_SLOTS);
         free2d((void**)pData->STFTOutputFrameTF, TIME_SLOTS);
-        if(pData->binauraliseLS && (pData->tempHopFrameTD!=NULL) )
-            free2d((void**)pData->tempHopFrameTD, MAX(NUM_EARS, MAX_NUM_SH_SIGNALS));
-        else if(pData->tempHopFrameTD!=NULL)
-            free2d((void**)pData->tempHopFrameTD, MAX(pData->nLoudpkrs, MAX_NUM_SH_SIGNALS));
-        
-        for(i=1; i<=SH_ORDER; i++)
-            for(band=0; band<HYBRID_BANDS; band++)
-                free(pData->SHframeTF[i-1][band]);
+        free2d((void**)pData->tempHopFrameTD, MAX(MAX_NUM_LOUDSPEAKERS, MAX_NUM_SH_SIGNALS));
 
-        if(pars->hrtf_vbap_gtableComp!= NULL)
-            free(pars->hrtf_vbap_gtableComp);
-        if(pars->hrtf_vbap_gtableIdx!= NULL)
-            free(pars->hrtf_vbap_gtableIdx);
-        if(pars->hrtf_fb!= NULL)
-            free(pars->hrtf_fb);
-        if(pars->hrtf_fb_mag!= NULL)
-            free(pars->hrtf_fb_mag);
-        if(pars->itds_s!= NULL)
-            free(pars->itds_s);
-        if(pars->hrirs!= NULL)
-            free(pars->hrirs);
-        if(pars->hrir_dirs_deg!= NULL)
-            free(pars->hrir_dirs_deg);
-        for (i=0; i<NUM_DECODERS; i++){
-            for(j=0; j<SH_ORDER; j++){
-                free(pars->M_dec[i][j]);
-                free(pars->M_dec_cmplx[i][j]);
-                free(pars->M_dec_maxrE[i][j]);
-                free(pars->M_dec_cmplx_maxrE[i][j]);
-            }
+        ambi_dec_freeCodecPars(&(pData->pars));
+        pars = (codecPars*)pData->pendingPars;
+        ambi_dec_freeCodecPars(&pars);
+        for(pars = (codecPars*)pData->retiredPars; pars!=NULL; pars = next){
+            next = pars->next;
+            ambi_dec_freeCodecPars(&pars);
         }
+        free(pData->sofa_filepath);
+        free(pData->new_sofa_filepath);
+        free(pData->worker_sofa_filepath);
+        saf_paramBlock_destroy(&(pData->hUserPars));
 
+        saf_profiler_destroy(&(pData->hProf));
         free(pData);
         pData = NULL;
     }
@@ -194,6 +147,62 @@ void ambi_dec_init
         else /* Assume 48kHz */
             pData->freqVector[band] =  (float)__afCenterFreq48e3[band];
     } 
+    
+    /* (re)build the codec parameters for this sampling rate */
+    ambi_dec_requestCodecInit(hAmbi);
+}
+
+void ambi_dec_setThreadPool(void* const hAmbi, void* const hPool)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    saf_atomic_storep(&(pData->hPool), hPool);
+}
+
+/* returns 1 if the decoding settings applied per band (rather than through the codec parameters) differ */
+static int ambi_dec_decodingSettingsDiffer(const userPars* up1, const userPars* up2)
+{
+    return memcmp(up1->orderPerBand, up2->orderPerBand, HYBRID_BANDS*sizeof(int)) ||
+           memcmp(up1->rE_WEIGHT, up2->rE_WEIGHT, NUM_DECODERS*sizeof(int)) ||
+           memcmp(up1->diffEQmode, up2->diffEQmode, NUM_DECODERS*sizeof(DIFFUSE_FIELD_EQ_APPROACH)) ||
+           up1->transitionFreq != up2->transitionFreq;
+}
+
+/* pool task: decodes one band of the current frame, crossfading from the output of the previous codec parameters,
+ * decoding settings and/or binauralisation state; outputs only present on one side of the crossfade are faded from/to
+ * zero */
+static void ambi_dec_decodeTask(void* arg, int band)
+{
+    ambi_dec_frameArgs* frameArgs = (ambi_dec_frameArgs*)arg;
+    ambi_dec_data *pData = (ambi_dec_data*)(frameArgs->hAmbi);
+    int t, ch, nDecoded;
+    float fadeIn, fadeOut;
+    
+    ambi_dec_decodeBand(frameArgs->hAmbi, frameArgs->up, frameArgs->pars, frameArgs->binauraliseLS, band,
+                        pData->outputframeTF[band]);
+    nDecoded = frameArgs->nOutputs;
+    
+    /* crossfade from the output of the previous configuration over the frame */
+    if(frameArgs->crossfade){
+        ambi_dec_decodeBand(frameArgs->hAmbi, frameArgs->prevUp!=NULL ? frameArgs->prevUp : frameArgs->up,
+                            frameArgs->prevPars!=NULL ? frameArgs->prevPars : frameArgs->pars, frameArgs->prevBinauraliseLS, band,
+                            pData->outputframeTF_prev[band]);
+        for (t = 0; t < TIME_SLOTS; t++) {
+            fadeIn = (float)(t+1)/(float)TIME_SLOTS;
+            fadeOut = 1.0f - fadeIn;
+            for (ch = 0; ch < MIN(frameArgs->nOutputs, frameArgs->nPrevOutputs); ch++)
+                pData->outputframeTF[band][ch][t] = ccaddf(crmulf(pData->outputframeTF[band][ch][t], fadeIn),
+                                                           crmulf(pData->outputframeTF_prev[band][ch][t], fadeOut));
+            for (; ch < frameArgs->nOutputs; ch++)
+                pData->outputframeTF[band][ch][t] = crmulf(pData->outputframeTF[band][ch][t], fadeIn);
+            for (; ch < frameArgs->nPrevOutputs; ch++)
+                pData->outputframeTF[band][ch][t] = crmulf(pData->outputframeTF_prev[band][ch][t], fadeOut);
+        }
+        nDecoded = MAX(nDecoded, frameArgs->nPrevOutputs);
+    }
+    
+    /* outputs that are no longer in use are still inverse-transformed until their filterbank memory has emptied */
+    for (ch = nDecoded; ch < frameArgs->nOutputsTF; ch++)
+        memset(pData->outputframeTF[band][ch], 0, TIME_SLOTS*sizeof(float_complex));
 }
 
 void ambi_dec_process
@@ -208,52 +217,39 @@ void ambi_dec_process
 )
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    codecPars* pars = pData->pars;
-    int n, t, sample, ch, ear, i, band, orderBand, nSH_band, decIdx;
+    const userPars* up;
+    codecPars* pars, *prevPars, *newPars;
+    ambi_dec_frameArgs frameArgs;
+    int n, t, sample, ch, i, band, nActive;
     int o[SH_ORDER+2];
-    const float_complex calpha = cmplxf(1.0f,0.0f), cbeta = cmplxf(0.0f, 0.0f);
     
-#ifdef ENABLE_FADE_IN_OUT
-    int applyFadeIn;
-    if(pData->reInitTFT || pData->reInitHRTFs)
-        applyFadeIn = 1;
-    else
-        applyFadeIn = 0;
-#endif
     /* local copies of user parameters */
-    int nLoudspeakers, binauraliseLS;
-    int orderPerBand[HYBRID_BANDS], rE_WEIGHT[NUM_DECODERS];
-    float transitionFreq;
-    DIFFUSE_FIELD_EQ_APPROACH diffEQmode[NUM_DECODERS];
-    NORM_TYPES norm;
+    int binauraliseLS;
+    NORM_TYPES norm;
     
-    /* reinitialise if needed */
-    if(pData->reInitTFT==1){
-        pData->reInitTFT = 2;
-        ambi_dec_initTFT(hAmbi); /* always init before codec or hrtfs (will do this better in future release) */
-        pData->reInitTFT = 0;
-    } /* TODO: do this better for future release */
-    if(pData->reInitCodec==1){
-        pData->reInitCodec = 2;
-        ambi_dec_initCodec(hAmbi);
-        pData->reInitCodec = 0;
-    }
-    if(pData->reInitHRTFs==1){
-        pData->reInitHRTFs = 2;
-        ambi_dec_initHRTFs(hAmbi);
-        pData->reInitHRTFs = 0;
+    /* consistent snapshot of the user parameters for this frame */
+    up = (const userPars*)saf_paramBlock_read(pData->hUserPars, USER_PARS_AUDIO);
+    
+    /* pick up newly published codec parameters (built on the worker thread, see "ambi_dec_codecWorker"); the previous
+     * ones are kept for this frame, in order to crossfade between the two, and are then handed back to the worker thread
+     * for freeing */
+    pars = pData->pars;
+    prevPars = NULL;
+    newPars = (codecPars*)saf_atomic_exchangep(&(pData->pendingPars), NULL);
+    if(newPars!=NULL){
+        prevPars = pars;
+        pData->pars = pars = newPars;
     }
+    
     /* decode audio to loudspeakers or headphones */
-    if ( (nSamples == FRAME_SIZE) && (isPlaying) && (pData->reInitCodec==0) && (pData->reInitTFT==0) && (pData->reInitHRTFs==0) ) {
-        /* copy user parameters to local variables */
+    if ( (nSamples == FRAME_SIZE) && (isPlaying) && (pars!=NULL) ) {
+        SAF_RT_SCOPE_BEGIN;
+        SAF_PROFILE_BEGIN(pData->hProf, "total");
+        /* copy user parameters to local variables; the output configuration is that of the codec parameters, as the
+         * HRTFs are only available once they have been built for it */
         for(n=0; n<SH_ORDER+2; n++){  o[n] = n*n;  }
-        nLoudspeakers = pData->nLoudpkrs;
-        memcpy(orderPerBand, pData->orderPerBand, HYBRID_BANDS*sizeof(int));
-        transitionFreq = pData->transitionFreq;
-        memcpy(diffEQmode, pData->diffEQmode, NUM_DECODERS*sizeof(int));
-        binauraliseLS = pData->binauraliseLS;
-        norm = pData->norm;
-        memcpy(rE_WEIGHT, pData->rE_WEIGHT, NUM_DECODERS*sizeof(int));
+        binauraliseLS = up->binauraliseLS && pars->binauraliseLS;
+        norm = up->norm;
         
         /* Load time-domain data */
         for(i=0; i < MIN(MAX_NUM_SH_SIGNALS, nInputs); i++)
@@ -261,11 +257,12 @@ void ambi_dec_process
         for(; i<MAX_NUM_SH_SIGNALS; i++)
             memset(pData->SHFrameTD[i], 0, FRAME_SIZE * sizeof(float)); /* fill remaining channels with zeros, to avoid funky behaviour */
 #ifdef ENABLE_FADE_IN_OUT
-        if(applyFadeIn)
+        if(pData->applyFadeIn)
             for(ch=0; ch < MAX_NUM_SH_SIGNALS;ch++)
                 for(i=0; i<FRAME_SIZE; i++)
                     pData->SHFrameTD[ch][i] *= (float)i/(float)FRAME_SIZE;
 #endif
+        pData->applyFadeIn = 0;
         
         /* account for input normalisation scheme */
         switch(norm){
@@ -280,106 +277,86 @@ void ambi_dec_process
         }
         
         /* Apply time-frequency transform (TFT) */
+        SAF_PROFILE_BEGIN(pData->hProf, "afSTFTforward");
         for ( t=0; t< TIME_SLOTS; t++) {
             for( ch=0; ch < MAX_NUM_SH_SIGNALS; ch++)
                 for ( sample=0; sample < HOP_SIZE; sample++)
                     pData->tempHopFrameTD[ch][sample] = pData->SHFrameTD[ch][sample + t*HOP_SIZE];
             afSTFTforward(pData->hSTFT, (float**)pData->tempHopFrameTD, (complexVector*)pData->STFTInputFrameTF[t]);
         }
-        for(n=1; n<=SH_ORDER; n++)
-            for(band=0; band<HYBRID_BANDS; band++)
-                for( ch=0; ch < (n+1)*(n+1); ch++)
-                    for ( t=0; t<TIME_SLOTS; t++)
-                        pData->SHframeTF[n-1][band][ch*TIME_SLOTS + t] = cmplxf(pData->STFTInputFrameTF[t][ch].re[band], pData->STFTInputFrameTF[t][ch].im[band]);
+        for(band=0; band<HYBRID_BANDS; band++)
+            for( ch=0; ch < MAX_NUM_SH_SIGNALS; ch++)
+                for ( t=0; t<TIME_SLOTS; t++)
+                    pData->SHframeTF[band][ch][t] = cmplxf(pData->STFTInputFrameTF[t][ch].re[band], pData->STFTInputFrameTF[t][ch].im[band]);
+        SAF_PROFILE_END(pData->hProf, "afSTFTforward");
         
-        /* Decode to loudspeaker set-up */
-        memset(pData->outputframeTF, 0, HYBRID_BANDS*MAX_NUM_LOUDSPEAKERS*TIME_SLOTS*sizeof(float_complex));
-        for(band=0; band<HYBRID_BANDS; band++){
-            orderBand = MAX(MIN(orderPerBand[band], SH_ORDER),1);
-            nSH_band = (orderBand+1)*(orderBand+1);
-            decIdx = pData->freqVector[band] < transitionFreq ? 0 : 1; /* different decoder for low (0) and high (1) frequencies */
-            if(rE_WEIGHT[decIdx]){
-                cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nLoudspeakers, TIME_SLOTS, nSH_band, &calpha,
-                            pars->M_dec_cmplx_maxrE[decIdx][orderBand-1], nSH_band,
-                            pData->SHframeTF[orderBand-1][band], TIME_SLOTS, &cbeta,
-                            pData->outputframeTF[band], TIME_SLOTS);
-            }
-            else{
-                cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nLoudspeakers, TIME_SLOTS, nSH_band, &calpha,
-                            pars->M_dec_cmplx[decIdx][orderBand-1], nSH_band,
-                            pData->SHframeTF[orderBand-1][band], TIME_SLOTS, &cbeta,
-                            pData->outputframeTF[band], TIME_SLOTS);
-            }
-            for(i=0; i<nLoudspeakers; i++){
-                for(t=0; t<TIME_SLOTS; t++){
-                    if(diffEQmode[decIdx]==AMPLITUDE_PRESERVING)
-                        pData->outputframeTF[band][i][t] = crmulf(pData->outputframeTF[band][i][t], pars->M_norm[decIdx][orderBand-1][0]);
-                    else
-                        pData->outputframeTF[band][i][t] = crmulf(pData->outputframeTF[band][i][t], pars->M_norm[decIdx][orderBand-1][1]);
+        /* Decode to loudspeaker set-up, or directly to the ears if binauralisation is enabled; the bands are spread over
+         * the thread pool (if any), and are all complete before the inverse-TFT */
+        SAF_PROFILE_BEGIN(pData->hProf, "decode");
+        frameArgs.hAmbi = hAmbi;
+        frameArgs.up = up;
+        frameArgs.pars = pars;
+        frameArgs.prevPars = prevPars;
+        frameArgs.prevUp = ambi_dec_decodingSettingsDiffer(&(pData->prevUp), up) ? &(pData->prevUp) : NULL;
+        frameArgs.binauraliseLS = binauraliseLS;
+        frameArgs.prevBinauraliseLS = pData->binauraliseLS;
+        frameArgs.crossfade = (prevPars!=NULL) || (frameArgs.prevUp!=NULL) || (binauraliseLS!=pData->binauraliseLS);
+        frameArgs.nOutputs = binauraliseLS ? NUM_EARS : pars->nLoudpkrs;
+        frameArgs.nPrevOutputs = !frameArgs.crossfade ? 0 :
+                                 pData->binauraliseLS ? NUM_EARS : (prevPars!=NULL ? prevPars : pars)->nLoudpkrs;
+        
+        /* outputs dropped by a change of configuration are kept in the inverse-TFT (with silent input) until their
+         * filterbank memory has emptied, so that their tail is not cut off and they can be picked up again at any time */
+        nActive = MAX(frameArgs.nOutputs, frameArgs.nPrevOutputs);
+        if( (nActive >= pData->nOutputsTF) || (pData->nSilentSamples >= afSTFTtail(HOP_SIZE, 1)) ){
+            pData->nOutputsTF = nActive;
+            pData->nSilentSamples = 0;
+        }
+        else
+            pData->nSilentSamples += FRAME_SIZE;
+        frameArgs.nOutputsTF = pData->nOutputsTF;
+        saf_pool_run(saf_atomic_loadp(&(pData->hPool)), ambi_dec_decodeTask, (void*)&frameArgs, HYBRID_BANDS);
+        pData->binauraliseLS = binauraliseLS;
+        SAF_PROFILE_END(pData->hProf, "decode");
+        
+        /* inverse-TFT */
+        SAF_PROFILE_BEGIN(pData->hProf, "afSTFTinverse");
+        for (band = 0; band < HYBRID_BANDS; band++) {
+            for (ch = 0; ch < pData->nOutputsTF; ch++) {
+                for (t = 0; t < TIME_SLOTS; t++) {
+                    pData->STFTOutputFrameTF[t][ch].re[band] = crealf(pData->outputframeTF[band][ch][t]);
+                    pData->STFTOutputFrameTF[t][ch].im[band] = cimagf(pData->outputframeTF[band][ch][t]);
                 }
             }
-        }
-        
-        /* binauralise the loudspeaker signals */
-        if(binauraliseLS){
-            memset(pData->binframeTF, 0, HYBRID_BANDS*NUM_EARS*TIME_SLOTS * sizeof(float_complex));
-            /* interpolate hrtfs and apply to each source */
-            for (ch = 0; ch < nLoudspeakers; ch++) {
-                if(pData->recalc_hrtf_interpFLAG[ch]){
-                    ambi_dec_interpHRTFs(hAmbi, pData->loudpkrs_dirs_deg[ch][0], pData->loudpkrs_dirs_deg[ch][1], pars->hrtf_interp[ch]);
-                    pData->recalc_hrtf_interpFLAG[ch] = 0;
-                }
-                for (band = 0; band < HYBRID_BANDS; band++)
-                    for (ear = 0; ear < NUM_EARS; ear++)
-                        for (t = 0; t < TIME_SLOTS; t++)
-                            pData->binframeTF[band][ear][t] = ccaddf(pData->binframeTF[band][ear][t], ccmulf(pData->outputframeTF[band][ch][t], pars->hrtf_interp[ch][band][ear]));
-            }
-            
-            /* scale by sqrt(number of loudspeakers) */
-            for (band = 0; band < HYBRID_BANDS; band++)
-                for (ear = 0; ear < NUM_EARS; ear++)
-                    for (t = 0; t < TIME_SLOTS; t++)
-                        pData->binframeTF[band][ear][t] = crmulf(pData->binframeTF[band][ear][t], 1.0f/sqrtf((float)nLoudspeakers));
-        }
-        
-        /* inverse-TFT */
-        for (band = 0; band < HYBRID_BANDS; band++) {
-            if(binauraliseLS){
-                for (ch = 0; ch < NUM_EARS; ch++) {
-                    for (t = 0; t < TIME_SLOTS; t++) {
-                        pData->STFTOutputFrameTF[t][ch].re[band] = crealf(pData->binframeTF[band][ch][t]);
-                        pData->STFTOutputFrameTF[t][ch].im[band] = cimagf(pData->binframeTF[band][ch][t]);
-                    }
-                }
-            }
-            else{
-                for (ch = 0; ch < nLoudspeakers; ch++) {
-                    for (t = 0; t < TIME_SLOTS; t++) {
-                        pData->STFTOutputFrameTF[t][ch].re[band] = crealf(pData->outputframeTF[band][ch][t]);
-                        pData->STFTOutputFrameTF[t][ch].im[band] = cimagf(pData->outputframeTF[band][ch][t]);
-                    }
-                }
-            }
-        }
-        for (t = 0; t < TIME_SLOTS; t++) {
-            afSTFTinverse(pData->hSTFT, pData->STFTOutputFrameTF[t], pData->tempHopFrameTD);
-            for (ch = 0; ch < MIN(binauraliseLS==1 ? NUM_EARS : nLoudspeakers, nOutputs); ch++)
-                for (sample = 0; sample < HOP_SIZE; sample++)
-                    outputs[ch][sample + t* HOP_SIZE] = pData->tempHopFrameTD[ch][sample];
-            for (; ch < nOutputs; ch++) /* fill remaining channels with zeros */
-                for (sample = 0; sample < HOP_SIZE; sample++)
-                    outputs[ch][sample + t* HOP_SIZE] = 0.0f;
-        }
-#ifdef ENABLE_FADE_IN_OUT
-        if(pData->reInitTFT || pData->reInitHRTFs)
-            for(ch=0; ch < nOutputs; ch++)
-                for(i=0; i<FRAME_SIZE; i++)
-                    outputs[ch][i] *= (1.0f - (float)(i+1)/(float)FRAME_SIZE);
-#endif
+        }
+        for (t = 0; t < TIME_SLOTS; t++) {
+            afSTFTinverseChannels(pData->hSTFT, pData->STFTOutputFrameTF[t], pData->tempHopFrameTD, NULL, pData->nOutputsTF);
+            for (ch = 0; ch < MIN(pData->nOutputsTF, nOutputs); ch++)
+                for (sample = 0; sample < HOP_SIZE; sample++)
+                    outputs[ch][sample + t* HOP_SIZE] = pData->tempHopFrameTD[ch][sample];
+            for (; ch < nOutputs; ch++) /* fill remaining channels with zeros */
+                for (sample = 0; sample < HOP_SIZE; sample++)
+                    outputs[ch][sample + t* HOP_SIZE] = 0.0f;
+        }
+        SAF_PROFILE_END(pData->hProf, "afSTFTinverse");
+        SAF_PROFILE_END(pData->hProf, "total");
+        SAF_RT_SCOPE_END;
     }
-    else
+    else{
         for (ch=0; ch < nOutputs; ch++)
             memset(outputs[ch],0, FRAME_SIZE*sizeof(float));
+        pData->applyFadeIn = 1;
+    }
+    
+    /* the previous codec parameters are no longer needed */
+    ambi_dec_retireCodecPars(hAmbi, prevPars);
+    memcpy(&(pData->prevUp), up, sizeof(userPars));
+}
+
+void ambi_dec_waitForCodecInit(void* const hAmbi)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    saf_worker_wait(pData->hWorker);
 }
 
 
@@ -388,118 +365,133 @@ void ambi_dec_process
 void ambi_dec_refreshSettings(void* const hAmbi)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    pData->reInitCodec = 1;
-    pData->reInitTFT = 1;
-    pData->reInitHRTFs = 1;
+    saf_paramBlock_edit(pData->hUserPars);
+    saf_paramBlock_publish(pData->hUserPars);
+    ambi_dec_requestCodecInit(hAmbi);
 }
 
 void ambi_dec_setDecOrder(void  * const hAmbi, int newValue, int bandIdx)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    pData->orderPerBand[bandIdx] = MIN(MAX(newValue,1), SH_ORDER);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->orderPerBand[bandIdx] = MIN(MAX(newValue,1), SH_ORDER);
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_dec_setDecOrderAllBands(void  * const hAmbi, int newValue)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
     int band;
     
     for(band=0; band<HYBRID_BANDS; band++)
-        pData->orderPerBand[band] = MIN(MAX(newValue,1), SH_ORDER);
+        up->orderPerBand[band] = MIN(MAX(newValue,1), SH_ORDER);
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_dec_setLoudspeakerAzi_deg(void* const hAmbi, int index, float newAzi_deg)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
     newAzi_deg = MAX(newAzi_deg, -180.0f);
     newAzi_deg = MIN(newAzi_deg, 180.0f);
-    pData->loudpkrs_dirs_deg[index][0] = newAzi_deg;
-    pData->reInitCodec=1;
-    pData->recalc_hrtf_interpFLAG[index] = 1;
+    up->loudpkrs_dirs_deg[index][0] = newAzi_deg;
+    saf_paramBlock_publish(pData->hUserPars);
+    ambi_dec_requestCodecInit(hAmbi);
 }
 
 void ambi_dec_setLoudspeakerElev_deg(void* const hAmbi, int index, float newElev_deg)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
     newElev_deg = MAX(newElev_deg, -90.0f);
     newElev_deg = MIN(newElev_deg, 90.0f);
-    pData->loudpkrs_dirs_deg[index][1] = newElev_deg;
-    pData->reInitCodec=1;
-    pData->recalc_hrtf_interpFLAG[index] = 1;
+    up->loudpkrs_dirs_deg[index][1] = newElev_deg;
+    saf_paramBlock_publish(pData->hUserPars);
+    ambi_dec_requestCodecInit(hAmbi);
 }
 
 void ambi_dec_setNumLoudspeakers(void* const hAmbi, int new_nLoudspeakers)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    int ch;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    int ch, new_nLoudpkrs;
     float sum_elev;
-    pData->new_nLoudpkrs = new_nLoudspeakers > MAX_NUM_LOUDSPEAKERS ? MAX_NUM_LOUDSPEAKERS : new_nLoudspeakers;
-    pData->new_nLoudpkrs = MAX(MIN_NUM_LOUDSPEAKERS, pData->new_nLoudpkrs);
-    if(pData->nLoudpkrs != pData->new_nLoudpkrs){
-        pData->reInitTFT = 1;
+    new_nLoudpkrs = new_nLoudspeakers > MAX_NUM_LOUDSPEAKERS ? MAX_NUM_LOUDSPEAKERS : new_nLoudspeakers;
+    new_nLoudpkrs = MAX(MIN_NUM_LOUDSPEAKERS, new_nLoudpkrs);
+    if(up->nLoudpkrs != new_nLoudpkrs){
+        up->nLoudpkrs = new_nLoudpkrs;
         /* check the new dimensionality before reinitialising the codec parameters */
         sum_elev = 0.0f;
-        for(ch=0; ch<pData->new_nLoudpkrs; ch++){
-            sum_elev += fabsf(pData->loudpkrs_dirs_deg[ch][1]);
+        for(ch=0; ch<up->nLoudpkrs; ch++){
+            sum_elev += fabsf(up->loudpkrs_dirs_deg[ch][1]);
         }
-        if( (((sum_elev < 5.0f) && (sum_elev > -5.0f))) || (pData->new_nLoudpkrs < 4) )
-            pData->loudpkrs_nDims = 2;
+        if( (((sum_elev < 5.0f) && (sum_elev > -5.0f))) || (up->nLoudpkrs < 4) )
+            up->loudpkrs_nDims = 2;
         else
-            pData->loudpkrs_nDims = 3;
-        pData->reInitCodec=1;
-        for(ch=0; ch<MAX_NUM_LOUDSPEAKERS; ch++)
-            pData->recalc_hrtf_interpFLAG[ch] = 1;
+            up->loudpkrs_nDims = 3;
+        saf_paramBlock_publish(pData->hUserPars);
+        ambi_dec_requestCodecInit(hAmbi);
     }
+    else
+        saf_paramBlock_release(pData->hUserPars);
 }
 
 void ambi_dec_setBinauraliseLSflag(void* const hAmbi, int newState)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
     
-    pData->new_binauraliseLS = newState;
-    if(pData->new_binauraliseLS != pData->binauraliseLS)
-        pData->reInitTFT = 1;
-    if(pData->new_binauraliseLS)
-        pData->reInitHRTFs = 1;
+    if(up->binauraliseLS != newState){
+        up->binauraliseLS = newState;
+        saf_paramBlock_publish(pData->hUserPars);
+    }
+    else
+        saf_paramBlock_release(pData->hUserPars);
+    if(newState)
+        ambi_dec_requestCodecInit(hAmbi);
 }
 
 void ambi_dec_setUseDefaultHRIRsflag(void* const hAmbi, int newState)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
     
-    if((!pData->useDefaultHRIRsFLAG) && (newState)){
-        pData->useDefaultHRIRsFLAG = newState;
-        pData->reInitHRTFs = 1;
+    if((!saf_atomic_loadi(&(pData->useDefaultHRIRsFLAG))) && (newState)){
+        saf_atomic_storei(&(pData->useDefaultHRIRsFLAG), newState);
+        ambi_dec_requestCodecInit(hAmbi);
     }
 }
 
 void ambi_dec_setSofaFilePath(void* const hAmbi, const char* path)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    codecPars* pars = pData->pars;
+    char* new_sofa_filepath;
     
-    pars->sofa_filepath = malloc(strlen(path) + 1);
-    strcpy(pars->sofa_filepath, path);
-    pData->useDefaultHRIRsFLAG = 0;
-    pData->reInitHRTFs = 1;
+    free(pData->sofa_filepath);
+    pData->sofa_filepath = malloc(strlen(path) + 1);
+    strcpy(pData->sofa_filepath, path);
+    /* hand a copy over to the worker thread; a copy it has not yet taken is no longer needed */
+    new_sofa_filepath = malloc(strlen(path) + 1);
+    strcpy(new_sofa_filepath, path);
+    free(saf_atomic_exchangep(&(pData->new_sofa_filepath), (void*)new_sofa_filepath));
+    saf_atomic_storei(&(pData->useDefaultHRIRsFLAG), 0);
+    ambi_dec_requestCodecInit(hAmbi);
 }
 
 void ambi_dec_setOutputConfigPreset(void* const hAmbi, int newPresetID)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    int ch;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
     
-    ambi_dec_loadPreset(newPresetID, pData->loudpkrs_dirs_deg, &(pData->new_nLoudpkrs), &(pData->loudpkrs_nDims));
-    if(pData->nLoudpkrs != pData->new_nLoudpkrs)
-        pData->reInitTFT = 1;
-    pData->reInitCodec = 1;
-    for(ch=0; ch<MAX_NUM_LOUDSPEAKERS; ch++)
-        pData->recalc_hrtf_interpFLAG[ch] = 1;
+    ambi_dec_loadPreset(newPresetID, up->loudpkrs_dirs_deg, &(up->nLoudpkrs), &(up->loudpkrs_nDims));
+    saf_paramBlock_publish(pData->hUserPars);
+    ambi_dec_requestCodecInit(hAmbi);
 }
 
 void ambi_dec_setSourcePreset(void* const hAmbi, int newPresetID)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
     int band, rangeIdx, curOrder, reverse;
     
     rangeIdx = 0;
@@ -509,7 +501,7 @@ void ambi_dec_setSourcePreset(void* const hAmbi, int newPresetID)
         /* Ideal spherical harmonics will have SH_ORDER at all frequencies */
         case MIC_PRESET_IDEAL:
             for(band=0; band<HYBRID_BANDS; band++)
-                pData->orderPerBand[band] = SH_ORDER;
+                up->orderPerBand[band] = SH_ORDER;
             break;
             
         /* For real microphone arrays, the maximum usable spherical harmonic order will depend on frequency  */
@@ -526,7 +518,7 @@ void ambi_dec_setSourcePreset(void* const hAmbi, int newPresetID)
                         rangeIdx++;
                     }
                 }
-                pData->orderPerBand[band] = MIN(SH_ORDER,curOrder);
+                up->orderPerBand[band] = MIN(SH_ORDER,curOrder);
             }
             break;
 #endif
@@ -544,7 +536,7 @@ void ambi_dec_setSourcePreset(void* const hAmbi, int newPresetID)
                         rangeIdx++;
                     }
                 }
-                pData->orderPerBand[band] = MIN(SH_ORDER,curOrder);
+                up->orderPerBand[band] = MIN(SH_ORDER,curOrder);
             }
             break;
 #endif
@@ -562,48 +554,61 @@ void ambi_dec_setSourcePreset(void* const hAmbi, int newPresetID)
                         rangeIdx++;
                     }
                 }
-                pData->orderPerBand[band] = MIN(SH_ORDER,curOrder);
+                up->orderPerBand[band] = MIN(SH_ORDER,curOrder);
             }
             break;
 #endif
     }
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_dec_setChOrder(void* const hAmbi, int newOrder)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    pData->chOrdering = (CH_ORDER)newOrder;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->chOrdering = (CH_ORDER)newOrder;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_dec_setNormType(void* const hAmbi, int newType)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    pData->norm = (NORM_TYPES)newType;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->norm = (NORM_TYPES)newType;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_dec_setDecMethod(void* const hAmbi, int index, int newID)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    pData->dec_method[index] = newID;
-    pData->reInitCodec = 1;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->dec_method[index] = newID;
+    saf_paramBlock_publish(pData->hUserPars);
+    ambi_dec_requestCodecInit(hAmbi);
 }
 
 void ambi_dec_setDecEnableMaxrE(void* const hAmbi, int index, int newID)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    pData->rE_WEIGHT[index] = newID;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->rE_WEIGHT[index] = newID;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_dec_setDecNormType(void* const hAmbi, int index, int newID)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    pData->diffEQmode[index] = newID;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->diffEQmode[index] = newID;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_dec_setTransitionFreq(void* const hAmbi, float newValue)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    pData->transitionFreq = newValue;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->transitionFreq = newValue;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 
@@ -612,13 +617,15 @@ void ambi_dec_setTransitionFreq(void* const hAmbi, float newValue)
 int ambi_dec_getDecOrder(void  * const hAmbi, int bandIdx)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    return pData->orderPerBand[bandIdx];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->orderPerBand[bandIdx];
 }
 
 int ambi_dec_getDecOrderAllBands(void  * const hAmbi)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    return pData->orderPerBand[0];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->orderPerBand[0];
 }
 
 void ambi_dec_getDecOrderHandle
@@ -630,9 +637,11 @@ void ambi_dec_getDecOrderHandle
 )
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
     (*pX_vector) = &pData->freqVector[0];
-    (*pY_values) = &pData->orderPerBand[0];
+    (*pY_values) = &up->orderPerBand[0]; /* edits made via the handle are published by "ambi_dec_refreshSettings" */
     (*pNpoints) = HYBRID_BANDS;
+    saf_paramBlock_release(pData->hUserPars);
 }
 
 int ambi_dec_getNumberOfBands(void)
@@ -643,19 +652,22 @@ int ambi_dec_getNumberOfBands(void)
 float ambi_dec_getLoudspeakerAzi_deg(void* const hAmbi, int index)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    return pData->loudpkrs_dirs_deg[index][0];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->loudpkrs_dirs_deg[index][0];
 }
 
 float ambi_dec_getLoudspeakerElev_deg(void* const hAmbi, int index)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    return pData->loudpkrs_dirs_deg[index][1];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->loudpkrs_dirs_deg[index][1];
 }
 
 int ambi_dec_getNumLoudspeakers(void* const hAmbi)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    return pData->nLoudpkrs;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->nLoudpkrs;
 }
 
 int ambi_dec_getMaxNumLoudspeakers()
@@ -666,21 +678,21 @@ int ambi_dec_getMaxNumLoudspeakers()
 int ambi_dec_getBinauraliseLSflag(void* const hAmbi)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    return pData->binauraliseLS;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->binauraliseLS;
 }
 
 int ambi_dec_getUseDefaultHRIRsflag(void* const hAmbi)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    return pData->useDefaultHRIRsFLAG;
+    return saf_atomic_loadi(&(pData->useDefaultHRIRsFLAG));
 }
 
 char* ambi_dec_getSofaFilePath(void* const hAmbi)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    codecPars* pars = pData->pars;
-    if(pars->sofa_filepath!=NULL)
-        return pars->sofa_filepath;
+    if(pData->sofa_filepath!=NULL)
+        return pData->sofa_filepath;
     else
         return "no_file";
 }
@@ -688,37 +700,54 @@ char* ambi_dec_getSofaFilePath(void* const hAmbi)
 int ambi_dec_getChOrder(void* const hAmbi)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    return (int)pData->chOrdering;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->chOrdering;
 }
 
 int ambi_dec_getNormType(void* const hAmbi)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    return (int)pData->norm;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->norm;
 }
 
 int ambi_dec_getDecMethod(void* const hAmbi, int index)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    return pData->dec_method[index];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->dec_method[index];
 }
 
 int ambi_dec_getDecEnableMaxrE(void* const hAmbi, int index)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    return pData->rE_WEIGHT[index];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->rE_WEIGHT[index];
 }
 
 int ambi_dec_getDecNormType(void* const hAmbi, int index)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    return pData->diffEQmode[index];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->diffEQmode[index];
 }
 
 float ambi_dec_getTransitionFreq(void* const hAmbi)
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    return pData->transitionFreq;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->transitionFreq;
+}
+
+int ambi_dec_getProcessingDelay(void)
+{
+    return afSTFTdelay(HOP_SIZE, 0, 1);
+}
+
+void* ambi_dec_getProfiler(void* const hAmbi)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    return pData->hProf;
 }
 
 
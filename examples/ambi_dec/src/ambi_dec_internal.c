@@ -40,36 +40,126 @@ static inline float matlab_fmodf(float x, float y) {
     return tmp >= 0 ? tmp : tmp + y;
 }
 
+void ambi_dec_requestCodecInit(void* const hAmbi)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    
+    saf_atomic_storei(&(pData->reInitCodec), 1);
+    saf_worker_post(pData->hWorker);
+}
+
+void ambi_dec_codecWorker(void* hAmbi)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    const userPars* up;
+    codecPars* pars, *next;
+    char* new_sofa_filepath;
+    
+    saf_atomic_storei(&(pData->reInitCodec), 2);
+    
+    /* free the codec parameters the audio thread is no longer using */
+    pars = (codecPars*)saf_atomic_exchangep(&(pData->retiredPars), NULL);
+    for(; pars!=NULL; pars = next){
+        next = pars->next;
+        ambi_dec_freeCodecPars(&pars);
+    }
+    
+    /* take ownership of a newly set sofa file path */
+    new_sofa_filepath = (char*)saf_atomic_exchangep(&(pData->new_sofa_filepath), NULL);
+    if(new_sofa_filepath!=NULL){
+        free(pData->worker_sofa_filepath);
+        pData->worker_sofa_filepath = new_sofa_filepath;
+    }
+    
+    /* build fresh codec parameters for a snapshot of the current configuration (if the configuration is changed in the
+     * meantime, the job is posted again and these will be superseded) */
+    up = (const userPars*)saf_paramBlock_read(pData->hUserPars, USER_PARS_WORKER);
+    pars = ambi_dec_createCodecPars();
+    pars->nLoudpkrs = up->nLoudpkrs;
+    memcpy(pars->loudpkrs_dirs_deg, up->loudpkrs_dirs_deg, MAX_NUM_LOUDSPEAKERS*2*sizeof(float));
+    memcpy(pars->dec_method, up->dec_method, NUM_DECODERS*sizeof(AMBI_DECODER_METHODS));
+    pars->binauraliseLS = up->binauraliseLS;
+    ambi_dec_initCodec(hAmbi, pars);
+    if(pars->binauraliseLS)
+        ambi_dec_initHRTFs(hAmbi, pars);
+    
+    /* publish them; if the audio thread never picked up the previously published ones, they are not needed anymore */
+    pars = (codecPars*)saf_atomic_exchangep(&(pData->pendingPars), (void*)pars);
+    ambi_dec_freeCodecPars(&pars);
+    
+    /* done, unless another reinitialisation has been requested in the meantime */
+    saf_atomic_casi(&(pData->reInitCodec), 2, 0);
+}
+
+codecPars* ambi_dec_createCodecPars(void)
+{
+    return (codecPars*)calloc(1, sizeof(codecPars));
+}
+
+void ambi_dec_freeCodecPars(codecPars** const ppars)
+{
+    codecPars* pars = *ppars;
+    int i, j;
+    
+    if(pars!=NULL){
+        hrtfResource_release(&(pars->hrtfRes));
+        for (i=0; i<NUM_DECODERS; i++){
+            for(j=0; j<SH_ORDER; j++){
+                free(pars->M_dec[i][j]);
+                free(pars->M_dec_cmplx[i][j]);
+                free(pars->M_dec_maxrE[i][j]);
+                free(pars->M_dec_cmplx_maxrE[i][j]);
+            }
+            free(pars->M_bin[i]);
+        }
+        free(pars);
+        *ppars = NULL;
+    }
+}
+
+void ambi_dec_retireCodecPars(void* const hAmbi, codecPars* const pars)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    void* head;
+    
+    if(pars==NULL)
+        return;
+    /* lock-free push; the worker thread only ever takes the whole list at once, so there is no ABA problem */
+    do{
+        head = saf_atomic_loadp(&(pData->retiredPars));
+        pars->next = (codecPars*)head;
+    } while(!saf_atomic_casp(&(pData->retiredPars), head, (void*)pars));
+}
+
 void ambi_dec_initCodec
 (
-    void* const hAmbi
+    void* const hAmbi,
+    codecPars* const pars
 )
 {
-    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    codecPars* pars = pData->pars;
     int i, d, j, n, ng, nGrid_dirs, nSH_order;
     float* grid_dirs_deg, *Y, *M_dec_tmp, *g, *a, *e, *a_n;
     float a_avg[SH_ORDER], e_avg[SH_ORDER];
     
     M_dec_tmp = NULL;
     nGrid_dirs = 480; /* Minimum t-design of degree 30, has 480 points */
-    g = malloc(pData->nLoudpkrs*sizeof(float));
+    g = malloc(pars->nLoudpkrs*sizeof(float));
     a = malloc(nGrid_dirs*sizeof(float));
     e = malloc(nGrid_dirs*sizeof(float));
     
     /* calculate loudspeaker decoding matrices */
     for( d=0; d<NUM_DECODERS; d++){
-        getAmbiDecoder((float*)pData->loudpkrs_dirs_deg, pData->nLoudpkrs, pData->dec_method[d], SH_ORDER, &(M_dec_tmp));
+        getAmbiDecoder((float*)pars->loudpkrs_dirs_deg, pars->nLoudpkrs, pars->dec_method[d], SH_ORDER, &(M_dec_tmp));
         
         /* diffuse-field EQ for orders 1..SH_ORDER */
         for( n=1; n<=SH_ORDER; n++){
             /* truncate M_dec for each order */
             nSH_order = (n+1)*(n+1);
             free(pars->M_dec[d][n-1]); 
-            pars->M_dec[d][n-1] = malloc(pData->nLoudpkrs * nSH_order * sizeof(float));
+            pars->M_dec[d][n-1] = malloc(pars->nLoudpkrs * nSH_order * sizeof(float));
             free(pars->M_dec_cmplx[d][n-1]);
-            pars->M_dec_cmplx[d][n-1] = malloc(pData->nLoudpkrs * nSH_order * sizeof(float_complex));
-            for(i=0; i<pData->nLoudpkrs; i++){
+            pars->M_dec_cmplx[d][n-1] = malloc(pars->nLoudpkrs * nSH_order * sizeof(float_complex));
+            for(i=0; i<pars->nLoudpkrs; i++){
                 for(j=0; j<nSH_order; j++){
                     pars->M_dec[d][n-1][i*nSH_order+j] = M_dec_tmp[i*MAX_NUM_SH_SIGNALS +j]; /* for applying in the time domain, and... */
                     pars->M_dec_cmplx[d][n-1][i*nSH_order+j] = cmplxf(pars->M_dec[d][n-1][i*nSH_order+j], 0.0f); /* for the time-frequency domain */
@@ -79,15 +169,17 @@ void ambi_dec_initCodec
             /* create dedicated maxrE weighted versions too (c'mon.. RAM is cheap nowadays) */
             a_n = malloc(nSH_order*nSH_order*sizeof(float));
             getMaxREweights(n, a_n); /* weights returned as diagonal matrix */
+            for(i=0; i<nSH_order; i++)
+                pars->maxrE_w[n-1][i] = a_n[i*nSH_order+i];
             free(pars->M_dec_maxrE[d][n-1]);
-            pars->M_dec_maxrE[d][n-1] = malloc(pData->nLoudpkrs * nSH_order * sizeof(float));
+            pars->M_dec_maxrE[d][n-1] = malloc(pars->nLoudpkrs * nSH_order * sizeof(float));
             free(pars->M_dec_cmplx_maxrE[d][n-1]);
-            pars->M_dec_cmplx_maxrE[d][n-1] = malloc(pData->nLoudpkrs * nSH_order * sizeof(float_complex));
-            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, pData->nLoudpkrs, nSH_order, nSH_order, 1.0f,
+            pars->M_dec_cmplx_maxrE[d][n-1] = malloc(pars->nLoudpkrs * nSH_order * sizeof(float_complex));
+            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, pars->nLoudpkrs, nSH_order, nSH_order, 1.0f,
                         pars->M_dec[d][n-1], nSH_order,
                         a_n, nSH_order, 0.0f,
                         pars->M_dec_maxrE[d][n-1], nSH_order); /* for applying in the time domain */
-            for(i=0; i<pData->nLoudpkrs * nSH_order; i++)
+            for(i=0; i<pars->nLoudpkrs * nSH_order; i++)
                 pars->M_dec_cmplx_maxrE[d][n-1][i] = cmplxf(pars->M_dec_maxrE[d][n-1][i], 0.0f); /* for the time-frequency domain */
             
             /* fire a plane-wave from each grid direction to find the total energy/amplitude (using non-maxrE weighted versions) */
@@ -95,12 +187,12 @@ void ambi_dec_initCodec
             grid_dirs_deg = (float*)(&__Tdesign_degree_30_dirs_deg[0][0]);
             for(ng=0; ng<nGrid_dirs; ng++){
                 getSHreal(n, grid_dirs_deg[ng*2]*M_PI/180.0f, M_PI/2.0f-grid_dirs_deg[ng*2+1]*M_PI/180.0f, Y);
-                cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, pData->nLoudpkrs, 1, nSH_order, 1.0f,
+                cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, pars->nLoudpkrs, 1, nSH_order, 1.0f,
                             pars->M_dec[d][n-1], nSH_order,
                             Y, nSH_order, 0.0f,
                             g, 1);
                 a[ng] = e[ng] = 0.0f;
-                for(i=0; i<pData->nLoudpkrs; i++){
+                for(i=0; i<pars->nLoudpkrs; i++){
                     a[ng] += g[i];
                     e[ng] += powf(g[i], 2.0f);
                 }
@@ -129,96 +221,63 @@ void ambi_dec_initCodec
 
 void ambi_dec_initHRTFs
 (
-    void* const hAmbi
+    void* const hAmbi,
+    codecPars* const pars
 )
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    codecPars* pars = pData->pars;
-    int i, j, k;
-    float* hrtf_vbap_gtable;
+    hrtfResource* hrtfRes;
+    int ch, d, band;
+    float_complex calpha;
+    const float_complex cbeta = cmplxf(0.0f, 0.0f);
     
-    /* load sofa file or load default hrir data */
-    if(!pData->useDefaultHRIRsFLAG && pars->sofa_filepath!=NULL){
+    /* acquire the HRTF data for the sofa file or the default HRIR set; this is loaded and processed only once, and
+     * then shared (read-only) with any other instance using the same HRIRs */
+    hrtfRes = NULL;
 #ifdef SAF_ENABLE_SOFA_READER
-        loadSofaFile(pars->sofa_filepath,
-                     &pars->hrirs,
-                     &pars->hrir_dirs_deg,
-                     &pars->N_hrir_dirs,
-                     &pars->hrir_len,
-                     &pars->hrir_fs);
-        if((pars->hrirs==NULL) || (pars->hrir_dirs_deg == NULL))
-            pData->useDefaultHRIRsFLAG = 1;
-#else
-        pData->useDefaultHRIRsFLAG = 1;
+    if(!saf_atomic_loadi(&(pData->useDefaultHRIRsFLAG)) && pData->worker_sofa_filepath!=NULL)
+        hrtfResource_acquire(pData->worker_sofa_filepath, loadSofaFile, (float*)pData->freqVector, HYBRID_BANDS, &hrtfRes);
 #endif
+    if(hrtfRes==NULL){
+        /* the sofa file could not be loaded or triangulated, use the default HRIR set */
+        saf_atomic_storei(&(pData->useDefaultHRIRsFLAG), 1);
+        hrtfResource_acquire(NULL, NULL, (float*)pData->freqVector, HYBRID_BANDS, &hrtfRes);
     }
-    if(pData->useDefaultHRIRsFLAG){
-        /* load defaults */
-        pars->N_hrir_dirs = __default_N_hrir_dirs;
-        pars->hrir_len = __default_hrir_len;
-        pars->hrir_fs = __default_hrir_fs;
-        if(pars->hrirs != NULL)
-            free(pars->hrirs);
-        pars->hrirs = malloc(pars->N_hrir_dirs * 2 * (pars->hrir_len)*sizeof(float));
-        for(i=0; i<pars->N_hrir_dirs; i++)
-            for(j=0; j<2; j++)
-                for(k=0; k< pars->hrir_len; k++)
-                    pars->hrirs[i*2*(pars->hrir_len) + j*(pars->hrir_len) + k] = (float)__default_hrirs[i][j][k];
-        if(pars->hrir_dirs_deg != NULL)
-            free(pars->hrir_dirs_deg);
-        pars->hrir_dirs_deg = malloc(pars->N_hrir_dirs * 2 * sizeof(float));
-        for(i=0; i<pars->N_hrir_dirs; i++)
-            for(j=0; j<2; j++)
-                pars->hrir_dirs_deg[i*2+j] = (float)__default_hrir_dirs_deg[i][j];
-    }
+    hrtfResource_release(&(pars->hrtfRes));
+    pars->hrtfRes = hrtfRes;
+    pars->hrir_dirs_deg = hrtfRes->hrir_dirs_deg;
+    pars->N_hrir_dirs = hrtfRes->N_hrir_dirs;
+    pars->hrir_len = hrtfRes->hrir_len;
+    pars->hrir_fs = hrtfRes->hrir_fs;
+    pars->itds_s = hrtfRes->itds_s;
+    pars->hrtf_fb = hrtfRes->hrtf_fb;
+    pars->hrtf_fb_mag = hrtfRes->hrtf_fb_mag;
+    pars->hrtf_vbapTableRes[0] = hrtfRes->hrtf_vbapTableRes[0];
+    pars->hrtf_vbapTableRes[1] = hrtfRes->hrtf_vbapTableRes[1];
+    pars->N_hrtf_vbap_gtable = hrtfRes->N_hrtf_vbap_gtable;
+    pars->hrtf_nTriangles = hrtfRes->hrtf_nTriangles;
+    pars->hrtf_vbap_gtableIdx = hrtfRes->hrtf_vbap_gtableIdx;
+    pars->hrtf_vbap_gtableComp = hrtfRes->hrtf_vbap_gtableComp;
     
-    /* estimate the ITDs for each HRIR */
-    if(pars->itds_s!= NULL){
-        free(pars->itds_s);
-        pars->itds_s = NULL;
-    }
-    estimateITDs(pars->hrirs, pars->N_hrir_dirs, pars->hrir_len, pars->hrir_fs, &(pars->itds_s));
+    /* interpolate the HRTFs for each loudspeaker direction */
+    for(ch=0; ch<pars->nLoudpkrs; ch++)
+        ambi_dec_interpHRTFs(pars, pars->loudpkrs_dirs_deg[ch][0], pars->loudpkrs_dirs_deg[ch][1], pars->hrtf_interp[ch]);
     
-    /* generate VBAP gain table for the hrir_dirs */
-    hrtf_vbap_gtable = NULL;
-    pars->hrtf_vbapTableRes[0] = 2; /* azimuth resolution in degrees */
-    pars->hrtf_vbapTableRes[1] = 5; /* elevation resolution in degrees */
-    generateVBAPgainTable3D(pars->hrir_dirs_deg, pars->N_hrir_dirs, pars->hrtf_vbapTableRes[0], pars->hrtf_vbapTableRes[1], 1, 0,
-                            &hrtf_vbap_gtable, &(pars->N_hrtf_vbap_gtable), &(pars->hrtf_nTriangles));
-    if(hrtf_vbap_gtable==NULL){
-        /* if generating vbap gain tabled failed, re-calculate with default HRIR set (which is known to triangulate correctly) */
-        pData->useDefaultHRIRsFLAG = 1;
-        ambi_dec_initHRTFs(hAmbi);
-    }
-    
-    /* compress VBAP table (i.e. remove the zero elements) */
-    if(pars->hrtf_vbap_gtableComp!= NULL){
-        free(pars->hrtf_vbap_gtableComp);
-        pars->hrtf_vbap_gtableComp = NULL;
-    }
-    if(pars->hrtf_vbap_gtableIdx!= NULL){
-        free(pars->hrtf_vbap_gtableIdx);
-        pars->hrtf_vbap_gtableIdx = NULL;
+    /* fold the HRTFs into the highest order decoders, to decode straight to the ears (NUM_EARS x nSH per band, instead
+     * of nLoudspeakers x nSH followed by nLoudspeakers x NUM_EARS). The lower order decoders are truncated versions of
+     * these, and the maxrE weights and normalisation are per SH channel and scalar, respectively; so these are applied
+     * on the fly, and only a change of loudspeakers, decoding method or HRTFs (i.e. new codec parameters) requires
+     * refolding */
+    calpha = cmplxf(1.0f/sqrtf((float)pars->nLoudpkrs), 0.0f);
+    for(d=0; d<NUM_DECODERS; d++){
+        free(pars->M_bin[d]);
+        pars->M_bin[d] = malloc(HYBRID_BANDS*NUM_EARS*MAX_NUM_SH_SIGNALS*sizeof(float_complex));
+        for(band=0; band<HYBRID_BANDS; band++)
+            utility_cgemm(TRANSPOSE, NO_TRANSPOSE, NUM_EARS, MAX_NUM_SH_SIGNALS, pars->nLoudpkrs, calpha,
+                          &(pars->hrtf_interp[0][band][0]), HYBRID_BANDS*NUM_EARS,
+                          pars->M_dec_cmplx[d][SH_ORDER-1], MAX_NUM_SH_SIGNALS, cbeta,
+                          &(pars->M_bin[d][band*NUM_EARS*MAX_NUM_SH_SIGNALS]), MAX_NUM_SH_SIGNALS);
     }
-    compressVBAPgainTable3D(hrtf_vbap_gtable, pars->N_hrtf_vbap_gtable, pars->N_hrir_dirs, &(pars->hrtf_vbap_gtableComp), &(pars->hrtf_vbap_gtableIdx));
-    
-    /* convert hrirs to filterbank coefficients */
-    if(pars->hrtf_fb!= NULL){
-        free(pars->hrtf_fb);
-        pars->hrtf_fb = NULL;
-    }
-    HRIRs2FilterbankHRTFs(pars->hrirs, pars->N_hrir_dirs, pars->hrir_len, pars->itds_s, (float*)pData->freqVector, HYBRID_BANDS, &(pars->hrtf_fb));
-    
-    /* calculate magnitude responses */
-    if(pars->hrtf_fb_mag!= NULL)
-        free(pars->hrtf_fb_mag);
-    pars->hrtf_fb_mag = malloc(HYBRID_BANDS*NUM_EARS* (pars->N_hrir_dirs)*sizeof(float));
-    for(i=0; i<HYBRID_BANDS*NUM_EARS* (pars->N_hrir_dirs); i++)
-        pars->hrtf_fb_mag[i] = cabsf(pars->hrtf_fb[i]);
-    
-    /* clean-up */
-    if(hrtf_vbap_gtable!=NULL)
-        free(hrtf_vbap_gtable);
 }
 
 void ambi_dec_initTFT
@@ -228,72 +287,38 @@ void ambi_dec_initTFT
 {
     ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
     int t, ch;
-
-    /* free afSTFT + buffers, if already allocated */
-    if (pData->hSTFT != NULL){
-        afSTFTfree(pData->hSTFT);
-        pData->hSTFT = NULL;
-        if(pData->binauraliseLS){
-            for (t = 0; t<TIME_SLOTS; t++) {
-                for (ch = 0; ch< NUM_EARS; ch++) {
-                    free(pData->STFTOutputFrameTF[t][ch].re);
-                    free(pData->STFTOutputFrameTF[t][ch].im);
-                }
-            }
-            free2d((void**)pData->tempHopFrameTD, MAX(MAX_NUM_SH_SIGNALS, NUM_EARS));
-        }
-        else{
-            for (t = 0; t<TIME_SLOTS; t++) {
-                for (ch = 0; ch< pData->nLoudpkrs; ch++) {
-                    free(pData->STFTOutputFrameTF[t][ch].re);
-                    free(pData->STFTOutputFrameTF[t][ch].im);
-                }
-            }
-            free2d((void**)pData->tempHopFrameTD, MAX(MAX_NUM_SH_SIGNALS, pData->nLoudpkrs));
-        }
-        free2d((void**)pData->STFTOutputFrameTF, TIME_SLOTS);
-    }
-    
-    /* reallocate afSTFT + buffers */
-    if (pData->hSTFT == NULL){
-        if(pData->new_binauraliseLS){
-            afSTFTinit(&(pData->hSTFT), HOP_SIZE, MAX_NUM_SH_SIGNALS, NUM_EARS, 0, 1);
-            pData->STFTOutputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, NUM_EARS, sizeof(complexVector));
-            for(t=0; t<TIME_SLOTS; t++) {
-                for(ch=0; ch< NUM_EARS; ch++) {
-                    pData->STFTOutputFrameTF[t][ch].re = (float*)calloc(HYBRID_BANDS, sizeof(float));
-                    pData->STFTOutputFrameTF[t][ch].im = (float*)calloc(HYBRID_BANDS, sizeof(float));
-                }
-            }
-            pData->tempHopFrameTD = (float**)malloc2d( MAX(MAX_NUM_SH_SIGNALS, NUM_EARS), HOP_SIZE, sizeof(float));
-            pData->nLoudpkrs = pData->new_nLoudpkrs;
+
+    /* afSTFT + buffers for the maximum number of SH signals and loudspeakers; "ambi_dec_process" only inverse-transforms
+     * the outputs in use, so changing the number of loudspeakers (or binauralising) does not require reallocating them,
+     * and the filterbank memory of the outputs carries over the change */
+    afSTFTinit(&(pData->hSTFT), HOP_SIZE, MAX_NUM_SH_SIGNALS, MAX_NUM_LOUDSPEAKERS, 0, 1);
+    pData->STFTInputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, MAX_NUM_SH_SIGNALS, sizeof(complexVector));
+    for(t=0; t<TIME_SLOTS; t++) {
+        for(ch=0; ch< MAX_NUM_SH_SIGNALS; ch++) {
+            pData->STFTInputFrameTF[t][ch].re = (float*)calloc(HYBRID_BANDS, sizeof(float));
+            pData->STFTInputFrameTF[t][ch].im = (float*)calloc(HYBRID_BANDS, sizeof(float));
         }
-        else{
-            afSTFTinit(&(pData->hSTFT), HOP_SIZE, MAX_NUM_SH_SIGNALS, pData->new_nLoudpkrs, 0, 1);
-            pData->STFTOutputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, pData->new_nLoudpkrs, sizeof(complexVector));
-            for(t=0; t<TIME_SLOTS; t++) {
-                for(ch=0; ch< pData->new_nLoudpkrs; ch++) {
-                    pData->STFTOutputFrameTF[t][ch].re = (float*)calloc(HYBRID_BANDS, sizeof(float));
-                    pData->STFTOutputFrameTF[t][ch].im = (float*)calloc(HYBRID_BANDS, sizeof(float));
-                }
-            }
-            pData->tempHopFrameTD = (float**)malloc2d( MAX(MAX_NUM_SH_SIGNALS, pData->new_nLoudpkrs), HOP_SIZE, sizeof(float));
-            pData->nLoudpkrs = pData->new_nLoudpkrs;
+    }
+    pData->STFTOutputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, MAX_NUM_LOUDSPEAKERS, sizeof(complexVector));
+    for(t=0; t<TIME_SLOTS; t++) {
+        for(ch=0; ch< MAX_NUM_LOUDSPEAKERS; ch++) {
+            pData->STFTOutputFrameTF[t][ch].re = (float*)calloc(HYBRID_BANDS, sizeof(float));
+            pData->STFTOutputFrameTF[t][ch].im = (float*)calloc(HYBRID_BANDS, sizeof(float));
         }
-        pData->binauraliseLS = pData->new_binauraliseLS;
     }
+    pData->tempHopFrameTD = (float**)malloc2d( MAX(MAX_NUM_SH_SIGNALS, MAX_NUM_LOUDSPEAKERS), HOP_SIZE, sizeof(float));
+    pData->nOutputsTF = 0;
+    pData->nSilentSamples = 0;
 }
 
 void ambi_dec_interpHRTFs
 (
-    void* const hAmbi,
+    codecPars* const pars,
     float azimuth_deg,
     float elevation_deg,
     float_complex h_intrp[HYBRID_BANDS][NUM_EARS]
 )
 {
-    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
-    codecPars* pars = pData->pars;
     int i, band;
     int aziIndex, elevIndex, N_azi, idx3d;
     float_complex ipd;
@@ -320,25 +345,80 @@ void ambi_dec_interpHRTFs
     }
     
     /* interpolate hrtf magnitudes and itd seperately */
-    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 1, 1, 3, 1,
-                (float*)weights, 3,
-                (float*)itds3, 1, 0,
-                (float*)itdInterp, 1);
+    utility_sgemm(NO_TRANSPOSE, NO_TRANSPOSE, 1, 1, 3, 1,
+                  (float*)weights, 3,
+                  (float*)itds3, 1, 0,
+                  (float*)itdInterp, 1);
     for (band = 0; band < HYBRID_BANDS; band++) {
-        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 1, 2, 3, 1,
-                    (float*)weights, 3,
-                    (float*)magnitudes3[band], 2, 0,
-                    (float*)magInterp[band], 2);
+        utility_sgemm(NO_TRANSPOSE, NO_TRANSPOSE, 1, 2, 3, 1,
+                      (float*)weights, 3,
+                      (float*)magnitudes3[band], 2, 0,
+                      (float*)magInterp[band], 2);
     }
     
     /* reintroduce the interaural phase difference per band */
     for (band = 0; band < HYBRID_BANDS; band++) {
-        ipd = cmplxf(0.0f, (matlab_fmodf(2.0f*PI* (pData->freqVector[band]) * itdInterp[0] + PI, 2.0f*PI) - PI) / 2.0f);
+        ipd = cmplxf(0.0f, (matlab_fmodf(2.0f*PI* (pars->hrtfRes->centreFreq[band]) * itdInterp[0] + PI, 2.0f*PI) - PI) / 2.0f);
         h_intrp[band][0] = ccmulf(cmplxf(magInterp[band][0], 0.0f), cexpf(ipd));
         h_intrp[band][1] = ccmulf(cmplxf(magInterp[band][1], 0.0f), conjf(cexpf(ipd)));
     }
 }
 
+void ambi_dec_decodeBand
+(
+    void* const hAmbi,
+    const userPars* up,
+    codecPars* const pars,
+    int binauraliseLS,
+    int band,
+    float_complex outputframeTF[MAX_NUM_LOUDSPEAKERS][TIME_SLOTS]
+)
+{
+    ambi_dec_data *pData = (ambi_dec_data*)(hAmbi);
+    int t, ear, i, orderBand, nSH_band, decIdx, nLoudspeakers;
+    float norm;
+    float_complex* M_bin_band;
+    float_complex M_bin_w[NUM_EARS][MAX_NUM_SH_SIGNALS];
+    const float_complex calpha = cmplxf(1.0f,0.0f), cbeta = cmplxf(0.0f, 0.0f);
+    
+    nLoudspeakers = pars->nLoudpkrs;
+    orderBand = MAX(MIN(up->orderPerBand[band], SH_ORDER),1);
+    nSH_band = (orderBand+1)*(orderBand+1);
+    decIdx = pData->freqVector[band] < up->transitionFreq ? 0 : 1; /* different decoder for low (0) and high (1) frequencies */
+    norm = pars->M_norm[decIdx][orderBand-1][up->diffEQmode[decIdx]==AMPLITUDE_PRESERVING ? 0 : 1];
+    
+    /* Decode directly to the ears, with the binaural decoding matrix truncated to this band's order, and weighted */
+    if(binauraliseLS){
+        M_bin_band = &(pars->M_bin[decIdx][band*NUM_EARS*MAX_NUM_SH_SIGNALS]);
+        for(ear=0; ear<NUM_EARS; ear++)
+            for(i=0; i<nSH_band; i++)
+                M_bin_w[ear][i] = crmulf(M_bin_band[ear*MAX_NUM_SH_SIGNALS+i],
+                                         up->rE_WEIGHT[decIdx] ? norm*pars->maxrE_w[orderBand-1][i] : norm);
+        utility_cgemm(NO_TRANSPOSE, NO_TRANSPOSE, NUM_EARS, TIME_SLOTS, nSH_band, calpha,
+                      (float_complex*)M_bin_w, MAX_NUM_SH_SIGNALS,
+                      (float_complex*)pData->SHframeTF[band], TIME_SLOTS, cbeta,
+                      (float_complex*)outputframeTF, TIME_SLOTS);
+        return;
+    }
+    
+    /* Decode to loudspeaker set-up */
+    if(up->rE_WEIGHT[decIdx]){
+        utility_cgemm(NO_TRANSPOSE, NO_TRANSPOSE, nLoudspeakers, TIME_SLOTS, nSH_band, calpha,
+                      pars->M_dec_cmplx_maxrE[decIdx][orderBand-1], nSH_band,
+                      (float_complex*)pData->SHframeTF[band], TIME_SLOTS, cbeta,
+                      (float_complex*)outputframeTF, TIME_SLOTS);
+    }
+    else{
+        utility_cgemm(NO_TRANSPOSE, NO_TRANSPOSE, nLoudspeakers, TIME_SLOTS, nSH_band, calpha,
+                      pars->M_dec_cmplx[decIdx][orderBand-1], nSH_band,
+                      (float_complex*)pData->SHframeTF[band], TIME_SLOTS, cbeta,
+                      (float_complex*)outputframeTF, TIME_SLOTS);
+    }
+    for(i=0; i<nLoudspeakers; i++)
+        for(t=0; t<TIME_SLOTS; t++)
+            outputframeTF[i][t] = crmulf(outputframeTF[i][t], norm);
+}
+
 void ambi_dec_loadPreset(PRESETS preset, float dirs_deg[MAX_NUM_LOUDSPEAKERS][2], int* newNCH, int* nDims)
 {
     float sum_elev;
@@ -36,7 +36,6 @@
 #include <math.h>
 #include <string.h>
 #include "ambi_dec.h"
-#include "ambi_dec_database.h"
 #define SAF_ENABLE_AFSTFT   /* for time-frequency transform */
 #define SAF_ENABLE_HOA      /* for ambisonic decoding matrices */
 #define SAF_ENABLE_SH       /* for spherical harmonic weights */
@@ -62,6 +61,8 @@ extern "C" {
 #define MIN_NUM_LOUDSPEAKERS ( 4 )                          /* To help avoid traingulation errors when using AllRAD */
 #define NUM_EARS ( 2 )                                      /* true for most humans */
 #define NUM_DECODERS ( 2 )                                  /* one for low-frequencies and another for high-frequencies */
+#define USER_PARS_AUDIO ( 0 )                               /* user parameter block reader index of the audio thread */
+#define USER_PARS_WORKER ( 1 )                              /* user parameter block reader index of the worker thread */
     
 typedef enum _CH_ORDER{
     CH_ACN = 1
@@ -77,18 +78,40 @@ typedef enum _NORM_TYPES{
 /* Structs */
 /***********/
     
+typedef struct _userPars
+{
+    int orderPerBand[HYBRID_BANDS];                           /* Ambisonic decoding order per frequency band 1..SH_ORDER */
+    AMBI_DECODER_METHODS dec_method[NUM_DECODERS];            /* decoding methods for each decoder, see "AMBI_DECODER_METHODS" enum */
+    int rE_WEIGHT[NUM_DECODERS];                              /* 0:disabled, 1: enable max_rE weight */
+    DIFFUSE_FIELD_EQ_APPROACH diffEQmode[NUM_DECODERS];       /* diffuse-field EQ approach; see "DIFFUSE_FIELD_EQ_APPROACH" enum */
+    float transitionFreq;                                     /* transition frequency for the 2 decoders, in Hz */
+    int nLoudpkrs;                                            /* number of loudspeakers/virtual loudspeakers */
+    int loudpkrs_nDims;                                       /* dimensionality of the loudspeaker set-up */
+    float loudpkrs_dirs_deg[MAX_NUM_LOUDSPEAKERS][2];         /* loudspeaker directions in degrees [azi, elev] */
+    int binauraliseLS;                                        /* 1: convolve loudspeaker signals with HRTFs, 0: output loudspeaker signals */
+    CH_ORDER chOrdering;                                      /* only ACN is supported */
+    NORM_TYPES norm;                                          /* N3D or SN3D */
+    
+}userPars;
+    
 typedef struct _codecPars
 {
+    /* configuration the codec parameters were built for */
+    int nLoudpkrs;                                            /* number of loudspeakers/virtual loudspeakers */
+    float loudpkrs_dirs_deg[MAX_NUM_LOUDSPEAKERS][2];         /* loudspeaker directions in degrees [azi, elev] */
+    AMBI_DECODER_METHODS dec_method[NUM_DECODERS];            /* decoding methods for each decoder */
+    int binauraliseLS;                                        /* 1: HRTFs were also initialised, 0: loudspeaker decoding only */
+    
     /* decoders */
     float* M_dec[NUM_DECODERS][SH_ORDER];                     /* ambisonic decoding matrices ([0] for low-freq, [1] for high-freq); FLAT: nLoudspeakers x nSH */
     float_complex* M_dec_cmplx[NUM_DECODERS][SH_ORDER];       /* complex ambisonic decoding matrices ([0] for low-freq, [1] for high-freq); FLAT: nLoudspeakers x nSH */
     float* M_dec_maxrE[NUM_DECODERS][SH_ORDER];               /* ambisonic decoding matrices with maxrE weighting ([0] for low-freq, [1] for high-freq); FLAT: nLoudspeakers x nSH */
     float_complex* M_dec_cmplx_maxrE[NUM_DECODERS][SH_ORDER]; /* complex ambisonic decoding matrices with maxrE weighting ([0] for low-freq, [1] for high-freq); FLAT: nLoudspeakers x nSH */
     float M_norm[NUM_DECODERS][SH_ORDER][2];                  /* norm coefficients to preserve omni energy/amplitude between different orders and decoders */
+    float maxrE_w[SH_ORDER][MAX_NUM_SH_SIGNALS];              /* maxrE weights for each order (the diagonals of "getMaxREweights"); the rest are 0 */
     
     /* sofa file info */
-    char* sofa_filepath;                                      /* absolute/relevative file path for a sofa file */
-    float* hrirs;                                             /* time domain HRIRs; N_hrir_dirs x 2 x hrir_len */
+    hrtfResource* hrtfRes;                                    /* shared HRTF data; the HRIR/HRTF pointers below all reference it (do not free) */
     float* hrir_dirs_deg;                                     /* directions of the HRIRs in degrees [azi elev]; N_hrir_dirs x 2 */
     int N_hrir_dirs;                                          /* number of HRIR directions in the current sofa file */
     int hrir_len;                                             /* length of the HRIRs, this can be truncated, see "saf_sofa_reader.h" */
@@ -106,6 +129,9 @@ typedef struct _codecPars
     float_complex* hrtf_fb;                                   /* HRTF filterbank coefficients; nBands x nCH x N_hrirs */
     float* hrtf_fb_mag;                                       /* magnitudes of the HRTF filterbank coefficients; nBands x nCH x N_hrirs */
     float_complex hrtf_interp[MAX_NUM_LOUDSPEAKERS][HYBRID_BANDS][NUM_EARS]; /* interpolated HRTFs */
+    float_complex* M_bin[NUM_DECODERS];                       /* binaural decoding matrices, i.e. the highest order decoders with the interpolated HRTFs (and 1/sqrt(nLoudspeakers)) folded in; FLAT: HYBRID_BANDS x NUM_EARS x MAX_NUM_SH_SIGNALS */
+    
+    struct _codecPars* next;                                  /* next entry in the list of retired codec parameters */
     
 }codecPars;
 
@@ -113,69 +139,115 @@ typedef struct _ambi_dec
 {
     /* audio buffers + afSTFT time-frequency transform handle */
     float SHFrameTD[MAX_NUM_SH_SIGNALS][FRAME_SIZE]; 
-    float_complex* SHframeTF[SH_ORDER][HYBRID_BANDS];         /* Frame per order; SH_ORDER x nBands x [ FLAT: (order+1)^2 x TIME_SLOTS ] */
-    float_complex outputframeTF[HYBRID_BANDS][MAX_NUM_LOUDSPEAKERS][TIME_SLOTS];
-    float_complex binframeTF[HYBRID_BANDS][NUM_EARS][TIME_SLOTS];
+    float_complex SHframeTF[HYBRID_BANDS][MAX_NUM_SH_SIGNALS][TIME_SLOTS]; /* lower orders are decoded from the leading (order+1)^2 channels */
+    float_complex outputframeTF[HYBRID_BANDS][MAX_NUM_LOUDSPEAKERS][TIME_SLOTS]; /* loudspeaker signals, or the ear signals in the first NUM_EARS rows if binauralising */
+    float_complex outputframeTF_prev[HYBRID_BANDS][MAX_NUM_LOUDSPEAKERS][TIME_SLOTS]; /* decoded with the previous codec parameters and/or output configuration */
     complexVector** STFTInputFrameTF;
     complexVector** STFTOutputFrameTF;
-    void* hSTFT;                                              /* afSTFT handle */
+    void* hSTFT;                                              /* afSTFT handle; MAX_NUM_SH_SIGNALS inputs and MAX_NUM_LOUDSPEAKERS outputs */
+    int nOutputsTF;                                           /* number of outputs currently inverse-transformed (audio thread) */
+    int nSilentSamples;                                       /* number of samples the outputs above those in use have been silent for (audio thread) */
     int afSTFTdelay;                                          /* for host delay compensation */
     float** tempHopFrameTD;                                   /* temporary multi-channel time-domain buffer of size "HOP_SIZE". */
     int fs;                                                   /* host sampling rate */
     float freqVector[HYBRID_BANDS];                           /* frequency vector for time-frequency transform, in Hz */
     
     /* our codec configuration */
-    codecPars* pars;                                          /* codec parameters */
+    codecPars* pars;                                          /* codec parameters currently used for rendering (audio thread only) */
+    void* volatile pendingPars;                               /* new codec parameters published by the worker thread (codecPars*) */
+    void* volatile retiredPars;                               /* codec parameters no longer used by the audio thread, freed by the worker thread (codecPars*) */
+    void* hWorker;                                            /* worker thread, which (re)initialises the codec parameters */
+    
+    /* sofa file info */
+    char* sofa_filepath;                                      /* absolute/relevative file path for a sofa file */
+    void* volatile new_sofa_filepath;                         /* copy of a newly set sofa file path, handed over to the worker thread (char*) */
+    char* worker_sofa_filepath;                               /* the worker thread's copy of the sofa file path */
     
     /* internal variables */
-    int new_nLoudpkrs;                                        /* if new_nLoudpkrs != nLoudpkrs, afSTFT is reinitialised */
-    int loudpkrs_nDims;                                       /* dimensionality of the current loudspeaker set-up */
-    int new_binauraliseLS;                                    /* if new_binauraliseLS != binauraliseLS, ambi_dec is reinitialised */
+    int binauraliseLS;                                        /* binauralisation state of the previous frame (audio thread) */
     
     /* flags */
-    int recalc_hrtf_interpFLAG[MAX_NUM_LOUDSPEAKERS];         /* 0: no init required, 1: init required */
-    int reInitCodec;                                          /* 0: no init required, 1: init required, 2: init in progress */
-    int reInitTFT;                                            /* 0: no init required, 1: init required, 2: init in progress */
-    int reInitHRTFs;                                          /* 0: no init required, 1: init required, 2: init in progress */
+    volatile int reInitCodec;                                 /* 0: no init required, 1: init required, 2: init in progress (decoders+HRTFs, on the worker thread) */
+    int applyFadeIn;                                          /* 1: fade-in the next rendered frame, as the output was muted */
     
     /* user parameters */
-    int orderPerBand[HYBRID_BANDS];                           /* Ambisonic decoding order per frequency band 1..SH_ORDER */
-    AMBI_DECODER_METHODS dec_method[NUM_DECODERS];            /* decoding methods for each decoder, see "AMBI_DECODER_METHODS" enum */
-    int rE_WEIGHT[NUM_DECODERS];                              /* 0:disabled, 1: enable max_rE weight */
-    DIFFUSE_FIELD_EQ_APPROACH diffEQmode[NUM_DECODERS];       /* diffuse-field EQ approach; see "DIFFUSE_FIELD_EQ_APPROACH" enum */
-    float transitionFreq;                                     /* transition frequency for the 2 decoders, in Hz */
-    int nLoudpkrs;                                            /* number of loudspeakers/virtual loudspeakers */
-    float loudpkrs_dirs_deg[MAX_NUM_LOUDSPEAKERS][NUM_DECODERS]; /* loudspeaker directions in degrees [azi, elev] */
-    int useDefaultHRIRsFLAG;                                  /* 1: use default HRIRs in database, 0: use those from SOFA file */
-    int binauraliseLS;                                        /* 1: convolve loudspeaker signals with HRTFs, 0: output loudspeaker signals */
-    CH_ORDER chOrdering;                                      /* only ACN is supported */
-    NORM_TYPES norm;                                          /* N3D or SN3D */
+    void* hUserPars;                                          /* parameter block of "userPars"; edited by the set functions, read by the audio and worker threads */
+    userPars prevUp;                                          /* the audio thread's snapshot of the previous frame, to crossfade changes of the decoding settings */
+    volatile int useDefaultHRIRsFLAG;                         /* 1: use default HRIRs in database, 0: use those from SOFA file */
+    void* hProf;                                              /* per-stage timing of the processing loop (see saf_profiler.h) */
+    void* volatile hPool;                                     /* thread pool for decoding the bands in parallel (see saf_threads.h); NULL: none */
     
 } ambi_dec_data;
 
+/* arguments of the band-parallel decoding of one frame (see "ambi_dec_process") */
+typedef struct _ambi_dec_frameArgs
+{
+    void* hAmbi;                                              /* ambi_dec handle */
+    const userPars* up;                                       /* snapshot of the user parameters */
+    codecPars* pars;                                          /* codec parameters to decode with */
+    codecPars* prevPars;                                      /* previous codec parameters to crossfade from; NULL: none */
+    const userPars* prevUp;                                   /* user parameters of the previous frame to crossfade from; NULL: none */
+    int binauraliseLS;                                        /* 1: binauralise the loudspeaker signals, 0: do not */
+    int prevBinauraliseLS;                                    /* binauralisation state of the previous frame */
+    int crossfade;                                            /* 1: crossfade from the previous codec parameters, decoding settings and/or binauralisation state */
+    int nOutputs;                                             /* number of outputs (loudspeakers or ears) decoded */
+    int nPrevOutputs;                                         /* number of outputs decoded with the previous frame's configuration */
+    int nOutputsTF;                                           /* number of outputs inverse-transformed; those not decoded are zeroed */
+    
+}ambi_dec_frameArgs;
+
 
 /**********************/
 /* Internal functions */
 /**********************/
     
-/* Intialises the codec parameters */
-/* Note: take care to initalise time-frequency transform "ambi_dec_initTFT" first */
-void ambi_dec_initCodec(void* const hAmbi);                   /* ambi_dec handle */
+/* Flags the codec parameters for reinitialisation, which is carried out on the worker thread. Not for the audio thread */
+void ambi_dec_requestCodecInit(void* const hAmbi);            /* ambi_dec handle */
+
+/* Worker thread job: builds a fresh set of codec parameters for the current configuration and publishes them to the
+ * audio thread. Also frees any codec parameters the audio thread has since retired */
+void ambi_dec_codecWorker(void* hAmbi);                       /* ambi_dec handle */
+
+/* Allocates an empty set of codec parameters */
+codecPars* ambi_dec_createCodecPars(void);
 
-/* Intialises the hrtf filterbank coefficients and vbap look-up tables */
-/* Note: take care to initalise time-frequency transform "ambi_dec_initTFT" first */
-void ambi_dec_initHRTFs(void* const hAmbi);                   /* ambi_dec handle */
+/* Frees a set of codec parameters (releasing its HRTFs) */
+void ambi_dec_freeCodecPars(codecPars** const ppars);         /* & address of codec parameters */
 
-/* Initialise the filterbank used by ambiDEC */
+/* Hands codec parameters no longer in use over to the worker thread for freeing; lock-free, for the audio thread */
+void ambi_dec_retireCodecPars(void* const hAmbi,              /* ambi_dec handle */
+                              codecPars* const pars);         /* codec parameters to retire */
+
+/* Intialises the decoding matrices, for the loudspeaker set-up in "pars" */
+void ambi_dec_initCodec(void* const hAmbi,                    /* ambi_dec handle */
+                        codecPars* const pars);               /* codec parameters to initialise */
+
+/* Intialises the hrtf filterbank coefficients and vbap look-up tables, interpolates the HRTFs for the loudspeaker
+ * directions in "pars", and folds them into the decoding matrices ("M_bin"). Must be called after "ambi_dec_initCodec" */
+void ambi_dec_initHRTFs(void* const hAmbi,                    /* ambi_dec handle */
+                        codecPars* const pars);               /* codec parameters to initialise */
+
+/* Allocates the filterbank and its buffers for up to MAX_NUM_SH_SIGNALS inputs and MAX_NUM_LOUDSPEAKERS outputs; called
+ * once, on creation */
 void ambi_dec_initTFT(void* const hAmbi);                     /* ambi_dec handle */
     
 /* interpolates between 3 HRTFs using amplitude-preserving VBAP gains. The HRTF magnitude responses and HRIR ITDs are interpolated seperately
  * before being re-combined */
-void ambi_dec_interpHRTFs(void* const hAmbi,                  /* ambi_dec handle (includes VBAP gains, HRTFs and ITDs) */
+void ambi_dec_interpHRTFs(codecPars* const pars,              /* codec parameters (includes VBAP gains, HRTFs and ITDs) */
                           float azimuth_deg,                  /* source azimuth in degrees */
                           float elevation_deg,                /* source elevation in degrees */
                           float_complex h_intrp[HYBRID_BANDS][NUM_EARS]);
 
+/* Decodes one band of the current SH frame to the loudspeakers, or, if binauralising, directly to the ears using the
+ * binaural decoding matrices (the loudspeaker signals are then not computed). Only the rows of the outputs decoded are
+ * written. Bands are independent of each other, and may be decoded on different threads */
+void ambi_dec_decodeBand(void* const hAmbi,                   /* ambi_dec handle */
+                         const userPars* up,                  /* snapshot of the user parameters */
+                         codecPars* const pars,               /* codec parameters to decode with */
+                         int binauraliseLS,                   /* 1: binauralise the loudspeaker signals, 0: do not */
+                         int band,                            /* band index */
+                         float_complex outputframeTF[MAX_NUM_LOUDSPEAKERS][TIME_SLOTS]); /* & loudspeaker (or binaural) signals of this band */
+
 /* Loads loudspeaker directions from preset */
 void ambi_dec_loadPreset(PRESETS preset,                      /* PRESET enum tag */
                          float dirs_deg[MAX_NUM_LOUDSPEAKERS][2], /* loudspeaker directions */
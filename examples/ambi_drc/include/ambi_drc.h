@@ -96,6 +96,11 @@ void ambi_drc_process(void* const hAmbi,                /* ambi_drc handle */
                       int nSamples,                     /* number of samples in 'inputs'/'outputs' matrix */
                       int isPlaying);                   /* Flag, 1: if there is audio in buffers */
 
+/* blocks until the worker thread has finished (re)initialising the time-frequency transform, which is then picked up
+ * by the next call to "ambi_drc_process" (e.g. for offline rendering or benchmarking). Must not be called from the
+ * audio thread */
+void ambi_drc_waitForInit(void* const hAmbi);           /* ambi_drc handle */
+
 
 /*****************/
 /* Set Functions */
@@ -157,6 +162,12 @@ int ambi_drc_getChOrder(void* const hAmbi);
 int ambi_drc_getNormType(void* const hAmbi);
     
 INPUT_ORDER ambi_drc_getInputPreset(void* const hAmbi);
+
+/* returns the processing delay in samples, introduced by the time-frequency transform */
+int ambi_drc_getProcessingDelay(void);
+
+/* returns the profiler handle, for "saf_profiler_getStats" (NULL, unless built with SAF_ENABLE_PROFILER) */
+void* ambi_drc_getProfiler(void* const hAmbi);
     
 #ifdef __cplusplus
 }
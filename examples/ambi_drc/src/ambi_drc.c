@@ -41,13 +41,16 @@ void ambi_drc_create
 )
 {
     ambi_drc_data* pData = (ambi_drc_data*)malloc(sizeof(ambi_drc_data));
+    userPars* up;
     if (pData == NULL) { return;/*error*/ }
     *phAmbi = (void*)pData;
+    saf_profiler_create(&(pData->hProf));
  
-    /* afSTFT init and audio buffers */
-    pData->hSTFT = NULL;
-    pData->STFTFrameTF = NULL;
-    pData->tempHopFrameTD = NULL;
+    /* afSTFT; built on the worker thread (see "ambi_drc_tftWorker") */
+    pData->tft = NULL;
+    pData->pendingTFT = NULL;
+    pData->retiredTFT = NULL;
+    saf_worker_create(&(pData->hWorker), ambi_drc_tftWorker, (void*)pData);
     
     /* internal */
     pData->fs = 48000;
@@ -58,21 +61,22 @@ void ambi_drc_create
 #endif
   
     /* Default user parameters */
-    pData->theshold = 0.0f;  
-    pData->ratio = 8.0f;
-    pData->knee = 0.0f;
-    pData->inGain = 0.0f;
-    pData->outGain = 0.0f;
-    pData->attack_ms = 50.0f;
-    pData->release_ms = 100.0f;
-    pData->chOrdering = CH_ACN;
-    pData->norm = NORM_N3D;
-    pData->currentOrder = INPUT_ORDER_1;
+    saf_paramBlock_create(&(pData->hUserPars), sizeof(userPars), 2);
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->theshold = 0.0f;  
+    up->ratio = 8.0f;
+    up->knee = 0.0f;
+    up->inGain = 0.0f;
+    up->outGain = 0.0f;
+    up->attack_ms = 50.0f;
+    up->release_ms = 100.0f;
+    up->chOrdering = CH_ACN;
+    up->norm = NORM_N3D;
+    up->currentOrder = INPUT_ORDER_1;
+    saf_paramBlock_publish(pData->hUserPars);
     
-    /* for dynamically allocating the number of channels */
-    ambi_drc_setInputOrder(pData->currentOrder, &(pData->new_nSH));
-    pData->nSH = pData->new_nSH;
-    pData->reInitTFT = 1;
+    /* build the TFT for the default order */
+    ambi_drc_requestTFTInit(pData);
 }
 
 void ambi_drc_destroy
@@ -81,19 +85,19 @@ void ambi_drc_destroy
 )
 {
     ambi_drc_data *pData = (ambi_drc_data*)(*phAmbi);
-    int t, ch;
+    tftPars* tft, *next;
 
     if (pData != NULL) {
-        if (pData->hSTFT != NULL) {
-            afSTFTfree(pData->hSTFT);
-            for (t = 0; t < TIME_SLOTS; t++) {
-                for (ch = 0; ch < pData->nSH; ch++) {
-                    free(pData->STFTFrameTF[t][ch].re);
-                    free(pData->STFTFrameTF[t][ch].im);
-                }
-            }
-            free(pData->STFTFrameTF);
-            free(pData->tempHopFrameTD);
+        /* stop the worker thread first (waits for it to finish any initialisation in progress) */
+        saf_worker_destroy(&(pData->hWorker));
+        
+        /* TFTs: current, pending and retired */
+        ambi_drc_freeTFT(&(pData->tft));
+        tft = (tftPars*)pData->pendingTFT;
+        ambi_drc_freeTFT(&tft);
+        for(tft = (tftPars*)pData->retiredTFT; tft!=NULL; tft = next){
+            next = tft->next;
+            ambi_drc_freeTFT(&tft);
         }
      
 #ifdef ENABLE_TF_DISPLAY
@@ -101,6 +105,8 @@ void ambi_drc_destroy
         free2d((void**)pData->gainsTF_bank1, HYBRID_BANDS);
 #endif 
 
+        saf_paramBlock_destroy(&(pData->hUserPars));
+        saf_profiler_destroy(&(pData->hProf));
         free(pData);
         pData = NULL;
     }
@@ -146,42 +152,52 @@ void ambi_drc_process
 )                                         
 {
     ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
-    int i, n, t, ch, band, sample;
+    const userPars* up;
+    tftPars* tft, *newTFT;
+    int i, n, t, ch, band, sample, nSH;
     int o[MAX_ORDER+2];
     float xG, yG, xL, yL, cdB, alpha_a, alpha_r;
     NORM_TYPES norm;
     float makeup, boost, theshold, ratio, knee;
     
-    /* reinitialise if needed */
-    if(pData->reInitTFT==1){
-        pData->reInitTFT = 2;
-        ambi_drc_initTFT(hAmbi);
-        pData->reInitTFT = 0;
+    /* consistent snapshot of the user parameters for this frame */
+    up = (const userPars*)saf_paramBlock_read(pData->hUserPars, USER_PARS_AUDIO);
+    
+    /* pick up the TFT newly published by the worker thread (see "ambi_drc_tftWorker"), and hand the previous one back
+     * to it for freeing. Until there is one for the current number of SH signals, the output is silent */
+    newTFT = (tftPars*)saf_atomic_exchangep(&(pData->pendingTFT), NULL);
+    if(newTFT!=NULL){
+        ambi_drc_retireTFT(hAmbi, pData->tft);
+        pData->tft = newTFT;
     }
+    tft = pData->tft;
+    ambi_drc_setInputOrder(up->currentOrder, &nSH);
 
     /* Main processing loop */
-    if (nSamples == FRAME_SIZE && pData->reInitTFT == 0 && isPlaying) {
+    if (nSamples == FRAME_SIZE && tft!=NULL && tft->nSH == nSH && isPlaying) {
+        SAF_RT_SCOPE_BEGIN;
+        SAF_PROFILE_BEGIN(pData->hProf, "total");
         /* prep */
         for(n=0; n<MAX_ORDER+2; n++){  o[n] = n*n;  }
-        alpha_a = expf(-1.0f / ( (pData->attack_ms  / ((float)FRAME_SIZE / (float)TIME_SLOTS)) * pData->fs * 0.001f));
-        alpha_r = expf(-1.0f / ( (pData->release_ms / ((float)FRAME_SIZE / (float)TIME_SLOTS)) * pData->fs * 0.001f));
-        boost = powf(10.0f, pData->inGain / 20.0f);
-        makeup = powf(10.0f, pData->outGain / 20.0f);
-        norm = pData->norm;
-        theshold = pData->theshold;
-        ratio = pData->ratio;
-        knee = pData->knee;
+        alpha_a = expf(-1.0f / ( (up->attack_ms  / ((float)FRAME_SIZE / (float)TIME_SLOTS)) * pData->fs * 0.001f));
+        alpha_r = expf(-1.0f / ( (up->release_ms / ((float)FRAME_SIZE / (float)TIME_SLOTS)) * pData->fs * 0.001f));
+        boost = powf(10.0f, up->inGain / 20.0f);
+        makeup = powf(10.0f, up->outGain / 20.0f);
+        norm = up->norm;
+        theshold = up->theshold;
+        ratio = up->ratio;
+        knee = up->knee;
         
         /* load time-domain data */
-        for (i = 0; i < MIN(pData->nSH, nCh); i++)
+        for (i = 0; i < MIN(nSH, nCh); i++)
             memcpy(pData->inputFrameTD[i], inputs[i], FRAME_SIZE * sizeof(float));
-        for (; i < pData->nSH; i++)
+        for (; i < nSH; i++)
             memset(pData->inputFrameTD[i], 0, FRAME_SIZE * sizeof(float));
         
         /* account for selected norm scheme */
         switch(norm){
             case NORM_N3D: /* convert to SN3D for processing */
-                for (n = 0; n<(sqrt(pData->nSH)-1)+1; n++)
+                for (n = 0; n<(sqrt(nSH)-1)+1; n++)
                     for (ch = o[n]; ch<o[n+1]; ch++)
                         for(i = 0; i<FRAME_SIZE; i++)
                             pData->inputFrameTD[ch][i] /= sqrtf(2.0f*(float)n+1.0f);
@@ -191,24 +207,27 @@ void ambi_drc_process
         }
 
         /* Apply time-frequency transform */
+        SAF_PROFILE_BEGIN(pData->hProf, "afSTFTforward");
         for (t = 0; t < TIME_SLOTS; t++) {
-            for (ch = 0; ch < pData->nSH; ch++)
+            for (ch = 0; ch < nSH; ch++)
                 for (sample = 0; sample < HOP_SIZE; sample++)
-                    pData->tempHopFrameTD[ch][sample] = pData->inputFrameTD[ch][sample + t*HOP_SIZE];
-            afSTFTforward(pData->hSTFT, pData->tempHopFrameTD, pData->STFTFrameTF[t]);
+                    tft->tempHopFrameTD[ch][sample] = pData->inputFrameTD[ch][sample + t*HOP_SIZE];
+            afSTFTforward(tft->hSTFT, tft->tempHopFrameTD, tft->STFTFrameTF[t]);
         }
         for (band = 0; band < HYBRID_BANDS; band++)
-            for (ch = 0; ch < pData->nSH; ch++)
+            for (ch = 0; ch < nSH; ch++)
                 for (t = 0; t < TIME_SLOTS; t++)
-                    pData->inputFrameTF[band][ch][t] = cmplxf(pData->STFTFrameTF[t][ch].re[band], pData->STFTFrameTF[t][ch].im[band]);
+                    pData->inputFrameTF[band][ch][t] = cmplxf(tft->STFTFrameTF[t][ch].re[band], tft->STFTFrameTF[t][ch].im[band]);
+        SAF_PROFILE_END(pData->hProf, "afSTFTforward");
                 
         /* Calculate the dynamic range compression gain factors per frequency band based on the omnidirectional component.
          * McCormack, L., & Välimäki, V. (2017). "FFT-Based Dynamic Range Compression". in Proceedings of the 14th
          * Sound and Music Computing Conference, July 5-8, Espoo, Finland.*/
+        SAF_PROFILE_BEGIN(pData->hProf, "drc");
         for (t = 0; t < TIME_SLOTS; t++) {
             for (band = 0; band < HYBRID_BANDS; band++) {
                 /* apply input boost */
-                for (ch = 0; ch < pData->nSH; ch++)
+                for (ch = 0; ch < nSH; ch++)
                     pData->inputFrameTF[band][ch][t] = crmulf(pData->inputFrameTF[band][ch][t], boost);
                 
                 /* calculate gain factor for this frequency based on the omni component */
@@ -228,7 +247,7 @@ void ambi_drc_process
                     pData->gainsTF_bank1[band][pData->wIdx] = cdB;
 #endif
                 /* apply same gain factor to all SH components, the spatial characteristics will be preserved */
-                for (ch = 0; ch < pData->nSH; ch++)
+                for (ch = 0; ch < nSH; ch++)
                     pData->outputFrameTF[band][ch][t] = crmulf(pData->inputFrameTF[band][ch][t], cdB*makeup);
             }
 #ifdef ENABLE_TF_DISPLAY
@@ -243,27 +262,30 @@ void ambi_drc_process
                 pData->rIdx = 0;
 #endif
         }
+        SAF_PROFILE_END(pData->hProf, "drc");
         
         /* Inverse time-frequency transform */
+        SAF_PROFILE_BEGIN(pData->hProf, "afSTFTinverse");
         for (t = 0; t < TIME_SLOTS; t++) {
-            for (ch = 0; ch < pData->nSH; ch++) {
+            for (ch = 0; ch < nSH; ch++) {
                 for (band = 0; band < HYBRID_BANDS; band++) {
-                    pData->STFTFrameTF[t][ch].re[band] = crealf(pData->outputFrameTF[band][ch][t]);
-                    pData->STFTFrameTF[t][ch].im[band] = cimagf(pData->outputFrameTF[band][ch][t]);
+                    tft->STFTFrameTF[t][ch].re[band] = crealf(pData->outputFrameTF[band][ch][t]);
+                    tft->STFTFrameTF[t][ch].im[band] = cimagf(pData->outputFrameTF[band][ch][t]);
                 }
             }
         }
         for (t = 0; t < TIME_SLOTS; t++) {
-            afSTFTinverse(pData->hSTFT, pData->STFTFrameTF[t], pData->tempHopFrameTD);
-            for (ch = 0; ch < pData->nSH; ch++)
+            afSTFTinverse(tft->hSTFT, tft->STFTFrameTF[t], tft->tempHopFrameTD);
+            for (ch = 0; ch < nSH; ch++)
                 for (sample = 0; sample < HOP_SIZE; sample++)
-                    pData->outputFrameTD[ch][sample + t* HOP_SIZE] = pData->tempHopFrameTD[ch][sample];
+                    pData->outputFrameTD[ch][sample + t* HOP_SIZE] = tft->tempHopFrameTD[ch][sample];
         }
+        SAF_PROFILE_END(pData->hProf, "afSTFTinverse");
         
         /* account for selected normalisation scheme */
         switch(norm){
             case NORM_N3D: /* convert back to N3D */
-                for (n = 0; n<(sqrt(pData->nSH)-1)+1; n++)
+                for (n = 0; n<(sqrt(nSH)-1)+1; n++)
                     for (ch = o[n]; ch<o[n+1]; ch++)
                         for(i = 0; i<FRAME_SIZE; i++)
                             pData->outputFrameTD[ch][i] *= sqrtf(2.0f*(float)n+1.0f);
@@ -273,10 +295,12 @@ void ambi_drc_process
         }
         
         /* copy buffers to output */
-        for (ch = 0; ch < MIN(pData->nSH, nCh); ch++) 
+        for (ch = 0; ch < MIN(nSH, nCh); ch++) 
             memcpy(outputs[ch], pData->outputFrameTD[ch], FRAME_SIZE*sizeof(float));
         for (; ch < nCh; ch++)
             memset(outputs[ch], 0, FRAME_SIZE*sizeof(float));
+        SAF_PROFILE_END(pData->hProf, "total");
+        SAF_RT_SCOPE_END;
     }
     else {
         for (ch=0; ch < nCh; ch++)
@@ -284,75 +308,102 @@ void ambi_drc_process
     }
 }
 
+void ambi_drc_waitForInit(void* const hAmbi)
+{
+    ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
+    saf_worker_wait(pData->hWorker);
+}
+
 /* SETS */
 
 void ambi_drc_refreshSettings(void* const hAmbi)
 {
-    ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
-    pData->reInitTFT = 1;
+    ambi_drc_requestTFTInit(hAmbi);
 }
 
 void ambi_drc_setThreshold(void* const hAmbi, float newValue)
 {
     ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
-    pData->theshold = MAX(MIN(newValue, 0.0f), -60.0f);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->theshold = MAX(MIN(newValue, 0.0f), -60.0f);
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_drc_setRatio(void* const hAmbi, float newValue)
 {
     ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
-    pData->ratio = MAX(MIN(newValue, 30.0f), 1.0f);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->ratio = MAX(MIN(newValue, 30.0f), 1.0f);
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_drc_setKnee(void* const hAmbi, float newValue)
 {
     ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
-    pData->knee = MAX(MIN(newValue, 10.0f), 0.0f);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->knee = MAX(MIN(newValue, 10.0f), 0.0f);
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_drc_setInGain(void* const hAmbi, float newValue)
 {
     ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
-    pData->inGain = MAX(MIN(newValue, 40.0f), -40.0f);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->inGain = MAX(MIN(newValue, 40.0f), -40.0f);
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_drc_setOutGain(void* const hAmbi, float newValue)
 {
     ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
-    pData->outGain = MAX(MIN(newValue, 40.0f), -20.0f);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->outGain = MAX(MIN(newValue, 40.0f), -20.0f);
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_drc_setAttack(void* const hAmbi, float newValue)
 {
     ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
-    pData->attack_ms = MAX(MIN(newValue, 200.0f), 10.0f);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->attack_ms = MAX(MIN(newValue, 200.0f), 10.0f);
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_drc_setRelease(void* const hAmbi, float newValue)
 {
     ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
-    pData->release_ms = MAX(MIN(newValue, 1000.0f), 50.0f);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->release_ms = MAX(MIN(newValue, 1000.0f), 50.0f);
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_drc_setChOrder(void* const hAmbi, int newOrder)
 {
     ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
-    pData->chOrdering = (CH_ORDER)newOrder;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->chOrdering = (CH_ORDER)newOrder;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_drc_setNormType(void* const hAmbi, int newType)
 {
     ambi_drc_data *pData = (ambi_drc_data*)hAmbi;
-    pData->norm = (NORM_TYPES)newType;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->norm = (NORM_TYPES)newType;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_drc_setInputPreset(void* const hAmbi, INPUT_ORDER newPreset)
 {
     ambi_drc_data *pData = (ambi_drc_data*)hAmbi;
-    ambi_drc_setInputOrder(newPreset, &(pData->new_nSH));
-    pData->currentOrder = newPreset;
-    if(pData->new_nSH!=pData->nSH)
-        pData->reInitTFT = 1;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    int changed;
+    
+    changed = up->currentOrder != newPreset;
+    up->currentOrder = newPreset;
+    saf_paramBlock_publish(pData->hUserPars);
+    if(changed) /* (afSTFT is reinitialised on the worker thread, if the number of SH signals changes) */
+        ambi_drc_requestTFTInit(hAmbi);
 }
 
 
@@ -391,60 +442,81 @@ float* ambi_drc_getFreqVector(void* const hAmbi, int* nFreqPoints)
 float ambi_drc_getThreshold(void* const hAmbi)
 {
     ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
-    return pData->theshold;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->theshold;
 }
 
 float ambi_drc_getRatio(void* const hAmbi)
 {
     ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
-    return pData->ratio;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->ratio;
 }
 
 float ambi_drc_getKnee(void* const hAmbi)
 {
     ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
-    return pData->knee;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->knee;
 }
 
 float ambi_drc_getInGain(void* const hAmbi)
 {
     ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
-    return pData->inGain;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->inGain;
 }
 
 float ambi_drc_getOutGain(void* const hAmbi)
 {
     ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
-    return pData->outGain;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->outGain;
 }
 
 float ambi_drc_getAttack(void* const hAmbi)
 {
     ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
-    return pData->attack_ms;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->attack_ms;
 }
 
 float ambi_drc_getRelease(void* const hAmbi)
 {
     ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
-    return pData->release_ms;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->release_ms;
 }
 
 int ambi_drc_getChOrder(void* const hAmbi)
 {
     ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
-    return (int)pData->chOrdering;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->chOrdering;
 }
 
 int ambi_drc_getNormType(void* const hAmbi)
 {
     ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
-    return (int)pData->norm;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->norm;
 }
 
 INPUT_ORDER ambi_drc_getInputPreset(void* const hAmbi)
 {
     ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
-    return pData->currentOrder;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->currentOrder;
+}
+
+int ambi_drc_getProcessingDelay(void)
+{
+    return afSTFTdelay(HOP_SIZE, 0, 1);
+}
+
+void* ambi_drc_getProfiler(void* const hAmbi)
+{
+    ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
+    return pData->hProf;
 }
 
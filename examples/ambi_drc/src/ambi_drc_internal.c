@@ -79,41 +79,92 @@ float ambi_drc_smoothPeakDetector
     return yL;
 }
 
-void ambi_drc_initTFT
-(
-    void* const hAmbi
-)
+void ambi_drc_requestTFTInit(void* const hAmbi)
+{
+    ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
+    
+    saf_atomic_storei(&(pData->reInitTFT), 1);
+    saf_worker_post(pData->hWorker);
+}
+
+void ambi_drc_tftWorker(void* hAmbi)
 {
     ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
+    const userPars* up;
+    tftPars* tft, *next;
+    int nSH;
+    
+    /* free the TFTs the audio thread is no longer using */
+    tft = (tftPars*)saf_atomic_exchangep(&(pData->retiredTFT), NULL);
+    for(; tft!=NULL; tft = next){
+        next = tft->next;
+        ambi_drc_freeTFT(&tft);
+    }
+    if(!saf_atomic_exchangei(&(pData->reInitTFT), 0))
+        return;
+    
+    /* build a fresh TFT for the current order (if the order is changed in the meantime, the job is posted again and
+     * this one will be superseded) */
+    up = (const userPars*)saf_paramBlock_read(pData->hUserPars, USER_PARS_WORKER);
+    ambi_drc_setInputOrder(up->currentOrder, &nSH);
+    tft = ambi_drc_createTFT(nSH);
+    
+    /* publish it; if the audio thread never picked up the previously published one, it is not needed anymore */
+    tft = (tftPars*)saf_atomic_exchangep(&(pData->pendingTFT), (void*)tft);
+    ambi_drc_freeTFT(&tft);
+}
+
+void ambi_drc_retireTFT(void* const hAmbi, tftPars* const tft)
+{
+    ambi_drc_data *pData = (ambi_drc_data*)(hAmbi);
+    void* head;
+    
+    if(tft==NULL)
+        return;
+    /* lock-free push; the worker thread only ever takes the whole list at once, so there is no ABA problem */
+    do{
+        head = saf_atomic_loadp(&(pData->retiredTFT));
+        tft->next = (tftPars*)head;
+    } while(!saf_atomic_casp(&(pData->retiredTFT), head, (void*)tft));
+}
+
+tftPars* ambi_drc_createTFT(int nSH)
+{
+    tftPars* tft;
     int t, ch;
     
-    /* free afSTFT + buffers, if already allocated */
-    if (pData->hSTFT != NULL){
-        afSTFTfree(pData->hSTFT);
-        pData->hSTFT = NULL;
-        for (t = 0; t<TIME_SLOTS; t++) {
-            for (ch = 0; ch< pData->nSH; ch++) {
-                free(pData->STFTFrameTF[t][ch].re);
-                free(pData->STFTFrameTF[t][ch].im);
-            }
+    tft = (tftPars*)malloc(sizeof(tftPars));
+    tft->nSH = nSH;
+    tft->next = NULL;
+    afSTFTinit(&(tft->hSTFT), HOP_SIZE, nSH, nSH, 0, 1);
+    tft->STFTFrameTF = (complexVector**)malloc2d(TIME_SLOTS, nSH, sizeof(complexVector));
+    for(t=0; t<TIME_SLOTS; t++) {
+        for(ch=0; ch< nSH; ch++) {
+            tft->STFTFrameTF[t][ch].re = (float*)calloc(HYBRID_BANDS, sizeof(float));
+            tft->STFTFrameTF[t][ch].im = (float*)calloc(HYBRID_BANDS, sizeof(float));
         }
-        free2d((void**)pData->tempHopFrameTD, MAX(MAX_NUM_SH_SIGNALS, pData->nSH));
-        free2d((void**)pData->STFTFrameTF, TIME_SLOTS);
     }
+    tft->tempHopFrameTD = (float**)malloc2d(nSH, HOP_SIZE, sizeof(float));
+    return tft;
+}
+
+void ambi_drc_freeTFT(tftPars** const ptft)
+{
+    tftPars* tft = *ptft;
+    int t, ch;
     
-    /* reallocate afSTFT + buffers */
-    if (pData->hSTFT == NULL){
-    
-        afSTFTinit(&(pData->hSTFT), HOP_SIZE, pData->new_nSH, pData->new_nSH, 0, 1);
-        pData->STFTFrameTF = (complexVector**)malloc2d(TIME_SLOTS, pData->new_nSH, sizeof(complexVector));
-        for(t=0; t<TIME_SLOTS; t++) {
-            for(ch=0; ch< pData->new_nSH; ch++) {
-                pData->STFTFrameTF[t][ch].re = (float*)calloc(HYBRID_BANDS, sizeof(float));
-                pData->STFTFrameTF[t][ch].im = (float*)calloc(HYBRID_BANDS, sizeof(float));
+    if(tft!=NULL){
+        afSTFTfree(tft->hSTFT);
+        for (t = 0; t<TIME_SLOTS; t++) {
+            for (ch = 0; ch< tft->nSH; ch++) {
+                free(tft->STFTFrameTF[t][ch].re);
+                free(tft->STFTFrameTF[t][ch].im);
             }
         }
-        pData->tempHopFrameTD = (float**)malloc2d(pData->new_nSH, HOP_SIZE, sizeof(float));
-        pData->nSH = pData->new_nSH;
+        free2d((void**)tft->STFTFrameTF, TIME_SLOTS);
+        free2d((void**)tft->tempHopFrameTD, tft->nSH);
+        free(tft);
+        *ptft = NULL;
     }
 }
 
@@ -39,13 +39,36 @@
 #include <math.h>
 #include <string.h>
 #include "ambi_drc.h"
-#include "ambi_drc_database.h"
 #define SAF_ENABLE_AFSTFT
 #include "saf.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
+    
+#define USER_PARS_AUDIO ( 0 )  /* user parameter block reader index of the audio thread */
+#define USER_PARS_WORKER ( 1 ) /* user parameter block reader index of the worker thread */
+    
+/* user parameters; edited by the set functions, and read by the audio thread (see saf_paramBlock) */
+typedef struct _userPars
+{
+    float theshold, ratio, knee, inGain, outGain, attack_ms, release_ms;
+    CH_ORDER chOrdering;
+    NORM_TYPES norm;
+    INPUT_ORDER currentOrder;
+    
+} userPars;
+
+/* time-frequency transform for nSH channels; built by the worker thread, used by the audio thread */
+typedef struct _tftPars
+{
+    int nSH;
+    void* hSTFT;
+    complexVector** STFTFrameTF;
+    float** tempHopFrameTD;
+    struct _tftPars* next; /* next entry in the list of retired TFTs */
+    
+} tftPars;
      
 typedef struct _ambi_drc
 {    
@@ -54,16 +77,19 @@ typedef struct _ambi_drc
     float outputFrameTD[MAX_NUM_SH_SIGNALS][FRAME_SIZE];
     float_complex inputFrameTF[HYBRID_BANDS][MAX_NUM_SH_SIGNALS][TIME_SLOTS];
     float_complex outputFrameTF[HYBRID_BANDS][MAX_NUM_SH_SIGNALS][TIME_SLOTS];
-    void* hSTFT; 
-    complexVector** STFTFrameTF;     
-    float** tempHopFrameTD;
     float freqVector[HYBRID_BANDS];
+    
+    /* TFT; the worker thread builds a new one whenever the number of SH signals changes, and publishes it to the audio
+     * thread, which hands the previous one back for freeing */
+    tftPars* tft;             /* TFT currently used for processing (audio thread only) */
+    void* volatile pendingTFT; /* new TFT published by the worker thread (tftPars*) */
+    void* volatile retiredTFT; /* TFTs no longer used by the audio thread, freed by the worker thread (tftPars*) */
+    void* hWorker;            /* worker thread, which (re)initialises the TFT */
 
     /* internal */
-    int nSH, new_nSH;
     float fs;
     float yL_z1[HYBRID_BANDS];
-    int reInitTFT; /* 0: no init required, 1: init required, 2: init in progress */
+    volatile int reInitTFT; /* 0: no init required, 1: init required (on the worker thread) */
 
 #ifdef ENABLE_TF_DISPLAY
     int wIdx, rIdx;
@@ -73,11 +99,9 @@ typedef struct _ambi_drc
 #endif
 
     /* user parameters */
-    float theshold, ratio, knee, inGain, outGain, attack_ms, release_ms;
+    void* hUserPars; /* parameter block of "userPars"; edited by the set functions, read by the audio and worker threads */
     int enableTF;
-    CH_ORDER chOrdering;
-    NORM_TYPES norm;
-    INPUT_ORDER currentOrder;
+    void* hProf;   /* per-stage timing of the processing loop (see saf_profiler.h) */
     
 } ambi_drc_data;
      
@@ -90,8 +114,22 @@ float ambi_drc_gainComputer(float xG, float T, float R, float W);
 
 float ambi_drc_smoothPeakDetector(float xL, float yL_z1, float alpha_a, float alpha_r);
     
-/* Initialise the filterbank used by ambiDRC */
-void ambi_drc_initTFT(void* const hAmbi);                     /* ambi_drc handle */
+/* Flags the TFT for reinitialisation, which is carried out on the worker thread. Not for the audio thread */
+void ambi_drc_requestTFTInit(void* const hAmbi);              /* ambi_drc handle */
+
+/* Worker thread job: builds a fresh TFT for the current input order and publishes it to the audio thread. Also frees
+ * any TFTs the audio thread has since retired */
+void ambi_drc_tftWorker(void* hAmbi);                         /* ambi_drc handle */
+
+/* Hands a TFT no longer in use over to the worker thread for freeing; lock-free, for the audio thread */
+void ambi_drc_retireTFT(void* const hAmbi,                    /* ambi_drc handle */
+                        tftPars* const tft);                  /* TFT to retire (may be NULL) */
+
+/* Creates the filterbank used by ambiDRC (and its buffers), for nSH channels */
+tftPars* ambi_drc_createTFT(int nSH);                         /* number of SH signals */
+
+/* Frees a TFT created by "ambi_drc_createTFT" */
+void ambi_drc_freeTFT(tftPars** const ptft);                  /* & address of TFT */
 
 void ambi_drc_setInputOrder(INPUT_ORDER inOrder, int* nSH);
 
@@ -191,6 +191,17 @@ void ambi_enc_setSourceElev_deg(void* const hAmbi, int index, float newElev_deg)
 void ambi_enc_setNumSources(void* const hAmbi, int new_nSources);
  
 void ambi_enc_setInputConfigPreset(void* const hAmbi, int newPresetID);
+    
+/* 1: when a source moves, its SHs are interpolated linearly from those of the previous direction to those of the new
+ * direction over the samples of the frame, rather than switching at the frame boundary. Static sources are encoded as
+ * before. 0 (default): off */
+void ambi_enc_setInterpPerSample(void* const hAmbi,               /* ambi_enc handle */
+                                 int newState);                   /* 1: on, 0: off */
+    
+/* sets how long a source must be silent (below -120 dBFS) before its encoding is skipped; it is encoded again as soon
+ * as it is not silent */
+void ambi_enc_setActivityHoldTime(void* const hAmbi,              /* ambi_enc handle */
+                                  float newHold_ms);              /* hold time in milliseconds (default 100) */
  
 void ambi_enc_setChOrder(void* const hAmbi, int newOrder);
     
@@ -214,6 +225,19 @@ int ambi_enc_getMaxNumSources(void);
 int ambi_enc_getChOrder(void* const hAmbi);
     
 int ambi_enc_getNormType(void* const hAmbi);
+    
+int ambi_enc_getInterpPerSample(void* const hAmbi);
+    
+float ambi_enc_getActivityHoldTime(void* const hAmbi);
+    
+/* returns the number of sources that were encoded (not skipped as silent) in the last frame */
+int ambi_enc_getNumActiveSources(void* const hAmbi);
+
+/* returns the processing delay in samples (always 0, since the processing is carried out in the time-domain) */
+int ambi_enc_getProcessingDelay(void);
+
+/* returns the profiler handle, for "saf_profiler_getStats" (NULL, unless built with SAF_ENABLE_PROFILER) */
+void* ambi_enc_getProfiler(void* const hAmbi);
 
     
 #ifdef __cplusplus
@@ -34,17 +34,43 @@ void ambi_enc_create
     ambi_enc_data* pData = (ambi_enc_data*)malloc(sizeof(ambi_enc_data));
     if (pData == NULL) { return;/*error*/ }
     *phAmbi = (void*)pData;
+    saf_profiler_create(&(pData->hProf));
     int i;
-    pData->order = 1;
+    userPars* up;
     
     /* user parameters */
-    ambi_enc_loadPreset(PRESET_DEFAULT, pData->src_dirs_deg, &(pData->new_nSources)); /*check setStateInformation if you change default preset*/
-    pData->nSources = pData->new_nSources;
+    saf_paramBlock_create(&(pData->hUserPars), sizeof(userPars), 1);
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->order = 1;
+    ambi_enc_loadPreset(PRESET_DEFAULT, up->src_dirs_deg, &(up->nSources)); /*check setStateInformation if you change default preset*/
+    up->chOrdering = CH_ACN;
+    up->norm = NORM_N3D;
+    up->outputOrderPreset = OUTPUT_ORDER_FIRST;
+    up->activityHold_ms = SAF_ACTIVITY_DEFAULT_HOLD_MS;
+    up->interpPerSample = 0;
+    saf_paramBlock_publish(pData->hUserPars);
+    
+    /* the SHs of all sources are calculated in the first frame */
     for(i=0; i<MAX_NUM_INPUTS; i++)
         pData->recalc_SH_FLAG[i] = 1;
-    pData->chOrdering = CH_ACN;
-    pData->norm = NORM_N3D;
-    pData->outputOrderPreset = OUTPUT_ORDER_FIRST;
+    pData->refreshSH = 0;
+    pData->order = 1;
+    pData->nSources = 0;
+    
+    /* SH interpolation weights, reaching the new SHs on the last sample of the frame */
+    for(i=0; i<FRAME_SIZE; i++)
+        pData->interpolator[i] = (float)(i+1)/(float)FRAME_SIZE;
+    for(i=0; i<MAX_NUM_INPUTS; i++){
+        pData->Y_valid[i] = 0;
+        pData->sourceMoving[i] = 0;
+    }
+    
+    /* all sources are active to begin with */
+    for(i=0; i<MAX_NUM_INPUTS; i++){
+        pData->sourceActive[i] = 1;
+        pData->nSilentFrames[i] = 0;
+    }
+    pData->nActiveSources = 0;
 }
 
 void ambi_enc_destroy
@@ -55,6 +81,8 @@ void ambi_enc_destroy
     ambi_enc_data *pData = (ambi_enc_data*)(*phAmbi);
     
     if (pData != NULL) {
+        saf_paramBlock_destroy(&(pData->hUserPars));
+        saf_profiler_destroy(&(pData->hProf));
         free(pData);
         pData = NULL;
     }
@@ -82,48 +110,110 @@ void ambi_enc_process
 )
 {
     ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
-    int i, j, ch, n, nSources, nSH;
+    const userPars* up;
+    int i, j, ch, n, nSources, nSH, nActive, nStatic, holdFrames, interpPerSample, refresh;
     int o[MAX_ORDER+2];
-    float src_dirs[MAX_NUM_INPUTS][2], scale;
-    float* Y_src;
-    CH_ORDER chOrdering;
+    float scale;
+    float Y_src[MAX_NUM_SH_SIGNALS];
     NORM_TYPES norm;
     int order;
+    
+    /* consistent snapshot of the user parameters for this frame */
+    up = (const userPars*)saf_paramBlock_read(pData->hUserPars, USER_PARS_AUDIO);
     
     if ( (nSamples == FRAME_SIZE) && (isPlaying == 1) ) {
+        SAF_RT_SCOPE_BEGIN;
+        SAF_PROFILE_BEGIN(pData->hProf, "total");
         /* prep */
         for(n=0; n<MAX_ORDER+2; n++){  o[n] = n*n;  }
-        chOrdering = pData->chOrdering;
-        norm = pData->norm;
-        nSources = pData->nSources;
-        memcpy(src_dirs, pData->src_dirs_deg, MAX_NUM_INPUTS*2*sizeof(float));
-        order = MIN(pData->order, MAX_ORDER);
+        norm = up->norm;
+        nSources = up->nSources;
+        order = MIN(up->order, MAX_ORDER);
         nSH = (order+1)*(order+1);
-        Y_src = malloc(nSH*sizeof(float));
+        interpPerSample = up->interpPerSample;
+        
+        /* flag the SHs of the sources that moved for recalculation; or of all sources, if requested or if the order or
+         * the number of sources changed (the latter without interpolation, as the sources no longer correspond) */
+        refresh = saf_atomic_exchangei(&(pData->refreshSH), 0) || order != pData->order;
+        if(nSources != pData->nSources){
+            for(i=0; i<MAX_NUM_INPUTS; i++)
+                pData->Y_valid[i] = 0;
+            refresh = 1;
+        }
+        for(i=0; i<nSources; i++)
+            if(refresh || up->src_dirs_deg[i][0] != pData->Y_dirs_deg[i][0] || up->src_dirs_deg[i][1] != pData->Y_dirs_deg[i][1])
+                pData->recalc_SH_FLAG[i] = 1;
+        pData->order = order;
+        pData->nSources = nSources;
         
-        /* Load time-domain data */
-        for(i=0; i < MIN(nSources,nInputs); i++)
-            memcpy(pData->inputFrameTD[i], inputs[i], FRAME_SIZE * sizeof(float));
-        for(; i<MAX_NUM_INPUTS; i++)
-            memset(pData->inputFrameTD[i], 0, FRAME_SIZE * sizeof(float));
+        /* activity of the sources; sources are skipped once they have been silent for longer than the hold time
+         * (missing inputs straight away) */
+        holdFrames = saf_activity_getHoldFrames(up->activityHold_ms, pData->fs, FRAME_SIZE, 0);
+        nActive = 0;
+        for(i=0; i<nSources; i++){
+            if(i<nInputs)
+                pData->sourceActive[i] = saf_activity_update(inputs[i], FRAME_SIZE, holdFrames, &(pData->nSilentFrames[i]));
+            else
+                pData->sourceActive[i] = 0;
+            if(pData->sourceActive[i])
+                nActive++;
+        }
+        saf_atomic_storei(&(pData->nActiveSources), nActive);
         
-        /* recalulate SHs */
+        /* recalulate SHs (of the active sources; those of the others are recalculated once they are active again, without
+         * interpolation). Sources that moved are interpolated from their previous SHs, if enabled */
         for(i=0; i<nSources; i++){
-            if(pData->recalc_SH_FLAG[i]){
-                getSHreal(order, pData->src_dirs_deg[i][0]*M_PI/180.0f, M_PI/2.0f - pData->src_dirs_deg[i][1]*M_PI/180.0f, Y_src);
+            pData->sourceMoving[i] = 0;
+            if(!pData->sourceActive[i])
+                pData->Y_valid[i] = 0;
+            else if(pData->recalc_SH_FLAG[i]){
+                if(interpPerSample && pData->Y_valid[i]){
+                    for(j=0; j<MAX_NUM_SH_SIGNALS; j++)
+                        pData->Y_prev[j][i] = pData->Y[j][i];
+                    pData->sourceMoving[i] = 1;
+                }
+                getSHreal(order, up->src_dirs_deg[i][0]*M_PI/180.0f, M_PI/2.0f - up->src_dirs_deg[i][1]*M_PI/180.0f, Y_src);
                 for(j=0; j<nSH; j++)
                     pData->Y[j][i] = sqrtf(4.0f*M_PI)*Y_src[j];
                 for(; j<MAX_NUM_SH_SIGNALS; j++)
                     pData->Y[j][i] = 0.0f;
+                pData->Y_dirs_deg[i][0] = up->src_dirs_deg[i][0];
+                pData->Y_dirs_deg[i][1] = up->src_dirs_deg[i][1];
+                pData->Y_valid[i] = 1;
                 pData->recalc_SH_FLAG[i] = 0;
             }
         }
         
-        /* spatially encode the input signals into spherical harmonic signals */
-        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, FRAME_SIZE, nSources, 1.0,
-                    (float*)pData->Y, MAX_NUM_INPUTS,
-                    (float*)pData->inputFrameTD, FRAME_SIZE, 0.0,
-                    (float*)pData->outputFrameTD, FRAME_SIZE);
+        /* Load the time-domain data of the active static sources, one after the other */
+        nStatic = 0;
+        for(i=0; i<nSources; i++)
+            if(pData->sourceActive[i] && !pData->sourceMoving[i])
+                memcpy(pData->inputFrameTD[nStatic++], inputs[i], FRAME_SIZE * sizeof(float));
+        
+        /* spatially encode the static sources into spherical harmonic signals */
+        SAF_PROFILE_BEGIN(pData->hProf, "encode");
+        if(nStatic == nSources)
+            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, FRAME_SIZE, nSources, 1.0,
+                        (float*)pData->Y, MAX_NUM_INPUTS,
+                        (float*)pData->inputFrameTD, FRAME_SIZE, 0.0,
+                        (float*)pData->outputFrameTD, FRAME_SIZE);
+        else if(nStatic > 0){
+            for(j=0; j<nSH; j++)
+                for(i=0, n=0; i<nSources; i++)
+                    if(pData->sourceActive[i] && !pData->sourceMoving[i])
+                        pData->Y_active[j][n++] = pData->Y[j][i];
+            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, FRAME_SIZE, nStatic, 1.0,
+                        (float*)pData->Y_active, MAX_NUM_INPUTS,
+                        (float*)pData->inputFrameTD, FRAME_SIZE, 0.0,
+                        (float*)pData->outputFrameTD, FRAME_SIZE);
+        }
+        else
+            memset(pData->outputFrameTD, 0, nSH*FRAME_SIZE*sizeof(float));
+        
+        /* add the moving sources, with their SHs interpolated over the frame */
+        for(i=0; i<nSources; i++)
+            if(pData->sourceMoving[i])
+                ambi_enc_encodeMovingSource(hAmbi, i, inputs[i], nSH);
         
         /* scale by 1/sqrt(nSources) */
         scale = 1.0f/sqrt(nSources);
@@ -140,13 +230,15 @@ void ambi_enc_process
                             pData->outputFrameTD[ch][i] /= sqrtf(2.0f*(float)n+1.0f);
                 break;
         }
+        SAF_PROFILE_END(pData->hProf, "encode");
         
         /* save SH signals to output buffer */
         for(i = 0; i < MIN(nSH,nOutputs); i++)
             memcpy(outputs[i], pData->outputFrameTD[i], FRAME_SIZE * sizeof(float));
         for(; i < nOutputs; i++)
             memset(outputs[i], 0, FRAME_SIZE * sizeof(float));
-        free((void*)Y_src);
+        SAF_PROFILE_END(pData->hProf, "total");
+        SAF_RT_SCOPE_END;
     }
     else{
         for (ch=0; ch < nOutputs; ch++)
@@ -159,80 +251,97 @@ void ambi_enc_process
 void ambi_enc_refreshParams(void* const hAmbi)
 {
     ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
-    int i;
-    for(i=0; i<MAX_NUM_INPUTS; i++)
-        pData->recalc_SH_FLAG[i] = 1;
+    saf_atomic_storei(&(pData->refreshSH), 1);
 }
 
 void ambi_enc_setOutputOrder(void* const hAmbi, int newOrder)
 {
     ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
-    int i;
-    if(newOrder != pData->outputOrderPreset){
-        pData->outputOrderPreset = (OUTPUT_ORDERS)newOrder;
-        switch(pData->outputOrderPreset){
-            case OUTPUT_OMNI: pData->order = 0; break;
-            case OUTPUT_ORDER_FIRST:   pData->order = 1; break;
-            case OUTPUT_ORDER_SECOND:  pData->order = 2; break;
-            case OUTPUT_ORDER_THIRD:   pData->order = 3; break;
-            case OUTPUT_ORDER_FOURTH:  pData->order = 4; break;
-            case OUTPUT_ORDER_FIFTH:   pData->order = 5; break;
-            case OUTPUT_ORDER_SIXTH:   pData->order = 6; break;
-            case OUTPUT_ORDER_SEVENTH: pData->order = 7; break;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    if(newOrder != up->outputOrderPreset){
+        up->outputOrderPreset = (OUTPUT_ORDERS)newOrder;
+        switch(up->outputOrderPreset){
+            case OUTPUT_OMNI: up->order = 0; break;
+            case OUTPUT_ORDER_FIRST:   up->order = 1; break;
+            case OUTPUT_ORDER_SECOND:  up->order = 2; break;
+            case OUTPUT_ORDER_THIRD:   up->order = 3; break;
+            case OUTPUT_ORDER_FOURTH:  up->order = 4; break;
+            case OUTPUT_ORDER_FIFTH:   up->order = 5; break;
+            case OUTPUT_ORDER_SIXTH:   up->order = 6; break;
+            case OUTPUT_ORDER_SEVENTH: up->order = 7; break;
         }
-        for(i=0; i<MAX_NUM_INPUTS; i++)
-            pData->recalc_SH_FLAG[i] = 1;
+        saf_paramBlock_publish(pData->hUserPars);
     }
+    else
+        saf_paramBlock_release(pData->hUserPars);
 }
 
 void ambi_enc_setSourceAzi_deg(void* const hAmbi, int index, float newAzi_deg)
 {
     ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
     newAzi_deg = MAX(newAzi_deg, -180.0f);
     newAzi_deg = MIN(newAzi_deg, 180.0f);
-    pData->recalc_SH_FLAG[index] = 1;
-    pData->src_dirs_deg[index][0] = newAzi_deg;
+    up->src_dirs_deg[index][0] = newAzi_deg;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_enc_setSourceElev_deg(void* const hAmbi, int index, float newElev_deg)
 {
     ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
     newElev_deg = MAX(newElev_deg, -90.0f);
     newElev_deg = MIN(newElev_deg, 90.0f);
-    pData->recalc_SH_FLAG[index] = 1;
-    pData->src_dirs_deg[index][1] = newElev_deg;
+    up->src_dirs_deg[index][1] = newElev_deg;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_enc_setNumSources(void* const hAmbi, int new_nSources)
 {
     ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
-    int i;
-    pData->new_nSources = new_nSources > MAX_NUM_INPUTS ? MAX_NUM_INPUTS : new_nSources;
-    pData->nSources = pData->new_nSources;
-    for(i=0; i<MAX_NUM_INPUTS; i++)
-        pData->recalc_SH_FLAG[i] = 1;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->nSources = new_nSources > MAX_NUM_INPUTS ? MAX_NUM_INPUTS : new_nSources;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_enc_setInputConfigPreset(void* const hAmbi, int newPresetID)
 {
     ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
-    int ch;
-    ambi_enc_loadPreset(newPresetID, pData->src_dirs_deg, &(pData->new_nSources));
-    pData->nSources = pData->new_nSources;
-    for(ch=0; ch<MAX_NUM_INPUTS; ch++)
-        pData->recalc_SH_FLAG[ch] = 1;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    ambi_enc_loadPreset(newPresetID, up->src_dirs_deg, &(up->nSources));
+    saf_paramBlock_publish(pData->hUserPars);
+}
+
+void ambi_enc_setInterpPerSample(void* const hAmbi, int newState)
+{
+    ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->interpPerSample = newState ? 1 : 0;
+    saf_paramBlock_publish(pData->hUserPars);
+}
+
+void ambi_enc_setActivityHoldTime(void* const hAmbi, float newHold_ms)
+{
+    ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->activityHold_ms = MAX(newHold_ms, 0.0f);
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_enc_setChOrder(void* const hAmbi, int newOrder)
 {
     ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
-    pData->chOrdering = (CH_ORDER)newOrder;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->chOrdering = (CH_ORDER)newOrder;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void ambi_enc_setNormType(void* const hAmbi, int newType)
 {
     ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
-    pData->norm = (NORM_TYPES)newType;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->norm = (NORM_TYPES)newType;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 /* Get Functions */
@@ -240,25 +349,29 @@ void ambi_enc_setNormType(void* const hAmbi, int newType)
 int ambi_enc_getOutputOrder(void* const hAmbi)
 {
     ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
-    return (int)pData->outputOrderPreset;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->outputOrderPreset;
 }
 
 float ambi_enc_getSourceAzi_deg(void* const hAmbi, int index)
 {
     ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
-    return pData->src_dirs_deg[index][0];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->src_dirs_deg[index][0];
 }
 
 float ambi_enc_getSourceElev_deg(void* const hAmbi, int index)
 {
     ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
-    return pData->src_dirs_deg[index][1];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->src_dirs_deg[index][1];
 }
 
 int ambi_enc_getNumSources(void* const hAmbi)
 {
     ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
-    return pData->nSources;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->nSources;
 }
 
 int ambi_enc_getMaxNumSources()
@@ -269,12 +382,45 @@ int ambi_enc_getMaxNumSources()
 int ambi_enc_getChOrder(void* const hAmbi)
 {
     ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
-    return (int)pData->chOrdering;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->chOrdering;
 }
 
 int ambi_enc_getNormType(void* const hAmbi)
 {
     ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
-    return (int)pData->norm;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->norm;
+}
+
+int ambi_enc_getInterpPerSample(void* const hAmbi)
+{
+    ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->interpPerSample;
+}
+
+float ambi_enc_getActivityHoldTime(void* const hAmbi)
+{
+    ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->activityHold_ms;
+}
+
+int ambi_enc_getNumActiveSources(void* const hAmbi)
+{
+    ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
+    return saf_atomic_loadi(&(pData->nActiveSources));
+}
+
+int ambi_enc_getProcessingDelay(void)
+{
+    return 0;
+}
+
+void* ambi_enc_getProfiler(void* const hAmbi)
+{
+    ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
+    return pData->hProf;
 }
 
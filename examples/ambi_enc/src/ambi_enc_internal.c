@@ -26,6 +26,34 @@
 #include "ambi_enc.h"
 #include "ambi_enc_internal.h"
 
+void ambi_enc_encodeMovingSource
+(
+    void* const hAmbi,
+    int src,
+    const float* input,
+    int nSH
+)
+{
+    ambi_enc_data *pData = (ambi_enc_data*)(hAmbi);
+    int i, j;
+    float y0, dy;
+    const float* w;
+    float* wx, *out;
+    
+    /* (y0 + w*dy)*x = y0*x + dy*(w*x); "w*x" is shared by all SH signals */
+    w = pData->interpolator;
+    wx = pData->interpFrameTD;
+    for(i=0; i<FRAME_SIZE; i++)
+        wx[i] = w[i]*input[i];
+    for(j=0; j<nSH; j++){
+        y0 = pData->Y_prev[j][src];
+        dy = pData->Y[j][src] - y0;
+        out = pData->outputFrameTD[j];
+        for(i=0; i<FRAME_SIZE; i++)
+            out[i] += y0*input[i] + dy*wx[i];
+    }
+}
+
 void ambi_enc_loadPreset(PRESETS preset, float dirs_deg[MAX_NUM_INPUTS][2], int* newNCH)
 {
     int ch, i, nCH;
@@ -40,26 +40,59 @@ extern "C" {
 #define MAX_ORDER ( 7 )
 #define MAX_NUM_INPUTS ( 64 )
 #define MAX_NUM_SH_SIGNALS ( (MAX_ORDER + 1)*(MAX_ORDER + 1) )    /* (L+1)^2 */
+#define USER_PARS_AUDIO ( 0 ) /* user parameter block reader index of the audio thread */
+    
+/* user parameters; edited by the set functions, and read by the audio thread (see saf_paramBlock) */
+typedef struct _userPars
+{
+    int order;
+    OUTPUT_ORDERS outputOrderPreset;
+    int nSources;
+    float src_dirs_deg[MAX_NUM_INPUTS][2];
+    CH_ORDER chOrdering;
+    NORM_TYPES norm;
+    int interpPerSample; /* 1: the SHs of moving sources are interpolated over the samples of a frame */
+    float activityHold_ms; /* time a source must be silent for, before it is skipped (see saf_activity.h) */
+    
+} userPars;
     
 typedef struct _ambi_enc
 {
     float inputFrameTD[MAX_NUM_INPUTS][FRAME_SIZE];
     float outputFrameTD[MAX_NUM_SH_SIGNALS][FRAME_SIZE];
     float fs;
-    int recalc_SH_FLAG[MAX_NUM_INPUTS];
+    int recalc_SH_FLAG[MAX_NUM_INPUTS]; /* (audio thread only, as is the SH state below) */
+    volatile int refreshSH; /* 1: recalculate the SHs of all sources (see "ambi_enc_refreshParams") */
     float Y[MAX_NUM_SH_SIGNALS][MAX_NUM_INPUTS];
-    int order;
+    float Y_active[MAX_NUM_SH_SIGNALS][MAX_NUM_INPUTS]; /* columns of "Y" of the static active sources, if not all are */
+    float Y_prev[MAX_NUM_SH_SIGNALS][MAX_NUM_INPUTS]; /* SHs of the previous direction of each moving source */
+    int Y_valid[MAX_NUM_INPUTS]; /* 1: "Y" holds the SHs of the source's last direction, to interpolate from if it moves */
+    int sourceMoving[MAX_NUM_INPUTS]; /* 1: the SHs of the source are interpolated from "Y_prev" to "Y" over this frame */
+    float interpolator[FRAME_SIZE]; /* interpolation weights of the new SHs over the samples of a frame */
+    float interpFrameTD[FRAME_SIZE]; /* input of a moving source, weighted by "interpolator" */
+    float Y_dirs_deg[MAX_NUM_INPUTS][2]; /* direction of each source that "Y" was calculated for */
+    int order; /* order that "Y" was calculated for */
+    int nSources; /* number of sources that "Y" was calculated for */
+    
+    /* source activity (audio thread only, except for the count) */
+    int sourceActive[MAX_NUM_INPUTS]; /* 0: the source is silent; its encoding is skipped */
+    int nSilentFrames[MAX_NUM_INPUTS]; /* number of consecutive silent frames of each source */
+    volatile int nActiveSources;
     
     /* user parameters */
-    int nSources;
-    int new_nSources;
-    float src_dirs_deg[MAX_NUM_INPUTS][2];
-    CH_ORDER chOrdering;
-    NORM_TYPES norm;
-    OUTPUT_ORDERS outputOrderPreset;
+    void* hUserPars; /* parameter block of "userPars"; edited by the set functions, read by the audio thread */
+    void* hProf;                             /* per-stage timing of the processing loop (see saf_profiler.h) */
     
 } ambi_enc_data;
     
+/* Encodes a moving source, adding it to "outputFrameTD": its SHs are interpolated linearly from "Y_prev" to "Y" over
+ * the samples of the frame, fused with the encoding into a single pass over each SH signal, which the compiler can
+ * vectorise */
+void ambi_enc_encodeMovingSource(void* const hAmbi,                /* ambi_enc handle */
+                                 int src,                        /* source index */
+                                 const float* input,             /* source signal; FRAME_SIZE x 1 */
+                                 int nSH);                       /* number of SH signals */
+    
 /* Loads directions from preset */
 void ambi_enc_loadPreset(PRESETS preset,                         /* PRESET enum */
                          float dirs_deg[MAX_NUM_INPUTS][2],      /* source/loudspeaker directions */
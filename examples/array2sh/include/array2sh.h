@@ -136,6 +136,11 @@ void array2sh_process(void* const hA2sh,                /* hA2sh handle */
                       int nOutputs,                     /* number of channels in 'outputs' matrix */
                       int nSamples,                     /* number of samples in 'inputs' and 'outputs' matrices */
                       int isPlaying);                   /* flag, 1: if inputs actually has audio in it */
+
+/* blocks until the worker thread has finished (re)computing the time-frequency transform and encoding matrix, which are
+ * then picked up by the next call to "array2sh_process" (e.g. for offline rendering or benchmarking). Must not be
+ * called from the audio thread */
+void array2sh_waitForCodecInit(void* const hA2sh);       /* hA2sh handle */
     
     
 /*****************/
@@ -232,6 +237,12 @@ float** array2sh_getbN_modal(void* const hA2sh, int* nCurves, int* nFreqPoints);
 float* array2sh_getSpatialCorrelation_Handle(void* const hA2sh, int* nCurves, int* nFreqPoints);
 
 float* array2sh_getLevelDifference_Handle(void* const hA2sh, int* nCurves, int* nFreqPoints);
+
+/* returns the processing delay in samples, introduced by the time-frequency transform */
+int array2sh_getProcessingDelay(void);
+
+/* returns the profiler handle, for "saf_profiler_getStats" (NULL, unless built with SAF_ENABLE_PROFILER) */
+void* array2sh_getProfiler(void* const hA2sh);
     
 #ifdef __cplusplus
 }
@@ -41,24 +41,28 @@ void array2sh_create
     array2sh_data* pData = (array2sh_data*)malloc(sizeof(array2sh_data));
     if (pData == NULL) { return;/*error*/ }
     *phA2sh = (void*)pData;
+    saf_profiler_create(&(pData->hProf));
     int band, t, ch;
+    userPars* up;
      
     /* defualt parameters */
+    saf_paramBlock_create(&(pData->hUserPars), sizeof(userPars), 2);
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->regType = REG_TIKHONOV;
+    up->regPar = 15.0f;
+    up->chOrdering = CH_ACN;
+    up->norm = NORM_N3D;
+    up->c = 343.0f;
+    up->gain_dB = 0.0f;
+    up->maxFreq = 20e3f;
+    array2sh_initArray(&(up->arraySpecs), PRESET_DEFAULT, 1); //PRESET_DEFAULT, 1);
     array2sh_createArray(&(pData->arraySpecs)); 
-    pData->regType = REG_TIKHONOV;
-    pData->regPar = 15.0f;
-    pData->chOrdering = CH_ACN;
-    pData->norm = NORM_N3D;
-    pData->c = 343.0f;
-    pData->gain_dB = 0.0f;
-    pData->maxFreq = 20e3f;
-    arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
-    array2sh_initArray(arraySpecs, PRESET_DEFAULT, 1); //PRESET_DEFAULT, 1);
+    memcpy(pData->arraySpecs, &(up->arraySpecs), sizeof(arrayPars));
+    saf_paramBlock_publish(pData->hUserPars);
     pData->reinitSHTmatrixFLAG = 1;
      
-    /* time-frequency transform + buffers */
-    pData->hSTFT = NULL;
-    pData->STFTInputFrameTF=NULL;
+    /* time-frequency transform + buffers (the TFT itself is built on the worker thread, see "array2sh_codecWorker") */
+    pData->fs = 0;
     pData->STFTOutputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, NUM_SH_SIGNALS, sizeof(complexVector));
     for(t=0; t<TIME_SLOTS; t++) {
         for(ch=0; ch< NUM_SH_SIGNALS; ch++) {
@@ -66,10 +70,14 @@ void array2sh_create
             pData->STFTOutputFrameTF[t][ch].im = (float*)calloc(HYBRID_BANDS, sizeof(float));
         }
     }
-    pData->tempHopFrameTD = NULL;
     for(band=0; band <HYBRID_BANDS; band++)
         pData->freqVector[band] =  (float)__afCenterFreq48e3[band];
     pData->reinitTFTFLAG = 1;
+    pData->pars = NULL;
+    pData->pendingPars = NULL;
+    pData->retiredPars = NULL;
+    pData->tft = NULL;
+    pData->retiredTFT = NULL;
     
     /* display related stuff */
     pData->bN_modal_dB = (float**)malloc2d(HYBRID_BANDS-1, SH_ORDER + 1, sizeof(float));
@@ -79,6 +87,7 @@ void array2sh_create
     pData->disp_freqVector = (float*)malloc((HYBRID_BANDS-1)*sizeof(float));
     
     pData->recalcEvalFLAG = 1;
+    saf_worker_create(&(pData->hWorker), array2sh_codecWorker, (void*)pData);
 }
 
 void array2sh_destroy
@@ -87,23 +96,28 @@ void array2sh_destroy
 )
 {
     array2sh_data *pData = (array2sh_data*)(*phM2sh);
-    arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
+    codecPars* pars, *nextPars;
+    tftPars* tft, *nextTFT;
     int t, ch;
 
     if (pData != NULL) {
+        /* stop the worker thread first, as it may still be building */
+        saf_worker_destroy(&(pData->hWorker));
+        
+        /* encoding matrices: current, pending (along with any new TFT) and retired */
+        array2sh_freeCodecPars(&(pData->pars));
+        pars = (codecPars*)saf_atomic_exchangep(&(pData->pendingPars), NULL);
+        array2sh_freeCodecPars(&pars);
+        for(pars = (codecPars*)pData->retiredPars; pars!=NULL; pars = nextPars){
+            nextPars = pars->next;
+            array2sh_freeCodecPars(&pars);
+        }
+        
         /* TFT stuff */
-        if (pData->hSTFT != NULL) {
-            afSTFTfree(pData->hSTFT);
-            if(pData->STFTInputFrameTF!=NULL){
-                for (t = 0; t<TIME_SLOTS; t++) {
-                    for (ch = 0; ch< arraySpecs->Q; ch++) {
-                        free(pData->STFTInputFrameTF[t][ch].re);
-                        free(pData->STFTInputFrameTF[t][ch].im);
-                    }
-                }
-            }
-            free2d((void**)pData->STFTInputFrameTF, TIME_SLOTS);
-            free2d((void**)pData->tempHopFrameTD, arraySpecs->Q);
+        array2sh_freeTFT(&(pData->tft));
+        for(tft = (tftPars*)pData->retiredTFT; tft!=NULL; tft = nextTFT){
+            nextTFT = tft->next;
+            array2sh_freeTFT(&tft);
         }
         for (t = 0; t<TIME_SLOTS; t++) {
             for(ch=0; ch< NUM_SH_SIGNALS; ch++) {
@@ -113,12 +127,14 @@ void array2sh_destroy
         }
         free2d((void**)pData->STFTOutputFrameTF, TIME_SLOTS);
         array2sh_destroyArray(&(pData->arraySpecs));
+        saf_paramBlock_destroy(&(pData->hUserPars));
         
         /* Display stuff */
         free2d((void**)pData->bN_modal_dB, HYBRID_BANDS-1);
         free2d((void**)pData->bN_inv_dB, HYBRID_BANDS-1);
         free(pData->disp_freqVector);
         
+        saf_profiler_destroy(&(pData->hProf));
         free(pData);
         pData = NULL;
     }
@@ -145,6 +161,10 @@ void array2sh_init
         else /* assume 48e3 */
             pData->disp_freqVector[band] =  (float)__afCenterFreq48e3[band+1];
     }
+    pData->fs = sampleRate;
+    
+    /* the encoding matrix depends on the frequency vector */
+    array2sh_requestInit(hA2sh, &(pData->reinitSHTmatrixFLAG));
 }
 
 void array2sh_process
@@ -159,42 +179,50 @@ void array2sh_process
 )
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
+    const userPars* up;
+    codecPars* pars, *prevPars, *newPars;
+    tftPars* tft;
     int n, t, sample, ch, i, band, Q;
     int o[SH_ORDER+2];
     const float_complex calpha = cmplxf(1.0f,0.0f), cbeta = cmplxf(0.0f, 0.0f);
     CH_ORDER chOrdering;
     NORM_TYPES norm;
-    float gain_lin, maxFreq;
+    float gain_lin, maxFreq, fadeIn, fadeOut;
     
-    /* reinit TF transform, before reinitialising bNs */
-    if (pData->reinitTFTFLAG==1) {
-        pData->reinitTFTFLAG = 2;
-        array2sh_initTFT(hA2sh);
-        pData->reinitTFTFLAG=0;
-    }
-    if (pData->reinitSHTmatrixFLAG==1) {
-        pData->reinitSHTmatrixFLAG = 2;
-        /* compute encoding matrix */
-        array2sh_calculate_sht_matrix(hA2sh);
-        /* calculate magnitude response curves */
-        array2sh_calculate_mag_curves(hA2sh);
-        pData->reinitSHTmatrixFLAG = 0;
-    }
-    if(pData->recalcEvalFLAG == 1){
-        pData->recalcEvalFLAG = 2;
-        array2sh_evaluateSHTfilters(hA2sh);
-        pData->recalcEvalFLAG = 0;
+    /* consistent snapshot of the user parameters for this frame */
+    up = (const userPars*)saf_paramBlock_read(pData->hUserPars, USER_PARS_AUDIO);
+    
+    /* pick up the encoding matrix (and TFT) newly published by the worker thread (see "array2sh_codecWorker"); the
+     * previous encoding matrix is kept for this frame, in order to crossfade between the two, unless the TFT has been
+     * replaced too. The previous ones are then handed back to the worker thread for freeing */
+    prevPars = NULL;
+    newPars = (codecPars*)saf_atomic_exchangep(&(pData->pendingPars), NULL);
+    if(newPars!=NULL){
+        if(newPars->tft!=NULL){
+            array2sh_retireTFT(hA2sh, pData->tft);
+            pData->tft = newPars->tft;
+            newPars->tft = NULL;
+            array2sh_retireCodecPars(hA2sh, pData->pars);
+        }
+        else if(pData->pars!=NULL && pData->pars->Q==newPars->Q)
+            prevPars = pData->pars;
+        else
+            array2sh_retireCodecPars(hA2sh, pData->pars);
+        pData->pars = newPars;
     }
-    if ((nSamples == FRAME_SIZE) && (isPlaying == 1) && !(pData->recalcEvalFLAG) &&
-        !(pData->reinitSHTmatrixFLAG) && !(pData->reinitTFTFLAG)) {
+    tft = pData->tft;
+    pars = pData->pars;
+    
+    if ((nSamples == FRAME_SIZE) && (isPlaying == 1) && (tft!=NULL) && (pars!=NULL) && (tft->Q==pars->Q)) {
+        SAF_RT_SCOPE_BEGIN;
+        SAF_PROFILE_BEGIN(pData->hProf, "total");
         /* prep */
         for(n=0; n<SH_ORDER+2; n++){  o[n] = n*n;  }
-        chOrdering = pData->chOrdering;
-        norm = pData->norm;
-        gain_lin = powf(10.0f, pData->gain_dB/20.0f);
-        maxFreq = pData->maxFreq;
-        Q = arraySpecs->Q;
+        chOrdering = up->chOrdering;
+        norm = up->norm;
+        gain_lin = powf(10.0f, up->gain_dB/20.0f);
+        maxFreq = up->maxFreq;
+        Q = tft->Q;
         
         /* Load time-domain data */
         for(i=0; i < nInputs; i++)
@@ -203,33 +231,53 @@ void array2sh_process
             memset(pData->inputFrameTD[i], 0, FRAME_SIZE * sizeof(float));
         
         /* Apply time-frequency transform (TFT) */
+        SAF_PROFILE_BEGIN(pData->hProf, "afSTFTforward");
         for ( t=0; t< TIME_SLOTS; t++) {
             for( ch=0; ch < Q; ch++)
                 for ( sample=0; sample < HOP_SIZE; sample++)
-                    pData->tempHopFrameTD[ch][sample] = pData->inputFrameTD[ch][sample + t*HOP_SIZE];
-            afSTFTforward(pData->hSTFT, (float**)pData->tempHopFrameTD, (complexVector*)pData->STFTInputFrameTF[t]);
+                    tft->tempHopFrameTD[ch][sample] = pData->inputFrameTD[ch][sample + t*HOP_SIZE];
+            afSTFTforward(tft->hSTFT, (float**)tft->tempHopFrameTD, (complexVector*)tft->STFTInputFrameTF[t]);
         }
         for(band=0; band<HYBRID_BANDS; band++){
             if(pData->freqVector[band] < maxFreq){
                 for( ch=0; ch < Q; ch++)
                     for ( t=0; t<TIME_SLOTS; t++)
-                        pData->inputframeTF[band][ch][t] = cmplxf(pData->STFTInputFrameTF[t][ch].re[band], pData->STFTInputFrameTF[t][ch].im[band]);
+                        pData->inputframeTF[band][ch][t] = cmplxf(tft->STFTInputFrameTF[t][ch].re[band], tft->STFTInputFrameTF[t][ch].im[band]);
                 for(; ch < MAX_NUM_SENSORS; ch++)
                     memset(pData->inputframeTF[band][ch], 0, TIME_SLOTS*sizeof(float_complex));
             }
         }
+        SAF_PROFILE_END(pData->hProf, "afSTFTforward");
         
         /* Apply spherical harmonic transform */
+        SAF_PROFILE_BEGIN(pData->hProf, "sht");
         for(band=0; band<HYBRID_BANDS; band++){
             if(pData->freqVector[band] < maxFreq){
                 cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, NUM_SH_SIGNALS, TIME_SLOTS, Q, &calpha,
-                            pData->W[band], MAX_NUM_SENSORS,
+                            pars->W[band], MAX_NUM_SENSORS,
                             pData->inputframeTF[band], TIME_SLOTS, &cbeta,
                             pData->SHframeTF[band], TIME_SLOTS);
+                
+                /* crossfade from the output of the previous encoding matrix over the frame */
+                if(prevPars!=NULL){
+                    cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, NUM_SH_SIGNALS, TIME_SLOTS, Q, &calpha,
+                                prevPars->W[band], MAX_NUM_SENSORS,
+                                pData->inputframeTF[band], TIME_SLOTS, &cbeta,
+                                pData->SHframeTF_prev[band], TIME_SLOTS);
+                    for (t = 0; t < TIME_SLOTS; t++) {
+                        fadeIn = (float)(t+1)/(float)TIME_SLOTS;
+                        fadeOut = 1.0f - fadeIn;
+                        for (ch = 0; ch < NUM_SH_SIGNALS; ch++)
+                            pData->SHframeTF[band][ch][t] = ccaddf(crmulf(pData->SHframeTF[band][ch][t], fadeIn),
+                                                                   crmulf(pData->SHframeTF_prev[band][ch][t], fadeOut));
+                    }
+                }
             }
         }
+        SAF_PROFILE_END(pData->hProf, "sht");
         
         /* inverse-TFT */
+        SAF_PROFILE_BEGIN(pData->hProf, "afSTFTinverse");
         for (band = 0; band < HYBRID_BANDS; band++) {
             if(pData->freqVector[band] < maxFreq){
                 for (ch = 0; ch < NUM_SH_SIGNALS; ch++) {
@@ -249,14 +297,15 @@ void array2sh_process
             }
         }
         for (t = 0; t < TIME_SLOTS; t++) {
-            afSTFTinverse(pData->hSTFT, pData->STFTOutputFrameTF[t], pData->tempHopFrameTD);
+            afSTFTinverse(tft->hSTFT, pData->STFTOutputFrameTF[t], tft->tempHopFrameTD);
             for (ch = 0; ch < MIN(NUM_SH_SIGNALS, nOutputs); ch++)
                 for (sample = 0; sample < HOP_SIZE; sample++)
-                    outputs[ch][sample + t* HOP_SIZE] = pData->tempHopFrameTD[ch][sample] * gain_lin;
+                    outputs[ch][sample + t* HOP_SIZE] = tft->tempHopFrameTD[ch][sample] * gain_lin;
             for (; ch < nOutputs; ch++)
                 for (sample = 0; sample < HOP_SIZE; sample++)
                     outputs[ch][sample + t* HOP_SIZE] = 0.0f;
         }
+        SAF_PROFILE_END(pData->hProf, "afSTFTinverse");
         
         /* apply normalisation scheme */
         switch(norm){
@@ -269,11 +318,22 @@ void array2sh_process
                             outputs[ch][i] /= sqrtf(2.0f*(float)n+1.0f);
                 break;
         }
+        SAF_PROFILE_END(pData->hProf, "total");
+        SAF_RT_SCOPE_END;
     }
     else{
         for (ch=0; ch < nOutputs; ch++)
             memset(outputs[ch],0, FRAME_SIZE*sizeof(float));
     }
+    
+    /* the previous encoding matrix is no longer needed */
+    array2sh_retireCodecPars(hA2sh, prevPars);
+}
+
+void array2sh_waitForCodecInit(void* const hA2sh)
+{
+    array2sh_data *pData = (array2sh_data*)(hA2sh);
+    saf_worker_wait(pData->hWorker);
 }
 
 /* Set Functions */
@@ -281,162 +341,224 @@ void array2sh_process
 void array2sh_refreshSettings(void* const hA2sh)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    pData->reinitSHTmatrixFLAG = 1;
-    pData->reinitTFTFLAG = 1;
+    saf_atomic_storei(&(pData->reinitSHTmatrixFLAG), 1);
+    array2sh_requestInit(hA2sh, &(pData->reinitTFTFLAG));
 }
 
 void array2sh_evaluateFilters(void* const hA2sh)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    pData->recalcEvalFLAG = 1;
+    array2sh_requestInit(hA2sh, &(pData->recalcEvalFLAG));
 }
 
 void array2sh_setPreset(void* const hA2sh, int preset)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
+    userPars* up;
+    int prevQ, newQ;
     
-    array2sh_initArray(arraySpecs,(PRESETS)preset, 0); 
-    pData->reinitTFTFLAG = arraySpecs->Q != arraySpecs->newQ ? 1 : 0;
-    pData->reinitSHTmatrixFLAG = 1;
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    prevQ = up->arraySpecs.newQ;
+    array2sh_initArray(&(up->arraySpecs),(PRESETS)preset, 0); 
+    newQ = up->arraySpecs.newQ;
+    saf_paramBlock_publish(pData->hUserPars);
+    if(prevQ != newQ)
+        saf_atomic_storei(&(pData->reinitTFTFLAG), 1); /* (do not cancel a pending reinitialisation) */
+    array2sh_requestInit(hA2sh, &(pData->reinitSHTmatrixFLAG));
 }
 
 void array2sh_setSensorAzi_rad(void* const hA2sh, int index, float newAzi_rad)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
+    userPars* up;
     
-    arraySpecs->sensorCoords_rad[index][0] = newAzi_rad;
-    arraySpecs->sensorCoords_deg[index][0] = newAzi_rad * (180.0f/M_PI);
-    pData->reinitSHTmatrixFLAG = 1;
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->arraySpecs.sensorCoords_rad[index][0] = newAzi_rad;
+    up->arraySpecs.sensorCoords_deg[index][0] = newAzi_rad * (180.0f/M_PI);
+    saf_paramBlock_publish(pData->hUserPars);
+    array2sh_requestInit(hA2sh, &(pData->reinitSHTmatrixFLAG));
 }
 
 void array2sh_setSensorElev_rad(void* const hA2sh, int index, float newElev_rad)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
+    userPars* up;
     
-    arraySpecs->sensorCoords_rad[index][1] = newElev_rad;
-    arraySpecs->sensorCoords_deg[index][1] = newElev_rad * (180.0f/M_PI);
-    pData->reinitSHTmatrixFLAG = 1;
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->arraySpecs.sensorCoords_rad[index][1] = newElev_rad;
+    up->arraySpecs.sensorCoords_deg[index][1] = newElev_rad * (180.0f/M_PI);
+    saf_paramBlock_publish(pData->hUserPars);
+    array2sh_requestInit(hA2sh, &(pData->reinitSHTmatrixFLAG));
 }
 
 void array2sh_setSensorAzi_deg(void* const hA2sh, int index, float newAzi_deg)
 
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
+    userPars* up;
     
-    arraySpecs->sensorCoords_rad[index][0] = newAzi_deg * (M_PI/180.0f);
-    arraySpecs->sensorCoords_deg[index][0] = newAzi_deg;
-    pData->reinitSHTmatrixFLAG = 1;
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->arraySpecs.sensorCoords_rad[index][0] = newAzi_deg * (M_PI/180.0f);
+    up->arraySpecs.sensorCoords_deg[index][0] = newAzi_deg;
+    saf_paramBlock_publish(pData->hUserPars);
+    array2sh_requestInit(hA2sh, &(pData->reinitSHTmatrixFLAG));
 }
 
 void array2sh_setSensorElev_deg(void* const hA2sh, int index, float newElev_deg)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
+    userPars* up;
     
-    arraySpecs->sensorCoords_rad[index][1] = newElev_deg * (M_PI/180.0f);
-    arraySpecs->sensorCoords_deg[index][1] = newElev_deg;
-    pData->reinitSHTmatrixFLAG = 1;
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->arraySpecs.sensorCoords_rad[index][1] = newElev_deg * (M_PI/180.0f);
+    up->arraySpecs.sensorCoords_deg[index][1] = newElev_deg;
+    saf_paramBlock_publish(pData->hUserPars);
+    array2sh_requestInit(hA2sh, &(pData->reinitSHTmatrixFLAG));
 }
 
 void array2sh_setNumSensors(void* const hA2sh, int newQ)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
+    userPars* up;
     
-    arraySpecs->newQ = newQ <= NUM_SH_SIGNALS ? NUM_SH_SIGNALS : newQ;
-    pData->reinitTFTFLAG = arraySpecs->Q != arraySpecs->newQ ? 1 : 0;
-    pData->reinitSHTmatrixFLAG = arraySpecs->Q != arraySpecs->newQ ? 1 : 0;
+    newQ = newQ <= NUM_SH_SIGNALS ? NUM_SH_SIGNALS : newQ;
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    if(up->arraySpecs.newQ != newQ){ /* (do not cancel a pending reinitialisation) */
+        up->arraySpecs.newQ = newQ;
+        saf_paramBlock_publish(pData->hUserPars);
+        array2sh_requestInit(hA2sh, &(pData->reinitTFTFLAG));
+    }
+    else
+        saf_paramBlock_release(pData->hUserPars);
 }
 
 void array2sh_setr(void* const hA2sh, float newr)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
-    arraySpecs->r = newr;
-    pData->reinitSHTmatrixFLAG = 1;
+    userPars* up;
+    
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->arraySpecs.r = newr;
+    saf_paramBlock_publish(pData->hUserPars);
+    array2sh_requestInit(hA2sh, &(pData->reinitSHTmatrixFLAG));
 }
 
 void array2sh_setR(void* const hA2sh, float newR)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
-    arraySpecs->R = newR;
-    pData->reinitSHTmatrixFLAG = 1;
+    userPars* up;
+    
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->arraySpecs.R = newR;
+    saf_paramBlock_publish(pData->hUserPars);
+    array2sh_requestInit(hA2sh, &(pData->reinitSHTmatrixFLAG));
 }
 
 void array2sh_setAdmittance(void* const hA2sh, float newAdmittance)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
-    arraySpecs->admittance = newAdmittance;
-    pData->reinitSHTmatrixFLAG = 1;
+    userPars* up;
+    
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->arraySpecs.admittance = newAdmittance;
+    saf_paramBlock_publish(pData->hUserPars);
+    array2sh_requestInit(hA2sh, &(pData->reinitSHTmatrixFLAG));
 }
 
 void array2sh_setArrayType(void* const hA2sh, int newType)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
-    arraySpecs->arrayType = (ARRAY_TYPES)newType;
-    pData->reinitSHTmatrixFLAG = 1;
+    userPars* up;
+    
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->arraySpecs.arrayType = (ARRAY_TYPES)newType;
+    saf_paramBlock_publish(pData->hUserPars);
+    array2sh_requestInit(hA2sh, &(pData->reinitSHTmatrixFLAG));
 }
 
 void array2sh_setWeightType(void* const hA2sh, int newType)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
+    userPars* up;
     
-    arraySpecs->weightType = (WEIGHT_TYPES)newType;
-    pData->reinitSHTmatrixFLAG = 1;
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->arraySpecs.weightType = (WEIGHT_TYPES)newType;
+    saf_paramBlock_publish(pData->hUserPars);
+    array2sh_requestInit(hA2sh, &(pData->reinitSHTmatrixFLAG));
 }
 
 void array2sh_setRegType(void* const hA2sh, int newType)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    pData->regType = (REG_TYPES)newType;
-    pData->reinitSHTmatrixFLAG = 1;
+    userPars* up;
+    
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->regType = (REG_TYPES)newType;
+    saf_paramBlock_publish(pData->hUserPars);
+    array2sh_requestInit(hA2sh, &(pData->reinitSHTmatrixFLAG));
 }
 
 void array2sh_setRegPar(void* const hA2sh, float newVal)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    pData->regPar = newVal;
-    pData->reinitSHTmatrixFLAG = 1;
+    userPars* up;
+    
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->regPar = newVal;
+    saf_paramBlock_publish(pData->hUserPars);
+    array2sh_requestInit(hA2sh, &(pData->reinitSHTmatrixFLAG));
 }
 
 void array2sh_setChOrder(void* const hA2sh, int newOrder)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    pData->chOrdering = (CH_ORDER)newOrder;
+    userPars* up;
+    
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->chOrdering = (CH_ORDER)newOrder;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void array2sh_setNormType(void* const hA2sh, int newType)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    pData->norm = (NORM_TYPES)newType;
+    userPars* up;
+    
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->norm = (NORM_TYPES)newType;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void array2sh_setc(void* const hA2sh, float newc)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    pData->c = newc;
-    pData->reinitSHTmatrixFLAG = 1;
+    userPars* up;
+    
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->c = newc;
+    saf_paramBlock_publish(pData->hUserPars);
+    array2sh_requestInit(hA2sh, &(pData->reinitSHTmatrixFLAG));
 }
 
 
 void array2sh_setGain(void* const hA2sh, float newGain)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    pData->gain_dB = newGain;
+    userPars* up;
+    
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->gain_dB = newGain;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void array2sh_setMaxFreq(void* const hA2sh, float newF)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    pData->maxFreq = newF;
+    userPars* up;
+    
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->maxFreq = newF;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 
@@ -445,37 +567,37 @@ void array2sh_setMaxFreq(void* const hA2sh, float newF)
 float array2sh_getSensorAzi_rad(void* const hA2sh, int index)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
-    return arraySpecs->sensorCoords_rad[index][0];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->arraySpecs.sensorCoords_rad[index][0];
 }
 
 float array2sh_getSensorElev_rad(void* const hA2sh, int index)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
-    return arraySpecs->sensorCoords_rad[index][1];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->arraySpecs.sensorCoords_rad[index][1];
 }
 
 float array2sh_getSensorAzi_deg(void* const hA2sh, int index)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
-    return arraySpecs->sensorCoords_deg[index][0];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->arraySpecs.sensorCoords_deg[index][0];
 }
 
 float array2sh_getSensorElev_deg(void* const hA2sh, int index)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
-    return arraySpecs->sensorCoords_deg[index][1];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->arraySpecs.sensorCoords_deg[index][1];
 }
 
 int array2sh_getNumSensors(void* const hA2sh)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
    // return arraySpecs->Q;
-    return arraySpecs->newQ; /* return the new Q, incase the plug-in is still waiting for a refresh */
+    return up->arraySpecs.newQ; /* return the new Q, incase the plug-in is still waiting for a refresh */
 }
 
 int array2sh_getMaxNumSensors(void)
@@ -486,78 +608,85 @@ int array2sh_getMaxNumSensors(void)
 float array2sh_getr(void* const hA2sh)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
-    return arraySpecs->r;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->arraySpecs.r;
 }
 
 float array2sh_getR(void* const hA2sh)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
-    return arraySpecs->R;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->arraySpecs.R;
 }
 
 float array2sh_getAdmittance(void* const hA2sh)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
-    return arraySpecs->admittance;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->arraySpecs.admittance;
 }
 
 int array2sh_getArrayType(void* const hA2sh)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
-    return (int)arraySpecs->arrayType;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->arraySpecs.arrayType;
 }
 
 int array2sh_getWeightType(void* const hA2sh)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
-    return (int)arraySpecs->weightType;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->arraySpecs.weightType;
 }
 
 int array2sh_getRegType(void* const hA2sh)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    return (int)pData->regType;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->regType;
 }
 
 float array2sh_getRegPar(void* const hA2sh)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    return pData->regPar;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->regPar;
 }
 
 int array2sh_getChOrder(void* const hA2sh)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    return (int)pData->chOrdering;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->chOrdering;
 }
 
 int array2sh_getNormType(void* const hA2sh)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    return (int)pData->norm;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->norm;
 }
 
 float array2sh_getc(void* const hA2sh)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    return pData->c;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->c;
 }
 
 float array2sh_getGain(void* const hA2sh)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    return pData->gain_dB;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->gain_dB;
 }
 
 float array2sh_getMaxFreq(void* const hA2sh)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
-    return pData->maxFreq;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->maxFreq;
 }
 
 float* array2sh_getFreqVector(void* const hA2sh, int* nFreqPoints)
@@ -599,6 +728,17 @@ float* array2sh_getLevelDifference_Handle(void* const hA2sh, int* nCurves, int*
     return pData->lSH;
 }
 
+int array2sh_getProcessingDelay(void)
+{
+    return afSTFTdelay(HOP_SIZE, 0, 1);
+}
+
+void* array2sh_getProfiler(void* const hA2sh)
+{
+    array2sh_data *pData = (array2sh_data*)(hA2sh);
+    return pData->hProf;
+}
+
 
 
 
@@ -1,11 +0,0 @@
-/* Generated using MatLab on: 19-Jun-2017, using a script by Leo McCormack */
-/* (leo.t.mccormack@gmail.com) */
-
-const double __afCenterFreq48e3[133] =
-{    0.000000000, 140.644316361, 234.355478108, 328.144332285, 421.855497937, 515.644326841, 609.355515147, 703.144330614, 796.855543885, 937.500032020, 1125.000017338, 1312.500035449, 1500.000075751, 1687.500031782, 1875.000024239, 2062.499975101, 2250.000053703, 2437.500044271, 2625.000002315, 2812.500019782, 3000.000041692, 3187.499983930, 3374.999995137, 3562.499994173, 3750.000018557, 3937.500021643, 4125.000009859, 4312.500011528, 4500.000010423, 4687.500014446, 4875.000013588, 5062.500013570, 5250.000007575, 5437.500010288, 5625.000004178, 5812.500003421, 6000.000005158, 6187.500003404, 6375.000003488, 6562.500007191, 6750.000005972, 6937.500008499, 7125.000006936, 7312.500008549, 7500.000005032, 7687.500004875, 7875.000004878, 8062.500007586, 8250.000006218, 8437.499999805, 8625.000000113, 8812.499997984, 9000.000008860, 9187.500004401, 9375.000001529, 9562.500006565, 9750.000006335, 9937.499999557, 10125.000002928, 10312.500002384, 10500.000004406, 10687.500002820, 10875.000001403, 11062.500002219, 11250.000001097, 11437.500001292, 11625.000000815, 11812.500000140, 12000.000000000, 12187.499999584, 12374.999999473, 12562.499999294, 12749.999998799, 12937.499997514, 13124.999998543, 13312.499997602, 13499.999995904, 13687.499996961, 13874.999996550, 14062.500000495, 14249.999993960, 14437.499993440, 14624.999997861, 14812.499995461, 14999.999991137, 15187.500001756, 15374.999999428, 15562.500000999, 15749.999993809, 15937.499992382, 16124.999995683, 16312.499995240, 16499.999994365, 16687.499991354, 16874.999992234, 17062.499991361, 17249.999994298, 17437.499992410, 17624.999995960, 17812.499995945, 17999.999994836, 18187.499996913, 18374.999996125, 18562.499990092, 18749.999991865, 18937.499986965, 19124.999985762, 19312.499985261, 19499.999989766, 19687.499988292, 19874.999989851, 20062.499978542, 20249.999981602, 20437.500005879, 20625.000004853, 20812.500015815, 20999.999958305, 21187.499980259, 21374.999997733, 21562.499955794, 21749.999946298, 21937.500025004, 22124.999975461, 22312.499968567, 22499.999924162, 22687.499964503, 22874.999982475, 23062.499968048, 23249.999976609, 23437.499982579, 23624.999922020, 23812.499893152, 24000.000000000    };
-
-const double __afCenterFreq44100[133] =
-{    0.000000000, 129.216965656349, 215.314095511940, 301.482605286864, 387.579738729321, 473.748225285069, 559.845379541353, 646.013853751194, 732.111030944280, 861.328154418396, 1033.59376592907, 1205.85940756884, 1378.12506959593, 1550.39065419983, 1722.65627226944, 1894.92185212374, 2067.18754933984, 2239.45316567436, 2411.71875212704, 2583.98439317445, 2756.25003830437, 2928.51561023581, 3100.78124553194, 3273.04686964626, 3445.31251704880, 3617.57814488494, 3789.84375905786, 3962.10938559150, 4134.37500957638, 4306.64063827204, 4478.90626248374, 4651.17188746737, 4823.43750695936, 4995.70313445178, 5167.96875383855, 5340.23437814308, 5512.50000473869, 5684.76562812748, 5857.03125320457, 6029.29688160671, 6201.56250548701, 6373.82813280869, 6546.09375637265, 6718.35938285452, 6890.62500462325, 7062.89062947914, 7235.15625448137, 7407.42188196954, 7579.68750571293, 7751.95312482074, 7924.21875010336, 8096.48437314815, 8268.75000813977, 8441.01562904346, 8613.28125140462, 8785.54688103121, 8957.81250582069, 9130.07812459266, 9302.34375268968, 9474.60937719035, 9646.87500404805, 9819.14062759121, 9991.40625128884, 10163.6718770385, 10335.9375010079, 10508.2031261869, 10680.4687507484, 10852.7343751285, 11025.0000000001, 11197.2656246178, 11369.5312495160, 11541.7968743512, 11714.0624988969, 11886.3281227156, 12058.5937486617, 12230.8593727970, 12403.1249962367, 12575.3906222075, 12747.6562468300, 12919.9218754546, 13092.1874944509, 13264.4531189729, 13436.7187480346, 13608.9843708301, 13781.2499918574, 13953.5156266137, 14125.7812494749, 14298.0468759180, 14470.3124943117, 14642.5781180010, 14814.8437460342, 14987.1093706271, 15159.3749948230, 15331.6406170568, 15503.9062428654, 15676.1718670625, 15848.4374947616, 16020.7031180267, 16192.9687462880, 16365.2343712743, 16537.4999952557, 16709.7656221640, 16882.0312464398, 17054.2968658973, 17226.5624925260, 17398.8281130242, 17571.0937369185, 17743.3593614590, 17915.6249905974, 18087.8906142430, 18260.1562406759, 18432.4218552854, 18604.6874830966, 18776.9531304013, 18949.2187544585, 19121.4843895303, 19293.7499616923, 19466.0156068630, 19638.2812479176, 19810.5468343861, 19982.8124506613, 20155.0781479723, 20327.3437274546, 20499.6093461210, 20671.8749303238, 20844.1405923868, 21016.4062338989, 21188.6718456437, 21360.9374785099, 21533.2031089940, 21705.4686783562, 21877.7342768337, 22050.0000000000    };
-
-
-
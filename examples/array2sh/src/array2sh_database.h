@@ -1,13 +0,0 @@
-/*
-    Leo McCormack
-    ../database/ARRAY2SH/array2sh_database.h
-    Generated using MatLab on: 19-Jun-2017 
-*/
-
-#ifndef __ARRAY2SH_DATABASE_INCLUDED__
-#define __ARRAY2SH_DATABASE_INCLUDED__
-
-extern const double __afCenterFreq48e3[133];
-extern const double __afCenterFreq44100[133];
-
-#endif /* __ARRAY2SH_DATABASE_INCLUDED__ */
@@ -185,6 +185,7 @@ static double_complex bessel_hl2(int l, double z)
 static void array2sh_calculate_bN
 (
     void* const hA2sh,
+    const userPars* up,
     float freqVector[HYBRID_BANDS]
 )
 {
@@ -197,8 +198,8 @@ static void array2sh_calculate_bN
     double_complex jl2, hl2, Jl2, Jl2_imag;
     
     for(band=0; band<HYBRID_BANDS; band++){
-        kr[band] = 2.0*M_PI*(double)freqVector[band] * (double)arraySpecs->r / (double)pData->c;
-        kR[band] = 2.0*M_PI*(double)freqVector[band] * (double)arraySpecs->R / (double)pData->c;
+        kr[band] = 2.0*M_PI*(double)freqVector[band] * (double)arraySpecs->r / (double)up->c;
+        kR[band] = 2.0*M_PI*(double)freqVector[band] * (double)arraySpecs->R / (double)up->c;
     }
     
     switch(arraySpecs->arrayType){
@@ -312,7 +313,8 @@ static void array2sh_calculate_bN
 
 static void array2sh_reg_inv_bN
 (
-    void* const hA2sh
+    void* const hA2sh,
+    const userPars* up
 )
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
@@ -320,13 +322,13 @@ static void array2sh_reg_inv_bN
     int band, n;
     double regPar, g_lim, alpha, beta, f_n;
     
-    regPar = (double)pData->regPar;
+    regPar = (double)up->regPar;
     
     for(band=0; band<HYBRID_BANDS; band++)
         for(n=0; n < SH_ORDER+1; n++)
             pData->bN_modal[band][n] = ccdiv(cmplx(1.0,0.0), (pData->bN[band][n]));
     
-    switch(pData->regType){
+    switch(up->regType){
         case REG_DAS:
             for(band=0; band<HYBRID_BANDS; band++){
                 f_n = 0.0;
@@ -375,45 +377,165 @@ static void array2sh_replicate_order
 }
 
 
-void array2sh_initTFT
-(
-    void* const hA2sh
-)
+void array2sh_requestInit(void* const hA2sh, volatile int* flag)
+{
+    array2sh_data *pData = (array2sh_data*)(hA2sh);
+    
+    saf_atomic_storei(flag, 1);
+    saf_worker_post(pData->hWorker);
+}
+
+void array2sh_codecWorker(void* hA2sh)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
     arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
+    const userPars* up;
+    codecPars* pars, *nextPars;
+    tftPars* tft, *nextTFT;
+    int Q;
+    
+    /* free the encoding matrices and TFTs the audio thread is no longer using */
+    pars = (codecPars*)saf_atomic_exchangep(&(pData->retiredPars), NULL);
+    for(; pars!=NULL; pars = nextPars){
+        nextPars = pars->next;
+        array2sh_freeCodecPars(&pars);
+    }
+    tft = (tftPars*)saf_atomic_exchangep(&(pData->retiredTFT), NULL);
+    for(; tft!=NULL; tft = nextTFT){
+        nextTFT = tft->next;
+        array2sh_freeTFT(&tft);
+    }
+    
+    /* nothing is built before "array2sh_init" (which posts the job again) */
+    if(pData->fs==0)
+        return;
+    
+    /* consistent snapshot of the user parameters for this job; the array specification is copied, as the encoding
+     * matrix is computed for the number of sensors of the current TFT ("Q"), until the new one is built */
+    up = (const userPars*)saf_paramBlock_read(pData->hUserPars, USER_PARS_WORKER);
+    Q = arraySpecs->Q;
+    memcpy(arraySpecs, &(up->arraySpecs), sizeof(arrayPars));
+    arraySpecs->Q = Q;
+    
+    /* reinit TF transform, before reinitialising the encoding matrix; the TFT is only published along with the
+     * encoding matrix for its number of sensors, so that the audio thread keeps using the previous ones until then */
+    tft = NULL;
+    if(saf_atomic_exchangei(&(pData->reinitTFTFLAG), 0)){
+        arraySpecs->Q = arraySpecs->newQ;
+        tft = array2sh_createTFT(arraySpecs->Q);
+        saf_atomic_storei(&(pData->reinitSHTmatrixFLAG), 1); /* filters need to be updated too */
+    }
+    if(saf_atomic_exchangei(&(pData->reinitSHTmatrixFLAG), 0)){
+        /* compute encoding matrix */
+        array2sh_calculate_sht_matrix(hA2sh, up);
+        /* calculate magnitude response curves */
+        array2sh_calculate_mag_curves(hA2sh);
+        
+        /* take back the previously published encoding matrix, if the audio thread never picked it up; it is not needed
+         * anymore, but a new TFT that came with it still is (the number of sensors has not changed since) */
+        pars = (codecPars*)saf_atomic_exchangep(&(pData->pendingPars), NULL);
+        if(pars!=NULL && tft==NULL){
+            tft = pars->tft;
+            pars->tft = NULL;
+        }
+        array2sh_freeCodecPars(&pars);
+        
+        /* publish the new one */
+        pars = (codecPars*)malloc(sizeof(codecPars));
+        pars->Q = arraySpecs->Q;
+        pars->tft = tft;
+        memcpy(pars->W, pData->W, HYBRID_BANDS*NUM_SH_SIGNALS*MAX_NUM_SENSORS*sizeof(float_complex));
+        pars = (codecPars*)saf_atomic_exchangep(&(pData->pendingPars), (void*)pars);
+        array2sh_freeCodecPars(&pars);
+    }
+    if(saf_atomic_exchangei(&(pData->recalcEvalFLAG), 0))
+        array2sh_evaluateSHTfilters(hA2sh, up);
+}
+
+void array2sh_freeCodecPars(codecPars** const ppars)
+{
+    codecPars* pars = *ppars;
+    
+    if(pars!=NULL){
+        array2sh_freeTFT(&(pars->tft));
+        free(pars);
+        *ppars = NULL;
+    }
+}
+
+void array2sh_retireCodecPars(void* const hA2sh, codecPars* const pars)
+{
+    array2sh_data *pData = (array2sh_data*)(hA2sh);
+    void* head;
+    
+    if(pars==NULL)
+        return;
+    /* lock-free push; the worker thread only ever takes the whole list at once, so there is no ABA problem */
+    do{
+        head = saf_atomic_loadp(&(pData->retiredPars));
+        pars->next = (codecPars*)head;
+    } while(!saf_atomic_casp(&(pData->retiredPars), head, (void*)pars));
+}
+
+void array2sh_retireTFT(void* const hA2sh, tftPars* const tft)
+{
+    array2sh_data *pData = (array2sh_data*)(hA2sh);
+    void* head;
+    
+    if(tft==NULL)
+        return;
+    /* lock-free push (as "array2sh_retireCodecPars") */
+    do{
+        head = saf_atomic_loadp(&(pData->retiredTFT));
+        tft->next = (tftPars*)head;
+    } while(!saf_atomic_casp(&(pData->retiredTFT), head, (void*)tft));
+}
+
+tftPars* array2sh_createTFT(int Q)
+{
+    tftPars* tft;
     int t, ch;
     
-    if (pData->hSTFT != NULL){
-        afSTFTfree(pData->hSTFT);
-        pData->hSTFT = NULL;
-        for (t = 0; t<TIME_SLOTS; t++) {
-            for (ch = 0; ch< arraySpecs->Q; ch++) {
-                free(pData->STFTInputFrameTF[t][ch].re);
-                free(pData->STFTInputFrameTF[t][ch].im);
-            }
+    tft = (tftPars*)malloc(sizeof(tftPars));
+    tft->Q = Q;
+    tft->next = NULL;
+    afSTFTinit(&(tft->hSTFT), HOP_SIZE, Q, NUM_SH_SIGNALS, 0, 1);
+    tft->STFTInputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, Q, sizeof(complexVector));
+    for(t=0; t<TIME_SLOTS; t++) {
+        for(ch=0; ch< Q; ch++) {
+            tft->STFTInputFrameTF[t][ch].re = (float*)calloc(HYBRID_BANDS, sizeof(float));
+            tft->STFTInputFrameTF[t][ch].im = (float*)calloc(HYBRID_BANDS, sizeof(float));
         }
-        free2d((void**)pData->STFTInputFrameTF, TIME_SLOTS);
-        free2d((void**)pData->tempHopFrameTD, arraySpecs->Q);
     }
-    if (pData->hSTFT == NULL){
-        afSTFTinit(&(pData->hSTFT), HOP_SIZE, arraySpecs->newQ, NUM_SH_SIGNALS, 0, 1);
-        pData->STFTInputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, arraySpecs->newQ, sizeof(complexVector));
-        for(t=0; t<TIME_SLOTS; t++) {
-            for(ch=0; ch< arraySpecs->newQ; ch++) {
-                pData->STFTInputFrameTF[t][ch].re = (float*)calloc(HYBRID_BANDS, sizeof(float));
-                pData->STFTInputFrameTF[t][ch].im = (float*)calloc(HYBRID_BANDS, sizeof(float));
-            } 
+    /* (also holds the NUM_SH_SIGNALS outputs of the inverse transform, for arrays with fewer sensors) */
+    tft->tempHopFrameTD = (float**)malloc2d(MAX(Q, NUM_SH_SIGNALS), HOP_SIZE, sizeof(float));
+    return tft;
+}
+
+void array2sh_freeTFT(tftPars** const ptft)
+{
+    tftPars* tft = *ptft;
+    int t, ch;
+    
+    if(tft!=NULL){
+        afSTFTfree(tft->hSTFT);
+        for (t = 0; t<TIME_SLOTS; t++) {
+            for (ch = 0; ch< tft->Q; ch++) {
+                free(tft->STFTInputFrameTF[t][ch].re);
+                free(tft->STFTInputFrameTF[t][ch].im);
+            }
         }
-        pData->tempHopFrameTD = (float**)malloc2d(arraySpecs->newQ, HOP_SIZE, sizeof(float));
-        arraySpecs->Q = arraySpecs->newQ;
-        pData->reinitSHTmatrixFLAG = 1; /* filters need to be updated too */
+        free2d((void**)tft->STFTInputFrameTF, TIME_SLOTS);
+        free2d((void**)tft->tempHopFrameTD, MAX(tft->Q, NUM_SH_SIGNALS));
+        free(tft);
+        *ptft = NULL;
     }
 }
 
 void array2sh_calculate_sht_matrix
 (
-    void* const hA2sh
+    void* const hA2sh,
+    const userPars* up
 )
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
@@ -432,8 +554,8 @@ void array2sh_calculate_sht_matrix
     arraySpecs->R = MAX(arraySpecs->R, arraySpecs->r);
 
     /* calculate equalisation matrix */
-    array2sh_calculate_bN(hA2sh, pData->freqVector);
-    array2sh_reg_inv_bN(hA2sh);
+    array2sh_calculate_bN(hA2sh, up, pData->freqVector);
+    array2sh_reg_inv_bN(hA2sh, up);
     array2sh_replicate_order(hA2sh);
     
     /* calculate real-valued SH weights for each sensor direction */
@@ -514,7 +636,7 @@ void array2sh_calculate_mag_curves(void* const hA2sh)
     }
 }
 
-void array2sh_evaluateSHTfilters(void* hA2sh)
+void array2sh_evaluateSHTfilters(void* hA2sh, const userPars* up)
 {
     array2sh_data *pData = (array2sh_data*)(hA2sh);
     arrayPars* arraySpecs = (arrayPars*)(pData->arraySpecs);
@@ -527,9 +649,9 @@ void array2sh_evaluateSHTfilters(void* hA2sh)
     
     /* simulate the current array by firing 812 plane-waves around the surface of a theoretical sphere
      * and ascertaining the transfer function for each */
-    simOrder = (int)(2.0f*M_PI*MAX_EVAL_FREQ_HZ*(arraySpecs->R)/pData->c)+1;
+    simOrder = (int)(2.0f*M_PI*MAX_EVAL_FREQ_HZ*(arraySpecs->R)/up->c)+1;
     for(i=0; i<HYBRID_BANDS-1; i++)
-        kr[i] = 2.0*M_PI*(pData->freqVector[i+1/* ignore DC */])*(arraySpecs->R)/pData->c;
+        kr[i] = 2.0*M_PI*(pData->freqVector[i+1/* ignore DC */])*(arraySpecs->R)/up->c;
     H_array = malloc((HYBRID_BANDS-1) * (arraySpecs->Q) * 812*sizeof(float_complex));
     switch(arraySpecs->arrayType){
         case ARRAY_SPHERICAL:
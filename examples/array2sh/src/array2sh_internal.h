@@ -40,7 +40,6 @@
 #include <string.h>
 #include <assert.h>
 #include "array2sh.h"
-#include "array2sh_database.h"
 #define SAF_ENABLE_AFSTFT /* for time-frequency transform */
 #define SAF_ENABLE_SH     /* for spherical harmonic weights */
 #include "saf.h"
@@ -59,13 +58,15 @@ extern "C" {
 #define TIME_SLOTS ( FRAME_SIZE / HOP_SIZE )                /* 4/8/16 */
 #define MAX_NUM_SENSORS ( 64 )                              /* Maximum permited channels for the VST standard */
 #define MAX_EVAL_FREQ_HZ ( 20e3f )                          /* Up to which frequency should the evaluation be accurate */
+#define USER_PARS_AUDIO ( 0 )                               /* user parameter block reader index of the audio thread */
+#define USER_PARS_WORKER ( 1 )                              /* user parameter block reader index of the worker thread */
     
 /***********/
 /* Structs */
 /***********/
     
 typedef struct _arrayPars {
-    int Q, newQ;
+    int Q, newQ;                             /* Q: number of sensors the encoding matrix was last computed for (worker thread), newQ: as set */
     float r;
     float R;
     float admittance;
@@ -76,6 +77,41 @@ typedef struct _arrayPars {
         
 }arrayPars;
 
+/* user parameters (see saf_paramBlock) */
+typedef struct _userPars {
+    arrayPars arraySpecs;                    /* array specification, as set (its "Q" is not used, see "newQ") */
+    
+    /* additional user parameters that are not included in the array presets */
+    REG_TYPES regType;
+    float regPar;
+    CH_ORDER chOrdering;
+    NORM_TYPES norm;
+    float c;
+    float gain_dB;
+    float maxFreq;
+    
+}userPars;
+
+/* spherical harmonic transform (encoding) matrix; built by the worker thread, used by the audio thread */
+typedef struct _codecPars {
+    int Q;                                   /* number of sensors */
+    float_complex W[HYBRID_BANDS][NUM_SH_SIGNALS][MAX_NUM_SENSORS];
+    struct _tftPars* tft;                    /* new TFT for "Q" sensors, which is picked up along with this encoding
+                                              * matrix; NULL: the current TFT still applies */
+    struct _codecPars* next;                 /* next entry in the list of retired codec parameters */
+    
+}codecPars;
+
+/* time-frequency transform for Q sensors; built by the worker thread, used by the audio thread */
+typedef struct _tftPars {
+    int Q;                                   /* number of sensors */
+    void* hSTFT;
+    complexVector** STFTInputFrameTF;
+    float** tempHopFrameTD;
+    struct _tftPars* next;                   /* next entry in the list of retired TFTs */
+    
+}tftPars;
+
 typedef struct _array2sh
 {
     /* audio buffers */
@@ -83,11 +119,20 @@ typedef struct _array2sh
     float SHframeTD[NUM_SH_SIGNALS][FRAME_SIZE];
     float_complex inputframeTF[HYBRID_BANDS][MAX_NUM_SENSORS][TIME_SLOTS];
     float_complex SHframeTF[HYBRID_BANDS][NUM_SH_SIGNALS][TIME_SLOTS];
-    complexVector** STFTInputFrameTF;
+    float_complex SHframeTF_prev[HYBRID_BANDS][NUM_SH_SIGNALS][TIME_SLOTS]; /* encoded with the previous encoding matrix */
     complexVector** STFTOutputFrameTF;
-    float** tempHopFrameTD;
     
-    /* intermediates */
+    /* encoding matrix and TFT; the worker thread builds new ones whenever they are to be reinitialised, and publishes
+     * them to the audio thread (a new TFT along with the encoding matrix for its number of sensors), which hands the
+     * previous ones back to it for freeing */
+    codecPars* pars;                         /* encoding matrix currently used for processing (audio thread only) */
+    void* volatile pendingPars;              /* new encoding matrix published by the worker thread (codecPars*) */
+    void* volatile retiredPars;              /* encoding matrices no longer used by the audio thread (codecPars*) */
+    tftPars* tft;                            /* TFT currently used for processing (audio thread only) */
+    void* volatile retiredTFT;               /* TFTs no longer used by the audio thread (tftPars*) */
+    void* hWorker;                           /* worker thread, which (re)initialises the encoding matrix and TFT */
+    
+    /* intermediates (worker thread) */
     double_complex bN_modal[HYBRID_BANDS][SH_ORDER + 1];
     double_complex bN[HYBRID_BANDS][SH_ORDER + 1];
     double_complex bN_inv[HYBRID_BANDS][SH_ORDER + 1];
@@ -95,7 +140,7 @@ typedef struct _array2sh
     double Y[NUM_SH_SIGNALS][MAX_NUM_SENSORS];
     double YYT[NUM_SH_SIGNALS][NUM_SH_SIGNALS];
     float_complex Y_cmplx[NUM_SH_SIGNALS][MAX_NUM_SENSORS];
-    float_complex W[HYBRID_BANDS][NUM_SH_SIGNALS][MAX_NUM_SENSORS];
+    float_complex W[HYBRID_BANDS][NUM_SH_SIGNALS][MAX_NUM_SENSORS]; /* latest encoding matrix, for the evaluation */
     
     /* for displaying the bNs */
     float** bN_modal_dB;
@@ -105,23 +150,17 @@ typedef struct _array2sh
     float* disp_freqVector;
     
     /* time-frequency transform and array details */
+    int fs;                                  /* host sampling rate; 0: not initialised yet */
     float freqVector[HYBRID_BANDS];
-    void* hSTFT;
-    void* arraySpecs;
+    void* arraySpecs;                        /* copy of the array specification the worker thread is building for */
     
-    /* additional user parameters that are not included in the array presets */
-    PRESETS preset;
-    REG_TYPES regType;
-    float regPar;
-    CH_ORDER chOrdering;
-    NORM_TYPES norm;
-    float c;
-    float gain_dB;
-    float maxFreq; 
+    /* user parameters */
+    void* hUserPars;                         /* parameter block of "userPars"; edited by the set functions, read by the audio and worker threads */
     
-    int reinitSHTmatrixFLAG;
-    int reinitTFTFLAG;
-    int recalcEvalFLAG;
+    volatile int reinitSHTmatrixFLAG;        /* 0: no init required, 1: init required (on the worker thread) */
+    volatile int reinitTFTFLAG;              /* 0: no init required, 1: init required (on the worker thread) */
+    volatile int recalcEvalFLAG;             /* 0: no evaluation required, 1: evaluation required (on the worker thread) */
+    void* hProf;                             /* per-stage timing of the processing loop (see saf_profiler.h) */
 
 } array2sh_data;
      
@@ -130,13 +169,30 @@ typedef struct _array2sh
 /* Internal functions */
 /**********************/
     
-void array2sh_initTFT(void* const hA2sh);
+/* Flags part of the state for reinitialisation, which is carried out on the worker thread. Not for the audio thread */
+void array2sh_requestInit(void* const hA2sh, volatile int* flag);
+    
+/* Worker thread job: builds a fresh TFT and/or encoding matrix, as flagged, and publishes them to the audio thread;
+ * then evaluates the encoding matrix, if requested. Also frees any the audio thread has since retired */
+void array2sh_codecWorker(void* hA2sh);
+    
+/* Frees an encoding matrix, along with the new TFT that came with it (if it was never picked up) */
+void array2sh_freeCodecPars(codecPars** const ppars);
+    
+/* Hands an encoding matrix/TFT no longer in use over to the worker thread for freeing; lock-free, for the audio thread */
+void array2sh_retireCodecPars(void* const hA2sh, codecPars* const pars);
+    
+void array2sh_retireTFT(void* const hA2sh, tftPars* const tft);
+    
+tftPars* array2sh_createTFT(int Q);
+    
+void array2sh_freeTFT(tftPars** const ptft);
     
-void array2sh_calculate_sht_matrix(void* const hA2sh);
+void array2sh_calculate_sht_matrix(void* const hA2sh, const userPars* up);
     
 void array2sh_calculate_mag_curves(void* const hA2sh);
     
-void array2sh_evaluateSHTfilters(void* hA2sh);
+void array2sh_evaluateSHTfilters(void* hA2sh, const userPars* up);
     
 void array2sh_createArray(void ** const hPars);
 
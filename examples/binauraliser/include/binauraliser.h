@@ -162,6 +162,101 @@ void binauraliser_process(void* const hBin,              /* binauraliser handle
                           int nOutputs,                  /* number of channels in 'outputs' matrix */
                           int nSamples,                  /* number of samples in 'inputs' and 'outputs' matrices */
                           int isPlaying);                /* flag; set to 1 if there really is audio */
+
+/* blocks until the worker thread has finished (re)initialising the HRTFs and the time-frequency transform, which are
+ * then picked up by the next call to "binauraliser_process" (e.g. for offline rendering or benchmarking). Must not be
+ * called from the audio thread */
+void binauraliser_waitForCodecInit(void* const hBin);    /* binauraliser handle */
+    
+    
+/*******************/
+/* Batch Functions */
+/*******************/
+    
+/* A batch holds several instances (e.g. one per listener or per scene), which are processed together by
+ * "binauraliser_processBatch": the time-frequency data of all instances are interleaved per band, and the work is
+ * spread over a thread pool (see "saf_pool_create"). Each instance keeps its own sources and HRIRs; instances that use
+ * the same HRIRs share the HRTF data */
+    
+/* creates a batch of binauraliser instances */
+void binauraliser_createBatch(void** const phBatch,      /* address of binauraliser batch handle */
+                              int nInstances);           /* number of instances */
+
+/* destroys a batch of binauraliser instances */
+void binauraliser_destroyBatch(void** const phBatch);    /* address of binauraliser batch handle */
+
+/* initialises all instances of a batch */
+void binauraliser_initBatch(void* const hBatch,          /* binauraliser batch handle */
+                            int samplerate);             /* host sample rate */
+
+/* returns the binauraliser handle of one instance of a batch, for the set/get functions; NULL if out of range */
+void* binauraliser_getBatchInstance(void* const hBatch,  /* binauraliser batch handle */
+                                    int index);          /* instance index */
+
+/* binauralises the input sources of all instances of a batch; the output of each instance is the same as
+ * "binauraliser_process" would produce */
+void binauraliser_processBatch(void* const hBatch,       /* binauraliser batch handle */
+                               float*** const inputs,    /* input channels, [nInstances][nInputs][nSamples] */
+                               float*** const outputs,   /* output channels, [nInstances][nOutputs][nSamples] */
+                               int nInputs,              /* number of channels in each 'inputs' matrix */
+                               int nOutputs,             /* number of channels in each 'outputs' matrix */
+                               int nSamples,             /* number of samples in each 'inputs' matrix */
+                               int isPlaying,            /* flag; set to 1 if there really is audio */
+                               void* const hPool);       /* thread pool handle; NULL: calling thread only */
+    
+    
+/********************/
+/* Object Functions */
+/********************/
+    
+/* Objects are sources with a dynamic lifetime, identified by an ID (0..maxNumObjects-1), each with its own direction
+ * and gain; they are rendered by "binauraliser_processObjects" instead of "binauraliser_process". The objects and
+ * the state of each are allocated once, for the maximum number of objects, so that objects may be added, removed and
+ * updated from another thread without any (re)allocation on the audio thread; changes take effect once committed.
+ * The cost of a frame scales with the number of objects that are not silent (see binauraliser_setActivityHoldTime).
+ * Once the objects have been allocated, the instance renders objects only ("binauraliser_process" outputs silence) */
+    
+/* (re)allocates the objects, without any; must not be called whilst processing (as binauraliser_init). The state of
+ * each object is then built on the worker thread (see binauraliser_waitForCodecInit) */
+void binauraliser_setMaxNumObjects(void* const hBin,               /* binauraliser handle */
+                                   int maxNumObjects);             /* maximum number of objects (1..4096) */
+    
+/* adds an object; returns 0 on success, or -1 if the ID is out of range or already in use */
+int binauraliser_addObject(void* const hBin,                       /* binauraliser handle */
+                           int id,                                 /* object ID; 0..maxNumObjects-1 */
+                           float azi_deg,                          /* azimuth in degrees */
+                           float elev_deg,                         /* elevation in degrees */
+                           float gain);                            /* linear gain */
+    
+/* removes an object; returns 0 on success, or -1 if the ID is not in use */
+int binauraliser_removeObject(void* const hBin,                    /* binauraliser handle */
+                              int id);                             /* object ID */
+    
+/* changes the direction and gain of an object; returns 0 on success, or -1 if the ID is not in use */
+int binauraliser_updateObject(void* const hBin,                    /* binauraliser handle */
+                              int id,                              /* object ID */
+                              float azi_deg,                       /* azimuth in degrees */
+                              float elev_deg,                      /* elevation in degrees */
+                              float gain);                         /* linear gain */
+    
+/* passes all object changes since the last call on to the audio thread, which picks them up at its next frame */
+void binauraliser_commitObjects(void* const hBin);                 /* binauraliser handle */
+    
+/* returns the maximum number of objects; 0 if binauraliser_setMaxNumObjects has not been called */
+int binauraliser_getMaxNumObjects(void* const hBin);               /* binauraliser handle */
+    
+/* returns the number of objects, including changes that have not been committed yet */
+int binauraliser_getNumObjects(void* const hBin);                  /* binauraliser handle */
+    
+/* binauralises the objects; channel "id" of 'objectInputs' holds the signal of object "id" (channels of IDs that are
+ * not in use are ignored, and may be NULL, as may those of objects that are silent) */
+void binauraliser_processObjects(void* const hBin,                 /* binauraliser handle */
+                                 float** const objectInputs,       /* object signals [nObjectInputs][FRAME_SIZE] */
+                                 float** const outputs,            /* binaural signals [nOutputs][FRAME_SIZE] */
+                                 int nObjectInputs,                /* number of channels in 'objectInputs' matrix */
+                                 int nOutputs,                     /* number of channels in 'outputs' matrix */
+                                 int nSamples,                     /* number of samples in 'objectInputs' and 'outputs' */
+                                 int isPlaying);                   /* flag; set to 1 if there really is audio */
     
     
 /*****************/
@@ -170,6 +265,12 @@ void binauraliser_process(void* const hBin,              /* binauraliser handle
     
 void binauraliser_refreshSettings(void* const hBin);
     
+/* sets the thread pool (see "saf_pool_create") over which "binauraliser_process" spreads the sources, in groups whose
+ * outputs are summed once all have been binauralised; NULL (default): the audio thread binauralises all sources. The
+ * pool may be shared with other instances/modules, and must not be destroyed whilst it is still set */
+void binauraliser_setThreadPool(void* const hBin,        /* binauraliser handle */
+                                void* const hPool);      /* thread pool handle; NULL: none */
+    
 void binauraliser_setSourceAzi_deg(void* const hBin, int index, float newAzi_deg);
 
 void binauraliser_setSourceElev_deg(void* const hBin, int index, float newElev_deg);
@@ -182,6 +283,30 @@ void binauraliser_setSofaFilePath(void* const hBin, const char* path);
 
 void binauraliser_setInputConfigPreset(void* const hBin, int newPresetID);
     
+/* 1: when a source moves, its HRTF magnitudes and ITD are interpolated from those of the previous frame to those of
+ * the new direction over the time slots of the frame, rather than switching at the frame boundary; which allows
+ * smooth motion at large frame sizes. 0 (default): off */
+void binauraliser_setInterpPerTimeSlot(void* const hBin,          /* binauraliser handle */
+                                       int newState);             /* 1: on, 0: off */
+    
+/* sets how long a source must be silent (below -120 dBFS) before its time-frequency transform, HRTF interpolation and
+ * binauralisation are skipped; it is processed again as soon as it is not silent. The hold time is extended to at
+ * least the memory of the filterbank, so that the tail of the source has decayed before it is skipped */
+void binauraliser_setActivityHoldTime(void* const hBin,           /* binauraliser handle */
+                                      float newHold_ms);          /* hold time in milliseconds (default 100) */
+    
+/* sets the resolution of the cache of interpolated HRTFs, which holds the HRTFs of the most recently used source
+ * directions; source directions are rounded to this grid before being looked up. 0 (default): the resolution of the
+ * VBAP gain table used for the interpolation (2 degrees azimuth, 5 degrees elevation), so that cached HRTFs are exactly
+ * those interpolated directly. The cache is emptied */
+void binauraliser_setHRTFCacheResolution(void* const hBin,         /* binauraliser handle */
+                                         float newRes_deg);        /* resolution in degrees (0..30) */
+    
+/* sets the memory budget of the cache of interpolated HRTFs; once full, the least recently used HRTFs make way for
+ * new ones. 0: no cache, the HRTFs are interpolated whenever a source moves. The cache is emptied */
+void binauraliser_setHRTFCacheSize(void* const hBin,               /* binauraliser handle */
+                                   int newSize_kB);                /* memory budget in kilobytes (default 1024) */
+    
 
 /*****************/
 /* Get Functions */
@@ -212,6 +337,29 @@ int binauraliser_getUseDefaultHRIRsflag(void* const hBin);
 char* binauraliser_getSofaFilePath(void* const hCmp);
  
 int binauraliser_getDAWsamplerate(void* const hBin); 
+    
+int binauraliser_getInterpPerTimeSlot(void* const hBin);
+    
+float binauraliser_getActivityHoldTime(void* const hBin);
+    
+/* returns the number of sources that were processed (not skipped as silent) in the last frame */
+int binauraliser_getNumActiveSources(void* const hBin);
+    
+float binauraliser_getHRTFCacheResolution(void* const hBin);
+    
+int binauraliser_getHRTFCacheSize(void* const hBin);
+    
+/* returns the number of HRTF lookups (one per moved source and frame) served from the cache, since it was emptied */
+int binauraliser_getHRTFCacheHits(void* const hBin);
+    
+/* returns the number of HRTF lookups that were interpolated (and then cached), since the cache was emptied */
+int binauraliser_getHRTFCacheMisses(void* const hBin);
+
+/* returns the processing delay in samples, introduced by the time-frequency transform */
+int binauraliser_getProcessingDelay(void);
+
+/* returns the profiler handle, for "saf_profiler_getStats" (NULL, unless built with SAF_ENABLE_PROFILER) */
+void* binauraliser_getProfiler(void* const hBin);
 
 #ifdef __cplusplus
 }
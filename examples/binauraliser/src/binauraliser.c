@@ -37,44 +37,71 @@ void binauraliser_create
     binauraliser_data* pData = (binauraliser_data*)malloc(sizeof(binauraliser_data));
     if (pData == NULL) { return;/*error*/ }
     *phBin = (void*)pData;
+    saf_profiler_create(&(pData->hProf));
     
     /* time-frequency transform + buffers */
-    pData->hSTFT = NULL;
-    pData->STFTInputFrameTF = NULL;
     int t, ch;
     pData->STFTOutputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, NUM_EARS, sizeof(complexVector));
     for(t=0; t<TIME_SLOTS; t++) {
         for(ch=0; ch< NUM_EARS; ch++) {
-            pData->STFTOutputFrameTF[t][ch].re = (float*)calloc(HYBRID_BANDS, sizeof(float));
-            pData->STFTOutputFrameTF[t][ch].im = (float*)calloc(HYBRID_BANDS, sizeof(float));
+            pData->STFTOutputFrameTF[t][ch].re = pData->outputTF_re[0][t][ch];
+            pData->STFTOutputFrameTF[t][ch].im = pData->outputTF_im[0][t][ch];
         }
     }
-    pData->tempHopFrameTD = NULL;
+    memset(pData->outputTF_re, 0, sizeof(pData->outputTF_re));
+    memset(pData->outputTF_im, 0, sizeof(pData->outputTF_im));
+    pData->nSourceGroups = 1;
+    pData->hPool = NULL;
+    pData->fs = 0;
+    
+    userPars* up;
+    
+    /* HRTFs and TFT; built on the worker thread (once the sampling rate is known, see binauraliser_init) */
+    pData->pars = NULL;
+    pData->prevPars = NULL;
+    pData->pendingPars = NULL;
+    pData->retiredPars = NULL;
+    pData->tft = NULL;
+    pData->pendingTFT = NULL;
+    pData->retiredTFT = NULL;
+    pData->fadedOut = 0;
+    saf_worker_create(&(pData->hWorker), binauraliser_codecWorker, (void*)pData);
     
     /* hrir data */
     pData->useDefaultHRIRsFLAG=1;
-    pData->hrirs = NULL;
+    pData->hrtfRes = NULL;
     pData->hrir_dirs_deg = NULL;
+    pData->N_hrir_dirs = pData->hrir_len = pData->hrir_fs = pData->nTriangles = 0;
     pData->sofa_filepath = "/Users/mccorml1/Documents/SourceTree/AkisPlugins/database/AALTO/leo_aalto2016.sofa";
     //pData->sofa_filename = "/Users/mccorml1/Documents/SourceTree/AkisPlugins/database/CIPIC/subject_003.sofa";
-    /* vbap */
-    pData->hrtf_vbap_gtableIdx = NULL;
-    pData->hrtf_vbap_gtableComp = NULL;
+    for(t=1; t<=TIME_SLOTS; t++)
+        pData->interpolator[t-1] = (float)t/(float)TIME_SLOTS;
+    
+    /* HRTF cache (allocated along with the HRTFs) */
+    pData->hrtfCacheRes = 0.0f;
+    pData->hrtfCacheSize_kB = DEFAULT_HRTF_CACHE_SIZE_KB;
+    pData->hrtfCacheHits = 0;
+    pData->hrtfCacheMisses = 0;
+    
+    /* source state (allocated along with the TFT) */
+    pData->nActiveSources = 0;
     
-    /* HRTF filterbank coefficients */
-    pData->itds_s = NULL;
-    pData->hrtf_fb = NULL;
-    pData->hrtf_fb_mag = NULL;
+    /* objects */
+    pData->hObjects = NULL;
+    pData->objectMode = 0;
     
     /* flags */
     pData->reInitHRTFsAndGainTables = 1;
-    for(ch=0; ch<MAX_NUM_INPUTS; ch++)
-        pData->recalc_hrtf_interpFLAG[ch] = 1;
+    pData->reInitHRTFCache = 1;
     pData->reInitTFT = 1;
     
     /* user parameters */
-    binauraliser_loadPreset(PRESET_DEFAULT, pData->src_dirs_deg, &(pData->new_nSources), &(pData->input_nDims)); /*check setStateInformation if you change default preset*/
-    pData->nSources = pData->new_nSources;
+    saf_paramBlock_create(&(pData->hUserPars), sizeof(userPars), 2);
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    binauraliser_loadPreset(PRESET_DEFAULT, up->src_dirs_deg, &(up->nSources), &(up->input_nDims)); /*check setStateInformation if you change default preset*/
+    up->interpPerTimeSlot = 0;
+    up->activityHold_ms = SAF_ACTIVITY_DEFAULT_HOLD_MS;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 
@@ -84,45 +111,36 @@ void binauraliser_destroy
 )
 {
     binauraliser_data *pData = (binauraliser_data*)(*phBin);
-    int t, ch;
+    codecPars *pars, *nextPars;
+    tftPars *tft, *nextTFT;
 
     if (pData != NULL) {
-        if(pData->hSTFT !=NULL)
-            afSTFTfree(pData->hSTFT);
-        for (t = 0; t<TIME_SLOTS; t++) {
-            if(pData->STFTInputFrameTF!=NULL){
-                for(ch=0; ch< pData->nSources; ch++) {
-                    free(pData->STFTInputFrameTF[t][ch].re);
-                    free(pData->STFTInputFrameTF[t][ch].im);
-                }
-            }
-            for (ch = 0; ch< NUM_EARS; ch++) {
-                free(pData->STFTOutputFrameTF[t][ch].re);
-                free(pData->STFTOutputFrameTF[t][ch].im);
-            }
-        }
-        if(pData->STFTInputFrameTF!=NULL)
-            free2d((void**)pData->STFTInputFrameTF, TIME_SLOTS);
+        /* stop the worker thread first (waits for it to finish any initialisation in progress) */
+        saf_worker_destroy(&(pData->hWorker));
+        
         if(pData->STFTOutputFrameTF!=NULL)
             free2d((void**)pData->STFTOutputFrameTF, TIME_SLOTS);
-        if(pData->tempHopFrameTD!=NULL)
-            free2d((void**)pData->tempHopFrameTD, MAX(pData->nSources, NUM_EARS));
         
-        if(pData->hrtf_vbap_gtableComp!= NULL)
-            free(pData->hrtf_vbap_gtableComp);
-        if(pData->hrtf_vbap_gtableIdx!= NULL)
-            free(pData->hrtf_vbap_gtableIdx);
-        if(pData->hrtf_fb!= NULL)
-            free(pData->hrtf_fb);
-        if(pData->hrtf_fb_mag!= NULL)
-            free(pData->hrtf_fb_mag);
-        if(pData->itds_s!= NULL)
-            free(pData->itds_s);
-        if(pData->hrirs!= NULL)
-            free(pData->hrirs);
-        if(pData->hrir_dirs_deg!= NULL)
-            free(pData->hrir_dirs_deg);
+        binauraliser_freeCodecPars(&(pData->pars));
+        binauraliser_freeCodecPars(&(pData->prevPars));
+        pars = (codecPars*)pData->pendingPars;
+        binauraliser_freeCodecPars(&pars);
+        for(pars = (codecPars*)pData->retiredPars; pars!=NULL; pars = nextPars){
+            nextPars = pars->next;
+            binauraliser_freeCodecPars(&pars);
+        }
+        binauraliser_freeTFT(&(pData->tft));
+        tft = (tftPars*)pData->pendingTFT;
+        binauraliser_freeTFT(&tft);
+        for(tft = (tftPars*)pData->retiredTFT; tft!=NULL; tft = nextTFT){
+            nextTFT = tft->next;
+            binauraliser_freeTFT(&tft);
+        }
+        hrtfResource_release(&(pData->hrtfRes));
+        saf_paramBlock_destroy(&(pData->hUserPars));
+        saf_objects_destroy(&(pData->hObjects));
          
+        saf_profiler_destroy(&(pData->hProf));
         free(pData);
         pData = NULL;
     }
@@ -138,13 +156,83 @@ void binauraliser_init
     int band;
     
     /* define frequency vector */
-    pData->fs = sampleRate;
     for(band=0; band <HYBRID_BANDS; band++){
         if(sampleRate == 44100)
             pData->freqVector[band] =  (float)__afCenterFreq44100[band];
         else
             pData->freqVector[band] =  (float)__afCenterFreq48e3[band];
     }
+    pData->fs = sampleRate;
+    
+    /* (re)build the HRTFs for this sampling rate (along with the TFT, if it has not been built yet) */
+    binauraliser_requestInit(hBin, &(pData->reInitHRTFsAndGainTables));
+}
+
+/* pool task: binauralises one group of the active sources into its own binaural frame */
+static void binauraliser_binauraliseTask(void* arg, int group)
+{
+    binauraliser_data *pData = (binauraliser_data*)(arg);
+    int first, last;
+    
+    first = group*(pData->tft->nSrcList)/(pData->nSourceGroups);
+    last = (group+1)*(pData->tft->nSrcList)/(pData->nSourceGroups);
+    binauraliser_binauraliseSources(arg, first, last-first, pData->outputTF_re[group], pData->outputTF_im[group]);
+}
+
+/* binauralises one frame of the sources (channel mode) or objects, once any reinitialisation has been done */
+static void binauraliser_processFrame
+(
+    void* const hBin,
+    const userPars* up,
+    const saf_objects_view* objects,
+    float** const inputs,
+    float** const outputs,
+    int nInputs,
+    int nOutputs,
+    int applyFadeIn,
+    int applyFadeOut
+)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    int i, group;
+    float* sum_re, *sum_im;
+    const float* group_re, *group_im;
+    void* hPool;
+    
+    SAF_RT_SCOPE_BEGIN;
+    SAF_PROFILE_BEGIN(pData->hProf, "total");
+    
+    /* Load time-domain data and apply time-frequency transform (TFT) */
+    SAF_PROFILE_BEGIN(pData->hProf, "afSTFTforward");
+    binauraliser_analysis(hBin, up, objects, inputs, nInputs, applyFadeIn, NULL, 0, 0);
+    SAF_PROFILE_END(pData->hProf, "afSTFTforward");
+    
+    /* interpolate hrtfs and apply to each active source; the sources are split into groups, which are spread over the
+     * thread pool (if any), and the binaural frames of the groups are then summed in a fixed order */
+    SAF_PROFILE_BEGIN(pData->hProf, "binauralise");
+    binauraliser_updateHRTFs(hBin, up, objects);
+    hPool = saf_atomic_loadp(&(pData->hPool));
+    pData->nSourceGroups = MIN(MIN(MAX_NUM_SOURCE_GROUPS, saf_pool_getNumThreads(hPool)+1),
+                               MAX(pData->tft->nSrcList/MIN_NUM_SOURCES_PER_GROUP, 1));
+    saf_pool_run(hPool, binauraliser_binauraliseTask, hBin, pData->nSourceGroups);
+    sum_re = (float*)pData->outputTF_re[0];
+    sum_im = (float*)pData->outputTF_im[0];
+    for (group = 1; group < pData->nSourceGroups; group++) {
+        group_re = (const float*)pData->outputTF_re[group];
+        group_im = (const float*)pData->outputTF_im[group];
+        for (i = 0; i < TIME_SLOTS*NUM_EARS*HYBRID_BANDS; i++) {
+            sum_re[i] += group_re[i];
+            sum_im[i] += group_im[i];
+        }
+    }
+    SAF_PROFILE_END(pData->hProf, "binauralise");
+    
+    /* inverse-TFT */
+    SAF_PROFILE_BEGIN(pData->hProf, "afSTFTinverse");
+    binauraliser_synthesis(hBin, NULL, 0, 0, applyFadeOut, outputs, nOutputs);
+    SAF_PROFILE_END(pData->hProf, "afSTFTinverse");
+    SAF_PROFILE_END(pData->hProf, "total");
+    SAF_RT_SCOPE_END;
 }
 
 void binauraliser_process
@@ -159,105 +247,315 @@ void binauraliser_process
 )
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
-    int t, sample, ch, ear, i, band, nSources; 
-    float src_dirs[MAX_NUM_INPUTS][2];
+    int ch, applyFadeIn, applyFadeOut;
+    const userPars* up;
     
-#ifdef ENABLE_FADE_IN_OUT
-    int applyFadeIn;
-    if(pData->reInitTFT || pData->reInitHRTFsAndGainTables)
-        applyFadeIn = 1;
-    else
-        applyFadeIn = 0;
-#endif
-    
-    /* reinitialise if needed */
-    if(pData->reInitTFT){
-        binauraliser_initTFT(hBin);
-        pData->reInitTFT = 0;
-        nSources = pData->nSources;
+    /* consistent snapshot of the user parameters for this frame */
+    up = (const userPars*)saf_paramBlock_read(pData->hUserPars, USER_PARS_AUDIO);
+    
+    /* pick up newly published HRTFs and/or TFT (built on the worker thread, see "binauraliser_codecWorker"); the output
+     * is crossfaded from the previous HRTFs over the frame, whereas for a new TFT it is faded out over the frame before,
+     * and faded in over the frame after */
+    applyFadeIn = binauraliser_pickUpPars(hBin);
+    applyFadeOut = binauraliser_fadeOutPending(hBin);
+    
+    /* apply binaural panner */
+    if ((nSamples == FRAME_SIZE) && (isPlaying == 1) && (pData->pars!=NULL) && (pData->tft!=NULL) && !pData->tft->objectMode) {
+        binauraliser_processFrame(hBin, up, NULL, inputs, outputs, nInputs, nOutputs, applyFadeIn, applyFadeOut);
+        pData->fadedOut = applyFadeOut;
+    }
+    else{
+        for (ch=0; ch < nOutputs; ch++)
+            memset(outputs[ch],0, FRAME_SIZE*sizeof(float));
+        pData->fadedOut = 1;
+    }
+}
+
+void binauraliser_waitForCodecInit(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    saf_worker_wait(pData->hWorker);
+}
+
+
+/* Object Functions */
+
+void binauraliser_setMaxNumObjects
+(
+    void * const hBin,
+    int          maxNumObjects
+)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    
+    maxNumObjects = MAX(MIN(maxNumObjects, MAX_NUM_OBJECTS), 1);
+    saf_objects_destroy(&(pData->hObjects));
+    saf_objects_create(&(pData->hObjects), maxNumObjects, 1);
+    
+    /* the TFT is rebuilt for the objects on the worker thread */
+    saf_atomic_storei(&(pData->objectMode), 1);
+    binauraliser_requestInit(hBin, &(pData->reInitTFT));
+}
+
+int binauraliser_addObject(void* const hBin, int id, float azi_deg, float elev_deg, float gain)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    if(pData->hObjects==NULL)
+        return -1;
+    return saf_objects_add(pData->hObjects, id, azi_deg, elev_deg, gain);
+}
+
+int binauraliser_removeObject(void* const hBin, int id)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    if(pData->hObjects==NULL)
+        return -1;
+    return saf_objects_remove(pData->hObjects, id);
+}
+
+int binauraliser_updateObject(void* const hBin, int id, float azi_deg, float elev_deg, float gain)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    if(pData->hObjects==NULL)
+        return -1;
+    return saf_objects_update(pData->hObjects, id, azi_deg, elev_deg, gain);
+}
+
+void binauraliser_commitObjects(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    if(pData->hObjects!=NULL)
+        saf_objects_publish(pData->hObjects);
+}
+
+int binauraliser_getMaxNumObjects(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return pData->hObjects==NULL ? 0 : saf_objects_getMaxNumObjects(pData->hObjects);
+}
+
+int binauraliser_getNumObjects(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return pData->hObjects==NULL ? 0 : saf_objects_getNumObjects(pData->hObjects);
+}
+
+void binauraliser_processObjects
+(
+    void  *  const hBin,
+    float ** const objectInputs,
+    float ** const outputs,
+    int            nObjectInputs,
+    int            nOutputs,
+    int            nSamples,
+    int            isPlaying
+)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    int ch, applyFadeIn, applyFadeOut;
+    const userPars* up;
+    saf_objects_view objects;
+    
+    if(pData->hObjects==NULL){
+        for (ch=0; ch < nOutputs; ch++)
+            memset(outputs[ch],0, FRAME_SIZE*sizeof(float));
+        return;
+    }
+    
+    /* consistent snapshots of the user parameters and objects for this frame */
+    up = (const userPars*)saf_paramBlock_read(pData->hUserPars, USER_PARS_AUDIO);
+    saf_objects_read(pData->hObjects, OBJECTS_AUDIO, &objects);
+    
+    /* pick up newly published HRTFs and/or TFT (as in "binauraliser_process") */
+    applyFadeIn = binauraliser_pickUpPars(hBin);
+    applyFadeOut = binauraliser_fadeOutPending(hBin);
+    
+    /* apply binaural panner, once the TFT has been built for the objects */
+    if ((nSamples == FRAME_SIZE) && (isPlaying == 1) && (pData->pars!=NULL) && (pData->tft!=NULL) && pData->tft->objectMode &&
+        (pData->tft->nSources == objects.maxNumObjects)) {
+        binauraliser_processFrame(hBin, up, &objects, objectInputs, outputs, nObjectInputs, nOutputs, applyFadeIn, applyFadeOut);
+        pData->fadedOut = applyFadeOut;
+    }
+    else{
+        for (ch=0; ch < nOutputs; ch++)
+            memset(outputs[ch],0, FRAME_SIZE*sizeof(float));
+        pData->fadedOut = 1;
+    }
+}
+
+
+/* Batch Functions */
+
+void binauraliser_createBatch
+(
+    void ** const phBatch,
+    int           nInstances
+)
+{
+    binauraliser_batch* pBatch = (binauraliser_batch*)malloc(sizeof(binauraliser_batch));
+    size_t nBytes;
+    int i;
+    
+    if (pBatch == NULL) { return;/*error*/ }
+    *phBatch = (void*)pBatch;
+    pBatch->nInstances = MAX(nInstances, 1);
+    pBatch->hInstances = (void**)malloc(pBatch->nInstances*sizeof(void*));
+    pBatch->applyFadeIn = (int*)calloc(pBatch->nInstances, sizeof(int));
+    pBatch->up = (const userPars**)calloc(pBatch->nInstances, sizeof(const userPars*));
+    for(i=0; i<pBatch->nInstances; i++)
+        binauraliser_create(&(pBatch->hInstances[i]));
+    
+    /* time-frequency buffers; for the maximum number of sources, since the numbers of sources of the instances may
+     * change whilst processing */
+    pBatch->nChannels = MAX_NUM_INPUTS;
+    nBytes = HYBRID_BANDS*(pBatch->nInstances)*TIME_SLOTS*sizeof(float_complex);
+    pBatch->inputframeTF = (float_complex*)malloc(pBatch->nChannels*nBytes);
+    pBatch->outputframeTF = (float_complex*)malloc(NUM_EARS*nBytes);
+}
+
+void binauraliser_destroyBatch
+(
+    void ** const phBatch
+)
+{
+    binauraliser_batch* pBatch = (binauraliser_batch*)(*phBatch);
+    int i;
+    
+    if (pBatch != NULL) {
+        for(i=0; i<pBatch->nInstances; i++)
+            binauraliser_destroy(&(pBatch->hInstances[i]));
+        free(pBatch->hInstances);
+        free(pBatch->applyFadeIn);
+        free((void*)pBatch->up);
+        free(pBatch->inputframeTF);
+        free(pBatch->outputframeTF);
+        free(pBatch);
+        *phBatch = NULL;
+    }
+}
+
+void binauraliser_initBatch
+(
+    void * const hBatch,
+    int          sampleRate
+)
+{
+    binauraliser_batch* pBatch = (binauraliser_batch*)(hBatch);
+    int i;
+    
+    for(i=0; i<pBatch->nInstances; i++)
+        binauraliser_init(pBatch->hInstances[i], sampleRate);
+}
+
+void* binauraliser_getBatchInstance
+(
+    void * const hBatch,
+    int          index
+)
+{
+    binauraliser_batch* pBatch = (binauraliser_batch*)(hBatch);
+    if(index<0 || index>=pBatch->nInstances)
+        return NULL;
+    return pBatch->hInstances[index];
+}
+
+/* pool task: loads and transforms the input of one instance, and updates its interpolated HRTFs */
+static void binauraliser_batchAnalysis(void* arg, int index)
+{
+    binauraliser_batch* pBatch = (binauraliser_batch*)arg;
+    const int ld = pBatch->nInstances*TIME_SLOTS;
+    
+    if(pBatch->up[index]==NULL)
+        return;
+    binauraliser_analysis(pBatch->hInstances[index], pBatch->up[index], NULL, pBatch->inputs[index], pBatch->nInputs, pBatch->applyFadeIn[index],
+                          pBatch->inputframeTF + index*TIME_SLOTS, (pBatch->nChannels)*ld, ld);
+    binauraliser_updateHRTFs(pBatch->hInstances[index], pBatch->up[index], NULL);
+}
+
+/* pool task: binauralises one band of all instances */
+static void binauraliser_batchBinauralise(void* arg, int band)
+{
+    binauraliser_batch* pBatch = (binauraliser_batch*)arg;
+    int i;
+    const int ld = pBatch->nInstances*TIME_SLOTS;
+    
+    for(i=0; i<pBatch->nInstances; i++)
+        if(pBatch->up[i]!=NULL)
+            binauraliser_binauraliseBand(pBatch->hInstances[i], band,
+                                         pBatch->inputframeTF + band*(pBatch->nChannels)*ld + i*TIME_SLOTS,
+                                         pBatch->outputframeTF + band*NUM_EARS*ld + i*TIME_SLOTS, ld);
+}
+
+/* pool task: transforms the output of one instance back to the time-domain */
+static void binauraliser_batchSynthesis(void* arg, int index)
+{
+    binauraliser_batch* pBatch = (binauraliser_batch*)arg;
+    binauraliser_data* pData = (binauraliser_data*)(pBatch->hInstances[index]);
+    const int ld = pBatch->nInstances*TIME_SLOTS;
+    int ch, applyFadeOut;
+    
+    if(pBatch->up[index]==NULL){
+        for (ch=0; ch < pBatch->nOutputs; ch++)
+            memset(pBatch->outputs[index][ch], 0, FRAME_SIZE*sizeof(float));
+        pData->fadedOut = 1;
+        return;
+    }
+    applyFadeOut = binauraliser_fadeOutPending(pData);
+    binauraliser_synthesis(pData, pBatch->outputframeTF + index*TIME_SLOTS, NUM_EARS*ld, ld, applyFadeOut,
+                           pBatch->outputs[index], pBatch->nOutputs);
+    pData->fadedOut = applyFadeOut;
+}
+
+void binauraliser_processBatch
+(
+    void   *  const hBatch,
+    float *** const inputs,
+    float *** const outputs,
+    int             nInputs,
+    int             nOutputs,
+    int             nSamples,
+    int             isPlaying,
+    void   *  const hPool
+)
+{
+    binauraliser_batch* pBatch = (binauraliser_batch*)(hBatch);
+    binauraliser_data* pData;
+    int i, ch;
+    
+    /* pick up newly published HRTFs and/or TFTs; as in "binauraliser_process", but for each instance. Instances which
+     * are not ready (or are configured for objects) output silence */
+    for(i=0; i<pBatch->nInstances; i++){
+        pData = (binauraliser_data*)(pBatch->hInstances[i]);
+        pBatch->up[i] = (const userPars*)saf_paramBlock_read(pData->hUserPars, USER_PARS_AUDIO);
+        pBatch->applyFadeIn[i] = binauraliser_pickUpPars(pData);
+        if(pData->pars==NULL || pData->tft==NULL || pData->tft->objectMode)
+            pBatch->up[i] = NULL;
     }
-    else
-        nSources = pData->nSources;
-    if(pData->reInitHRTFsAndGainTables){
-        binauraliser_initHRTFsAndGainTables(hBin);
-        pData->reInitHRTFsAndGainTables = 0;
-    }
     
     /* apply binaural panner */
-    if ((nSamples == FRAME_SIZE) && (isPlaying == 1) && (pData->hrtf_fb!=NULL)) {
-        nSources = pData->nSources;  
-        memcpy(src_dirs, pData->src_dirs_deg, MAX_NUM_INPUTS*2*sizeof(float));
-        /* Load time-domain data */
-        for(i=0; i < MIN(nSources,nInputs); i++)
-            memcpy(pData->inputFrameTD[i], inputs[i], FRAME_SIZE * sizeof(float));
-        for(; i<MAX_NUM_INPUTS; i++)
-            memset(pData->inputFrameTD[i], 0, FRAME_SIZE * sizeof(float));
-#ifdef ENABLE_FADE_IN_OUT
-        if(applyFadeIn)
-            for(ch=0; ch < nSources;ch++)
-                for(i=0; i<FRAME_SIZE; i++)
-                    pData->inputFrameTD[ch][i] *= (float)i/(float)FRAME_SIZE;
-#endif
+    if ((nSamples == FRAME_SIZE) && (isPlaying == 1)) {
+        SAF_RT_SCOPE_BEGIN;
+        pBatch->inputs = inputs;
+        pBatch->outputs = outputs;
+        pBatch->nInputs = nInputs;
+        pBatch->nOutputs = nOutputs;
         
-        /* Apply time-frequency transform (TFT) */
-        for ( t=0; t< TIME_SLOTS; t++) {
-            for( ch=0; ch < nSources; ch++)
-                for ( sample=0; sample < HOP_SIZE; sample++)
-                    pData->tempHopFrameTD[ch][sample] = pData->inputFrameTD[ch][sample + t*HOP_SIZE];
-            afSTFTforward(pData->hSTFT, (float**)pData->tempHopFrameTD, (complexVector*)pData->STFTInputFrameTF[t]);
-        }
-        for(band=0; band<HYBRID_BANDS; band++)
-            for( ch=0; ch < nSources; ch++)
-                for ( t=0; t<TIME_SLOTS; t++)
-                    pData->inputframeTF[band][ch][t] = cmplxf(pData->STFTInputFrameTF[t][ch].re[band], pData->STFTInputFrameTF[t][ch].im[band]);
-     
-        /* interpolate hrtfs and apply to each source */
-        memset(pData->outputframeTF, 0, HYBRID_BANDS*NUM_EARS*TIME_SLOTS * sizeof(float_complex));
-        for (ch = 0; ch < nSources; ch++) {
-            if(pData->recalc_hrtf_interpFLAG[ch]){
-                binauraliser_interpHRTFs(hBin, pData->src_dirs_deg[ch][0], pData->src_dirs_deg[ch][1], pData->hrtf_interp[ch]);
-                pData->recalc_hrtf_interpFLAG[ch] = 0;
-            }
-            for (band = 0; band < HYBRID_BANDS; band++)
-                for (ear = 0; ear < NUM_EARS; ear++)
-                    for (t = 0; t < TIME_SLOTS; t++)
-                        pData->outputframeTF[band][ear][t] = ccaddf(pData->outputframeTF[band][ear][t], ccmulf(pData->inputframeTF[band][ch][t], pData->hrtf_interp[ch][band][ear]));
-        }
+        /* per instance: time-frequency transform and HRTF interpolation */
+        saf_pool_run(hPool, binauraliser_batchAnalysis, (void*)pBatch, pBatch->nInstances);
         
-        /* scale by number of sources */
-        for (band = 0; band < HYBRID_BANDS; band++)
-            for (ear = 0; ear < NUM_EARS; ear++)
-                for (t = 0; t < TIME_SLOTS; t++)
-                    pData->outputframeTF[band][ear][t] = crmulf(pData->outputframeTF[band][ear][t], 1.0f/sqrtf((float)nSources));
-        
-        /* inverse-TFT */
-        for (band = 0; band < HYBRID_BANDS; band++) {
-            for (ch = 0; ch < NUM_EARS; ch++) {
-                for (t = 0; t < TIME_SLOTS; t++) {
-                    pData->STFTOutputFrameTF[t][ch].re[band] = crealf(pData->outputframeTF[band][ch][t]);
-                    pData->STFTOutputFrameTF[t][ch].im[band] = cimagf(pData->outputframeTF[band][ch][t]);
-                }
-            }
-        }
-        for (t = 0; t < TIME_SLOTS; t++) {
-            afSTFTinverse(pData->hSTFT, pData->STFTOutputFrameTF[t], pData->tempHopFrameTD);
-            for (ch = 0; ch < MIN(NUM_EARS, nOutputs); ch++)
-                for (sample = 0; sample < HOP_SIZE; sample++)
-                    outputs[ch][sample + t* HOP_SIZE] = pData->tempHopFrameTD[ch][sample];
-            for (; ch < nOutputs; ch++)
-                for (sample = 0; sample < HOP_SIZE; sample++)
-                    outputs[ch][sample + t* HOP_SIZE] = 0.0f;
-        }
-#ifdef ENABLE_FADE_IN_OUT
-        if(pData->reInitTFT || pData->reInitHRTFsAndGainTables)
-            for(ch=0; ch < NUM_EARS;ch++)
-                for(i=0; i<FRAME_SIZE; i++)
-                    outputs[ch][i] *= (1.0f - (float)(i+1)/(float)FRAME_SIZE);
-#endif
+        /* per band: binauralisation of all instances */
+        saf_pool_run(hPool, binauraliser_batchBinauralise, (void*)pBatch, HYBRID_BANDS);
+        
+        /* per instance: inverse time-frequency transform */
+        saf_pool_run(hPool, binauraliser_batchSynthesis, (void*)pBatch, pBatch->nInstances);
+        SAF_RT_SCOPE_END;
     }
     else{
-        for (ch=0; ch < nOutputs; ch++)
-            memset(outputs[ch],0, FRAME_SIZE*sizeof(float));
+        for(i=0; i<pBatch->nInstances; i++){
+            for (ch=0; ch < nOutputs; ch++)
+                memset(outputs[i][ch], 0, FRAME_SIZE*sizeof(float));
+            ((binauraliser_data*)(pBatch->hInstances[i]))->fadedOut = 1;
+        }
     }
 }
 
@@ -266,42 +564,56 @@ void binauraliser_process
 void binauraliser_refreshSettings(void* const hBin)
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
-    pData->reInitHRTFsAndGainTables = 1;
-    pData->reInitTFT = 1;
+    saf_paramBlock_edit(pData->hUserPars);
+    saf_paramBlock_publish(pData->hUserPars);
+    saf_atomic_storei(&(pData->reInitHRTFsAndGainTables), 1);
+    binauraliser_requestInit(hBin, &(pData->reInitTFT));
+}
+
+void binauraliser_setThreadPool(void* const hBin, void* const hPool)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    saf_atomic_storep(&(pData->hPool), hPool);
 }
 
 void binauraliser_setSourceAzi_deg(void* const hBin, int index, float newAzi_deg)
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
     newAzi_deg = MAX(newAzi_deg, -180.0f);
     newAzi_deg = MIN(newAzi_deg, 180.0f);
-    pData->recalc_hrtf_interpFLAG[index] = 1;
-    pData->src_dirs_deg[index][0] = newAzi_deg;
+    up->src_dirs_deg[index][0] = newAzi_deg;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void binauraliser_setSourceElev_deg(void* const hBin, int index, float newElev_deg)
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
     newElev_deg = MAX(newElev_deg, -90.0f);
     newElev_deg = MIN(newElev_deg, 90.0f);
-    pData->recalc_hrtf_interpFLAG[index] = 1;
-    pData->src_dirs_deg[index][1] = newElev_deg;
+    up->src_dirs_deg[index][1] = newElev_deg;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void binauraliser_setNumSources(void* const hBin, int new_nSources)
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
-    pData->new_nSources = new_nSources > MAX_NUM_INPUTS ? MAX_NUM_INPUTS : new_nSources;
-    if(pData->nSources != pData->new_nSources)
-        pData->reInitTFT = 1;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    int nSources_prev = up->nSources;
+    int nSources = new_nSources > MAX_NUM_INPUTS ? MAX_NUM_INPUTS : new_nSources;
+    up->nSources = nSources;
+    saf_paramBlock_publish(pData->hUserPars);
+    if(nSources_prev != nSources)
+        binauraliser_requestInit(hBin, &(pData->reInitTFT));
 }
 
 void binauraliser_setUseDefaultHRIRsflag(void* const hBin, int newState)
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
-    if((!pData->useDefaultHRIRsFLAG) && (newState)){
-        pData->useDefaultHRIRsFLAG = newState;
-        pData->reInitHRTFsAndGainTables = 1;
+    if((!saf_atomic_loadi(&(pData->useDefaultHRIRsFLAG))) && (newState)){
+        saf_atomic_storei(&(pData->useDefaultHRIRsFLAG), newState);
+        binauraliser_requestInit(hBin, &(pData->reInitHRTFsAndGainTables));
     }
 }
 
@@ -311,21 +623,58 @@ void binauraliser_setSofaFilePath(void* const hBin, const char* path)
     
     pData->sofa_filepath = malloc(strlen(path) + 1);
     strcpy(pData->sofa_filepath, path);
-    pData->useDefaultHRIRsFLAG = 0;
-    pData->reInitHRTFsAndGainTables = 1; 
+    saf_atomic_storei(&(pData->useDefaultHRIRsFLAG), 0);
+    binauraliser_requestInit(hBin, &(pData->reInitHRTFsAndGainTables));
+}
+
+void binauraliser_setInterpPerTimeSlot(void* const hBin, int newState)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->interpPerTimeSlot = newState ? 1 : 0;
+    saf_paramBlock_publish(pData->hUserPars);
+}
+
+void binauraliser_setActivityHoldTime(void* const hBin, float newHold_ms)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->activityHold_ms = MAX(newHold_ms, 0.0f);
+    saf_paramBlock_publish(pData->hUserPars);
+}
+
+void binauraliser_setHRTFCacheResolution(void* const hBin, float newRes_deg)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    if(newRes_deg > 0.0f){
+        newRes_deg = MAX(newRes_deg, MIN_HRTF_CACHE_RES_DEG);
+        newRes_deg = MIN(newRes_deg, MAX_HRTF_CACHE_RES_DEG);
+    }
+    else
+        newRes_deg = 0.0f;
+    pData->hrtfCacheRes = newRes_deg;
+    binauraliser_requestInit(hBin, &(pData->reInitHRTFCache));
+}
+
+void binauraliser_setHRTFCacheSize(void* const hBin, int newSize_kB)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    pData->hrtfCacheSize_kB = MAX(newSize_kB, 0);
+    binauraliser_requestInit(hBin, &(pData->reInitHRTFCache));
 }
 
 void binauraliser_setInputConfigPreset(void* const hBin, int newPresetID)
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
-    int ch;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    int nSources_prev, nSources;
     
-    binauraliser_loadPreset(newPresetID, pData->src_dirs_deg, &(pData->new_nSources), &(pData->input_nDims));
-    if(pData->nSources != pData->new_nSources)
-        pData->reInitTFT = 1;
-    for(ch=0; ch<MAX_NUM_INPUTS; ch++){
-        pData->recalc_hrtf_interpFLAG[ch] = 1;
-    }
+    nSources_prev = up->nSources;
+    binauraliser_loadPreset(newPresetID, up->src_dirs_deg, &(up->nSources), &(up->input_nDims));
+    nSources = up->nSources;
+    saf_paramBlock_publish(pData->hUserPars);
+    if(nSources_prev != nSources)
+        binauraliser_requestInit(hBin, &(pData->reInitTFT));
 }
 
 
@@ -334,19 +683,22 @@ void binauraliser_setInputConfigPreset(void* const hBin, int newPresetID)
 float binauraliser_getSourceAzi_deg(void* const hBin, int index)
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
-    return pData->src_dirs_deg[index][0];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->src_dirs_deg[index][0];
 }
 
 float binauraliser_getSourceElev_deg(void* const hBin, int index)
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
-    return pData->src_dirs_deg[index][1];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->src_dirs_deg[index][1];
 }
 
 int binauraliser_getNumSources(void* const hBin)
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
-    return pData->nSources;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->nSources;
 }
 
 int binauraliser_getMaxNumSources()
@@ -399,7 +751,7 @@ int binauraliser_getHRIRsamplerate(void* const hBin)
 int binauraliser_getUseDefaultHRIRsflag(void* const hBin)
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
-    return pData->useDefaultHRIRsFLAG;
+    return saf_atomic_loadi(&(pData->useDefaultHRIRsFLAG));
 }
 
 char* binauraliser_getSofaFilePath(void* const hCmp)
@@ -415,6 +767,61 @@ int binauraliser_getDAWsamplerate(void* const hBin)
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
     return pData->fs;
+}
+
+int binauraliser_getInterpPerTimeSlot(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->interpPerTimeSlot;
+}
+
+float binauraliser_getActivityHoldTime(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->activityHold_ms;
+}
+
+int binauraliser_getNumActiveSources(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return saf_atomic_loadi(&(pData->nActiveSources));
+}
+
+float binauraliser_getHRTFCacheResolution(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return pData->hrtfCacheRes;
+}
+
+int binauraliser_getHRTFCacheSize(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return pData->hrtfCacheSize_kB;
+}
+
+int binauraliser_getHRTFCacheHits(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return saf_atomic_loadi(&(pData->hrtfCacheHits));
+}
+
+int binauraliser_getHRTFCacheMisses(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return saf_atomic_loadi(&(pData->hrtfCacheMisses));
+}
+
+int binauraliser_getProcessingDelay(void)
+{
+    return afSTFTdelay(HOP_SIZE, 0, 1);
+}
+
+void* binauraliser_getProfiler(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return pData->hProf;
 } 
 
 
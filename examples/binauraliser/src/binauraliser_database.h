@@ -1,18 +0,0 @@
-/*
-    Leo McCormack
-    ../database/binauraliser_database_kemarhead_aalto2016/binauraliser_database.h
-    Generated using MatLab on: 23-Nov-2017 
-*/
-
-#ifndef __BINAURALISER_DATABASE_INCLUDED__
-#define __BINAURALISER_DATABASE_INCLUDED__
-
-extern const double __afCenterFreq48e3[133];
-extern const double __afCenterFreq44100[133];
-extern const double __default_hrirs[217][2][1024];
-extern const double __default_hrir_dirs_deg[217][2];
-extern const int __default_N_hrir_dirs;
-extern const int __default_hrir_len;
-extern const int __default_hrir_fs;
-
-#endif /* __BINAURALISER_DATABASE_INCLUDED__ */
@@ -36,189 +36,807 @@
 static inline float matlab_fmodf(float x, float y) {
     float tmp = fmodf(x, y);
     return tmp >= 0 ? tmp : tmp + y; 
+}
+
+/* returns the phase (in radians) that is applied to the HRTF magnitude of the left ear, and with the opposite sign to
+ * that of the right ear, in order to introduce the interaural phase difference of the given ITD to one band */
+static inline float binauraliser_getIPDphase(codecPars* pars, int band, float itd)
+{
+    return pars->phi_bands[band]*(matlab_fmodf(2.0f*PI*(pars->hrtfRes->centreFreq[band]) * itd + PI, 2.0f*PI) - PI)/2.0f;
+}
+
+/* returns the index of the direction of an (aziRes x elevRes) degree grid, which is nearest to the given direction */
+static int binauraliser_getGridIndex(float azimuth_deg, float elevation_deg, float aziRes, float elevRes)
+{
+    int aziIndex, elevIndex, N_azi;
+    
+    N_azi = (int)(360.0f / aziRes + 0.5f) + 1;
+    aziIndex = (int)(matlab_fmodf(azimuth_deg + 180.0f, 360.0f) / aziRes + 0.5f);
+    elevIndex = (int)((elevation_deg + 90.0f) / elevRes + 0.5f);
+    return elevIndex * N_azi + aziIndex;
+}
+
+/* removes an entry from the least-recently-used order of the HRTF cache */
+static void binauraliser_unlinkHRTFCacheEntry(codecPars* pars, int i)
+{
+    hrtfCacheEntry* entry = &(pars->hrtfCache[i]);
+    
+    if(entry->older>=0)
+        pars->hrtfCache[entry->older].newer = entry->newer;
+    else
+        pars->hrtfCacheOldest = entry->newer;
+    if(entry->newer>=0)
+        pars->hrtfCache[entry->newer].older = entry->older;
+    else
+        pars->hrtfCacheNewest = entry->older;
+}
+
+/* appends an entry to the least-recently-used order of the HRTF cache, as the most recently used one */
+static void binauraliser_linkHRTFCacheEntry(codecPars* pars, int i)
+{
+    hrtfCacheEntry* entry = &(pars->hrtfCache[i]);
+    
+    entry->older = pars->hrtfCacheNewest;
+    entry->newer = -1;
+    if(pars->hrtfCacheNewest>=0)
+        pars->hrtfCache[pars->hrtfCacheNewest].newer = i;
+    else
+        pars->hrtfCacheOldest = i;
+    pars->hrtfCacheNewest = i;
+}
+
+/* interpolates the HRTFs of a direction into a cache entry (split into real and imaginary parts) */
+static void binauraliser_interpHRTFsToEntry(codecPars* const pars, float azimuth_deg, float elevation_deg, hrtfCacheEntry* entry)
+{
+    int ear, band;
+    float_complex h_intrp[HYBRID_BANDS][NUM_EARS];
+    float magInterp[HYBRID_BANDS][NUM_EARS];
+    
+    binauraliser_interpHRTFs(pars, azimuth_deg, elevation_deg, h_intrp, magInterp, &(entry->itd));
+    for (ear = 0; ear < NUM_EARS; ear++) {
+        for (band = 0; band < HYBRID_BANDS; band++) {
+            entry->h_re[ear][band] = crealf(h_intrp[band][ear]);
+            entry->h_im[ear][band] = cimagf(h_intrp[band][ear]);
+            entry->mag[ear][band] = magInterp[band][ear];
+        }
+    }
+}
+
+void binauraliser_requestInit(void* const hBin, volatile int* flag)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    
+    saf_atomic_storei(flag, 1);
+    saf_worker_post(pData->hWorker);
+}
+
+void binauraliser_codecWorker(void* hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    const userPars* up;
+    codecPars* pars, *nextPars;
+    tftPars* tft, *nextTFT;
+    int objectMode;
+    
+    /* free the HRTFs and TFTs the audio thread is no longer using */
+    pars = (codecPars*)saf_atomic_exchangep(&(pData->retiredPars), NULL);
+    for(; pars!=NULL; pars = nextPars){
+        nextPars = pars->next;
+        binauraliser_freeCodecPars(&pars);
+    }
+    tft = (tftPars*)saf_atomic_exchangep(&(pData->retiredTFT), NULL);
+    for(; tft!=NULL; tft = nextTFT){
+        nextTFT = tft->next;
+        binauraliser_freeTFT(&tft);
+    }
+    
+    /* nothing can be built before the sampling rate is known; the flags are left raised for binauraliser_init */
+    if(pData->fs==0)
+        return;
+    
+    /* build fresh HRTFs, along with an empty cache (both flags are cleared before building, so that a request made in
+     * the meantime is carried out on the next run) */
+    if(saf_atomic_exchangei(&(pData->reInitHRTFsAndGainTables), 0) | saf_atomic_exchangei(&(pData->reInitHRTFCache), 0)){
+        pars = (codecPars*)calloc(1, sizeof(codecPars));
+        binauraliser_initHRTFsAndGainTables(hBin, pars);
+        binauraliser_initHRTFCache(hBin, pars);
+        
+        /* publish them; if the audio thread never picked up the previously published ones, they are not needed anymore */
+        pars = (codecPars*)saf_atomic_exchangep(&(pData->pendingPars), (void*)pars);
+        binauraliser_freeCodecPars(&pars);
+    }
+    
+    /* build a fresh TFT, for the current number of input channels, or for the maximum number of objects */
+    if(saf_atomic_exchangei(&(pData->reInitTFT), 0)){
+        up = (const userPars*)saf_paramBlock_read(pData->hUserPars, USER_PARS_WORKER);
+        objectMode = saf_atomic_loadi(&(pData->objectMode));
+        tft = binauraliser_createTFT(objectMode ? saf_objects_getMaxNumObjects(pData->hObjects) : up->nSources, objectMode);
+        tft = (tftPars*)saf_atomic_exchangep(&(pData->pendingTFT), (void*)tft);
+        binauraliser_freeTFT(&tft);
+    }
+}
+
+int binauraliser_pickUpPars(void* const hBin)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    codecPars* newPars;
+    tftPars* newTFT;
+    int ch;
+    
+    /* the previous HRTFs were only needed for the crossfade of the last frame */
+    binauraliser_retireCodecPars(hBin, pData->prevPars);
+    pData->prevPars = NULL;
+    
+    /* a new TFT, once the output has been faded out (unless nothing is being rendered yet) */
+    newTFT = NULL;
+#ifdef ENABLE_FADE_IN_OUT
+    if(pData->fadedOut || pData->pars==NULL || pData->tft==NULL)
+#endif
+        newTFT = (tftPars*)saf_atomic_exchangep(&(pData->pendingTFT), NULL);
+    pData->fadedOut = 0;
+    if(newTFT!=NULL){
+        binauraliser_retireTFT(hBin, pData->tft);
+        pData->tft = newTFT;
+    }
+    
+    /* new HRTFs; crossfaded from the previous ones, unless nothing was being rendered with them (the HRTFs of the
+     * sources of a new TFT are calculated afresh anyway) */
+    newPars = (codecPars*)saf_atomic_exchangep(&(pData->pendingPars), NULL);
+    if(newPars!=NULL){
+        if(pData->pars!=NULL && pData->tft!=NULL && newTFT==NULL)
+            pData->prevPars = pData->pars;
+        else{
+            binauraliser_retireCodecPars(hBin, pData->pars);
+            if(pData->tft!=NULL)
+                for(ch=0; ch<pData->tft->nSources; ch++)
+                    pData->tft->recalc_hrtf_interpFLAG[ch] = 1;
+        }
+        pData->pars = newPars;
+    }
+    return newTFT!=NULL || (newPars!=NULL && pData->prevPars==NULL);
+}
+
+int binauraliser_fadeOutPending(void* const hBin)
+{
+#ifdef ENABLE_FADE_IN_OUT
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    return saf_atomic_loadp(&(pData->pendingTFT))!=NULL;
+#else
+    return 0;
+#endif
+}
+
+void binauraliser_retireCodecPars(void* const hBin, codecPars* const pars)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    void* head;
+    
+    if(pars==NULL)
+        return;
+    /* lock-free push; the worker thread only ever takes the whole list at once, so there is no ABA problem */
+    do{
+        head = saf_atomic_loadp(&(pData->retiredPars));
+        pars->next = (codecPars*)head;
+    } while(!saf_atomic_casp(&(pData->retiredPars), head, (void*)pars));
+}
+
+void binauraliser_retireTFT(void* const hBin, tftPars* const tft)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    void* head;
+    
+    if(tft==NULL)
+        return;
+    /* lock-free push (as "binauraliser_retireCodecPars") */
+    do{
+        head = saf_atomic_loadp(&(pData->retiredTFT));
+        tft->next = (tftPars*)head;
+    } while(!saf_atomic_casp(&(pData->retiredTFT), head, (void*)tft));
 }
 
 void binauraliser_interpHRTFs
 (
-    void* const hBin,
+    codecPars* const pars,
     float azimuth_deg,
     float elevation_deg,
-    float_complex h_intrp[HYBRID_BANDS][NUM_EARS]
+    float_complex h_intrp[HYBRID_BANDS][NUM_EARS],
+    float magInterp[HYBRID_BANDS][NUM_EARS],
+    float* itdInterp
 )
 {
-    binauraliser_data *pData = (binauraliser_data*)(hBin);
     int i, band;
-    int aziIndex, elevIndex, N_azi, idx3d;
+    int idx3d;
     float_complex ipd;
-    float aziRes, elevRes, weights[3], itds3[3],  itdInterp;
-    float magnitudes3[HYBRID_BANDS][3][NUM_EARS], magInterp[HYBRID_BANDS][NUM_EARS];
+    float weights[3], itds3[3];
+    float magnitudes3[HYBRID_BANDS][3][NUM_EARS];
      
     /* find closest pre-computed VBAP direction */
-    aziRes = (float)pData->hrtf_vbapTableRes[0];
-    elevRes = (float)pData->hrtf_vbapTableRes[1];
-    N_azi = (int)(360.0f / aziRes + 0.5f) + 1;
-    aziIndex = (int)(matlab_fmodf(azimuth_deg + 180.0f, 360.0f) / aziRes + 0.5f);
-    elevIndex = (int)((elevation_deg + 90.0f) / elevRes + 0.5f);
-    idx3d = elevIndex * N_azi + aziIndex;
+    idx3d = binauraliser_getGridIndex(azimuth_deg, elevation_deg, (float)pars->hrtf_vbapTableRes[0],
+                                      (float)pars->hrtf_vbapTableRes[1]);
     for (i = 0; i < 3; i++)
-        weights[i] = pData->hrtf_vbap_gtableComp[idx3d*3 + i];
+        weights[i] = pars->hrtf_vbap_gtableComp[idx3d*3 + i];
     
     /* retrieve the 3 itds and hrtf magnitudes */
     for (i = 0; i < 3; i++) {
-        itds3[i] = pData->itds_s[pData->hrtf_vbap_gtableIdx[idx3d*3+i]];
+        itds3[i] = pars->itds_s[pars->hrtf_vbap_gtableIdx[idx3d*3+i]];
         for (band = 0; band < HYBRID_BANDS; band++) {
-            magnitudes3[band][i][0] = pData->hrtf_fb_mag[band*NUM_EARS*(pData->N_hrir_dirs) + 0*(pData->N_hrir_dirs) + pData->hrtf_vbap_gtableIdx[idx3d*3+i]];
-            magnitudes3[band][i][1] = pData->hrtf_fb_mag[band*NUM_EARS*(pData->N_hrir_dirs) + 1*(pData->N_hrir_dirs) + pData->hrtf_vbap_gtableIdx[idx3d*3+i]];
+            magnitudes3[band][i][0] = pars->hrtf_fb_mag[band*NUM_EARS*(pars->N_hrir_dirs) + 0*(pars->N_hrir_dirs) + pars->hrtf_vbap_gtableIdx[idx3d*3+i]];
+            magnitudes3[band][i][1] = pars->hrtf_fb_mag[band*NUM_EARS*(pars->N_hrir_dirs) + 1*(pars->N_hrir_dirs) + pars->hrtf_vbap_gtableIdx[idx3d*3+i]];
         }
     }
     
     /* interpolate hrtf magnitudes and itd */
-    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 1, 1, 3, 1.0f,
-                (float*)weights, 3,
-                (float*)itds3, 1, 0.0f,
-                &itdInterp, 1);
+    utility_sgemm(NO_TRANSPOSE, NO_TRANSPOSE, 1, 1, 3, 1.0f,
+                  (float*)weights, 3,
+                  (float*)itds3, 1, 0.0f,
+                  itdInterp, 1);
     for (band = 0; band < HYBRID_BANDS; band++) {
-        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 1, 2, 3, 1.0f,
-                    (float*)weights, 3,
-                    (float*)magnitudes3[band], 2, 0.0f,
-                    (float*)magInterp[band], 2);
+        utility_sgemm(NO_TRANSPOSE, NO_TRANSPOSE, 1, 2, 3, 1.0f,
+                      (float*)weights, 3,
+                      (float*)magnitudes3[band], 2, 0.0f,
+                      (float*)magInterp[band], 2);
     }
     
     /* introduce interaural phase difference */
     for (band = 0; band < HYBRID_BANDS; band++) {
-        ipd = cmplxf(0.0f, pData->phi_bands[band]*(matlab_fmodf(2.0f*PI*(pData->freqVector[band]) * itdInterp + PI, 2.0f*PI) - PI)/2.0f);
+        ipd = cmplxf(0.0f, binauraliser_getIPDphase(pars, band, *itdInterp));
         h_intrp[band][0] = crmulf(cexpf(ipd), magInterp[band][0]);
         h_intrp[band][1] = crmulf(conjf(cexpf(ipd)), magInterp[band][1]);
     }
 }
 
-void binauraliser_initHRTFsAndGainTables(void* const hBin)
+void binauraliser_initHRTFsAndGainTables(void* const hBin, codecPars* const pars)
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
-    int i, j, k;
-    float* hrtf_vbap_gtable;
+    hrtfResource* hrtfRes;
     
-    /* load sofa file or load default hrir data */
-    if(!pData->useDefaultHRIRsFLAG){
+    /* acquire the HRTF data for the sofa file or the default HRIR set; this is loaded and processed only once, and
+     * then shared (read-only) with any other instance using the same HRIRs */
+    hrtfRes = NULL;
 #ifdef SAF_ENABLE_SOFA_READER
-        loadSofaFile(pData->sofa_filepath,
-                     &(pData->hrirs),
-                     &(pData->hrir_dirs_deg),
-                     &(pData->N_hrir_dirs),
-                     &(pData->hrir_len),
-                     &(pData->hrir_fs));
-        if((pData->hrirs==NULL) || (pData->hrir_dirs_deg == NULL))
-            pData->useDefaultHRIRsFLAG = 1;
-#else
-        pData->useDefaultHRIRsFLAG = 1;
-#endif
+    if(!saf_atomic_loadi(&(pData->useDefaultHRIRsFLAG)))
+        hrtfResource_acquire(pData->sofa_filepath, loadSofaFile, pData->freqVector, HYBRID_BANDS, &hrtfRes);
+#endif
+    if(hrtfRes==NULL){
+        /* the sofa file could not be loaded or triangulated, use the default HRIR set */
+        saf_atomic_storei(&(pData->useDefaultHRIRsFLAG), 1);
+        hrtfResource_acquire(NULL, NULL, pData->freqVector, HYBRID_BANDS, &hrtfRes);
     }
-    if(pData->useDefaultHRIRsFLAG){
-        /* load defaults */
-        pData->N_hrir_dirs = __default_N_hrir_dirs;
-        pData->hrir_len = __default_hrir_len;
-        pData->hrir_fs = __default_hrir_fs;
-        if(pData->hrirs != NULL)
-            free(pData->hrirs);
-        pData->hrirs = malloc(pData->N_hrir_dirs * 2 * (pData->hrir_len)*sizeof(float));
-        for(i=0; i<pData->N_hrir_dirs; i++)
-            for(j=0; j<2; j++)
-                for(k=0; k< pData->hrir_len; k++)
-                    pData->hrirs[i*2*(pData->hrir_len) + j*(pData->hrir_len) + k] = (float)__default_hrirs[i][j][k];
-        if(pData->hrir_dirs_deg != NULL)
-            free(pData->hrir_dirs_deg);
-        pData->hrir_dirs_deg = malloc(pData->N_hrir_dirs * 2 * sizeof(float));
-        for(i=0; i<pData->N_hrir_dirs; i++)
-            for(j=0; j<2; j++)
-                pData->hrir_dirs_deg[i*2+j] = (float)__default_hrir_dirs_deg[i][j];
-    }
+    hrtfResource_release(&(pars->hrtfRes));
+    pars->hrtfRes = hrtfRes;
+    pars->N_hrir_dirs = hrtfRes->N_hrir_dirs;
+    pars->itds_s = hrtfRes->itds_s;
+    pars->hrtf_fb_mag = hrtfRes->hrtf_fb_mag;
+    pars->hrtf_vbapTableRes[0] = hrtfRes->hrtf_vbapTableRes[0];
+    pars->hrtf_vbapTableRes[1] = hrtfRes->hrtf_vbapTableRes[1];
+    pars->hrtf_vbap_gtableIdx = hrtfRes->hrtf_vbap_gtableIdx;
+    pars->hrtf_vbap_gtableComp = hrtfRes->hrtf_vbap_gtableComp;
     
-    /* estimate the ITDs for each HRIR */
-    if(pData->itds_s!= NULL){
-        free(pData->itds_s);
-        pData->itds_s = NULL;
-    }
-    estimateITDs(pData->hrirs, pData->N_hrir_dirs, pData->hrir_len, pData->hrir_fs, &(pData->itds_s));
+    /* estimate phase manipulation curve */
+    estimateIPDmanipCurve(pars->itds_s, pars->N_hrir_dirs, pData->freqVector, HYBRID_BANDS, 343.0f, 1.3f, pars->phi_bands);
+    
+    /* HRIR info for the get functions; the worker thread holds on to these HRTF data for as long as they are current */
+    hrtfResource_acquire(hrtfRes->sofa_filepath, NULL, pData->freqVector, HYBRID_BANDS, &(pData->hrtfRes));
+    pData->hrir_dirs_deg = hrtfRes->hrir_dirs_deg;
+    pData->N_hrir_dirs = hrtfRes->N_hrir_dirs;
+    pData->hrir_len = hrtfRes->hrir_len;
+    pData->hrir_fs = hrtfRes->hrir_fs;
+    pData->nTriangles = hrtfRes->hrtf_nTriangles;
+}
+
+void binauraliser_initHRTFCache(void* const hBin, codecPars* const pars)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    int i, N_azi, N_elev, nEntries;
+    float res;
+    
+    /* grid of the quantised directions; by default that of the VBAP gain table, since the interpolated HRTFs of all
+     * directions within one cell of the table are the same */
+    res = pars->hrtfCacheRes = pData->hrtfCacheRes;
+    pars->hrtfCacheGridRes[0] = res > 0.0f ? res : (float)pars->hrtf_vbapTableRes[0];
+    pars->hrtfCacheGridRes[1] = res > 0.0f ? res : (float)pars->hrtf_vbapTableRes[1];
+    N_azi = (int)(360.0f / pars->hrtfCacheGridRes[0] + 0.5f) + 1;
+    N_elev = (int)(180.0f / pars->hrtfCacheGridRes[1] + 0.5f) + 1;
+    pars->nHRTFCacheKeys = N_azi * N_elev;
+    
+    /* as many entries as fit into the memory budget (but no more than there are directions) */
+    nEntries = (int)MIN((size_t)(pData->hrtfCacheSize_kB) * 1024 / sizeof(hrtfCacheEntry), (size_t)(pars->nHRTFCacheKeys));
+    free(pars->hrtfCache);
+    free(pars->hrtfCacheSlots);
+    pars->hrtfCache = NULL;
+    pars->hrtfCacheSlots = NULL;
+    if(nEntries>0){
+        pars->hrtfCache = (hrtfCacheEntry*)malloc(nEntries*sizeof(hrtfCacheEntry));
+        pars->hrtfCacheSlots = (int*)malloc(pars->nHRTFCacheKeys*sizeof(int));
+        for(i=0; i<pars->nHRTFCacheKeys; i++)
+            pars->hrtfCacheSlots[i] = -1;
+    }
+    pars->nHRTFCacheEntries = nEntries;
+    pars->nHRTFCacheEntriesUsed = 0;
+    pars->hrtfCacheNewest = pars->hrtfCacheOldest = -1;
+    saf_atomic_storei(&(pData->hrtfCacheHits), 0);
+    saf_atomic_storei(&(pData->hrtfCacheMisses), 0);
+}
+
+void binauraliser_freeCodecPars(codecPars** const ppars)
+{
+    codecPars* pars = *ppars;
+    
+    if(pars!=NULL){
+        hrtfResource_release(&(pars->hrtfRes));
+        free(pars->hrtfCache);
+        free(pars->hrtfCacheSlots);
+        free(pars);
+        *ppars = NULL;
+    }
+}
+
+const hrtfCacheEntry* binauraliser_getHRTFs
+(
+    void* const hBin,
+    float azimuth_deg,
+    float elevation_deg
+)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    codecPars* pars = pData->pars;
+    int i, key, N_azi;
+    hrtfCacheEntry* entry;
+    
+    key = binauraliser_getGridIndex(azimuth_deg, elevation_deg, pars->hrtfCacheGridRes[0], pars->hrtfCacheGridRes[1]);
     
-    /* estimate phase manipulation curve */
-    estimateIPDmanipCurve(pData->itds_s, pData->N_hrir_dirs, pData->freqVector, HYBRID_BANDS, 343.0f, 1.3f, pData->phi_bands);
-    
-    /* generate VBAP gain table */
-    hrtf_vbap_gtable = NULL;
-    pData->hrtf_vbapTableRes[0] = 2;
-    pData->hrtf_vbapTableRes[1] = 5;
-    generateVBAPgainTable3D(pData->hrir_dirs_deg, pData->N_hrir_dirs, pData->hrtf_vbapTableRes[0], pData->hrtf_vbapTableRes[1], 1, 0,
-                            &hrtf_vbap_gtable, &(pData->N_hrtf_vbap_gtable), &(pData->nTriangles));
-    if(hrtf_vbap_gtable==NULL){
-        /* if generating vbap gain tabled failed, re-calculate with default HRIR set */
-        pData->useDefaultHRIRsFLAG = 1;
-        binauraliser_initHRTFsAndGainTables(hBin);
+    /* no cache (or a direction outside of the grid): interpolate directly */
+    if(pars->nHRTFCacheEntries==0 || key<0 || key>=pars->nHRTFCacheKeys){
+        saf_atomic_storei(&(pData->hrtfCacheMisses), pData->hrtfCacheMisses+1);
+        binauraliser_interpHRTFsToEntry(pars, azimuth_deg, elevation_deg, &(pData->hrtfScratch));
+        return &(pData->hrtfScratch);
     }
+    
+    /* hit: becomes the most recently used entry */
+    i = pars->hrtfCacheSlots[key];
+    if(i>=0){
+        saf_atomic_storei(&(pData->hrtfCacheHits), pData->hrtfCacheHits+1);
+        binauraliser_unlinkHRTFCacheEntry(pars, i);
+        binauraliser_linkHRTFCacheEntry(pars, i);
+        return &(pars->hrtfCache[i]);
+    }
+    
+    /* miss: interpolate into the next free entry, or into the least recently used one once the cache is full */
+    saf_atomic_storei(&(pData->hrtfCacheMisses), pData->hrtfCacheMisses+1);
+    if(pars->nHRTFCacheEntriesUsed < pars->nHRTFCacheEntries)
+        i = pars->nHRTFCacheEntriesUsed++;
+    else{
+        i = pars->hrtfCacheOldest;
+        pars->hrtfCacheSlots[pars->hrtfCache[i].key] = -1;
+        binauraliser_unlinkHRTFCacheEntry(pars, i);
+    }
+    entry = &(pars->hrtfCache[i]);
+    if(pars->hrtfCacheRes > 0.0f){
+        /* the HRTFs of the grid direction, so that they hold for all directions rounded to it */
+        N_azi = (int)(360.0f / pars->hrtfCacheGridRes[0] + 0.5f) + 1;
+        azimuth_deg = (float)(key % N_azi) * pars->hrtfCacheGridRes[0] - 180.0f;
+        elevation_deg = MIN((float)(key / N_azi) * pars->hrtfCacheGridRes[1] - 90.0f, 90.0f);
+    }
+    binauraliser_interpHRTFsToEntry(pars, azimuth_deg, elevation_deg, entry);
+    entry->key = key;
+    pars->hrtfCacheSlots[key] = i;
+    binauraliser_linkHRTFCacheEntry(pars, i);
+    return entry;
+}
+
+tftPars* binauraliser_createTFT
+(
+    int new_nSources,
+    int objectMode
+)
+{
+    tftPars* tft;
+    int t, ch;
     
-    /* compress VBAP table */
-    if(pData->hrtf_vbap_gtableComp!= NULL){
-        free(pData->hrtf_vbap_gtableComp);
-        pData->hrtf_vbap_gtableComp = NULL;
+    tft = (tftPars*)calloc(1, sizeof(tftPars));
+    tft->nSources = new_nSources;
+    tft->objectMode = objectMode;
+    afSTFTinit(&(tft->hSTFT), HOP_SIZE, new_nSources, NUM_EARS, 0, 1);
+    tft->STFTInputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, new_nSources, sizeof(complexVector));
+    for(t=0; t<TIME_SLOTS; t++) {
+        for(ch=0; ch< new_nSources; ch++) {
+            tft->STFTInputFrameTF[t][ch].re = (float*)calloc(HYBRID_BANDS, sizeof(float));
+            tft->STFTInputFrameTF[t][ch].im = (float*)calloc(HYBRID_BANDS, sizeof(float));
+        }
     }
-    if(pData->hrtf_vbap_gtableIdx!= NULL){
-        free(pData->hrtf_vbap_gtableIdx);
-        pData->hrtf_vbap_gtableIdx = NULL;
+    tft->tempHopFrameTD = (float**)malloc2d( MAX(new_nSources, NUM_EARS), HOP_SIZE, sizeof(float));
+    tft->inputFrameTD = (float**)malloc2d(new_nSources, FRAME_SIZE, sizeof(float));
+    
+    /* source state; the HRTFs of all sources are calculated afresh, and all sources start out inactive, with their
+     * TFT memory cleared (see binauraliser_analysis) */
+    tft->hrtf_re = calloc(new_nSources, sizeof(*(tft->hrtf_re)));
+    tft->hrtf_im = calloc(new_nSources, sizeof(*(tft->hrtf_im)));
+    tft->hrtf_gain = (float*)calloc(new_nSources, sizeof(float));
+    tft->hrtf_mag = calloc(new_nSources, sizeof(*(tft->hrtf_mag)));
+    tft->hrtf_itd = (float*)calloc(new_nSources, sizeof(float));
+    tft->prev_hrtf_mag = calloc(new_nSources, sizeof(*(tft->prev_hrtf_mag)));
+    tft->prev_hrtf_itd = (float*)calloc(new_nSources, sizeof(float));
+    tft->hrtf_moving = (int*)calloc(new_nSources, sizeof(int));
+    tft->interp_dirs_deg = calloc(new_nSources, sizeof(*(tft->interp_dirs_deg)));
+    tft->sourceActive = (int*)calloc(new_nSources, sizeof(int));
+    tft->nSilentFrames = (int*)calloc(new_nSources, sizeof(int));
+    tft->sourceGeneration = (int*)calloc(new_nSources, sizeof(int));
+    tft->srcList = (int*)malloc(new_nSources*sizeof(int));
+    tft->nSrcList = 0;
+    tft->recalc_hrtf_interpFLAG = (int*)malloc(new_nSources*sizeof(int));
+    for(ch=0; ch<new_nSources; ch++)
+        tft->recalc_hrtf_interpFLAG[ch] = 1;
+    return tft;
+}
+
+void binauraliser_freeTFT(tftPars** const ptft)
+{
+    tftPars* tft = *ptft;
+    int t, ch;
+    
+    if (tft == NULL)
+        return;
+    afSTFTfree(tft->hSTFT);
+    for (t = 0; t<TIME_SLOTS; t++) {
+        for (ch = 0; ch< tft->nSources; ch++) {
+            free(tft->STFTInputFrameTF[t][ch].re);
+            free(tft->STFTInputFrameTF[t][ch].im);
+        }
     }
-    compressVBAPgainTable3D(hrtf_vbap_gtable, pData->N_hrtf_vbap_gtable, pData->N_hrir_dirs, &(pData->hrtf_vbap_gtableComp), &(pData->hrtf_vbap_gtableIdx));
+    free2d((void**)tft->STFTInputFrameTF, TIME_SLOTS);
+    free2d((void**)tft->tempHopFrameTD, MAX(tft->nSources, NUM_EARS));
+    free2d((void**)tft->inputFrameTD, tft->nSources);
+    free(tft->hrtf_re);
+    free(tft->hrtf_im);
+    free(tft->hrtf_gain);
+    free(tft->hrtf_mag);
+    free(tft->hrtf_itd);
+    free(tft->prev_hrtf_mag);
+    free(tft->prev_hrtf_itd);
+    free(tft->hrtf_moving);
+    free(tft->interp_dirs_deg);
+    free(tft->sourceActive);
+    free(tft->nSilentFrames);
+    free(tft->sourceGeneration);
+    free(tft->srcList);
+    free(tft->recalc_hrtf_interpFLAG);
+    free(tft);
+    *ptft = NULL;
+}
+
+void binauraliser_analysis
+(
+    void* const hBin,
+    const userPars* up,
+    const saf_objects_view* objects,
+    float** const inputs,
+    int nInputs,
+    int applyFadeIn,
+    float_complex* inputframeTF,
+    int bandStride,
+    int chStride
+)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    tftPars* tft = pData->tft;
+    int i, j, t, ch, band, sample, nCandidates, wasActive, holdFrames;
+    
+    /* in object mode, only the sources of the current objects are considered; the others are neither loaded nor
+     * transformed, so that the cost of a frame scales with the number of (active) objects */
+    nCandidates = objects==NULL ? tft->nSources : objects->nObjects;
     
-    /* convert hrirs to filterbank coefficients */
-    if(pData->hrtf_fb!= NULL){
-        free(pData->hrtf_fb);
-        pData->hrtf_fb = NULL;
+    /* sources are skipped once they have been silent for longer than the hold time, and the memory of the TFT */
+    holdFrames = saf_activity_getHoldFrames(up->activityHold_ms, (float)pData->fs, FRAME_SIZE, afSTFTtail(HOP_SIZE, 1));
+    tft->nSrcList = 0;
+    for(j=0; j<nCandidates; j++){
+        ch = objects==NULL ? j : objects->ids[j];
+        if(objects!=NULL && objects->generations[ch] != tft->sourceGeneration[ch]){
+            /* the object has been (re)added since the last frame; it starts afresh */
+            tft->sourceGeneration[ch] = objects->generations[ch];
+            tft->sourceActive[ch] = 0;
+            tft->nSilentFrames[ch] = 0;
+        }
+        
+        /* Load time-domain data */
+        if(ch < nInputs && inputs[ch]!=NULL)
+            memcpy(tft->inputFrameTD[ch], inputs[ch], FRAME_SIZE * sizeof(float));
+        else
+            memset(tft->inputFrameTD[ch], 0, FRAME_SIZE * sizeof(float));
+#ifdef ENABLE_FADE_IN_OUT
+        if(applyFadeIn)
+            for(i=0; i<FRAME_SIZE; i++)
+                tft->inputFrameTD[ch][i] *= (float)i/(float)FRAME_SIZE;
+#endif
+        
+        wasActive = tft->sourceActive[ch];
+        tft->sourceActive[ch] = saf_activity_update(tft->inputFrameTD[ch], FRAME_SIZE, holdFrames, &(tft->nSilentFrames[ch]));
+        if(!tft->sourceActive[ch]){
+            /* (it resumes from silence, so without interpolating from its HRTFs of when it was last active) */
+            tft->recalc_hrtf_interpFLAG[ch] = 1;
+            continue;
+        }
+        if(!wasActive)
+            afSTFTclearChannel(tft->hSTFT, ch);
+        tft->srcList[tft->nSrcList++] = ch;
+    }
+    saf_atomic_storei(&(pData->nActiveSources), tft->nSrcList);
+    
+    /* Apply time-frequency transform (TFT) */
+    for ( t=0; t< TIME_SLOTS; t++) {
+        for( j=0; j < tft->nSrcList; j++){
+            ch = tft->srcList[j];
+            for ( sample=0; sample < HOP_SIZE; sample++)
+                tft->tempHopFrameTD[ch][sample] = tft->inputFrameTD[ch][sample + t*HOP_SIZE];
+        }
+        afSTFTforwardChannels(tft->hSTFT, (float**)tft->tempHopFrameTD, (complexVector*)tft->STFTInputFrameTF[t],
+                              tft->srcList, tft->nSrcList);
+    }
+    if(inputframeTF==NULL)
+        return;
+    for(band=0; band<HYBRID_BANDS; band++){
+        for( j=0; j < tft->nSrcList; j++){
+            ch = tft->srcList[j];
+            for ( t=0; t<TIME_SLOTS; t++)
+                inputframeTF[band*bandStride + ch*chStride + t] = cmplxf(tft->STFTInputFrameTF[t][ch].re[band], tft->STFTInputFrameTF[t][ch].im[band]);
+        }
     }
-    HRIRs2FilterbankHRTFs(pData->hrirs, pData->N_hrir_dirs, pData->hrir_len, pData->itds_s, pData->freqVector, HYBRID_BANDS, &(pData->hrtf_fb));
-    
-    /* calculate magnitude responses */
-    if(pData->hrtf_fb_mag!= NULL)
-        free(pData->hrtf_fb_mag);
-    pData->hrtf_fb_mag = malloc(HYBRID_BANDS*NUM_EARS* (pData->N_hrir_dirs)*sizeof(float));
-    for(i=0; i<HYBRID_BANDS*NUM_EARS* (pData->N_hrir_dirs); i++)
-        pData->hrtf_fb_mag[i] = cabsf(pData->hrtf_fb[i]);
-    
-    /* clean-up */
-    if(hrtf_vbap_gtable!=NULL)
-        free(hrtf_vbap_gtable);
 }
 
-void binauraliser_initTFT
+/* updates the HRTFs of the active sources, from "pData->pars" (see "binauraliser_updateHRTFs") */
+static void binauraliser_updateSourceHRTFs
 (
-    void* const hBin
+    void* const hBin,
+    const userPars* up,
+    const saf_objects_view* objects
 )
 {
     binauraliser_data *pData = (binauraliser_data*)(hBin);
-    int t, ch;
+    tftPars* tft = pData->tft;
+    int i, ch, ear, band;
+    float gain;
+    const float* dir;
+    const hrtfCacheEntry* hrtfs;
+    
+    for (i = 0; i < tft->nSrcList; i++) {
+        ch = tft->srcList[i];
+        if(objects==NULL){
+            dir = up->src_dirs_deg[ch];
+            gain = 1.0f/sqrtf((float)tft->nSources);
+        }
+        else{
+            dir = objects->dirs_deg[ch];
+            gain = objects->gains[ch];
+        }
+        tft->hrtf_moving[ch] = 0;
+        if(gain != tft->hrtf_gain[ch] || tft->recalc_hrtf_interpFLAG[ch] || dir[0] != tft->interp_dirs_deg[ch][0] ||
+           dir[1] != tft->interp_dirs_deg[ch][1]){
+            hrtfs = binauraliser_getHRTFs(hBin, dir[0], dir[1]);
+            if(up->interpPerTimeSlot && !tft->recalc_hrtf_interpFLAG[ch]){
+                /* (there are no previous HRTFs to start from, if they are being recalculated) */
+                memcpy(tft->prev_hrtf_mag[ch], tft->hrtf_mag[ch], NUM_EARS*HYBRID_BANDS*sizeof(float));
+                tft->prev_hrtf_itd[ch] = tft->hrtf_itd[ch];
+                tft->hrtf_moving[ch] = 1;
+            }
+            for (ear = 0; ear < NUM_EARS; ear++) {
+                for (band = 0; band < HYBRID_BANDS; band++) {
+                    tft->hrtf_re[ch][ear][band] = gain * hrtfs->h_re[ear][band];
+                    tft->hrtf_im[ch][ear][band] = gain * hrtfs->h_im[ear][band];
+                    tft->hrtf_mag[ch][ear][band] = gain * hrtfs->mag[ear][band];
+                }
+            }
+            tft->hrtf_itd[ch] = hrtfs->itd;
+            tft->hrtf_gain[ch] = gain;
+            tft->interp_dirs_deg[ch][0] = dir[0];
+            tft->interp_dirs_deg[ch][1] = dir[1];
+            tft->recalc_hrtf_interpFLAG[ch] = 0;
+        }
+    }
+}
+
+void binauraliser_updateHRTFs
+(
+    void* const hBin,
+    const userPars* up,
+    const saf_objects_view* objects
+)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    tftPars* tft = pData->tft;
+    codecPars* pars;
+    int ch;
+    
+    /* render this frame with the previous HRTFs too, for the crossfade */
+    if(pData->prevPars!=NULL){
+        pars = pData->pars;
+        pData->pars = pData->prevPars;
+        binauraliser_updateSourceHRTFs(hBin, up, objects);
+        binauraliser_binauraliseSources(hBin, 0, tft->nSrcList, pData->prevTF_re, pData->prevTF_im);
+        pData->pars = pars;
+        for(ch=0; ch<tft->nSources; ch++)
+            tft->recalc_hrtf_interpFLAG[ch] = 1;
+    }
+    binauraliser_updateSourceHRTFs(hBin, up, objects);
+}
+
+void binauraliser_binauraliseSources
+(
+    void* const hBin,
+    int firstSource,
+    int nGroupSources,
+    float out_re[TIME_SLOTS][NUM_EARS][HYBRID_BANDS],
+    float out_im[TIME_SLOTS][NUM_EARS][HYBRID_BANDS]
+)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    tftPars* tft = pData->tft;
+    codecPars* pars = pData->pars;
+    int i, ch, ear, t, band;
+    float w, itd, phase, mag;
+    const float* x_re, *x_im, *h_re, *h_im;
+    float* y_re, *y_im;
+    float hs_re[NUM_EARS][HYBRID_BANDS], hs_im[NUM_EARS][HYBRID_BANDS];
     
-    if (pData->hSTFT != NULL){
-        afSTFTfree(pData->hSTFT);
-        pData->hSTFT = NULL;
-        for (t = 0; t<TIME_SLOTS; t++) {
-            for (ch = 0; ch< pData->nSources; ch++) {
-                free(pData->STFTInputFrameTF[t][ch].re);
-                free(pData->STFTInputFrameTF[t][ch].im);
+    memset(out_re, 0, TIME_SLOTS*NUM_EARS*HYBRID_BANDS*sizeof(float));
+    memset(out_im, 0, TIME_SLOTS*NUM_EARS*HYBRID_BANDS*sizeof(float));
+    for (i = firstSource; i < firstSource+nGroupSources; i++) {
+        ch = tft->srcList[i];
+        if(tft->hrtf_moving[ch]){
+            /* interpolate the magnitudes and ITD for each time slot, and re-introduce the interaural phase difference */
+            for (t = 0; t < TIME_SLOTS; t++) {
+                w = pData->interpolator[t];
+                itd = (1.0f-w) * tft->prev_hrtf_itd[ch] + w * tft->hrtf_itd[ch];
+                for (band = 0; band < HYBRID_BANDS; band++) {
+                    phase = binauraliser_getIPDphase(pars, band, itd);
+                    mag = (1.0f-w) * tft->prev_hrtf_mag[ch][0][band] + w * tft->hrtf_mag[ch][0][band];
+                    hs_re[0][band] = mag * cosf(phase);
+                    hs_im[0][band] = mag * sinf(phase);
+                    mag = (1.0f-w) * tft->prev_hrtf_mag[ch][1][band] + w * tft->hrtf_mag[ch][1][band];
+                    hs_re[1][band] = mag * cosf(phase);
+                    hs_im[1][band] = -mag * sinf(phase);
+                }
+                x_re = tft->STFTInputFrameTF[t][ch].re;
+                x_im = tft->STFTInputFrameTF[t][ch].im;
+                for (ear = 0; ear < NUM_EARS; ear++) {
+                    h_re = hs_re[ear];
+                    h_im = hs_im[ear];
+                    y_re = out_re[t][ear];
+                    y_im = out_im[t][ear];
+                    for (band = 0; band < HYBRID_BANDS; band++) {
+                        y_re[band] += x_re[band]*h_re[band] - x_im[band]*h_im[band];
+                        y_im[band] += x_re[band]*h_im[band] + x_im[band]*h_re[band];
+                    }
+                }
+            }
+            continue;
+        }
+        for (ear = 0; ear < NUM_EARS; ear++) {
+            h_re = tft->hrtf_re[ch][ear];
+            h_im = tft->hrtf_im[ch][ear];
+            for (t = 0; t < TIME_SLOTS; t++) {
+                x_re = tft->STFTInputFrameTF[t][ch].re;
+                x_im = tft->STFTInputFrameTF[t][ch].im;
+                y_re = out_re[t][ear];
+                y_im = out_im[t][ear];
+                for (band = 0; band < HYBRID_BANDS; band++) {
+                    y_re[band] += x_re[band]*h_re[band] - x_im[band]*h_im[band];
+                    y_im[band] += x_re[band]*h_im[band] + x_im[band]*h_re[band];
+                }
             }
         }
-        free2d((void**)pData->STFTInputFrameTF, TIME_SLOTS);
-        free2d((void**)pData->tempHopFrameTD, MAX(pData->nSources, NUM_EARS));
     }
-    if (pData->hSTFT == NULL){
-        afSTFTinit(&(pData->hSTFT), HOP_SIZE, pData->new_nSources, NUM_EARS, 0, 1);
-        pData->STFTInputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, pData->new_nSources, sizeof(complexVector));
-        for(t=0; t<TIME_SLOTS; t++) {
-            for(ch=0; ch< pData->new_nSources; ch++) {
-                pData->STFTInputFrameTF[t][ch].re = (float*)calloc(HYBRID_BANDS, sizeof(float));
-                pData->STFTInputFrameTF[t][ch].im = (float*)calloc(HYBRID_BANDS, sizeof(float));
+}
+
+void binauraliser_binauraliseBand
+(
+    void* const hBin,
+    int band,
+    const float_complex* inputframeTF,
+    float_complex* outputframeTF,
+    int ld
+)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    tftPars* tft = pData->tft;
+    codecPars* pars = pData->pars;
+    int i, ch, ear, t;
+    float h_re, h_im, w, phase, mag, c, s;
+    const float* x;
+    float* y;
+    
+    /* apply the HRTFs of each active source (which include its gain) */
+    for (ear = 0; ear < NUM_EARS; ear++)
+        memset(&outputframeTF[ear*ld], 0, TIME_SLOTS*sizeof(float_complex));
+    for (i = 0; i < tft->nSrcList; i++) {
+        ch = tft->srcList[i];
+        x = (const float*)&inputframeTF[ch*ld];
+        if(tft->hrtf_moving[ch]){
+            /* interpolate the magnitudes and ITD for each time slot (as in "binauraliser_binauraliseSources") */
+            for (t = 0; t < TIME_SLOTS; t++) {
+                w = pData->interpolator[t];
+                phase = binauraliser_getIPDphase(pars, band, (1.0f-w) * tft->prev_hrtf_itd[ch] + w * tft->hrtf_itd[ch]);
+                c = cosf(phase);
+                s = sinf(phase);
+                for (ear = 0; ear < NUM_EARS; ear++) {
+                    mag = (1.0f-w) * tft->prev_hrtf_mag[ch][ear][band] + w * tft->hrtf_mag[ch][ear][band];
+                    h_re = mag * c;
+                    h_im = ear==0 ? mag * s : -mag * s;
+                    y = (float*)&outputframeTF[ear*ld];
+                    y[2*t]   += x[2*t]*h_re - x[2*t+1]*h_im;
+                    y[2*t+1] += x[2*t]*h_im + x[2*t+1]*h_re;
+                }
+            }
+            continue;
+        }
+        for (ear = 0; ear < NUM_EARS; ear++) {
+            h_re = tft->hrtf_re[ch][ear][band];
+            h_im = tft->hrtf_im[ch][ear][band];
+            y = (float*)&outputframeTF[ear*ld];
+            for (t = 0; t < TIME_SLOTS; t++) {
+                y[2*t]   += x[2*t]*h_re - x[2*t+1]*h_im;
+                y[2*t+1] += x[2*t]*h_im + x[2*t+1]*h_re;
             }
         }
-        pData->tempHopFrameTD = (float**)malloc2d( MAX(pData->new_nSources, NUM_EARS), HOP_SIZE, sizeof(float));
-        pData->nSources = pData->new_nSources;
     }
 }
 
+void binauraliser_synthesis
+(
+    void* const hBin,
+    const float_complex* outputframeTF,
+    int bandStride,
+    int chStride,
+    int applyFadeOut,
+    float** const outputs,
+    int nOutputs
+)
+{
+    binauraliser_data *pData = (binauraliser_data*)(hBin);
+    tftPars* tft = pData->tft;
+    int i, t, ch, band, sample;
+    float fadeIn, fadeOut;
+    float* y_re, *y_im;
+    
+    for (band = 0; band < HYBRID_BANDS && outputframeTF!=NULL; band++) {
+        for (ch = 0; ch < NUM_EARS; ch++) {
+            for (t = 0; t < TIME_SLOTS; t++) {
+                pData->STFTOutputFrameTF[t][ch].re[band] = crealf(outputframeTF[band*bandStride + ch*chStride + t]);
+                pData->STFTOutputFrameTF[t][ch].im[band] = cimagf(outputframeTF[band*bandStride + ch*chStride + t]);
+            }
+        }
+    }
+    
+    /* crossfade from the output of the previous HRTFs over the frame */
+    if(pData->prevPars!=NULL){
+        for (t = 0; t < TIME_SLOTS; t++) {
+            fadeIn = pData->interpolator[t];
+            fadeOut = 1.0f - fadeIn;
+            for (ch = 0; ch < NUM_EARS; ch++) {
+                y_re = pData->STFTOutputFrameTF[t][ch].re;
+                y_im = pData->STFTOutputFrameTF[t][ch].im;
+                for (band = 0; band < HYBRID_BANDS; band++) {
+                    y_re[band] = fadeIn * y_re[band] + fadeOut * pData->prevTF_re[t][ch][band];
+                    y_im[band] = fadeIn * y_im[band] + fadeOut * pData->prevTF_im[t][ch][band];
+                }
+            }
+        }
+    }
+    for (t = 0; t < TIME_SLOTS; t++) {
+        afSTFTinverse(tft->hSTFT, pData->STFTOutputFrameTF[t], tft->tempHopFrameTD);
+        for (ch = 0; ch < MIN(NUM_EARS, nOutputs); ch++)
+            for (sample = 0; sample < HOP_SIZE; sample++)
+                outputs[ch][sample + t* HOP_SIZE] = tft->tempHopFrameTD[ch][sample];
+        for (; ch < nOutputs; ch++)
+            for (sample = 0; sample < HOP_SIZE; sample++)
+                outputs[ch][sample + t* HOP_SIZE] = 0.0f;
+    }
+#ifdef ENABLE_FADE_IN_OUT
+    if(applyFadeOut)
+        for(ch=0; ch < MIN(NUM_EARS, nOutputs);ch++)
+            for(i=0; i<FRAME_SIZE; i++)
+                outputs[ch][i] *= (1.0f - (float)(i+1)/(float)FRAME_SIZE);
+#endif
+}
+
 void binauraliser_loadPreset(PRESETS preset, float dirs_deg[MAX_NUM_INPUTS][2], int* newNCH, int* nDims)
 {
     float sum_elev;
@@ -35,7 +35,6 @@
 #include <math.h>
 #include <string.h>
 #include "binauraliser.h"
-#include "binauraliser_database.h"
 #define SAF_ENABLE_AFSTFT  /* for time-frequency transform */
 #define SAF_ENABLE_HRIR    /* for HRIR->HRTF filterbank coefficients conversion etc. */
 #define SAF_ENABLE_VBAP    /* for amplitude-normalised VBAP gains used for interpolating HRTFs */
@@ -55,86 +54,322 @@ extern "C" {
 #define HYBRID_BANDS ( HOP_SIZE + 5 )                       /* hybrid mode incurs an additional 5 bands  */
 #define TIME_SLOTS ( FRAME_SIZE / HOP_SIZE )                /* 4/8/16 */
 #define MAX_NUM_INPUTS ( 64 )                               /* Maximum permited channels for the VST standard */
+#define MAX_NUM_OBJECTS ( 4096 )                            /* Maximum number of objects (see binauraliser_setMaxNumObjects) */
 #define MAX_NUM_OUTPUTS ( 64 )                              /* Maximum permited channels for the VST standard */
 #define NUM_EARS ( 2 )                                      /* true for most humans */
+#define USER_PARS_AUDIO ( 0 )                               /* parameter block reader index of the audio thread */
+#define USER_PARS_WORKER ( 1 )                              /* parameter block reader index of the worker thread */
+#define OBJECTS_AUDIO ( 0 )                                 /* object store reader index of the audio thread */
+#define MAX_NUM_SOURCE_GROUPS ( 8 )                         /* maximum number of groups the sources are split into, to be binauralised in parallel */
+#define MIN_NUM_SOURCES_PER_GROUP ( 4 )                     /* smaller groups are not worth handing to another thread */
+#define DEFAULT_HRTF_CACHE_SIZE_KB ( 1024 )                 /* default memory budget of the HRTF cache (~320 directions) */
+#define MIN_HRTF_CACHE_RES_DEG ( 1.0f )                     /* finest (non-zero) resolution of the HRTF cache directions */
+#define MAX_HRTF_CACHE_RES_DEG ( 30.0f )                    /* coarsest resolution of the HRTF cache directions */
  
     
 /***********/
 /* Structs */
 /***********/
 
-typedef struct _binauraliser
+/* user parameters; edited by the set functions and passed on to the audio thread via a parameter block */
+typedef struct _userPars
 {
-    /* audio buffers */
-    float inputFrameTD[MAX_NUM_INPUTS][FRAME_SIZE];
-    float outframeTD[NUM_EARS][FRAME_SIZE];
-    float_complex inputframeTF[HYBRID_BANDS][MAX_NUM_INPUTS][TIME_SLOTS];
-    float_complex outputframeTF[HYBRID_BANDS][NUM_EARS][TIME_SLOTS];
-    complexVector** STFTInputFrameTF;
-    complexVector** STFTOutputFrameTF;
-    float** tempHopFrameTD;
-    int fs;
+    int nSources;
+    float src_dirs_deg[MAX_NUM_INPUTS][2];
+    int input_nDims;
+    int interpPerTimeSlot; /* 1: the HRTFs of moving sources are interpolated over the time slots of a frame */
+    float activityHold_ms; /* time a source must be silent for, before it is skipped (see saf_activity.h) */
     
-    /* time-frequency transform */
-    float freqVector[HYBRID_BANDS];
-    float phi_bands[HYBRID_BANDS];
-    void* hSTFT;
+} userPars;
+
+/* interpolated HRTFs of one (quantised) direction, as held by the HRTF cache */
+typedef struct _hrtfCacheEntry
+{
+    int key;                                  /* index of the quantised direction; -1: unused */
+    int older;                                /* entry used before this one; -1: none (least recently used) */
+    int newer;                                /* entry used after this one; -1: none (most recently used) */
+    float h_re[NUM_EARS][HYBRID_BANDS];       /* real parts of the HRTFs */
+    float h_im[NUM_EARS][HYBRID_BANDS];       /* imaginary parts of the HRTFs */
+    float mag[NUM_EARS][HYBRID_BANDS];        /* magnitudes of the HRTFs */
+    float itd;                                /* ITD of the HRTFs, in seconds */
     
+} hrtfCacheEntry;
+
+/* HRTFs, VBAP gain table and HRTF cache; built on the worker thread, then used (and the cache filled) by the audio
+ * thread only */
+typedef struct _codecPars
+{
     /* sofa file info */
-    char* sofa_filepath; 
-    float* hrirs;
-    float* hrir_dirs_deg;
+    hrtfResource* hrtfRes; /* shared HRTF data; the HRIR/HRTF pointers below all reference it (do not free) */
     int N_hrir_dirs;
-    int hrir_len;
-    int hrir_fs;
     
     /* vbap gain table */
     int hrtf_vbapTableRes[2];
-    int N_hrtf_vbap_gtable;
     int* hrtf_vbap_gtableIdx; /* N_hrtf_vbap_gtable x 3 */
     float* hrtf_vbap_gtableComp; /* N_hrtf_vbap_gtable x 3 */
     
     /* hrir filterbank coefficients */
-    int useDefaultHRIRsFLAG; 
     float* itds_s; /* interaural-time differences for each HRIR (in seconds); nBands x 1 */
-    float_complex* hrtf_fb; /* hrtf filterbank coefficients; nBands x nCH x N_hrirs */
     float* hrtf_fb_mag; /* magnitudes of the hrtf filterbank coefficients; nBands x nCH x N_hrirs */
-    float_complex hrtf_interp[MAX_NUM_OUTPUTS][HYBRID_BANDS][NUM_EARS];
+    float phi_bands[HYBRID_BANDS];
+    
+    /* cache of interpolated HRTFs, in least-recently-used order */
+    float hrtfCacheRes; /* resolution of the cached directions, in degrees; 0: that of the VBAP gain table */
+    hrtfCacheEntry* hrtfCache; /* nHRTFCacheEntries x 1 */
+    int nHRTFCacheEntries; /* number of entries the cache can hold */
+    int nHRTFCacheEntriesUsed; /* number of entries filled so far */
+    int* hrtfCacheSlots; /* entry holding each quantised direction; -1: not cached; nHRTFCacheKeys x 1 */
+    int nHRTFCacheKeys; /* number of quantised directions */
+    float hrtfCacheGridRes[2]; /* azimuth and elevation resolution of the quantised directions, in degrees */
+    int hrtfCacheNewest; /* most recently used entry; -1: none */
+    int hrtfCacheOldest; /* least recently used entry; -1: none */
+    
+    struct _codecPars* next; /* next entry in the list of retired codec parameters */
     
-    /* flags */
-    int recalc_hrtf_interpFLAG[MAX_NUM_OUTPUTS];
-    int reInitHRTFsAndGainTables;
-    int reInitTFT;
+} codecPars;
+
+/* time-frequency transform, buffers and state of each source; built on the worker thread for a number of sources,
+ * then used by the audio thread only */
+typedef struct _tftPars
+{
+    int nSources; /* number of sources; in object mode, the maximum number of objects */
+    int objectMode; /* 1: configured for the objects; 0: for the input channels */
+    
+    /* time-frequency transform + buffers */
+    void* hSTFT;
+    complexVector** STFTInputFrameTF;
+    float** tempHopFrameTD;
+    float** inputFrameTD; /* nSources x FRAME_SIZE */
     
-    /* misc. */
+    /* interpolated HRTFs of each source */
+    float (*hrtf_re)[NUM_EARS][HYBRID_BANDS]; /* interpolated HRTFs of each source, scaled by "hrtf_gain"; real parts */
+    float (*hrtf_im)[NUM_EARS][HYBRID_BANDS]; /* imaginary parts */
+    float* hrtf_gain; /* gain folded into "hrtf_re" and "hrtf_im" of each source (1/sqrt(nSources), or the object
+                       * gain); 0: none yet */
+    float (*hrtf_mag)[NUM_EARS][HYBRID_BANDS]; /* magnitudes of "hrtf_re/im" (including "hrtf_gain") */
+    float* hrtf_itd; /* ITDs of "hrtf_re/im", in seconds */
+    float (*prev_hrtf_mag)[NUM_EARS][HYBRID_BANDS]; /* magnitudes of the HRTFs of the previous frame */
+    float* prev_hrtf_itd; /* ITDs of the HRTFs of the previous frame, in seconds */
+    int* hrtf_moving; /* 1: the HRTF magnitudes and ITD are interpolated from "prev_hrtf_mag/itd" to "hrtf_mag/itd"
+                       * over the time slots of this frame; 0: "hrtf_re/im" apply */
+    float (*interp_dirs_deg)[2]; /* source directions that "hrtf_re/im" currently correspond to */
+    int* recalc_hrtf_interpFLAG; /* 1: the HRTFs of the source are to be recalculated */
+    
+    /* source activity */
+    int* sourceActive; /* 0: the source is silent; its TFT, HRTF update and binauralisation are skipped */
+    int* nSilentFrames; /* number of consecutive silent frames of each source */
+    int* sourceGeneration; /* generation of the object each source last held (see saf_objects_view) */
+    int* srcList; /* indices of the active sources of the current frame, in ascending order in channel mode */
+    int nSrcList; /* number of active sources of the current frame */
+    
+    struct _tftPars* next; /* next entry in the list of retired TFTs */
+    
+} tftPars;
+
+typedef struct _binauraliser
+{
+    /* audio buffers */
+    float outputTF_re[MAX_NUM_SOURCE_GROUPS][TIME_SLOTS][NUM_EARS][HYBRID_BANDS]; /* binaural frame of each source group; real parts */
+    float outputTF_im[MAX_NUM_SOURCE_GROUPS][TIME_SLOTS][NUM_EARS][HYBRID_BANDS]; /* imaginary parts */
+    float prevTF_re[TIME_SLOTS][NUM_EARS][HYBRID_BANDS]; /* binaural frame rendered with "prevPars"; real parts */
+    float prevTF_im[TIME_SLOTS][NUM_EARS][HYBRID_BANDS]; /* imaginary parts */
+    complexVector** STFTOutputFrameTF; /* references the binaural frame of source group 0, which ends up holding the sum */
+    int fs;
+    float freqVector[HYBRID_BANDS];
+    
+    /* HRTFs and TFT; the worker thread builds new ones whenever they are to be reinitialised, and publishes them to
+     * the audio thread, which hands the previous ones back to it for freeing */
+    codecPars* pars; /* HRTFs currently used for rendering (audio thread only) */
+    void* volatile pendingPars; /* new HRTFs published by the worker thread (codecPars*) */
+    void* volatile retiredPars; /* HRTFs no longer used by the audio thread, freed by the worker thread (codecPars*) */
+    codecPars* prevPars; /* HRTFs replaced by "pars" at the start of the current frame, kept for that frame in order to
+                          * crossfade from their output; NULL: none (audio thread only) */
+    tftPars* tft; /* TFT and source state currently used for rendering (audio thread only) */
+    void* volatile pendingTFT; /* new TFT published by the worker thread (tftPars*) */
+    void* volatile retiredTFT; /* TFTs no longer used by the audio thread, freed by the worker thread (tftPars*) */
+    int fadedOut; /* 1: the output was faded out (or muted) over the previous frame, so a newly published TFT may be
+                   * picked up (audio thread) */
+    void* hWorker; /* worker thread, which (re)initialises the HRTFs and TFT */
+    
+    /* sofa file info (for the get functions; written by the worker thread) */
+    char* sofa_filepath; 
+    volatile int useDefaultHRIRsFLAG; 
+    hrtfResource* hrtfRes; /* the worker thread's reference to the current HRTF data, which "hrir_dirs_deg" points into */
+    float* hrir_dirs_deg;
+    int N_hrir_dirs;
+    int hrir_len;
+    int hrir_fs;
     int nTriangles;
-    int input_nDims;  
-    int output_nDims;
+    
+    /* HRTF cache settings and counters */
+    volatile float hrtfCacheRes; /* resolution of the cached directions, in degrees; 0: that of the VBAP gain table */
+    volatile int hrtfCacheSize_kB; /* memory budget of the cache, in kilobytes; 0: no cache */
+    hrtfCacheEntry hrtfScratch; /* HRTFs interpolated without a cache (audio thread) */
+    volatile int hrtfCacheHits;
+    volatile int hrtfCacheMisses;
+    
+    /* interpolation weights of the current HRTFs over the time slots of a frame */
+    float interpolator[TIME_SLOTS];
+    volatile int nActiveSources;
+    
+    /* objects (see binauraliser_setMaxNumObjects); the sources are then indexed by object ID */
+    void* hObjects; /* object store; NULL: none */
+    volatile int objectMode; /* 1: the TFT is to be configured for the objects; 0: for the input channels */
+    
+    /* flags; raised by the set functions and cleared by the worker thread, when it starts reinitialising */
+    volatile int reInitHRTFCache;
+    volatile int reInitHRTFsAndGainTables;
+    volatile int reInitTFT;
     
     /* user parameters */
-    int nSources;
-    int new_nSources;
-    float src_dirs_deg[MAX_NUM_INPUTS][2];
+    int nSourceGroups; /* number of groups the sources are split into for the current frame (audio thread) */
+    void* volatile hPool; /* thread pool for binauralising the source groups in parallel (see saf_threads.h); NULL: none */
+    void* hUserPars; /* parameter block of "userPars"; edited by the set functions, read by the audio and worker threads */
+    void* hProf;     /* per-stage timing of the processing loop (see saf_profiler.h) */
     
 } binauraliser_data;
+
+/* a batch of instances, which are processed together (see "binauraliser_processBatch") */
+typedef struct _binauraliser_batch
+{
+    int nInstances;                                           /* number of instances */
+    void** hInstances;                                        /* instance handles; nInstances x 1 */
+    int* applyFadeIn;                                         /* 1: fade in the current frame of an instance; nInstances x 1 */
+    const userPars** up;                                      /* user parameters of each instance for the current frame; NULL: the
+                                                               * instance is not ready, and outputs silence; nInstances x 1 */
+    
+    /* time-frequency buffers; the time slots of all instances are interleaved per band and channel */
+    int nChannels;                                            /* number of source channels the buffers hold (MAX_NUM_INPUTS) */
+    float_complex* inputframeTF;                              /* FLAT: HYBRID_BANDS x nChannels x nInstances x TIME_SLOTS */
+    float_complex* outputframeTF;                             /* FLAT: HYBRID_BANDS x NUM_EARS x nInstances x TIME_SLOTS */
+    
+    /* arguments of the current "binauraliser_processBatch" call, for the thread pool tasks */
+    float*** inputs;
+    float*** outputs;
+    int nInputs;
+    int nOutputs;
+    
+} binauraliser_batch;
      
 
 /**********************/
 /* Internal functions */
 /**********************/
     
+/* Flags part of the state for reinitialisation, which is carried out on the worker thread. Not for the audio thread */
+void binauraliser_requestInit(void* const hBin,                    /* binauraliser handle */
+                              volatile int* flag);                 /* "reInitTFT", "reInitHRTFsAndGainTables" or "reInitHRTFCache" */
+    
+/* Worker thread job: builds fresh HRTFs (along with their cache) and/or a fresh TFT, as flagged, and publishes them to
+ * the audio thread. Also frees any HRTFs and TFTs the audio thread has since retired */
+void binauraliser_codecWorker(void* hBin);                         /* binauraliser handle */
+    
+/* Picks up the HRTFs and TFT newly published by the worker thread, and retires the previous ones. New HRTFs are picked
+ * up straight away, and the previous ones are kept in "prevPars" for the current frame, so that their output is
+ * crossfaded to that of the new ones (see "binauraliser_updateHRTFs"); they are retired by the next call. A new TFT
+ * changes the number of sources, so it is only picked up once the output has been faded out over the previous frame (see
+ * "binauraliser_fadeOutPending"). Returns 1 if the current frame is to be faded in (a new TFT, or the first HRTFs). For
+ * the audio thread */
+int binauraliser_pickUpPars(void* const hBin);                     /* binauraliser handle */
+    
+/* Returns 1 if a newly published TFT is waiting to be picked up, in which case the current frame is to be faded out; 0
+ * otherwise, or if fading is disabled */
+int binauraliser_fadeOutPending(void* const hBin);                 /* binauraliser handle */
+    
+/* Hands HRTFs no longer in use over to the worker thread for freeing; lock-free, for the audio thread */
+void binauraliser_retireCodecPars(void* const hBin,                /* binauraliser handle */
+                                  codecPars* const pars);          /* HRTFs to retire */
+    
+/* Hands a TFT no longer in use over to the worker thread for freeing; lock-free, for the audio thread */
+void binauraliser_retireTFT(void* const hBin,                      /* binauraliser handle */
+                            tftPars* const tft);                   /* TFT to retire */
+    
 /* interpolates between 3 HRTFs via VBAP gains. The HRTF magnitude responses and HRIR ITDs are interpolated seperately
  * before being re-combined */
-void binauraliser_interpHRTFs(void* const hPan,                    /* pannerlib handle (includes VBAP gains, HRTFs and ITDs) */
+void binauraliser_interpHRTFs(codecPars* const pars,               /* HRTFs (includes VBAP gains and ITDs) */
                               float azimuth_deg,                   /* source azimuth in degrees */
                               float elevation_deg,                 /* source elevation in degrees */
-                              float_complex h_intrp[HYBRID_BANDS][NUM_EARS]);
+                              float_complex h_intrp[HYBRID_BANDS][NUM_EARS], /* interpolated HRTFs */
+                              float magInterp[HYBRID_BANDS][NUM_EARS], /* their magnitudes */
+                              float* itdInterp);                   /* & their ITD, in seconds */
     
 /* Initialise the HRTFs: either loading the default set or loading from a SOFA file, Then generate a VBAP gain table. */
-void binauraliser_initHRTFsAndGainTables(void* const hBin);        /* binauraliser handle */
+void binauraliser_initHRTFsAndGainTables(void* const hBin,         /* binauraliser handle */
+                                         codecPars* const pars);   /* HRTFs to initialise */
+    
+/* Allocates an empty HRTF cache for the HRTFs in "pars", for the current resolution and memory budget */
+void binauraliser_initHRTFCache(void* const hBin,                  /* binauraliser handle */
+                                codecPars* const pars);            /* HRTFs to initialise the cache of */
+    
+/* Frees a set of HRTFs (releasing the HRTF data) along with their cache */
+void binauraliser_freeCodecPars(codecPars** const ppars);          /* & address of HRTFs */
+    
+/* Returns the interpolated HRTFs of a direction (unscaled); from the cache if they are held there, otherwise they are
+ * interpolated and cached (replacing the least recently used entry if the cache is full). The returned entry is valid
+ * until the next call */
+const hrtfCacheEntry* binauraliser_getHRTFs(void* const hBin,      /* binauraliser handle */
+                                            float azimuth_deg,     /* source azimuth in degrees */
+                                            float elevation_deg);  /* source elevation in degrees */
+    
+/* Allocates the filterbank used by binauraliser, along with the buffers and state of each source */
+tftPars* binauraliser_createTFT(int new_nSources,                  /* number of sources */
+                                int objectMode);                   /* 1: for the objects; 0: for the input channels */
+    
+/* Frees the filterbank, buffers and source state allocated by binauraliser_createTFT */
+void binauraliser_freeTFT(tftPars** const ptft);                   /* & address of TFT */
+    
+/* Loads a frame of input (applying the fade-in), updates the activity of the sources, lists the active ones in
+ * "srcList" and transforms them into the time-frequency domain, "STFTInputFrameTF" (inactive sources are left as they
+ * are there). Unless "inputframeTF" is NULL, TF sample (band, ch, t) of the active sources is additionally written to
+ * inputframeTF[band*bandStride + ch*chStride + t]. In object mode, only the sources of the current objects are
+ * considered, and input channel "id" holds the signal of object "id" */
+void binauraliser_analysis(void* const hBin,                       /* binauraliser handle */
+                           const userPars* up,                     /* user parameters of this frame */
+                           const saf_objects_view* objects,        /* objects of this frame; NULL: channel mode */
+                           float** const inputs,                   /* input channels; nInputs x FRAME_SIZE (NULL: silent) */
+                           int nInputs,                            /* number of input channels */
+                           int applyFadeIn,                        /* 1: fade in this frame */
+                           float_complex* inputframeTF,            /* time-frequency frame */
+                           int bandStride,                         /* distance between bands in "inputframeTF" */
+                           int chStride);                          /* distance between channels in "inputframeTF" */
+    
+/* Updates the HRTFs of the active sources that have moved since the last frame (see "binauraliser_getHRTFs"), and folds
+ * in their gain: 1/sqrt(nSources) in channel mode, or the object gains in object mode (sources are also updated if
+ * their gain has changed). If "interpPerTimeSlot" is enabled, the updated sources are flagged to be interpolated from
+ * their HRTFs of the previous frame. (Inactive sources are flagged to have their HRTFs recalculated by the analysis).
+ * If new HRTFs have been picked up for this frame, the active sources are first binauralised with the previous ones
+ * into "prevTF_re/im", for the crossfade in "binauraliser_synthesis", and the HRTFs of all sources are then recalculated */
+void binauraliser_updateHRTFs(void* const hBin,                    /* binauraliser handle */
+                              const userPars* up,                  /* user parameters of this frame */
+                              const saf_objects_view* objects);    /* objects of this frame; NULL: channel mode */
+    
+/* Applies the interpolated HRTFs of a group of the active sources to all bands of "STFTInputFrameTF". The bands are
+ * innermost, with the real and imaginary parts stored separately, so that the compiler can vectorise across the bands.
+ * The HRTFs of moving sources are rebuilt for each time slot, from their interpolated magnitudes and ITD */
+void binauraliser_binauraliseSources(void* const hBin,             /* binauraliser handle */
+                                     int firstSource,              /* index into "srcList" of the first source of the group */
+                                     int nGroupSources,            /* number of sources in the group */
+                                     float out_re[TIME_SLOTS][NUM_EARS][HYBRID_BANDS], /* binaural frame; real parts */
+                                     float out_im[TIME_SLOTS][NUM_EARS][HYBRID_BANDS]); /* imaginary parts */
+    
+/* Applies the interpolated HRTFs of all active sources to one band. Source sample (ch, t) is read from
+ * inputframeTF[ch*ld + t], and binaural sample (ear, t) written to outputframeTF[ear*ld + t] */
+void binauraliser_binauraliseBand(void* const hBin,                /* binauraliser handle */
+                                  int band,                        /* band index */
+                                  const float_complex* inputframeTF, /* source signals of this band */
+                                  float_complex* outputframeTF,    /* binaural signals of this band */
+                                  int ld);                         /* distance between channels/ears in both */
     
-/* Initialise the filterbank used by binauraliser */
-void binauraliser_initTFT(void* const hBin);                       /* binauraliser handle */
+/* Transforms a binaural time-frequency frame, with sample (band, ear, t) at outputframeTF[band*bandStride +
+ * ear*chStride + t], back to the time-domain (applying the fade-out). If "outputframeTF" is NULL, the frame is taken
+ * as it is from "STFTOutputFrameTF" */
+void binauraliser_synthesis(void* const hBin,                      /* binauraliser handle */
+                            const float_complex* outputframeTF,    /* time-frequency frame */
+                            int bandStride,                        /* distance between bands in "outputframeTF" */
+                            int chStride,                          /* distance between ears in "outputframeTF" */
+                            int applyFadeOut,                      /* 1: fade out this frame */
+                            float** const outputs,                 /* output channels; nOutputs x FRAME_SIZE */
+                            int nOutputs);                         /* number of output channels */
     
 /* Loads directions from preset */
 void binauraliser_loadPreset(PRESETS preset,                       /* PRESET enum */
@@ -56,6 +56,11 @@ void mceq_process(void* const hMEQ,                 /* mceq handle */
                   int nSamples,                     /* number of samples in 'inputs' and 'outputs' matrices */
                   int isPlaying);                   /* flag; set to 1 if there really is audio */
     
+/* blocks until the worker thread has finished (re)initialising the time-frequency transform, which is then picked up
+ * by the next call to "mceq_process" (e.g. for offline rendering or benchmarking). Must not be called from the audio
+ * thread */
+void mceq_waitForInit(void* const hMEQ);            /* mceq handle */
+    
     
 /*****************/
 /* Set Functions */
@@ -79,6 +84,12 @@ int mceq_getNumChannels(void* const hMEQ);
 int mceq_getNumFilters(void* const hMEQ);
  
 float mceq_getFc(void* const hMEQ, int filterIndex);
+
+/* returns the processing delay in samples, introduced by the time-frequency transform */
+int mceq_getProcessingDelay(void);
+
+/* returns the profiler handle, for "saf_profiler_getStats" (NULL, unless built with SAF_ENABLE_PROFILER) */
+void* mceq_getProfiler(void* const hMEQ);
     
 
 #ifdef __cplusplus
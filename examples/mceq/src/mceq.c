@@ -33,20 +33,24 @@ void mceq_create
     mceq_data* pData = (mceq_data*)malloc(sizeof(mceq_data));
     if (pData == NULL) { return;/*error*/ }
     *phMEQ = (void*)pData;
+    saf_profiler_create(&(pData->hProf));
+    userPars* up;
     
-    /* time-frequency transform + buffers */
-    pData->hSTFT = NULL;
-    pData->STFTInputFrameTF = NULL;
-    pData->STFTOutputFrameTF = NULL;
-    pData->tempHopFrameTD = NULL;
-    
-    /* internal parameters */
-    pData->reInitTFT = 1;
+    /* time-frequency transform + buffers; built on the worker thread (see "mceq_tftWorker") */
+    pData->tft = NULL;
+    pData->pendingTFT = NULL;
+    pData->retiredTFT = NULL;
+    saf_worker_create(&(pData->hWorker), mceq_tftWorker, (void*)pData);
      
     /* user parameters */
-    pData->nFilters = 0;
-    pData->nChannels = 2;
-    pData->new_nChannels = pData->nChannels;
+    saf_paramBlock_create(&(pData->hUserPars), sizeof(userPars), 2);
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->nFilters = 0;
+    up->nChannels = 2;
+    saf_paramBlock_publish(pData->hUserPars);
+    
+    /* build the TFT for the default number of channels */
+    mceq_requestTFTInit(pData);
 }
 
 
@@ -56,32 +60,23 @@ void mceq_destroy
 )
 {
     mceq_data *pData = (mceq_data*)(*phMEQ);
-	int t, ch;
+	tftPars* tft, *next;
 
 	if (pData != NULL) {
-        if(pData->hSTFT !=NULL)
-            afSTFTfree(pData->hSTFT);
-        for (t = 0; t<TIME_SLOTS; t++) {
-            if(pData->STFTInputFrameTF!=NULL){
-                for(ch=0; ch< pData->nChannels; ch++) {
-                    free(pData->STFTInputFrameTF[t][ch].re);
-                    free(pData->STFTInputFrameTF[t][ch].im);
-                }
-            }
-            if(pData->STFTOutputFrameTF!=NULL){
-                for (ch = 0; ch< pData->nChannels; ch++) {
-                    free(pData->STFTOutputFrameTF[t][ch].re);
-                    free(pData->STFTOutputFrameTF[t][ch].im);
-                }
-            }
+        /* stop the worker thread first (waits for it to finish any initialisation in progress) */
+        saf_worker_destroy(&(pData->hWorker));
+        
+        /* TFTs: current, pending and retired */
+        mceq_freeTFT(&(pData->tft));
+        tft = (tftPars*)pData->pendingTFT;
+        mceq_freeTFT(&tft);
+        for(tft = (tftPars*)pData->retiredTFT; tft!=NULL; tft = next){
+            next = tft->next;
+            mceq_freeTFT(&tft);
         }
-        if(pData->STFTInputFrameTF!=NULL)
-            free2d((void**)pData->STFTInputFrameTF, TIME_SLOTS);
-        if(pData->STFTOutputFrameTF!=NULL)
-            free2d((void**)pData->STFTOutputFrameTF, TIME_SLOTS);
-        if(pData->tempHopFrameTD!=NULL)
-            free2d((void**)pData->tempHopFrameTD, pData->nChannels);
+        saf_paramBlock_destroy(&(pData->hUserPars));
      
+        saf_profiler_destroy(&(pData->hProf));
         free(pData);
         pData = NULL;
     }
@@ -121,66 +116,83 @@ void mceq_process
 )
 {
     mceq_data *pData = (mceq_data*)(hMEQ);
-    int t, sample, ch, i, band;
+    const userPars* up;
+    tftPars* tft, *newTFT;
+    int t, sample, ch, i, band, nChannels;
     float mag, arg;
     
-    /* tmp parameters */
+    /* consistent snapshot of the user parameters for this frame */
+    up = (const userPars*)saf_paramBlock_read(pData->hUserPars, USER_PARS_AUDIO);
     
-    /* reinitialise afSTFT if needed */
-    if(pData->reInitTFT){
-        pData->reInitTFT = 2;
-        mceq_initTFT(hMEQ);
-        pData->reInitTFT = 0;
+    /* pick up the afSTFT newly published by the worker thread (see "mceq_tftWorker"), and hand the previous one back
+     * to it for freeing. Until there is one for the current number of channels, the output is silent */
+    newTFT = (tftPars*)saf_atomic_exchangep(&(pData->pendingTFT), NULL);
+    if(newTFT!=NULL){
+        mceq_retireTFT(hMEQ, pData->tft);
+        pData->tft = newTFT;
     }
-    if ((nSamples == FRAME_SIZE) && (isPlaying == 1) && (pData->reInitTFT == 0) ) {
+    tft = pData->tft;
+    
+    if ((nSamples == FRAME_SIZE) && (isPlaying == 1) && (tft!=NULL) && (tft->nChannels == up->nChannels) ) {
+        nChannels = tft->nChannels;
+        SAF_RT_SCOPE_BEGIN;
+        SAF_PROFILE_BEGIN(pData->hProf, "total");
         
         /* Load time-domain data */
-        for(i=0; i < MIN(pData->nChannels,nInputs); i++)
+        for(i=0; i < MIN(nChannels,nInputs); i++)
             memcpy(pData->inputFrameTD[i], inputs[i], FRAME_SIZE * sizeof(float));
-        for(; i<pData->nChannels; i++)
+        for(; i<nChannels; i++)
             memset(pData->inputFrameTD[i], 0, FRAME_SIZE * sizeof(float));
         
         /* Apply time-frequency transform (TFT) */
+        SAF_PROFILE_BEGIN(pData->hProf, "afSTFTforward");
         for ( t=0; t< TIME_SLOTS; t++) {
-            for( ch=0; ch < pData->nChannels; ch++)
+            for( ch=0; ch < nChannels; ch++)
                 for ( sample=0; sample < HOP_SIZE; sample++)
-                    pData->tempHopFrameTD[ch][sample] = pData->inputFrameTD[ch][sample + t*HOP_SIZE];
-            afSTFTforward(pData->hSTFT, (float**)pData->tempHopFrameTD, (complexVector*)pData->STFTInputFrameTF[t]);
+                    tft->tempHopFrameTD[ch][sample] = pData->inputFrameTD[ch][sample + t*HOP_SIZE];
+            afSTFTforward(tft->hSTFT, (float**)tft->tempHopFrameTD, (complexVector*)tft->STFTInputFrameTF[t]);
         }
-        for( ch=0; ch < pData->nChannels; ch++)
+        for( ch=0; ch < nChannels; ch++)
             for ( t=0; t<TIME_SLOTS; t++)
                 for(band=0; band<NUM_BANDS; band++)
-                    pData->inputframeTF[ch][t][band] = cmplxf(pData->STFTInputFrameTF[t][ch].re[band], pData->STFTInputFrameTF[t][ch].im[band]);
+                    pData->inputframeTF[ch][t][band] = cmplxf(tft->STFTInputFrameTF[t][ch].re[band], tft->STFTInputFrameTF[t][ch].im[band]);
+        SAF_PROFILE_END(pData->hProf, "afSTFTforward");
    
         /* apply EQ */
-        for( ch=0; ch < pData->nChannels; ch++){
+        SAF_PROFILE_BEGIN(pData->hProf, "eq");
+        for( ch=0; ch < nChannels; ch++){
             for ( t=0; t<TIME_SLOTS; t++){
                 for(band=0; band<NUM_BANDS; band++){
                     mag = cabsf(pData->inputframeTF[ch][t][band]);
                     arg = atan2f(cimagf(pData->inputframeTF[ch][t][band]), crealf(pData->inputframeTF[ch][t][band])); 
-                    pData->outputframeTF[ch][t][band] = ccmulf(cmplxf(pData->filters[0].FBmag[band] * mag,0.0f), cexpf(cmplxf(0.0f, arg)));
+                    pData->outputframeTF[ch][t][band] = ccmulf(cmplxf(up->filters[0].FBmag[band] * mag,0.0f), cexpf(cmplxf(0.0f, arg)));
                 }
             }
         }
+        SAF_PROFILE_END(pData->hProf, "eq");
         
         /* inverse-TFT */
-        for (ch = 0; ch < pData->nChannels; ch++) {
+        SAF_PROFILE_BEGIN(pData->hProf, "afSTFTinverse");
+        for (ch = 0; ch < nChannels; ch++) {
             for (t = 0; t < TIME_SLOTS; t++) {
                 for (band = 0; band < NUM_BANDS; band++) {
-                    pData->STFTOutputFrameTF[t][ch].re[band] = crealf(pData->outputframeTF[ch][t][band]);
-                    pData->STFTOutputFrameTF[t][ch].im[band] = cimagf(pData->outputframeTF[ch][t][band]);
+                    tft->STFTOutputFrameTF[t][ch].re[band] = crealf(pData->outputframeTF[ch][t][band]);
+                    tft->STFTOutputFrameTF[t][ch].im[band] = cimagf(pData->outputframeTF[ch][t][band]);
                 }
             }
         }
         for (t = 0; t < TIME_SLOTS; t++) {
-            afSTFTinverse(pData->hSTFT, pData->STFTOutputFrameTF[t], pData->tempHopFrameTD);
-            for (ch = 0; ch < MIN(pData->nChannels, nOutputs); ch++)
+            afSTFTinverse(tft->hSTFT, tft->STFTOutputFrameTF[t], tft->tempHopFrameTD);
+            for (ch = 0; ch < MIN(nChannels, nOutputs); ch++)
                 for (sample = 0; sample < HOP_SIZE; sample++)
-                    outputs[ch][sample + t* HOP_SIZE] = pData->tempHopFrameTD[ch][sample];
+                    outputs[ch][sample + t* HOP_SIZE] = tft->tempHopFrameTD[ch][sample];
             for (; ch < nOutputs; ch++)
                 for (sample = 0; sample < HOP_SIZE; sample++)
                     outputs[ch][sample + t* HOP_SIZE] = 0.0f;
         }
+        SAF_PROFILE_END(pData->hProf, "afSTFTinverse");
+        SAF_PROFILE_END(pData->hProf, "total");
+        SAF_RT_SCOPE_END;
     }
     else{
         for (ch=0; ch < nOutputs; ch++)
@@ -188,15 +200,27 @@ void mceq_process
     } 
 }
 
+void mceq_waitForInit(void* const hMEQ)
+{
+    mceq_data *pData = (mceq_data*)(hMEQ);
+    saf_worker_wait(pData->hWorker);
+}
+
 
 /* Set Functions */
 
 void mceq_setNumChannels(void* const hMEQ, int newValue)
 {
     mceq_data *pData = (mceq_data*)(hMEQ);
-    pData->new_nChannels = newValue;
-    if(pData->new_nChannels != pData->nChannels)
-        pData->reInitTFT = 1;
+    userPars* up;
+    int changed;
+    
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    changed = up->nChannels != newValue;
+    up->nChannels = newValue;
+    saf_paramBlock_publish(pData->hUserPars);
+    if(changed) /* (afSTFT is reinitialised on the worker thread) */
+        mceq_requestTFTInit(hMEQ);
 }
 
 void mceq_setNumFilters(void* const hMEQ, int newValue)
@@ -214,16 +238,19 @@ void mceq_setFc(void* const hMEQ, float newValue, int filterIndex)
 void mceq_addFilter(void* const hMEQ)
 {
     mceq_data *pData = (mceq_data*)(hMEQ);
+    userPars* up;
     int fIdx;
     
-    pData->nFilters++; 
-    fIdx = pData->nFilters-1;
-    pData->filters[fIdx].type = FILTER_PEAK;
-    pData->filters[fIdx].fc = 1000.0f;
-    pData->filters[fIdx].Q = 0.7071f;
-    pData->filters[fIdx].G = 0.0f;
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->nFilters++; 
+    fIdx = up->nFilters-1;
+    up->filters[fIdx].type = FILTER_PEAK;
+    up->filters[fIdx].fc = 1000.0f;
+    up->filters[fIdx].Q = 0.7071f;
+    up->filters[fIdx].G = 0.0f;
     
-    mceq_initFilter(&(pData->filters[fIdx]), pData->freqVector_n, pData->disp_freqVector_n, (float)(pData->fs+0.5f));
+    mceq_initFilter(&(up->filters[fIdx]), pData->freqVector_n, pData->disp_freqVector_n, (float)(pData->fs+0.5f));
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 
@@ -232,7 +259,19 @@ void mceq_addFilter(void* const hMEQ)
 int mceq_getNumChannels(void* const hMEQ)
 {
     mceq_data *pData = (mceq_data*)(hMEQ);
-    return pData->nChannels;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->nChannels;
+}
+
+int mceq_getProcessingDelay(void)
+{
+    return afSTFTdelay(HOP_SIZE, 0, 0);
+}
+
+void* mceq_getProfiler(void* const hMEQ)
+{
+    mceq_data *pData = (mceq_data*)(hMEQ);
+    return pData->hProf;
 }
 
 
@@ -25,43 +25,96 @@
 
 #include "mceq_internal.h"
 
-void mceq_initTFT
-(
-    void* const hMEQ
-)
+void mceq_requestTFTInit(void* const hMEQ)
+{
+    mceq_data *pData = (mceq_data*)(hMEQ);
+    
+    saf_atomic_storei(&(pData->reInitTFT), 1);
+    saf_worker_post(pData->hWorker);
+}
+
+void mceq_tftWorker(void* hMEQ)
 {
     mceq_data *pData = (mceq_data*)(hMEQ);
+    const userPars* up;
+    tftPars* tft, *next;
+    
+    /* free the TFTs the audio thread is no longer using */
+    tft = (tftPars*)saf_atomic_exchangep(&(pData->retiredTFT), NULL);
+    for(; tft!=NULL; tft = next){
+        next = tft->next;
+        mceq_freeTFT(&tft);
+    }
+    if(!saf_atomic_exchangei(&(pData->reInitTFT), 0))
+        return;
+    
+    /* build a fresh TFT for the current number of channels (if it is changed in the meantime, the job is posted again
+     * and this one will be superseded) */
+    up = (const userPars*)saf_paramBlock_read(pData->hUserPars, USER_PARS_WORKER);
+    tft = mceq_createTFT(up->nChannels);
+    
+    /* publish it; if the audio thread never picked up the previously published one, it is not needed anymore */
+    tft = (tftPars*)saf_atomic_exchangep(&(pData->pendingTFT), (void*)tft);
+    mceq_freeTFT(&tft);
+}
+
+void mceq_retireTFT(void* const hMEQ, tftPars* const tft)
+{
+    mceq_data *pData = (mceq_data*)(hMEQ);
+    void* head;
+    
+    if(tft==NULL)
+        return;
+    /* lock-free push; the worker thread only ever takes the whole list at once, so there is no ABA problem */
+    do{
+        head = saf_atomic_loadp(&(pData->retiredTFT));
+        tft->next = (tftPars*)head;
+    } while(!saf_atomic_casp(&(pData->retiredTFT), head, (void*)tft));
+}
+
+tftPars* mceq_createTFT(int nChannels)
+{
+    tftPars* tft;
     int t, ch;
     
-    if (pData->hSTFT != NULL){
-        afSTFTfree(pData->hSTFT);
-        pData->hSTFT = NULL;
-        for (t = 0; t<TIME_SLOTS; t++) {
-            for (ch = 0; ch< pData->nChannels; ch++) {
-                free(pData->STFTInputFrameTF[t][ch].re);
-                free(pData->STFTInputFrameTF[t][ch].im);
-                free(pData->STFTOutputFrameTF[t][ch].re);
-                free(pData->STFTOutputFrameTF[t][ch].im);
-            }
+    tft = (tftPars*)malloc(sizeof(tftPars));
+    tft->nChannels = nChannels;
+    tft->next = NULL;
+    afSTFTinit(&(tft->hSTFT), HOP_SIZE, nChannels, nChannels, 0, 0);
+    tft->STFTInputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, nChannels, sizeof(complexVector));
+    tft->STFTOutputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, nChannels, sizeof(complexVector));
+    for(t=0; t<TIME_SLOTS; t++) {
+        for(ch=0; ch< nChannels; ch++) {
+            tft->STFTInputFrameTF[t][ch].re = (float*)calloc(NUM_BANDS, sizeof(float));
+            tft->STFTInputFrameTF[t][ch].im = (float*)calloc(NUM_BANDS, sizeof(float));
+            tft->STFTOutputFrameTF[t][ch].re = (float*)calloc(NUM_BANDS, sizeof(float));
+            tft->STFTOutputFrameTF[t][ch].im = (float*)calloc(NUM_BANDS, sizeof(float));
         }
-        free2d((void**)pData->STFTInputFrameTF, TIME_SLOTS);
-        free2d((void**)pData->STFTOutputFrameTF, TIME_SLOTS);
-        free2d((void**)pData->tempHopFrameTD, pData->nChannels);
     }
-    if (pData->hSTFT == NULL){
-        afSTFTinit(&(pData->hSTFT), HOP_SIZE, pData->new_nChannels, pData->new_nChannels, 0, 0);
-        pData->STFTInputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, pData->new_nChannels, sizeof(complexVector));
-        pData->STFTOutputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, pData->new_nChannels, sizeof(complexVector));
-        for(t=0; t<TIME_SLOTS; t++) {
-            for(ch=0; ch< pData->new_nChannels; ch++) {
-                pData->STFTInputFrameTF[t][ch].re = (float*)calloc(NUM_BANDS, sizeof(float));
-                pData->STFTInputFrameTF[t][ch].im = (float*)calloc(NUM_BANDS, sizeof(float));
-                pData->STFTOutputFrameTF[t][ch].re = (float*)calloc(NUM_BANDS, sizeof(float));
-                pData->STFTOutputFrameTF[t][ch].im = (float*)calloc(NUM_BANDS, sizeof(float));
+    tft->tempHopFrameTD = (float**)malloc2d( nChannels, HOP_SIZE, sizeof(float));
+    return tft;
+}
+
+void mceq_freeTFT(tftPars** const ptft)
+{
+    tftPars* tft = *ptft;
+    int t, ch;
+    
+    if(tft!=NULL){
+        afSTFTfree(tft->hSTFT);
+        for (t = 0; t<TIME_SLOTS; t++) {
+            for (ch = 0; ch< tft->nChannels; ch++) {
+                free(tft->STFTInputFrameTF[t][ch].re);
+                free(tft->STFTInputFrameTF[t][ch].im);
+                free(tft->STFTOutputFrameTF[t][ch].re);
+                free(tft->STFTOutputFrameTF[t][ch].im);
             }
         }
-        pData->tempHopFrameTD = (float**)malloc2d( pData->new_nChannels, HOP_SIZE, sizeof(float));
-        pData->nChannels = pData->new_nChannels;
+        free2d((void**)tft->STFTInputFrameTF, TIME_SLOTS);
+        free2d((void**)tft->STFTOutputFrameTF, TIME_SLOTS);
+        free2d((void**)tft->tempHopFrameTD, tft->nChannels);
+        free(tft);
+        *ptft = NULL;
     }
 }
 
@@ -49,6 +49,8 @@ extern "C" {
 #define TIME_SLOTS ( FRAME_SIZE / HOP_SIZE )                /* >=1 */
 #define MAX_NUM_CHANNELS ( 64 )                             /* Maximum permited channels for the VST standard */
 #define MAX_NUM_FILTERS ( 10 )                              /* number of filters allowed */
+#define USER_PARS_AUDIO ( 0 )                               /* user parameter block reader index of the audio thread */
+#define USER_PARS_WORKER ( 1 )                              /* user parameter block reader index of the worker thread */
 
 typedef enum _FILTER_TYPES
 {
@@ -76,6 +78,27 @@ typedef struct _filter
     
 }filter;
 
+/* user parameters (see saf_paramBlock) */
+typedef struct _userPars
+{
+    filter filters[MAX_NUM_FILTERS];
+    int nChannels;
+    int nFilters;
+    
+}userPars;
+
+/* time-frequency transform for nChannels; built by the worker thread, used by the audio thread */
+typedef struct _tftPars
+{
+    int nChannels;
+    void* hSTFT;
+    complexVector** STFTInputFrameTF;
+    complexVector** STFTOutputFrameTF;
+    float** tempHopFrameTD;
+    struct _tftPars* next;           /* next entry in the list of retired TFTs */
+    
+}tftPars;
+
 typedef struct _mceq
 {
     /* audio buffers */
@@ -83,26 +106,25 @@ typedef struct _mceq
     float outframeTD[MAX_NUM_CHANNELS][FRAME_SIZE];
     float_complex inputframeTF[MAX_NUM_CHANNELS][TIME_SLOTS][NUM_BANDS];
     float_complex outputframeTF[MAX_NUM_CHANNELS][TIME_SLOTS][NUM_BANDS];
-    complexVector** STFTInputFrameTF;
-    complexVector** STFTOutputFrameTF;
-    float** tempHopFrameTD;
     int fs;
     
-    /* time-frequency transform */
-    void* hSTFT;
+    /* time-frequency transform; the worker thread builds a new one whenever the number of channels changes, and
+     * publishes it to the audio thread, which hands the previous one back for freeing */
+    tftPars* tft;                    /* TFT currently used for processing (audio thread only) */
+    void* volatile pendingTFT;       /* new TFT published by the worker thread (tftPars*) */
+    void* volatile retiredTFT;       /* TFTs no longer used by the audio thread, freed by the worker thread (tftPars*) */
+    void* hWorker;                   /* worker thread, which (re)initialises the TFT */
     
     /* internal parameters */ 
     float freqVector[NUM_BANDS];     /* frequency vector for processing */
     float freqVector_n[NUM_BANDS];   /* normalised frequency vector for processing */
     float disp_freqVector[NUM_DISPLAY_FREQS];
     float disp_freqVector_n[NUM_DISPLAY_FREQS];
-    int reInitTFT; 
-    int new_nChannels;
+    volatile int reInitTFT;          /* 0: no init required, 1: init required (on the worker thread) */
     
     /* user parameters */
-    filter filters[MAX_NUM_FILTERS];
-    int nChannels;
-    int nFilters;
+    void* hUserPars;                 /* parameter block of "userPars"; edited by the set functions, read by the audio and worker threads */
+    void* hProf;                     /* per-stage timing of the processing loop (see saf_profiler.h) */
     
 } mceq_data;
      
@@ -111,8 +133,22 @@ typedef struct _mceq
    Internal functions
  **********************/
     
-/* Initialise the filterbank used by mceq */
-void mceq_initTFT(void* const hMEQ);                       /* mceq handle */
+/* Flags the TFT for reinitialisation, which is carried out on the worker thread. Not for the audio thread */
+void mceq_requestTFTInit(void* const hMEQ);                /* mceq handle */
+    
+/* Worker thread job: builds a fresh TFT for the current number of channels and publishes it to the audio thread. Also
+ * frees any TFTs the audio thread has since retired */
+void mceq_tftWorker(void* hMEQ);                           /* mceq handle */
+    
+/* Hands a TFT no longer in use over to the worker thread for freeing; lock-free, for the audio thread */
+void mceq_retireTFT(void* const hMEQ,                      /* mceq handle */
+                    tftPars* const tft);                   /* TFT to retire (may be NULL) */
+    
+/* Creates the filterbank used by mceq (and its buffers), for nChannels */
+tftPars* mceq_createTFT(int nChannels);                    /* number of channels */
+    
+/* Frees a TFT created by "mceq_createTFT" */
+void mceq_freeTFT(tftPars** const ptft);                   /* & address of TFT */
     
 /*  */
 void mceq_initFilter(filter* f,/* filter struct, with .type, .fc, .Q, and .G pre-defined */
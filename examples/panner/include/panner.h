@@ -158,6 +158,64 @@ void panner_process(void* const hPan,                    /* panner handle */
                     int nOutputs,                        /* number of channels in 'outputs' matrix */
                     int nSamples,                        /* number of samples in 'inputs' and 'outputs' matrices */
                     int isPlaying);                      /* flag; set to 1 if there really is audio */
+
+/* blocks until the worker thread has finished (re)initialising the gain table and the time-frequency transform, which
+ * are then picked up by the next call to "panner_process" (e.g. for offline rendering or benchmarking). Must not be
+ * called from the audio thread */
+void panner_waitForCodecInit(void* const hPan);          /* panner handle */
+    
+    
+/********************/
+/* Object Functions */
+/********************/
+    
+/* Objects are sources with a dynamic lifetime, identified by an ID (0..maxNumObjects-1), each with its own direction
+ * and gain; they are panned by "panner_processObjects" instead of "panner_process". The objects and the state of each
+ * are allocated once, for the maximum number of objects, so that objects may be added, removed and updated from
+ * another thread without any (re)allocation on the audio thread; changes take effect once committed. The cost of a
+ * frame scales with the number of objects that are not silent (see panner_setActivityHoldTime) */
+    
+/* (re)allocates the objects, without any; must not be called whilst processing (as panner_init). The state of each
+ * object is then built on the worker thread (see panner_waitForCodecInit) */
+void panner_setMaxNumObjects(void* const hPan,                    /* panner handle */
+                             int maxNumObjects);                  /* maximum number of objects (1..4096) */
+    
+/* adds an object; returns 0 on success, or -1 if the ID is out of range or already in use */
+int panner_addObject(void* const hPan,                            /* panner handle */
+                     int id,                                      /* object ID; 0..maxNumObjects-1 */
+                     float azi_deg,                               /* azimuth in degrees */
+                     float elev_deg,                              /* elevation in degrees */
+                     float gain);                                 /* linear gain */
+    
+/* removes an object; returns 0 on success, or -1 if the ID is not in use */
+int panner_removeObject(void* const hPan,                         /* panner handle */
+                        int id);                                  /* object ID */
+    
+/* changes the direction and gain of an object; returns 0 on success, or -1 if the ID is not in use */
+int panner_updateObject(void* const hPan,                         /* panner handle */
+                        int id,                                   /* object ID */
+                        float azi_deg,                            /* azimuth in degrees */
+                        float elev_deg,                           /* elevation in degrees */
+                        float gain);                              /* linear gain */
+    
+/* passes all object changes since the last call on to the audio thread, which picks them up at its next frame */
+void panner_commitObjects(void* const hPan);                      /* panner handle */
+    
+/* returns the maximum number of objects; 0 if panner_setMaxNumObjects has not been called */
+int panner_getMaxNumObjects(void* const hPan);                    /* panner handle */
+    
+/* returns the number of objects, including changes that have not been committed yet */
+int panner_getNumObjects(void* const hPan);                       /* panner handle */
+    
+/* pans the objects; channel "id" of 'objectInputs' holds the signal of object "id" (channels of IDs that are not in
+ * use are ignored, and may be NULL, as may those of objects that are silent) */
+void panner_processObjects(void* const hPan,                      /* panner handle */
+                           float** const objectInputs,            /* object signals [nObjectInputs][FRAME_SIZE] */
+                           float** const outputs,                 /* loudspeaker signals [nOutputs][FRAME_SIZE] */
+                           int nObjectInputs,                     /* number of channels in 'objectInputs' matrix */
+                           int nOutputs,                          /* number of channels in 'outputs' matrix */
+                           int nSamples,                          /* number of samples in 'objectInputs' and 'outputs' */
+                           int isPlaying);                        /* flag; set to 1 if there really is audio */
     
     
 /*****************/
@@ -182,6 +240,12 @@ void panner_setInputConfigPreset(void* const hPan, int newPresetID);
     
 void panner_setDTT(void* const hPan, float newValue);
     
+/* sets how long a source must be silent (below -120 dBFS) before its time-frequency transform and panning are skipped;
+ * it is processed again as soon as it is not silent. The hold time is extended to at least the memory of the
+ * filterbank, so that the tail of the source has decayed before it is skipped */
+void panner_setActivityHoldTime(void* const hPan,                 /* panner handle */
+                                float newHold_ms);                /* hold time in milliseconds (default 100) */
+    
 
 /*****************/
 /* Get Functions */
@@ -207,6 +271,17 @@ int panner_getDAWsamplerate(void* const hPan);
     
 float panner_getDTT(void* const hPan);
     
+float panner_getActivityHoldTime(void* const hPan);
+    
+/* returns the number of sources that were processed (not skipped as silent) in the last frame */
+int panner_getNumActiveSources(void* const hPan);
+
+/* returns the processing delay in samples, introduced by the time-frequency transform */
+int panner_getProcessingDelay(void);
+
+/* returns the profiler handle, for "saf_profiler_getStats" (NULL, unless built with SAF_ENABLE_PROFILER) */
+void* panner_getProfiler(void* const hPan);
+    
 
 #ifdef __cplusplus
 }
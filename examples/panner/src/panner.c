@@ -40,26 +40,45 @@ void panner_create
 )
 {
     panner_data* pData = (panner_data*)malloc(sizeof(panner_data));
+    userPars* up;
+    int nDims;
+    
     if (pData == NULL) { return;/*error*/ }
     *phPan = (void*)pData;
+    saf_profiler_create(&(pData->hProf));
+    
+    /* gain table and TFT; built on the worker thread */
+    pData->pars = NULL;
+    pData->pendingPars = NULL;
+    pData->retiredPars = NULL;
+    pData->tft = NULL;
+    pData->pendingTFT = NULL;
+    pData->retiredTFT = NULL;
+    
+    /* source state (allocated along with the TFT) */
+    pData->nActiveSources = 0;
     
-    /* time-frequency transform + buffers */
-    pData->hSTFT = NULL;
-    pData->STFTInputFrameTF = NULL;
-    pData->STFTOutputFrameTF = NULL;
-    pData->tempHopFrameTD = NULL;
+    /* objects */
+    pData->hObjects = NULL;
+    pData->objectMode = 0;
     
-    /* flags and gain table */
+    /* flags */
     pData->reInitGainTables = 1;
-    pData->vbap_gtable = NULL;
     pData->reInitTFT = 1;
     
     /* user parameters */
-    panner_loadPreset(PRESET_DEFAULT, pData->src_dirs_deg, &(pData->new_nSources), &(pData->input_nDims)); /*check setStateInformation if you change default preset*/
-    pData->nSources = pData->new_nSources;
-    pData->DTT = 0.5f;
-    panner_loadPreset(PRESET_5PX, pData->loudpkrs_dirs_deg, &(pData->new_nLoudpkrs), &(pData->output_nDims)); /*check setStateInformation if you change default preset*/
-    pData->nLoudpkrs = pData->new_nLoudpkrs;
+    saf_paramBlock_create(&(pData->hUserPars), sizeof(userPars), 2);
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    panner_loadPreset(PRESET_DEFAULT, up->src_dirs_deg, &(up->nSources), &(up->input_nDims)); /*check setStateInformation if you change default preset*/
+    up->DTT = 0.5f;
+    up->activityHold_ms = SAF_ACTIVITY_DEFAULT_HOLD_MS;
+    panner_loadPreset(PRESET_5PX, up->loudpkrs_dirs_deg, &(up->nLoudpkrs), &nDims); /*check setStateInformation if you change default preset*/
+    saf_paramBlock_publish(pData->hUserPars);
+    pData->DTT = -1.0f;
+    
+    /* build the gain table and TFT for the defaults */
+    saf_worker_create(&(pData->hWorker), panner_codecWorker, (void*)pData);
+    saf_worker_post(pData->hWorker);
 }
 
 
@@ -69,35 +88,31 @@ void panner_destroy
 )
 {
     panner_data *pData = (panner_data*)(*phPan);
-    int t, ch;
+    codecPars* pars, *nextPars;
+    tftPars* tft, *nextTFT;
 
     if (pData != NULL) {
-        if(pData->hSTFT !=NULL)
-            afSTFTfree(pData->hSTFT);
-        for (t = 0; t<TIME_SLOTS; t++) {
-            if(pData->STFTInputFrameTF!=NULL){
-                for(ch=0; ch< pData->nSources; ch++) {
-                    free(pData->STFTInputFrameTF[t][ch].re);
-                    free(pData->STFTInputFrameTF[t][ch].im);
-                }
-            }
-            if(pData->STFTOutputFrameTF!=NULL){
-                for (ch = 0; ch< pData->new_nLoudpkrs; ch++) {
-                    free(pData->STFTOutputFrameTF[t][ch].re);
-                    free(pData->STFTOutputFrameTF[t][ch].im);
-                }
-            }
+        /* stop the worker thread first (waits for it to finish any initialisation in progress) */
+        saf_worker_destroy(&(pData->hWorker));
+        
+        panner_freeCodecPars(&(pData->pars));
+        pars = (codecPars*)pData->pendingPars;
+        panner_freeCodecPars(&pars);
+        for(pars = (codecPars*)pData->retiredPars; pars!=NULL; pars = nextPars){
+            nextPars = pars->next;
+            panner_freeCodecPars(&pars);
+        }
+        panner_freeTFT(&(pData->tft));
+        tft = (tftPars*)pData->pendingTFT;
+        panner_freeTFT(&tft);
+        for(tft = (tftPars*)pData->retiredTFT; tft!=NULL; tft = nextTFT){
+            nextTFT = tft->next;
+            panner_freeTFT(&tft);
         }
-        if(pData->STFTInputFrameTF!=NULL)
-            free2d((void**)pData->STFTInputFrameTF, TIME_SLOTS);
-        if(pData->STFTOutputFrameTF!=NULL)
-            free2d((void**)pData->STFTOutputFrameTF, TIME_SLOTS);
-        if(pData->tempHopFrameTD!=NULL)
-            free2d((void**)pData->tempHopFrameTD, MAX(pData->nSources, pData->new_nLoudpkrs));
-    
-        if(pData->vbap_gtable!= NULL)
-            free(pData->vbap_gtable);
+        saf_objects_destroy(&(pData->hObjects));
+        saf_paramBlock_destroy(&(pData->hUserPars));
          
+        saf_profiler_destroy(&(pData->hProf));
         free(pData);
         pData = NULL;
     }
@@ -121,142 +136,349 @@ void panner_init
             pData->freqVector[band] =  (float)__afCenterFreq48e3[band];
     }
     
-    /* calculate pValue per frequency */
-    panner_getPvalue(pData->DTT, pData->freqVector, pData->pValue);
+    /* pValue per frequency (recalculated on the audio thread, see panner_updatePvalue) */
+    pData->DTT = -1.0f;
 }
 
-void panner_process
+void panner_setActivityHoldTime(void* const hPan, float newHold_ms)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    userPars* up;
+    
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->activityHold_ms = MAX(newHold_ms, 0.0f);
+    saf_paramBlock_publish(pData->hUserPars);
+}
+
+/* recalculates the pValues, if the DTT has changed */
+static void panner_updatePvalue
 (
-    void  *  const hPan,
+    void* const hPan,
+    const userPars* up
+)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    
+    if(pData->DTT != up->DTT){
+        panner_getPvalue(up->DTT, pData->freqVector, pData->pValue);
+        pData->DTT = up->DTT;
+    }
+}
+
+/* pans one frame of the sources (channel mode) or objects, once any reinitialisation has been done */
+static void panner_processFrame
+(
+    void* const hPan,
+    const userPars* up,
+    const saf_objects_view* objects,
     float ** const inputs,
     float ** const outputs,
-    int            nInputs,
-    int            nOutputs,
-    int            nSamples,
-    int            isPlaying
+    int nInputs,
+    int nOutputs
 )
 {
     panner_data *pData = (panner_data*)(hPan);
-    int t, sample, ch, ls, i, band, nSources, nLoudspeakers, N_azi, aziIndex, elevIndex, idx3d, idx2D;
+    tftPars* tft = pData->tft;
+    codecPars* pars = pData->pars;
+    int t, sample, ch, ls, j, band, nCandidates, nLoudspeakers, N_azi, aziIndex, elevIndex, idx3d, idx2D, wasActive, holdFrames, nOutputsTF;
     float aziRes, elevRes, pv_f, gains3D_sum_pvf, gains2D_sum_pvf;
-    float src_dirs[MAX_NUM_INPUTS][2], pValue[HYBRID_BANDS], gains3D[MAX_NUM_OUTPUTS], gains2D[MAX_NUM_OUTPUTS], gains_band[MAX_NUM_OUTPUTS];
+    float pValue[HYBRID_BANDS], gains3D[MAX_NUM_OUTPUTS], gains2D[MAX_NUM_OUTPUTS], gains_band[MAX_NUM_OUTPUTS];
+    const float* src_dir;
     
-    /* reinitialise if needed */
-    if(pData->reInitTFT){
-        panner_initTFT(hPan);
-        pData->reInitTFT = 0;
-    }
-    if(pData->reInitGainTables){
-        panner_initGainTables(hPan);
-        pData->reInitGainTables = 0;
-    }
-    /* apply panner */
-    if ((nSamples == FRAME_SIZE) && (isPlaying == 1) && (pData->vbap_gtable != NULL)) {
-        memcpy(src_dirs, pData->src_dirs_deg, MAX_NUM_INPUTS*2*sizeof(float));
-        memcpy(pValue, pData->pValue, HYBRID_BANDS*sizeof(float));
-        nSources = pData->nSources;
-        nLoudspeakers = pData->nLoudpkrs;
+    SAF_RT_SCOPE_BEGIN;
+    SAF_PROFILE_BEGIN(pData->hProf, "total");
+    memcpy(pValue, pData->pValue, HYBRID_BANDS*sizeof(float));
+    nLoudspeakers = pars->nLoudpkrs;
+    
+    /* in object mode, only the sources of the current objects are considered; the others are neither loaded nor
+     * transformed, so that the cost of a frame scales with the number of (active) objects */
+    nCandidates = objects==NULL ? tft->nSources : objects->nObjects;
+    
+    /* sources are skipped once they have been silent for longer than the hold time, and the memory of the TFT */
+    holdFrames = saf_activity_getHoldFrames(up->activityHold_ms, (float)pData->fs, FRAME_SIZE, afSTFTtail(HOP_SIZE, 1));
+    tft->nSrcList = 0;
+    for(j=0; j<nCandidates; j++){
+        ch = objects==NULL ? j : objects->ids[j];
+        if(objects!=NULL && objects->generations[ch] != tft->sourceGeneration[ch]){
+            /* the object has been (re)added since the last frame; it starts afresh */
+            tft->sourceGeneration[ch] = objects->generations[ch];
+            tft->sourceActive[ch] = 0;
+            tft->nSilentFrames[ch] = 0;
+        }
         
         /* Load time-domain data */
-        for(i=0; i < MIN(nSources,nInputs); i++)
-            memcpy(pData->inputFrameTD[i], inputs[i], FRAME_SIZE * sizeof(float));
-        for(; i<MAX_NUM_INPUTS; i++)
-            memset(pData->inputFrameTD[i], 0, FRAME_SIZE * sizeof(float));
+        if(ch < nInputs && inputs[ch]!=NULL)
+            memcpy(tft->inputFrameTD[ch], inputs[ch], FRAME_SIZE * sizeof(float));
+        else
+            memset(tft->inputFrameTD[ch], 0, FRAME_SIZE * sizeof(float));
         
-        /* Apply time-frequency transform (TFT) */
-        for ( t=0; t< TIME_SLOTS; t++) {
-            for( ch=0; ch < nSources; ch++)
-                for ( sample=0; sample < HOP_SIZE; sample++)
-                    pData->tempHopFrameTD[ch][sample] = pData->inputFrameTD[ch][sample + t*HOP_SIZE];
-            afSTFTforward(pData->hSTFT, (float**)pData->tempHopFrameTD, (complexVector*)pData->STFTInputFrameTF[t]);
+        wasActive = tft->sourceActive[ch];
+        tft->sourceActive[ch] = saf_activity_update(tft->inputFrameTD[ch], FRAME_SIZE, holdFrames, &(tft->nSilentFrames[ch]));
+        if(!tft->sourceActive[ch])
+            continue;
+        if(!wasActive)
+            afSTFTclearChannel(tft->hSTFT, ch);
+        tft->srcList[tft->nSrcList++] = ch;
+    }
+    saf_atomic_storei(&(pData->nActiveSources), tft->nSrcList);
+    
+    /* Apply time-frequency transform (TFT) */
+    SAF_PROFILE_BEGIN(pData->hProf, "afSTFTforward");
+    for ( t=0; t< TIME_SLOTS; t++) {
+        for( j=0; j < tft->nSrcList; j++){
+            ch = tft->srcList[j];
+            for ( sample=0; sample < HOP_SIZE; sample++)
+                tft->tempHopFrameTD[ch][sample] = tft->inputFrameTD[ch][sample + t*HOP_SIZE];
         }
-        for(band=0; band<HYBRID_BANDS; band++)
-            for( ch=0; ch < nSources; ch++)
-                for ( t=0; t<TIME_SLOTS; t++)
-                    pData->inputframeTF[band][ch][t] = cmplxf(pData->STFTInputFrameTF[t][ch].re[band], pData->STFTInputFrameTF[t][ch].im[band]);
-        memset(pData->outputframeTF, 0, HYBRID_BANDS*MAX_NUM_OUTPUTS*TIME_SLOTS * sizeof(float_complex));
-        
-        /* Apply VBAP Panning */
-        if(pData->output_nDims == 3){/* 3-D case */
-            aziRes = (float)pData->vbapTableRes[0];
-            elevRes = (float)pData->vbapTableRes[1];
-            N_azi = (int)(360.0f / aziRes + 0.5f) + 1;
-            for (ch = 0; ch < nSources; ch++) {
-                aziIndex = (int)(matlab_fmodf(pData->src_dirs_deg[ch][0] + 180.0f, 360.0f) / aziRes + 0.5f);
-                elevIndex = (int)((pData->src_dirs_deg[ch][1] + 90.0f) / elevRes + 0.5f);
-                idx3d = elevIndex * N_azi + aziIndex;
-                for (ls = 0; ls < nLoudspeakers; ls++)
-                    gains3D[ls] =  pData->vbap_gtable[idx3d*nLoudspeakers+ls];
-                for (band = 0; band < HYBRID_BANDS; band++){
-                    /* apply pValue per frequency */
-                    pv_f = pData->pValue[band];
-                    if(pv_f != 2.0f){
-                        gains3D_sum_pvf = 0.0f;
-                        for (ls = 0; ls < nLoudspeakers; ls++)
-                            gains3D_sum_pvf += powf(MAX(gains3D[ls], 0.0f), pv_f);
-                        gains3D_sum_pvf = powf(gains3D_sum_pvf, 1.0f/(pv_f+2.23e-13f));
-                        for (ls = 0; ls < nLoudspeakers; ls++)
-                            gains_band[ls] = gains3D[ls] / (gains3D_sum_pvf+2.23e-13f);
-                    }
-                    else
-                        memcpy(gains_band, gains3D, nLoudspeakers*sizeof(float));
+        afSTFTforwardChannels(tft->hSTFT, (float**)tft->tempHopFrameTD, (complexVector*)tft->STFTInputFrameTF[t],
+                              tft->srcList, tft->nSrcList);
+    }
+    memset(pData->outputframeTF, 0, HYBRID_BANDS*MAX_NUM_OUTPUTS*TIME_SLOTS * sizeof(float_complex));
+    SAF_PROFILE_END(pData->hProf, "afSTFTforward");
+    
+    /* Apply VBAP Panning (the gain of each object is applied along with its VBAP gains) */
+    SAF_PROFILE_BEGIN(pData->hProf, "vbap");
+    if(pars->output_nDims == 3){/* 3-D case */
+        aziRes = (float)pars->vbapTableRes[0];
+        elevRes = (float)pars->vbapTableRes[1];
+        N_azi = (int)(360.0f / aziRes + 0.5f) + 1;
+        for (j = 0; j < tft->nSrcList; j++) {
+            ch = tft->srcList[j];
+            src_dir = objects==NULL ? up->src_dirs_deg[ch] : objects->dirs_deg[ch];
+            aziIndex = (int)(matlab_fmodf(src_dir[0] + 180.0f, 360.0f) / aziRes + 0.5f);
+            elevIndex = (int)((src_dir[1] + 90.0f) / elevRes + 0.5f);
+            idx3d = elevIndex * N_azi + aziIndex;
+            for (ls = 0; ls < nLoudspeakers; ls++)
+                gains3D[ls] =  pars->vbap_gtable[idx3d*nLoudspeakers+ls];
+            for (band = 0; band < HYBRID_BANDS; band++){
+                /* apply pValue per frequency */
+                pv_f = pData->pValue[band];
+                if(pv_f != 2.0f){
+                    gains3D_sum_pvf = 0.0f;
+                    for (ls = 0; ls < nLoudspeakers; ls++)
+                        gains3D_sum_pvf += powf(MAX(gains3D[ls], 0.0f), pv_f);
+                    gains3D_sum_pvf = powf(gains3D_sum_pvf, 1.0f/(pv_f+2.23e-13f));
                     for (ls = 0; ls < nLoudspeakers; ls++)
-                        for (t = 0; t < TIME_SLOTS; t++)
-                            pData->outputframeTF[band][ls][t] = ccaddf(pData->outputframeTF[band][ls][t], crmulf(pData->inputframeTF[band][ch][t], gains_band[ls]));
+                        gains_band[ls] = gains3D[ls] / (gains3D_sum_pvf+2.23e-13f);
                 }
+                else
+                    memcpy(gains_band, gains3D, nLoudspeakers*sizeof(float));
+                if(objects!=NULL)
+                    for (ls = 0; ls < nLoudspeakers; ls++)
+                        gains_band[ls] *= objects->gains[ch];
+                for (ls = 0; ls < nLoudspeakers; ls++)
+                    for (t = 0; t < TIME_SLOTS; t++)
+                        pData->outputframeTF[band][ls][t] = ccaddf(pData->outputframeTF[band][ls][t],
+                            crmulf(cmplxf(tft->STFTInputFrameTF[t][ch].re[band], tft->STFTInputFrameTF[t][ch].im[band]), gains_band[ls]));
             }
         }
-        else{/* 2-D case */
-            aziRes = (float)pData->vbapTableRes[0];
-            for (ch = 0; ch < nSources; ch++) {
-                idx2D = (int)((matlab_fmodf(pData->src_dirs_deg[ch][0]+180.0f,360.0f)/aziRes)+0.5f);
-                for (ls = 0; ls < nLoudspeakers; ls++)
-                    gains2D[ls] = pData->vbap_gtable[idx2D*nLoudspeakers+ls]; 
-                for (band = 0; band < HYBRID_BANDS; band++){
-                    /* apply pValue per frequency */
-                    pv_f = pData->pValue[band];
-                    if(pv_f != 2.0f){
-                        gains2D_sum_pvf = 0.0f;
-                        for (ls = 0; ls < nLoudspeakers; ls++)
-                            gains2D_sum_pvf += powf(MAX(gains2D[ls], 0.0f), pv_f);
-                        gains2D_sum_pvf = powf(gains2D_sum_pvf, 1.0f/(pv_f+2.23e-13f));
-                        for (ls = 0; ls < nLoudspeakers; ls++)
-                            gains_band[ls] = gains2D[ls] / (gains2D_sum_pvf+2.23e-13f);
-                    }
-                    else
-                        memcpy(gains_band, gains2D, nLoudspeakers*sizeof(float));
+    }
+    else{/* 2-D case */
+        aziRes = (float)pars->vbapTableRes[0];
+        for (j = 0; j < tft->nSrcList; j++) {
+            ch = tft->srcList[j];
+            src_dir = objects==NULL ? up->src_dirs_deg[ch] : objects->dirs_deg[ch];
+            idx2D = (int)((matlab_fmodf(src_dir[0]+180.0f,360.0f)/aziRes)+0.5f);
+            for (ls = 0; ls < nLoudspeakers; ls++)
+                gains2D[ls] = pars->vbap_gtable[idx2D*nLoudspeakers+ls]; 
+            for (band = 0; band < HYBRID_BANDS; band++){
+                /* apply pValue per frequency */
+                pv_f = pData->pValue[band];
+                if(pv_f != 2.0f){
+                    gains2D_sum_pvf = 0.0f;
                     for (ls = 0; ls < nLoudspeakers; ls++)
-                        for (t = 0; t < TIME_SLOTS; t++)
-                            pData->outputframeTF[band][ls][t] = ccaddf(pData->outputframeTF[band][ls][t], crmulf(pData->inputframeTF[band][ch][t], gains_band[ls]));
+                        gains2D_sum_pvf += powf(MAX(gains2D[ls], 0.0f), pv_f);
+                    gains2D_sum_pvf = powf(gains2D_sum_pvf, 1.0f/(pv_f+2.23e-13f));
+                    for (ls = 0; ls < nLoudspeakers; ls++)
+                        gains_band[ls] = gains2D[ls] / (gains2D_sum_pvf+2.23e-13f);
                 }
+                else
+                    memcpy(gains_band, gains2D, nLoudspeakers*sizeof(float));
+                if(objects!=NULL)
+                    for (ls = 0; ls < nLoudspeakers; ls++)
+                        gains_band[ls] *= objects->gains[ch];
+                for (ls = 0; ls < nLoudspeakers; ls++)
+                    for (t = 0; t < TIME_SLOTS; t++)
+                        pData->outputframeTF[band][ls][t] = ccaddf(pData->outputframeTF[band][ls][t],
+                            crmulf(cmplxf(tft->STFTInputFrameTF[t][ch].re[band], tft->STFTInputFrameTF[t][ch].im[band]), gains_band[ls]));
             }
-        }
-        
-        /* scale by number of sources */
+        }
+    }
+    
+    /* scale by number of sources (objects carry their own gains) */
+    if(objects==NULL)
         for (band = 0; band < HYBRID_BANDS; band++)
             for (ls = 0; ls < nLoudspeakers; ls++)
                 for (t = 0; t < TIME_SLOTS; t++)
-                    pData->outputframeTF[band][ls][t] = crmulf(pData->outputframeTF[band][ls][t], 1.0f/sqrtf((float)nSources));
-        
-        /* inverse-TFT */
-        for (band = 0; band < HYBRID_BANDS; band++) {
-            for (ch = 0; ch < nLoudspeakers; ch++) {
-                for (t = 0; t < TIME_SLOTS; t++) {
-                    pData->STFTOutputFrameTF[t][ch].re[band] = crealf(pData->outputframeTF[band][ch][t]);
-                    pData->STFTOutputFrameTF[t][ch].im[band] = cimagf(pData->outputframeTF[band][ch][t]);
-                }
+                    pData->outputframeTF[band][ls][t] = crmulf(pData->outputframeTF[band][ls][t], 1.0f/sqrtf((float)tft->nSources));
+    SAF_PROFILE_END(pData->hProf, "vbap");
+    
+    /* inverse-TFT; loudspeakers dropped by a new gain table are kept in it (with silent input) until their filterbank
+     * memory has emptied, so that their tail is not cut off and they can be picked up again at any time */
+    SAF_PROFILE_BEGIN(pData->hProf, "afSTFTinverse");
+    if( (nLoudspeakers >= tft->nOutputsTF) || (tft->nSilentSamples >= afSTFTtail(HOP_SIZE, 1)) ){
+        tft->nOutputsTF = nLoudspeakers;
+        tft->nSilentSamples = 0;
+    }
+    else
+        tft->nSilentSamples += FRAME_SIZE;
+    nOutputsTF = tft->nOutputsTF;
+    for (band = 0; band < HYBRID_BANDS; band++) {
+        for (ch = 0; ch < nOutputsTF; ch++) {
+            for (t = 0; t < TIME_SLOTS; t++) {
+                tft->STFTOutputFrameTF[t][ch].re[band] = crealf(pData->outputframeTF[band][ch][t]);
+                tft->STFTOutputFrameTF[t][ch].im[band] = cimagf(pData->outputframeTF[band][ch][t]);
             }
         }
-        for (t = 0; t < TIME_SLOTS; t++) {
-            afSTFTinverse(pData->hSTFT, pData->STFTOutputFrameTF[t], pData->tempHopFrameTD);
-            for (ch = 0; ch < MIN(nLoudspeakers, nOutputs); ch++)
-                for (sample = 0; sample < HOP_SIZE; sample++)
-                    outputs[ch][sample + t* HOP_SIZE] = pData->tempHopFrameTD[ch][sample];
-            for (; ch < nOutputs; ch++)
-                for (sample = 0; sample < HOP_SIZE; sample++)
-                    outputs[ch][sample + t* HOP_SIZE] = 0.0f;
-        }
     }
+    for (t = 0; t < TIME_SLOTS; t++) {
+        afSTFTinverseChannels(tft->hSTFT, tft->STFTOutputFrameTF[t], tft->tempHopFrameTD, NULL, nOutputsTF);
+        for (ch = 0; ch < MIN(nOutputsTF, nOutputs); ch++)
+            for (sample = 0; sample < HOP_SIZE; sample++)
+                outputs[ch][sample + t* HOP_SIZE] = tft->tempHopFrameTD[ch][sample];
+        for (; ch < nOutputs; ch++)
+            for (sample = 0; sample < HOP_SIZE; sample++)
+                outputs[ch][sample + t* HOP_SIZE] = 0.0f;
+    }
+    SAF_PROFILE_END(pData->hProf, "afSTFTinverse");
+    SAF_PROFILE_END(pData->hProf, "total");
+    SAF_RT_SCOPE_END;
+}
+
+void panner_process
+(
+    void  *  const hPan,
+    float ** const inputs,
+    float ** const outputs,
+    int            nInputs,
+    int            nOutputs,
+    int            nSamples,
+    int            isPlaying
+)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    const userPars* up;
+    int ch;
+    
+    /* consistent snapshot of the user parameters for this frame */
+    up = (const userPars*)saf_paramBlock_read(pData->hUserPars, USER_PARS_AUDIO);
+    
+    /* pick up a newly published gain table and/or TFT (built on the worker thread, see "panner_codecWorker") */
+    panner_pickUpPars(hPan);
+    panner_updatePvalue(hPan, up);
+    
+    /* apply panner, once the TFT has been built for the input channels */
+    if ((nSamples == FRAME_SIZE) && (isPlaying == 1) && (pData->pars!=NULL) && (pData->pars->vbap_gtable != NULL) &&
+        (pData->tft!=NULL) && !pData->tft->objectMode)
+        panner_processFrame(hPan, up, NULL, inputs, outputs, nInputs, nOutputs);
+    else
+        for (ch=0; ch < nOutputs; ch++)
+            memset(outputs[ch],0, FRAME_SIZE*sizeof(float));
+}
+
+void panner_waitForCodecInit(void* const hPan)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    saf_worker_wait(pData->hWorker);
+}
+
+
+/* Object Functions */
+
+void panner_setMaxNumObjects
+(
+    void * const hPan,
+    int          maxNumObjects
+)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    
+    maxNumObjects = MAX(MIN(maxNumObjects, MAX_NUM_OBJECTS), 1);
+    saf_objects_destroy(&(pData->hObjects));
+    saf_objects_create(&(pData->hObjects), maxNumObjects, 1);
+    
+    /* the TFT is rebuilt for the objects on the worker thread */
+    saf_atomic_storei(&(pData->objectMode), 1);
+    panner_requestInit(hPan, &(pData->reInitTFT));
+}
+
+int panner_addObject(void* const hPan, int id, float azi_deg, float elev_deg, float gain)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    if(pData->hObjects==NULL)
+        return -1;
+    return saf_objects_add(pData->hObjects, id, azi_deg, elev_deg, gain);
+}
+
+int panner_removeObject(void* const hPan, int id)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    if(pData->hObjects==NULL)
+        return -1;
+    return saf_objects_remove(pData->hObjects, id);
+}
+
+int panner_updateObject(void* const hPan, int id, float azi_deg, float elev_deg, float gain)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    if(pData->hObjects==NULL)
+        return -1;
+    return saf_objects_update(pData->hObjects, id, azi_deg, elev_deg, gain);
+}
+
+void panner_commitObjects(void* const hPan)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    if(pData->hObjects!=NULL)
+        saf_objects_publish(pData->hObjects);
+}
+
+int panner_getMaxNumObjects(void* const hPan)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    return pData->hObjects==NULL ? 0 : saf_objects_getMaxNumObjects(pData->hObjects);
+}
+
+int panner_getNumObjects(void* const hPan)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    return pData->hObjects==NULL ? 0 : saf_objects_getNumObjects(pData->hObjects);
+}
+
+void panner_processObjects
+(
+    void  *  const hPan,
+    float ** const objectInputs,
+    float ** const outputs,
+    int            nObjectInputs,
+    int            nOutputs,
+    int            nSamples,
+    int            isPlaying
+)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    const userPars* up;
+    int ch;
+    saf_objects_view objects;
+    
+    if(pData->hObjects==NULL){
+        for (ch=0; ch < nOutputs; ch++)
+            memset(outputs[ch],0, FRAME_SIZE*sizeof(float));
+        return;
+    }
+    
+    /* consistent snapshot of the objects and user parameters for this frame */
+    saf_objects_read(pData->hObjects, OBJECTS_AUDIO, &objects);
+    up = (const userPars*)saf_paramBlock_read(pData->hUserPars, USER_PARS_AUDIO);
+    
+    /* pick up a newly published gain table and/or TFT (as in "panner_process") */
+    panner_pickUpPars(hPan);
+    panner_updatePvalue(hPan, up);
+    
+    /* apply panner, once the TFT has been built for the objects */
+    if ((nSamples == FRAME_SIZE) && (isPlaying == 1) && (pData->pars!=NULL) && (pData->pars->vbap_gtable != NULL) &&
+        (pData->tft!=NULL) && pData->tft->objectMode && (pData->tft->nSources == objects.maxNumObjects))
+        panner_processFrame(hPan, up, &objects, objectInputs, outputs, nObjectInputs, nOutputs);
     else
         for (ch=0; ch < nOutputs; ch++)
             memset(outputs[ch],0, FRAME_SIZE*sizeof(float));
@@ -268,79 +490,112 @@ void panner_process
 void panner_setSourceAzi_deg(void* const hPan, int index, float newAzi_deg)
 {
     panner_data *pData = (panner_data*)(hPan);
+    userPars* up;
+    
     newAzi_deg = MAX(newAzi_deg, -180.0f);
     newAzi_deg = MIN(newAzi_deg, 180.0f);
-    pData->src_dirs_deg[index][0] = newAzi_deg;
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->src_dirs_deg[index][0] = newAzi_deg;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void panner_setSourceElev_deg(void* const hPan, int index, float newElev_deg)
 {
     panner_data *pData = (panner_data*)(hPan);
+    userPars* up;
+    
     newElev_deg = MAX(newElev_deg, -90.0f);
     newElev_deg = MIN(newElev_deg, 90.0f);
-    pData->src_dirs_deg[index][1] = newElev_deg;
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->src_dirs_deg[index][1] = newElev_deg;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void panner_setNumSources(void* const hPan, int new_nSources)
 {
-    panner_data *pData = (panner_data*)(hPan);
-    /* determine if TFT must be reinitialised */
-    pData->new_nSources = new_nSources > MAX_NUM_INPUTS ? MAX_NUM_INPUTS : new_nSources;
-    if(pData->nSources != pData->new_nSources)
-        pData->reInitTFT = 1;
+    panner_data *pData = (panner_data*)(hPan);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    int nSources_prev = up->nSources;
+    int nSources = new_nSources > MAX_NUM_INPUTS ? MAX_NUM_INPUTS : new_nSources;
+    up->nSources = nSources;
+    saf_paramBlock_publish(pData->hUserPars);
+    if(nSources_prev != nSources)
+        panner_requestInit(hPan, &(pData->reInitTFT));
 }
 
 void panner_setLoudspeakerAzi_deg(void* const hPan, int index, float newAzi_deg)
 {
     panner_data *pData = (panner_data*)(hPan);
+    userPars* up;
+    
     newAzi_deg = MAX(newAzi_deg, -180.0f);
     newAzi_deg = MIN(newAzi_deg, 180.0f);
-    pData->loudpkrs_dirs_deg[index][0] = newAzi_deg;
-    pData->reInitGainTables=1;
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->loudpkrs_dirs_deg[index][0] = newAzi_deg;
+    saf_paramBlock_publish(pData->hUserPars);
+    panner_requestInit(hPan, &(pData->reInitGainTables));
 }
 
 void panner_setLoudspeakerElev_deg(void* const hPan, int index, float newElev_deg)
 {
     panner_data *pData = (panner_data*)(hPan);
+    userPars* up;
+    
     newElev_deg = MAX(newElev_deg, -90.0f);
     newElev_deg = MIN(newElev_deg, 90.0f);
-    pData->loudpkrs_dirs_deg[index][1] = newElev_deg;
-    pData->reInitGainTables=1;
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->loudpkrs_dirs_deg[index][1] = newElev_deg;
+    saf_paramBlock_publish(pData->hUserPars);
+    panner_requestInit(hPan, &(pData->reInitGainTables));
 }
 
 void panner_setNumLoudspeakers(void* const hPan, int new_nLoudspeakers)
 {
     panner_data *pData = (panner_data*)(hPan);    
-    pData->new_nLoudpkrs = new_nLoudspeakers > MAX_NUM_OUTPUTS ? MAX_NUM_OUTPUTS : new_nLoudspeakers;
-    if(pData->nLoudpkrs != pData->new_nLoudpkrs)
-        pData->reInitTFT = 1; 
-    pData->reInitGainTables=1;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    int nLoudpkrs_prev = up->nLoudpkrs;
+    int nLoudpkrs = new_nLoudspeakers > MAX_NUM_OUTPUTS ? MAX_NUM_OUTPUTS : new_nLoudspeakers;
+    up->nLoudpkrs = nLoudpkrs;
+    saf_paramBlock_publish(pData->hUserPars);
+    if(nLoudpkrs_prev != nLoudpkrs)
+        panner_requestInit(hPan, &(pData->reInitGainTables));
 }
 
 void panner_setOutputConfigPreset(void* const hPan, int newPresetID)
 {
     panner_data *pData = (panner_data*)(hPan);
-    panner_loadPreset(newPresetID, pData->loudpkrs_dirs_deg, &(pData->new_nLoudpkrs), &(pData->output_nDims));
-    if(pData->nLoudpkrs != pData->new_nLoudpkrs)
-        pData->reInitTFT = 1;
-    pData->reInitGainTables=1;
+    userPars* up;
+    int nDims;
+    
+    /* (the dimensionality of the loudspeaker setup is determined along with the gain table) */
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    panner_loadPreset(newPresetID, up->loudpkrs_dirs_deg, &(up->nLoudpkrs), &nDims);
+    saf_paramBlock_publish(pData->hUserPars);
+    panner_requestInit(hPan, &(pData->reInitGainTables));
 }
 
 void panner_setInputConfigPreset(void* const hPan, int newPresetID)
 {
     panner_data *pData = (panner_data*)(hPan);
-
-    panner_loadPreset(newPresetID, pData->src_dirs_deg, &(pData->new_nSources), &(pData->input_nDims));
-    if(pData->nSources != pData->new_nSources)
-        pData->reInitTFT = 1;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    int nSources_prev, nSources;
+
+    nSources_prev = up->nSources;
+    panner_loadPreset(newPresetID, up->src_dirs_deg, &(up->nSources), &(up->input_nDims));
+    nSources = up->nSources;
+    saf_paramBlock_publish(pData->hUserPars);
+    if(nSources_prev != nSources)
+        panner_requestInit(hPan, &(pData->reInitTFT));
 }
 
 void panner_setDTT(void* const hPan, float newValue)
 {
     panner_data *pData = (panner_data*)(hPan);
+    userPars* up;
 
-    pData->DTT = newValue;
-    panner_getPvalue(pData->DTT, pData->freqVector, pData->pValue);
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->DTT = newValue;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 
@@ -349,19 +604,22 @@ void panner_setDTT(void* const hPan, float newValue)
 float panner_getSourceAzi_deg(void* const hPan, int index)
 {
     panner_data *pData = (panner_data*)(hPan);
-    return pData->src_dirs_deg[index][0];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->src_dirs_deg[index][0];
 }
 
 float panner_getSourceElev_deg(void* const hPan, int index)
 {
     panner_data *pData = (panner_data*)(hPan);
-    return pData->src_dirs_deg[index][1];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->src_dirs_deg[index][1];
 }
 
 int panner_getNumSources(void* const hPan)
 {
     panner_data *pData = (panner_data*)(hPan);
-    return pData->nSources;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->nSources;
 }
 
 int panner_getMaxNumSources()
@@ -372,19 +630,22 @@ int panner_getMaxNumSources()
 float panner_getLoudspeakerAzi_deg(void* const hPan, int index)
 {
     panner_data *pData = (panner_data*)(hPan);
-    return pData->loudpkrs_dirs_deg[index][0];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->loudpkrs_dirs_deg[index][0];
 }
 
 float panner_getLoudspeakerElev_deg(void* const hPan, int index)
 {
     panner_data *pData = (panner_data*)(hPan);
-    return pData->loudpkrs_dirs_deg[index][1];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->loudpkrs_dirs_deg[index][1];
 }
 
 int panner_getNumLoudspeakers(void* const hPan)
 {
     panner_data *pData = (panner_data*)(hPan);
-    return pData->nLoudpkrs;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->nLoudpkrs;
 }
 
 int panner_getMaxNumLoudspeakers()
@@ -401,7 +662,32 @@ int panner_getDAWsamplerate(void* const hPan)
 float panner_getDTT(void* const hPan)
 {
     panner_data *pData = (panner_data*)(hPan);
-    return pData->DTT;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->DTT;
+}
+
+float panner_getActivityHoldTime(void* const hPan)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->activityHold_ms;
+}
+
+int panner_getNumActiveSources(void* const hPan)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    return saf_atomic_loadi(&(pData->nActiveSources));
+}
+
+int panner_getProcessingDelay(void)
+{
+    return afSTFTdelay(HOP_SIZE, 0, 1);
+}
+
+void* panner_getProfiler(void* const hPan)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    return pData->hProf;
 }
 
 
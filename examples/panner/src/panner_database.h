@@ -1,13 +0,0 @@
-/*
-    Leo McCormack 
-    ../database/panner_database.h
-    Generated using MatLab on: 23-Nov-2017 
-*/
-
-#ifndef __PANNER_DATABASE_INCLUDED__
-#define __PANNER_DATABASE_INCLUDED__
-
-extern const double __afCenterFreq48e3[133];
-extern const double __afCenterFreq44100[133];
-
-#endif /* __PANNER_DATABASE_INCLUDED__ */
@@ -29,86 +29,215 @@
 
 #include "panner_internal.h" 
 
-void panner_initGainTables(void* const hPan)
+void panner_requestInit(void* const hPan, volatile int* flag)
 {
     panner_data *pData = (panner_data*)(hPan);
+    
+    saf_atomic_storei(flag, 1);
+    saf_worker_post(pData->hWorker);
+}
+
+void panner_codecWorker(void* hPan)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    const userPars* up;
+    codecPars* pars, *nextPars;
+    tftPars* tft, *nextTFT;
+    int objectMode;
+    
+    /* free the gain tables and TFTs the audio thread is no longer using */
+    pars = (codecPars*)saf_atomic_exchangep(&(pData->retiredPars), NULL);
+    for(; pars!=NULL; pars = nextPars){
+        nextPars = pars->next;
+        panner_freeCodecPars(&pars);
+    }
+    tft = (tftPars*)saf_atomic_exchangep(&(pData->retiredTFT), NULL);
+    for(; tft!=NULL; tft = nextTFT){
+        nextTFT = tft->next;
+        panner_freeTFT(&tft);
+    }
+    
+    /* build a fresh gain table for a snapshot of the current loudspeakers (if they are changed in the meantime, the job
+     * is posted again and this one will be superseded) */
+    if(saf_atomic_exchangei(&(pData->reInitGainTables), 0)){
+        up = (const userPars*)saf_paramBlock_read(pData->hUserPars, USER_PARS_WORKER);
+        pars = (codecPars*)calloc(1, sizeof(codecPars));
+        pars->nLoudpkrs = up->nLoudpkrs;
+        memcpy(pars->loudpkrs_dirs_deg, up->loudpkrs_dirs_deg, MAX_NUM_INPUTS*2*sizeof(float));
+        panner_initGainTables(pars);
+        
+        /* publish it; if the audio thread never picked up the previously published one, it is not needed anymore */
+        pars = (codecPars*)saf_atomic_exchangep(&(pData->pendingPars), (void*)pars);
+        panner_freeCodecPars(&pars);
+    }
+    
+    /* build a fresh TFT, for the current number of input channels, or for the maximum number of objects */
+    if(saf_atomic_exchangei(&(pData->reInitTFT), 0)){
+        up = (const userPars*)saf_paramBlock_read(pData->hUserPars, USER_PARS_WORKER);
+        objectMode = saf_atomic_loadi(&(pData->objectMode));
+        tft = panner_createTFT(objectMode ? saf_objects_getMaxNumObjects(pData->hObjects) : up->nSources, objectMode);
+        tft = (tftPars*)saf_atomic_exchangep(&(pData->pendingTFT), (void*)tft);
+        panner_freeTFT(&tft);
+    }
+}
+
+void panner_pickUpPars(void* const hPan)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    codecPars* newPars;
+    tftPars* newTFT;
+    
+    newPars = (codecPars*)saf_atomic_exchangep(&(pData->pendingPars), NULL);
+    if(newPars!=NULL){
+        panner_retireCodecPars(hPan, pData->pars);
+        pData->pars = newPars;
+    }
+    newTFT = (tftPars*)saf_atomic_exchangep(&(pData->pendingTFT), NULL);
+    if(newTFT!=NULL){
+        panner_retireTFT(hPan, pData->tft);
+        pData->tft = newTFT;
+    }
+}
+
+void panner_retireCodecPars(void* const hPan, codecPars* const pars)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    void* head;
+    
+    if(pars==NULL)
+        return;
+    /* lock-free push; the worker thread only ever takes the whole list at once, so there is no ABA problem */
+    do{
+        head = saf_atomic_loadp(&(pData->retiredPars));
+        pars->next = (codecPars*)head;
+    } while(!saf_atomic_casp(&(pData->retiredPars), head, (void*)pars));
+}
+
+void panner_retireTFT(void* const hPan, tftPars* const tft)
+{
+    panner_data *pData = (panner_data*)(hPan);
+    void* head;
+    
+    if(tft==NULL)
+        return;
+    /* lock-free push (as "panner_retireCodecPars") */
+    do{
+        head = saf_atomic_loadp(&(pData->retiredTFT));
+        tft->next = (tftPars*)head;
+    } while(!saf_atomic_casp(&(pData->retiredTFT), head, (void*)tft));
+}
+
+void panner_initGainTables(codecPars* const pars)
+{
     int i;
     float sum_elev;
     
     /* determine dimensionality */
     sum_elev = 0.0f;
-    for(i=0; i<pData->nLoudpkrs; i++)
-        sum_elev += fabsf(pData->loudpkrs_dirs_deg[i][1]);
-    sum_elev = sum_elev/(float)pData->nLoudpkrs - fabsf(pData->loudpkrs_dirs_deg[i][0]);
+    for(i=0; i<pars->nLoudpkrs; i++)
+        sum_elev += fabsf(pars->loudpkrs_dirs_deg[i][1]);
+    sum_elev = sum_elev/(float)pars->nLoudpkrs - fabsf(pars->loudpkrs_dirs_deg[i][0]);
     if(sum_elev < 0.01f)
-        pData->output_nDims = 2;
+        pars->output_nDims = 2;
     else
-        pData->output_nDims = 3;
+        pars->output_nDims = 3;
     
     /* generate VBAP gain table */
-    if(pData->vbap_gtable!= NULL){
-        free(pData->vbap_gtable);
-        pData->vbap_gtable = NULL;
+    if(pars->vbap_gtable!= NULL){
+        free(pars->vbap_gtable);
+        pars->vbap_gtable = NULL;
     } 
-    pData->vbapTableRes[0] = 2;
-    pData->vbapTableRes[1] = 5;
-    if(pData->output_nDims==2)
-        generateVBAPgainTable2D((float*)pData->loudpkrs_dirs_deg, pData->nLoudpkrs, pData->vbapTableRes[0],
-                                &(pData->vbap_gtable), &(pData->N_vbap_gtable), &(pData->nTriangles));
+    pars->vbapTableRes[0] = 2;
+    pars->vbapTableRes[1] = 5;
+    if(pars->output_nDims==2)
+        generateVBAPgainTable2D((float*)pars->loudpkrs_dirs_deg, pars->nLoudpkrs, pars->vbapTableRes[0],
+                                &(pars->vbap_gtable), &(pars->N_vbap_gtable), &(pars->nTriangles));
     else{
-        generateVBAPgainTable3D((float*)pData->loudpkrs_dirs_deg, pData->nLoudpkrs, pData->vbapTableRes[0], pData->vbapTableRes[1], 1, 1,
-                                &(pData->vbap_gtable), &(pData->N_vbap_gtable), &(pData->nTriangles));
-        if(pData->vbap_gtable==NULL){
+        generateVBAPgainTable3D((float*)pars->loudpkrs_dirs_deg, pars->nLoudpkrs, pars->vbapTableRes[0], pars->vbapTableRes[1], 1, 1,
+                                &(pars->vbap_gtable), &(pars->N_vbap_gtable), &(pars->nTriangles));
+        if(pars->vbap_gtable==NULL){
             /* if generating vbap gain tabled failed, re-calculate with 2D VBAP */
-            pData->output_nDims = 2;
-            panner_initGainTables(hPan);
+            pars->output_nDims = 2;
+            panner_initGainTables(pars);
         }
     }
 }
 
-void panner_initTFT
+void panner_freeCodecPars(codecPars** const ppars)
+{
+    codecPars* pars = *ppars;
+    
+    if (pars == NULL)
+        return;
+    free(pars->vbap_gtable);
+    free(pars);
+    *ppars = NULL;
+}
+
+tftPars* panner_createTFT
 (
-    void* const hPan
+    int new_nSources,
+    int objectMode
 )
 {
-    panner_data *pData = (panner_data*)(hPan);
+    tftPars* tft;
     int t, ch;
     
-    if (pData->hSTFT != NULL){
-        afSTFTfree(pData->hSTFT);
-        pData->hSTFT = NULL;
-        for (t = 0; t<TIME_SLOTS; t++) {
-            for (ch = 0; ch< pData->nSources; ch++) {
-                free(pData->STFTInputFrameTF[t][ch].re);
-                free(pData->STFTInputFrameTF[t][ch].im);
-            }
-            for (ch = 0; ch< pData->nLoudpkrs; ch++) {
-                free(pData->STFTOutputFrameTF[t][ch].re);
-                free(pData->STFTOutputFrameTF[t][ch].im);
-            }
+    tft = (tftPars*)calloc(1, sizeof(tftPars));
+    tft->nSources = new_nSources;
+    tft->objectMode = objectMode;
+    afSTFTinit(&(tft->hSTFT), HOP_SIZE, new_nSources, MAX_NUM_OUTPUTS, 0, 1);
+    tft->STFTInputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, new_nSources, sizeof(complexVector));
+    tft->STFTOutputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, MAX_NUM_OUTPUTS, sizeof(complexVector));
+    for(t=0; t<TIME_SLOTS; t++) {
+        for(ch=0; ch< new_nSources; ch++) {
+            tft->STFTInputFrameTF[t][ch].re = (float*)calloc(HYBRID_BANDS, sizeof(float));
+            tft->STFTInputFrameTF[t][ch].im = (float*)calloc(HYBRID_BANDS, sizeof(float));
+        }
+        for(ch=0; ch< MAX_NUM_OUTPUTS; ch++) {
+            tft->STFTOutputFrameTF[t][ch].re = (float*)calloc(HYBRID_BANDS, sizeof(float));
+            tft->STFTOutputFrameTF[t][ch].im = (float*)calloc(HYBRID_BANDS, sizeof(float));
         }
-        free2d((void**)pData->STFTInputFrameTF, TIME_SLOTS);
-        free2d((void**)pData->STFTOutputFrameTF, TIME_SLOTS);
-        free2d((void**)pData->tempHopFrameTD, MAX(pData->nSources, pData->nLoudpkrs));
     }
-    if (pData->hSTFT == NULL){
-        afSTFTinit(&(pData->hSTFT), HOP_SIZE, pData->new_nSources, pData->new_nLoudpkrs, 0, 1);
-        pData->STFTInputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, pData->new_nSources, sizeof(complexVector));
-        pData->STFTOutputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, pData->new_nLoudpkrs, sizeof(complexVector));
-        for(t=0; t<TIME_SLOTS; t++) {
-            for(ch=0; ch< pData->new_nSources; ch++) {
-                pData->STFTInputFrameTF[t][ch].re = (float*)calloc(HYBRID_BANDS, sizeof(float));
-                pData->STFTInputFrameTF[t][ch].im = (float*)calloc(HYBRID_BANDS, sizeof(float));
-            }
-            for(ch=0; ch< pData->new_nLoudpkrs; ch++) {
-                pData->STFTOutputFrameTF[t][ch].re = (float*)calloc(HYBRID_BANDS, sizeof(float));
-                pData->STFTOutputFrameTF[t][ch].im = (float*)calloc(HYBRID_BANDS, sizeof(float));
-            }
+    tft->tempHopFrameTD = (float**)malloc2d( MAX(new_nSources, MAX_NUM_OUTPUTS), HOP_SIZE, sizeof(float));
+    tft->inputFrameTD = (float**)malloc2d(new_nSources, FRAME_SIZE, sizeof(float));
+    
+    /* all sources start out inactive, with their TFT memory cleared once they are active (see panner_process) */
+    tft->sourceActive = (int*)calloc(new_nSources, sizeof(int));
+    tft->nSilentFrames = (int*)calloc(new_nSources, sizeof(int));
+    tft->sourceGeneration = (int*)calloc(new_nSources, sizeof(int));
+    tft->srcList = (int*)malloc(new_nSources*sizeof(int));
+    return tft;
+}
+
+void panner_freeTFT(tftPars** const ptft)
+{
+    tftPars* tft = *ptft;
+    int t, ch;
+    
+    if (tft == NULL)
+        return;
+    afSTFTfree(tft->hSTFT);
+    for (t = 0; t<TIME_SLOTS; t++) {
+        for (ch = 0; ch< tft->nSources; ch++) {
+            free(tft->STFTInputFrameTF[t][ch].re);
+            free(tft->STFTInputFrameTF[t][ch].im);
+        }
+        for (ch = 0; ch< MAX_NUM_OUTPUTS; ch++) {
+            free(tft->STFTOutputFrameTF[t][ch].re);
+            free(tft->STFTOutputFrameTF[t][ch].im);
         }
-        pData->tempHopFrameTD = (float**)malloc2d( MAX(pData->new_nSources, pData->new_nLoudpkrs), HOP_SIZE, sizeof(float));
-        pData->nSources = pData->new_nSources;
-        pData->nLoudpkrs = pData->new_nLoudpkrs;
     }
+    free2d((void**)tft->STFTInputFrameTF, TIME_SLOTS);
+    free2d((void**)tft->STFTOutputFrameTF, TIME_SLOTS);
+    free2d((void**)tft->tempHopFrameTD, MAX(tft->nSources, MAX_NUM_OUTPUTS));
+    free2d((void**)tft->inputFrameTD, tft->nSources);
+    free(tft->sourceActive);
+    free(tft->nSilentFrames);
+    free(tft->sourceGeneration);
+    free(tft->srcList);
+    free(tft);
+    *ptft = NULL;
 }
 
 void panner_loadPreset(PRESETS preset, float dirs_deg[MAX_NUM_INPUTS][2], int* newNCH, int* nDims)
@@ -35,7 +35,6 @@
 #include <math.h>
 #include <string.h>
 #include "panner.h"
-#include "panner_database.h"
 #define SAF_ENABLE_AFSTFT /* for time-frequency transform */
 #define SAF_ENABLE_VBAP   /* for VBAP gains */
 #include "saf.h"
@@ -55,6 +54,10 @@ extern "C" {
 #define TIME_SLOTS ( FRAME_SIZE / HOP_SIZE )                /* 4/8/16 */
 #define MAX_NUM_INPUTS ( 64 )                               /* Maximum permited channels for the VST standard */
 #define MAX_NUM_OUTPUTS ( 64 )                              /* Maximum permited channels for the VST standard */
+#define MAX_NUM_OBJECTS ( 4096 )                            /* Maximum number of objects (see panner_setMaxNumObjects) */
+#define OBJECTS_AUDIO ( 0 )                                 /* object store reader index of the audio thread */
+#define USER_PARS_AUDIO ( 0 )                               /* user parameter block reader index of the audio thread */
+#define USER_PARS_WORKER ( 1 )                              /* user parameter block reader index of the worker thread */
 #define NUM_EARS ( 2 )                                      /* true for most humans */
  
     
@@ -62,45 +65,96 @@ extern "C" {
 /* Structs */
 /***********/
 
+/* user parameters (see saf_paramBlock) */
+typedef struct _userPars
+{
+    int nSources;
+    float src_dirs_deg[MAX_NUM_INPUTS][2];
+    int input_nDims; /* both 2D and 3D setups are supported, however, triangulation can fail if LS directions are shady */
+    float DTT;
+    int nLoudpkrs;
+    float loudpkrs_dirs_deg[MAX_NUM_INPUTS][2];
+    float activityHold_ms; /* time a source must be silent for, before it is skipped (see saf_activity.h) */
+    
+}userPars;
+
+/* VBAP gain table for a loudspeaker set-up; built on the worker thread, then used by the audio thread only */
+typedef struct _codecPars
+{
+    int nLoudpkrs; /* number of loudspeakers of the gain table */
+    float loudpkrs_dirs_deg[MAX_NUM_INPUTS][2]; /* loudspeaker directions of the gain table */
+    int output_nDims; /* dimensionality of the loudspeaker set-up (2 or 3) */
+    int vbapTableRes[2];
+    float* vbap_gtable; /* N_vbap_gtable x nLoudpkrs */
+    int N_vbap_gtable;
+    int nTriangles;
+    
+    struct _codecPars* next; /* next entry in the list of retired codec parameters */
+    
+} codecPars;
+
+/* time-frequency transform, buffers and state of each source; built on the worker thread for a number of sources,
+ * then used by the audio thread only. The inverse transform is allocated for MAX_NUM_OUTPUTS, so that it does not
+ * depend on the gain table */
+typedef struct _tftPars
+{
+    int nSources; /* number of sources; in object mode, the maximum number of objects */
+    int objectMode; /* 1: configured for the objects; 0: for the input channels */
+    
+    /* time-frequency transform + buffers */
+    void* hSTFT;
+    complexVector** STFTInputFrameTF;
+    complexVector** STFTOutputFrameTF; /* TIME_SLOTS x MAX_NUM_OUTPUTS */
+    float** tempHopFrameTD;
+    float** inputFrameTD; /* nSources x FRAME_SIZE */
+    int nOutputsTF; /* number of outputs currently inverse-transformed */
+    int nSilentSamples; /* number of samples the outputs above those of the gain table have been silent for */
+    
+    /* source activity */
+    int* sourceActive; /* 0: the source is silent; its TFT and panning are skipped */
+    int* nSilentFrames; /* number of consecutive silent frames of each source */
+    int* sourceGeneration; /* generation of the object each source last held (see saf_objects_view) */
+    int* srcList; /* indices of the active sources of the current frame, in ascending order in channel mode */
+    int nSrcList; /* number of active sources of the current frame */
+    
+    struct _tftPars* next; /* next entry in the list of retired TFTs */
+    
+} tftPars;
+
 typedef struct _panner
 {
     /* audio buffers */
-    float inputFrameTD[MAX_NUM_INPUTS][FRAME_SIZE];
-    float outframeTD[NUM_EARS][FRAME_SIZE];
-    float_complex inputframeTF[HYBRID_BANDS][MAX_NUM_INPUTS][TIME_SLOTS];
     float_complex outputframeTF[HYBRID_BANDS][MAX_NUM_OUTPUTS][TIME_SLOTS];
-    complexVector** STFTInputFrameTF;
-    complexVector** STFTOutputFrameTF;
-    float** tempHopFrameTD;
     int fs;
-    
-    /* time-frequency transform */
     float freqVector[HYBRID_BANDS];
-    void* hSTFT;
-    
-    /* Loudspeaker version */
-    int vbapTableRes[2];
-    float* vbap_gtable; /* N_hrtf_vbap_gtable x nLoudpkrs */
-    int N_vbap_gtable;
-    int reInitGainTables;
-    int reInitTFT;
     
-    /* misc. */
-    int nTriangles;
-    int input_nDims; /* both 2D and 3D setups are supported, however, triangulation can fail if LS directions are shady */
-    int output_nDims;
+    /* gain table and TFT; the worker thread builds new ones whenever they are to be reinitialised, and publishes them
+     * to the audio thread, which hands the previous ones back to it for freeing */
+    codecPars* pars; /* gain table currently used for panning (audio thread only) */
+    void* volatile pendingPars; /* new gain table published by the worker thread (codecPars*) */
+    void* volatile retiredPars; /* gain tables no longer used by the audio thread, freed by the worker thread (codecPars*) */
+    tftPars* tft; /* TFT and source state currently used for panning (audio thread only) */
+    void* volatile pendingTFT; /* new TFT published by the worker thread (tftPars*) */
+    void* volatile retiredTFT; /* TFTs no longer used by the audio thread, freed by the worker thread (tftPars*) */
+    void* hWorker; /* worker thread, which (re)initialises the gain table and TFT */
     
-    /* pValue */
+    /* pValue (audio thread) */
     float pValue[HYBRID_BANDS];
+    float DTT; /* DTT the pValues were computed for; -1: not yet */
+    
+    volatile int nActiveSources;
+    
+    /* objects (see panner_setMaxNumObjects); the sources are then indexed by object ID */
+    void* hObjects; /* object store; NULL: none */
+    volatile int objectMode; /* 1: the TFT is to be configured for the objects; 0: for the input channels */
+    
+    /* flags; raised by the set functions and cleared by the worker thread, when it starts reinitialising */
+    volatile int reInitGainTables;
+    volatile int reInitTFT;
     
     /* user parameters */
-    int nSources;
-    int new_nSources;
-    float src_dirs_deg[MAX_NUM_INPUTS][2];
-    float DTT;
-    int nLoudpkrs;
-    int new_nLoudpkrs;
-    float loudpkrs_dirs_deg[MAX_NUM_INPUTS][2];
+    void* hUserPars; /* parameter block of "userPars"; edited by the set functions, read by the audio and worker threads */
+    void* hProf;     /* per-stage timing of the processing loop (see saf_profiler.h) */
     
 } panner_data;
      
@@ -109,11 +163,39 @@ typedef struct _panner
 /* Internal functions */
 /**********************/
     
-/* Generate a VBAP gain table for current loudspeaker configuration. */
-void panner_initGainTables(void* const hPan);                /* panner handle */
+/* Flags part of the state for reinitialisation, which is carried out on the worker thread. Not for the audio thread */
+void panner_requestInit(void* const hPan,                    /* panner handle */
+                        volatile int* flag);                 /* "reInitTFT" or "reInitGainTables" */
+    
+/* Worker thread job: builds a fresh gain table and/or a fresh TFT, as flagged, and publishes them to the audio thread.
+ * Also frees any gain tables and TFTs the audio thread has since retired */
+void panner_codecWorker(void* hPan);                         /* panner handle */
+    
+/* Picks up the gain table and TFT newly published by the worker thread, and retires the previous ones. For the audio
+ * thread */
+void panner_pickUpPars(void* const hPan);                    /* panner handle */
+    
+/* Hands a gain table no longer in use over to the worker thread for freeing; lock-free, for the audio thread */
+void panner_retireCodecPars(void* const hPan,                /* panner handle */
+                            codecPars* const pars);          /* gain table to retire */
+    
+/* Hands a TFT no longer in use over to the worker thread for freeing; lock-free, for the audio thread */
+void panner_retireTFT(void* const hPan,                      /* panner handle */
+                      tftPars* const tft);                   /* TFT to retire */
+    
+/* Generate a VBAP gain table for the loudspeaker configuration in "pars" */
+void panner_initGainTables(codecPars* const pars);           /* gain table to initialise */
+    
+/* Frees a gain table */
+void panner_freeCodecPars(codecPars** const ppars);          /* & address of gain table */
+    
+/* Allocates the filterbank used by panner, along with the buffers and activity state of each source, for
+ * "new_nSources" sources and MAX_NUM_OUTPUTS outputs */
+tftPars* panner_createTFT(int new_nSources,                  /* number of sources */
+                          int objectMode);                   /* 1: for the objects; 0: for the input channels */
     
-/* Initialise the filterbank used by panner */
-void panner_initTFT(void* const hPan);                       /* panner handle */
+/* Frees the filterbank, buffers and source state allocated by panner_createTFT */
+void panner_freeTFT(tftPars** const ptft);                   /* & address of TFT */
     
 /* Loads directions from preset */
 void panner_loadPreset(PRESETS preset,                       /* PRESET enum */
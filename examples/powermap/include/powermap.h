@@ -104,12 +104,23 @@ void powermap_analysis(void* const hPm,                      /* powermap handle
                        int nInputs,                          /* number of channels in 'inputs' matrix */
                        int nSamples,                         /* number of samples in 'inputs' and 'outputs' matrices */
                        int isPlaying);                       /* flag, 0: no audio in buffer, 1: buffers have been filled */
+
+/* blocks until the worker thread has finished (re)computing the codec parameters (grids, steering vectors and
+ * interpolation tables), which are then picked up by the next call to "powermap_analysis" (e.g. for offline analysis or
+ * benchmarking). Must not be called from the audio thread */
+void powermap_waitForCodecInit(void* const hPm);             /* powermap handle */
     
    
 /*****************/
 /* Set Functions */
 /*****************/
     
+/* sets the thread pool (see "saf_pool_create") over which "powermap_analysis" spreads the covariance updates of the
+ * bands; NULL (default): the audio thread updates all bands. The pool may be shared with other instances/modules, and
+ * must not be destroyed whilst it is still set */
+void powermap_setThreadPool(void* const hPm,           /* powermap handle */
+                            void* const hPool);        /* thread pool handle; NULL: none */
+    
 void powermap_setPowermapMode(void* const hPm, int newMode);
 
 void powermap_setAnaOrder(void* const hPm,  int newValue, int bandIdx);
@@ -136,6 +147,8 @@ void powermap_setAspectRatio(void* const hPm, int newOption);
     
 void powermap_setPowermapAvgCoeff(void* const hPm, float newValue);
     
+void powermap_setPeakSearch(void* const hPm, int newState); /* 0: off, 1: find the powermap peaks every frame */
+    
 void powermap_requestPmapUpdate(void* const hPm);
 
 void powermap_refreshSettings(void* const hPm);
@@ -157,6 +170,8 @@ float powermap_getPowermapEQ(void* const hPm, int bandIdx);
 
 float powermap_getPowermapEQAllBands(void* const hPm);
 
+/* Note: values written via the EQ/order handles are passed on to the audio thread upon the next call to
+ * "powermap_requestPmapUpdate" (or any of the set functions) */
 void powermap_getPowermapEQHandle(void* const hPm,
                                   float** pX_vector,
                                   float** pY_values,
@@ -183,6 +198,16 @@ int powermap_getAspectRatio(void* const hPm);
     
 float powermap_getPowermapAvgCoeff(void* const hPm);
     
+int powermap_getPeakSearch(void* const hPm);
+    
+/* returns the number of peaks found in the most recent frame; the powermap itself is only updated upon request,
+ * whereas the peaks are found every frame (coarse-to-fine, see "findPowermapPeaks"), if enabled. Values are not
+ * normalised, unlike the powermap returned by "powermap_getPmap". The directions, values and count all belong to the
+ * same frame, and remain valid and unchanged until the next call; to be called from one thread only (e.g. the GUI) */
+int powermap_getPeaks(void* const hPm,
+                      float** peak_dirs_deg,                 /* & peak directions, in degrees; FLAT: nPeaks x 2 */
+                      float** peak_vals);                    /* & peak powermap values; nPeaks x 1 */
+    
 //TODO: hfov and aspectRatio should be float, if 16:9 etc options are added
 int powermap_getPmap(void* const hPm,
                      float** grid_dirs,
@@ -192,6 +217,9 @@ int powermap_getPmap(void* const hPm,
                      int* hfov,
                      int* aspectRatio);
 
+/* returns the profiler handle, for "saf_profiler_getStats" (NULL, unless built with SAF_ENABLE_PROFILER) */
+void* powermap_getProfiler(void* const hPm);
+
 
 #ifdef __cplusplus
 }
@@ -26,7 +26,6 @@
 
 #include "powermap.h"
 #include "powermap_internal.h"
-#include "powermap_database.h"
 
 void powermap_create
 (
@@ -36,7 +35,10 @@ void powermap_create
     powermap_data* pData = (powermap_data*)malloc(sizeof(powermap_data));
     if (pData == NULL) { return;/*error*/ }
     *phPm = (void*)pData;
-    int n, i, t, ch, band;
+    saf_profiler_create(&(pData->hProf));
+    pData->hPool = NULL;
+    int t, ch, band;
+    userPars* up;
     
     afSTFTinit(&(pData->hSTFT), HOP_SIZE, MAX_NUM_SH_SIGNALS, 0, 0, 1);
     pData->STFTInputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, MAX_NUM_SH_SIGNALS, sizeof(complexVector));
@@ -48,41 +50,46 @@ void powermap_create
     }
     pData->tempHopFrameTD = (float**)malloc2d(MAX_NUM_SH_SIGNALS, HOP_SIZE, sizeof(float));
     
-    /* codec data */
-    pData->pars = (codecPars*)malloc(sizeof(codecPars));
-    codecPars* pars = pData->pars;
-    pars->interp_dirs_deg = NULL;
-    for(n=0; n<SH_ORDER; n++){
-        pars->Y_grid[n] = NULL;
-        pars->Y_grid_cmplx[n] = NULL;
-    }
-    pars->interp_table = NULL;
+    /* codec data (built on the worker thread, see "powermap_codecWorker") */
+    pData->pars = NULL;
+    pData->pendingPars = NULL;
+    pData->retiredPars = NULL;
     
     /* internal */
     pData->reInitAna = 1;
     pData->dispWidth = 140;
 
     /* display */
-    pData->pmap = NULL;
-    pData->prev_pmap = NULL;
-    for(i=0; i<NUM_DISP_SLOTS; i++)
-        pData->pmap_grid[i] = NULL;
+    pData->dispPars = NULL;
     pData->pmapReady = 0;
     pData->recalcPmap = 1;
+    memset(pData->peaks, 0, 3*sizeof(peakResults));
+    pData->peaksBack = 0;
+    pData->peaksMiddle = 1;
+    pData->peaksFront = 2;
+    pData->prev_pmap_mode = PM_MODE_MUSIC;
     
     /* Default user parameters */
+    saf_paramBlock_create(&(pData->hUserPars), sizeof(userPars), 2);
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
     for(band=0; band<HYBRID_BANDS; band++){
-        pData->analysisOrderPerBand[band] = SH_ORDER;
-        pData->pmapEQ[band] = 1.0f;
+        up->analysisOrderPerBand[band] = SH_ORDER;
+        up->pmapEQ[band] = 1.0f;
     }
-    pData->covAvgCoeff = 0.0f;
-    pData->pmapAvgCoeff = 0.666f;
-    pData->nSources = 4;
-    pData->pmap_mode = PM_MODE_MUSIC;
-    pData->HFOVoption = HFOV_360;
-    pData->aspectRatioOption = ASPECT_RATIO_2_1;
-    pData->chOrdering = CH_ACN;
-    pData->norm = NORM_N3D;
+    up->covAvgCoeff = 0.0f;
+    up->pmapAvgCoeff = 0.666f;
+    up->nSources = 4;
+    up->pmap_mode = PM_MODE_MUSIC;
+    up->HFOVoption = HFOV_360;
+    up->aspectRatioOption = ASPECT_RATIO_2_1;
+    up->chOrdering = CH_ACN;
+    up->norm = NORM_N3D;
+    up->enablePeakSearch = 0;
+    saf_paramBlock_publish(pData->hUserPars);
+    
+    /* build the codec parameters for the default settings */
+    saf_worker_create(&(pData->hWorker), powermap_codecWorker, (void*)pData);
+    saf_worker_post(pData->hWorker);
 }
 
 void powermap_destroy
@@ -91,10 +98,13 @@ void powermap_destroy
 )
 {
     powermap_data *pData = (powermap_data*)(*phPm);
-    codecPars* pars = pData->pars;
-    int i, t, ch;
+    codecPars* pars, *next;
+    int t, ch;
     
     if (pData != NULL) {
+        /* stop the worker thread first, as it may still be building */
+        saf_worker_destroy(&(pData->hWorker));
+        
         afSTFTfree(pData->hSTFT);
         for (t = 0; t<TIME_SLOTS; t++) {
             for (ch = 0; ch< MAX_NUM_SH_SIGNALS; ch++) {
@@ -105,24 +115,16 @@ void powermap_destroy
         free2d((void**)pData->STFTInputFrameTF, TIME_SLOTS);
         free2d((void**)pData->tempHopFrameTD, MAX_NUM_SH_SIGNALS);
         
-        if(pData->pmap!=NULL)
-            free(pData->pmap);
-        if(pData->prev_pmap!=NULL)
-            free(pData->prev_pmap);
-        for(i=0; i<NUM_DISP_SLOTS; i++)
-            if(pData->pmap_grid[i] !=NULL)
-                free(pData->pmap_grid[i]);
-        if(pars->interp_dirs_deg!=NULL)
-            free(pars->interp_dirs_deg);
-        for(i=0; i<SH_ORDER; i++){
-            if(pars->Y_grid[i] !=NULL)
-                free(pars->Y_grid[i]);
-            if(pars->Y_grid_cmplx[i]!=NULL)
-                free(pars->Y_grid_cmplx[i]);
+        /* codec parameters: current, pending and retired */
+        powermap_freeCodecPars(&(pData->pars));
+        pars = (codecPars*)saf_atomic_exchangep(&(pData->pendingPars), NULL);
+        powermap_freeCodecPars(&pars);
+        for(pars = (codecPars*)pData->retiredPars; pars!=NULL; pars = next){
+            next = pars->next;
+            powermap_freeCodecPars(&pars);
         }
-        if(pars->interp_table!=NULL)
-            free(pars->interp_table);
-        free(pData->pars);
+        saf_paramBlock_destroy(&(pData->hUserPars));
+        saf_profiler_destroy(&(pData->hProf));
         free(pData);
         pData = NULL;
     }
@@ -136,7 +138,7 @@ void powermap_init
 {
     powermap_data *pData = (powermap_data*)(hPm);
     codecPars* pars = pData->pars;
-    int band;
+    int i, band;
     
     pData->fs = sampleRate;
     
@@ -155,14 +157,43 @@ void powermap_init
     
     /* intialise parameters */
     memset(pData->Cx, 0 , MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS*HYBRID_BANDS*sizeof(float_complex));
-    if(pData->prev_pmap!=NULL)
-        memset(pData->prev_pmap, 0, pars->grid_nDirs*sizeof(float));
+    if(pars!=NULL)
+        memset(pars->prev_pmap, 0, pars->grid_nDirs*sizeof(float));
     pData->recalcPmap = 1;
     pData->pmapReady = 0;
     pData->dispSlotIdx = 0;
+    for(i=0; i<3; i++)
+        pData->peaks[i].nPeaks = 0;
 }
 
 
+/* pool task: updates the covariance matrix of one band */
+static void powermap_covarianceTask(void* arg, int band)
+{
+    powermap_frameArgs* frameArgs = (powermap_frameArgs*)arg;
+    powermap_data *pData = (powermap_data*)(frameArgs->hPm);
+    int i, j;
+    float covScale;
+    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
+    float_complex new_Cx[MAX_NUM_SH_SIGNALS][MAX_NUM_SH_SIGNALS];
+    
+    covScale = 1.0f/(float)(MAX_NUM_SH_SIGNALS);
+    cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, MAX_NUM_SH_SIGNALS, MAX_NUM_SH_SIGNALS, TIME_SLOTS, &calpha,
+                pData->SHframeTF[band], TIME_SLOTS,
+                pData->SHframeTF[band], TIME_SLOTS, &cbeta,
+                new_Cx, MAX_NUM_SH_SIGNALS);
+    
+    /* scale with nSH */
+    for(i=0; i<MAX_NUM_SH_SIGNALS; i++)
+        for(j=0; j<MAX_NUM_SH_SIGNALS; j++)
+            new_Cx[i][j] = crmulf(new_Cx[i][j], covScale);
+    
+    /* average over time */
+    for(i=0; i<MAX_NUM_SH_SIGNALS; i++)
+        for(j=0; j<MAX_NUM_SH_SIGNALS; j++)
+            pData->Cx[band][i][j] = ccaddf( crmulf(new_Cx[i][j], 1.0f-frameArgs->covAvgCoeff), crmulf(pData->Cx[band][i][j], frameArgs->covAvgCoeff));
+}
+
 void powermap_analysis
 (
     void  *  const hPm,
@@ -173,41 +204,59 @@ void powermap_analysis
 )
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    codecPars* pars = pData->pars;
+    codecPars* pars, *newPars;
     int i, j, t, n, ch, sample, band, nSH_order, order_band, nSH_maxOrder, maxOrder;
-    float C_grp_trace, covScale, pmapEQ_band;
+    float C_grp_trace, pmapEQ_band;
     int o[SH_ORDER+2];
-    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
-    float_complex new_Cx[MAX_NUM_SH_SIGNALS][MAX_NUM_SH_SIGNALS];
+    powermap_frameArgs frameArgs;
     float_complex* C_grp;
+    POWERMAP_TYPES peakType;
+    peakResults* peaks;
     
     /* local parameters */
-    int analysisOrderPerBand[HYBRID_BANDS];
-    int nSources;
+    const userPars* up;
+    int nSources, enablePeakSearch, recalcPmap;
     float covAvgCoeff, pmapAvgCoeff;
-    float pmapEQ[HYBRID_BANDS];
     NORM_TYPES norm;
     POWERMAP_MODES pmap_mode;
     
-    /* reinitialise if needed */
-    if(pData->reInitAna == 1){
-        pData->reInitAna = 2;  /* indicate init in progress */
-        pData->pmapReady = 0;  /* avoid trying to draw pmap during reinit */
-        powermap_initAna(hPm);
-        pData->reInitAna = 0;  /* indicate init complete */
-        pData->recalcPmap = 1; /* recalculate powermap with new configuration */
+    /* consistent snapshot of the user parameters for this frame */
+    up = (const userPars*)saf_paramBlock_read(pData->hUserPars, USER_PARS_AUDIO);
+    
+    /* pick up newly published codec parameters (see "powermap_codecWorker"), and hand the previous ones back to the
+     * worker thread for freeing */
+    newPars = (codecPars*)saf_atomic_exchangep(&(pData->pendingPars), NULL);
+    if(newPars!=NULL){
+        pData->pmapReady = 0;  /* avoid trying to draw the pmap of the previous configuration */
+        saf_atomic_storep(&(pData->dispPars), NULL);
+        powermap_retireCodecPars(hPm, pData->pars);
+        pData->pars = newPars;
+        saf_atomic_storei(&(pData->recalcPmap), 1); /* recalculate powermap with new configuration */
     }
+    pars = pData->pars;
     
     /* The main processing: */
-    if (nSamples == FRAME_SIZE && (pData->reInitAna == 0) && isPlaying ) {
-        /* copy current parameters to be thread safe */
-        memcpy(analysisOrderPerBand, pData->analysisOrderPerBand, HYBRID_BANDS*sizeof(int));
-        memcpy(pmapEQ, pData->pmapEQ, HYBRID_BANDS*sizeof(float));
-        norm = pData->norm;
-        nSources = pData->nSources;
-        covAvgCoeff = MIN(pData->covAvgCoeff, MAX_COV_AVG_COEFF);
-        pmapAvgCoeff = pData->pmapAvgCoeff;
-        pmap_mode = pData->pmap_mode;
+    if (nSamples == FRAME_SIZE && (pars != NULL) && isPlaying ) {
+        SAF_RT_SCOPE_BEGIN;
+        SAF_PROFILE_BEGIN(pData->hProf, "total");
+        C_grp = pData->C_grp;
+        C_grp_trace = 0.0f;
+        maxOrder = 1;
+        
+        /* parameters for this frame */
+        norm = up->norm;
+        nSources = up->nSources;
+        covAvgCoeff = MIN(up->covAvgCoeff, MAX_COV_AVG_COEFF);
+        pmapAvgCoeff = up->pmapAvgCoeff;
+        pmap_mode = up->pmap_mode;
+        enablePeakSearch = up->enablePeakSearch;
+        recalcPmap = saf_atomic_exchangei(&(pData->recalcPmap), 0);
+        
+        /* the averaged powermap is not meaningful across different modes */
+        if(pmap_mode != pData->prev_pmap_mode){
+            memset(pars->prev_pmap, 0, pars->grid_nDirs*sizeof(float));
+            pData->prev_pmap_mode = pmap_mode;
+        }
         
         /* load intput time-domain data */
         for (i = 0; i < MIN(MAX_NUM_SH_SIGNALS, nInputs); i++)
@@ -229,6 +278,7 @@ void powermap_analysis
         }
         
         /* apply the time-frequency transform */
+        SAF_PROFILE_BEGIN(pData->hProf, "afSTFTforward");
         for (t = 0; t < TIME_SLOTS; t++) {
             for (ch = 0; ch < MAX_NUM_SH_SIGNALS; ch++)
                 for (sample = 0; sample < HOP_SIZE; sample++)
@@ -239,160 +289,196 @@ void powermap_analysis
             for (ch = 0; ch < MAX_NUM_SH_SIGNALS; ch++)
                 for (t = 0; t < TIME_SLOTS; t++)
                     pData->SHframeTF[band][ch][t] = cmplxf(pData->STFTInputFrameTF[t][ch].re[band], pData->STFTInputFrameTF[t][ch].im[band]);
-
-        /* Update covarience matrix per band */
-        covScale = 1.0f/(float)(MAX_NUM_SH_SIGNALS);
-        for(band=0; band<HYBRID_BANDS; band++){
-            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, MAX_NUM_SH_SIGNALS, MAX_NUM_SH_SIGNALS, TIME_SLOTS, &calpha,
-                        pData->SHframeTF[band], TIME_SLOTS,
-                        pData->SHframeTF[band], TIME_SLOTS, &cbeta,
-                        new_Cx, MAX_NUM_SH_SIGNALS);
-
-            /* scale with nSH */
-            for(i=0; i<MAX_NUM_SH_SIGNALS; i++)
-                for(j=0; j<MAX_NUM_SH_SIGNALS; j++)
-                    new_Cx[i][j] = crmulf(new_Cx[i][j], covScale);
-
-            /* average over time */
-            for(i=0; i<MAX_NUM_SH_SIGNALS; i++)
-                for(j=0; j<MAX_NUM_SH_SIGNALS; j++)
-                    pData->Cx[band][i][j] = ccaddf( crmulf(new_Cx[i][j], 1.0f-covAvgCoeff), crmulf(pData->Cx[band][i][j], covAvgCoeff));
-        }
+        SAF_PROFILE_END(pData->hProf, "afSTFTforward");
+
+        /* Update covarience matrix per band; the bands are spread over the thread pool (if any), and are all
+         * complete before they are grouped */
+        SAF_PROFILE_BEGIN(pData->hProf, "covariance");
+        frameArgs.hPm = hPm;
+        frameArgs.covAvgCoeff = covAvgCoeff;
+        saf_pool_run(saf_atomic_loadp(&(pData->hPool)), powermap_covarianceTask, (void*)&frameArgs, HYBRID_BANDS);
         
-        /* update the powermap */
-        if(pData->recalcPmap==1){
-            pData->recalcPmap = 0;
-            pData->pmapReady = 0;
-
+        /* group covarience matrices (required for both the powermap and the peak search) */
+        if(recalcPmap || enablePeakSearch){
             /* determine maximum analysis order */
             maxOrder = 1;
             for(i=0; i<HYBRID_BANDS; i++)
-                maxOrder = MAX(maxOrder, MIN(analysisOrderPerBand[i], SH_ORDER));
+                maxOrder = MAX(maxOrder, MIN(up->analysisOrderPerBand[i], SH_ORDER));
             nSH_maxOrder = (maxOrder+1)*(maxOrder+1);
-
-            /* group covarience matrices */
-            C_grp = calloc(MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS, sizeof(float_complex));
+            
+            memset(C_grp, 0, nSH_maxOrder*nSH_maxOrder*sizeof(float_complex));
             for (band=0; band<HYBRID_BANDS; band++){
-                order_band = MAX(MIN(pData->analysisOrderPerBand[band], SH_ORDER),1);
+                order_band = MAX(MIN(up->analysisOrderPerBand[band], SH_ORDER),1);
                 nSH_order = (order_band+1)*(order_band+1);
-                pmapEQ_band = MIN(MAX(pmapEQ[band], 0.0f), 2.0f);
+                pmapEQ_band = MIN(MAX(up->pmapEQ[band], 0.0f), 2.0f);
                 for(i=0; i<nSH_order; i++)
                     for(j=0; j<nSH_order; j++)
                         C_grp[i*nSH_maxOrder+j] = ccaddf(C_grp[i*nSH_maxOrder+j], crmulf(pData->Cx[band][i][j], 1e4f*pmapEQ_band));
             }
-
-            /* generate powermap */
             C_grp_trace = 0.0f;
             for(i=0; i<nSH_maxOrder; i++)
                 C_grp_trace+=crealf(C_grp[i*nSH_maxOrder+ i]);
+        }
+        SAF_PROFILE_END(pData->hProf, "covariance");
+        
+        /* find the powermap peaks, coarse-to-fine (cheap enough to do every frame) */
+        SAF_PROFILE_BEGIN(pData->hProf, "peakSearch");
+        if(enablePeakSearch){
+            switch(pmap_mode){
+                default:
+                case PM_MODE_PWD:         peakType = PMAP_PWD;   break;
+                case PM_MODE_MVDR:
+                case PM_MODE_CROPAC_LCMV: peakType = PMAP_MVDR;  break;
+                case PM_MODE_MUSIC:
+                case PM_MODE_MUSIC_LOG:
+                case PM_MODE_MINNORM:
+                case PM_MODE_MINNORM_LOG: peakType = PMAP_MUSIC; break;
+            }
+            peaks = &(pData->peaks[pData->peaksBack]);
+            if(C_grp_trace>1e-8f)
+                findPowermapPeaks(pars->hGrid, peakType, maxOrder, C_grp, nSources, 8.0f, PEAK_SEARCH_COARSE_LEVEL,
+                                  MIN(MAX(nSources, 1), MAX_NUM_PEAKS), (float*)peaks->dirs_deg, peaks->vals, &(peaks->nPeaks));
+            else
+                peaks->nPeaks = 0;
+            
+            /* publish them; swap the filled back buffer with the middle one (as in "saf_paramBlock_publish") */
+            pData->peaksBack = saf_atomic_exchangei(&(pData->peaksMiddle), pData->peaksBack | PEAKS_NEW_DATA) & ~PEAKS_NEW_DATA;
+        }
+        SAF_PROFILE_END(pData->hProf, "peakSearch");
+        
+        /* update the powermap */
+        SAF_PROFILE_BEGIN(pData->hProf, "powermap");
+        if(recalcPmap){
+            pData->pmapReady = 0;
+
+            /* generate powermap */
             switch(pmap_mode){
                 default:
                 case PM_MODE_PWD:
-                    generatePWDmap(maxOrder, C_grp, pars->Y_grid_cmplx[maxOrder-1], pars->grid_nDirs, pData->pmap);
+                    generatePWDmap(maxOrder, C_grp, pars->Y_grid_cmplx[maxOrder-1], pars->grid_nDirs, pars->hPmapWork, pars->pmap);
                     break;
 
                 case PM_MODE_MVDR:
                     if(C_grp_trace>1e-8f)
-                        generateMVDRmap(maxOrder, C_grp, pars->Y_grid_cmplx[maxOrder-1], pars->grid_nDirs, 8.0f, pData->pmap, NULL);
+                        generateMVDRmap(maxOrder, C_grp, pars->Y_grid_cmplx[maxOrder-1], pars->grid_nDirs, 8.0f, pars->hPmapWork, pars->pmap, NULL);
                     else
-                        memset(pData->pmap, 0, pars->grid_nDirs*sizeof(float));
+                        memset(pars->pmap, 0, pars->grid_nDirs*sizeof(float));
                     break;
 
                 case PM_MODE_CROPAC_LCMV:
                     if(C_grp_trace>1e-8f)
-                        generateCroPaCLCMVmap(maxOrder, C_grp, pars->Y_grid_cmplx[maxOrder-1], pars->grid_nDirs, 8.0f, 0.0f, pData->pmap);
+                        generateCroPaCLCMVmap(maxOrder, C_grp, pars->Y_grid_cmplx[maxOrder-1], pars->grid_nDirs, 8.0f, 0.0f, pars->hPmapWork, pars->pmap);
                     else
-                        memset(pData->pmap, 0, pars->grid_nDirs*sizeof(float));
+                        memset(pars->pmap, 0, pars->grid_nDirs*sizeof(float));
                     break;
 
                 case PM_MODE_MUSIC:
                     if(C_grp_trace>1e-8f)
-                        generateMUSICmap(maxOrder, C_grp, pars->Y_grid_cmplx[maxOrder-1], nSources, pars->grid_nDirs, 0, pData->pmap);
+                        generateMUSICmap(maxOrder, C_grp, pars->Y_grid_cmplx[maxOrder-1], nSources, pars->grid_nDirs, 0, pars->hPmapWork, pars->pmap);
                     else
-                        memset(pData->pmap, 0, pars->grid_nDirs*sizeof(float));
+                        memset(pars->pmap, 0, pars->grid_nDirs*sizeof(float));
                     break;
                     
                 case PM_MODE_MUSIC_LOG:
                     if(C_grp_trace>1e-8f)
-                        generateMUSICmap(maxOrder, C_grp, pars->Y_grid_cmplx[maxOrder-1], nSources, pars->grid_nDirs, 1, pData->pmap);
+                        generateMUSICmap(maxOrder, C_grp, pars->Y_grid_cmplx[maxOrder-1], nSources, pars->grid_nDirs, 1, pars->hPmapWork, pars->pmap);
                     else
-                        memset(pData->pmap, 0, pars->grid_nDirs*sizeof(float));
+                        memset(pars->pmap, 0, pars->grid_nDirs*sizeof(float));
                     break; 
                     
                 case PM_MODE_MINNORM:
                     if(C_grp_trace>1e-8f)
-                        generateMinNormMap(maxOrder, C_grp, pars->Y_grid_cmplx[maxOrder-1], nSources, pars->grid_nDirs, 0, pData->pmap);
+                        generateMinNormMap(maxOrder, C_grp, pars->Y_grid_cmplx[maxOrder-1], nSources, pars->grid_nDirs, 0, pars->hPmapWork, pars->pmap);
                     else
-                        memset(pData->pmap, 0, pars->grid_nDirs*sizeof(float));
+                        memset(pars->pmap, 0, pars->grid_nDirs*sizeof(float));
                     break;
                     
                 case PM_MODE_MINNORM_LOG:
                     if(C_grp_trace>1e-8f)
-                        generateMinNormMap(maxOrder, C_grp, pars->Y_grid_cmplx[maxOrder-1], nSources, pars->grid_nDirs, 1, pData->pmap);
+                        generateMinNormMap(maxOrder, C_grp, pars->Y_grid_cmplx[maxOrder-1], nSources, pars->grid_nDirs, 1, pars->hPmapWork, pars->pmap);
                     else
-                        memset(pData->pmap, 0, pars->grid_nDirs*sizeof(float));
+                        memset(pars->pmap, 0, pars->grid_nDirs*sizeof(float));
                     break;
             }
-             free(C_grp);
             
             /* average powermap over time */
             for(i=0; i<pars->grid_nDirs; i++)
-                pData->pmap[i] =  (1.0f-pmapAvgCoeff) * (pData->pmap[i] )+ pmapAvgCoeff * (pData->prev_pmap[i]);
-            memcpy(pData->prev_pmap,  pData->pmap , pars->grid_nDirs*sizeof(float));
+                pars->pmap[i] =  (1.0f-pmapAvgCoeff) * (pars->pmap[i] )+ pmapAvgCoeff * (pars->prev_pmap[i]);
+            memcpy(pars->prev_pmap,  pars->pmap , pars->grid_nDirs*sizeof(float));
 
             /* interpolate powermap */
             cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, pars->interp_nDirs, 1, pars->grid_nDirs, 1.0f,
                         pars->interp_table, pars->grid_nDirs,
-                        pData->pmap, 1, 0.0f,
-                        pData->pmap_grid[pData->dispSlotIdx], 1);
+                        pars->pmap, 1, 0.0f,
+                        pars->pmap_grid[pData->dispSlotIdx], 1);
 
             /* ascertain minimum and maximum values for powermap colour scaling */
             pData->pmap_grid_minVal = FLT_MAX;
             pData->pmap_grid_maxVal = FLT_MIN;
             for(i=0; i<pars->interp_nDirs; i++){
-                pData->pmap_grid_minVal = pData->pmap_grid[pData->dispSlotIdx][i] < pData->pmap_grid_minVal ? pData->pmap_grid[pData->dispSlotIdx][i] : pData->pmap_grid_minVal;
-                pData->pmap_grid_maxVal = pData->pmap_grid[pData->dispSlotIdx][i] > pData->pmap_grid_maxVal ? pData->pmap_grid[pData->dispSlotIdx][i] : pData->pmap_grid_maxVal;
+                pData->pmap_grid_minVal = pars->pmap_grid[pData->dispSlotIdx][i] < pData->pmap_grid_minVal ? pars->pmap_grid[pData->dispSlotIdx][i] : pData->pmap_grid_minVal;
+                pData->pmap_grid_maxVal = pars->pmap_grid[pData->dispSlotIdx][i] > pData->pmap_grid_maxVal ? pars->pmap_grid[pData->dispSlotIdx][i] : pData->pmap_grid_maxVal;
             }
 
             /* normalise the powermap to 0..1 */
             for(i=0; i<pars->interp_nDirs; i++)
-                pData->pmap_grid[pData->dispSlotIdx][i] = (pData->pmap_grid[pData->dispSlotIdx][i]-pData->pmap_grid_minVal)/(pData->pmap_grid_maxVal-pData->pmap_grid_minVal+1e-11f);
+                pars->pmap_grid[pData->dispSlotIdx][i] = (pars->pmap_grid[pData->dispSlotIdx][i]-pData->pmap_grid_minVal)/(pData->pmap_grid_maxVal-pData->pmap_grid_minVal+1e-11f);
 
             /* signify that the powermap in current slot is ready for plotting */
             pData->dispSlotIdx++;
             if(pData->dispSlotIdx>=NUM_DISP_SLOTS)
                 pData->dispSlotIdx = 0;
+            saf_atomic_storep(&(pData->dispPars), (void*)pars);
             pData->pmapReady = 1;
         }
+        SAF_PROFILE_END(pData->hProf, "powermap");
+        SAF_PROFILE_END(pData->hProf, "total");
+        SAF_RT_SCOPE_END;
     }
 }
 
+void powermap_waitForCodecInit(void* const hPm)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    saf_worker_wait(pData->hWorker);
+}
+
 /* SETS */
 
+void powermap_setThreadPool(void* const hPm, void* const hPool)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    saf_atomic_storep(&(pData->hPool), hPool);
+}
+
 void powermap_setPowermapMode(void* const hPm, int newMode)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    codecPars* pars = pData->pars;
-    pData->pmap_mode = (POWERMAP_MODES)newMode;
-    if(pData->prev_pmap!=NULL)
-        memset(pData->prev_pmap, 0, pars->grid_nDirs*sizeof(float));
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->pmap_mode = (POWERMAP_MODES)newMode;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void powermap_setCovAvgCoeff(void* const hPm, float newAvg)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    pData->covAvgCoeff = MIN(MAX(0.0f, newAvg), 0.99999999f);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->covAvgCoeff = MIN(MAX(0.0f, newAvg), 0.99999999f);
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void powermap_setNumSources(void* const hPm, int newValue)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    pData->nSources = newValue;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->nSources = newValue;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void powermap_setSourcePreset(void* const hPm, int newPresetID)
 {
     powermap_data *pData = (powermap_data*)(hPm);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
     int band, rangeIdx, curOrder, reverse;
 
     rangeIdx = 0;
@@ -402,7 +488,7 @@ void powermap_setSourcePreset(void* const hPm, int newPresetID)
         case MIC_PRESET_IDEAL:
             /* Ideal SH should have maximum order per frequency */
             for(band=0; band<HYBRID_BANDS; band++)
-                pData->analysisOrderPerBand[band] = SH_ORDER;
+                up->analysisOrderPerBand[band] = SH_ORDER;
             break;
             
             /* In the case of real microphone arrays, the analysis order should be frequency dependent
@@ -420,9 +506,9 @@ void powermap_setSourcePreset(void* const hPm, int newPresetID)
                         rangeIdx++;
                     }
                 }
-                pData->analysisOrderPerBand[band] = MIN(SH_ORDER,curOrder);
+                up->analysisOrderPerBand[band] = MIN(SH_ORDER,curOrder);
                 if(pData->freqVector[band] > __Zylia_freqRange[(__Zylia_maxOrder-1)*2 - 1])
-                    pData->pmapEQ[band] = 0.0f;
+                    up->pmapEQ[band] = 0.0f;
             }
             break;
 #endif
@@ -439,9 +525,9 @@ void powermap_setSourcePreset(void* const hPm, int newPresetID)
                         rangeIdx++;
                     }
                 }
-                pData->analysisOrderPerBand[band] = MIN(SH_ORDER,curOrder);
+                up->analysisOrderPerBand[band] = MIN(SH_ORDER,curOrder);
                 if(pData->freqVector[band] > __Eigenmike32_freqRange[(__Eigenmike32_maxOrder-1)*2 - 1])
-                    pData->pmapEQ[band] = 0.0f;
+                    up->pmapEQ[band] = 0.0f;
             }
             break;
 #endif
@@ -458,85 +544,116 @@ void powermap_setSourcePreset(void* const hPm, int newPresetID)
                         rangeIdx++;
                     }
                 }
-                pData->analysisOrderPerBand[band] = MIN(SH_ORDER,curOrder);
+                up->analysisOrderPerBand[band] = MIN(SH_ORDER,curOrder);
                 if(pData->freqVector[band] > __DTU_mic_freqRange[(__DTU_mic_maxOrder-1)*2 - 1])
-                    pData->pmapEQ[band] = 0.0f;
+                    up->pmapEQ[band] = 0.0f;
             }
             break;
 #endif
     }
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void powermap_setAnaOrder(void  * const hPm, int newValue, int bandIdx)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    pData->analysisOrderPerBand[bandIdx] = MIN(MAX(newValue,1), SH_ORDER);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->analysisOrderPerBand[bandIdx] = MIN(MAX(newValue,1), SH_ORDER);
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void powermap_setAnaOrderAllBands(void  * const hPm, int newValue)
 {
     powermap_data *pData = (powermap_data*)(hPm);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
     int band;
 
     for(band=0; band<HYBRID_BANDS; band++)
-        pData->analysisOrderPerBand[band] = MIN(MAX(newValue,1), SH_ORDER);
+        up->analysisOrderPerBand[band] = MIN(MAX(newValue,1), SH_ORDER);
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void powermap_setPowermapEQ(void  * const hPm, float newValue, int bandIdx)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    pData->pmapEQ[bandIdx] = newValue;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->pmapEQ[bandIdx] = newValue;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void powermap_setPowermapEQAllBands(void  * const hPm, float newValue)
 {
     powermap_data *pData = (powermap_data*)(hPm);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
     int band;
     
     for(band=0; band<HYBRID_BANDS; band++)
-        pData->pmapEQ[band] = newValue;
+        up->pmapEQ[band] = newValue;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void powermap_setChOrder(void* const hPm, int newOrder)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    pData->chOrdering = (CH_ORDER)newOrder;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->chOrdering = (CH_ORDER)newOrder;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void powermap_setNormType(void* const hPm, int newType)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    pData->norm = (NORM_TYPES)newType;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->norm = (NORM_TYPES)newType;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void powermap_setDispFOV(void* const hPm, int newOption)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    pData->HFOVoption = (HFOV_OPTIONS)newOption;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->HFOVoption = (HFOV_OPTIONS)newOption;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void powermap_setAspectRatio(void* const hPm, int newOption)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    pData->aspectRatioOption = (ASPECT_RATIO_OPTIONS)newOption;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->aspectRatioOption = (ASPECT_RATIO_OPTIONS)newOption;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void powermap_setPowermapAvgCoeff(void* const hPm, float newValue)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    pData->pmapAvgCoeff = MIN(MAX(0.0f, newValue), 0.99999999f);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->pmapAvgCoeff = MIN(MAX(0.0f, newValue), 0.99999999f);
+    saf_paramBlock_publish(pData->hUserPars);
+}
+
+void powermap_setPeakSearch(void* const hPm, int newState)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->enablePeakSearch = newState;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void powermap_requestPmapUpdate(void* const hPm)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    pData->recalcPmap = 1;
+    saf_paramBlock_edit(pData->hUserPars);
+    saf_paramBlock_publish(pData->hUserPars); /* passes on any edits made via the EQ/order handles */
+    saf_atomic_storei(&(pData->recalcPmap), 1);
 }
 
 void powermap_refreshSettings(void* const hPm)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    pData->reInitAna = 1;
+    saf_paramBlock_edit(pData->hUserPars);
+    saf_paramBlock_publish(pData->hUserPars);
+    powermap_requestAnaInit(hPm);
 }
 
 
@@ -545,7 +662,8 @@ void powermap_refreshSettings(void* const hPm)
 int powermap_getPowermapMode(void* const hPm)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    return (int)pData->pmap_mode;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->pmap_mode;
 }
 
 float powermap_getSamplingRate(void* const hPm)
@@ -557,19 +675,22 @@ float powermap_getSamplingRate(void* const hPm)
 float powermap_getCovAvgCoeff(void* const hPm)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    return pData->covAvgCoeff;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->covAvgCoeff;
 }
 
 float powermap_getPowermapEQ(void  * const hPm, int bandIdx)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    return pData->pmapEQ[bandIdx];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->pmapEQ[bandIdx];
 }
 
 float powermap_getPowermapEQAllBands(void  * const hPm)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    return pData->pmapEQ[0];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->pmapEQ[0];
 }
 
 void powermap_getPowermapEQHandle
@@ -581,21 +702,25 @@ void powermap_getPowermapEQHandle
 )
 {
     powermap_data *pData = (powermap_data*)(hPm);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
     (*pX_vector) = &(pData->freqVector[0]);
-    (*pY_values) = &(pData->pmapEQ[0]);
+    (*pY_values) = &(up->pmapEQ[0]);
     (*pNpoints) = HYBRID_BANDS;
+    saf_paramBlock_release(pData->hUserPars);
 }
 
 int powermap_getAnaOrder(void  * const hPm, int bandIdx)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    return pData->analysisOrderPerBand[bandIdx];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->analysisOrderPerBand[bandIdx];
 }
 
 int powermap_getAnaOrderAllBands(void  * const hPm)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    return pData->analysisOrderPerBand[0];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->analysisOrderPerBand[0];
 }
 
 void powermap_getAnaOrderHandle
@@ -607,9 +732,11 @@ void powermap_getAnaOrderHandle
 )
 {
     powermap_data *pData = (powermap_data*)(hPm);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
     (*pX_vector) = &(pData->freqVector[0]);
-    (*pY_values) = &(pData->analysisOrderPerBand[0]);
+    (*pY_values) = &(up->analysisOrderPerBand[0]);
     (*pNpoints) = HYBRID_BANDS;
+    saf_paramBlock_release(pData->hUserPars);
 }
 
 int powermap_getNumberOfBands(void)
@@ -620,62 +747,98 @@ int powermap_getNumberOfBands(void)
 int powermap_getChOrder(void* const hPm)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    return (int)pData->chOrdering;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->chOrdering;
 }
 
 int powermap_getNormType(void* const hPm)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    return (int)pData->norm;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->norm;
 }
 
 int powermap_getNumSources(void* const hPm)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    return pData->nSources;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->nSources;
 }
 
 int powermap_getDispFOV(void* const hPm)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    return (int)pData->HFOVoption;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->HFOVoption;
 }
 
 int powermap_getAspectRatio(void* const hPm)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    return (int)pData->aspectRatioOption;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->aspectRatioOption;
 }
 
 float powermap_getPowermapAvgCoeff(void* const hPm)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    return pData->pmapAvgCoeff;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->pmapAvgCoeff;
+}
+
+int powermap_getPeakSearch(void* const hPm)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->enablePeakSearch;
+}
+
+int powermap_getPeaks(void* const hPm, float** peak_dirs_deg, float** peak_vals)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    const peakResults* peaks;
+    
+    /* pick up the peaks most recently published by the audio thread, if they have not been already; the buffer is then
+     * held (and left untouched by the audio thread) until the next call */
+    if(saf_atomic_loadi(&(pData->peaksMiddle)) & PEAKS_NEW_DATA)
+        pData->peaksFront = saf_atomic_exchangei(&(pData->peaksMiddle), pData->peaksFront) & ~PEAKS_NEW_DATA;
+    peaks = &(pData->peaks[pData->peaksFront]);
+    (*peak_dirs_deg) = (float*)peaks->dirs_deg;
+    (*peak_vals) = (float*)peaks->vals;
+    return up->enablePeakSearch ? peaks->nPeaks : 0;
 }
 
 int powermap_getPmap(void* const hPm, float** grid_dirs, float** pmap, int* nDirs,int* pmapWidth, int* hfov, int* aspectRatio) //TODO: hfov and aspectRatio should be float, if 16:9 etc options are added
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    codecPars* pars = pData->pars;
-    if((pData->reInitAna == 0) && pData->pmapReady){
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    codecPars* pars = (codecPars*)saf_atomic_loadp(&(pData->dispPars));
+    if((pars != NULL) && pData->pmapReady){
         (*grid_dirs) = pars->interp_dirs_deg;
-        (*pmap) = pData->pmap_grid[pData->dispSlotIdx-1 < 0 ? NUM_DISP_SLOTS-1 : pData->dispSlotIdx-1];
+        (*pmap) = pars->pmap_grid[pData->dispSlotIdx-1 < 0 ? NUM_DISP_SLOTS-1 : pData->dispSlotIdx-1];
         (*nDirs) = pars->interp_nDirs;
         (*pmapWidth) = pData->dispWidth;
-        switch(pData->HFOVoption){
+        switch(up->HFOVoption){
             default:
             case HFOV_360:
                 (*hfov) = 360;
                 break;
         }
-        switch(pData->aspectRatioOption){
+        switch(up->aspectRatioOption){
             default:
             case ASPECT_RATIO_2_1:
                 (*aspectRatio) = 2;
                 break;
         }
     }
-    return pData->pmapReady;
+    return pars != NULL ? pData->pmapReady : 0;
+}
+
+void* powermap_getProfiler(void* const hPm)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    return pData->hProf;
 }
 
 
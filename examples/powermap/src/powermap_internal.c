@@ -26,12 +26,83 @@
 
 #include "powermap.h"
 #include "powermap_internal.h"
-#include "powermap_database.h"
 
-void powermap_initAna(void* const hPm)
+void powermap_requestAnaInit(void* const hPm)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    
+    saf_atomic_storei(&(pData->reInitAna), 1);
+    saf_worker_post(pData->hWorker);
+}
+
+void powermap_codecWorker(void* hPm)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    const userPars* up;
+    codecPars* pars, *next;
+    
+    saf_atomic_storei(&(pData->reInitAna), 2);
+    
+    /* free the codec parameters the audio thread is no longer using */
+    pars = (codecPars*)saf_atomic_exchangep(&(pData->retiredPars), NULL);
+    for(; pars!=NULL; pars = next){
+        next = pars->next;
+        powermap_freeCodecPars(&pars);
+    }
+    
+    /* build fresh codec parameters for a snapshot of the current configuration */
+    up = (const userPars*)saf_paramBlock_read(pData->hUserPars, USER_PARS_WORKER);
+    pars = (codecPars*)calloc(1, sizeof(codecPars));
+    powermap_initAna(hPm, pars, up);
+    
+    /* publish them; if the audio thread never picked up the previously published ones, they are not needed anymore */
+    pars = (codecPars*)saf_atomic_exchangep(&(pData->pendingPars), (void*)pars);
+    powermap_freeCodecPars(&pars);
+    
+    /* done, unless another reinitialisation has been requested in the meantime */
+    saf_atomic_casi(&(pData->reInitAna), 2, 0);
+}
+
+void powermap_freeCodecPars(codecPars** const ppars)
+{
+    codecPars* pars = *ppars;
+    int i;
+    
+    if(pars!=NULL){
+        free(pars->interp_dirs_deg);
+        for(i=0; i<SH_ORDER; i++){
+            free(pars->Y_grid[i]);
+            free(pars->Y_grid_cmplx[i]);
+        }
+        free(pars->interp_table);
+        hierarchicalGrid_destroy(&(pars->hGrid));
+        powermapWorkspace_destroy(&(pars->hPmapWork));
+        free(pars->pmap);
+        free(pars->prev_pmap);
+        for(i=0; i<NUM_DISP_SLOTS; i++)
+            free(pars->pmap_grid[i]);
+        free(pars);
+        *ppars = NULL;
+    }
+}
+
+void powermap_retireCodecPars(void* const hPm, codecPars* const pars)
+{
+    powermap_data *pData = (powermap_data*)(hPm);
+    void* head;
+    
+    if(pars==NULL)
+        return;
+    /* lock-free push; the worker thread only ever takes the whole list at once, so there is no ABA problem */
+    do{
+        head = saf_atomic_loadp(&(pData->retiredPars));
+        pars->next = (codecPars*)head;
+    } while(!saf_atomic_casp(&(pData->retiredPars), head, (void*)pars));
+}
+
+void powermap_initAna(void* const hPm, codecPars* const pars, const userPars* up)
 {
     powermap_data *pData = (powermap_data*)(hPm);
-    codecPars* pars = pData->pars;
     int i, j, n, N_azi, N_ele, nSH_order;
     float scaleY, hfov, vfov, fi, aspectRatio;
     float* Y_grid_N, *grid_x_axis, *grid_y_axis;
@@ -45,8 +116,6 @@ void powermap_initAna(void* const hPm)
     for(n=1; n<=SH_ORDER; n++){
         nSH_order = (n+1)*(n+1);
         scaleY = 1.0f/(float)nSH_order;
-        free(pars->Y_grid[n-1]);
-        free(pars->Y_grid_cmplx[n-1]);
         pars->Y_grid[n-1] = malloc(nSH_order * (pars->grid_nDirs)*sizeof(float));
         pars->Y_grid_cmplx[n-1] = malloc(nSH_order * (pars->grid_nDirs)*sizeof(float_complex));
         memcpy(pars->Y_grid[n-1], Y_grid_N, nSH_order * (pars->grid_nDirs)*sizeof(float));
@@ -56,12 +125,16 @@ void powermap_initAna(void* const hPm)
                 pars->Y_grid_cmplx[n-1][i*(pars->grid_nDirs)+j] = cmplxf(pars->Y_grid[n-1][i*(pars->grid_nDirs)+j], 0.0f);
     }
 
+    /* hierarchical grid for the peak search (independent of the display settings) */
+    hierarchicalGrid_create(&(pars->hGrid), NUM_PEAK_GRID_LEVELS, SH_ORDER);
+    powermapWorkspace_create(&(pars->hPmapWork), SH_ORDER, pars->grid_nDirs);
+    
     /* generate interpolation table for current display settings */
-    switch(pData->HFOVoption){
+    switch(up->HFOVoption){
         default:
         case HFOV_360: hfov = 360.0f; break;
     }
-    switch(pData->aspectRatioOption){
+    switch(up->aspectRatioOption){
         default:
         case ASPECT_RATIO_2_1: aspectRatio = 2.0f; break;
     }
@@ -74,7 +147,6 @@ void powermap_initAna(void* const hPm)
         grid_x_axis[i] = fi;
     for(fi = -vfov/2.0f,  i = 0; i<N_ele; fi+=vfov/N_ele, i++)
         grid_y_axis[i] = fi;
-    free(pars->interp_dirs_deg);
     pars->interp_dirs_deg = malloc(N_azi*N_ele*2*sizeof(float));
     for(i = 0; i<N_ele; i++){
         for(j=0; j<N_azi; j++){
@@ -82,19 +154,14 @@ void powermap_initAna(void* const hPm)
             pars->interp_dirs_deg[(i*N_azi + j)*2+1] = grid_y_axis[i];
         }
     }
-    free(pars->interp_table);
     generateVBAPgainTable3D_srcs(pars->interp_dirs_deg, N_azi*N_ele, pars->grid_dirs_deg, pars->grid_nDirs, 0, 0, &(pars->interp_table), &(pars->interp_nDirs), &(pars->interp_nTri));
     VBAPgainTable2InterpTable(pars->interp_table, pars->interp_nDirs, pars->grid_nDirs);
     
-    /* reallocate memory for storing the powermaps */
-    free(pData->pmap);
-    pData->pmap = malloc(pars->grid_nDirs*sizeof(float));
-    free(pData->prev_pmap);
-    pData->prev_pmap = calloc(pars->grid_nDirs, sizeof(float));
-    for(i=0; i<NUM_DISP_SLOTS; i++){
-        free(pData->pmap_grid[i]);
-        pData->pmap_grid[i] = calloc(pars->interp_nDirs,sizeof(float));
-    }
+    /* allocate memory for storing the powermaps */
+    pars->pmap = malloc(pars->grid_nDirs*sizeof(float));
+    pars->prev_pmap = calloc(pars->grid_nDirs, sizeof(float));
+    for(i=0; i<NUM_DISP_SLOTS; i++)
+        pars->pmap_grid[i] = calloc(pars->interp_nDirs,sizeof(float));
     
     free(Y_grid_N);
     free(grid_x_axis);
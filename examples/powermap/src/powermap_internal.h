@@ -32,7 +32,6 @@
 #include <string.h>
 #include <float.h>
 #include "powermap.h"
-#include "powermap_database.h"
 #define SAF_ENABLE_AFSTFT /* for time-frequency transform */
 #define SAF_ENABLE_SH     /* for spherical harmonic weights */
 #define SAF_ENABLE_VBAP   /* for vbap-based interpolation tables */
@@ -52,12 +51,35 @@ extern "C" {
 #define MAX_NUM_SH_SIGNALS ( (SH_ORDER+1)*(SH_ORDER+1) )
 #define NUM_DISP_SLOTS ( 2 )
 #define MAX_COV_AVG_COEFF ( 0.45f )                         /*  */
+#define NUM_PEAK_GRID_LEVELS ( 5 )                          /* hierarchical grid levels; finest: 2562 points */
+#define PEAK_SEARCH_COARSE_LEVEL ( 2 )                      /* coarse level (162 points) used to initialise the peak search */
+#define MAX_NUM_PEAKS ( PMAP_PEAKS_MAX_CANDIDATES )         /* maximum number of peaks to search for */
+#define USER_PARS_AUDIO ( 0 )                               /* parameter block reader index of the audio thread */
+#define USER_PARS_WORKER ( 1 )                              /* parameter block reader index of the worker thread */
+#define PEAKS_NEW_DATA ( 4 )                                /* set in "peaksMiddle" when it holds peaks not yet picked up */
     
     
 /***********/
 /* Structs */
 /***********/
     
+/* user parameters; edited by the set functions and passed on to the audio thread via a parameter block */
+typedef struct _userPars
+{
+    int analysisOrderPerBand[HYBRID_BANDS];
+    float pmapEQ[HYBRID_BANDS];
+    HFOV_OPTIONS HFOVoption;
+    ASPECT_RATIO_OPTIONS aspectRatioOption;
+    float covAvgCoeff;
+    float pmapAvgCoeff;
+    int nSources;
+    POWERMAP_MODES pmap_mode;
+    CH_ORDER chOrdering;
+    NORM_TYPES norm;
+    int enablePeakSearch;
+    
+}userPars;
+    
 typedef struct _codecPars
 {
     float* grid_dirs_deg; /* grid_nDirs x 2 */
@@ -70,8 +92,26 @@ typedef struct _codecPars
     float* Y_grid[SH_ORDER];                 /* MAX_NUM_SH_SIGNALS x grid_nDirs */
     float_complex* Y_grid_cmplx[SH_ORDER];   /* MAX_NUM_SH_SIGNALS x grid_nDirs */
     
+    void* hGrid;                             /* hierarchical grid for the peak search */
+    void* hPmapWork;                         /* powermap workspace, so that the maps are generated without allocating */
+    
+    float* pmap;                             /* grid_nDirs x 1 */
+    float* prev_pmap;                        /* grid_nDirs x 1 */
+    float* pmap_grid[NUM_DISP_SLOTS];        /* powermap interpolated to grid; interp_nDirs x 1 */
+    
+    struct _codecPars* next;                 /* next entry in the list of retired codec parameters */
+    
 }codecPars;
     
+/* peaks found in one frame */
+typedef struct _peakResults
+{
+    float dirs_deg[MAX_NUM_PEAKS][2];      /* peak directions, in degrees */
+    float vals[MAX_NUM_PEAKS];             /* corresponding powermap values */
+    int nPeaks;                            /* number of peaks found */
+    
+} peakResults;
+
 typedef struct _powermap
 {
     /* TFT */
@@ -85,43 +125,67 @@ typedef struct _powermap
     
     /* internal */
     float_complex Cx[HYBRID_BANDS][MAX_NUM_SH_SIGNALS][MAX_NUM_SH_SIGNALS];     /* cov matrices */ 
-    int reInitAna; /* 0: no init required, 1: init required, 2: init in progress */
+    float_complex C_grp[MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS];                /* grouped cov matrix; FLAT: nSH x nSH */
+    volatile int reInitAna; /* 0: no init required, 1: init required, 2: init in progress (on the worker thread) */
     int dispWidth;
     
     /* ana configuration */
-    codecPars* pars;                                          /* codec parameters */
+    codecPars* pars;                       /* codec parameters currently used for the analysis (audio thread only) */
+    void* volatile pendingPars;            /* new codec parameters published by the worker thread (codecPars*) */
+    void* volatile retiredPars;            /* codec parameters no longer used by the audio thread, freed by the worker thread (codecPars*) */
+    void* hWorker;                         /* worker thread, which (re)initialises the codec parameters */
     
     /* display */
-    float* pmap;                           /* grid_nDirs x 1 */
-    float* prev_pmap;                      /* grid_nDirs x 1 */
-    float* pmap_grid[NUM_DISP_SLOTS];      /* powermap interpolated to grid; interp_nDirs x 1 */
+    void* volatile dispPars;               /* codec parameters holding the powermap that is ready for plotting (codecPars*) */
     int dispSlotIdx;
     float pmap_grid_minVal;
     float pmap_grid_maxVal;
-    int recalcPmap;   /* set this to 1 to generate a new powermap */
+    volatile int recalcPmap; /* set this to 1 to generate a new powermap */
     int pmapReady;    /* 0: powermap not started yet, 1: powermap is ready for plotting*/
+    peakResults peaks[3];                  /* triple buffer of the peaks found by the audio thread (see "powermap_getPeaks") */
+    int peaksBack;                         /* buffer the audio thread writes the peaks of a frame to (audio thread) */
+    volatile int peaksMiddle;              /* buffer most recently published by the audio thread (| PEAKS_NEW_DATA) */
+    int peaksFront;                        /* buffer held by "powermap_getPeaks" until its next call */
+    POWERMAP_MODES prev_pmap_mode;         /* mode used to compute "prev_pmap" (audio thread) */
     
     /* User parameters */
-    int analysisOrderPerBand[HYBRID_BANDS];
-    float pmapEQ[HYBRID_BANDS]; 
-    HFOV_OPTIONS HFOVoption; 
-    ASPECT_RATIO_OPTIONS aspectRatioOption;
-    float covAvgCoeff;
-    float pmapAvgCoeff;
-    int nSources;
-    POWERMAP_MODES pmap_mode;
-    CH_ORDER chOrdering;
-    NORM_TYPES norm;
+    void* hUserPars;                       /* parameter block of "userPars" */
+    void* hProf;                           /* per-stage timing of the processing loop (see saf_profiler.h) */
+    void* volatile hPool;                  /* thread pool for updating the bands in parallel (see saf_threads.h); NULL: none */
     
 } powermap_data;
 
+/* arguments of the band-parallel covariance update of one frame (see "powermap_analysis") */
+typedef struct _powermap_frameArgs
+{
+    void* hPm;                             /* powermap handle */
+    float covAvgCoeff;                     /* covariance averaging coefficient of this frame */
+    
+} powermap_frameArgs;
+
 
 /**********************/
 /* Internal functions */
 /**********************/
 
+/* Flags the codec parameters for reinitialisation, which is carried out on the worker thread. Not for the audio thread */
+void powermap_requestAnaInit(void* const hPm);    /* handle for powermap */
+
+/* Worker thread job: builds a fresh set of codec parameters for the current configuration and publishes them to the
+ * audio thread. Also frees any codec parameters the audio thread has since retired */
+void powermap_codecWorker(void* hPm);             /* handle for powermap */
+
+/* Frees a set of codec parameters */
+void powermap_freeCodecPars(codecPars** const ppars); /* & address of codec parameters */
+
+/* Hands codec parameters no longer in use over to the worker thread for freeing; lock-free, for the audio thread */
+void powermap_retireCodecPars(void* const hPm,    /* handle for powermap */
+                              codecPars* const pars); /* codec parameters to retire */
+
 /* generates spherical harmonic steering vectors and interpolation tables etc. */
-void powermap_initAna(void* const hPm);           /* handle for powermap */
+void powermap_initAna(void* const hPm,            /* handle for powermap */
+                      codecPars* const pars,      /* codec parameters to initialise (freshly allocated) */
+                      const userPars* up);        /* user parameters snapshot */
 
     
 #ifdef __cplusplus
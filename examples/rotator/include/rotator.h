@@ -113,6 +113,13 @@ int rotator_getChOrder(void* const hRot);
 int rotator_getNormType(void* const hRot);
 
 int rotator_getOrder(void* const hRot);
+
+/* returns the processing delay in samples (one frame, since the rotation is applied to the previous frame, in order to
+ * interpolate between the previous and current rotation matrices) */
+int rotator_getProcessingDelay(void);
+
+/* returns the profiler handle, for "saf_profiler_getStats" (NULL, unless built with SAF_ENABLE_PROFILER) */
+void* rotator_getProfiler(void* const hRot);
     
 #ifdef __cplusplus
 }
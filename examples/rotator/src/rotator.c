@@ -35,16 +35,21 @@ void rotator_create
     rotator_data* pData = (rotator_data*)malloc(sizeof(rotator_data));
     if (pData == NULL) { return;/*error*/ }
     *phRot = (void*)pData;
+    saf_profiler_create(&(pData->hProf));
+    userPars* up;
   
     /* Default user parameters */
-    pData->yaw = 0.0f;
-    pData->pitch = 0.0f;
-    pData->roll = 0.0f;
-    pData->bFlipYaw = 0;
-    pData->bFlipPitch = 0;
-    pData->bFlipRoll = 0;
-    pData->chOrdering = CH_ACN;
-    pData->norm = NORM_N3D;
+    saf_paramBlock_create(&(pData->hUserPars), sizeof(userPars), 1);
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->yaw = 0.0f;
+    up->pitch = 0.0f;
+    up->roll = 0.0f;
+    up->bFlipYaw = 0;
+    up->bFlipPitch = 0;
+    up->bFlipRoll = 0;
+    up->chOrdering = CH_ACN;
+    up->norm = NORM_N3D;
+    saf_paramBlock_publish(pData->hUserPars);
     rotator_setOrder(*phRot,  OUTPUT_ORDER_FIRST);
 }
 
@@ -57,6 +62,8 @@ void rotator_destroy
     rotator_data *pData = (rotator_data*)(*phRot);
 
     if (pData != NULL) {
+        saf_paramBlock_destroy(&(pData->hUserPars));
+        saf_profiler_destroy(&(pData->hProf));
         free(pData);
         pData = NULL;
     }
@@ -93,19 +100,24 @@ void rotator_process
 )
 {
     rotator_data *pData = (rotator_data*)(hRot);
+    const userPars* up;
     int i, j, n, order, nSH;
     int o[MAX_SH_ORDER+2];
     float Rxyz[3][3];
-    float* M_rot_tmp;
     CH_ORDER chOrdering;
     NORM_TYPES norm;
  
+    /* consistent snapshot of the user parameters for this frame */
+    up = (const userPars*)saf_paramBlock_read(pData->hUserPars, USER_PARS_AUDIO);
+    
     if (nSamples == FRAME_SIZE && isPlaying) {
+        SAF_RT_SCOPE_BEGIN;
+        SAF_PROFILE_BEGIN(pData->hProf, "total");
         /* prep */
         for(n=0; n<MAX_SH_ORDER+2; n++){  o[n] = n*n;  }
-        chOrdering = pData->chOrdering;
-        norm = pData->norm;
-        order = pData->order;
+        chOrdering = up->chOrdering;
+        norm = up->norm;
+        order = up->order;
         nSH = (order+1)*(order+1);
         for (i = 0; i < MIN(nSH, nInputs); i++)
             memcpy(pData->inputFrameTD[i], inputs[i], FRAME_SIZE * sizeof(float));
@@ -126,15 +138,14 @@ void rotator_process
                 break;
         }
         
+        SAF_PROFILE_BEGIN(pData->hProf, "rotation");
         if (order>0){
             /* calculate rotation matrix */
-            M_rot_tmp = malloc(nSH*nSH*sizeof(float));
-            yawPitchRoll2Rzyx (pData->yaw, pData->pitch, pData->roll, Rxyz);
-            getSHrotMtxReal(Rxyz, M_rot_tmp, order);
+            yawPitchRoll2Rzyx (up->yaw, up->pitch, up->roll, Rxyz);
+            getSHrotMtxReal(Rxyz, pData->M_rot_tmp, order);
             for(i=0; i<nSH; i++)
                 for(j=0; j<nSH; j++)
-                    pData->M_rot[i][j] = M_rot_tmp[i*nSH+j];
-            free(M_rot_tmp);
+                    pData->M_rot[i][j] = pData->M_rot_tmp[i*nSH+j];
             
             /* apply rotation (assumes ACN/N3D) */
             cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, FRAME_SIZE, nSH, 1.0f,
@@ -154,8 +165,12 @@ void rotator_process
             for(i=0; i<nSH; i++)
                 memcpy(pData->prev_M_rot[i], pData->M_rot[i], nSH*sizeof(float));
         }
-        else
-            memcpy(pData->outputFrameTD[0], pData->inputFrameTD[0], FRAME_SIZE*sizeof(float));
+        else{
+            /* (delayed by one frame too, so that the processing delay does not depend on the order) */
+            memcpy(pData->outputFrameTD[0], pData->prev_inputFrameTD[0], FRAME_SIZE*sizeof(float));
+            memcpy(pData->prev_inputFrameTD[0], pData->inputFrameTD[0], FRAME_SIZE*sizeof(float));
+        }
+        SAF_PROFILE_END(pData->hProf, "rotation");
         
         /* account for norm scheme */
         switch(norm){
@@ -174,6 +189,8 @@ void rotator_process
             memcpy(outputs[i], pData->outputFrameTD[i], FRAME_SIZE*sizeof(float));
         for (; i < nOutputs; i++)
             memset(outputs[i], 0, FRAME_SIZE*sizeof(float));
+        SAF_PROFILE_END(pData->hProf, "total");
+        SAF_RT_SCOPE_END;
     }
     else{
         for (i = 0; i < nOutputs; i++)
@@ -184,75 +201,99 @@ void rotator_process
 void rotator_setYaw(void  * const hRot, float newYaw)
 {
     rotator_data *pData = (rotator_data*)(hRot);
-    pData->yaw = pData->bFlipYaw == 1 ? -DEG2RAD(newYaw) : DEG2RAD(newYaw);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->yaw = up->bFlipYaw == 1 ? -DEG2RAD(newYaw) : DEG2RAD(newYaw);
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void rotator_setPitch(void* const hRot, float newPitch)
 {
     rotator_data *pData = (rotator_data*)(hRot);
-    pData->pitch = pData->bFlipPitch == 1 ? -DEG2RAD(newPitch) : DEG2RAD(newPitch);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->pitch = up->bFlipPitch == 1 ? -DEG2RAD(newPitch) : DEG2RAD(newPitch);
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void rotator_setRoll(void* const hRot, float newRoll)
 {
     rotator_data *pData = (rotator_data*)(hRot);
-    pData->roll = pData->bFlipRoll == 1 ? -DEG2RAD(newRoll) : DEG2RAD(newRoll);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->roll = up->bFlipRoll == 1 ? -DEG2RAD(newRoll) : DEG2RAD(newRoll);
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void rotator_setFlipYaw(void* const hRot, int newState)
 {
     rotator_data *pData = (rotator_data*)(hRot);
-    if(newState !=pData->bFlipYaw ){
-        pData->bFlipYaw = newState;
-        rotator_setYaw(hRot, -rotator_getYaw(hRot));
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    if(newState !=up->bFlipYaw ){
+        up->bFlipYaw = newState;
+        up->yaw = -(up->yaw); /* (the angle in degrees is unchanged) */
+        saf_paramBlock_publish(pData->hUserPars);
     }
+    else
+        saf_paramBlock_release(pData->hUserPars);
 }
 
 void rotator_setFlipPitch(void* const hRot, int newState)
 {
     rotator_data *pData = (rotator_data*)(hRot);
-    if(newState !=pData->bFlipPitch ){
-        pData->bFlipPitch = newState;
-        rotator_setPitch(hRot, -rotator_getPitch(hRot));
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    if(newState !=up->bFlipPitch ){
+        up->bFlipPitch = newState;
+        up->pitch = -(up->pitch); /* (the angle in degrees is unchanged) */
+        saf_paramBlock_publish(pData->hUserPars);
     }
+    else
+        saf_paramBlock_release(pData->hUserPars);
 }
 
 void rotator_setFlipRoll(void* const hRot, int newState)
 {
     rotator_data *pData = (rotator_data*)(hRot);
-    if(newState !=pData->bFlipRoll ){
-        pData->bFlipRoll = newState;
-        rotator_setRoll(hRot, -rotator_getRoll(hRot));
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    if(newState !=up->bFlipRoll ){
+        up->bFlipRoll = newState;
+        up->roll = -(up->roll); /* (the angle in degrees is unchanged) */
+        saf_paramBlock_publish(pData->hUserPars);
     }
+    else
+        saf_paramBlock_release(pData->hUserPars);
 }
 
 void rotator_setChOrder(void* const hRot, int newOrder)
 {
     rotator_data *pData = (rotator_data*)(hRot);
-    pData->chOrdering = (CH_ORDER)newOrder;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->chOrdering = (CH_ORDER)newOrder;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void rotator_setNormType(void* const hRot, int newType)
 {
     rotator_data *pData = (rotator_data*)(hRot);
-    pData->norm = (NORM_TYPES)newType;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->norm = (NORM_TYPES)newType;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void rotator_setOrder(void* const hRot, int newOrder)
 {
     rotator_data *pData = (rotator_data*)(hRot);
-    pData->outputOrder = (OUTPUT_ORDERS)newOrder;
-    switch(pData->outputOrder){
-        case OUTPUT_OMNI:          pData->order = 0; break;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->outputOrder = (OUTPUT_ORDERS)newOrder;
+    switch(up->outputOrder){
+        case OUTPUT_OMNI:          up->order = 0; break;
         default:
-        case OUTPUT_ORDER_FIRST:   pData->order = 1; break;
-        case OUTPUT_ORDER_SECOND:  pData->order = 2; break;
-        case OUTPUT_ORDER_THIRD:   pData->order = 3; break;
-        case OUTPUT_ORDER_FOURTH:  pData->order = 4; break;
-        case OUTPUT_ORDER_FIFTH:   pData->order = 5; break;
-        case OUTPUT_ORDER_SIXTH:   pData->order = 6; break;
-        case OUTPUT_ORDER_SEVENTH: pData->order = 7; break;
+        case OUTPUT_ORDER_FIRST:   up->order = 1; break;
+        case OUTPUT_ORDER_SECOND:  up->order = 2; break;
+        case OUTPUT_ORDER_THIRD:   up->order = 3; break;
+        case OUTPUT_ORDER_FOURTH:  up->order = 4; break;
+        case OUTPUT_ORDER_FIFTH:   up->order = 5; break;
+        case OUTPUT_ORDER_SIXTH:   up->order = 6; break;
+        case OUTPUT_ORDER_SEVENTH: up->order = 7; break;
     }
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 /*gets*/
@@ -260,55 +301,75 @@ void rotator_setOrder(void* const hRot, int newOrder)
 float rotator_getYaw(void* const hRot)
 {
     rotator_data *pData = (rotator_data*)(hRot);
-    return pData->bFlipYaw == 1 ? -RAD2DEG(pData->yaw) : RAD2DEG(pData->yaw);
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->bFlipYaw == 1 ? -RAD2DEG(up->yaw) : RAD2DEG(up->yaw);
 }
 
 float rotator_getPitch(void* const hRot)
 {
     rotator_data *pData = (rotator_data*)(hRot);
-    return pData->bFlipPitch == 1 ? -RAD2DEG(pData->pitch) : RAD2DEG(pData->pitch);
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->bFlipPitch == 1 ? -RAD2DEG(up->pitch) : RAD2DEG(up->pitch);
 }
 
 float rotator_getRoll(void* const hRot)
 {
     rotator_data *pData = (rotator_data*)(hRot);
-    return pData->bFlipRoll == 1 ? -RAD2DEG(pData->roll) : RAD2DEG(pData->roll);
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->bFlipRoll == 1 ? -RAD2DEG(up->roll) : RAD2DEG(up->roll);
 }
 
 int rotator_getFlipYaw(void* const hRot)
 {
     rotator_data *pData = (rotator_data*)(hRot);
-    return pData->bFlipYaw;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->bFlipYaw;
 }
 
 int rotator_getFlipPitch(void* const hRot)
 {
     rotator_data *pData = (rotator_data*)(hRot);
-    return pData->bFlipPitch;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->bFlipPitch;
 }
 
 int rotator_getFlipRoll(void* const hRot)
 {
     rotator_data *pData = (rotator_data*)(hRot);
-    return pData->bFlipRoll;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->bFlipRoll;
 }
 
 int rotator_getChOrder(void* const hRot)
 {
     rotator_data *pData = (rotator_data*)(hRot);
-    return (int)pData->chOrdering;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->chOrdering;
 }
 
 int rotator_getNormType(void* const hRot)
 {
     rotator_data *pData = (rotator_data*)(hRot);
-    return (int)pData->norm;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->norm;
 }
 
 int rotator_getOrder(void* const hRot)
 {
     rotator_data *pData = (rotator_data*)(hRot);
-    return (int)pData->outputOrder;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->outputOrder;
+}
+
+int rotator_getProcessingDelay(void)
+{
+    return FRAME_SIZE;
+}
+
+void* rotator_getProfiler(void* const hRot)
+{
+    rotator_data *pData = (rotator_data*)(hRot);
+    return pData->hProf;
 }
 
 
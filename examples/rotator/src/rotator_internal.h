@@ -39,6 +39,7 @@ extern "C" {
 
 #define MAX_SH_ORDER ( 7 )
 #define MAX_NUM_SH_SIGNALS ( (MAX_SH_ORDER + 1)*(MAX_SH_ORDER + 1)  )    /* (L+1)^2 */
+#define USER_PARS_AUDIO ( 0 )                                      /* user parameter block reader index of the audio thread */
     
 #ifndef DEG2RAD
   #define DEG2RAD(x) (x * PI / 180.0f)
@@ -46,6 +47,18 @@ extern "C" {
 #ifndef RAD2DEG
   #define RAD2DEG(x) (x * 180.0f / PI)
 #endif
+
+/* user parameters (see saf_paramBlock) */
+typedef struct _userPars
+{
+    float yaw, roll, pitch;                                    /* rotation angles in radians (negated if flipped) */
+    int bFlipYaw, bFlipPitch, bFlipRoll;
+    int order;
+    CH_ORDER chOrdering;
+    NORM_TYPES norm;
+    OUTPUT_ORDERS outputOrder;
+    
+} userPars;
 
 typedef struct _rotator
 {
@@ -58,14 +71,11 @@ typedef struct _rotator
     float interpolator[FRAME_SIZE];
     float M_rot[MAX_NUM_SH_SIGNALS][MAX_NUM_SH_SIGNALS];
     float prev_M_rot[MAX_NUM_SH_SIGNALS][MAX_NUM_SH_SIGNALS];
+    float M_rot_tmp[MAX_NUM_SH_SIGNALS*MAX_NUM_SH_SIGNALS];    /* FLAT: nSH x nSH */
 
     /* user parameters */
-    float yaw, roll, pitch;
-    int bFlipYaw, bFlipPitch, bFlipRoll;
-    int order;
-    CH_ORDER chOrdering;
-    NORM_TYPES norm;
-    OUTPUT_ORDERS outputOrder;
+    void* hUserPars;                                           /* parameter block of "userPars"; edited by the set functions, read by the audio thread */
+    void* hProf;                                               /* per-stage timing of the processing loop (see saf_profiler.h) */
     
 } rotator_data;
     
@@ -158,6 +158,9 @@ int sldoa_getChOrder(void* const hSld);
 
 int sldoa_getNormType(void* const hSld);
 
+/* returns the profiler handle, for "saf_profiler_getStats" (NULL, unless built with SAF_ENABLE_PROFILER) */
+void* sldoa_getProfiler(void* const hSld);
+
 #ifdef __cplusplus
 }
 #endif
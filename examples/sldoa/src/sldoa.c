@@ -35,7 +35,6 @@
 
 #include "sldoa.h"
 #include "sldoa_internal.h"
-#include "sldoa_database.h" 
 
 void sldoa_create
 (
@@ -45,7 +44,9 @@ void sldoa_create
     sldoa_data* pData = (sldoa_data*)malloc(sizeof(sldoa_data));
     if (pData == NULL) { return;/*error*/ }
     *phSld = (void*)pData;
-    int i, j, t, ch, band;
+    saf_profiler_create(&(pData->hProf));
+    int i, t, ch, band;
+    userPars* up;
     
     afSTFTinit(&(pData->hSTFT), HOP_SIZE, NUM_SH_SIGNALS, 0, 0, 1);
     pData->STFTInputFrameTF = (complexVector**)malloc2d(TIME_SLOTS, NUM_SH_SIGNALS, sizeof(complexVector));
@@ -57,18 +58,13 @@ void sldoa_create
     }
     pData->tempHopFrameTD = (float**)malloc2d(NUM_SH_SIGNALS, HOP_SIZE, sizeof(float));
     
-    /* internal */
-    pData->reInitAna = 1;
-#if SH_ORDER > 1
-    for(i=0; i<SH_ORDER; i++)
-        pData->secCoeffs[i] = NULL;
-#endif
-    for(i=0; i<64; i++)
-        for(j=0; j<NUM_GRID_DIRS; j++)
-            pData->grid_Y[i][j] = (float)__grid_Y[i][j];
-    for(i=0; i<NUM_GRID_DIRS; i++)
-        for(j=0; j<2; j++)
-            pData->grid_dirs_deg[i][j] = (float)__grid_dirs_deg[i][j];
+    /* internal; the sector coefficients do not depend on any user parameter or the sampling rate, so they are
+     * computed once, here, rather than on the audio thread */
+    for(i=0; i<SH_ORDER; i++)
+        pData->secCoeffs[i] = NULL;
+    pData->gridRes = NULL;
+    shGridResource_acquire(SH_ORDER, GRID_ICO_FREQ, &(pData->gridRes));
+    sldoa_initAna(pData);
     
     /* display */
     for(i=0; i<NUM_DISP_SLOTS; i++){
@@ -79,15 +75,18 @@ void sldoa_create
     }
     
     /* Default user parameters */
+    saf_paramBlock_create(&(pData->hUserPars), sizeof(userPars), 1);
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
     for(band=0; band<HYBRID_BANDS; band++){
-        pData->analysisOrderPerBand[band] = SH_ORDER;
-        pData->nSectorsPerBand[band] = ORDER2NUMSECTORS(pData->analysisOrderPerBand[band]);
+        up->analysisOrderPerBand[band] = SH_ORDER;
+        pData->nSectorsPerBand[band] = ORDER2NUMSECTORS(up->analysisOrderPerBand[band]);
     }
-    pData->minFreq = 500.0f;
-    pData->maxFreq = 5e3f;
-    pData->avg_ms = 500.0f;
-    pData->chOrdering = CH_ACN;
-    pData->norm = NORM_N3D;
+    up->minFreq = 500.0f;
+    up->maxFreq = 5e3f;
+    up->avg_ms = 500.0f;
+    up->chOrdering = CH_ACN;
+    up->norm = NORM_N3D;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void sldoa_destroy
@@ -108,12 +107,17 @@ void sldoa_destroy
         }
         free2d((void**)pData->STFTInputFrameTF, TIME_SLOTS);
         free2d((void**)pData->tempHopFrameTD, NUM_SH_SIGNALS);
+        for(i=0; i<SH_ORDER; i++)
+            free(pData->secCoeffs[i]);
+        shGridResource_release(&(pData->gridRes));
         for(i=0; i<NUM_DISP_SLOTS; i++){
             free(pData->azi_deg[i]);
             free(pData->elev_deg[i]);
             free(pData->colourScale[i]);
             free(pData->alphaScale[i]);
         }
+        saf_paramBlock_destroy(&(pData->hUserPars));
+        saf_profiler_destroy(&(pData->hProf));
         free(pData);
         pData = NULL;
     }
@@ -145,7 +149,13 @@ void sldoa_init
     
     /* intialise display parameters */
     pData->current_disp_idx = 0;
-    memset(pData->doa_rad, 0, HYBRID_BANDS*MAX_NUM_SECTORS*2* sizeof(float));
+    for(band=0; band<HYBRID_BANDS; band++){
+        for(i=0; i<MAX_NUM_SECTORS; i++){
+            pData->doa_xyz[band][i][0] = 1.0f; /* azi=0, elev=0 */
+            pData->doa_xyz[band][i][1] = 0.0f;
+            pData->doa_xyz[band][i][2] = 0.0f;
+        }
+    }
     memset(pData->energy, 0, HYBRID_BANDS*MAX_NUM_SECTORS* sizeof(float));
     for(i=0; i<NUM_DISP_SLOTS; i++){
         memset(pData->azi_deg[i], 0, HYBRID_BANDS*MAX_NUM_SECTORS* sizeof(float));
@@ -166,9 +176,10 @@ void sldoa_analysis
 )
 {
     sldoa_data *pData = (sldoa_data*)(hSld);
-    int i, j, t, n, ch, sample, band, nSectors, min_band, numAnalysisBands, current_disp_idx;
-    float avgCoeff, max_en[HYBRID_BANDS], min_en[HYBRID_BANDS];
-    float new_doa[MAX_NUM_SECTORS][TIME_SLOTS][2], new_doa_xyz[3], doa_xyz[3], avg_xyz[3];
+    const userPars* up;
+    int i, j, t, n, ch, sample, band, nSectors, min_band, numAnalysisBands, current_disp_idx, order, nSH, endBand;
+    float avgCoeff, avg_norm, max_en[HYBRID_BANDS], min_en[HYBRID_BANDS];
+    float new_doa_xyz[MAX_NUM_SECTORS][TIME_SLOTS][3], avg_xyz[3];
     float new_energy[MAX_NUM_SECTORS][TIME_SLOTS];
     int o[SH_ORDER+2];
     
@@ -179,22 +190,19 @@ void sldoa_analysis
     CH_ORDER chOrdering;
     NORM_TYPES norm;
     
-    /* reinitialise if needed */
-    if(pData->reInitAna == 1){
-        pData->reInitAna = 2; /* indicate init in progress */
-        sldoa_initAna(hSld);
-        pData->reInitAna = 0; /* indicate init complete */
-    }
-    if (nSamples == FRAME_SIZE && (pData->reInitAna == 0) && isPlaying) {
+    /* consistent snapshot of the user parameters for this frame */
+    up = (const userPars*)saf_paramBlock_read(pData->hUserPars, USER_PARS_AUDIO);
+    
+    if (nSamples == FRAME_SIZE && isPlaying) {
+        SAF_RT_SCOPE_BEGIN;
+        SAF_PROFILE_BEGIN(pData->hProf, "total");
         current_disp_idx = pData->current_disp_idx;
-        /* copy current parameters to be thread safe */
-        memcpy(analysisOrderPerBand, pData->analysisOrderPerBand, HYBRID_BANDS*sizeof(int));
-        memcpy(nSectorsPerBand, pData->nSectorsPerBand, HYBRID_BANDS*sizeof(int));
-        minFreq = pData->minFreq;
-        maxFreq = pData->maxFreq;
-        avg_ms = pData->avg_ms;
-        chOrdering = pData->chOrdering;
-        norm = pData->norm;
+        memcpy(analysisOrderPerBand, up->analysisOrderPerBand, HYBRID_BANDS*sizeof(int));
+        minFreq = up->minFreq;
+        maxFreq = up->maxFreq;
+        avg_ms = up->avg_ms;
+        chOrdering = up->chOrdering;
+        norm = up->norm;
         
         /* load intput time-domain data */
         for (i = 0; i < MIN(NUM_SH_SIGNALS, nInputs); i++)
@@ -216,48 +224,68 @@ void sldoa_analysis
         }
         
         /* apply the time-frequency transform */
+        SAF_PROFILE_BEGIN(pData->hProf, "afSTFTforward");
         for (t = 0; t < TIME_SLOTS; t++) {
             for (ch = 0; ch < NUM_SH_SIGNALS; ch++)
                 for (sample = 0; sample < HOP_SIZE; sample++)
                     pData->tempHopFrameTD[ch][sample] = pData->SHframeTD[ch][sample + t*HOP_SIZE];
             afSTFTforward(pData->hSTFT, (float**)pData->tempHopFrameTD, (complexVector*)pData->STFTInputFrameTF[t]);
         }
-        for (band = 0; band < HYBRID_BANDS; band++)
-            for (ch = 0; ch < NUM_SH_SIGNALS; ch++)
+        for (ch = 0; ch < NUM_SH_SIGNALS; ch++)
+            for (band = 0; band < HYBRID_BANDS; band++)
                 for (t = 0; t < TIME_SLOTS; t++)
-                    pData->SHframeTF[band][ch][t] = cmplxf(pData->STFTInputFrameTF[t][ch].re[band], pData->STFTInputFrameTF[t][ch].im[band]);
+                    pData->SHframeTF[ch][band][t] = cmplxf(pData->STFTInputFrameTF[t][ch].re[band], pData->STFTInputFrameTF[t][ch].im[band]);
+        SAF_PROFILE_END(pData->hProf, "afSTFTforward");
+        
+        /* number of sectors follows directly from the analysis order */
+        for(band=0; band<HYBRID_BANDS; band++){
+            analysisOrderPerBand[band] = MIN(MAX(analysisOrderPerBand[band], 1), SH_ORDER);
+            nSectorsPerBand[band] = ORDER2NUMSECTORS(analysisOrderPerBand[band]);
+        }
+        memcpy(pData->nSectorsPerBand, nSectorsPerBand, HYBRID_BANDS*sizeof(int)); /* for display */
+        
+        /* obtain the sector signals. Consecutive analysis bands sharing the same analysis order are beamformed
+         * with one matrix multiplication (covering all of their sectors and time slots). Since the sector
+         * coefficients are real-valued, the complex TF data can be treated as interleaved real data */
+        SAF_PROFILE_BEGIN(pData->hProf, "beamforming");
+        for(band=1/* ignore DC */; band<HYBRID_BANDS; band=endBand){
+            endBand = band+1;
+            if(pData->freqVector[band] < minFreq || pData->freqVector[band] > maxFreq)
+                continue;
+            order = analysisOrderPerBand[band];
+            while(endBand<HYBRID_BANDS && analysisOrderPerBand[endBand]==order &&
+                  pData->freqVector[endBand] >= minFreq && pData->freqVector[endBand]<=maxFreq)
+                endBand++;
+            nSH = (order+1)*(order+1);
+            utility_sgemm(NO_TRANSPOSE, NO_TRANSPOSE, 4*ORDER2NUMSECTORS(order), 2*(endBand-band)*TIME_SLOTS, nSH, 1.0f,
+                          pData->secCoeffs[order-1], nSH,
+                          (float*)&(pData->SHframeTF[0][band][0]), 2*HYBRID_BANDS*TIME_SLOTS, 0.0f,
+                          (float*)&(pData->secSigTF[0][band][0]), 2*HYBRID_BANDS*TIME_SLOTS);
+        }
+        SAF_PROFILE_END(pData->hProf, "beamforming");
         
         /* apply sector-based, frequency-dependent DOA analysis */
+        SAF_PROFILE_BEGIN(pData->hProf, "doa");
         numAnalysisBands = 0;
         min_band = 0;
+        avgCoeff = avg_ms < 10.0f ? 1.0f : 1.0f / ((avg_ms/1e3f) / (1.0f/(float)HOP_SIZE) + 2.23e-9f);
+        avgCoeff = MAX(MIN(avgCoeff, 0.99999f), 0.0f); /* ensures stability */
         for(band=1/* ignore DC */; band<HYBRID_BANDS; band++){
             if(pData->freqVector[band] <= minFreq)
                 min_band = band;
             if(pData->freqVector[band] >= minFreq && pData->freqVector[band]<=maxFreq){
                 nSectors = nSectorsPerBand[band];
-                avgCoeff = avg_ms < 10.0f ? 1.0f : 1.0f / ((avg_ms/1e3f) / (1.0f/(float)HOP_SIZE) + 2.23e-9f);
-                avgCoeff = MAX(MIN(avgCoeff, 0.99999f), 0.0f); /* ensures stability */
-                sldoa_estimateDoA(pData->SHframeTF[band],
-                                  analysisOrderPerBand[band],
-#if SH_ORDER > 1
-                                  pData->secCoeffs[analysisOrderPerBand[band]-2],
-#else
-                                  NULL,
-#endif
-                                  new_doa,
-                                  new_energy);
+                sldoa_estimateDoA(&(pData->secSigTF[0][band][0]), nSectors, HYBRID_BANDS*TIME_SLOTS, new_doa_xyz, new_energy);
                 
-                /* average the raw data over time */
+                /* average the raw data over time (in cartesian form) */
                 for(i=0; i<nSectors; i++){
                     for( t = 0; t<TIME_SLOTS; t++){
                         /* avg doa estimate */
-                        unitSph2Cart(new_doa[i][t][0], new_doa[i][t][1], new_doa_xyz);
-                        unitSph2Cart(pData->doa_rad[band][i][0],
-                                     pData->doa_rad[band][i][1],
-                                     doa_xyz);
                         for(j=0; j<3; j++)
-                            avg_xyz[j] = new_doa_xyz[j]*avgCoeff + doa_xyz[j] * (1.0f-avgCoeff);
-                        unitCart2Sph_aziElev(avg_xyz, &(pData->doa_rad[band][i][0]), &(pData->doa_rad[band][i][1]));
+                            avg_xyz[j] = new_doa_xyz[i][t][j]*avgCoeff + pData->doa_xyz[band][i][j] * (1.0f-avgCoeff);
+                        avg_norm = sqrtf(avg_xyz[0]*avg_xyz[0] + avg_xyz[1]*avg_xyz[1] + avg_xyz[2]*avg_xyz[2]);
+                        for(j=0; j<3; j++)
+                            pData->doa_xyz[band][i][j] = avg_norm>0.0f ? avg_xyz[j]/avg_norm : (j==0 ? 1.0f : 0.0f);
                         
                         /* avg energy */
                         pData->energy[band][i] = new_energy[i][t]*avgCoeff + pData->energy[band][i] * (1.0f-avgCoeff);
@@ -266,6 +294,7 @@ void sldoa_analysis
                 numAnalysisBands++;
             }
         }
+        SAF_PROFILE_END(pData->hProf, "doa");
         
         /* determine the minimum and maximum sector energies per frequency (to scale them 0..1) */
         for(band=1/* ignore DC */; band<HYBRID_BANDS; band++){
@@ -285,8 +314,8 @@ void sldoa_analysis
                 nSectors = nSectorsPerBand[band];
                 /* store averaged values */
                 for(i=0; i<nSectors; i++){
-                    pData->azi_deg [current_disp_idx][band*MAX_NUM_SECTORS + i] = pData->doa_rad[band][i][0]*180.0f/M_PI;
-                    pData->elev_deg[current_disp_idx][band*MAX_NUM_SECTORS + i] = pData->doa_rad[band][i][1]*180.0f/M_PI;
+                    pData->azi_deg [current_disp_idx][band*MAX_NUM_SECTORS + i] = atan2f(pData->doa_xyz[band][i][1], pData->doa_xyz[band][i][0])*180.0f/M_PI;
+                    pData->elev_deg[current_disp_idx][band*MAX_NUM_SECTORS + i] = asinf(MIN(MAX(pData->doa_xyz[band][i][2], -1.0f), 1.0f))*180.0f/M_PI;
                     
                     /* colour should indicate the different frequencies */
                     pData->colourScale[current_disp_idx][band*MAX_NUM_SECTORS + i] = (float)(band-min_band)/(float)(numAnalysisBands+1);
@@ -305,6 +334,8 @@ void sldoa_analysis
                 memset(&(pData->alphaScale [current_disp_idx][band*MAX_NUM_SECTORS]), 0, MAX_NUM_SECTORS*sizeof(float));
             }
         }
+        SAF_PROFILE_END(pData->hProf, "total");
+        SAF_RT_SCOPE_END;
     }
 }
 
@@ -312,46 +343,59 @@ void sldoa_analysis
 
 void sldoa_refreshSettings(void* const hSld)
 {
-    sldoa_data *pData = (sldoa_data*)(hSld);
-    pData->reInitAna = 1;
-}
+    /* nothing to reinitialise; the sector coefficients are fixed (see "sldoa_create") */
+}
 
 void sldoa_setMaxFreq(void* const hSld, float newFreq)
 {
     sldoa_data *pData = (sldoa_data*)(hSld);
+    userPars* up;
+    
     newFreq = MAX(MIN(newFreq, pData->fs/2.0f),0.0f);
-    if(newFreq < pData->minFreq )
-        pData->minFreq = newFreq;
-    pData->maxFreq = newFreq;
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    if(newFreq < up->minFreq )
+        up->minFreq = newFreq;
+    up->maxFreq = newFreq;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void sldoa_setMinFreq(void* const hSld, float newFreq)
 {
     sldoa_data *pData = (sldoa_data*)(hSld);
+    userPars* up;
+    
     newFreq = MAX(MIN(newFreq, pData->fs/2.0f),0.0f);
-    if(newFreq > pData->maxFreq )
-        pData->maxFreq = newFreq;
-    pData->minFreq = newFreq;
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    if(newFreq > up->maxFreq )
+        up->maxFreq = newFreq;
+    up->minFreq = newFreq;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void sldoa_setAvg(void* const hSld, float newAvg)
 {
     sldoa_data *pData = (sldoa_data*)(hSld);
-    pData->avg_ms = newAvg;
+    userPars* up;
+    
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->avg_ms = newAvg;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void sldoa_setSourcePreset(void* const hSld, int newPresetID)
 {
     sldoa_data *pData = (sldoa_data*)(hSld);
+    userPars* up;
     int band, rangeIdx, curOrder, reverse;
     
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
     rangeIdx = 0;
     curOrder = 1;
     reverse = 0;
     switch(newPresetID){
         case MIC_PRESET_IDEAL:
             for(band=0; band<HYBRID_BANDS; band++)
-                pData->analysisOrderPerBand[band] = SH_ORDER;
+                up->analysisOrderPerBand[band] = SH_ORDER;
             break;
 #ifdef ENABLE_ZYLIA_MIC_PRESET
         case MIC_PRESET_ZYLIA:
@@ -366,9 +410,9 @@ void sldoa_setSourcePreset(void* const hSld, int newPresetID)
                         rangeIdx++;
                     }
                 }
-                pData->analysisOrderPerBand[band] = MIN(SH_ORDER,curOrder);
+                up->analysisOrderPerBand[band] = MIN(SH_ORDER,curOrder);
             }
-            pData->maxFreq = __Zylia_freqRange[(__Zylia_maxOrder-1)*2-1];
+            up->maxFreq = __Zylia_freqRange[(__Zylia_maxOrder-1)*2-1];
             break;
 #endif
 #ifdef ENABLE_EIGENMIKE32_MIC_PRESET
@@ -384,9 +428,9 @@ void sldoa_setSourcePreset(void* const hSld, int newPresetID)
                         rangeIdx++;
                     }
                 }
-                pData->analysisOrderPerBand[band] = MIN(SH_ORDER,curOrder);
+                up->analysisOrderPerBand[band] = MIN(SH_ORDER,curOrder);
             }
-            pData->maxFreq = __Eigenmike32_freqRange[(__Eigenmike32_maxOrder-1)*2-1];
+            up->maxFreq = __Eigenmike32_freqRange[(__Eigenmike32_maxOrder-1)*2-1];
             break;
 #endif
 #ifdef ENABLE_DTU_MIC_MIC_PRESET
@@ -402,44 +446,55 @@ void sldoa_setSourcePreset(void* const hSld, int newPresetID)
                         rangeIdx++;
                     }
                 }
-                pData->analysisOrderPerBand[band] = MIN(SH_ORDER,curOrder);
+                up->analysisOrderPerBand[band] = MIN(SH_ORDER,curOrder);
             }
-            pData->maxFreq = __DTU_mic_freqRange[(__DTU_mic_maxOrder-1)*2-1];
+            up->maxFreq = __DTU_mic_freqRange[(__DTU_mic_maxOrder-1)*2-1];
             break;
 #endif
     }
-    for(band=0; band<HYBRID_BANDS; band++)
-        pData->nSectorsPerBand[band] = ORDER2NUMSECTORS(pData->analysisOrderPerBand[band]);
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void sldoa_setAnaOrder(void * const hSld, int newValue, int bandIdx)
 {
     sldoa_data *pData = (sldoa_data*)(hSld);
-    pData->analysisOrderPerBand[bandIdx] = MIN(MAX(newValue,1), SH_ORDER);
-    pData->nSectorsPerBand[bandIdx] = ORDER2NUMSECTORS(pData->analysisOrderPerBand[bandIdx]);
+    userPars* up;
+    
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->analysisOrderPerBand[bandIdx] = MIN(MAX(newValue,1), SH_ORDER);
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void sldoa_setAnaOrderAllBands(void * const hSld, int newValue)
 {
     sldoa_data *pData = (sldoa_data*)(hSld);
+    userPars* up;
     int band;
     
-    for(band=0; band<HYBRID_BANDS; band++){
-        pData->analysisOrderPerBand[band] = MIN(MAX(newValue,1), SH_ORDER);
-        pData->nSectorsPerBand[band] = ORDER2NUMSECTORS(pData->analysisOrderPerBand[band]);
-    }
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    for(band=0; band<HYBRID_BANDS; band++)
+        up->analysisOrderPerBand[band] = MIN(MAX(newValue,1), SH_ORDER);
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void sldoa_setChOrder(void* const hSld, int newOrder)
 {
     sldoa_data *pData = (sldoa_data*)(hSld);
-    pData->chOrdering = (CH_ORDER)newOrder;
+    userPars* up;
+    
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->chOrdering = (CH_ORDER)newOrder;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void sldoa_setNormType(void* const hSld, int newType)
 {
     sldoa_data *pData = (sldoa_data*)(hSld);
-    pData->norm = (NORM_TYPES)newType;
+    userPars* up;
+    
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->norm = (NORM_TYPES)newType;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 /* GETS */
@@ -453,19 +508,22 @@ float sldoa_getSamplingRate(void* const hSld)
 float sldoa_getMaxFreq(void* const hSld)
 {
     sldoa_data *pData = (sldoa_data*)(hSld);
-    return pData->maxFreq;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->maxFreq;
 }
 
 float sldoa_getMinFreq(void* const hSld)
 {
     sldoa_data *pData = (sldoa_data*)(hSld);
-    return pData->minFreq;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->minFreq;
 }
 
 float sldoa_getAvg(void* const hSld)
 {
     sldoa_data *pData = (sldoa_data*)(hSld);
-    return pData->avg_ms;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->avg_ms;
 }
 
 /* Not very elegent, but does the job */
@@ -483,6 +541,7 @@ void sldoa_getDisplayData
 )
 {
     sldoa_data *pData = (sldoa_data*)(hSld);
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
     int i;
     
     (*azi_deg) = pData->azi_deg[pData->current_disp_idx];
@@ -494,9 +553,9 @@ void sldoa_getDisplayData
     (*startBand) =1;
     (*endBand) =1;
     for(i=1/*ignore DC*/; i<HYBRID_BANDS; i++){
-        if(pData->freqVector[i]<pData->minFreq)
+        if(pData->freqVector[i]<up->minFreq)
             (*startBand) = i+1;
-        if(pData->freqVector[i]<pData->maxFreq)
+        if(pData->freqVector[i]<up->maxFreq)
             (*endBand) = i;
     }
     /* read the next buffer for the next call */
@@ -508,13 +567,15 @@ void sldoa_getDisplayData
 int sldoa_getAnaOrder(void  * const hSld, int bandIdx)
 {
     sldoa_data *pData = (sldoa_data*)(hSld);
-    return pData->analysisOrderPerBand[bandIdx];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->analysisOrderPerBand[bandIdx];
 }
 
 int sldoa_getAnaOrderAllBands(void  * const hSld)
 {
     sldoa_data *pData = (sldoa_data*)(hSld);
-    return pData->analysisOrderPerBand[0];
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->analysisOrderPerBand[0];
 }
 
 void sldoa_getAnaOrderHandle
@@ -526,9 +587,11 @@ void sldoa_getAnaOrderHandle
 )
 {
     sldoa_data *pData = (sldoa_data*)(hSld);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
     (*pX_vector) = &(pData->freqVector[0]);
-    (*pY_values) = &(pData->analysisOrderPerBand[0]);
+    (*pY_values) = &(up->analysisOrderPerBand[0]);
     (*pNpoints) = HYBRID_BANDS;
+    saf_paramBlock_release(pData->hUserPars);
 }
 
 int sldoa_getNumberOfBands(void)
@@ -539,12 +602,20 @@ int sldoa_getNumberOfBands(void)
 int sldoa_getChOrder(void* const hSld)
 {
     sldoa_data *pData = (sldoa_data*)(hSld);
-    return (int)pData->chOrdering;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->chOrdering;
 }
 
 int sldoa_getNormType(void* const hSld)
 {
     sldoa_data *pData = (sldoa_data*)(hSld);
-    return (int)pData->norm;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return (int)up->norm;
 }
 
+void* sldoa_getProfiler(void* const hSld)
+{
+    sldoa_data *pData = (sldoa_data*)(hSld);
+    return pData->hProf;
+}
+
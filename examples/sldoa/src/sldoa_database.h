@@ -1,17 +0,0 @@
-/*
-    Leo McCormack
-    ../../database/sldoa_database/sldoa_database.h
-    Generated using MatLab on: 12-Feb-2018 
-*/
-
-#ifndef __SLDOA_DATABASE_INCLUDED__
-#define __SLDOA_DATABASE_INCLUDED__
-
-#define NUM_GRID_DIRS ( 2562 )
-
-extern const double __afCenterFreq48e3[133];
-extern const double __afCenterFreq44100[133];
-extern const double __grid_Y[64][2562];
-extern const double __grid_dirs_deg[2562][2];
-
-#endif /* __SLDOA_DATABASE_INCLUDED__ */
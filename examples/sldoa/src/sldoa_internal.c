@@ -35,17 +35,34 @@
 
 #include "sldoa.h"
 #include "sldoa_internal.h"
-#include "sldoa_database.h"
 
 void sldoa_initAna(void* const hSld)
 {
-#if SH_ORDER > 1
     sldoa_data *pData = (sldoa_data*)(hSld);
     int i, n, j, k, order, nSectors, nSH, grid_N_vbap_gtable, grid_nGroups;
     float* sec_dirs_deg, *grid_vbap_gtable, *w_SG, *pinv_Y;
     float secPatterns[4][NUM_GRID_DIRS], grid_vbap_gtable_T[ORDER2NUMSECTORS(SH_ORDER)][NUM_GRID_DIRS];
-
-    for(i=0, order=2; order<=SH_ORDER; i++,order++){
+    float compScale;
+    const float* grid_Y, *grid_dirs_deg;
+    
+    /* real SH basis sampled over the grid (N3D, scaled by 1/sqrt(4pi)); shared by all instances (see sldoa_create) */
+    grid_Y = pData->gridRes->Y;
+    grid_dirs_deg = pData->gridRes->dirs_deg;
+    
+    /* the sector coefficients are stored component-major (row j*nSectors+n: component j of sector n), such
+     * that the sector signals for all sectors and bands can be obtained with a single matrix multiplication
+     * per analysis order. The N3D to SN3D conversion of the dipole components is also folded in here */
+    
+    /* first order: standard pressure-intensity based DoA estimation (i.e. same signals for all sectors) */
+    nSectors = ORDER2NUMSECTORS(1);
+    free(pData->secCoeffs[0]);
+    pData->secCoeffs[0] = calloc(4*nSectors*4, sizeof(float));
+    for(j=0; j<4; j++)
+        for(n=0; n<nSectors; n++)
+            pData->secCoeffs[0][(j*nSectors+n)*4+j] = j==0 ? 1.0f : 1.0f/sqrtf(3.0f);
+    
+    /* higher orders: spatially localised pressure-intensity based DoA estimation */
+    for(i=1, order=2; order<=SH_ORDER; i++,order++){
         nSectors = ORDER2NUMSECTORS(order);
         nSH = (order+1)*(order+1);
         
@@ -54,7 +71,7 @@ void sldoa_initAna(void* const hSld)
         memcpy(sec_dirs_deg, __HANDLES_SphCovering_dirs_deg[nSectors-1], nSectors*2*sizeof(float));
         
         /* generate VBAP gain table */
-        generateVBAPgainTable3D_srcs((float*)pData->grid_dirs_deg, NUM_GRID_DIRS, sec_dirs_deg, nSectors, 0, 0,
+        generateVBAPgainTable3D_srcs((float*)grid_dirs_deg, NUM_GRID_DIRS, sec_dirs_deg, nSectors, 0, 0,
                                      &(grid_vbap_gtable), &(grid_N_vbap_gtable), &(grid_nGroups));
         
         /* convert to amplitude preserving gains */
@@ -66,103 +83,73 @@ void sldoa_initAna(void* const hSld)
                 grid_vbap_gtable_T[n][j] = grid_vbap_gtable[j*nSectors+n];
         
         /* generate sector coefficients */
-        if(pData->secCoeffs[i]!=NULL)
-            free(pData->secCoeffs[i]);
-        pData->secCoeffs[i] = malloc(4 * (nSH*nSectors) * sizeof(float_complex));
+        free(pData->secCoeffs[i]);
+        pData->secCoeffs[i] = malloc(4 * (nSH*nSectors) * sizeof(float));
         w_SG = malloc(4 * (nSH) * sizeof(float));
         pinv_Y = malloc(NUM_GRID_DIRS*nSH*sizeof(float));
+        utility_spinv(grid_Y, nSH, NUM_GRID_DIRS, pinv_Y);
         for(n=0; n<nSectors; n++){
             for(j=0; j<4; j++)
-                utility_svvmul((float*)grid_vbap_gtable_T[n], pData->grid_Y[j], NUM_GRID_DIRS, secPatterns[j]);
-            utility_spinv(&(pData->grid_Y[0][0]), nSH, NUM_GRID_DIRS, pinv_Y);
+                utility_svvmul((float*)grid_vbap_gtable_T[n], (float*)&(grid_Y[j*NUM_GRID_DIRS]), NUM_GRID_DIRS, secPatterns[j]);
             cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 4, nSH, NUM_GRID_DIRS, 1.0f,
                         &(secPatterns[0][0]), NUM_GRID_DIRS,
                         pinv_Y, nSH, 0.0f,
                         w_SG, nSH);
             
             /* stack the sector coefficients */
-            for(j=0; j<4; j++)
+            for(j=0; j<4; j++){
+                compScale = j==0 ? 1.0f : 1.0f/sqrtf(3.0f);
                 for(k=0; k<nSH; k++)
-                    pData->secCoeffs[i][j*(nSectors*nSH)+n*nSH+k] = cmplxf(w_SG[j*nSH+k], 0.0f);
+                    pData->secCoeffs[i][(j*nSectors+n)*nSH+k] = compScale * w_SG[j*nSH+k];
+            }
         }
         free(w_SG);
         free(pinv_Y);
         free(grid_vbap_gtable);
         free(sec_dirs_deg);
-    } 
-#endif
+    }
 }
 
 
 void sldoa_estimateDoA
 (
-    float_complex SHframeTF[NUM_SH_SIGNALS][TIME_SLOTS],
-    int anaOrder,
-    float_complex* secCoeffs,
-    float doa[MAX_NUM_SECTORS][TIME_SLOTS][2],
+    float_complex* secSig,
+    int nSectors,
+    int ld,
+    float doa_xyz[MAX_NUM_SECTORS][TIME_SLOTS][3],
     float energy[MAX_NUM_SECTORS][TIME_SLOTS]
 )
 {
-    int n, ch, i, j, nSectors, analysisOrder, nSH;
-    float_complex secSig[4][TIME_SLOTS];
-    float_complex* sec_c;
-    float secEnergy[TIME_SLOTS], secIntensity[3][TIME_SLOTS], secAzi[TIME_SLOTS], secElev[TIME_SLOTS];
-    const float_complex calpha = cmplxf(1.0f, 0.0f); const float_complex cbeta = cmplxf(0.0f, 0.0f);
-    int o[SH_ORDER+2];
-    for(n=0; n<SH_ORDER+2; n++){  o[n] = n*n;  }
-    
-    /* prep */
-    memset(doa,0,MAX_NUM_SECTORS*TIME_SLOTS*2*sizeof(float));
-    memset(energy,0,MAX_NUM_SECTORS*TIME_SLOTS*sizeof(float));
-    analysisOrder = MAX(MIN(SH_ORDER, anaOrder),1);
-    nSectors = ORDER2NUMSECTORS(analysisOrder);
-    nSH = (analysisOrder+1)*(analysisOrder+1);
-    sec_c = malloc(4*nSH*sizeof(float_complex));
+    int n, i, j;
+    float_complex* p, *v[3];
+    float intensity[3], norm;
     
     /* calculate energy and DoA for each sector */
     for( n=0; n<nSectors; n++){
-        if(anaOrder==1 || secCoeffs == NULL) /* standard first order pressure-intensity based DoA estimation */
-            for (i=0; i<4; i++)
-                memcpy(secSig[i], SHframeTF[i], TIME_SLOTS * sizeof(float_complex));
-        else{ /* spatially localised pressure-intensity based DoA estimation */
-            for (i=0; i<4; i++)
-                for (j=0; j<nSH; j++)
-                    sec_c[i*nSH+j] = secCoeffs[i*(nSectors*nSH)+n*nSH+j];
-            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 4, TIME_SLOTS, nSH, &calpha,
-                        sec_c, nSH,
-                        SHframeTF, TIME_SLOTS, &cbeta,
-                        secSig, TIME_SLOTS);
-        }
-        
-        /* convert N3D to SN3D */
-        for (ch = 1; ch<4; ch++)
-            for(i = 0; i<TIME_SLOTS; i++)
-                secSig[ch][i] = crmulf(secSig[ch][i], 1.0f/sqrtf(3.0f));
-        
-        /* calculate sector energy and intensity vector */
-        memset(secEnergy, 0, TIME_SLOTS*sizeof(float));
-        for (i=0; i<4; i++)
-            for (j=0; j<TIME_SLOTS; j++)
-                secEnergy[j] += 0.5f*powf(cabsf(secSig[i][j]), 2.0f);
-        for (i=0; i<3; i++)
-            for (j=0; j<TIME_SLOTS; j++)
-                secIntensity[i][j] = crealf(ccmulf(conjf(secSig[0][j]), secSig[1+i][j]));
-        
-        /* extract DoA */
-        for (j=0; j<TIME_SLOTS; j++){
-            secAzi[j]  = atan2f( secIntensity[0][j], secIntensity[2][j] );
-            secElev[j] = atan2f( secIntensity[1][j], sqrtf( powf(secIntensity[2][j], 2.0f) + powf(secIntensity[0][j], 2.0f)) );
-        }
-        
-        /* store energy and DoA estimate */
+        p = &(secSig[n*ld]);
+        for(i=0; i<3; i++)
+            v[i] = &(secSig[((i+1)*nSectors+n)*ld]);
         for (j=0; j<TIME_SLOTS; j++){
-            doa[n][j][0] = secAzi[j];
-            doa[n][j][1] = secElev[j];
-            energy[n][j] = secEnergy[j]*1e6f;
+            /* sector energy and intensity vector */
+            energy[n][j] = 0.5f*(crealf(ccmulf(conjf(p[j]), p[j])) + crealf(ccmulf(conjf(v[0][j]), v[0][j])) +
+                                 crealf(ccmulf(conjf(v[1][j]), v[1][j])) + crealf(ccmulf(conjf(v[2][j]), v[2][j]))) * 1e6f;
+            for(i=0; i<3; i++)
+                intensity[i] = crealf(ccmulf(conjf(p[j]), v[i][j]));
+            
+            /* DoA, as a unit vector (ACN dipoles are ordered y,z,x) */
+            norm = sqrtf(intensity[0]*intensity[0] + intensity[1]*intensity[1] + intensity[2]*intensity[2]);
+            if(norm>0.0f){
+                doa_xyz[n][j][0] = intensity[2]/norm;
+                doa_xyz[n][j][1] = intensity[0]/norm;
+                doa_xyz[n][j][2] = intensity[1]/norm;
+            }
+            else{
+                doa_xyz[n][j][0] = 1.0f;
+                doa_xyz[n][j][1] = 0.0f;
+                doa_xyz[n][j][2] = 0.0f;
+            }
         }
     }
-    
-    free(sec_c);
 }
  
 
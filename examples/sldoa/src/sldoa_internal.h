@@ -41,7 +41,6 @@
 #include <string.h>
 #include <float.h>
 #include "sldoa.h"
-#include "sldoa_database.h"
 #define SAF_ENABLE_AFSTFT      /* for time-frequency transform */
 #define SAF_ENABLE_SH          /* for spherical harmonic related functions */
 #define SAF_ENABLE_VBAP        /* for vbap gain tables */
@@ -57,6 +56,9 @@
 #define TIME_SLOTS ( FRAME_SIZE / HOP_SIZE )                /* Processing relies on fdHop = 16 */
 #define MAX_NUM_SECTORS ( ORDER2NUMSECTORS(SH_ORDER) )      /* maximum number of sectors */
 #define NUM_DISP_SLOTS ( 2 )                                /* needs to be at least 2. On slower systems that skip frames, consider more slots.  */
+#define GRID_ICO_FREQ ( 16 )                                /* geosphere used for computing the sector patterns */
+#define NUM_GRID_DIRS ( 2562 )                              /* number of points in the above geosphere */
+#define USER_PARS_AUDIO ( 0 )                               /* user parameter block reader index of the audio thread */
 #ifndef M_PI
   #define M_PI ( 3.14159265359f )
 #endif 
@@ -70,11 +72,23 @@ extern "C" {
 /* Structs */
 /***********/
     
+/* user parameters (see saf_paramBlock) */
+typedef struct _userPars
+{
+    int analysisOrderPerBand[HYBRID_BANDS];
+    float maxFreq;
+    float minFreq;
+    float avg_ms;
+    CH_ORDER chOrdering;
+    NORM_TYPES norm;
+    
+} userPars;
+    
 typedef struct _sldoa
 {
     /* TFT */
     float SHframeTD[NUM_SH_SIGNALS][FRAME_SIZE]; 
-    float_complex SHframeTF[HYBRID_BANDS][NUM_SH_SIGNALS][TIME_SLOTS];
+    float_complex SHframeTF[NUM_SH_SIGNALS][HYBRID_BANDS][TIME_SLOTS];     /* channel-major, so bands can be batched */
     void* hSTFT;
     complexVector** STFTInputFrameTF;
     float** tempHopFrameTD;
@@ -82,15 +96,12 @@ typedef struct _sldoa
     float fs;
       
     /* internal */
-    int reInitAna; /* 0: no init required, 1: init required, 2: init in progress */
-    float grid_Y[64][NUM_GRID_DIRS];
-    float grid_dirs_deg[NUM_GRID_DIRS][2];
-#if SH_ORDER > 1
-    float_complex* secCoeffs[SH_ORDER-1];
-#endif
-    float doa_rad[HYBRID_BANDS][MAX_NUM_SECTORS][2];
+    shGridResource* gridRes;                                              /* shared SHs over the geosphere (see saf_sh.h); Y: FLAT: NUM_SH_SIGNALS x NUM_GRID_DIRS */
+    float* secCoeffs[SH_ORDER];                                           /* per order; FLAT: 4*nSectors x nSH (component-major) */
+    float_complex secSigTF[4*MAX_NUM_SECTORS][HYBRID_BANDS][TIME_SLOTS]; /* sector signals */
+    float doa_xyz[HYBRID_BANDS][MAX_NUM_SECTORS][3];                      /* averaged DoA unit vectors */
     float energy [HYBRID_BANDS][MAX_NUM_SECTORS];
-    int nSectorsPerBand[HYBRID_BANDS];
+    int nSectorsPerBand[HYBRID_BANDS];                                    /* of the last analysed frame (for display) */
     
     /* display */
     float* azi_deg[NUM_DISP_SLOTS];
@@ -100,12 +111,8 @@ typedef struct _sldoa
     int current_disp_idx;
     
     /* User parameters */
-    int analysisOrderPerBand[HYBRID_BANDS];
-    float maxFreq;
-    float minFreq;
-    float avg_ms;
-    CH_ORDER chOrdering;
-    NORM_TYPES norm;
+    void* hUserPars;                                                      /* parameter block of "userPars"; edited by the set functions, read by the audio thread */
+    void* hProf;                                                          /* per-stage timing of the processing loop (see saf_profiler.h) */
 
 } sldoa_data;
      
@@ -114,17 +121,20 @@ typedef struct _sldoa
 /* Internal functions */
 /**********************/
     
-/* The formulae for calculating the sector coefficients can be found in:
+/* Computes the sector coefficients of all analysis orders; called once, on creation.
+ * The formulae for calculating the sector coefficients can be found in:
  * McCormack, L., Delikaris-Manias, S., Farina, A., Pinardi, D., and Pulkki, V., “Real-time conversion of
  * sensor array signals into spherical harmonic signals with applications to spatially localised sub-band
  * sound-field analysis,” in Audio Engineering Society Convention 144, Audio Engineering Society, 2018.*/
 void sldoa_initAna(void* const hSld);                                        /* handle for sldoa */
   
-/* estimates the DoA using the active intensity vectors derived from spatially contrained sectors */
-void sldoa_estimateDoA(float_complex SHframeTF[NUM_SH_SIGNALS][TIME_SLOTS],  /* input SH frame */
-                       int anaOrder,                                         /* analysis order (1:PI, 2+: SLPI) */
-                       float_complex* secCoeffs,                             /* sector coefficients for this order */
-                       float doa[MAX_NUM_SECTORS][TIME_SLOTS][2],            /* resulting DoA estimates per timeslot and sector */
+/* estimates the DoA using the active intensity vectors derived from spatially contrained sectors. The sector
+ * signals of one band are component-major (row j*nSectors+n holds component j of sector n), as given by the
+ * sector coefficients, and already in SN3D */
+void sldoa_estimateDoA(float_complex* secSig,                                /* sector signals of one band; FLAT: 4*nSectors x ld */
+                       int nSectors,                                         /* number of sectors */
+                       int ld,                                               /* leading dimension (row stride) of 'secSig' */
+                       float doa_xyz[MAX_NUM_SECTORS][TIME_SLOTS][3],        /* resulting DoA unit vectors per timeslot and sector */
                        float energy[MAX_NUM_SECTORS][TIME_SLOTS]);           /* resulting sector energies per time slot */
 
 #ifdef __cplusplus
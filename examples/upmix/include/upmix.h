@@ -55,12 +55,23 @@ void upmix_process(void* const hUpmx,                  /* upmix handle */
                    int nOutputs,                       /* number of channels in 'outputs' matrix */
                    int nSamples,                       /* number of samples in 'inputs' and 'outputs' matrices */
                    int isPlaying);                     /* flag; set to 1 if there really is audio */
+
+/* blocks until the worker thread has finished (re)computing the codec parameters (VBAP gain table and band grouping),
+ * which are then picked up by the next call to "upmix_process" (e.g. for offline rendering or benchmarking). Must not
+ * be called from the audio thread */
+void upmix_waitForCodecInit(void* const hUpmx);        /* upmix handle */
     
     
 /*****************/
 /* Set Functions */
 /*****************/
     
+/* sets the thread pool (see "saf_pool_create") over which "upmix_process" spreads its per-band stages; NULL
+ * (default): the audio thread processes all bands. The pool may be shared with other instances/modules, and must not
+ * be destroyed whilst it is still set */
+void upmix_setThreadPool(void* const hUpmx,            /* upmix handle */
+                         void* const hPool);           /* thread pool handle; NULL: none */
+    
 void upmix_setPValueCoeff(void* const hUpmx, float newValue);
     
 void upmix_setParamAvgCoeff(void* const hUpmx, float newValue);
@@ -81,6 +92,12 @@ float upmix_getParamAvgCoeff(void* const hUpmx);
 float upmix_getScaleDoAwidth(void* const hUpmx);
 
 float upmix_getCovAvg(void* const hUpmx);
+
+/* returns the processing delay in samples, introduced by the time-frequency transform */
+int upmix_getProcessingDelay(void);
+
+/* returns the profiler handle, for "saf_profiler_getStats" (NULL, unless built with SAF_ENABLE_PROFILER) */
+void* upmix_getProfiler(void* const hUpmx);
     
 
 #ifdef __cplusplus
@@ -39,8 +39,11 @@ void upmix_create
 )
 {
     upmix_data* pData = (upmix_data*)malloc(sizeof(upmix_data));
+    userPars* up;
     if (pData == NULL) { return;/*error*/ }
     *phUpmx = (void*)pData;
+    saf_profiler_create(&(pData->hProf));
+    pData->hPool = NULL;
     int t, ch;
     
     /* time-frequency transform + buffers */
@@ -59,20 +62,24 @@ void upmix_create
     }
     pData->tempHopFrameTD = (float**)malloc2d( MAX(MAX_NUM_OUTPUT_CHANNELS, MAX_NUM_INPUT_CHANNELS), HOP_SIZE, sizeof(float));
     
-    /* internal parameters */
+    /* internal parameters; the codec parameters are built on the worker thread (once the sampling rate is known, see
+     * upmix_init) */
     pData->reInitCodec = 1;
-    pData->pars = malloc(sizeof(codecPars));
-    codecPars* pars = pData->pars;
-    pars->grid_vbap_gtable = NULL;
-    pars->grp_freqs = NULL;
-    pars->grp_idx = NULL;
-    pars->prev_est_dir = NULL; 
+    pData->pars = NULL;
+    pData->pendingPars = NULL;
+    pData->retiredPars = NULL;
+    saf_worker_create(&(pData->hWorker), upmix_codecWorker, (void*)pData);
+    memset(pData->prev_est_dir, 0, HYBRID_BANDS*sizeof(float));
      
     /* user parameters */
-    pData->pValueCoeff = 0.5f;
-    pData->paramAvgCoeff = 0.0f;
-    pData->scaleDoAwidth = 1.0f;
-    pData->covAvg = 0.85f;
+    saf_paramBlock_create(&(pData->hUserPars), sizeof(userPars), 1);
+    up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->pValueCoeff = 0.5f;
+    up->paramAvgCoeff = 0.0f;
+    up->scaleDoAwidth = 1.0f;
+    up->covAvg = 0.85f;
+    saf_paramBlock_publish(pData->hUserPars);
+    pData->pValueCoeff = -1.0f;
 }
 
 
@@ -82,9 +89,13 @@ void upmix_destroy
 )
 {
     upmix_data *pData = (upmix_data*)(*phUpmx);
+    codecPars *pars, *next;
     int t, ch;
 
     if (pData != NULL) {
+        /* stop the worker thread first (waits for it to finish any initialisation in progress) */
+        saf_worker_destroy(&(pData->hWorker));
+        
         afSTFTfree(pData->hSTFT);
         for (t = 0; t<TIME_SLOTS; t++) {
             for(ch=0; ch< MAX_NUM_INPUT_CHANNELS; ch++) {
@@ -99,7 +110,17 @@ void upmix_destroy
         free2d((void**)pData->STFTInputFrameTF, TIME_SLOTS);
         free2d((void**)pData->STFTOutputFrameTF, TIME_SLOTS);
         free2d((void**)pData->tempHopFrameTD, MAX(MAX_NUM_INPUT_CHANNELS, MAX_NUM_OUTPUT_CHANNELS));
+        
+        upmix_freeCodecPars(&(pData->pars));
+        pars = (codecPars*)pData->pendingPars;
+        upmix_freeCodecPars(&pars);
+        for(pars = (codecPars*)pData->retiredPars; pars!=NULL; pars = next){
+            next = pars->next;
+            upmix_freeCodecPars(&pars);
+        }
+        saf_paramBlock_destroy(&(pData->hUserPars));
  
+        saf_profiler_destroy(&(pData->hProf));
         free(pData);
         pData = NULL;
     }
@@ -123,14 +144,175 @@ void upmix_init
         for(band=0; band <HYBRID_BANDS; band++)
             pData->freqVector[band] = (float)__afCenterFreq48e3[band];
     
-    /* define pValues */
-    getPvalues(pData->pValueCoeff, (float*)pData->freqVector, HYBRID_BANDS, (float*)pData->pValues);
+    /* the pValues are (re)computed for this frequency vector by the audio thread */
+    pData->pValueCoeff = -1.0f;
     
     /* default starting values */
     memset(pData->Cx, 0, HYBRID_BANDS*MAX_NUM_INPUT_CHANNELS*MAX_NUM_INPUT_CHANNELS*sizeof(float_complex));
     memset(pData->inputframeTF_buffer, 0, HYBRID_BANDS*MAX_NUM_INPUT_CHANNELS*DIFFUSE_DELAY_TIME_SLOTS*sizeof(float_complex));
     pData->buffer_rIdx = 1;
     pData->buffer_wIdx = 0;
+    
+    /* the band grouping depends on the sampling rate */
+    upmix_requestCodecInit(hUpmx);
+}
+
+/* pool task: updates the covariance matrix of one band */
+static void upmix_covarianceTask(void* arg, int band)
+{
+    upmix_frameArgs* frameArgs = (upmix_frameArgs*)arg;
+    upmix_data *pData = (upmix_data*)(frameArgs->hUpmx);
+    int i, j;
+    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
+    float_complex new_Cx[MAX_NUM_INPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS];
+    
+    cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, MAX_NUM_INPUT_CHANNELS, MAX_NUM_INPUT_CHANNELS, TIME_SLOTS, &calpha,
+                pData->inputframeTF[band], TIME_SLOTS,
+                pData->inputframeTF[band], TIME_SLOTS, &cbeta,
+                new_Cx, MAX_NUM_INPUT_CHANNELS);
+    
+    /* average over time */
+    for(i=0; i<MAX_NUM_INPUT_CHANNELS; i++)
+        for(j=0; j<MAX_NUM_INPUT_CHANNELS; j++)
+            pData->Cx[band][i][j] = new_Cx[i][j]*(1.0f-frameArgs->covAvg) + pData->Cx[band][i][j] * frameArgs->covAvg;
+}
+
+/* pool task: calculates the mixing matrices of the bands of one bark/erb band group */
+static void upmix_mixingMatricesTask(void* arg, int grpband)
+{
+    upmix_frameArgs* frameArgs = (upmix_frameArgs*)arg;
+    upmix_data *pData = (upmix_data*)(frameArgs->hUpmx);
+    codecPars* pars = frameArgs->pars;
+    int i, j, k, band, num_grpBands, idx2D, ls;
+    int grp_bands[HYBRID_BANDS];
+    float est_dir, dummy;
+    double Cx_grp00, Cx_grp11, ICC_01, A1, A2, B, C, src_en, diff_en, src_diff_en, w_denom;
+    double pv_f, gains2D_sum_pvf;
+    float est_dir_xyz[3], prev_est_dir_xyz[3], est_dir_xyz_avg[3];
+    double gains2D[MAX_NUM_OUTPUT_CHANNELS];
+    double w_src[1][2], w_diff[2][2];
+    double Ms_S[MAX_NUM_OUTPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS];
+    double Ms_N[MAX_NUM_OUTPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS];
+    double Md_N[MAX_NUM_OUTPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS];
+    float_complex Cx_grp[MAX_NUM_INPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS];
+    const double mix_LR[MAX_NUM_OUTPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS] = { {sqrt(4.0), 0.0}, {0.0, sqrt(4.0)}, {0.0, 0.0f}, {0.0, 0.0}, {0.0, 0.0}};
+    const double mix_LsRs[MAX_NUM_OUTPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS] = { { 0.0, 0.0}, {0.0,  0.0}, {0.0, 0.0}, {sqrt(4.0), 0.0}, {0.0, sqrt(4.0)}};
+    const int nLoudspeakers = frameArgs->nLoudspeakers;
+    const float paramAvgCoeff = frameArgs->paramAvgCoeff;
+    
+    /* define which bands make up the bark/erb scale grouping */
+    num_grpBands = pars->grp_idx[grpband+1] - pars->grp_idx[grpband];
+    for(i=pars->grp_idx[grpband], j=0; i<pars->grp_idx[grpband+1]; i++, j++)
+        grp_bands[j] = i-1; /* -1 as the indices start from 1 */
+    
+    /* sum the covarience matrices for these grouped bands and calculate ICC between left and right channels */
+    memset(Cx_grp, 0, MAX_NUM_INPUT_CHANNELS*MAX_NUM_INPUT_CHANNELS*sizeof(float_complex));
+    for(i=0; i<num_grpBands; i++)
+        for(j=0; j<MAX_NUM_INPUT_CHANNELS; j++)
+            for(k=0; k<MAX_NUM_INPUT_CHANNELS; k++)
+                Cx_grp[j][k] = ccaddf(Cx_grp[j][k], pData->Cx[grp_bands[i]][j][k]);
+    Cx_grp00 = creal((double)Cx_grp[0][0]);
+    Cx_grp11 = creal((double)Cx_grp[1][1]);
+    ICC_01 = creal((double)Cx_grp[0][1])/(sqrt(Cx_grp00*Cx_grp11)+2.23e-9);
+    
+    /* estimate the short-time energy of the source and diffuse signals */
+    /* Faller, C. (2006). Multiple-loudspeaker playback of stereo signals. Journal of the Audio Engineering Society, 54(11), 1051-1064. */
+    C = crealf(Cx_grp[0][1]);
+    B = Cx_grp11 - Cx_grp00 + sqrt( pow(Cx_grp00-Cx_grp11, 2.0) + 4.0 * Cx_grp00*Cx_grp11 * pow(ICC_01, 2.0));
+    A1 = B/(2.0*C + 2.23e-9);
+    A2 = (2.0*C)/(B+ 2.23e-9);
+    src_en = (2.0f*C*C)/(B+2.23e-9);
+    diff_en = Cx_grp00 - src_en;
+    src_diff_en = src_en * diff_en;
+    
+    /* Determine source azimuth (-180..180) based on the real-valued amplitude ratio */
+    if (A1<=1.0 && A1>=-1.0)
+        est_dir = A1<0.0 ? 150.0*A1 - 30.0f : 30.0*A1 - 30.0;
+    else if (A2<=1.0 && A2>=-1.0)
+        est_dir = A2<0.0 ? -(150.0*A2 - 30.0f) : -(30.0*A2 - 30.0);
+    else
+        est_dir = 0.0;
+    est_dir = est_dir*frameArgs->scaleDoAwidth; /* manipulate the width by scaling this estimate */
+    
+    /* Average source DoA over time */
+    unitSph2Cart(est_dir*M_PI/180.0f, 0.0f, est_dir_xyz);
+    unitSph2Cart(pData->prev_est_dir[grpband]*M_PI/180.0f, 0.0f, prev_est_dir_xyz);
+    for(i=0; i<3; i++)
+        est_dir_xyz_avg[i] = (1.0f-paramAvgCoeff)*est_dir_xyz[i] + paramAvgCoeff*prev_est_dir_xyz[i];
+    unitCart2Sph_aziElev( est_dir_xyz_avg, &est_dir, &dummy);
+    est_dir *= 180.0f/M_PI;
+    pData->prev_est_dir[grpband] = est_dir;
+    
+    /* estimate the mixing weights reqiured to obtain source and diffuse components via a least-square approximation */
+    w_denom = (A1*A1+1.0)*src_diff_en + diff_en*diff_en + 2.23e-9;
+    w_src[0][0] = (src_diff_en)/w_denom;
+    w_src[0][1] = w_src[0][0]*A1;
+    w_diff[0][0] = ((A1*A1)*src_diff_en + diff_en*diff_en)/w_denom;
+    w_diff[0][1] = (-A1*src_diff_en + diff_en*diff_en)/w_denom;
+    w_diff[1][0] = w_diff[0][1];
+    w_diff[1][1] = (src_diff_en + diff_en*diff_en)/w_denom;
+    
+    for(band=0; band<num_grpBands; band++){
+        /* Pull loudspeaker gains from vbap table */
+        idx2D = (int)((matlab_fmodf(est_dir+180.0f,360.0f)/pars->vbap_azi_res)+0.5f);
+        for (ls = 0; ls < nLoudspeakers; ls++)
+            gains2D[ls] = (double)pars->grid_vbap_gtable[idx2D*nLoudspeakers+ls];
+         
+        /* apply pValue normalisation (i.e. amplitude normalises the VBAP gains for low frequencies depending on room) */
+        pv_f = pData->pValues[grp_bands[band]];
+        if(pv_f != 2.0f){
+            gains2D_sum_pvf = 0.0f;
+            for (ls = 0; ls < nLoudspeakers; ls++)
+                gains2D_sum_pvf += pow(MAX(gains2D[ls], 0.0), pv_f);
+            gains2D_sum_pvf = pow(gains2D_sum_pvf, 1.0/(pv_f+2.23e-9));
+            for (ls = 0; ls < nLoudspeakers; ls++)
+                gains2D[ls] = gains2D[ls] / (gains2D_sum_pvf+2.23e-9);
+        }
+
+        /* formulate direct mixing matrix */
+        cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, MAX_NUM_OUTPUT_CHANNELS, MAX_NUM_INPUT_CHANNELS, 1, 1.0,
+                    (const double*)gains2D, 1,
+                    (const double*)w_src, MAX_NUM_INPUT_CHANNELS, 0.0,
+                    (double*)Ms_S, MAX_NUM_INPUT_CHANNELS);
+        cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, MAX_NUM_OUTPUT_CHANNELS, MAX_NUM_INPUT_CHANNELS, MAX_NUM_INPUT_CHANNELS, 1.0,
+                    (const double*)mix_LR, MAX_NUM_INPUT_CHANNELS,
+                    (const double*)w_diff, MAX_NUM_INPUT_CHANNELS, 0.0,
+                    (double*)Ms_N, MAX_NUM_INPUT_CHANNELS);
+        for(i=0; i<MAX_NUM_OUTPUT_CHANNELS; i++)
+            for(j=0; j<MAX_NUM_INPUT_CHANNELS; j++)
+                pData->new_Ms[grp_bands[band]][i][j] = cmplxf((float)Ms_S[i][j] + (float)Ms_N[i][j], 0.0f);
+        
+        /* formulate diffuse mixing matrix */
+        cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, MAX_NUM_OUTPUT_CHANNELS, MAX_NUM_INPUT_CHANNELS, MAX_NUM_INPUT_CHANNELS, 1.0,
+                    (const double*)mix_LsRs, MAX_NUM_INPUT_CHANNELS,
+                    (const double*)w_diff, MAX_NUM_INPUT_CHANNELS, 0.0f,
+                    (double*)Md_N, MAX_NUM_INPUT_CHANNELS);
+        for(i=0; i<MAX_NUM_OUTPUT_CHANNELS; i++)
+            for(j=0; j<MAX_NUM_INPUT_CHANNELS; j++)
+                pData->new_Md[grp_bands[band]][i][j] = cmplxf(pars->diff_lpf[grp_bands[band]] * (float)Md_N[i][j], 0.0f);
+    }
+}
+
+/* pool task: applies the mixing matrices of one band to the current and delayed input frames */
+static void upmix_mixingTask(void* arg, int band)
+{
+    upmix_frameArgs* frameArgs = (upmix_frameArgs*)arg;
+    upmix_data *pData = (upmix_data*)(frameArgs->hUpmx);
+    int t, ch;
+    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
+    
+    cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, MAX_NUM_OUTPUT_CHANNELS, TIME_SLOTS, MAX_NUM_INPUT_CHANNELS, &calpha,
+                (const float*)pData->new_Ms[band], MAX_NUM_INPUT_CHANNELS,
+                (const float*)pData->inputframeTF[band], TIME_SLOTS, &cbeta,
+                (float*)pData->directframeTF[band], TIME_SLOTS);
+    cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, MAX_NUM_OUTPUT_CHANNELS, TIME_SLOTS, MAX_NUM_INPUT_CHANNELS, &calpha,
+                (const float*)pData->new_Md[band], MAX_NUM_INPUT_CHANNELS,
+                (const float*)pData->inputframeTF_del[band], TIME_SLOTS, &cbeta,
+                (float*)pData->diffuseframeTF[band], TIME_SLOTS);
+    /* combine */
+    for(ch=0; ch<MAX_NUM_OUTPUT_CHANNELS; ch++)
+        for(t=0; t<TIME_SLOTS; t++)
+            pData->outputframeTF[band][ch][t] = ccaddf(pData->directframeTF[band][ch][t], pData->diffuseframeTF[band][ch][t]);
 }
 
 void upmix_process
@@ -145,39 +327,43 @@ void upmix_process
 )
 {
     upmix_data *pData = (upmix_data*)(hUpmx);
-    codecPars* pars = pData->pars;
-    int t, sample, ch, i, j, k, band, grpband, num_grpBands, idx2D, ls;
-    int* grp_bands;
-    float est_dir, dummy;
-    double Cx_grp00, Cx_grp11, ICC_01, A1, A2, B, C, src_en, diff_en, src_diff_en, w_denom;
-    double pv_f, gains2D_sum_pvf;
-    float est_dir_xyz[3], prev_est_dir_xyz[3], est_dir_xyz_avg[3];
-    double gains2D[MAX_NUM_OUTPUT_CHANNELS];
-    double w_src[1][2], w_diff[2][2];
-    double Ms_S[MAX_NUM_OUTPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS];
-    double Ms_N[MAX_NUM_OUTPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS];
-    double Md_N[MAX_NUM_OUTPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS];
-    float_complex new_Cx[MAX_NUM_INPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS];
-    float_complex Cx_grp[MAX_NUM_INPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS];
-    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
-    const double mix_LR[MAX_NUM_OUTPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS] = { {sqrt(4.0), 0.0}, {0.0, sqrt(4.0)}, {0.0, 0.0f}, {0.0, 0.0}, {0.0, 0.0}};
-    const double mix_LsRs[MAX_NUM_OUTPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS] = { { 0.0, 0.0}, {0.0,  0.0}, {0.0, 0.0}, {sqrt(4.0), 0.0}, {0.0, sqrt(4.0)}};
-    
-    /* local copies of user parameters */
-    int nLoudspeakers;
-    float paramAvgCoeff, scaleDoAwidth, covAvg;
+    const userPars* up;
+    codecPars* pars, *newPars;
+    upmix_frameArgs frameArgs;
+    void* hPool;
+    int t, sample, ch, i, band;
+    
+    /* consistent snapshot of the user parameters for this frame */
+    up = (const userPars*)saf_paramBlock_read(pData->hUserPars, USER_PARS_AUDIO);
     
-    /* reinitialise codec if needed */
-    if(pData->reInitCodec){
-        pData->reInitCodec = 2;
-        upmix_initCodec(hUpmx);
-        pData->reInitCodec = 0;
+    /* pick up newly published codec parameters (built on the worker thread, see "upmix_codecWorker"), and hand the
+     * previous ones back to the worker thread for freeing. The DoA smoothing state only carries over if the band
+     * grouping is unchanged */
+    newPars = (codecPars*)saf_atomic_exchangep(&(pData->pendingPars), NULL);
+    if(newPars!=NULL){
+        if( (pData->pars==NULL) || (pData->pars->nGrpBands!=newPars->nGrpBands) )
+            memset(pData->prev_est_dir, 0, HYBRID_BANDS*sizeof(float));
+        upmix_retireCodecPars(hUpmx, pData->pars);
+        pData->pars = newPars;
     }
-    if ((nSamples == FRAME_SIZE) && (isPlaying == 1) && (pData->reInitCodec == 0) ) {
-        nLoudspeakers = pData->nLoudspeakers;
-        paramAvgCoeff = pData->paramAvgCoeff;
-        scaleDoAwidth = pData->scaleDoAwidth;
-        covAvg = pData->covAvg;
+    pars = pData->pars;
+    
+    if ((nSamples == FRAME_SIZE) && (isPlaying == 1) && (pars != NULL) ) {
+        SAF_RT_SCOPE_BEGIN;
+        SAF_PROFILE_BEGIN(pData->hProf, "total");
+        hPool = saf_atomic_loadp(&(pData->hPool));
+        frameArgs.hUpmx = hUpmx;
+        frameArgs.pars = pars;
+        frameArgs.nLoudspeakers = pars->nLoudspeakers;
+        frameArgs.paramAvgCoeff = up->paramAvgCoeff;
+        frameArgs.scaleDoAwidth = up->scaleDoAwidth;
+        frameArgs.covAvg = up->covAvg;
+        
+        /* update the pValues, if the coefficient has changed */
+        if(up->pValueCoeff != pData->pValueCoeff){
+            getPvalues(up->pValueCoeff, pData->freqVector, HYBRID_BANDS, pData->pValues);
+            pData->pValueCoeff = up->pValueCoeff;
+        }
     
         /* Load time-domain data */
         for(i=0; i < MIN(MAX_NUM_INPUT_CHANNELS,nInputs); i++)
@@ -186,6 +372,7 @@ void upmix_process
             memset(pData->inputFrameTD[i], 0, FRAME_SIZE * sizeof(float));
         
         /* Apply time-frequency transform (TFT) */
+        SAF_PROFILE_BEGIN(pData->hProf, "afSTFTforward");
         for ( t=0; t< TIME_SLOTS; t++) {
             for( ch=0; ch < MAX_NUM_INPUT_CHANNELS; ch++)
                 for ( sample=0; sample < HOP_SIZE; sample++)
@@ -196,118 +383,21 @@ void upmix_process
             for( ch=0; ch < MAX_NUM_INPUT_CHANNELS; ch++)
                 for ( t=0; t<TIME_SLOTS; t++)
                     pData->inputframeTF[band][ch][t] = cmplxf(pData->STFTInputFrameTF[t][ch].re[band], pData->STFTInputFrameTF[t][ch].im[band]);
+        SAF_PROFILE_END(pData->hProf, "afSTFTforward");
    
-        /* update covarience matrix per band */
-        for(band=0; band<HYBRID_BANDS; band++){
-            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, MAX_NUM_INPUT_CHANNELS, MAX_NUM_INPUT_CHANNELS, TIME_SLOTS, &calpha,
-                        pData->inputframeTF[band], TIME_SLOTS,
-                        pData->inputframeTF[band], TIME_SLOTS, &cbeta,
-                        new_Cx, MAX_NUM_INPUT_CHANNELS);
-            
-            /* average over time */
-            for(i=0; i<MAX_NUM_INPUT_CHANNELS; i++)
-                for(j=0; j<MAX_NUM_INPUT_CHANNELS; j++)
-                    pData->Cx[band][i][j] = new_Cx[i][j]*(1.0f-covAvg) + pData->Cx[band][i][j] * covAvg;
-        }
+        /* update covarience matrix per band (the band-parallel stages are spread over the thread pool, if any, and
+         * each is complete before the next one starts) */
+        SAF_PROFILE_BEGIN(pData->hProf, "covariance");
+        saf_pool_run(hPool, upmix_covarianceTask, (void*)&frameArgs, HYBRID_BANDS);
+        SAF_PROFILE_END(pData->hProf, "covariance");
         
-        /* Calculate mixing matrices for upmixing */
-        for (grpband = 0; grpband < pars->nGrpBands-1; grpband++) {
-            /* define which bands make up the bark/erb scale grouping */
-            num_grpBands = pars->grp_idx[grpband+1] - pars->grp_idx[grpband];
-            grp_bands = (int*)malloc(num_grpBands*sizeof(int));
-            for(i=pars->grp_idx[grpband], j=0; i<pars->grp_idx[grpband+1]; i++, j++)
-                grp_bands[j] = i-1; /* -1 as the indices start from 1 */
-            
-            /* sum the covarience matrices for these grouped bands and calculate ICC between left and right channels */
-            memset(Cx_grp, 0, MAX_NUM_INPUT_CHANNELS*MAX_NUM_INPUT_CHANNELS*sizeof(float_complex));
-            for(i=0; i<num_grpBands; i++)
-                for(j=0; j<MAX_NUM_INPUT_CHANNELS; j++)
-                    for(k=0; k<MAX_NUM_INPUT_CHANNELS; k++)
-                        Cx_grp[j][k] = ccaddf(Cx_grp[j][k], pData->Cx[grp_bands[i]][j][k]);
-            Cx_grp00 = creal((double)Cx_grp[0][0]);
-            Cx_grp11 = creal((double)Cx_grp[1][1]);
-            ICC_01 = creal((double)Cx_grp[0][1])/(sqrt(Cx_grp00*Cx_grp11)+2.23e-9);
-            
-            /* estimate the short-time energy of the source and diffuse signals */
-            /* Faller, C. (2006). Multiple-loudspeaker playback of stereo signals. Journal of the Audio Engineering Society, 54(11), 1051-1064. */
-            C = crealf(Cx_grp[0][1]);
-            B = Cx_grp11 - Cx_grp00 + sqrt( pow(Cx_grp00-Cx_grp11, 2.0) + 4.0 * Cx_grp00*Cx_grp11 * pow(ICC_01, 2.0));
-            A1 = B/(2.0*C + 2.23e-9);
-            A2 = (2.0*C)/(B+ 2.23e-9);
-            src_en = (2.0f*C*C)/(B+2.23e-9);
-            diff_en = Cx_grp00 - src_en;
-            src_diff_en = src_en * diff_en;
-            
-            /* Determine source azimuth (-180..180) based on the real-valued amplitude ratio */
-            if (A1<=1.0 && A1>=-1.0)
-                est_dir = A1<0.0 ? 150.0*A1 - 30.0f : 30.0*A1 - 30.0;
-            else if (A2<=1.0 && A2>=-1.0)
-                est_dir = A2<0.0 ? -(150.0*A2 - 30.0f) : -(30.0*A2 - 30.0);
-            else
-                est_dir = 0.0;
-            est_dir = est_dir*scaleDoAwidth; /* manipulate the width by scaling this estimate */
-            
-            /* Average source DoA over time */
-            unitSph2Cart(est_dir*M_PI/180.0f, 0.0f, est_dir_xyz);
-            unitSph2Cart(pars->prev_est_dir[grpband]*M_PI/180.0f, 0.0f, prev_est_dir_xyz);
-            for(i=0; i<3; i++)
-                est_dir_xyz_avg[i] = (1.0f-paramAvgCoeff)*est_dir_xyz[i] + paramAvgCoeff*prev_est_dir_xyz[i];
-            unitCart2Sph_aziElev( est_dir_xyz_avg, &est_dir, &dummy);
-            est_dir *= 180.0f/M_PI;
-            pars->prev_est_dir[grpband] = est_dir;
-            
-            /* estimate the mixing weights reqiured to obtain source and diffuse components via a least-square approximation */
-            w_denom = (A1*A1+1.0)*src_diff_en + diff_en*diff_en + 2.23e-9;
-            w_src[0][0] = (src_diff_en)/w_denom;
-            w_src[0][1] = w_src[0][0]*A1;
-            w_diff[0][0] = ((A1*A1)*src_diff_en + diff_en*diff_en)/w_denom;
-            w_diff[0][1] = (-A1*src_diff_en + diff_en*diff_en)/w_denom;
-            w_diff[1][0] = w_diff[0][1];
-            w_diff[1][1] = (src_diff_en + diff_en*diff_en)/w_denom;
-            
-            for(band=0; band<num_grpBands; band++){
-                /* Pull loudspeaker gains from vbap table */
-                idx2D = (int)((matlab_fmodf(est_dir+180.0f,360.0f)/pars->vbap_azi_res)+0.5f);
-                for (ls = 0; ls < nLoudspeakers; ls++)
-                    gains2D[ls] = (double)pars->grid_vbap_gtable[idx2D*nLoudspeakers+ls];
-                 
-                /* apply pValue normalisation (i.e. amplitude normalises the VBAP gains for low frequencies depending on room) */
-                pv_f = pData->pValues[grp_bands[band]];
-                if(pv_f != 2.0f){
-                    gains2D_sum_pvf = 0.0f;
-                    for (ls = 0; ls < nLoudspeakers; ls++)
-                        gains2D_sum_pvf += pow(MAX(gains2D[ls], 0.0), pv_f);
-                    gains2D_sum_pvf = pow(gains2D_sum_pvf, 1.0/(pv_f+2.23e-9));
-                    for (ls = 0; ls < nLoudspeakers; ls++)
-                        gains2D[ls] = gains2D[ls] / (gains2D_sum_pvf+2.23e-9);
-                }
-
-                /* formulate direct mixing matrix */
-                cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, MAX_NUM_OUTPUT_CHANNELS, MAX_NUM_INPUT_CHANNELS, 1, 1.0,
-                            (const double*)gains2D, 1,
-                            (const double*)w_src, MAX_NUM_INPUT_CHANNELS, 0.0,
-                            (double*)Ms_S, MAX_NUM_INPUT_CHANNELS);
-                cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, MAX_NUM_OUTPUT_CHANNELS, MAX_NUM_INPUT_CHANNELS, MAX_NUM_INPUT_CHANNELS, 1.0,
-                            (const double*)mix_LR, MAX_NUM_INPUT_CHANNELS,
-                            (const double*)w_diff, MAX_NUM_INPUT_CHANNELS, 0.0,
-                            (double*)Ms_N, MAX_NUM_INPUT_CHANNELS);
-                for(i=0; i<MAX_NUM_OUTPUT_CHANNELS; i++)
-                    for(j=0; j<MAX_NUM_INPUT_CHANNELS; j++)
-                        pData->new_Ms[grp_bands[band]][i][j] = cmplxf((float)Ms_S[i][j] + (float)Ms_N[i][j], 0.0f);
-                
-                /* formulate diffuse mixing matrix */
-                cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, MAX_NUM_OUTPUT_CHANNELS, MAX_NUM_INPUT_CHANNELS, MAX_NUM_INPUT_CHANNELS, 1.0,
-                            (const double*)mix_LsRs, MAX_NUM_INPUT_CHANNELS,
-                            (const double*)w_diff, MAX_NUM_INPUT_CHANNELS, 0.0f,
-                            (double*)Md_N, MAX_NUM_INPUT_CHANNELS);
-                for(i=0; i<MAX_NUM_OUTPUT_CHANNELS; i++)
-                    for(j=0; j<MAX_NUM_INPUT_CHANNELS; j++)
-                        pData->new_Md[grp_bands[band]][i][j] = cmplxf(pars->diff_lpf[grp_bands[band]] * (float)Md_N[i][j], 0.0f);
-            }
-            free(grp_bands);
-        }
+        /* Calculate mixing matrices for upmixing, per group of bands */
+        SAF_PROFILE_BEGIN(pData->hProf, "mixingMatrices");
+        saf_pool_run(hPool, upmix_mixingMatricesTask, (void*)&frameArgs, pars->nGrpBands-1);
+        SAF_PROFILE_END(pData->hProf, "mixingMatrices");
         
         /* obtain delayed inputframe */
+        SAF_PROFILE_BEGIN(pData->hProf, "mixing");
         for(t=0; t<TIME_SLOTS; t++){
             for(band=0; band<HYBRID_BANDS; band++){
                 for(ch=0; ch<MAX_NUM_INPUT_CHANNELS; ch++){
@@ -325,22 +415,11 @@ void upmix_process
         }
         
         /* Apply mixing matrices to current and delayed intputframe */
-        for(band=0; band<HYBRID_BANDS; band++){
-            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, MAX_NUM_OUTPUT_CHANNELS, TIME_SLOTS, MAX_NUM_INPUT_CHANNELS, &calpha,
-                        (const float*)pData->new_Ms[band], MAX_NUM_INPUT_CHANNELS,
-                        (const float*)pData->inputframeTF[band], TIME_SLOTS, &cbeta,
-                        (float*)pData->directframeTF[band], TIME_SLOTS);
-            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, MAX_NUM_OUTPUT_CHANNELS, TIME_SLOTS, MAX_NUM_INPUT_CHANNELS, &calpha,
-                        (const float*)pData->new_Md[band], MAX_NUM_INPUT_CHANNELS,
-                        (const float*)pData->inputframeTF_del[band], TIME_SLOTS, &cbeta,
-                        (float*)pData->diffuseframeTF[band], TIME_SLOTS);
-            /* combine */
-            for(ch=0; ch<MAX_NUM_OUTPUT_CHANNELS; ch++)
-                for(t=0; t<TIME_SLOTS; t++)
-                    pData->outputframeTF[band][ch][t] = ccaddf(pData->directframeTF[band][ch][t], pData->diffuseframeTF[band][ch][t]);
-        }
+        saf_pool_run(hPool, upmix_mixingTask, (void*)&frameArgs, HYBRID_BANDS);
+        SAF_PROFILE_END(pData->hProf, "mixing");
         
         /* inverse-TFT */
+        SAF_PROFILE_BEGIN(pData->hProf, "afSTFTinverse");
         for (band = 0; band < HYBRID_BANDS; band++) {
             for (ch = 0; ch < MAX_NUM_OUTPUT_CHANNELS; ch++) {
                 for (t = 0; t < TIME_SLOTS; t++) {
@@ -358,6 +437,9 @@ void upmix_process
                 for (sample = 0; sample < HOP_SIZE; sample++)
                     outputs[ch][sample + t* HOP_SIZE] = 0.0f;
         }
+        SAF_PROFILE_END(pData->hProf, "afSTFTinverse");
+        SAF_PROFILE_END(pData->hProf, "total");
+        SAF_RT_SCOPE_END;
     }
     else{
         for (ch=0; ch < nOutputs; ch++)
@@ -365,32 +447,51 @@ void upmix_process
     } 
 }
 
+void upmix_waitForCodecInit(void* const hUpmx)
+{
+    upmix_data *pData = (upmix_data*)(hUpmx);
+    saf_worker_wait(pData->hWorker);
+}
+
 
 /* Set Functions */
 
+void upmix_setThreadPool(void* const hUpmx, void* const hPool)
+{
+    upmix_data *pData = (upmix_data*)(hUpmx);
+    saf_atomic_storep(&(pData->hPool), hPool);
+}
+
 void upmix_setPValueCoeff(void* const hUpmx, float newValue)
 {
     upmix_data *pData = (upmix_data*)(hUpmx);
-    pData->pValueCoeff = newValue;
-    getPvalues(pData->pValueCoeff, pData->freqVector, HYBRID_BANDS, pData->pValues);
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->pValueCoeff = newValue;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void upmix_setParamAvgCoeff(void* const hUpmx, float newValue)
 {
     upmix_data *pData = (upmix_data*)(hUpmx);
-    pData->paramAvgCoeff = newValue;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->paramAvgCoeff = newValue;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void upmix_setScaleDoAwidth(void* const hUpmx, float newValue)
 {
     upmix_data *pData = (upmix_data*)(hUpmx);
-    pData->scaleDoAwidth = newValue;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->scaleDoAwidth = newValue;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 void upmix_setCovAvg(void* const hUpmx, float newValue)
 {
     upmix_data *pData = (upmix_data*)(hUpmx);
-    pData->covAvg = newValue;
+    userPars* up = (userPars*)saf_paramBlock_edit(pData->hUserPars);
+    up->covAvg = newValue;
+    saf_paramBlock_publish(pData->hUserPars);
 }
 
 
@@ -399,25 +500,40 @@ void upmix_setCovAvg(void* const hUpmx, float newValue)
 float upmix_getPValueCoeff(void* const hUpmx)
 {
     upmix_data *pData = (upmix_data*)(hUpmx);
-    return pData->pValueCoeff;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->pValueCoeff;
 }
 
 float upmix_getParamAvgCoeff(void* const hUpmx)
 {
     upmix_data *pData = (upmix_data*)(hUpmx);
-    return pData->paramAvgCoeff;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->paramAvgCoeff;
 }
 
 float upmix_getScaleDoAwidth(void* const hUpmx)
 {
     upmix_data *pData = (upmix_data*)(hUpmx);
-    return pData->scaleDoAwidth;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->scaleDoAwidth;
 }
 
 float upmix_getCovAvg(void* const hUpmx)
 {
     upmix_data *pData = (upmix_data*)(hUpmx);
-    return pData->covAvg;
+    const userPars* up = (const userPars*)saf_paramBlock_peek(pData->hUserPars);
+    return up->covAvg;
+}
+
+int upmix_getProcessingDelay(void)
+{
+    return afSTFTdelay(HOP_SIZE, 0, 1);
+}
+
+void* upmix_getProfiler(void* const hUpmx)
+{
+    upmix_data *pData = (upmix_data*)(hUpmx);
+    return pData->hProf;
 }
 
 
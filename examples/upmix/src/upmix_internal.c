@@ -100,23 +100,84 @@ static void groupBands
 }
 
 
+void upmix_requestCodecInit(void* const hUpmx)
+{
+    upmix_data *pData = (upmix_data*)(hUpmx);
+    
+    saf_atomic_storei(&(pData->reInitCodec), 1);
+    saf_worker_post(pData->hWorker);
+}
+
+void upmix_codecWorker(void* hUpmx)
+{
+    upmix_data *pData = (upmix_data*)(hUpmx);
+    codecPars* pars, *next;
+    
+    saf_atomic_storei(&(pData->reInitCodec), 2);
+    
+    /* free the codec parameters the audio thread is no longer using */
+    pars = (codecPars*)saf_atomic_exchangep(&(pData->retiredPars), NULL);
+    for(; pars!=NULL; pars = next){
+        next = pars->next;
+        upmix_freeCodecPars(&pars);
+    }
+    
+    /* build fresh codec parameters (if the sampling rate is changed in the meantime, the job is posted again and these
+     * will be superseded) */
+    pars = (codecPars*)calloc(1, sizeof(codecPars));
+    upmix_initCodec(hUpmx, pars);
+    
+    /* publish them; if the audio thread never picked up the previously published ones, they are not needed anymore */
+    pars = (codecPars*)saf_atomic_exchangep(&(pData->pendingPars), (void*)pars);
+    upmix_freeCodecPars(&pars);
+    
+    /* done, unless another reinitialisation has been requested in the meantime */
+    saf_atomic_casi(&(pData->reInitCodec), 2, 0);
+}
+
+void upmix_freeCodecPars(codecPars** const ppars)
+{
+    codecPars* pars = *ppars;
+    
+    if(pars!=NULL){
+        free(pars->grid_vbap_gtable);
+        free(pars->grp_idx);
+        free(pars->grp_freqs);
+        free(pars);
+        *ppars = NULL;
+    }
+}
+
+void upmix_retireCodecPars(void* const hUpmx, codecPars* const pars)
+{
+    upmix_data *pData = (upmix_data*)(hUpmx);
+    void* head;
+    
+    if(pars==NULL)
+        return;
+    /* lock-free push; the worker thread only ever takes the whole list at once, so there is no ABA problem */
+    do{
+        head = saf_atomic_loadp(&(pData->retiredPars));
+        pars->next = (codecPars*)head;
+    } while(!saf_atomic_casp(&(pData->retiredPars), head, (void*)pars));
+}
+
 void upmix_initCodec
 (
-    void* const hUpmx
+    void* const hUpmx,
+    codecPars* const pars
 )
 {
     upmix_data *pData = (upmix_data*)(hUpmx);
-    codecPars* pars = pData->pars;
     int i, j;
     
     /* generate VBAP gain table for the grid */
     pars->vbap_azi_res = 1;
-    pData->nLoudspeakers = MAX_NUM_OUTPUT_CHANNELS;
-    for(i=0; i<pData->nLoudspeakers; i++)
+    pars->nLoudspeakers = MAX_NUM_OUTPUT_CHANNELS;
+    for(i=0; i<pars->nLoudspeakers; i++)
         for(j=0; j<2; j++)
-            pData->loudpkrs_dirs_deg[i][j] = __5pX_dirs_deg[i][j]; /* only stereo to 5.x is currently supported */
-    free(pars->grid_vbap_gtable);
-    generateVBAPgainTable2D((float*)pData->loudpkrs_dirs_deg, pData->nLoudspeakers, pars->vbap_azi_res , &(pars->grid_vbap_gtable), &(pars->grid_N_vbap_gtable), &(pars->grid_nPairs));
+            pars->loudpkrs_dirs_deg[i][j] = __5pX_dirs_deg[i][j]; /* only stereo to 5.x is currently supported */
+    generateVBAPgainTable2D((float*)pars->loudpkrs_dirs_deg, pars->nLoudspeakers, pars->vbap_azi_res , &(pars->grid_vbap_gtable), &(pars->grid_N_vbap_gtable), &(pars->grid_nPairs));
     
     /* define band grouping */
     pars->maxGrpFreq = MAX_GROUP_FREQ;
@@ -124,10 +185,6 @@ void upmix_initCodec
     
     /* low-pass filter */
     memcpy(pars->diff_lpf, __diff_lpf, HYBRID_BANDS*sizeof(float));
-    
-    /* for averaging DoA estimate over time */
-    free(pars->prev_est_dir);
-    pars->prev_est_dir = calloc(pars->nGrpBands,sizeof(float));
 }
 
 
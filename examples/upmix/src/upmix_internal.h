@@ -34,7 +34,6 @@
 #include <math.h>
 #include <string.h>
 #include "upmix.h"
-#include "upmix_database.h"
 #define SAF_ENABLE_VBAP     /* for VBAP gains */
 #define SAF_ENABLE_SH       /* for cart2sph and sph2cart */
 #define SAF_ENABLE_AFSTFT   /* for time-frequency transform */
@@ -56,13 +55,28 @@ extern "C" {
 #define MAX_GROUP_FREQ ( 18000 )                     /* Hz, past this point bands are grouped into 1 */
 #define DIFFUSE_DELAY_MS ( 30.0f )                   /* diffuse stream delay in ms */
 #define DIFFUSE_DELAY_TIME_SLOTS ( 11 )              /* diffuse stream delay in time slots (11==30ms approx). (bit lazy I know..) */
+#define USER_PARS_AUDIO ( 0 )                        /* user parameter block reader index of the audio thread */
     
 /***********/
 /* Structs */
 /***********/
     
+/* user parameters; edited by the set functions, and read by the audio thread (see saf_paramBlock) */
+typedef struct _userPars
+{
+    float pValueCoeff;       /* pValue coefficient; 0..1; 0: normal room, 0.5: listening room, 1: anechoic */
+    float paramAvgCoeff;     /* coefficient for the one-pole filter that smooths the estimated parameters over time; 0..1 */
+    float scaleDoAwidth;     /* influences the stage width. 0: only centre, 0.5: -90..90 azimuth, 1: -180..180 azimuth */
+    float covAvg;            /* coefficient for the one-pole filter that smooths the covarience matrix over time; 0..1 */
+    
+}userPars;
+    
 typedef struct _codecPars
 {
+    /* loudspeaker set-up */
+    float loudpkrs_dirs_deg[MAX_NUM_OUTPUT_CHANNELS][2]; /* currently only stereo to 5.x is supported */
+    int nLoudspeakers;                                 /* number of loudspeakers in the target set-up */
+    
     /* 2D VBAP gain table */
     float* grid_vbap_gtable;                           /* 2D gain table to pan the source signal to estimated azimuth */
     int grid_nPairs;                                   /* number of loudspeaker pairs in vbap gain table */
@@ -78,8 +92,7 @@ typedef struct _codecPars
     /* low-pass filter */
     float diff_lpf[HYBRID_BANDS];                      /* low-pass filter applied to the diffuse stream */
     
-    /* for smoothing DoA over time */
-    float* prev_est_dir;                               /* degrees, previous estimated source direction per band grouping; nGrpBands x 1 */
+    struct _codecPars* next;                           /* next entry in the list of retired codec parameters */
     
 }codecPars;
     
@@ -104,10 +117,15 @@ typedef struct _upmix
     void* hSTFT;                        /* handle for the afSTFT time.frequency transform */
     
     /* internal parameters */
-    codecPars* pars;                    /* handle for codec parameters */
-    float pValues[HYBRID_BANDS];        /* VBAP normalisation coefficients per band */
+    codecPars* pars;                    /* codec parameters currently used for the upmixing (audio thread only) */
+    void* volatile pendingPars;         /* new codec parameters published by the worker thread (codecPars*) */
+    void* volatile retiredPars;         /* codec parameters no longer used by the audio thread, freed by the worker thread (codecPars*) */
+    void* hWorker;                      /* worker thread, which (re)initialises the codec parameters */
+    float pValues[HYBRID_BANDS];        /* VBAP normalisation coefficients per band (audio thread) */
+    float pValueCoeff;                  /* pValue coefficient "pValues" were computed for; -1: not computed yet */
     float freqVector[HYBRID_BANDS];     /* frequency vector for processing */ 
-    int reInitCodec;                    /* flag. 0: no init required, 1: init required, 2: init ongoing */
+    volatile int reInitCodec;           /* flag. 0: no init required, 1: init required, 2: init ongoing (on the worker thread) */
+    float prev_est_dir[HYBRID_BANDS];   /* degrees, previous estimated source direction per band grouping (for smoothing the DoA over time) */
     float_complex Cx[HYBRID_BANDS][MAX_NUM_INPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS];
     float_complex new_Ms[HYBRID_BANDS][MAX_NUM_OUTPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS];
     float_complex new_Md[HYBRID_BANDS][MAX_NUM_OUTPUT_CHANNELS][MAX_NUM_INPUT_CHANNELS];
@@ -115,22 +133,46 @@ typedef struct _upmix
     float_complex diffuseframeTF[HYBRID_BANDS][MAX_NUM_OUTPUT_CHANNELS][TIME_SLOTS];
     
     /* user parameters */
-    float loudpkrs_dirs_deg[MAX_NUM_OUTPUT_CHANNELS][2]; /* currently only stereo to 5.x is supported */
-    int nLoudspeakers;       /* number of loudspeakers in the target set-up */
-    float pValueCoeff;       /* pValue coefficient; 0..1; 0: normal room, 0.5: listening room, 1: anechoic */
-    float paramAvgCoeff;     /* coefficient for the one-pole filter that smooths the estimated parameters over time; 0..1 */
-    float scaleDoAwidth;     /* influences the stage width. 0: only centre, 0.5: -90..90 azimuth, 1: -180..180 azimuth */
-    float covAvg;            /* coefficient for the one-pole filter that smooths the covarience matrix over time; 0..1 */
+    void* hUserPars;         /* parameter block of "userPars"; edited by the set functions, read by the audio thread */
+    void* hProf;             /* per-stage timing of the processing loop (see saf_profiler.h) */
+    void* volatile hPool;    /* thread pool for processing the bands in parallel (see saf_threads.h); NULL: none */
     
 } upmix_data;
+
+/* arguments of the band-parallel stages of one frame (see "upmix_process") */
+typedef struct _upmix_frameArgs
+{
+    void* hUpmx;             /* upmix handle */
+    codecPars* pars;         /* codec parameters of this frame */
+    int nLoudspeakers;       /* parameters of this frame */
+    float paramAvgCoeff;
+    float scaleDoAwidth;
+    float covAvg;
+    
+} upmix_frameArgs;
      
 
 /**********************/
 /* Internal functions */
 /**********************/
     
+/* Flags the codec parameters for reinitialisation, which is carried out on the worker thread. Not for the audio thread */
+void upmix_requestCodecInit(void* const hUpmx);    /* upmix handle */
+
+/* Worker thread job: builds a fresh set of codec parameters and publishes them to the audio thread. Also frees any
+ * codec parameters the audio thread has since retired */
+void upmix_codecWorker(void* hUpmx);               /* upmix handle */
+
+/* Frees a set of codec parameters */
+void upmix_freeCodecPars(codecPars** const ppars); /* & address of codec parameters */
+
+/* Hands codec parameters no longer in use over to the worker thread for freeing; lock-free, for the audio thread */
+void upmix_retireCodecPars(void* const hUpmx,      /* upmix handle */
+                           codecPars* const pars); /* codec parameters to retire */
+    
 /* Intialises the codec parameters */
-void upmix_initCodec(void* const hUpmx);           /* upmix handle */
+void upmix_initCodec(void* const hUpmx,            /* upmix handle */
+                     codecPars* const pars);       /* codec parameters to initialise (freshly allocated) */
 
     
 #ifdef __cplusplus
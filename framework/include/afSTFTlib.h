@@ -75,16 +75,42 @@ typedef struct
 } afHybrid;
 
 
+/* Centre frequencies of the hybrid filterbank (hopSize=128, hybridMode=1), shared by all examples */
+extern const float __afCenterFreq48e3[133];
+extern const float __afCenterFreq44100[133];
+
 /* Call these */
 
 void afSTFTinit(void** handle, int hopSize, int inChannels, int outChannels, int LDmode, int hybridMode);
 
 void afSTFTforward(void* handle, float** inTD, complexVector* outFD);
 
+/* As afSTFTforward, but only for the input channels listed in "channels" (NULL: the first nChannels channels); the
+ * inputs and outputs of the others are not touched. The memory of a skipped channel does not advance, so it must be
+ * cleared with afSTFTclearChannel before the channel is transformed again. A channel should therefore only be skipped
+ * once its input has been negligible for at least afSTFTtail samples */
+void afSTFTforwardChannels(void* handle, float** inTD, complexVector* outFD, const int* channels, int nChannels);
+
+/* Clears the memory of an input channel, as if its past input had been silent */
+void afSTFTclearChannel(void* handle, int ch);
+
 void afSTFTinverse(void* handle, complexVector* inFD, float** outTD);
 
+/* As afSTFTinverse, but only for the output channels listed in "channels" (NULL: the first nChannels channels); the
+ * outputs of the others are not touched. A skipped channel keeps the memory it had, so it should only be skipped once
+ * it has been given silent input for at least afSTFTtail samples, after which its memory is empty */
+void afSTFTinverseChannels(void* handle, complexVector* inFD, float** outTD, const int* channels, int nChannels);
+
 void afSTFTfree(void* handle);
 
+/* Returns the delay (in samples) between afSTFTforward input and afSTFTinverse output for the given configuration:
+ * the group delay of the prototype filters (9 hops, or 4 in low-delay mode), plus 3 hops for the hybrid filtering */
+int afSTFTdelay(int hopSize, int LDmode, int hybridMode);
+
+/* Returns the number of most recent input samples (per channel) that the output of afSTFTforward depends on: the length
+ * of the prototype filter (10 hops), plus 6 hops of hybrid filtering */
+int afSTFTtail(int hopSize, int hybridMode);
+
 void vtInitFFT(void** planPr, float* timeData, float* frequencyData, int log2n);
 
 void vtFreeFFT(void* planPr);
@@ -98,8 +124,12 @@ void afHybridInit(void** handle, int hopSize, int inChannels, int outChannels);
 
 void afHybridForward(void* handle, complexVector* FD);
 
+void afHybridForwardChannels(void* handle, complexVector* FD, const int* channels, int nChannels);
+
 void afHybridInverse(void* handle, complexVector* FD);
 
+void afHybridInverseChannels(void* handle, complexVector* FD, const int* channels, int nChannels);
+
 void afHybridFree(void* handle);
 
 #endif /* defined(__afSTFTlib_tester__afSTFTlib__) */
@@ -32,13 +32,19 @@
 /* SAF Utilities:
  *     Contains a collection of useful memory allocation functions and cross-platform
  *     complex number wrappers. Optimised linear algebra routines utilising BLAS and LAPACK
- *     are also included.
+ *     are also included, as are lock-free atomics and a worker thread for carrying out
+ *     (re)initialisations away from the audio thread.
  * Enable instructions:
  *     Cannot be disabled.
+ *     Optionally, build everything with SAF_ENABLE_RT_ALLOC_CHECK defined, to report any heap
+ *     usage within the real-time regions of the *_process functions (see saf_malloc.h), and/or
+ *     with SAF_ENABLE_PROFILER defined, to time the stages of the processing loops (see
+ *     saf_profiler.h).
  * Dependencies:
  *     Windows users only: Intel's MKL must be installed, which can be freely aquired via:
  *     https://software.intel.com/en-us/articles/free-ipsxe-tools-and-libraries
  *     Mac users only: saf_utilities will utilise Apple's Accelerate library.
+ *     Linux/Mac users only: link with pthreads.
  */
 #include "saf_utilities.h"
 
@@ -101,9 +107,10 @@
 
 
 /* SAF SOFA Reader:
- *     A simple header only SOFA file reader that returns only the bare minimum.
+ *     A simple SOFA file reader that returns only the bare minimum.
  * Enable instructions:
  *     Place: #define SAF_ENABLE_SOFA_READER, before: #include "saf.h"
+ *     The framework itself must also be built with SAF_ENABLE_SOFA_READER defined (for saf_sofa_reader.c)
  * Dependencies:
  *     netcdf library
  */
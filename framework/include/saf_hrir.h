@@ -18,7 +18,7 @@
  * Description:
  *     A collection of head-related impulse-response (HRIR)- related functions.
  * Dependencies:
- *     saf_utilities, afSTFTlib
+ *     saf_utilities, afSTFTlib, saf_vbap
  * Author, date created:
  *     Leo McCormack, 12.12.2016
  */
@@ -35,6 +35,25 @@ extern "C" {
 #ifndef M_PI
   #define M_PI ( 3.14159265359f )
 #endif
+    
+/* The default HRIR set, shared by all examples and defined once in "saf_default_hrirs.c" (distributed separately from
+ * the source code; a data file in the old double-precision format is converted with "tools/src/saf_hrir_convert.c"). The HRIRs are stored in single-precision, or in IEEE 754 half-precision if
+ * SAF_DEFAULT_HRIRS_FP16 is defined (halving the size of the data); use "getDefaultHRIRs" to access them. The symbols
+ * carry the precision in their name, so that data generated for the old double-precision declarations
+ * ("__default_hrirs", "__default_hrir_dirs_deg") fails to link, rather than being read as floats */
+#ifdef SAF_DEFAULT_HRIRS_FP16
+extern const unsigned short __default_hrirs_fp16[217][2][1024];
+#else
+extern const float __default_hrirs_f32[217][2][1024];
+#endif
+extern const float __default_hrir_dirs_deg_f32[217][2];
+extern const int __default_N_hrir_dirs;
+extern const int __default_hrir_len;
+extern const int __default_hrir_fs;
+
+/* returns the default HRIRs in single-precision; FLAT: __default_N_hrir_dirs x 2 x __default_hrir_len. The shared data
+ * is referenced directly, or, if stored in half-precision, decoded once upon first use. Do not free or modify */
+const float* getDefaultHRIRs(void);
 
 /* estimates the interaural time-differences (ITDs) for each HRIR via the cross-correlation between the left and right IRs */
 void estimateITDs(/* Input arguments */
@@ -84,6 +103,67 @@ void interpFilterbankHRTFs(/* Input arguments */
                            /* Output arguments */
                            float_complex* hrtf_interp);   /* pre-alloc, interpolated HRTFs; FLAT: N_bands x 2 x N_interp_dirs */
     
+    
+/*****************************/
+/* Shared HRTF resources     */
+/*****************************/
+    
+/* HRIR loading function, e.g. "loadSofaFile" (see saf_sofa_reader.h) */
+typedef void (*hrirLoaderFunc)(char* filepath, float** hrirs, float** hrir_dirs_deg, int* N_hrir_dirs, int* hrir_len, int* hrir_fs);
+    
+/* Processed HRTF data, which is shared (read-only) between all instances requesting the same HRIR set and filterbank
+ * configuration. The resource is loaded and processed once, reference counted, and freed when the last user releases it */
+typedef struct _hrtfResource {
+    /* key */
+    char* sofa_filepath;                                  /* file path of the HRIRs; NULL for the default HRIR set */
+    int N_bands;                                          /* number of filterbank bands */
+    float* centreFreq;                                    /* filterbank centre frequencies; N_bands x 1 */
+    /* HRIRs */
+    const float* hrirs;                                   /* time domain HRIRs; FLAT: N_hrir_dirs x 2 x hrir_len */
+    float* hrir_dirs_deg;                                 /* HRIR directions in degrees [azi elev]; FLAT: N_hrir_dirs x 2 */
+    int N_hrir_dirs;                                      /* number of HRIR directions */
+    int hrir_len;                                         /* length of the HRIRs in samples */
+    int hrir_fs;                                          /* sampling rate of the HRIRs */
+    /* processed data */
+    float* itds_s;                                        /* interaural-time differences in seconds; N_hrir_dirs x 1 */
+    float_complex* hrtf_fb;                               /* HRTFs as filterbank coeffs; FLAT: N_bands x 2 x N_hrir_dirs */
+    float* hrtf_fb_mag;                                   /* magnitudes of hrtf_fb; FLAT: N_bands x 2 x N_hrir_dirs */
+    int hrtf_vbapTableRes[2];                             /* [azi elev] step sizes of the VBAP table in degrees */
+    int N_hrtf_vbap_gtable;                               /* number of interpolation directions */
+    int hrtf_nTriangles;                                  /* number of triangles after triangulation */
+    int* hrtf_vbap_gtableIdx;                             /* compressed VBAP table indices; FLAT: N_hrtf_vbap_gtable x 3 */
+    float* hrtf_vbap_gtableComp;                          /* compressed VBAP table gains; FLAT: N_hrtf_vbap_gtable x 3 */
+    /* internal */
+    void* cacheMap;                                       /* memory-mapped cache file the processed data points into (or NULL) */
+    size_t cacheMapSize;                                  /* size of the memory-mapped cache file in bytes */
+    int refCount;
+    int loading;                                          /* 1: still being loaded, by the caller that added it */
+    int failed;                                           /* 1: loading failed (no longer in the list) */
+    struct _hrtfResource* next;
+
+}hrtfResource;
+    
+/* Returns the shared HRTF resource for the specified HRIR set and filterbank configuration; loading and processing
+ * the HRIRs only if no other instance currently holds it. Any resource already in "phRes" is released afterwards
+ * (so re-acquiring the same configuration is cheap). "phRes" is returned as NULL if the HRIRs could not be loaded or
+ * triangulated; the caller may then fall back to the default HRIR set. Thread-safe; whilst a resource is loaded, only
+ * other callers asking for the same configuration wait for it. */
+void hrtfResource_acquire(/* Input arguments */
+                          char* sofa_filepath,            /* file path of the HRIRs; NULL for the default HRIR set */
+                          hrirLoaderFunc loader,          /* function used to load "sofa_filepath"; may be NULL for defaults */
+                          float* centreFreq,              /* filterbank centre frequencies; N_bands x 1 */
+                          int N_bands,                    /* number of frequency bands */
+                          /* Output arguments */
+                          hrtfResource** phRes);          /* & address of the resource (NULL or currently held) */
+    
+/* Releases a shared HRTF resource (freeing it if this was the last user), and sets "phRes" to NULL. Thread-safe. */
+void hrtfResource_release(hrtfResource** phRes);          /* & address of the resource */
+    
+/* Enables the on-disk cache of processed HRTF data (disabled by default), by specifying the directory in which the cache
+ * files are stored; NULL disables it again. Cache files are keyed by a hash of the HRIR data and the processing
+ * configuration, and are memory-mapped when loaded; so only the HRIRs need to be read when a cached set is acquired */
+void hrtfResource_setCacheDirectory(const char* cacheDir); /* cache directory (must exist); NULL to disable */
+    
 
 #ifdef __cplusplus
 }
@@ -38,6 +38,10 @@ extern "C" {
 #ifndef M_PI
   #define M_PI ( 3.14159265359f )
 #endif
+
+/* maximum number of coarse-level maxima that "findPowermapPeaks" refines on the finer grid levels; this bounds its
+ * cost per call, regardless of the requested number of peaks */
+#define PMAP_PEAKS_MAX_CANDIDATES ( 8 )
     
 /*************************/
 /* Processing modes tags */
@@ -57,6 +61,12 @@ typedef enum _ARRAY_CONSTRUCTION_TYPES {
     ARRAY_CONSTRUCTION_DIRECTIONAL
 }ARRAY_CONSTRUCTION_TYPES;
     
+typedef enum _POWERMAP_TYPES {
+    PMAP_PWD,                  /* plane-wave decomposition (steered response power) */
+    PMAP_MVDR,                 /* minimum-variance distortionless response */
+    PMAP_MUSIC                 /* subspace-based MUSIC pseudo-spectrum */
+}POWERMAP_TYPES;
+    
 /******************/
 /* Main Functions */
 /******************/
@@ -144,12 +154,25 @@ void unitCart2Sph_aziElev(/* Input arguments */
                           float* azi_rad,         /* & azimuth in radians */
                           float* elev_rad);       /* & elevation in radians */
     
+/* creates a workspace for the powermap functions below. Given a workspace that is large enough (and is not in use
+ * by another thread), they do not allocate any memory, and may therefore be called from the audio thread. Passing
+ * NULL (or a workspace that is too small) instead is also fine, in which case a temporary workspace is used */
+void powermapWorkspace_create(/* Input arguments */
+                              void** const phWork,  /* & address of workspace handle */
+                              int maxOrder,         /* highest analysis order that the workspace will be used for */
+                              int maxNGrid_dirs);   /* largest number of grid directions that it will be used for */
+
+/* destroys the powermap workspace */
+void powermapWorkspace_destroy(/* Input arguments */
+                               void** const phWork);/* & address of workspace handle */
+
 /* generates a powermap utilising the PWD method */
 void generatePWDmap(/* Input arguments */
                     int order,                    /* analysis order */
                     float_complex* Cx,            /* covarience matrix; FLAT: (order+1)^2 x (order+1)^2 */
                     float_complex* Y_grid,        /* steering vectors for grid direcionts; FLAT: (order+1)^2 x nGrid_dirs  */
                     int nGrid_dirs,               /* number of grid directions */
+                    void* const hWork,            /* powermap workspace handle (or NULL) */
                     /* Output arguments */
                     float* pmap);                 /* resulting PWD powermap; nGrid_dirs x 1 */
 
@@ -160,6 +183,7 @@ void generateMVDRmap(/* Input arguments */
                      float_complex* Y_grid,       /* steering vectors for grid direcionts; FLAT: (order+1)^2 x nGrid_dirs  */
                      int nGrid_dirs,              /* number of grid directions */
                      float regPar,                /* regularisation parameter, for diagonal loading of Cx */
+                     void* const hWork,           /* powermap workspace handle (or NULL) */
                      /* Output arguments */
                      float* pmap,                 /* resulting MVDR powermap; nGrid_dirs x 1 */
                      float_complex* w_MVDR);      /* optional. weights will be copied to this, unless it's NULL; FLAT: nSH x nGrid_dirs || NULL */
@@ -181,6 +205,7 @@ void generateCroPaCLCMVmap(/* Input arguments */
                            int nGrid_dirs,        /* number of grid directions */
                            float regPar,          /* regularisation parameter, for diagonal loading of Cx */
                            float lambda,          /* parameter controlling how harsh CroPaC is applied, 0..1; 0: fully cropac, 1: fully mvdr */
+                           void* const hWork,     /* powermap workspace handle (or NULL) */
                            /* Output arguments */
                            float* pmap);          /* resulting CroPaC LCMV powermap; nGrid_dirs x 1 */
     
@@ -192,6 +217,7 @@ void generateMUSICmap(/* Input arguments */
                       int nSources,               /* number of sources present in sound scene */
                       int nGrid_dirs,             /* number of grid directions */
                       int logScaleFlag,           /* 1: log(pmap), 0: pmap. */
+                      void* const hWork,          /* powermap workspace handle (or NULL) */
                       /* Output arguments */
                       float* pmap);               /* resulting MUSIC pseudo-spectrum; nGrid_dirs x 1 */
 
@@ -203,9 +229,84 @@ void generateMinNormMap(/* Input arguments */
                         int nSources,             /* number of sources present in sound scene */
                         int nGrid_dirs,           /* number of grid directions */
                         int logScaleFlag,         /* 1: log(pmap), 0: pmap. */
+                        void* const hWork,        /* powermap workspace handle (or NULL) */
                         /* Output arguments */
                         float* pmap);             /* resulting MinNorm pseudo-spectrum; nGrid_dirs x 1 */
 
+/* creates a hierarchical spherical grid, by recursively subdividing an icosahedron. Level 0 comprises the 12
+ * icosahedron vertices, and each subsequent level has 10*4^l+2 points (42, 162, 642, 2562, 10242...). The grid
+ * points are nested; i.e. the points of level l are the first points of level l+1. Real spherical harmonics
+ * (N3D) up to 'order' are precomputed for the finest level */
+void hierarchicalGrid_create(/* Input arguments */
+                             void** const phHG,   /* & address of hierarchical grid handle */
+                             int nLevels,         /* number of grid levels, 1..7 */
+                             int order);          /* maximum analysis order to support */
+
+/* destroys the hierarchical grid */
+void hierarchicalGrid_destroy(/* Input arguments */
+                              void** const phHG); /* & address of hierarchical grid handle */
+
+/* returns the directions of a given grid level */
+void hierarchicalGrid_getLevel(/* Input arguments */
+                               void* const hHG,   /* hierarchical grid handle */
+                               int level,         /* grid level, 0..nLevels-1 */
+                               /* Output arguments */
+                               float** dirs_deg,  /* & grid directions, in degrees (do not free); FLAT: nDirs x 2 */
+                               int* nDirs);       /* & number of directions */
+
+/* finds the peaks of a PWD/MVDR/MUSIC powermap in a coarse-to-fine manner. The map is first evaluated over a
+ * coarse level of the hierarchical grid, and its local maxima are then refined by hill-climbing over the
+ * neighbours on each finer level; therefore, only a small fraction of the finest grid is actually evaluated.
+ * The final peak directions are further refined below the grid resolution, by taking the weighted centroid of
+ * the peak and its neighbours. Peaks are returned in descending order of their map value. Note that the map
+ * values are the same as "generatePWDmap", "generateMVDRmap" and "generateMUSICmap" (with logScaleFlag=0) would
+ * give, when given the steering vectors returned by "getRSH". At most PMAP_PEAKS_MAX_CANDIDATES peaks are refined.
+ * Worst-case cost per call: one nSH x nSH eigenvalue decomposition (MUSIC) or linear solve (MVDR), the
+ * map evaluated at all points of the coarse level, plus at most PMAP_PEAKS_MAX_CANDIDATES x 16 hill-climbing steps
+ * x 6 neighbours = 768 map evaluations per finer level; each map evaluation costs O(nSH^2) */
+void findPowermapPeaks(/* Input arguments */
+                       void* const hHG,           /* hierarchical grid handle */
+                       POWERMAP_TYPES pmapType,   /* see 'POWERMAP_TYPES' enum */
+                       int order,                 /* analysis order; no higher than the grid order */
+                       float_complex* Cx,         /* covarience matrix; FLAT: (order+1)^2 x (order+1)^2 */
+                       int nSources,              /* number of sources present in sound scene (MUSIC only) */
+                       float regPar,              /* regularisation parameter, for diagonal loading of Cx (MVDR only) */
+                       int coarseLevel,           /* grid level used for the initial (exhaustive) evaluation */
+                       int maxNumPeaks,           /* maximum number of peaks to find; no more than
+                                                   * PMAP_PEAKS_MAX_CANDIDATES are returned */
+                       /* Output arguments */
+                       float* peak_dirs_deg,      /* peak directions, in degrees; FLAT: maxNumPeaks x 2 */
+                       float* peak_vals,          /* peak map values (set to NULL if not needed); maxNumPeaks x 1 */
+                       int* nPeaks);              /* & number of peaks found */
+
+/* Real spherical harmonics (N3D, WITH the 1/sqrt(4*pi) scaling) sampled over the points of one of the
+ * "__HANDLES_geosphere_ico_dirs_deg" geospheres; shared (read-only) between all users asking for the same order and
+ * geosphere. The resource is computed when it is first acquired, reference counted, and freed when the last user
+ * releases it. Rows 0..(n+1)^2-1 hold the spherical harmonics up to any lower order n */
+typedef struct _shGridResource {
+    int order;                                    /* maximum order of the spherical harmonics */
+    int icoFreq;                                  /* frequency of the geosphere; index into "__HANDLES_geosphere_ico_dirs_deg" */
+    const float* dirs_deg;                        /* grid directions, in degrees (shared preset); FLAT: nDirs x 2 */
+    int nDirs;                                    /* number of grid directions */
+    float* Y;                                     /* spherical harmonics; FLAT: (order+1)^2 x nDirs */
+    /* internal */
+    int refCount;
+    struct _shGridResource* next;
+
+}shGridResource;
+
+/* Returns the shared spherical harmonics for the specified order and geosphere; computing them only if no other user
+ * currently holds them. Any resource already in "phRes" is released afterwards. Thread-safe; not for the audio thread */
+void shGridResource_acquire(/* Input arguments */
+                            int order,            /* maximum order of the spherical harmonics */
+                            int icoFreq,          /* frequency of the geosphere, 0..16 */
+                            /* Output arguments */
+                            shGridResource** phRes); /* & address of the resource (NULL or currently held) */
+
+/* Releases a shared spherical harmonic grid resource (freeing it if this was the last user), and sets "phRes" to
+ * NULL. Thread-safe; not for the audio thread */
+void shGridResource_release(shGridResource** phRes); /* & address of the resource */
+
 /* (cylindrical) Bessel function of the first kind: Jn
  * returns the Bessel values and their derivatives up to order N for all values in vector z  */
 void bessel_Jn(/* Input arguments */
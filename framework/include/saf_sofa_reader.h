@@ -16,7 +16,10 @@
  * Filename:
  *     saf_sofa_reader.h (include header)
  * Description:
- *     Header only sofa reader, which returns only the bare minimum.
+ *     A simple sofa reader, which returns only the bare minimum. The HRIRs are read directly in single precision and
+ *     only the retained taps (and, optionally, only a subset of the measurement positions) are read from the file; in
+ *     blocks of positions, so that large sofa files may be loaded with bounded memory and with progress reporting.
+ *     Note: the framework must be built with SAF_ENABLE_SOFA_READER defined, and linked against netcdf.
  * Dependencies:
  *     netcdf
  * Author, date created:
@@ -26,16 +29,18 @@
 #ifndef __SAF_SOFA_READER_H_INCLUDED__
 #define __SAF_SOFA_READER_H_INCLUDED__
 
-#include <math.h>
-#include <stdio.h>
-#include <string.h>
-#include <netcdf.h>
-
 #ifdef __cplusplus
 extern "C" {
 #endif
     
 #define MAX_HRIR_LENGTH 1024 /* truncates HRIRs to this length */
+#define SOFA_READER_CHUNK_SIZE 256 /* default number of measurement positions read at a time */
+    
+/* Progress callback for "loadSofaFile_subset"; called after each block of positions has been read. Return 0 to
+ * continue loading, or any other value to cancel (in which case the outputs are returned as NULL) */
+typedef int (*sofaProgressCallback)(void* userData,   /* user data passed to "loadSofaFile_subset" */
+                                    int nLoaded,      /* number of positions loaded so far */
+                                    int nTotal);      /* total number of positions to load */
     
 /* Allocates memory and copies the values of the essential data contained in a sofa file.
  * This function is not suitable for binaural room impulse responses (BRIRs), as the IRs are truncated to "MAX_HRIR_LENGTH"
@@ -49,132 +54,26 @@ void loadSofaFile(/* Input arguments */
                   int* hrir_len,              /* & length of the HRIRs in samples */
                   int* hrir_fs );             /* & sampling rate used to record HRIRs */
     
+/* Same as "loadSofaFile", but loads only the measurement positions in "dirIndices" (in that order), truncates the IRs to
+ * "maxLength" taps, and reads the file "chunkSize" positions at a time; reporting the progress via "progress" (optional).
+ * The hrirs are returned as NULL if the file does not exist, an index is out of range, or the loading was cancelled */
+void loadSofaFile_subset(/* Input arguments */
+                         char* sofa_filepath,                /* directory of the SOFA file you wish to load */
+                         int* dirIndices,                    /* indices of the positions to load; NULL to load all */
+                         int nDirIndices,                    /* number of indices in "dirIndices" */
+                         int maxLength,                      /* maximum IR length in samples (IRs are truncated) */
+                         int chunkSize,                      /* positions per read; <=0 for SOFA_READER_CHUNK_SIZE */
+                         sofaProgressCallback progress,      /* progress callback; NULL if not needed */
+                         void* userData,                     /* user data passed to "progress" */
+                         /* Output arguments */
+                         float** hrirs,                      /* & of the HRIR data; N_hrir_dirs x 2 x hrir_len */
+                         float** hrir_dirs_deg,              /* & of the HRIR positions; N_hrir_dirs x 2 */
+                         int* N_hrir_dirs,                   /* & number of HRIR positions */
+                         int* hrir_len,                      /* & length of the HRIRs in samples */
+                         int* hrir_fs );                     /* & sampling rate used to record HRIRs */
+    
 #ifdef __cplusplus
 }
 #endif
 
-#endif /* __SOFA_READER_H_INCLUDED__ */
-
-#ifdef SAF_ENABLE_SOFA_READER
-
-void loadSofaFile
-(
-    char* sofa_filepath,
-    float** hrirs,
-    float** hrir_dirs_deg,
-    int* N_hrir_dirs,
-    int* hrir_len,
-    int* hrir_fs
-)
-{
-    int i, j, k, retval,dimid[6], *dimids, ndimsp,ncid, varid;
-    size_t dimlength[6], IR_dims[3], SourcePosition_dims[2];
-    size_t hrir_dims[3], hrir_pos_dims[2];
-    char dimname[6];
-    const char* errorMessage;
-    double* IR, *SourcePosition, IR_fs;
-    
-    /* free any existing memory */
-    if ((*hrirs)!=NULL){
-        free((*hrirs));
-        (*hrirs) = NULL;
-    }
-    if ((*hrir_dirs_deg)!=NULL){
-        free((*hrir_dirs_deg));
-        (*hrir_dirs_deg) = NULL;
-    }
-    
-    /* open sofa file */
-    if ((retval = nc_open(sofa_filepath, NC_NOWRITE, &ncid)))
-        errorMessage = nc_strerror(retval);
-    
-    /* return NULLs if not a real file */
-    if(retval!=NC_NOERR){
-        return;
-    }
-    
-    /* Determine dimension IDs and lengths */
-    for (i=0; i<6; i++){ /* there are 6 possible dimension lengths in the sofa standard */
-        retval = nc_inq_dim(ncid, i, &dimname[i], &dimlength[i]);
-        errorMessage = nc_strerror(retval);
-        retval = nc_inq_dimid(ncid, &dimname[i], &dimid[i]);
-        errorMessage = nc_strerror(retval);
-    }
-    
-    /* Extract IR data */
-    if ((retval = nc_inq_varid(ncid, "Data.IR", &varid)))
-        errorMessage = nc_strerror(retval);
-    if ((retval =  nc_inq_varndims (ncid, varid, &ndimsp)))
-        errorMessage = nc_strerror(retval);
-    dimids = malloc(ndimsp*sizeof(int));
-    if ((retval = nc_inq_vardimid(ncid, varid, dimids)))
-        errorMessage = nc_strerror(retval);
-    for(i=0; i<3; i++)
-        IR_dims[i] = dimlength[dimid[dimids[i]]];
-    free(dimids);
-    IR = malloc(IR_dims[0]*IR_dims[1]*IR_dims[2]*sizeof(double));
-    if ((retval = nc_get_var(ncid, varid, IR)))
-        errorMessage = nc_strerror(retval);
-    if ((retval = nc_inq_varid(ncid, "Data.SamplingRate", &varid)))
-        errorMessage = nc_strerror(retval);
-    if ((retval = nc_get_var(ncid, varid, &IR_fs)))
-        errorMessage = nc_strerror(retval);
-    
-    /* Extract positional data */
-    if ((retval = nc_inq_varid(ncid, "SourcePosition", &varid)))
-        errorMessage = nc_strerror(retval);
-    if ((retval =  nc_inq_varndims (ncid, varid, &ndimsp)))
-        errorMessage = nc_strerror(retval);
-    dimids = malloc(ndimsp*sizeof(int));
-    if ((retval = nc_inq_vardimid(ncid, varid, dimids)))
-        errorMessage = nc_strerror(retval);
-    for(i=0; i<2; i++)
-        SourcePosition_dims[i] = dimlength[dimid[dimids[i]]];
-    free(dimids);
-    SourcePosition = malloc(SourcePosition_dims[0]*SourcePosition_dims[1]*sizeof(double));
-    if ((retval = nc_get_var(ncid, varid, SourcePosition)))
-        errorMessage = nc_strerror(retval);
-    
-    /* Close the file, freeing all resources. */
-    if ((retval = nc_close(ncid)))
-        errorMessage = nc_strerror(retval);
-    
-    /* Allocate sufficient memory */
-    (*hrir_len) = MIN((int)IR_dims[2], MAX_HRIR_LENGTH); /* truncate the HRIR length (1024 should be plenty) */
-    (*hrirs) = malloc(IR_dims[0]*IR_dims[1]*(*hrir_len) *sizeof(float));
-    (*hrir_dirs_deg) = malloc(SourcePosition_dims[0]*2*sizeof(float));
-    
-    /* Store relevent info in handle */
-    (*hrir_fs) = (int)(IR_fs+0.5);
-    hrir_dims[0] = IR_dims[0];
-    hrir_dims[1] = IR_dims[1];
-    hrir_dims[2] = (size_t)(*hrir_len);
-    (*N_hrir_dirs) = (int)hrir_dims[0];
-    for(i=0; i<2; i++)
-        hrir_pos_dims[i] = SourcePosition_dims[i];
-    for(i=0; i<hrir_dims[0]; i++){
-        for(j=0; j<hrir_dims[1]; j++){
-            for(k=0; k<hrir_dims[2]; k++){
-                /* trunctate IRs and store in floating point precision */
-                (*hrirs)[i*hrir_dims[1]*hrir_dims[2] + j*hrir_dims[2] + k] = (float)IR[i*IR_dims[1]*IR_dims[2] + j*IR_dims[2] + k];
-            }
-        }
-    }
-    
-    /* store in floating point precision */
-    for(i=0; i<SourcePosition_dims[0]; i++){
-        (*hrir_dirs_deg)[2*i+0] = (float)SourcePosition[i*SourcePosition_dims[1]+0];
-        (*hrir_dirs_deg)[2*i+1] = (float)SourcePosition[i*SourcePosition_dims[1]+1];
-    }
-    
-    free(IR);
-    free(SourcePosition);
-}
-
-
 #endif /* __SAF_SOFA_READER_H_INCLUDED__ */
-    
-
-
-
- 
@@ -61,6 +61,18 @@ extern "C" {
 /* For cross-platform complex numbers wrapper */
 #include "../saf_utilities/saf_complex.h"
 
+/* For lock-free atomic operations and a worker thread for non-real-time (re)initialisations */
+#include "../saf_utilities/saf_threads.h"
+
+/* For optional per-stage timing of the processing loops */
+#include "../saf_utilities/saf_profiler.h"
+
+/* For detecting silent input channels, the processing of which may be skipped */
+#include "../saf_utilities/saf_activity.h"
+
+/* For a store of audio objects (dynamically added/removed sources), shared lock-free with the audio thread */
+#include "../saf_utilities/saf_objects.h"
+
 /* For various presets for loudspeaker, microphone, and hydrophone arrays.  */
 #include "../saf_utilities/saf_loudspeaker_presets.h"
 #include "../saf_utilities/saf_sensorarray_presets.h"
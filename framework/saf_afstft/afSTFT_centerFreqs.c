@@ -0,0 +1,48 @@
+/*
+ * Filename:
+ *     afSTFT_centerFreqs.c
+ * Description:
+ *     Centre frequencies of the afSTFT hybrid filterbank (hopSize=128, hybridMode=1), for
+ *     sample rates of 48kHz and 44.1kHz. Shared by all examples; single-precision.
+ * Generated using MatLab on: 23-Nov-2017, using a script by Leo McCormack
+ */
+
+#include "afSTFTlib.h"
+
+const float __afCenterFreq48e3[133] = {
+    0.0000f, 140.6443f, 234.3555f, 328.1443f, 421.8555f, 515.6443f, 609.3555f, 703.1443f,
+    796.8555f, 937.5000f, 1125.0000f, 1312.5000f, 1500.0001f, 1687.5000f, 1875.0000f, 2062.5000f,
+    2250.0001f, 2437.5000f, 2625.0000f, 2812.5000f, 3000.0000f, 3187.5000f, 3375.0000f, 3562.5000f,
+    3750.0000f, 3937.5000f, 4125.0000f, 4312.5000f, 4500.0000f, 4687.5000f, 4875.0000f, 5062.5000f,
+    5250.0000f, 5437.5000f, 5625.0000f, 5812.5000f, 6000.0000f, 6187.5000f, 6375.0000f, 6562.5000f,
+    6750.0000f, 6937.5000f, 7125.0000f, 7312.5000f, 7500.0000f, 7687.5000f, 7875.0000f, 8062.5000f,
+    8250.0000f, 8437.5000f, 8625.0000f, 8812.5000f, 9000.0000f, 9187.5000f, 9375.0000f, 9562.5000f,
+    9750.0000f, 9937.5000f, 10125.0000f, 10312.5000f, 10500.0000f, 10687.5000f, 10875.0000f, 11062.5000f,
+    11250.0000f, 11437.5000f, 11625.0000f, 11812.5000f, 12000.0000f, 12187.5000f, 12375.0000f, 12562.5000f,
+    12750.0000f, 12937.5000f, 13125.0000f, 13312.5000f, 13500.0000f, 13687.5000f, 13875.0000f, 14062.5000f,
+    14250.0000f, 14437.5000f, 14625.0000f, 14812.5000f, 15000.0000f, 15187.5000f, 15375.0000f, 15562.5000f,
+    15750.0000f, 15937.5000f, 16125.0000f, 16312.5000f, 16500.0000f, 16687.5000f, 16875.0000f, 17062.5000f,
+    17250.0000f, 17437.5000f, 17625.0000f, 17812.5000f, 18000.0000f, 18187.5000f, 18375.0000f, 18562.5000f,
+    18750.0000f, 18937.5000f, 19125.0000f, 19312.5000f, 19500.0000f, 19687.5000f, 19875.0000f, 20062.5000f,
+    20250.0000f, 20437.5000f, 20625.0000f, 20812.5000f, 21000.0000f, 21187.5000f, 21375.0000f, 21562.5000f,
+    21749.9999f, 21937.5000f, 22125.0000f, 22312.5000f, 22499.9999f, 22687.5000f, 22875.0000f, 23062.5000f,
+    23250.0000f, 23437.5000f, 23624.9999f, 23812.4999f, 24000.0000f };
+
+const float __afCenterFreq44100[133] = {
+    0.0000f, 129.2170f, 215.3141f, 301.4826f, 387.5797f, 473.7482f, 559.8454f, 646.0139f,
+    732.1110f, 861.3282f, 1033.5938f, 1205.8594f, 1378.1251f, 1550.3907f, 1722.6563f, 1894.9219f,
+    2067.1875f, 2239.4532f, 2411.7188f, 2583.9844f, 2756.2500f, 2928.5156f, 3100.7812f, 3273.0469f,
+    3445.3125f, 3617.5781f, 3789.8438f, 3962.1094f, 4134.3750f, 4306.6406f, 4478.9063f, 4651.1719f,
+    4823.4375f, 4995.7031f, 5167.9688f, 5340.2344f, 5512.5000f, 5684.7656f, 5857.0313f, 6029.2969f,
+    6201.5625f, 6373.8281f, 6546.0938f, 6718.3594f, 6890.6250f, 7062.8906f, 7235.1563f, 7407.4219f,
+    7579.6875f, 7751.9531f, 7924.2188f, 8096.4844f, 8268.7500f, 8441.0156f, 8613.2813f, 8785.5469f,
+    8957.8125f, 9130.0781f, 9302.3438f, 9474.6094f, 9646.8750f, 9819.1406f, 9991.4063f, 10163.6719f,
+    10335.9375f, 10508.2031f, 10680.4688f, 10852.7344f, 11025.0000f, 11197.2656f, 11369.5312f, 11541.7969f,
+    11714.0625f, 11886.3281f, 12058.5937f, 12230.8594f, 12403.1250f, 12575.3906f, 12747.6562f, 12919.9219f,
+    13092.1875f, 13264.4531f, 13436.7187f, 13608.9844f, 13781.2500f, 13953.5156f, 14125.7812f, 14298.0469f,
+    14470.3125f, 14642.5781f, 14814.8437f, 14987.1094f, 15159.3750f, 15331.6406f, 15503.9062f, 15676.1719f,
+    15848.4375f, 16020.7031f, 16192.9687f, 16365.2344f, 16537.5000f, 16709.7656f, 16882.0312f, 17054.2969f,
+    17226.5625f, 17398.8281f, 17571.0937f, 17743.3594f, 17915.6250f, 18087.8906f, 18260.1562f, 18432.4219f,
+    18604.6875f, 18776.9531f, 18949.2188f, 19121.4844f, 19293.7500f, 19466.0156f, 19638.2812f, 19810.5468f,
+    19982.8125f, 20155.0781f, 20327.3437f, 20499.6093f, 20671.8749f, 20844.1406f, 21016.4062f, 21188.6718f,
+    21360.9375f, 21533.2031f, 21705.4687f, 21877.7343f, 22050.0000f };
@@ -122,12 +122,20 @@ void afSTFTinit(void** handle, int hopSize, int inChannels, int outChannels, int
 void afSTFTforward(void* handle, float** inTD, complexVector* outFD)
 {
     afSTFT *h = (afSTFT*)(handle);
-    int ch,k,hopIndex_this,hopIndex_this2;
+    afSTFTforwardChannels(handle, inTD, outFD, NULL, h->inChannels);
+}
+
+void afSTFTforwardChannels(void* handle, float** inTD, complexVector* outFD, const int* channels, int nChannels)
+{
+    afSTFT *h = (afSTFT*)(handle);
+    int i,ch,k,hopIndex_this,hopIndex_this2;
     float *p1,*p2,*p3,*p4;
     int lr;
     
-    for (ch=0;ch<h->inChannels;ch++)
+    for (i=0;i<nChannels;i++)
     {
+        ch = channels==NULL ? i : channels[i];
+        
         /* Copy the input frame into the memory buffer */
         hopIndex_this2 = h->hopIndexIn;
         p1=&(h->inBuffer[ch][hopIndex_this2*h->hopSize]);
@@ -189,25 +197,33 @@ void afSTFTforward(void* handle, float** inTD, complexVector* outFD)
     /* Subdivide lowest bands with half-band filters if hybrid mode is enabled */
     if (h->hybridMode)
     {
-        afHybridForward(h->h_afHybrid, outFD);
+        afHybridForwardChannels(h->h_afHybrid, outFD, channels, nChannels);
     }
 }
 
 void afSTFTinverse(void* handle, complexVector* inFD, float** outTD)
 {
     afSTFT *h = (afSTFT*)(handle);
-    int ch,k,hopIndex_this,hopIndex_this2;
+    afSTFTinverseChannels(handle, inFD, outTD, NULL, h->outChannels);
+}
+
+void afSTFTinverseChannels(void* handle, complexVector* inFD, float** outTD, const int* channels, int nChannels)
+{
+    afSTFT *h = (afSTFT*)(handle);
+    int i,ch,k,hopIndex_this,hopIndex_this2;
     float *p1,*p2,*p3,*p4;
     int lr;
     
     /* Combine subdivided lowest bands if hybrid mode is enabled */
     if (h->hybridMode)
     {
-        afHybridInverse(h->h_afHybrid, inFD);
+        afHybridInverseChannels(h->h_afHybrid, inFD, channels, nChannels);
     }
     
-    for (ch=0;ch<h->outChannels;ch++)
+    for (i=0;i<nChannels;i++)
     {
+        ch = channels==NULL ? i : channels[i];
+        
         /* Copy data from input to internal memory */
         hopIndex_this2 = h->hopIndexOut;
         h->fftProcessFrameFD[0] = inFD[ch].re[0]; /* DC */
@@ -285,6 +301,34 @@ void afSTFTinverse(void* handle, complexVector* inFD, float** outTD)
     
 }
 
+int afSTFTdelay(int hopSize, int LDmode, int hybridMode)
+{
+    return (LDmode==0 ? 9 : 4)*hopSize + (hybridMode ? 3*hopSize : 0);
+}
+
+void afSTFTclearChannel(void* handle, int ch)
+{
+    afSTFT *h = (afSTFT*)(handle);
+    afHybrid *hHybrid;
+    int sample;
+    
+    memset(h->inBuffer[ch], 0, sizeof(float)*(h->hLen));
+    if (h->hybridMode)
+    {
+        hHybrid = (afHybrid*)(h->h_afHybrid);
+        for (sample=0;sample<7;sample++)
+        {
+            memset(hHybrid->analysisBuffer[ch][sample].re, 0, sizeof(float)*(h->hopSize+1));
+            memset(hHybrid->analysisBuffer[ch][sample].im, 0, sizeof(float)*(h->hopSize+1));
+        }
+    }
+}
+
+int afSTFTtail(int hopSize, int hybridMode)
+{
+    return 10*hopSize + (hybridMode ? 6*hopSize : 0);
+}
+
 void afSTFTfree(void* handle)
 {
     afSTFT *h = (afSTFT*)(handle);
@@ -340,7 +384,13 @@ void afHybridInit(void** handle, int hopSize, int inChannels, int outChannels)
 void afHybridForward(void* handle, complexVector* FD)
 {
     afHybrid *h = (afHybrid*)(handle);
-    int ch,band,sample,realImag;
+    afHybridForwardChannels(handle, FD, NULL, h->inChannels);
+}
+
+void afHybridForwardChannels(void* handle, complexVector* FD, const int* channels, int nChannels)
+{
+    afHybrid *h = (afHybrid*)(handle);
+    int i,ch,band,sample,realImag;
     float *pr1, *pr2, *pi1, *pi2;
     float re,im;
     int sampleIndices[7];
@@ -350,8 +400,10 @@ void afHybridForward(void* handle, complexVector* FD)
     {
         h->loopPointer = 0;
     }
-    for (ch=0;ch<h->inChannels;ch++)
+    for (i=0;i<nChannels;i++)
     {
+        ch = channels==NULL ? i : channels[i];
+        
         /* Copy data from input to the memory buffer */
         pr1 = FD[ch].re;
         pi1 = FD[ch].im;
@@ -436,11 +488,18 @@ void afHybridForward(void* handle, complexVector* FD)
 void afHybridInverse(void* handle, complexVector* FD)
 {
     afHybrid *h = (afHybrid*)(handle);
-    int ch,realImag;
+    afHybridInverseChannels(handle, FD, NULL, h->outChannels);
+}
+
+void afHybridInverseChannels(void* handle, complexVector* FD, const int* channels, int nChannels)
+{
+    afHybrid *h = (afHybrid*)(handle);
+    int i,ch,realImag;
     float *pr;
 
-    for (ch=0;ch<h->outChannels;ch++)
+    for (i=0;i<nChannels;i++)
     {
+        ch = channels==NULL ? i : channels[i];
         pr = FD[ch].re;
         for (realImag=0;realImag<2;realImag++)
         {
@@ -18,7 +18,7 @@
  * Description:
  *     A collection of head-related impulse-response (HRIR)- related functions.
  * Dependencies:
- *     saf_utilities, afSTFTlib
+ *     saf_utilities, afSTFTlib, saf_vbap
  * Author, date created:
  *     Leo McCormack, 12.12.2016
  */
@@ -26,11 +26,80 @@
 #include "saf_hrir.h"
 #include "saf_hrir_internal.h"
 
+/* locks (and condition variables) protecting the shared (process-wide) HRIR data */
+#if defined(_WIN32)
+#include <windows.h>
+typedef SRWLOCK hrirLock;
+typedef CONDITION_VARIABLE hrirCond;
+#define HRIR_LOCK_INIT      SRWLOCK_INIT
+#define HRIR_LOCK(l)        AcquireSRWLockExclusive(l)
+#define HRIR_UNLOCK(l)      ReleaseSRWLockExclusive(l)
+#define HRIR_COND_INIT      CONDITION_VARIABLE_INIT
+#define HRIR_COND_WAIT(c,l) SleepConditionVariableSRW(c, l, INFINITE, 0)
+#define HRIR_COND_BROADCAST(c) WakeAllConditionVariable(c)
+#else
+#include <pthread.h>
+typedef pthread_mutex_t hrirLock;
+typedef pthread_cond_t hrirCond;
+#define HRIR_LOCK_INIT      PTHREAD_MUTEX_INITIALIZER
+#define HRIR_LOCK(l)        pthread_mutex_lock(l)
+#define HRIR_UNLOCK(l)      pthread_mutex_unlock(l)
+#define HRIR_COND_INIT      PTHREAD_COND_INITIALIZER
+#define HRIR_COND_WAIT(c,l) pthread_cond_wait(c, l)
+#define HRIR_COND_BROADCAST(c) pthread_cond_broadcast(c)
+#endif
+
 static inline float matlab_fmodf(float x, float y) {
     float tmp = fmodf(x, y);
     return tmp >= 0 ? tmp : tmp + y;
 }
 
+#ifdef SAF_DEFAULT_HRIRS_FP16
+static float half2float(unsigned short h)
+{
+    unsigned int sign, expo, mant;
+    float out;
+    
+    sign = (h >> 15) & 0x1;
+    expo = (h >> 10) & 0x1F;
+    mant = h & 0x3FF;
+    if(expo == 0)
+        out = ldexpf((float)mant, -24);                /* subnormal */
+    else if(expo == 31)
+        out = mant == 0 ? INFINITY : NAN;
+    else
+        out = ldexpf((float)(mant | 0x400), (int)expo-25);
+    return sign ? -out : out;
+}
+
+static float __default_hrirs_fp32[217][2][1024];
+static volatile int __default_hrirs_decoded = 0;
+static hrirLock __default_hrirs_lock = HRIR_LOCK_INIT;
+#endif
+
+const float* getDefaultHRIRs(void)
+{
+#ifdef SAF_DEFAULT_HRIRS_FP16
+    int i, j, k;
+    
+    /* decode once, the result is shared by all instances; concurrent first calls wait for the one decoding */
+    if(!saf_atomic_loadi(&__default_hrirs_decoded)){
+        HRIR_LOCK(&__default_hrirs_lock);
+        if(!saf_atomic_loadi(&__default_hrirs_decoded)){
+            for(i=0; i<__default_N_hrir_dirs; i++)
+                for(j=0; j<2; j++)
+                    for(k=0; k< __default_hrir_len; k++)
+                        __default_hrirs_fp32[i][j][k] = half2float(__default_hrirs_fp16[i][j][k]);
+            saf_atomic_storei(&__default_hrirs_decoded, 1);
+        }
+        HRIR_UNLOCK(&__default_hrirs_lock);
+    }
+    return (const float*)__default_hrirs_fp32;
+#else
+    return (const float*)__default_hrirs_f32;
+#endif
+}
+
 void estimateITDs
 (
     float* hrirs /*N_dirs x 2 x hrir_len*/,
@@ -247,12 +316,216 @@ void interpFilterbankHRTFs
 }
 
 
+/* list of shared HRTF resources currently in use (or being loaded), and the lock protecting it. The lock is not held
+ * whilst a resource is loaded; callers asking for a resource that is still loading wait on "hrtfResLoaded" instead */
+static hrirLock hrtfResLock = HRIR_LOCK_INIT;
+static hrirCond hrtfResLoaded = HRIR_COND_INIT;
+#define HRTF_RES_LOCK()   HRIR_LOCK(&hrtfResLock)
+#define HRTF_RES_UNLOCK() HRIR_UNLOCK(&hrtfResLock)
+static hrtfResource* hrtfResList = NULL;
+static char* hrtfCacheDir = NULL;
 
+static void hrtfResource_free(hrtfResource* res)
+{
+    if(res->sofa_filepath!=NULL){
+        free(res->sofa_filepath);
+        free((float*)res->hrirs); /* only owned if loaded from file */
+    }
+    free(res->centreFreq);
+    free(res->hrir_dirs_deg);
+    if(res->cacheMap!=NULL)
+        hrtfCache_unmap(res); /* the processed data points into the cache file */
+    else{
+        free(res->itds_s);
+        free(res->hrtf_fb);
+        free(res->hrtf_fb_mag);
+        free(res->hrtf_vbap_gtableIdx);
+        free(res->hrtf_vbap_gtableComp);
+    }
+    free(res);
+}
 
+/* loads and processes the HRIRs of a resource, whose key has already been set; returns 0 if this failed */
+static int hrtfResource_load
+(
+    hrtfResource* res,
+    hrirLoaderFunc loader,
+    const char* cacheDir
+)
+{
+    float* hrirs, *hrtf_vbap_gtable;
+    unsigned long long cacheKey;
+    int i, N_bands;
+    
+    N_bands = res->N_bands;
+    
+    /* load sofa file or reference the default HRIR data */
+    if(res->sofa_filepath!=NULL){
+        hrirs = NULL;
+        if(loader!=NULL)
+            loader(res->sofa_filepath, &hrirs, &(res->hrir_dirs_deg), &(res->N_hrir_dirs), &(res->hrir_len), &(res->hrir_fs));
+        res->hrirs = hrirs;
+        if((res->hrirs==NULL) || (res->hrir_dirs_deg==NULL))
+            return 0;
+    }
+    else{
+        res->N_hrir_dirs = __default_N_hrir_dirs;
+        res->hrir_len = __default_hrir_len;
+        res->hrir_fs = __default_hrir_fs;
+        res->hrirs = getDefaultHRIRs();
+        res->hrir_dirs_deg = malloc(res->N_hrir_dirs * 2 * sizeof(float));
+        memcpy(res->hrir_dirs_deg, __default_hrir_dirs_deg_f32, res->N_hrir_dirs * 2 * sizeof(float));
+    }
+    
+    res->hrtf_vbapTableRes[0] = 2; /* azimuth resolution in degrees */
+    res->hrtf_vbapTableRes[1] = 5; /* elevation resolution in degrees */
+    
+    /* skip the processing if this HRIR set and configuration has been cached already */
+    cacheKey = 0;
+    if(cacheDir!=NULL){
+        cacheKey = hrtfCache_key(res);
+        if(hrtfCache_load(cacheDir, cacheKey, res))
+            return 1;
+    }
+    
+    /* generate VBAP gain table for the HRIR directions */
+    hrtf_vbap_gtable = NULL;
+    generateVBAPgainTable3D(res->hrir_dirs_deg, res->N_hrir_dirs, res->hrtf_vbapTableRes[0], res->hrtf_vbapTableRes[1], 1, 0,
+                            &hrtf_vbap_gtable, &(res->N_hrtf_vbap_gtable), &(res->hrtf_nTriangles));
+    if(hrtf_vbap_gtable==NULL)
+        return 0;
+    compressVBAPgainTable3D(hrtf_vbap_gtable, res->N_hrtf_vbap_gtable, res->N_hrir_dirs, &(res->hrtf_vbap_gtableComp), &(res->hrtf_vbap_gtableIdx));
+    free(hrtf_vbap_gtable);
+    
+    /* estimate the ITDs and convert the HRIRs to filterbank coefficients */
+    estimateITDs((float*)res->hrirs, res->N_hrir_dirs, res->hrir_len, res->hrir_fs, &(res->itds_s));
+    HRIRs2FilterbankHRTFs((float*)res->hrirs, res->N_hrir_dirs, res->hrir_len, res->itds_s, res->centreFreq, N_bands, &(res->hrtf_fb));
+    res->hrtf_fb_mag = malloc(N_bands*NUM_EARS*(res->N_hrir_dirs)*sizeof(float));
+    for(i=0; i<N_bands*NUM_EARS*(res->N_hrir_dirs); i++)
+        res->hrtf_fb_mag[i] = cabsf(res->hrtf_fb[i]);
+    
+    if(cacheDir!=NULL)
+        hrtfCache_save(cacheDir, cacheKey, res);
+    
+    return 1;
+}
 
+void hrtfResource_acquire
+(
+    char* sofa_filepath,
+    hrirLoaderFunc loader,
+    float* centreFreq,
+    int N_bands,
+    hrtfResource** phRes
+)
+{
+    hrtfResource* res, **pp;
+    char* cacheDir;
+    int loaded;
+    
+    HRTF_RES_LOCK();
+    
+    /* look for a resource with the same HRIRs and filterbank configuration */
+    for(res = hrtfResList; res!=NULL; res = res->next){
+        if( (sofa_filepath==NULL ? res->sofa_filepath==NULL :
+             (res->sofa_filepath!=NULL && !strcmp(res->sofa_filepath, sofa_filepath))) &&
+            (res->N_bands == N_bands) && !memcmp(res->centreFreq, centreFreq, N_bands*sizeof(float)) )
+            break;
+    }
+    
+    if(res!=NULL){
+        /* wait, if another caller is still loading it */
+        res->refCount++;
+        while(res->loading)
+            HRIR_COND_WAIT(&hrtfResLoaded, &hrtfResLock);
+    }
+    else{
+        /* otherwise, add a placeholder (so that callers asking for the same configuration wait for this load, rather
+         * than starting their own), and load and process it without holding the lock */
+        res = calloc(1, sizeof(hrtfResource));
+        if(sofa_filepath!=NULL){
+            res->sofa_filepath = malloc(strlen(sofa_filepath) + 1);
+            strcpy(res->sofa_filepath, sofa_filepath);
+        }
+        res->N_bands = N_bands;
+        res->centreFreq = malloc(N_bands*sizeof(float));
+        memcpy(res->centreFreq, centreFreq, N_bands*sizeof(float));
+        res->loading = 1;
+        res->refCount = 1;
+        res->next = hrtfResList;
+        hrtfResList = res;
+        cacheDir = NULL;
+        if(hrtfCacheDir!=NULL){
+            cacheDir = malloc(strlen(hrtfCacheDir) + 1);
+            strcpy(cacheDir, hrtfCacheDir);
+        }
+        HRTF_RES_UNLOCK();
+        
+        loaded = hrtfResource_load(res, loader, cacheDir);
+        free(cacheDir);
+        
+        HRTF_RES_LOCK();
+        res->loading = 0;
+        if(!loaded){
+            /* remove it from the list; the waiting callers then drop their references below */
+            res->failed = 1;
+            for(pp = &hrtfResList; (*pp)!=NULL; pp = &((*pp)->next)){
+                if((*pp)==res){
+                    (*pp) = res->next;
+                    break;
+                }
+            }
+        }
+        HRIR_COND_BROADCAST(&hrtfResLoaded);
+    }
+    if(res->failed){
+        if(--(res->refCount) == 0)
+            hrtfResource_free(res);
+        res = NULL;
+    }
+    
+    HRTF_RES_UNLOCK();
+    
+    hrtfResource_release(phRes);
+    (*phRes) = res;
+}
 
+void hrtfResource_release
+(
+    hrtfResource** phRes
+)
+{
+    hrtfResource* res, **pp;
+    
+    res = (*phRes);
+    if(res==NULL)
+        return;
+    HRTF_RES_LOCK();
+    if(--(res->refCount) == 0){
+        /* last user, remove from the list and free */
+        for(pp = &hrtfResList; (*pp)!=NULL; pp = &((*pp)->next)){
+            if((*pp)==res){
+                (*pp) = res->next;
+                break;
+            }
+        }
+        hrtfResource_free(res);
+    }
+    HRTF_RES_UNLOCK();
+    (*phRes) = NULL;
+}
 
-
-
-
-
+void hrtfResource_setCacheDirectory
+(
+    const char* cacheDir
+)
+{
+    HRTF_RES_LOCK();
+    free(hrtfCacheDir);
+    hrtfCacheDir = NULL;
+    if(cacheDir!=NULL){
+        hrtfCacheDir = malloc(strlen(cacheDir) + 1);
+        strcpy(hrtfCacheDir, cacheDir);
+    }
+    HRTF_RES_UNLOCK();
+}
@@ -25,6 +25,14 @@
 
 #include "saf_hrir.h"
 #include "saf_hrir_internal.h"
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+#endif
 
 void cxcorr
 (
@@ -199,3 +207,229 @@ void FIRtoFilterbankCoeffs
     free(ir);
     free(irFB);
 }
+
+/* HRTF cache file: header, followed by itds_s, hrtf_fb, hrtf_fb_mag, hrtf_vbap_gtableIdx and hrtf_vbap_gtableComp; with
+ * each block starting on a 16 byte boundary */
+typedef struct _hrtfCacheHeader {
+    char magic[8];
+    int version;
+    int N_bands;
+    unsigned long long key;
+    int N_hrir_dirs, hrir_len, hrir_fs;
+    int hrtf_vbapTableRes[2];
+    int N_hrtf_vbap_gtable, hrtf_nTriangles;
+    int reserved;
+}hrtfCacheHeader;
+
+#define HRTF_CACHE_MAGIC "SAFHRTF"
+#define HRTF_CACHE_ALIGN(x) ( ((x) + 15) & ~((size_t)15) )
+
+static void hrtfCache_offsets(int N_bands, int N_dirs, int N_gtable, size_t offsets[6])
+{
+    size_t nBands, nDirs, nGtable;
+    
+    nBands = (size_t)N_bands;
+    nDirs = (size_t)N_dirs;
+    nGtable = (size_t)N_gtable;
+    offsets[0] = HRTF_CACHE_ALIGN(sizeof(hrtfCacheHeader));                               /* itds_s */
+    offsets[1] = offsets[0] + HRTF_CACHE_ALIGN(nDirs*sizeof(float));                       /* hrtf_fb */
+    offsets[2] = offsets[1] + HRTF_CACHE_ALIGN(nBands*NUM_EARS*nDirs*sizeof(float_complex)); /* hrtf_fb_mag */
+    offsets[3] = offsets[2] + HRTF_CACHE_ALIGN(nBands*NUM_EARS*nDirs*sizeof(float));       /* hrtf_vbap_gtableIdx */
+    offsets[4] = offsets[3] + HRTF_CACHE_ALIGN(nGtable*3*sizeof(int));                     /* hrtf_vbap_gtableComp */
+    offsets[5] = offsets[4] + HRTF_CACHE_ALIGN(nGtable*3*sizeof(float));                   /* total size */
+}
+
+static void hrtfCache_path(const char* cacheDir, unsigned long long key, char* path, size_t maxLen)
+{
+    snprintf(path, maxLen, "%s/saf_hrtf_%016llx.bin", cacheDir, key);
+}
+
+static void fnv1a(unsigned long long* hash, const void* data, size_t nBytes)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    size_t i;
+    
+    for(i=0; i<nBytes; i++){
+        (*hash) ^= (unsigned long long)bytes[i];
+        (*hash) *= 0x100000001b3ULL;
+    }
+}
+
+unsigned long long hrtfCache_key
+(
+    hrtfResource* res
+)
+{
+    unsigned long long hash;
+    int version;
+    
+    hash = 0xcbf29ce484222325ULL;
+    version = HRTF_CACHE_VERSION;
+    fnv1a(&hash, &version, sizeof(int));
+    fnv1a(&hash, &(res->N_hrir_dirs), sizeof(int));
+    fnv1a(&hash, &(res->hrir_len), sizeof(int));
+    fnv1a(&hash, &(res->hrir_fs), sizeof(int));
+    fnv1a(&hash, res->hrirs, res->N_hrir_dirs*NUM_EARS*(res->hrir_len)*sizeof(float));
+    fnv1a(&hash, res->hrir_dirs_deg, res->N_hrir_dirs*2*sizeof(float));
+    fnv1a(&hash, &(res->N_bands), sizeof(int));
+    fnv1a(&hash, res->centreFreq, res->N_bands*sizeof(float));
+    fnv1a(&hash, res->hrtf_vbapTableRes, 2*sizeof(int));
+    return hash;
+}
+
+int hrtfCache_load
+(
+    const char* cacheDir,
+    unsigned long long key,
+    hrtfResource* res
+)
+{
+    char path[4096];
+    void* map;
+    size_t mapSize, offsets[6];
+    hrtfCacheHeader* header;
+    int valid;
+    
+    /* map the whole file (read-only) */
+    hrtfCache_path(cacheDir, key, path, sizeof(path));
+    map = NULL;
+    mapSize = 0;
+#ifdef _WIN32
+    {
+        HANDLE hFile, hMap;
+        LARGE_INTEGER fileSize;
+        hFile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if(hFile == INVALID_HANDLE_VALUE)
+            return 0;
+        if(GetFileSizeEx(hFile, &fileSize) && fileSize.QuadPart >= (LONGLONG)sizeof(hrtfCacheHeader)){
+            hMap = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+            if(hMap != NULL){
+                map = MapViewOfFile(hMap, FILE_MAP_READ, 0, 0, 0);
+                mapSize = (size_t)fileSize.QuadPart;
+                CloseHandle(hMap);
+            }
+        }
+        CloseHandle(hFile);
+    }
+#else
+    {
+        int fd;
+        struct stat st;
+        fd = open(path, O_RDONLY);
+        if(fd < 0)
+            return 0;
+        if(fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(hrtfCacheHeader)){
+            map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            mapSize = (size_t)st.st_size;
+            if(map == MAP_FAILED)
+                map = NULL;
+        }
+        close(fd);
+    }
+#endif
+    if(map == NULL)
+        return 0;
+    
+    /* validate the header against the expected configuration. The file is not trusted: the table size it states is
+     * only used once the header is known to belong to this configuration, and must fit within the mapped file */
+    header = (hrtfCacheHeader*)map;
+    valid = !memcmp(header->magic, HRTF_CACHE_MAGIC, sizeof(HRTF_CACHE_MAGIC)) && header->version == HRTF_CACHE_VERSION &&
+        header->key == key && header->N_bands == res->N_bands && header->N_hrir_dirs == res->N_hrir_dirs &&
+        header->hrir_len == res->hrir_len && header->hrir_fs == res->hrir_fs &&
+        header->hrtf_vbapTableRes[0] == res->hrtf_vbapTableRes[0] && header->hrtf_vbapTableRes[1] == res->hrtf_vbapTableRes[1];
+    valid = valid && header->N_hrtf_vbap_gtable > 0 && header->hrtf_nTriangles > 0 &&
+        (size_t)header->N_hrtf_vbap_gtable <= mapSize/(3*(sizeof(int)+sizeof(float)));
+    if(valid){
+        hrtfCache_offsets(res->N_bands, res->N_hrir_dirs, header->N_hrtf_vbap_gtable, offsets);
+        valid = offsets[5] == mapSize;
+    }
+    if(!valid){
+        res->cacheMap = map;
+        res->cacheMapSize = mapSize;
+        hrtfCache_unmap(res);
+        return 0;
+    }
+    
+    /* the processed data then points directly into the mapped file */
+    res->cacheMap = map;
+    res->cacheMapSize = mapSize;
+    res->N_hrtf_vbap_gtable = header->N_hrtf_vbap_gtable;
+    res->hrtf_nTriangles = header->hrtf_nTriangles;
+    res->itds_s = (float*)((char*)map + offsets[0]);
+    res->hrtf_fb = (float_complex*)((char*)map + offsets[1]);
+    res->hrtf_fb_mag = (float*)((char*)map + offsets[2]);
+    res->hrtf_vbap_gtableIdx = (int*)((char*)map + offsets[3]);
+    res->hrtf_vbap_gtableComp = (float*)((char*)map + offsets[4]);
+    return 1;
+}
+
+void hrtfCache_save
+(
+    const char* cacheDir,
+    unsigned long long key,
+    hrtfResource* res
+)
+{
+    char path[4096], tmpPath[4096+8];
+    size_t i, offsets[6], sizes[5];
+    const void* blocks[5];
+    const char zeros[16] = {0};
+    hrtfCacheHeader header;
+    FILE* file;
+    int ok;
+    
+    memset(&header, 0, sizeof(hrtfCacheHeader));
+    memcpy(header.magic, HRTF_CACHE_MAGIC, sizeof(HRTF_CACHE_MAGIC));
+    header.version = HRTF_CACHE_VERSION;
+    header.key = key;
+    header.N_bands = res->N_bands;
+    header.N_hrir_dirs = res->N_hrir_dirs;
+    header.hrir_len = res->hrir_len;
+    header.hrir_fs = res->hrir_fs;
+    header.hrtf_vbapTableRes[0] = res->hrtf_vbapTableRes[0];
+    header.hrtf_vbapTableRes[1] = res->hrtf_vbapTableRes[1];
+    header.N_hrtf_vbap_gtable = res->N_hrtf_vbap_gtable;
+    header.hrtf_nTriangles = res->hrtf_nTriangles;
+    hrtfCache_offsets(res->N_bands, res->N_hrir_dirs, res->N_hrtf_vbap_gtable, offsets);
+    blocks[0] = res->itds_s;               sizes[0] = res->N_hrir_dirs*sizeof(float);
+    blocks[1] = res->hrtf_fb;              sizes[1] = res->N_bands*NUM_EARS*(res->N_hrir_dirs)*sizeof(float_complex);
+    blocks[2] = res->hrtf_fb_mag;          sizes[2] = res->N_bands*NUM_EARS*(res->N_hrir_dirs)*sizeof(float);
+    blocks[3] = res->hrtf_vbap_gtableIdx;  sizes[3] = res->N_hrtf_vbap_gtable*3*sizeof(int);
+    blocks[4] = res->hrtf_vbap_gtableComp; sizes[4] = res->N_hrtf_vbap_gtable*3*sizeof(float);
+    
+    /* write to a temporary file first, so that other processes never map a partially written file */
+    hrtfCache_path(cacheDir, key, path, sizeof(path));
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+    file = fopen(tmpPath, "wb");
+    if(file == NULL)
+        return;
+    ok = fwrite(&header, sizeof(hrtfCacheHeader), 1, file) == 1;
+    ok = ok && fwrite(zeros, 1, offsets[0]-sizeof(hrtfCacheHeader), file) == offsets[0]-sizeof(hrtfCacheHeader);
+    for(i=0; i<5 && ok; i++){
+        ok = fwrite(blocks[i], 1, sizes[i], file) == sizes[i];
+        ok = ok && fwrite(zeros, 1, offsets[i+1]-offsets[i]-sizes[i], file) == offsets[i+1]-offsets[i]-sizes[i];
+    }
+    ok = (fclose(file) == 0) && ok;
+    if(ok){
+        remove(path);
+        ok = rename(tmpPath, path) == 0;
+    }
+    if(!ok)
+        remove(tmpPath);
+}
+
+void hrtfCache_unmap
+(
+    hrtfResource* res
+)
+{
+    if(res->cacheMap == NULL)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(res->cacheMap);
+#else
+    munmap(res->cacheMap, res->cacheMapSize);
+#endif
+    res->cacheMap = NULL;
+    res->cacheMapSize = 0;
+}
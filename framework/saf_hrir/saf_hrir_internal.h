@@ -18,7 +18,7 @@
  * Description:
  *     A collection of head-related impulse-response (HRIR)- related functions.
  * Dependencies:
- *     saf_utilities, afSTFTlib
+ *     saf_utilities, afSTFTlib, saf_vbap
  * Author, date created:
  *     Leo McCormack, 12.12.2016
  */
@@ -32,6 +32,7 @@
 #include <string.h>
 #include "saf_hrir.h"
 #include "afSTFTlib.h"
+#include "saf_vbap.h"
 #include "saf_utilities.h"
 
 #ifdef __cplusplus
@@ -58,6 +59,27 @@ void FIRtoFilterbankCoeffs(float* hIR               /* time-domain FIR; N_dirs x
                            int N_bands,             /* number of time-frequency domain bands */
                            float_complex** hFB);    /* & the FIRs as Filterbank coefficients; N_bands x nCH x N_dirs */
     
+/* The version of the HRTF cache file format; increment whenever the format or the HRTF processing changes */
+#define HRTF_CACHE_VERSION ( 1 )
+    
+/* Returns the cache key of a HRTF resource; a 64-bit FNV-1a hash of the HRIR data, the filterbank configuration and the
+ * VBAP table resolution (these must be set in "res" beforehand) */
+unsigned long long hrtfCache_key(hrtfResource* res);        /* HRTF resource */
+    
+/* Memory-maps the processed HRTF data of "res" from the cache file with the specified key; returning 1 if successful,
+ * or 0 if no valid cache file exists */
+int hrtfCache_load(const char* cacheDir,                    /* cache directory */
+                   unsigned long long key,                  /* cache key, see "hrtfCache_key" */
+                   hrtfResource* res);                      /* HRTF resource to point into the mapped file */
+    
+/* Writes the processed HRTF data of "res" to the cache file with the specified key */
+void hrtfCache_save(const char* cacheDir,                   /* cache directory */
+                    unsigned long long key,                 /* cache key, see "hrtfCache_key" */
+                    hrtfResource* res);                     /* processed HRTF resource */
+    
+/* Unmaps the cache file of "res" (if any) */
+void hrtfCache_unmap(hrtfResource* res);                    /* HRTF resource */
+    
     
 #ifdef __cplusplus
 }
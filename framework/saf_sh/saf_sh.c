@@ -27,7 +27,22 @@
  */
 
 #include "saf_sh.h"
-#include "saf_sh_internal.h"
+#include "saf_sh_internal.h"
+
+/* lock protecting the shared (process-wide) spherical harmonic grid resources */
+#if defined(_WIN32)
+#include <windows.h>
+typedef SRWLOCK shLock;
+#define SH_LOCK_INIT        SRWLOCK_INIT
+#define SH_LOCK(l)          AcquireSRWLockExclusive(l)
+#define SH_UNLOCK(l)        ReleaseSRWLockExclusive(l)
+#else
+#include <pthread.h>
+typedef pthread_mutex_t shLock;
+#define SH_LOCK_INIT        PTHREAD_MUTEX_INITIALIZER
+#define SH_LOCK(l)          pthread_mutex_lock(l)
+#define SH_UNLOCK(l)        pthread_mutex_unlock(l)
+#endif
 
 static double Jn(int n, double z)
 {
@@ -523,15 +538,28 @@ void getSHreal
 {
     int i, j, n, m, idx_Y;
     float *p_mm, *Lnm_real, *condon, *norm_real, *Nnm_real, *CosSin, *Ynm;
+    float buf[7][2*SH_MAX_STACK_ORDER+1];
     //Nharm = (N+1)*(N+1);
 
-    p_mm = (float*)malloc((N+1) * sizeof(float));
-    norm_real = (float*)malloc((N+1) * sizeof(float));
-    CosSin = (float*)malloc((N*2+1) * sizeof(float));
-    Ynm = (float*)malloc((N*2+1) * sizeof(float));
-    Nnm_real = (float*)malloc((N*2+1) * sizeof(float));
-    Lnm_real = (float*)malloc((N*2+1) * sizeof(float));
-    condon = (float*)malloc((N*2+1) * sizeof(float));
+    if(N<=SH_MAX_STACK_ORDER){
+        /* use the stack, so that this may be called from the audio thread */
+        p_mm = buf[0];
+        norm_real = buf[1];
+        CosSin = buf[2];
+        Ynm = buf[3];
+        Nnm_real = buf[4];
+        Lnm_real = buf[5];
+        condon = buf[6];
+    }
+    else{
+        p_mm = (float*)malloc((N+1) * sizeof(float));
+        norm_real = (float*)malloc((N+1) * sizeof(float));
+        CosSin = (float*)malloc((N*2+1) * sizeof(float));
+        Ynm = (float*)malloc((N*2+1) * sizeof(float));
+        Nnm_real = (float*)malloc((N*2+1) * sizeof(float));
+        Lnm_real = (float*)malloc((N*2+1) * sizeof(float));
+        condon = (float*)malloc((N*2+1) * sizeof(float));
+    }
 
     idx_Y = 0;
     for(n=0; n<=N; n++){
@@ -570,13 +598,15 @@ void getSHreal
         idx_Y = idx_Y + (2*n+1);
     }
 
-    free(p_mm);
-    free(norm_real);
-    free(CosSin);
-    free(Ynm);
-    free(Nnm_real);
-    free(Lnm_real);
-    free(condon);
+    if(N>SH_MAX_STACK_ORDER){
+        free(p_mm);
+        free(norm_real);
+        free(CosSin);
+        free(Ynm);
+        free(Nnm_real);
+        free(Lnm_real);
+        free(condon);
+    }
 }
 
 void yawPitchRoll2Rzyx
@@ -627,14 +657,34 @@ void getSHrotMtxReal
     int L
 )
 {
-    int i, j, M, l, m, n, d, bandIdx, denom;
+    int i, j, M, l, m, n, d, bandIdx, denom, nBand;
     float u, v, w;
-    float** R_1,  **R_lm1, **R_l;
+    float R_1_buf[3][3];
+    float R_lm1_buf[(2*SH_MAX_STACK_ORDER+1)*(2*SH_MAX_STACK_ORDER+1)];
+    float R_l_buf[(2*SH_MAX_STACK_ORDER+1)*(2*SH_MAX_STACK_ORDER+1)];
+    float* R_1[3], *R_lm1_rows[2*SH_MAX_STACK_ORDER+1], *R_l_rows[2*SH_MAX_STACK_ORDER+1];
+    float** R_lm1, **R_l;
     
     M = (L+1) * (L+1);
-    R_1 = (float**)calloc2d(3, 3, sizeof(float));
-    R_lm1 = (float**)calloc2d(M, M, sizeof(float));
-    R_l = (float**)calloc2d(M, M, sizeof(float));
+    nBand = 2*L+1; /* size of the largest band matrix */
+    memset(R_1_buf, 0, 3*3*sizeof(float));
+    for(i=0; i<3; i++)
+        R_1[i] = R_1_buf[i];
+    if(L<=SH_MAX_STACK_ORDER){
+        /* use the stack, so that this may be called from the audio thread */
+        memset(R_lm1_buf, 0, nBand*nBand*sizeof(float));
+        memset(R_l_buf, 0, nBand*nBand*sizeof(float));
+        for(i=0; i<nBand; i++){
+            R_lm1_rows[i] = &R_lm1_buf[i*nBand];
+            R_l_rows[i] = &R_l_buf[i*nBand];
+        }
+        R_lm1 = R_lm1_rows;
+        R_l = R_l_rows;
+    }
+    else{
+        R_lm1 = (float**)calloc2d(nBand, nBand, sizeof(float));
+        R_l = (float**)calloc2d(nBand, nBand, sizeof(float));
+    }
     memset(RotMtx, 0, M*M*sizeof(float));
     
     /* zeroth-band (l=0) is invariant to rotation */
@@ -691,9 +741,10 @@ void getSHrotMtxReal
         bandIdx += 2*l+1;
     }
     
-    free2d((void**)R_1, 3);
-    free2d((void**)R_lm1, M);
-    free2d((void**)R_l, M);
+    if(L>SH_MAX_STACK_ORDER){
+        free2d((void**)R_lm1, nBand);
+        free2d((void**)R_l, nBand);
+    }
 }
 
 void calcBFweights
@@ -789,24 +840,130 @@ void unitCart2Sph_aziElev
     (*elev_rad) = atan2f(xyz[2], hypotxy);
 }
 
+void powermapWorkspace_create
+(
+    void** const phWork,
+    int maxOrder,
+    int maxNGrid_dirs
+)
+{
+    powermapWorkspace* ws = (powermapWorkspace*)malloc(sizeof(powermapWorkspace));
+    if (ws == NULL) { return;/*error*/ }
+    *phWork = (void*)ws;
+    int nSH, nG;
+    
+    ws->maxOrder = maxOrder;
+    ws->maxNGrid_dirs = maxNGrid_dirs;
+    nSH = (maxOrder+1)*(maxOrder+1);
+    nG = MAX(maxNGrid_dirs, 1);
+    utility_cWorkspace_create(&(ws->hWork), nSH, MAX(nSH, nG));
+    ws->pwd_Cx_Y = malloc(nSH*nG*sizeof(float_complex));
+    ws->pwd_Y_Cx_Y = malloc(nG*sizeof(float_complex));
+    ws->pwd_Cx_Y_s = malloc(nSH*sizeof(float_complex));
+    ws->pwd_Y_grid_s = malloc(nSH*sizeof(float_complex));
+    ws->mvdr_w = malloc(nSH*nG*sizeof(float_complex));
+    ws->mvdr_Cx_d = malloc(nSH*nSH*sizeof(float_complex));
+    ws->mvdr_invCx_Ygrid = malloc(nSH*nG*sizeof(float_complex));
+    ws->mvdr_invCx_Ygrid_s = malloc(nSH*sizeof(float_complex));
+    ws->mvdr_Y_grid_s = malloc(nSH*sizeof(float_complex));
+    ws->cro_mvdr_map = malloc(nG*sizeof(float));
+    ws->cro_Cx_Y = malloc(nSH*nG*sizeof(float_complex));
+    ws->cro_Cx_d = malloc(nSH*nSH*sizeof(float_complex));
+    ws->cro_A = malloc(nSH*2*sizeof(float_complex));
+    ws->cro_invCxd_A = malloc(nSH*2*sizeof(float_complex));
+    ws->cro_invCxd_A_tmp = malloc(nSH*2*sizeof(float_complex));
+    ws->cro_w_LCMV_s = malloc(2*nSH*sizeof(float_complex));
+    ws->cro_w = malloc(nSH*nG*sizeof(float_complex));
+    ws->cro_wo = malloc(nSH*sizeof(float_complex));
+    ws->cro_Cx_Y_s = malloc(nSH*sizeof(float_complex));
+    ws->sub_V = malloc(nSH*nSH*sizeof(float_complex));
+    ws->sub_Vn = malloc(nSH*nSH*sizeof(float_complex));
+    ws->sub_Vn_Y = malloc(nSH*nG*sizeof(float_complex));
+    ws->sub_Vn1 = malloc(nSH*sizeof(float_complex));
+    ws->sub_Un = malloc(nSH*sizeof(float_complex));
+}
+
+void powermapWorkspace_destroy
+(
+    void** const phWork
+)
+{
+    powermapWorkspace* ws = (powermapWorkspace*)(*phWork);
+    
+    if (ws != NULL) {
+        utility_cWorkspace_destroy(&(ws->hWork));
+        free(ws->pwd_Cx_Y);
+        free(ws->pwd_Y_Cx_Y);
+        free(ws->pwd_Cx_Y_s);
+        free(ws->pwd_Y_grid_s);
+        free(ws->mvdr_w);
+        free(ws->mvdr_Cx_d);
+        free(ws->mvdr_invCx_Ygrid);
+        free(ws->mvdr_invCx_Ygrid_s);
+        free(ws->mvdr_Y_grid_s);
+        free(ws->cro_mvdr_map);
+        free(ws->cro_Cx_Y);
+        free(ws->cro_Cx_d);
+        free(ws->cro_A);
+        free(ws->cro_invCxd_A);
+        free(ws->cro_invCxd_A_tmp);
+        free(ws->cro_w_LCMV_s);
+        free(ws->cro_w);
+        free(ws->cro_wo);
+        free(ws->cro_Cx_Y_s);
+        free(ws->sub_V);
+        free(ws->sub_Vn);
+        free(ws->sub_Vn_Y);
+        free(ws->sub_Vn1);
+        free(ws->sub_Un);
+        free(ws);
+        ws = NULL;
+        *phWork = NULL;
+    }
+}
+
+/* returns the given workspace if it is large enough, otherwise creates a temporary one, which is returned via
+ * 'tmpWork' and must be destroyed by the caller */
+static powermapWorkspace* powermapWorkspace_get
+(
+    void* const hWork,
+    int order,
+    int nGrid_dirs,
+    void** tmpWork
+)
+{
+    powermapWorkspace* ws = (powermapWorkspace*)hWork;
+    
+    *tmpWork = NULL;
+    if(ws==NULL || order>ws->maxOrder || nGrid_dirs>ws->maxNGrid_dirs){
+        powermapWorkspace_create(tmpWork, order, nGrid_dirs);
+        ws = (powermapWorkspace*)(*tmpWork);
+    }
+    return ws;
+}
+
 void generatePWDmap
 (
     int order,
     float_complex* Cx,
     float_complex* Y_grid,
     int nGrid_dirs,
+    void* const hWork,
     float* pmap
 )
 {
     int i, j, nSH;
+    void* tmpWork;
+    powermapWorkspace* ws;
     float_complex* Cx_Y, *Y_Cx_Y, *Cx_Y_s, *Y_grid_s;
     const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
     
     nSH = (order+1)*(order+1);
-    Cx_Y = malloc(nSH * nGrid_dirs * sizeof(float_complex));
-    Y_Cx_Y = malloc(nGrid_dirs*sizeof(float_complex));
-    Cx_Y_s = malloc(nSH*sizeof(float_complex));
-    Y_grid_s = malloc(nSH*sizeof(float_complex));
+    ws = powermapWorkspace_get(hWork, order, nGrid_dirs, &tmpWork);
+    Cx_Y = ws->pwd_Cx_Y;
+    Y_Cx_Y = ws->pwd_Y_Cx_Y;
+    Cx_Y_s = ws->pwd_Cx_Y_s;
+    Y_grid_s = ws->pwd_Y_grid_s;
     
     /* Calculate PWD powermap: real(diag(Y_grid.'*C_x*Y_grid)) */
     cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, nGrid_dirs, nSH, &calpha,
@@ -825,10 +982,7 @@ void generatePWDmap
     for(i=0; i<nGrid_dirs; i++)
         pmap[i] = crealf(Y_Cx_Y[i]);
     
-    free(Cx_Y);
-    free(Y_Cx_Y);
-    free(Cx_Y_s);
-    free(Y_grid_s);
+    powermapWorkspace_destroy(&tmpWork);
 }
 
 void generateMVDRmap
@@ -838,21 +992,25 @@ void generateMVDRmap
     float_complex* Y_grid,
     int nGrid_dirs,
     float regPar,
+    void* const hWork,
     float* pmap,
     float_complex* w_MVDR_out
 )
 {
     int i, j, nSH;
+    void* tmpWork;
+    powermapWorkspace* ws;
     float Cx_trace;
     float_complex *Cx_d, *invCx_Ygrid, *w_MVDR, *invCx_Ygrid_s, *Y_grid_s;
     float_complex denum;
     
     nSH = (order+1)*(order+1);
-    w_MVDR = malloc(nSH * nGrid_dirs*sizeof(float_complex));
-    Cx_d = malloc(nSH*nSH*sizeof(float_complex));
-    invCx_Ygrid = malloc(nSH*nGrid_dirs*sizeof(float_complex));
-    invCx_Ygrid_s = malloc(nSH*sizeof(float_complex));
-    Y_grid_s = malloc(nSH*sizeof(float_complex));
+    ws = powermapWorkspace_get(hWork, order, nGrid_dirs, &tmpWork);
+    w_MVDR = ws->mvdr_w;
+    Cx_d = ws->mvdr_Cx_d;
+    invCx_Ygrid = ws->mvdr_invCx_Ygrid;
+    invCx_Ygrid_s = ws->mvdr_invCx_Ygrid_s;
+    Y_grid_s = ws->mvdr_Y_grid_s;
     
     /* apply diagonal loading */
     Cx_trace = 0.0f;
@@ -864,7 +1022,7 @@ void generateMVDRmap
         Cx_d[i*nSH+i] = craddf(Cx_d[i*nSH+i], regPar*Cx_trace);
     
     /* solve the numerator part of the MVDR weights for all grid directions: Cx^-1 * Y */
-    utility_cslslv(Cx_d, nSH, Y_grid, nGrid_dirs, invCx_Ygrid);
+    utility_cslslv_ws(ws->hWork, Cx_d, nSH, Y_grid, nGrid_dirs, invCx_Ygrid);
     for(i=0; i<nGrid_dirs; i++){
         /* solve the denumerator part of the MVDR weights for each grid direction: Y^T * Cx^-1 * Y */
         for(j=0; j<nSH; j++){
@@ -880,17 +1038,13 @@ void generateMVDRmap
     }
     
     /* generate MVDR powermap, by using the generatePWDmap function with the MVDR weights instead */
-    generatePWDmap(order, Cx, w_MVDR, nGrid_dirs, pmap);
+    generatePWDmap(order, Cx, w_MVDR, nGrid_dirs, ws, pmap);
     
     /* optional output of the beamforming weights */
     if (w_MVDR_out!=NULL)
         memcpy(w_MVDR_out, w_MVDR, nSH * nGrid_dirs*sizeof(float_complex));
     
-    free(w_MVDR);
-    free(Cx_d);
-    free(invCx_Ygrid);
-    free(invCx_Ygrid_s);
-    free(Y_grid_s);
+    powermapWorkspace_destroy(&tmpWork);
 }
 
 /* EXPERIMENTAL
@@ -905,10 +1059,13 @@ void generateCroPaCLCMVmap
     int nGrid_dirs,
     float regPar,
     float lambda,
+    void* const hWork,
     float* pmap  
 )
 {
     int i, j, k, nSH;
+    void* tmpWork;
+    powermapWorkspace* ws;
     float Cx_trace, S, G;
     float* mvdr_map;
     float_complex* Cx_d, *A, *invCxd_A, *invCxd_A_tmp, *w_LCMV_s, *w_CroPaC, *wo, *Cx_Y, *Cx_Y_s;
@@ -920,19 +1077,20 @@ void generateCroPaCLCMVmap
     b[0] = cmplxf(1.0f, 0.0f);
     b[1] = cmplxf(0.0f, 0.0f);
     nSH = (order+1)*(order+1);
-    Cx_Y = malloc(nSH * nGrid_dirs * sizeof(float_complex));
-    Cx_d = malloc(nSH*nSH*sizeof(float_complex));
-    A = malloc(nSH*2*sizeof(float_complex));
-    invCxd_A = malloc(nSH*2*sizeof(float_complex));
-    invCxd_A_tmp = malloc(nSH*2*sizeof(float_complex));
-    w_LCMV_s = malloc(2*nGrid_dirs*sizeof(float_complex));
-    w_CroPaC = malloc(nSH*nGrid_dirs*sizeof(float_complex));
-    wo = malloc(nSH*sizeof(float_complex));
-    mvdr_map = malloc(nGrid_dirs*sizeof(float));
-    Cx_Y_s = malloc(nSH*sizeof(float_complex));
+    ws = powermapWorkspace_get(hWork, order, nGrid_dirs, &tmpWork);
+    Cx_Y = ws->cro_Cx_Y;
+    Cx_d = ws->cro_Cx_d;
+    A = ws->cro_A;
+    invCxd_A = ws->cro_invCxd_A;
+    invCxd_A_tmp = ws->cro_invCxd_A_tmp;
+    w_LCMV_s = ws->cro_w_LCMV_s;
+    w_CroPaC = ws->cro_w;
+    wo = ws->cro_wo;
+    mvdr_map = ws->cro_mvdr_map;
+    Cx_Y_s = ws->cro_Cx_Y_s;
     
     /* generate MVDR map and weights to use as a basis */
-    generateMVDRmap(order, Cx, Y_grid, nGrid_dirs, regPar, mvdr_map, w_CroPaC);
+    generateMVDRmap(order, Cx, Y_grid, nGrid_dirs, regPar, ws, mvdr_map, w_CroPaC);
     
     /* first half of the cross-spectrum */
     cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, nGrid_dirs, nSH, &calpha,
@@ -957,7 +1115,7 @@ void generateCroPaCLCMVmap
         }
         
         /* solve for minimisation problem for LCMV weights: (Cx^-1 * A) * (A^H * Cx^-1 * A)^-1 * b */
-        utility_cslslv(Cx_d, nSH, A, 2, invCxd_A);
+        utility_cslslv_ws(ws->hWork, Cx_d, nSH, A, 2, invCxd_A);
         for(j=0; j<nSH*2; j++)
             invCxd_A_tmp[j] = conjf(invCxd_A[j]);
         cblas_cgemm(CblasRowMajor, CblasConjTrans, CblasNoTrans, 2, 2, nSH, &calpha,
@@ -967,7 +1125,7 @@ void generateCroPaCLCMVmap
         for(j=0; j<nSH; j++)
             for(k=0; k<2; k++)
                 invCxd_A_tmp[k*nSH+j] = invCxd_A[j*2+k];
-        utility_cglslv((float_complex*)A_invCxd_A, 2, invCxd_A_tmp, nSH, w_LCMV_s);
+        utility_cglslv_ws(ws->hWork, (float_complex*)A_invCxd_A, 2, invCxd_A_tmp, nSH, w_LCMV_s);
         cblas_cgemm(CblasRowMajor, CblasTrans, CblasNoTrans, nSH, 1, 2, &calpha,
                     w_LCMV_s, nSH,
                     b, 1, &cbeta,
@@ -987,18 +1145,9 @@ void generateCroPaCLCMVmap
     }
     
     /* generate CroPaC powermap, by using the generatePWDmap function with the CroPaC weights instead */
-    generatePWDmap(order, Cx, w_CroPaC, nGrid_dirs, pmap);
-    
-    free(mvdr_map);
-    free(Cx_d);
-    free(A);
-    free(invCxd_A);
-    free(invCxd_A_tmp);
-    free(w_LCMV_s);
-    free(w_CroPaC);
-    free(wo);
-    free(Cx_Y);
-    free(Cx_Y_s);
+    generatePWDmap(order, Cx, w_CroPaC, nGrid_dirs, ws, pmap);
+    
+    powermapWorkspace_destroy(&tmpWork);
 }
 
 
@@ -1010,22 +1159,26 @@ void generateMUSICmap
     int nSources,
     int nGrid_dirs,
     int logScaleFlag,
+    void* const hWork,
     float* pmap
 )
 {
     int i, j, nSH;
+    void* tmpWork;
+    powermapWorkspace* ws;
     float_complex* V, *Vn, *Vn_Y;
     const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
     float_complex tmp;
     
     nSH = (order+1)*(order+1);
     nSources = MIN(nSources, nSH/2);
-    V = malloc(nSH*nSH*sizeof(float_complex));
-    Vn = malloc(nSH*(nSH-nSources)*sizeof(float_complex));
-    Vn_Y = malloc((nSH-nSources)*nGrid_dirs*sizeof(float_complex));
+    ws = powermapWorkspace_get(hWork, order, nGrid_dirs, &tmpWork);
+    V = ws->sub_V;
+    Vn = ws->sub_Vn;
+    Vn_Y = ws->sub_Vn_Y;
     
     /* obtain eigenvectors */
-    utility_ceig(Cx, nSH, 1, NULL, V, NULL, NULL);
+    utility_ceig_ws(ws->hWork, Cx, nSH, 1, NULL, V, NULL, NULL);
     
     /* truncate, to obtain noise sub-space */
     for(i=0; i<nSH; i++)
@@ -1044,9 +1197,7 @@ void generateMUSICmap
         pmap[i] = logScaleFlag ? logf(1.0f/(crealf(tmp)+2.23e-10f)) : 1.0f/(crealf(tmp)+2.23e-10f);
     }
     
-    free(V);
-    free(Vn);
-    free(Vn_Y);
+    powermapWorkspace_destroy(&tmpWork);
 }
 
 
@@ -1058,24 +1209,28 @@ void generateMinNormMap
     int nSources,
     int nGrid_dirs,
     int logScaleFlag,
+    void* const hWork,
     float* pmap
 )
 {
     int i, j, nSH;
+    void* tmpWork;
+    powermapWorkspace* ws;
     float_complex* V, *Vn, *Vn1, *Un, *Un_Y;
     const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
     float_complex Vn1_Vn1H;
     
     nSH = (order+1)*(order+1);
     nSources = MIN(nSources, nSH/2);
-    V = malloc(nSH*nSH*sizeof(float_complex));
-    Vn = malloc(nSH*(nSH-nSources)*sizeof(float_complex));
-    Vn1 = malloc((nSH-nSources)*sizeof(float_complex));
-    Un = malloc(nSH*sizeof(float_complex));
-    Un_Y = malloc(nGrid_dirs*sizeof(float_complex));
+    ws = powermapWorkspace_get(hWork, order, nGrid_dirs, &tmpWork);
+    V = ws->sub_V;
+    Vn = ws->sub_Vn;
+    Vn1 = ws->sub_Vn1;
+    Un = ws->sub_Un;
+    Un_Y = ws->sub_Vn_Y;
     
     /* obtain eigenvectors */
-    utility_ceig(Cx, nSH, 1, NULL, V, NULL, NULL);
+    utility_ceig_ws(ws->hWork, Cx, nSH, 1, NULL, V, NULL, NULL);
     
     /* truncate, to obtain noise sub-space */
     for(i=0; i<nSH; i++)
@@ -1099,11 +1254,608 @@ void generateMinNormMap
     for(i=0; i<nGrid_dirs; i++)
         pmap[i] = logScaleFlag ? logf(1.0f/(powf(cabsf(Un_Y[i]),2.0f) + 2.23e-9f)) : 1.0f/(powf(cabsf(Un_Y[i]),2.0f) + 2.23e-9f);
     
-    free(V);
-    free(Vn);
-    free(Vn1);
-    free(Un);
-    free(Un_Y);
+    powermapWorkspace_destroy(&tmpWork);
+}
+
+/* adds vertex 'b' to the neighbour list of vertex 'a' (if not already there) */
+static void hg_addNeighbour
+(
+    int* nbrs,
+    int a,
+    int b
+)
+{
+    int k;
+    
+    for(k=0; k<HG_MAX_NEIGHBOURS; k++){
+        if(nbrs[a*HG_MAX_NEIGHBOURS+k]==b)
+            return;
+        if(nbrs[a*HG_MAX_NEIGHBOURS+k]==-1){
+            nbrs[a*HG_MAX_NEIGHBOURS+k] = b;
+            return;
+        }
+    }
+    assert(0); /* should never have more than HG_MAX_NEIGHBOURS */
+}
+
+/* returns the index of the (normalised) midpoint between neighbouring vertices 'a' and 'b'; a new vertex is
+ * appended to 'xyz' if it has not already been created for this edge */
+static int hg_getMidpoint
+(
+    int* nbrs,
+    int* mids,
+    int a,
+    int b,
+    float* xyz,
+    int* nPoints
+)
+{
+    int ka, kb, idx;
+    float norm;
+    
+    for(ka=0; ka<HG_MAX_NEIGHBOURS; ka++)
+        if(nbrs[a*HG_MAX_NEIGHBOURS+ka]==b)
+            break;
+    for(kb=0; kb<HG_MAX_NEIGHBOURS; kb++)
+        if(nbrs[b*HG_MAX_NEIGHBOURS+kb]==a)
+            break;
+    assert(ka<HG_MAX_NEIGHBOURS && kb<HG_MAX_NEIGHBOURS);
+    if(mids[a*HG_MAX_NEIGHBOURS+ka]!=-1)
+        return mids[a*HG_MAX_NEIGHBOURS+ka];
+    
+    /* create the midpoint vertex and project it onto the unit sphere */
+    idx = (*nPoints)++;
+    xyz[idx*3]   = xyz[a*3]   + xyz[b*3];
+    xyz[idx*3+1] = xyz[a*3+1] + xyz[b*3+1];
+    xyz[idx*3+2] = xyz[a*3+2] + xyz[b*3+2];
+    norm = sqrtf(xyz[idx*3]*xyz[idx*3] + xyz[idx*3+1]*xyz[idx*3+1] + xyz[idx*3+2]*xyz[idx*3+2]);
+    xyz[idx*3]   /= norm;
+    xyz[idx*3+1] /= norm;
+    xyz[idx*3+2] /= norm;
+    mids[a*HG_MAX_NEIGHBOURS+ka] = idx;
+    mids[b*HG_MAX_NEIGHBOURS+kb] = idx;
+    return idx;
+}
+
+void hierarchicalGrid_create
+(
+    void** const phHG,
+    int nLevels,
+    int order
+)
+{
+    hierarchicalGrid* hg = (hierarchicalGrid*)malloc(sizeof(hierarchicalGrid));
+    if (hg == NULL) { return;/*error*/ }
+    *phHG = (void*)hg;
+    int i, k, l, f, nFaces, nPts, nNewPts, maxFaces;
+    int a, b, c, ab, bc, ca, e0, e1;
+    int* faces, *newFaces, *tmpFaces, *mids;
+    float phi, norm;
+    float* Y_tmp;
+    const int ico_faces[20][3] = { {0,11,5},  {0,5,1},  {0,1,7},  {0,7,10}, {0,10,11},
+                                   {1,5,9},   {5,11,4}, {11,10,2},{10,7,6}, {7,1,8},
+                                   {3,9,4},   {3,4,2},  {3,2,6},  {3,6,8},  {3,8,9},
+                                   {4,9,5},   {2,4,11}, {6,2,10}, {8,6,7},  {9,8,1} };
+    
+    nLevels = MIN(MAX(nLevels, 1), 7);
+    hg->nLevels = nLevels;
+    hg->order = order;
+    hg->nSH = (order+1)*(order+1);
+    hg->nPoints = malloc(nLevels*sizeof(int));
+    for(l=0; l<nLevels; l++)
+        hg->nPoints[l] = 10*(1<<(2*l)) + 2;
+    nPts = hg->nPoints[nLevels-1];
+    maxFaces = 20*(1<<(2*(nLevels-1)));
+    hg->xyz = malloc(nPts*3*sizeof(float));
+    hg->dirs_deg = malloc(nPts*2*sizeof(float));
+    hg->neighbours = malloc(nLevels*sizeof(int*));
+    faces = malloc(maxFaces*3*sizeof(int));
+    newFaces = malloc(maxFaces*3*sizeof(int));
+    mids = malloc(nPts*HG_MAX_NEIGHBOURS*sizeof(int));
+    
+    /* level 0: icosahedron */
+    phi = (1.0f + sqrtf(5.0f))/2.0f;
+    norm = sqrtf(1.0f + phi*phi);
+    for(i=0; i<4; i++){
+        /* (+-1, +-phi, 0), (0, +-1, +-phi), (+-phi, 0, +-1) */
+        hg->xyz[i*3]        = (i%2==0 ? -1.0f : 1.0f)/norm;
+        hg->xyz[i*3+1]      = (i<2 ? phi : -phi)/norm;
+        hg->xyz[i*3+2]      = 0.0f;
+        hg->xyz[(i+4)*3]    = 0.0f;
+        hg->xyz[(i+4)*3+1]  = (i%2==0 ? -1.0f : 1.0f)/norm;
+        hg->xyz[(i+4)*3+2]  = (i<2 ? phi : -phi)/norm;
+        hg->xyz[(i+8)*3]    = (i<2 ? phi : -phi)/norm;
+        hg->xyz[(i+8)*3+1]  = 0.0f;
+        hg->xyz[(i+8)*3+2]  = (i%2==0 ? -1.0f : 1.0f)/norm;
+    }
+    for(f=0; f<20; f++)
+        for(k=0; k<3; k++)
+            faces[f*3+k] = ico_faces[f][k];
+    nFaces = 20;
+    
+    /* subdivide, while keeping track of the neighbours on each level */
+    for(l=0; l<nLevels; l++){
+        hg->neighbours[l] = malloc(hg->nPoints[l]*HG_MAX_NEIGHBOURS*sizeof(int));
+        for(i=0; i<hg->nPoints[l]*HG_MAX_NEIGHBOURS; i++)
+            hg->neighbours[l][i] = -1;
+        for(f=0; f<nFaces; f++){
+            for(k=0; k<3; k++){
+                e0 = faces[f*3+k];
+                e1 = faces[f*3+(k+1)%3];
+                hg_addNeighbour(hg->neighbours[l], e0, e1);
+                hg_addNeighbour(hg->neighbours[l], e1, e0);
+            }
+        }
+        if(l==nLevels-1)
+            break;
+        
+        /* split each triangle into 4 */
+        for(i=0; i<hg->nPoints[l]*HG_MAX_NEIGHBOURS; i++)
+            mids[i] = -1;
+        nNewPts = hg->nPoints[l];
+        for(f=0; f<nFaces; f++){
+            a = faces[f*3];
+            b = faces[f*3+1];
+            c = faces[f*3+2];
+            ab = hg_getMidpoint(hg->neighbours[l], mids, a, b, hg->xyz, &nNewPts);
+            bc = hg_getMidpoint(hg->neighbours[l], mids, b, c, hg->xyz, &nNewPts);
+            ca = hg_getMidpoint(hg->neighbours[l], mids, c, a, hg->xyz, &nNewPts);
+            newFaces[(f*4)*3]   = a;  newFaces[(f*4)*3+1]   = ab; newFaces[(f*4)*3+2]   = ca;
+            newFaces[(f*4+1)*3] = ab; newFaces[(f*4+1)*3+1] = b;  newFaces[(f*4+1)*3+2] = bc;
+            newFaces[(f*4+2)*3] = ca; newFaces[(f*4+2)*3+1] = bc; newFaces[(f*4+2)*3+2] = c;
+            newFaces[(f*4+3)*3] = ab; newFaces[(f*4+3)*3+1] = bc; newFaces[(f*4+3)*3+2] = ca;
+        }
+        assert(nNewPts==hg->nPoints[l+1]);
+        nFaces *= 4;
+        tmpFaces = faces;
+        faces = newFaces;
+        newFaces = tmpFaces;
+    }
+    
+    /* directions and (point-major) spherical harmonics of the finest level */
+    for(i=0; i<nPts; i++){
+        hg->dirs_deg[i*2]   = atan2f(hg->xyz[i*3+1], hg->xyz[i*3]) * 180.0f/M_PI;
+        hg->dirs_deg[i*2+1] = atan2f(hg->xyz[i*3+2], sqrtf(hg->xyz[i*3]*hg->xyz[i*3] + hg->xyz[i*3+1]*hg->xyz[i*3+1])) * 180.0f/M_PI;
+    }
+    Y_tmp = NULL;
+    getRSH(order, hg->dirs_deg, nPts, &Y_tmp);
+    hg->Y = malloc(nPts*(hg->nSH)*sizeof(float));
+    for(i=0; i<nPts; i++)
+        for(k=0; k<hg->nSH; k++)
+            hg->Y[i*(hg->nSH)+k] = Y_tmp[k*nPts+i];
+    
+    /* scratch */
+    hg->Rnum = malloc((hg->nSH)*(hg->nSH)*sizeof(float));
+    hg->Rden = malloc((hg->nSH)*(hg->nSH)*sizeof(float));
+    hg->Ysub = malloc(HG_EVAL_BATCH_SIZE*(hg->nSH)*sizeof(float));
+    hg->RYsub = malloc(HG_EVAL_BATCH_SIZE*(hg->nSH)*sizeof(float));
+    hg->C_tmp1 = malloc((hg->nSH)*(hg->nSH)*sizeof(float_complex));
+    hg->C_tmp2 = malloc((hg->nSH)*(hg->nSH)*sizeof(float_complex));
+    hg->C_tmp3 = malloc((hg->nSH)*(hg->nSH)*sizeof(float_complex));
+    hg->vals = malloc(nPts*sizeof(float));
+    hg->evalStamp = calloc(nPts, sizeof(int));
+    hg->stamp = 0;
+    hg->idx = malloc(nPts*sizeof(int));
+    utility_cWorkspace_create(&(hg->hWork), hg->nSH, hg->nSH);
+    
+    free(faces);
+    free(newFaces);
+    free(mids);
+    free(Y_tmp);
+}
+
+void hierarchicalGrid_destroy
+(
+    void** const phHG
+)
+{
+    hierarchicalGrid* hg = (hierarchicalGrid*)(*phHG);
+    int l;
+    
+    if (hg != NULL) {
+        for(l=0; l<hg->nLevels; l++)
+            free(hg->neighbours[l]);
+        free(hg->neighbours);
+        free(hg->nPoints);
+        free(hg->dirs_deg);
+        free(hg->xyz);
+        free(hg->Y);
+        free(hg->Rnum);
+        free(hg->Rden);
+        free(hg->Ysub);
+        free(hg->RYsub);
+        free(hg->C_tmp1);
+        free(hg->C_tmp2);
+        free(hg->C_tmp3);
+        free(hg->vals);
+        free(hg->evalStamp);
+        free(hg->idx);
+        utility_cWorkspace_destroy(&(hg->hWork));
+        free(hg);
+        hg = NULL;
+        *phHG = NULL;
+    }
+}
+
+void hierarchicalGrid_getLevel
+(
+    void* const hHG,
+    int level,
+    float** dirs_deg,
+    int* nDirs
+)
+{
+    hierarchicalGrid* hg = (hierarchicalGrid*)(hHG);
+    
+    level = MIN(MAX(level, 0), hg->nLevels-1);
+    (*dirs_deg) = hg->dirs_deg;
+    (*nDirs) = hg->nPoints[level];
+}
+
+/* evaluates the map for a batch of (at most HG_EVAL_BATCH_SIZE) grid directions with one GEMM call:
+ * val = y^T Rnum y, (MVDR: divided by (y^T Rden y)^2, MUSIC: inverted) */
+static void hg_evaluateBatch
+(
+    hierarchicalGrid* hg,
+    POWERMAP_TYPES pmapType,
+    int nSH,
+    int* batch,
+    int nBatch
+)
+{
+    int i;
+    float num, den;
+    
+    for(i=0; i<nBatch; i++)
+        memcpy(&(hg->Ysub[i*nSH]), &(hg->Y[batch[i]*(hg->nSH)]), nSH*sizeof(float));
+    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nBatch, nSH, nSH, 1.0f,
+                hg->Ysub, nSH,
+                hg->Rnum, nSH, 0.0f,
+                hg->RYsub, nSH);
+    for(i=0; i<nBatch; i++){
+        utility_svvdot(&(hg->Ysub[i*nSH]), &(hg->RYsub[i*nSH]), nSH, &num);
+        switch(pmapType){
+            default:
+            case PMAP_PWD:   hg->vals[batch[i]] = num; break;
+            case PMAP_MVDR:  hg->vals[batch[i]] = num; break; /* divided below */
+            case PMAP_MUSIC: hg->vals[batch[i]] = 1.0f/(num+2.23e-10f); break;
+        }
+    }
+    if(pmapType==PMAP_MVDR){
+        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nBatch, nSH, nSH, 1.0f,
+                    hg->Ysub, nSH,
+                    hg->Rden, nSH, 0.0f,
+                    hg->RYsub, nSH);
+        for(i=0; i<nBatch; i++){
+            utility_svvdot(&(hg->Ysub[i*nSH]), &(hg->RYsub[i*nSH]), nSH, &den);
+            hg->vals[batch[i]] /= (den*den + 2.23e-10f);
+        }
+    }
+}
+
+/* evaluates the map for the listed grid directions, skipping those already evaluated during this call */
+static void hg_evaluate
+(
+    hierarchicalGrid* hg,
+    POWERMAP_TYPES pmapType,
+    int nSH,
+    int* idx,
+    int nIdx
+)
+{
+    int i, nBatch;
+    int batch[HG_EVAL_BATCH_SIZE];
+    
+    nBatch = 0;
+    for(i=0; i<nIdx; i++){
+        if(hg->evalStamp[idx[i]]==hg->stamp)
+            continue;
+        hg->evalStamp[idx[i]] = hg->stamp;
+        batch[nBatch++] = idx[i];
+        if(nBatch==HG_EVAL_BATCH_SIZE){
+            hg_evaluateBatch(hg, pmapType, nSH, batch, nBatch);
+            nBatch = 0;
+        }
+    }
+    if(nBatch>0)
+        hg_evaluateBatch(hg, pmapType, nSH, batch, nBatch);
+}
+
+void findPowermapPeaks
+(
+    void* const hHG,
+    POWERMAP_TYPES pmapType,
+    int order,
+    float_complex* Cx,
+    int nSources,
+    float regPar,
+    int coarseLevel,
+    int maxNumPeaks,
+    float* peak_dirs_deg,
+    float* peak_vals,
+    int* nPeaks
+)
+{
+    hierarchicalGrid* hg = (hierarchicalGrid*)(hHG);
+    int i, j, k, m, l, p, q, nSH, nCoarse, nMax, nFound, best, iter, isMax, nNbrs, tmp;
+    int nbrs[HG_MAX_NEIGHBOURS];
+    float Cx_trace, minVal, w, xyz[3], norm;
+    const float_complex calpha = cmplxf(1.0f, 0.0f), cbeta = cmplxf(0.0f, 0.0f);
+    int* nbrTbl;
+    
+    assert(order<=hg->order);
+    nSH = (order+1)*(order+1);
+    coarseLevel = MIN(MAX(coarseLevel, 0), hg->nLevels-1);
+    (*nPeaks) = 0;
+    if(maxNumPeaks<1)
+        return;
+    
+    /* express the map as (a ratio of) real quadratic forms in the real steering vectors; y^T R y. Note that
+     * only the symmetric part of real(R) contributes, since the steering vectors are real-valued */
+    switch(pmapType){
+        default:
+        case PMAP_PWD:
+            /* y^T Cx y */
+            for(i=0; i<nSH; i++)
+                for(j=0; j<nSH; j++)
+                    hg->Rnum[i*nSH+j] = 0.5f*(crealf(Cx[i*nSH+j]) + crealf(Cx[j*nSH+i]));
+            break;
+            
+        case PMAP_MVDR:
+            /* (y^T B^T Cx B y) / (y^T B y)^2, where B = (Cx + diagonal loading)^-1 */
+            Cx_trace = 0.0f;
+            for(i=0; i<nSH; i++)
+                Cx_trace += crealf(Cx[i*nSH+i]);
+            Cx_trace /= (float)nSH;
+            memcpy(hg->C_tmp1, Cx, nSH*nSH*sizeof(float_complex));
+            memset(hg->C_tmp2, 0, nSH*nSH*sizeof(float_complex));
+            for(i=0; i<nSH; i++){
+                hg->C_tmp1[i*nSH+i] = craddf(hg->C_tmp1[i*nSH+i], regPar*Cx_trace);
+                hg->C_tmp2[i*nSH+i] = cmplxf(1.0f, 0.0f);
+            }
+            utility_cslslv_ws(hg->hWork, hg->C_tmp1, nSH, hg->C_tmp2, nSH, hg->C_tmp3);
+            for(i=0; i<nSH; i++)
+                for(j=0; j<nSH; j++)
+                    hg->Rden[i*nSH+j] = 0.5f*(crealf(hg->C_tmp3[i*nSH+j]) + crealf(hg->C_tmp3[j*nSH+i]));
+            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, nSH, nSH, &calpha,
+                        Cx, nSH,
+                        hg->C_tmp3, nSH, &cbeta,
+                        hg->C_tmp1, nSH);
+            for(i=0; i<nSH*nSH; i++)
+                hg->C_tmp2[i] = conjf(hg->C_tmp3[i]); /* B^T = conj(B), since B is hermitian */
+            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, nSH, nSH, nSH, &calpha,
+                        hg->C_tmp2, nSH,
+                        hg->C_tmp1, nSH, &cbeta,
+                        hg->C_tmp3, nSH);
+            for(i=0; i<nSH; i++)
+                for(j=0; j<nSH; j++)
+                    hg->Rnum[i*nSH+j] = 0.5f*(crealf(hg->C_tmp3[i*nSH+j]) + crealf(hg->C_tmp3[j*nSH+i]));
+            break;
+            
+        case PMAP_MUSIC:
+            /* 1 / (y^T Vn Vn^H y), where Vn is the noise sub-space */
+            nSources = MIN(MAX(nSources, 0), nSH/2);
+            utility_ceig_ws(hg->hWork, Cx, nSH, 1, NULL, hg->C_tmp1, NULL, NULL);
+            cblas_cgemm(CblasRowMajor, CblasNoTrans, CblasConjTrans, nSH, nSH, nSH-nSources, &calpha,
+                        &(hg->C_tmp1[nSources]), nSH,
+                        &(hg->C_tmp1[nSources]), nSH, &cbeta,
+                        hg->C_tmp2, nSH);
+            for(i=0; i<nSH; i++)
+                for(j=0; j<nSH; j++)
+                    hg->Rnum[i*nSH+j] = 0.5f*(crealf(hg->C_tmp2[i*nSH+j]) + crealf(hg->C_tmp2[j*nSH+i]));
+            break;
+    }
+    
+    /* invalidate the values cached by the previous call */
+    hg->stamp++;
+    if(hg->stamp<=0){
+        memset(hg->evalStamp, 0, hg->nPoints[hg->nLevels-1]*sizeof(int));
+        hg->stamp = 1;
+    }
+    
+    /* exhaustive evaluation over the coarse level */
+    nCoarse = hg->nPoints[coarseLevel];
+    for(i=0; i<nCoarse; i++)
+        hg->idx[i] = i;
+    hg_evaluate(hg, pmapType, nSH, hg->idx, nCoarse);
+    
+    /* find the local maxima of the coarse level (ties are broken by index) */
+    nbrTbl = hg->neighbours[coarseLevel];
+    nMax = 0;
+    for(p=0; p<nCoarse; p++){
+        isMax = 1;
+        for(k=0; k<HG_MAX_NEIGHBOURS && nbrTbl[p*HG_MAX_NEIGHBOURS+k]!=-1; k++){
+            q = nbrTbl[p*HG_MAX_NEIGHBOURS+k];
+            if(hg->vals[q]>hg->vals[p] || (hg->vals[q]==hg->vals[p] && q<p)){
+                isMax = 0;
+                break;
+            }
+        }
+        if(isMax)
+            hg->idx[nMax++] = p;
+    }
+    
+    /* retain only the strongest maxima; capped, so that the cost of the refinement below is bounded */
+    nFound = MIN(nMax, MIN(maxNumPeaks, PMAP_PEAKS_MAX_CANDIDATES));
+    for(k=0; k<nFound; k++){
+        best = k;
+        for(m=k+1; m<nMax; m++)
+            if(hg->vals[hg->idx[m]]>hg->vals[hg->idx[best]])
+                best = m;
+        tmp = hg->idx[k];
+        hg->idx[k] = hg->idx[best];
+        hg->idx[best] = tmp;
+    }
+    
+    /* refine each peak, by hill-climbing over its neighbours on each of the finer levels */
+    for(l=coarseLevel+1; l<hg->nLevels; l++){
+        nbrTbl = hg->neighbours[l];
+        for(k=0; k<nFound; k++){
+            p = hg->idx[k];
+            for(iter=0; iter<HG_MAX_HILLCLIMB_ITER; iter++){
+                for(nNbrs=0; nNbrs<HG_MAX_NEIGHBOURS && nbrTbl[p*HG_MAX_NEIGHBOURS+nNbrs]!=-1; nNbrs++)
+                    nbrs[nNbrs] = nbrTbl[p*HG_MAX_NEIGHBOURS+nNbrs];
+                hg_evaluate(hg, pmapType, nSH, nbrs, nNbrs);
+                best = p;
+                for(m=0; m<nNbrs; m++)
+                    if(hg->vals[nbrs[m]]>hg->vals[best])
+                        best = nbrs[m];
+                if(best==p)
+                    break;
+                p = best;
+            }
+            hg->idx[k] = p;
+        }
+    }
+    
+    /* peaks may have converged onto the same point */
+    for(k=1; k<nFound; k++){
+        for(m=0; m<k; m++){
+            if(hg->idx[m]==hg->idx[k]){
+                hg->idx[k--] = hg->idx[--nFound];
+                break;
+            }
+        }
+    }
+    
+    /* sort in descending order */
+    for(k=0; k<nFound; k++){
+        best = k;
+        for(m=k+1; m<nFound; m++)
+            if(hg->vals[hg->idx[m]]>hg->vals[hg->idx[best]])
+                best = m;
+        tmp = hg->idx[k];
+        hg->idx[k] = hg->idx[best];
+        hg->idx[best] = tmp;
+    }
+    
+    /* sub-grid refinement: weighted centroid of the peak and its neighbours on the finest level */
+    nbrTbl = hg->neighbours[hg->nLevels-1];
+    for(k=0; k<nFound; k++){
+        p = hg->idx[k];
+        for(nNbrs=0; nNbrs<HG_MAX_NEIGHBOURS && nbrTbl[p*HG_MAX_NEIGHBOURS+nNbrs]!=-1; nNbrs++)
+            nbrs[nNbrs] = nbrTbl[p*HG_MAX_NEIGHBOURS+nNbrs];
+        hg_evaluate(hg, pmapType, nSH, nbrs, nNbrs);
+        minVal = hg->vals[p];
+        for(m=0; m<nNbrs; m++)
+            minVal = MIN(minVal, hg->vals[nbrs[m]]);
+        w = hg->vals[p]-minVal;
+        for(i=0; i<3; i++)
+            xyz[i] = w*hg->xyz[p*3+i];
+        for(m=0; m<nNbrs; m++){
+            w = hg->vals[nbrs[m]]-minVal;
+            for(i=0; i<3; i++)
+                xyz[i] += w*hg->xyz[nbrs[m]*3+i];
+        }
+        norm = sqrtf(xyz[0]*xyz[0] + xyz[1]*xyz[1] + xyz[2]*xyz[2]);
+        if(norm>2.23e-10f)
+            for(i=0; i<3; i++)
+                xyz[i] /= norm;
+        else
+            for(i=0; i<3; i++)
+                xyz[i] = hg->xyz[p*3+i];
+        peak_dirs_deg[k*2]   = atan2f(xyz[1], xyz[0]) * 180.0f/M_PI;
+        peak_dirs_deg[k*2+1] = atan2f(xyz[2], sqrtf(xyz[0]*xyz[0] + xyz[1]*xyz[1])) * 180.0f/M_PI;
+        if(peak_vals!=NULL)
+            peak_vals[k] = hg->vals[p];
+    }
+    (*nPeaks) = nFound;
+}
+
+/* list of shared spherical harmonic grid resources currently in use, and the lock protecting it. The lock is not held
+ * whilst the spherical harmonics of a new resource are computed; if two callers happen to compute the same one at the
+ * same time, the one that finishes second uses (and frees its own copy in favour of) the one added by the first */
+static shLock shGridResLock = SH_LOCK_INIT;
+static shGridResource* shGridResList = NULL;
+
+/* returns the resource for the given order and geosphere from the list, with its reference count incremented; or NULL
+ * if it is not in the list. The lock must be held */
+static shGridResource* shGridResource_find(int order, int icoFreq)
+{
+    shGridResource* res;
+    
+    for(res = shGridResList; res!=NULL; res = res->next){
+        if(res->order==order && res->icoFreq==icoFreq){
+            res->refCount++;
+            break;
+        }
+    }
+    return res;
+}
+
+void shGridResource_acquire
+(
+    int order,
+    int icoFreq,
+    shGridResource** phRes
+)
+{
+    shGridResource* res, *found;
+    float scaleY;
+    
+    SH_LOCK(&shGridResLock);
+    res = shGridResource_find(order, icoFreq);
+    SH_UNLOCK(&shGridResLock);
+    
+    if(res==NULL){
+        /* compute the spherical harmonics without holding the lock */
+        res = calloc(1, sizeof(shGridResource));
+        res->order = order;
+        res->icoFreq = icoFreq;
+        res->dirs_deg = __HANDLES_geosphere_ico_dirs_deg[icoFreq];
+        res->nDirs = __geosphere_ico_nPoints[icoFreq];
+        res->refCount = 1;
+        getRSH(order, (float*)res->dirs_deg, res->nDirs, &(res->Y));
+        scaleY = 1.0f/sqrtf(4.0f*M_PI);
+        utility_svsmul(res->Y, &scaleY, (order+1)*(order+1)*(res->nDirs), NULL);
+        
+        /* add it to the list, unless another caller has added the same one in the meantime */
+        SH_LOCK(&shGridResLock);
+        found = shGridResource_find(order, icoFreq);
+        if(found==NULL){
+            res->next = shGridResList;
+            shGridResList = res;
+        }
+        SH_UNLOCK(&shGridResLock);
+        if(found!=NULL){
+            free(res->Y);
+            free(res);
+            res = found;
+        }
+    }
+    
+    shGridResource_release(phRes);
+    (*phRes) = res;
+}
+
+void shGridResource_release
+(
+    shGridResource** phRes
+)
+{
+    shGridResource* res, **pp;
+    
+    res = (*phRes);
+    if(res==NULL)
+        return;
+    SH_LOCK(&shGridResLock);
+    if(--(res->refCount) == 0){
+        /* last user, remove from the list */
+        for(pp = &shGridResList; (*pp)!=NULL; pp = &((*pp)->next)){
+            if((*pp)==res){
+                (*pp) = res->next;
+                break;
+            }
+        }
+    }
+    else
+        res = NULL;
+    SH_UNLOCK(&shGridResLock);
+    if(res!=NULL){
+        free(res->Y);
+        free(res);
+    }
+    (*phRes) = NULL;
 }
 
 void bessel_Jn /* untested */
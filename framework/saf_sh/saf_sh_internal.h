@@ -40,6 +40,79 @@
 extern "C" {
 #endif
  
+#define HG_MAX_NEIGHBOURS ( 6 )      /* maximum number of neighbours of a vertex on a subdivided icosahedron */
+#define HG_MAX_HILLCLIMB_ITER ( 16 ) /* maximum number of hill-climbing steps per peak and grid level (see saf_sh.h) */
+#define HG_EVAL_BATCH_SIZE ( 128 )   /* maximum number of grid directions evaluated per GEMM call */
+#define SH_MAX_STACK_ORDER ( 15 )    /* SHs/rotation matrices up to this order are computed without allocating memory */
+
+/* Hierarchical spherical grid, obtained by recursively subdividing an icosahedron. The grid points are
+ * nested, such that the points of grid level 'l' are the first nPoints[l] points of all finer levels */
+typedef struct _hierarchicalGrid {
+    int nLevels;                     /* number of grid levels; level 0: 12 points, level l: 10*4^l+2 points */
+    int order;                       /* maximum spherical harmonic order supported by the grid */
+    int nSH;                         /* (order+1)^2 */
+    int* nPoints;                    /* number of points per level; nLevels x 1 */
+    float* dirs_deg;                 /* grid directions of the finest level; FLAT: nPoints[nLevels-1] x 2 */
+    float* xyz;                      /* unit cartesian coordinates of the finest level; FLAT: nPoints[nLevels-1] x 3 */
+    float* Y;                        /* real SH (N3D) of the finest level, point-major; FLAT: nPoints[nLevels-1] x nSH */
+    int** neighbours;                /* neighbour indices per level, -1 padded; nLevels x FLAT: nPoints[l] x HG_MAX_NEIGHBOURS */
+    
+    /* scratch (peak search) */
+    float* Rnum;                     /* quadratic form of the numerator; FLAT: nSH x nSH */
+    float* Rden;                     /* quadratic form of the denominator (MVDR only); FLAT: nSH x nSH */
+    float* Ysub;                     /* gathered steering vectors; FLAT: HG_EVAL_BATCH_SIZE x nSH */
+    float* RYsub;                    /* Ysub * R; FLAT: HG_EVAL_BATCH_SIZE x nSH */
+    float_complex* C_tmp1;           /* FLAT: nSH x nSH */
+    float_complex* C_tmp2;           /* FLAT: nSH x nSH */
+    float_complex* C_tmp3;           /* FLAT: nSH x nSH */
+    float* vals;                     /* cached map values, finest level; nPoints[nLevels-1] x 1 */
+    int* evalStamp;                  /* call stamp for which vals[i] is valid; nPoints[nLevels-1] x 1 */
+    int stamp;                       /* current call stamp */
+    int* idx;                        /* index scratch; nPoints[nLevels-1] x 1 */
+    void* hWork;                     /* linear solver/eigen-solver workspace (see "utility_cWorkspace_create") */
+    
+}hierarchicalGrid;
+
+/* workspace for the powermap functions; each function has its own buffers, since MVDR calls PWD and CroPaC calls MVDR */
+typedef struct _powermapWorkspace {
+    int maxOrder;                    /* highest analysis order supported */
+    int maxNGrid_dirs;               /* largest number of grid directions supported */
+    void* hWork;                     /* linear solver/eigen-solver workspace, maxNSH x max(maxNSH, maxNGrid_dirs) */
+    
+    /* PWD */
+    float_complex* pwd_Cx_Y;         /* FLAT: maxNSH x maxNGrid_dirs */
+    float_complex* pwd_Y_Cx_Y;       /* maxNGrid_dirs x 1 */
+    float_complex* pwd_Cx_Y_s;       /* maxNSH x 1 */
+    float_complex* pwd_Y_grid_s;     /* maxNSH x 1 */
+    
+    /* MVDR */
+    float_complex* mvdr_w;           /* FLAT: maxNSH x maxNGrid_dirs */
+    float_complex* mvdr_Cx_d;        /* FLAT: maxNSH x maxNSH */
+    float_complex* mvdr_invCx_Ygrid; /* FLAT: maxNSH x maxNGrid_dirs */
+    float_complex* mvdr_invCx_Ygrid_s; /* maxNSH x 1 */
+    float_complex* mvdr_Y_grid_s;    /* maxNSH x 1 */
+    
+    /* CroPaC LCMV */
+    float* cro_mvdr_map;             /* maxNGrid_dirs x 1 */
+    float_complex* cro_Cx_Y;         /* FLAT: maxNSH x maxNGrid_dirs */
+    float_complex* cro_Cx_d;         /* FLAT: maxNSH x maxNSH */
+    float_complex* cro_A;            /* FLAT: maxNSH x 2 */
+    float_complex* cro_invCxd_A;     /* FLAT: maxNSH x 2 */
+    float_complex* cro_invCxd_A_tmp; /* FLAT: maxNSH x 2 */
+    float_complex* cro_w_LCMV_s;     /* FLAT: 2 x maxNSH */
+    float_complex* cro_w;            /* FLAT: maxNSH x maxNGrid_dirs */
+    float_complex* cro_wo;           /* maxNSH x 1 */
+    float_complex* cro_Cx_Y_s;       /* maxNSH x 1 */
+    
+    /* MUSIC and MinNorm */
+    float_complex* sub_V;            /* FLAT: maxNSH x maxNSH */
+    float_complex* sub_Vn;           /* FLAT: maxNSH x maxNSH */
+    float_complex* sub_Vn_Y;         /* FLAT: maxNSH x maxNGrid_dirs */
+    float_complex* sub_Vn1;          /* maxNSH x 1 */
+    float_complex* sub_Un;           /* maxNSH x 1 */
+    
+}powermapWorkspace;
+
 /* Calculates Chebyshev Polynomial Coefficients */
 void ChebyshevPolyCoeff (int n,              /* order of spherical harmonic expansion */
                          float* t_coeff);    /* resulting Chebyshev Polynomial Coefficients */
@@ -0,0 +1,158 @@
+/*
+ Copyright 2017-2018 Leo McCormack
+ 
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     saf_sofa_reader.c
+ * Description:
+ *     A simple sofa reader, which returns only the bare minimum.
+ * Dependencies:
+ *     netcdf
+ * Author, date created:
+ *     Leo McCormack, 21.11.2017
+ */
+
+#ifdef SAF_ENABLE_SOFA_READER
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <netcdf.h>
+#include "saf_sofa_reader.h"
+
+#ifndef MIN
+  #define MIN(a,b) (( (a) < (b) ) ? (a) : (b))
+#endif
+
+/* returns the lengths of the (first "nDims") dimensions of a variable; returns 0 if the variable is not found */
+static int getVarDims(int ncid, const char* name, int nDims, int* varid, size_t* dims)
+{
+    int i, ndimsp, dimids[NC_MAX_VAR_DIMS];
+    
+    if (nc_inq_varid(ncid, name, varid) != NC_NOERR)
+        return 0;
+    if (nc_inq_varndims(ncid, *varid, &ndimsp) != NC_NOERR || ndimsp < nDims || ndimsp > NC_MAX_VAR_DIMS)
+        return 0;
+    if (nc_inq_vardimid(ncid, *varid, dimids) != NC_NOERR)
+        return 0;
+    for(i=0; i<nDims; i++)
+        if (nc_inq_dimlen(ncid, dimids[i], &dims[i]) != NC_NOERR)
+            return 0;
+    return 1;
+}
+
+void loadSofaFile
+(
+    char* sofa_filepath,
+    float** hrirs,
+    float** hrir_dirs_deg,
+    int* N_hrir_dirs,
+    int* hrir_len,
+    int* hrir_fs
+)
+{
+    loadSofaFile_subset(sofa_filepath, NULL, 0, MAX_HRIR_LENGTH, SOFA_READER_CHUNK_SIZE, NULL, NULL,
+                        hrirs, hrir_dirs_deg, N_hrir_dirs, hrir_len, hrir_fs);
+}
+
+void loadSofaFile_subset
+(
+    char* sofa_filepath,
+    int* dirIndices,
+    int nDirIndices,
+    int maxLength,
+    int chunkSize,
+    sofaProgressCallback progress,
+    void* userData,
+    float** hrirs,
+    float** hrir_dirs_deg,
+    int* N_hrir_dirs,
+    int* hrir_len,
+    int* hrir_fs
+)
+{
+    int i, j, nDirs, run, ok, ncid, IR_varid, pos_varid, fs_varid;
+    size_t IR_dims[3], pos_dims[2], fs_dims[1], start[3], count[3], irSize, zero;
+    double IR_fs;
+    
+    /* free any existing memory */
+    if ((*hrirs)!=NULL){
+        free((*hrirs));
+        (*hrirs) = NULL;
+    }
+    if ((*hrir_dirs_deg)!=NULL){
+        free((*hrir_dirs_deg));
+        (*hrir_dirs_deg) = NULL;
+    }
+    
+    /* open sofa file (returning NULLs if not a real file) */
+    if (nc_open(sofa_filepath, NC_NOWRITE, &ncid) != NC_NOERR)
+        return;
+    
+    /* IR data: M x R x N, source positions: M x C, and the sampling rate */
+    ok = getVarDims(ncid, "Data.IR", 3, &IR_varid, IR_dims) &&
+         getVarDims(ncid, "SourcePosition", 2, &pos_varid, pos_dims) &&
+         getVarDims(ncid, "Data.SamplingRate", 1, &fs_varid, fs_dims);
+    ok = ok && pos_dims[0] == IR_dims[0] && pos_dims[1] >= 2;
+    zero = 0;
+    ok = ok && nc_get_var1_double(ncid, fs_varid, &zero, &IR_fs) == NC_NOERR;
+    nDirs = dirIndices == NULL ? (int)IR_dims[0] : nDirIndices;
+    for(i=0; ok && dirIndices!=NULL && i<nDirIndices; i++)
+        ok = dirIndices[i] >= 0 && dirIndices[i] < (int)IR_dims[0];
+    ok = ok && nDirs > 0;
+    if(!ok){
+        nc_close(ncid);
+        return;
+    }
+    
+    /* only the retained part of the IRs is ever read, directly in single precision */
+    (*hrir_len) = MIN((int)IR_dims[2], maxLength > 0 ? maxLength : (int)IR_dims[2]);
+    (*hrir_fs) = (int)(IR_fs+0.5);
+    (*N_hrir_dirs) = nDirs;
+    irSize = IR_dims[1] * (size_t)(*hrir_len);
+    (*hrirs) = malloc(nDirs*irSize*sizeof(float));
+    (*hrir_dirs_deg) = malloc(nDirs*2*sizeof(float));
+    if(chunkSize <= 0)
+        chunkSize = SOFA_READER_CHUNK_SIZE;
+    
+    /* read blocks of "chunkSize" positions; each as hyperslabs over runs of consecutive position indices */
+    for(i=0; ok && i<nDirs; i+=chunkSize){
+        for(j=i; ok && j<MIN(i+chunkSize, nDirs); j+=run){
+            start[0] = dirIndices == NULL ? (size_t)j : (size_t)dirIndices[j];
+            for(run=1; j+run<MIN(i+chunkSize, nDirs); run++)
+                if(dirIndices != NULL && dirIndices[j+run] != dirIndices[j]+run)
+                    break;
+            start[1] = start[2] = 0;
+            count[0] = (size_t)run;
+            count[1] = IR_dims[1];
+            count[2] = (size_t)(*hrir_len);
+            ok = nc_get_vara_float(ncid, IR_varid, start, count, &((*hrirs)[j*irSize])) == NC_NOERR;
+            count[1] = 2; /* azimuth, elevation */
+            ok = ok && nc_get_vara_float(ncid, pos_varid, start, count, &((*hrir_dirs_deg)[j*2])) == NC_NOERR;
+        }
+        if(ok && progress != NULL)
+            ok = progress(userData, MIN(i+chunkSize, nDirs), nDirs) == 0;
+    }
+    
+    /* Close the file, freeing all resources. */
+    nc_close(ncid);
+    if(!ok){
+        free((*hrirs));
+        free((*hrir_dirs_deg));
+        (*hrirs) = NULL;
+        (*hrir_dirs_deg) = NULL;
+    }
+}
+
+#endif /* SAF_ENABLE_SOFA_READER */
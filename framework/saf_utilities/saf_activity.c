@@ -0,0 +1,57 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     saf_activity.c
+ * Description:
+ *     Per-channel activity detection, for skipping the processing of silent input channels.
+ *     A channel is silent for a frame if the mean energy of the frame is below
+ *     SAF_ACTIVITY_THRESHOLD_DB. It remains active until it has been silent for more than a
+ *     "hold" number of frames, which must at least span the memory of any processing applied
+ *     to the channel (e.g. the filterbank, see afSTFTtail), and becomes active again as soon as
+ *     a frame is not silent.
+ * Dependencies:
+ *     none
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include <math.h>
+#include "saf_activity.h"
+
+int saf_activity_getHoldFrames(float holdTime_ms, float fs, int frameSize, int minHoldSamples)
+{
+    int holdFrames, minHoldFrames;
+
+    holdFrames = (int)ceilf(holdTime_ms > 0.0f ? holdTime_ms*fs/(1000.0f*(float)frameSize) : 0.0f);
+    minHoldFrames = (minHoldSamples + frameSize - 1)/frameSize;
+    return holdFrames > minHoldFrames ? holdFrames : minHoldFrames;
+}
+
+int saf_activity_update(const float* frame, int frameSize, int holdFrames, int* nSilentFrames)
+{
+    const float threshold = powf(10.0f, SAF_ACTIVITY_THRESHOLD_DB/10.0f)*(float)frameSize;
+    float energy;
+    int i;
+
+    energy = 0.0f;
+    for(i=0; i<frameSize; i++)
+        energy += frame[i]*frame[i];
+    if(energy >= threshold)
+        *nSilentFrames = 0;
+    else if(*nSilentFrames <= holdFrames)
+        (*nSilentFrames)++;
+    return *nSilentFrames <= holdFrames;
+}
@@ -0,0 +1,59 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     saf_activity.h
+ * Description:
+ *     Per-channel activity detection, for skipping the processing of silent input channels.
+ *     A channel is silent for a frame if the mean energy of the frame is below
+ *     SAF_ACTIVITY_THRESHOLD_DB. It remains active until it has been silent for more than a
+ *     "hold" number of frames, which must at least span the memory of any processing applied
+ *     to the channel (e.g. the filterbank, see afSTFTtail), and becomes active again as soon as
+ *     a frame is not silent.
+ * Dependencies:
+ *     none
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#ifndef SAF_ACTIVITY_H_INCLUDED
+#define SAF_ACTIVITY_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SAF_ACTIVITY_THRESHOLD_DB ( -120.0f )   /* mean frame energy (dB re. full scale) below which a channel is silent */
+#define SAF_ACTIVITY_DEFAULT_HOLD_MS ( 100.0f ) /* default hold time, in milliseconds */
+
+/* returns the hold time in frames: "holdTime_ms" rounded up to whole frames, but no fewer than needed to span
+ * "minHoldSamples" samples of processing memory */
+int saf_activity_getHoldFrames(float holdTime_ms,               /* hold time, in milliseconds */
+                               float fs,                        /* sampling rate */
+                               int frameSize,                   /* number of samples per frame */
+                               int minHoldSamples);             /* memory of the processing (e.g. afSTFTtail) */
+
+/* updates the activity of one channel with its next frame; returns 1 if the channel is active, 0 if it is not */
+int saf_activity_update(const float* frame,                     /* input frame; frameSize x 1 */
+                        int frameSize,                          /* number of samples per frame */
+                        int holdFrames,                         /* hold time, in frames (see saf_activity_getHoldFrames) */
+                        int* nSilentFrames);                    /* & number of consecutive silent frames so far */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SAF_ACTIVITY_H_INCLUDED */
@@ -28,6 +28,7 @@
  */
 
 #include "saf_calloc.h"
+#include "saf_malloc.h" /* for the real-time allocation check */
 
 void*** calloc3d(int dim1, int dim2, int dim3, size_t _Size)
 {
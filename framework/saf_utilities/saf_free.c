@@ -28,6 +28,7 @@
  */
 
 #include "saf_free.h"
+#include "saf_malloc.h" /* for the real-time allocation check */
 
 void free3d(void ***arr, int dim1, int dim2)
 {
@@ -28,6 +28,9 @@
  */
 
 #include "saf_malloc.h"
+#ifdef SAF_ENABLE_RT_ALLOC_CHECK
+#include "saf_threads.h"
+#endif
 
 void ***malloc3d(int dim1, int  dim2, int dim3, size_t _Size)
 {
@@ -90,7 +93,71 @@ void* malloc1d(int dim1, size_t _Size)
     return arr;
 }
 
+#ifdef SAF_ENABLE_RT_ALLOC_CHECK
 
+static SAF_THREAD_LOCAL int saf_rt_depth = 0; /* real-time region nesting depth of the calling thread */
+static volatile int saf_rt_nAllocs = 0;
+static volatile int saf_rt_abortOnAlloc = 0;
 
+static void saf_rt_check(const char* op, size_t size, const char* file, int line)
+{
+    if(saf_rt_depth>0){
+        saf_atomic_fetch_addi(&saf_rt_nAllocs, 1);
+        fprintf(stderr, "saf_rt: %s(%lu) inside a real-time region, at %s:%d\n", op, (unsigned long)size, file, line);
+        if(saf_atomic_loadi(&saf_rt_abortOnAlloc))
+            abort();
+    }
+}
+
+void saf_rt_scope_enter(void)
+{
+    saf_rt_depth++;
+}
+
+void saf_rt_scope_exit(void)
+{
+    saf_rt_depth--;
+}
+
+int saf_rt_getNumAllocs(void)
+{
+    return saf_atomic_loadi(&saf_rt_nAllocs);
+}
+
+void saf_rt_resetNumAllocs(void)
+{
+    saf_atomic_storei(&saf_rt_nAllocs, 0);
+}
 
+void saf_rt_setAbortOnAlloc(int newState)
+{
+    saf_atomic_storei(&saf_rt_abortOnAlloc, newState);
+}
+
+/* (malloc) etc. suppresses the macros defined in saf_malloc.h, and calls the standard library functions */
+void* saf_rt_malloc(size_t size, const char* file, int line)
+{
+    saf_rt_check("malloc", size, file, line);
+    return (malloc)(size);
+}
+
+void* saf_rt_calloc(size_t nmemb, size_t size, const char* file, int line)
+{
+    saf_rt_check("calloc", nmemb*size, file, line);
+    return (calloc)(nmemb, size);
+}
+
+void* saf_rt_realloc(void* ptr, size_t size, const char* file, int line)
+{
+    saf_rt_check("realloc", size, file, line);
+    return (realloc)(ptr, size);
+}
+
+void saf_rt_free(void* ptr, const char* file, int line)
+{
+    if(ptr!=NULL)
+        saf_rt_check("free", 0, file, line);
+    (free)(ptr);
+}
 
+#endif /* SAF_ENABLE_RT_ALLOC_CHECK */
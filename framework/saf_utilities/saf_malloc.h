@@ -41,6 +41,55 @@ extern "C" {
 void***   malloc3d(int dim1, int dim2, int dim3, size_t _Size);
 void**    malloc2d(int dim1, int dim2, size_t _Size); 
 void*     malloc1d(int dim1, size_t _Size);
+    
+    
+/******************************/
+/* Real-time allocation check */
+/******************************/
+    
+/* Audit mode for finding heap usage on the audio thread. When the framework and the examples are built with
+ * SAF_ENABLE_RT_ALLOC_CHECK defined (globally, e.g. -DSAF_ENABLE_RT_ALLOC_CHECK), every malloc/calloc/realloc/free
+ * made in code that includes this header (including the malloc*d/calloc*d/free*d helpers) is routed through the
+ * functions below. Any such call made whilst the calling thread is inside a SAF_RT_SCOPE_BEGIN/SAF_RT_SCOPE_END
+ * region is counted, reported to stderr with its file and line, and optionally aborts. The scope macros also
+ * restrict BLAS/LAPACK to the calling thread (see "utility_blasThreadsBegin" in saf_veclib.h); without the define,
+ * that is all they do. Note: allocations made internally by BLAS/LAPACK implementations are not visible to this
+ * check. */
+#ifdef SAF_ENABLE_RT_ALLOC_CHECK
+    
+/* marks the start of a real-time region on the calling thread (regions may be nested) */
+void saf_rt_scope_enter(void);
+
+/* marks the end of a real-time region on the calling thread */
+void saf_rt_scope_exit(void);
+
+/* returns the number of heap operations made inside real-time regions so far (all threads) */
+int saf_rt_getNumAllocs(void);
+
+/* resets the counter returned by "saf_rt_getNumAllocs" */
+void saf_rt_resetNumAllocs(void);
+
+/* 0: count and report heap operations inside real-time regions (default), 1: also call abort() */
+void saf_rt_setAbortOnAlloc(int newState);
+
+void* saf_rt_malloc(size_t size, const char* file, int line);
+void* saf_rt_calloc(size_t nmemb, size_t size, const char* file, int line);
+void* saf_rt_realloc(void* ptr, size_t size, const char* file, int line);
+void  saf_rt_free(void* ptr, const char* file, int line);
+
+#define malloc(size) saf_rt_malloc(size, __FILE__, __LINE__)
+#define calloc(nmemb, size) saf_rt_calloc(nmemb, size, __FILE__, __LINE__)
+#define realloc(ptr, size) saf_rt_realloc(ptr, size, __FILE__, __LINE__)
+#define free(ptr) saf_rt_free(ptr, __FILE__, __LINE__)
+#define SAF_RT_SCOPE_BEGIN do{ saf_rt_scope_enter(); utility_blasThreadsBegin(); }while(0)
+#define SAF_RT_SCOPE_END do{ utility_blasThreadsEnd(); saf_rt_scope_exit(); }while(0)
+
+#else
+    
+#define SAF_RT_SCOPE_BEGIN utility_blasThreadsBegin()
+#define SAF_RT_SCOPE_END utility_blasThreadsEnd()
+    
+#endif /* SAF_ENABLE_RT_ALLOC_CHECK */
 
 #ifdef __cplusplus
 }/* extern "C" */ 
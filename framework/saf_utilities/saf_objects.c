@@ -0,0 +1,250 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     saf_objects.c
+ * Description:
+ *     A store of audio objects (sources with a dynamic lifetime), for the object-based
+ *     renderers. Objects are identified by an ID in the range 0..maxNumObjects-1, and each
+ *     has a direction and a gain. The store is allocated once, for its maximum number of
+ *     objects, with the fields held in separate arrays indexed by ID, along with a list of
+ *     the IDs in use. The writers add, remove and update objects, and then publish the
+ *     changes; the readers (e.g. the audio thread) see consistent snapshots, via a parameter
+ *     block (see saf_threads.h). Each writer call holds the writer lock of the parameter block
+ *     from its edit to its publish/release, so writers may be on different threads. Neither
+ *     side allocates memory.
+ * Dependencies:
+ *     saf_threads
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include <stdlib.h>
+#include "saf_objects.h"
+#include "saf_threads.h"
+
+/* the parameter block holds one contiguous copy of all fields, in the order of "saf_objects_fields" */
+typedef struct _saf_objects_fields {
+    int* nObjects;
+    int* ids;
+    float (*dirs_deg)[2];
+    float* gains;
+    int* generations;
+
+}saf_objects_fields;
+
+typedef struct _saf_objects {
+    int maxNumObjects;
+    void* hPB;              /* parameter block of the fields */
+    saf_objects_fields w;   /* fields of the writer's working copy */
+    int* pos;               /* index of each ID in "ids" of the working copy; -1: not in use; maxNumObjects x 1 */
+
+}saf_objects;
+
+/* returns the size of the fields of "maxNumObjects" objects, in bytes */
+static size_t saf_objects_getSize(int maxNumObjects)
+{
+    return (size_t)(1 + 2*maxNumObjects)*sizeof(int) + (size_t)(3*maxNumObjects)*sizeof(float);
+}
+
+/* points "fields" into a copy of the fields, starting at "base" */
+static void saf_objects_getFields(const void* base, int maxNumObjects, saf_objects_fields* fields)
+{
+    char* p = (char*)base;
+
+    fields->nObjects = (int*)p;                 p += sizeof(int);
+    fields->ids = (int*)p;                      p += maxNumObjects*sizeof(int);
+    fields->dirs_deg = (float(*)[2])p;          p += 2*maxNumObjects*sizeof(float);
+    fields->gains = (float*)p;                  p += maxNumObjects*sizeof(float);
+    fields->generations = (int*)p;
+}
+
+void saf_objects_create
+(
+    void** const phObj,
+    int maxNumObjects,
+    int nReaders
+)
+{
+    saf_objects* h = (saf_objects*)malloc(sizeof(saf_objects));
+    int i;
+
+    *phObj = (void*)h;
+    if(h == NULL) { return;/*error*/ }
+    h->maxNumObjects = maxNumObjects > 0 ? maxNumObjects : 1;
+    saf_paramBlock_create(&(h->hPB), saf_objects_getSize(h->maxNumObjects), nReaders);
+    saf_objects_getFields(saf_paramBlock_peek(h->hPB), h->maxNumObjects, &(h->w));
+    h->pos = (int*)malloc(h->maxNumObjects*sizeof(int));
+    for(i=0; i<h->maxNumObjects; i++)
+        h->pos[i] = -1;
+    saf_objects_publish(h);
+}
+
+void saf_objects_destroy
+(
+    void** const phObj
+)
+{
+    saf_objects* h = (saf_objects*)(*phObj);
+
+    if(h != NULL){
+        saf_paramBlock_destroy(&(h->hPB));
+        free(h->pos);
+        free(h);
+        *phObj = NULL;
+    }
+}
+
+int saf_objects_getMaxNumObjects(void* const hObj)
+{
+    saf_objects* h = (saf_objects*)hObj;
+    return h->maxNumObjects;
+}
+
+int saf_objects_add
+(
+    void* const hObj,
+    int id,
+    float azi_deg,
+    float elev_deg,
+    float gain
+)
+{
+    saf_objects* h = (saf_objects*)hObj;
+
+    if(id<0 || id>=h->maxNumObjects)
+        return -1;
+    saf_paramBlock_edit(h->hPB);
+    if(h->pos[id]>=0){
+        saf_paramBlock_release(h->hPB);
+        return -1;
+    }
+    h->pos[id] = *(h->w.nObjects);
+    h->w.ids[(*(h->w.nObjects))++] = id;
+    h->w.generations[id]++;
+    h->w.dirs_deg[id][0] = azi_deg;
+    h->w.dirs_deg[id][1] = elev_deg;
+    h->w.gains[id] = gain;
+    saf_paramBlock_release(h->hPB);
+    return 0;
+}
+
+int saf_objects_remove
+(
+    void* const hObj,
+    int id
+)
+{
+    saf_objects* h = (saf_objects*)hObj;
+    int last;
+
+    if(id<0 || id>=h->maxNumObjects)
+        return -1;
+    saf_paramBlock_edit(h->hPB);
+    if(h->pos[id]<0){
+        saf_paramBlock_release(h->hPB);
+        return -1;
+    }
+
+    /* the last object in the list takes the place of the removed one */
+    last = h->w.ids[--(*(h->w.nObjects))];
+    h->w.ids[h->pos[id]] = last;
+    h->pos[last] = h->pos[id];
+    h->pos[id] = -1;
+    saf_paramBlock_release(h->hPB);
+    return 0;
+}
+
+int saf_objects_update
+(
+    void* const hObj,
+    int id,
+    float azi_deg,
+    float elev_deg,
+    float gain
+)
+{
+    saf_objects* h = (saf_objects*)hObj;
+
+    if(id<0 || id>=h->maxNumObjects)
+        return -1;
+    saf_paramBlock_edit(h->hPB);
+    if(h->pos[id]<0){
+        saf_paramBlock_release(h->hPB);
+        return -1;
+    }
+    h->w.dirs_deg[id][0] = azi_deg;
+    h->w.dirs_deg[id][1] = elev_deg;
+    h->w.gains[id] = gain;
+    saf_paramBlock_release(h->hPB);
+    return 0;
+}
+
+int saf_objects_get
+(
+    void* const hObj,
+    int id,
+    float* azi_deg,
+    float* elev_deg,
+    float* gain
+)
+{
+    saf_objects* h = (saf_objects*)hObj;
+
+    if(id<0 || id>=h->maxNumObjects)
+        return -1;
+    saf_paramBlock_edit(h->hPB);
+    if(h->pos[id]<0){
+        saf_paramBlock_release(h->hPB);
+        return -1;
+    }
+    *azi_deg = h->w.dirs_deg[id][0];
+    *elev_deg = h->w.dirs_deg[id][1];
+    *gain = h->w.gains[id];
+    saf_paramBlock_release(h->hPB);
+    return 0;
+}
+
+int saf_objects_getNumObjects(void* const hObj)
+{
+    saf_objects* h = (saf_objects*)hObj;
+    return *(h->w.nObjects);
+}
+
+void saf_objects_publish(void* const hObj)
+{
+    saf_objects* h = (saf_objects*)hObj;
+    saf_paramBlock_edit(h->hPB);
+    saf_paramBlock_publish(h->hPB);
+}
+
+void saf_objects_read
+(
+    void* const hObj,
+    int readerIdx,
+    saf_objects_view* view
+)
+{
+    saf_objects* h = (saf_objects*)hObj;
+    saf_objects_fields fields;
+
+    saf_objects_getFields(saf_paramBlock_read(h->hPB, readerIdx), h->maxNumObjects, &fields);
+    view->maxNumObjects = h->maxNumObjects;
+    view->nObjects = *(fields.nObjects);
+    view->ids = fields.ids;
+    view->dirs_deg = (const float(*)[2])fields.dirs_deg;
+    view->gains = fields.gains;
+    view->generations = fields.generations;
+}
@@ -0,0 +1,106 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     saf_objects.h
+ * Description:
+ *     A store of audio objects (sources with a dynamic lifetime), for the object-based
+ *     renderers. Objects are identified by an ID in the range 0..maxNumObjects-1, and each
+ *     has a direction and a gain. The store is allocated once, for its maximum number of
+ *     objects, with the fields held in separate arrays indexed by ID, along with a list of
+ *     the IDs in use. The writers add, remove and update objects, and then publish the
+ *     changes; the readers (e.g. the audio thread) see consistent snapshots, via a parameter
+ *     block (see saf_threads.h). Each writer call takes the writer lock of the parameter
+ *     block, so writers may be on different threads. Neither side allocates memory.
+ * Dependencies:
+ *     saf_threads
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#ifndef SAF_OBJECTS_H_INCLUDED
+#define SAF_OBJECTS_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* snapshot of the objects, as seen by one reader */
+typedef struct _saf_objects_view {
+    int maxNumObjects;                  /* maximum number of objects (and the range of the IDs) */
+    int nObjects;                       /* number of objects */
+    const int* ids;                     /* IDs of the objects, in no particular order; nObjects x 1 */
+    const float (*dirs_deg)[2];         /* azimuth and elevation of each ID, in degrees; maxNumObjects x 2 */
+    const float* gains;                 /* linear gain of each ID; maxNumObjects x 1 */
+    const int* generations;             /* incremented whenever an ID is added, so that readers can tell a newly
+                                         * added object from the one that used the ID before; maxNumObjects x 1 */
+}saf_objects_view;
+
+/* creates an object store, without any objects */
+void saf_objects_create(void** const phObj,             /* & address of object store handle */
+                        int maxNumObjects,              /* maximum number of objects */
+                        int nReaders);                  /* number of (independent) reader threads */
+
+/* frees an object store */
+void saf_objects_destroy(void** const phObj);           /* & address of object store handle */
+
+/* returns the maximum number of objects */
+int saf_objects_getMaxNumObjects(void* const hObj);     /* object store handle */
+
+/* adds an object; returns 0 on success, or -1 if the ID is out of range or already in use. Writer thread only */
+int saf_objects_add(void* const hObj,                   /* object store handle */
+                    int id,                             /* object ID */
+                    float azi_deg,                      /* azimuth in degrees */
+                    float elev_deg,                     /* elevation in degrees */
+                    float gain);                        /* linear gain */
+
+/* removes an object; returns 0 on success, or -1 if the ID is not in use. Writer thread only */
+int saf_objects_remove(void* const hObj,                /* object store handle */
+                       int id);                         /* object ID */
+
+/* changes the direction and gain of an object; returns 0 on success, or -1 if the ID is not in use. Writer thread
+ * only */
+int saf_objects_update(void* const hObj,                /* object store handle */
+                       int id,                          /* object ID */
+                       float azi_deg,                   /* azimuth in degrees */
+                       float elev_deg,                  /* elevation in degrees */
+                       float gain);                     /* linear gain */
+
+/* returns the direction and gain of an object; returns 0 on success, or -1 if the ID is not in use. Includes changes
+ * that have not been published yet. Writer thread only */
+int saf_objects_get(void* const hObj,                   /* object store handle */
+                    int id,                             /* object ID */
+                    float* azi_deg,                     /* & azimuth in degrees */
+                    float* elev_deg,                    /* & elevation in degrees */
+                    float* gain);                       /* & linear gain */
+
+/* returns the number of objects, including changes that have not been published yet. Writer thread only */
+int saf_objects_getNumObjects(void* const hObj);        /* object store handle */
+
+/* makes all changes since the last call available to the readers. Writer thread only */
+void saf_objects_publish(void* const hObj);             /* object store handle */
+
+/* returns the most recently published objects for the given reader; the snapshot remains valid and unchanged until
+ * this reader calls "saf_objects_read" again. Lock-free; safe for the audio thread */
+void saf_objects_read(void* const hObj,                 /* object store handle */
+                      int readerIdx,                    /* reader index 0..nReaders-1 */
+                      saf_objects_view* view);          /* & snapshot */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SAF_OBJECTS_H_INCLUDED */
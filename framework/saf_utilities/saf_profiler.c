@@ -0,0 +1,197 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     saf_profiler.c
+ * Description:
+ *     Optional per-stage timing of the processing loops. Each stage (e.g. "afSTFTforward")
+ *     records its duration for every frame into a lock-free ring buffer, owned by the module
+ *     instance, and the min/mean/p99/max durations may then be queried from another thread.
+ *     The framework and the examples must be built with SAF_ENABLE_PROFILER defined;
+ *     otherwise, the profiler macros expand to nothing, and no profiler memory is allocated.
+ * Dependencies:
+ *     saf_threads
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include "saf_profiler.h"
+#include "saf_threads.h"
+#include "saf_malloc.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#ifdef _WIN32
+  #include <windows.h>
+#elif defined(__APPLE__)
+  #include <mach/mach_time.h>
+#else
+  #include <time.h>
+#endif
+
+typedef struct _saf_profiler_stage {
+    const char* name;
+    double start_us;                         /* time at which the stage was last begun */
+    float durations[SAF_PROFILER_RING_SIZE]; /* ring buffer of the most recent durations, in microseconds */
+    volatile int wIdx;                       /* next ring buffer index to write */
+    volatile int full;                       /* 1: the ring buffer has wrapped around at least once */
+
+}saf_profiler_stage;
+
+typedef struct _saf_profiler {
+    saf_profiler_stage stages[SAF_PROFILER_MAX_STAGES];
+    volatile int nStages;                    /* number of registered stages; published after their names */
+
+}saf_profiler;
+
+/* returns a monotonic time stamp in microseconds */
+static double saf_profiler_now_us(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (double)count.QuadPart * 1.0e6 / (double)freq.QuadPart;
+#elif defined(__APPLE__)
+    static mach_timebase_info_data_t tb;
+    if(tb.denom==0)
+        mach_timebase_info(&tb);
+    return (double)mach_absolute_time() * (double)tb.numer / ((double)tb.denom * 1.0e3);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1.0e6 + (double)ts.tv_nsec * 1.0e-3;
+#endif
+}
+
+/* returns the stage with this name, registering it if it is new; NULL if there is no room left */
+static saf_profiler_stage* saf_profiler_findStage(saf_profiler* prof, const char* name)
+{
+    int i, nStages;
+
+    nStages = prof->nStages; /* only the timing thread changes nStages */
+    for(i=0; i<nStages; i++)
+        if(prof->stages[i].name==name || strcmp(prof->stages[i].name, name)==0)
+            return &(prof->stages[i]);
+    if(nStages>=SAF_PROFILER_MAX_STAGES)
+        return NULL;
+    prof->stages[nStages].name = name;
+    saf_atomic_storei(&(prof->nStages), nStages+1);
+    return &(prof->stages[nStages]);
+}
+
+static int saf_profiler_cmpf(const void* a, const void* b)
+{
+    float fa = *(const float*)a, fb = *(const float*)b;
+    return (fa > fb) - (fa < fb);
+}
+
+void saf_profiler_create(void** const phProf)
+{
+#ifdef SAF_ENABLE_PROFILER
+    saf_profiler* prof = (saf_profiler*)calloc(1, sizeof(saf_profiler));
+    *phProf = (void*)prof;
+#else
+    *phProf = NULL;
+#endif
+}
+
+void saf_profiler_destroy(void** const phProf)
+{
+    saf_profiler* prof = (saf_profiler*)(*phProf);
+
+    if(prof!=NULL){
+        free(prof);
+        prof = NULL;
+        *phProf = NULL;
+    }
+}
+
+void saf_profiler_begin(void* const hProf, const char* name)
+{
+    saf_profiler* prof = (saf_profiler*)hProf;
+    saf_profiler_stage* stage;
+
+    if(prof==NULL)
+        return;
+    stage = saf_profiler_findStage(prof, name);
+    if(stage!=NULL)
+        stage->start_us = saf_profiler_now_us();
+}
+
+void saf_profiler_end(void* const hProf, const char* name)
+{
+    saf_profiler* prof = (saf_profiler*)hProf;
+    saf_profiler_stage* stage;
+    double end_us;
+    int w;
+
+    if(prof==NULL)
+        return;
+    end_us = saf_profiler_now_us();
+    stage = saf_profiler_findStage(prof, name);
+    if(stage==NULL)
+        return;
+    w = stage->wIdx;
+    stage->durations[w] = (float)(end_us - stage->start_us);
+    if(w+1 == SAF_PROFILER_RING_SIZE){
+        saf_atomic_storei(&(stage->full), 1);
+        saf_atomic_storei(&(stage->wIdx), 0);
+    }
+    else
+        saf_atomic_storei(&(stage->wIdx), w+1);
+}
+
+void saf_profiler_getStats
+(
+    void* const hProf,
+    saf_profiler_stats* stats,
+    int maxNStages,
+    int* nStages
+)
+{
+    saf_profiler* prof = (saf_profiler*)hProf;
+    float sorted[SAF_PROFILER_RING_SIZE];
+    double sum;
+    int i, j, n;
+
+    (*nStages) = 0;
+    if(prof==NULL)
+        return;
+    (*nStages) = saf_atomic_loadi(&(prof->nStages));
+    (*nStages) = (*nStages) < maxNStages ? (*nStages) : maxNStages;
+    for(i=0; i<(*nStages); i++){
+        saf_profiler_stage* stage = &(prof->stages[i]);
+
+        /* take a copy of the durations written so far, and sort it */
+        n = saf_atomic_loadi(&(stage->full)) ? SAF_PROFILER_RING_SIZE : saf_atomic_loadi(&(stage->wIdx));
+        memcpy(sorted, stage->durations, n*sizeof(float));
+        qsort(sorted, n, sizeof(float), saf_profiler_cmpf);
+
+        stats[i].name = stage->name;
+        stats[i].nFrames = n;
+        if(n==0){
+            stats[i].min_us = stats[i].mean_us = stats[i].p99_us = stats[i].max_us = 0.0f;
+            continue;
+        }
+        sum = 0.0;
+        for(j=0; j<n; j++)
+            sum += (double)sorted[j];
+        stats[i].min_us = sorted[0];
+        stats[i].mean_us = (float)(sum/(double)n);
+        stats[i].p99_us = sorted[(int)ceil(0.99*(double)n)-1];
+        stats[i].max_us = sorted[n-1];
+    }
+}
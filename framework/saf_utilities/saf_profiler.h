@@ -0,0 +1,87 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     saf_profiler.h
+ * Description:
+ *     Optional per-stage timing of the processing loops. Each stage (e.g. "afSTFTforward")
+ *     records its duration for every frame into a lock-free ring buffer, owned by the module
+ *     instance, and the min/mean/p99/max durations may then be queried from another thread.
+ *     The framework and the examples must be built with SAF_ENABLE_PROFILER defined;
+ *     otherwise, the profiler macros expand to nothing, and no profiler memory is allocated.
+ * Dependencies:
+ *     saf_threads
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#ifndef SAF_PROFILER_H_INCLUDED
+#define SAF_PROFILER_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SAF_PROFILER_MAX_STAGES ( 16 )   /* maximum number of stages per profiler */
+#define SAF_PROFILER_RING_SIZE ( 512 )   /* number of (most recent) durations kept per stage */
+
+/* statistics of one stage, in microseconds, over the durations currently held in its ring buffer */
+typedef struct _saf_profiler_stats {
+    const char* name;                    /* stage name, as passed to SAF_PROFILE_BEGIN */
+    int nFrames;                         /* number of durations the statistics are based on */
+    float min_us;                        /* shortest duration */
+    float mean_us;                       /* mean duration */
+    float p99_us;                        /* 99th percentile */
+    float max_us;                        /* longest duration */
+}saf_profiler_stats;
+
+/* Stages are delimited with SAF_PROFILE_BEGIN(hProf, "name") and SAF_PROFILE_END(hProf, "name"), with the same name
+ * (a string literal) in both. Stages are registered on first use; they may be nested, but a stage must not be
+ * begun again before it is ended. Timing is lock-free and does not allocate, so it is safe for the audio thread */
+#ifdef SAF_ENABLE_PROFILER
+# define SAF_PROFILE_BEGIN(hProf, name) saf_profiler_begin(hProf, name)
+# define SAF_PROFILE_END(hProf, name) saf_profiler_end(hProf, name)
+#else
+# define SAF_PROFILE_BEGIN(hProf, name)
+# define SAF_PROFILE_END(hProf, name)
+#endif
+
+/* creates a profiler; *phProf is set to NULL if the framework was built without SAF_ENABLE_PROFILER */
+void saf_profiler_create(void** const phProf);          /* & address of profiler handle */
+
+/* frees a profiler */
+void saf_profiler_destroy(void** const phProf);         /* & address of profiler handle */
+
+/* starts timing a stage (use SAF_PROFILE_BEGIN instead). One thread only */
+void saf_profiler_begin(void* const hProf,              /* profiler handle (NULL: does nothing) */
+                        const char* name);              /* stage name */
+
+/* stops timing a stage, and records its duration (use SAF_PROFILE_END instead). One thread only */
+void saf_profiler_end(void* const hProf,                /* profiler handle (NULL: does nothing) */
+                      const char* name);                /* stage name */
+
+/* returns the statistics of all stages, in the order they were first used. May be called from any thread, while
+ * the stages are being timed; a duration that is being overwritten whilst it is read only skews the statistics */
+void saf_profiler_getStats(void* const hProf,           /* profiler handle (NULL: no stages) */
+                           saf_profiler_stats* stats,   /* statistics per stage; maxNStages x 1 */
+                           int maxNStages,              /* size of "stats" */
+                           int* nStages);               /* & number of stages written to "stats" */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SAF_PROFILER_H_INCLUDED */
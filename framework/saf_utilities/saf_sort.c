@@ -29,6 +29,7 @@
 
 #include "saf_sort.h"
 #include "saf_complex.h" /* TODO: add sort complex numbers, abs/real */
+#include "saf_malloc.h" /* for the real-time allocation check */
 
 typedef struct saf_sort_int {
     int val;
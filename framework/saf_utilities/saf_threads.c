@@ -0,0 +1,692 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     saf_threads.c
+ * Description:
+ *     Cross-platform atomic operations, triple-buffered parameter blocks, a simple worker
+ *     thread, which may be used to carry out expensive (re)initialisations away from the audio
+ *     thread, and a work-stealing thread pool for spreading independent tasks over several
+ *     cores. The atomic operations and parameter block reads are lock-free and may be called
+ *     from the audio thread; the worker thread functions may not.
+ * Dependencies:
+ *     Windows: Win32 threads (Vista or newer), otherwise: pthreads
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+  #define _GNU_SOURCE /* for pthread_setaffinity_np */
+#endif
+#include "saf_threads.h"
+#include "saf_veclib.h" /* for utility_blasThreadsBegin */
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <pthread.h>
+  #include <unistd.h>
+  #ifdef __linux__
+    #include <sched.h>
+  #endif
+#endif
+
+/*********************/
+/* Atomic operations */
+/*********************/
+
+#if defined(_MSC_VER)
+
+int saf_atomic_loadi(volatile int* ptr)                        { return (int)InterlockedCompareExchange((volatile LONG*)ptr, 0, 0); }
+void saf_atomic_storei(volatile int* ptr, int val)             { InterlockedExchange((volatile LONG*)ptr, (LONG)val); }
+int saf_atomic_exchangei(volatile int* ptr, int val)           { return (int)InterlockedExchange((volatile LONG*)ptr, (LONG)val); }
+int saf_atomic_casi(volatile int* ptr, int expected, int desired)
+{
+    return InterlockedCompareExchange((volatile LONG*)ptr, (LONG)desired, (LONG)expected) == (LONG)expected;
+}
+int saf_atomic_fetch_addi(volatile int* ptr, int val)          { return (int)InterlockedExchangeAdd((volatile LONG*)ptr, (LONG)val); }
+void* saf_atomic_loadp(void* volatile* ptr)                    { return InterlockedCompareExchangePointer(ptr, NULL, NULL); }
+void saf_atomic_storep(void* volatile* ptr, void* val)         { InterlockedExchangePointer(ptr, val); }
+void* saf_atomic_exchangep(void* volatile* ptr, void* val)     { return InterlockedExchangePointer(ptr, val); }
+int saf_atomic_casp(void* volatile* ptr, void* expected, void* desired)
+{
+    return InterlockedCompareExchangePointer(ptr, desired, expected) == expected;
+}
+
+#else /* GCC, Clang and ICC */
+
+int saf_atomic_loadi(volatile int* ptr)                        { return __atomic_load_n(ptr, __ATOMIC_SEQ_CST); }
+void saf_atomic_storei(volatile int* ptr, int val)             { __atomic_store_n(ptr, val, __ATOMIC_SEQ_CST); }
+int saf_atomic_exchangei(volatile int* ptr, int val)           { return __atomic_exchange_n(ptr, val, __ATOMIC_SEQ_CST); }
+int saf_atomic_casi(volatile int* ptr, int expected, int desired)
+{
+    return __atomic_compare_exchange_n(ptr, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+int saf_atomic_fetch_addi(volatile int* ptr, int val)          { return __atomic_fetch_add(ptr, val, __ATOMIC_SEQ_CST); }
+void* saf_atomic_loadp(void* volatile* ptr)                    { return __atomic_load_n(ptr, __ATOMIC_SEQ_CST); }
+void saf_atomic_storep(void* volatile* ptr, void* val)         { __atomic_store_n(ptr, val, __ATOMIC_SEQ_CST); }
+void* saf_atomic_exchangep(void* volatile* ptr, void* val)     { return __atomic_exchange_n(ptr, val, __ATOMIC_SEQ_CST); }
+int saf_atomic_casp(void* volatile* ptr, void* expected, void* desired)
+{
+    return __atomic_compare_exchange_n(ptr, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+#endif
+
+
+/***********/
+/* Locking */
+/***********/
+
+#ifdef _WIN32
+typedef SRWLOCK saf_mutex;
+typedef CONDITION_VARIABLE saf_cond;
+#define SAF_MUTEX_INIT(m)       InitializeSRWLock(m)
+#define SAF_MUTEX_DESTROY(m)
+#define SAF_MUTEX_LOCK(m)       AcquireSRWLockExclusive(m)
+#define SAF_MUTEX_UNLOCK(m)     ReleaseSRWLockExclusive(m)
+#define SAF_COND_INIT(c)        InitializeConditionVariable(c)
+#define SAF_COND_DESTROY(c)
+#define SAF_COND_WAIT(c, m)     SleepConditionVariableSRW(c, m, INFINITE, 0)
+#define SAF_COND_BROADCAST(c)   WakeAllConditionVariable(c)
+#else
+typedef pthread_mutex_t saf_mutex;
+typedef pthread_cond_t saf_cond;
+#define SAF_MUTEX_INIT(m)       pthread_mutex_init(m, NULL)
+#define SAF_MUTEX_DESTROY(m)    pthread_mutex_destroy(m)
+#define SAF_MUTEX_LOCK(m)       pthread_mutex_lock(m)
+#define SAF_MUTEX_UNLOCK(m)     pthread_mutex_unlock(m)
+#define SAF_COND_INIT(c)        pthread_cond_init(c, NULL)
+#define SAF_COND_DESTROY(c)     pthread_cond_destroy(c)
+#define SAF_COND_WAIT(c, m)     pthread_cond_wait(c, m)
+#define SAF_COND_BROADCAST(c)   pthread_cond_broadcast(c)
+#endif
+
+
+/*******************/
+/* Parameter block */
+/*******************/
+
+#define PB_NEW_DATA ( 4 ) /* set in "middle" when it holds data the reader has not yet picked up */
+
+typedef struct _saf_pb_reader
+{
+    void* slots[3];
+    int back;            /* slot owned by the writer */
+    int front;           /* slot owned by the reader */
+    volatile int middle; /* slot being exchanged (| PB_NEW_DATA) */
+    
+}saf_pb_reader;
+
+typedef struct _saf_paramBlock
+{
+    size_t size;
+    saf_mutex writerLock;/* serialises the writers; held from "edit" until "publish"/"release" */
+    void* working;       /* the writer's working copy */
+    int nReaders;
+    saf_pb_reader* readers;
+    
+}saf_paramBlock;
+
+void saf_paramBlock_create
+(
+    void** const phPB,
+    size_t size,
+    int nReaders
+)
+{
+    saf_paramBlock* pb = (saf_paramBlock*)malloc(sizeof(saf_paramBlock));
+    int r, i;
+    
+    *phPB = (void*)pb;
+    if(pb == NULL) { return;/*error*/ }
+    pb->size = size;
+    SAF_MUTEX_INIT(&(pb->writerLock));
+    pb->working = calloc(1, size);
+    pb->nReaders = nReaders;
+    pb->readers = (saf_pb_reader*)malloc(nReaders*sizeof(saf_pb_reader));
+    for(r=0; r<nReaders; r++){
+        for(i=0; i<3; i++)
+            pb->readers[r].slots[i] = calloc(1, size);
+        pb->readers[r].back = 0;
+        pb->readers[r].middle = 1;
+        pb->readers[r].front = 2;
+    }
+}
+
+void saf_paramBlock_destroy
+(
+    void** const phPB
+)
+{
+    saf_paramBlock* pb = (saf_paramBlock*)(*phPB);
+    int r, i;
+    
+    if(pb != NULL){
+        for(r=0; r<pb->nReaders; r++)
+            for(i=0; i<3; i++)
+                free(pb->readers[r].slots[i]);
+        free(pb->readers);
+        free(pb->working);
+        SAF_MUTEX_DESTROY(&(pb->writerLock));
+        free(pb);
+        *phPB = NULL;
+    }
+}
+
+void* saf_paramBlock_edit(void* const hPB)
+{
+    saf_paramBlock* pb = (saf_paramBlock*)hPB;
+    SAF_MUTEX_LOCK(&(pb->writerLock));
+    return pb->working;
+}
+
+const void* saf_paramBlock_peek(void* const hPB)
+{
+    saf_paramBlock* pb = (saf_paramBlock*)hPB;
+    return pb->working;
+}
+
+void saf_paramBlock_release(void* const hPB)
+{
+    saf_paramBlock* pb = (saf_paramBlock*)hPB;
+    SAF_MUTEX_UNLOCK(&(pb->writerLock));
+}
+
+void saf_paramBlock_publish(void* const hPB)
+{
+    saf_paramBlock* pb = (saf_paramBlock*)hPB;
+    saf_pb_reader* rd;
+    int r;
+    
+    /* the writer lock is held since "saf_paramBlock_edit"; so "working" and "back" have only one writer */
+    for(r=0; r<pb->nReaders; r++){
+        rd = &(pb->readers[r]);
+        memcpy(rd->slots[rd->back], pb->working, pb->size);
+        /* swap the filled back buffer with the middle one (which the reader may or may not have picked up yet) */
+        rd->back = saf_atomic_exchangei(&(rd->middle), rd->back | PB_NEW_DATA) & ~PB_NEW_DATA;
+    }
+    SAF_MUTEX_UNLOCK(&(pb->writerLock));
+}
+
+const void* saf_paramBlock_read(void* const hPB, int readerIdx)
+{
+    saf_paramBlock* pb = (saf_paramBlock*)hPB;
+    saf_pb_reader* rd = &(pb->readers[readerIdx]);
+    
+    /* swap the front buffer with the middle one, if it holds newer data */
+    if(saf_atomic_loadi(&(rd->middle)) & PB_NEW_DATA)
+        rd->front = saf_atomic_exchangei(&(rd->middle), rd->front) & ~PB_NEW_DATA;
+    return rd->slots[rd->front];
+}
+
+
+/*****************/
+/* Worker thread */
+/*****************/
+
+typedef struct _saf_worker
+{
+#ifdef _WIN32
+    HANDLE thread;
+#else
+    pthread_t thread;
+#endif
+    saf_mutex lock;
+    saf_cond cond;       /* signalled whenever any of the flags below change */
+    saf_worker_job job;
+    void* arg;
+    int pending;         /* 1: job requested but not yet started */
+    int running;         /* 1: job currently running */
+    int quit;            /* 1: thread should exit */
+
+}saf_worker;
+
+#ifdef _WIN32
+static DWORD WINAPI saf_worker_main(LPVOID hWorker)
+#else
+static void* saf_worker_main(void* hWorker)
+#endif
+{
+    saf_worker* w = (saf_worker*)hWorker;
+
+    SAF_MUTEX_LOCK(&(w->lock));
+    for(;;){
+        while(!w->pending && !w->quit)
+            SAF_COND_WAIT(&(w->cond), &(w->lock));
+        if(w->quit)
+            break;
+        w->pending = 0;
+        w->running = 1;
+        SAF_MUTEX_UNLOCK(&(w->lock));
+        w->job(w->arg);
+        SAF_MUTEX_LOCK(&(w->lock));
+        w->running = 0;
+        SAF_COND_BROADCAST(&(w->cond)); /* wake up saf_worker_wait() */
+    }
+    SAF_MUTEX_UNLOCK(&(w->lock));
+    return 0;
+}
+
+void saf_worker_create
+(
+    void** const phWorker,
+    saf_worker_job job,
+    void* arg
+)
+{
+    saf_worker* w = (saf_worker*)malloc(sizeof(saf_worker));
+    *phWorker = NULL;
+    if(w == NULL) { return;/*error*/ }
+    w->job = job;
+    w->arg = arg;
+    w->pending = w->running = w->quit = 0;
+    SAF_MUTEX_INIT(&(w->lock));
+    SAF_COND_INIT(&(w->cond));
+#ifdef _WIN32
+    w->thread = CreateThread(NULL, 0, saf_worker_main, (LPVOID)w, 0, NULL);
+    if(w->thread == NULL){
+#else
+    if(pthread_create(&(w->thread), NULL, saf_worker_main, (void*)w) != 0){
+#endif
+        SAF_COND_DESTROY(&(w->cond));
+        SAF_MUTEX_DESTROY(&(w->lock));
+        free(w);
+        return;/*error*/
+    }
+    *phWorker = (void*)w;
+}
+
+void saf_worker_destroy
+(
+    void** const phWorker
+)
+{
+    saf_worker* w = (saf_worker*)(*phWorker);
+
+    if(w != NULL){
+        SAF_MUTEX_LOCK(&(w->lock));
+        w->quit = 1;
+        SAF_COND_BROADCAST(&(w->cond));
+        SAF_MUTEX_UNLOCK(&(w->lock));
+#ifdef _WIN32
+        WaitForSingleObject(w->thread, INFINITE);
+        CloseHandle(w->thread);
+#else
+        pthread_join(w->thread, NULL);
+#endif
+        SAF_COND_DESTROY(&(w->cond));
+        SAF_MUTEX_DESTROY(&(w->lock));
+        free(w);
+        *phWorker = NULL;
+    }
+}
+
+void saf_worker_post(void* const hWorker)
+{
+    saf_worker* w = (saf_worker*)hWorker;
+
+    if(w == NULL)
+        return;
+    SAF_MUTEX_LOCK(&(w->lock));
+    w->pending = 1;
+    SAF_COND_BROADCAST(&(w->cond));
+    SAF_MUTEX_UNLOCK(&(w->lock));
+}
+
+void saf_worker_wait(void* const hWorker)
+{
+    saf_worker* w = (saf_worker*)hWorker;
+
+    if(w == NULL)
+        return;
+    SAF_MUTEX_LOCK(&(w->lock));
+    while((w->pending || w->running) && !w->quit)
+        SAF_COND_WAIT(&(w->cond), &(w->lock));
+    SAF_MUTEX_UNLOCK(&(w->lock));
+}
+
+int saf_worker_isBusy(void* const hWorker)
+{
+    saf_worker* w = (saf_worker*)hWorker;
+    int busy;
+
+    if(w == NULL)
+        return 0;
+    SAF_MUTEX_LOCK(&(w->lock));
+    busy = w->pending || w->running;
+    SAF_MUTEX_UNLOCK(&(w->lock));
+    return busy;
+}
+
+
+/***************/
+/* Thread pool */
+/***************/
+
+/* The task indices still to be carried out by a thread are held as one integer, [first last) = [range>>16, range&0xFFFF),
+ * so that the owner (taking from the front) and the thieves (taking the back half) can update them with a single CAS */
+#define SAF_POOL_MAX_NUM_TASKS ( 0x7FFF )
+#define SAF_POOL_RANGE(first, last) ( ((first)<<16) | (last) )
+#define SAF_POOL_FIRST(range) ( (range)>>16 )
+#define SAF_POOL_LAST(range) ( (range)&0xFFFF )
+
+/* number of times an idle thread polls for the next run (or the caller for the end of a run) before going to sleep;
+ * a few tens of microseconds, which covers the gaps between the stages of one "_process" call */
+#define SAF_POOL_NUM_SPINS ( 4000 )
+
+#if defined(_MSC_VER)
+  #define SAF_CPU_RELAX() YieldProcessor()
+#elif defined(__i386__) || defined(__x86_64__)
+  #define SAF_CPU_RELAX() __builtin_ia32_pause()
+#elif defined(__aarch64__)
+  #define SAF_CPU_RELAX() __asm__ __volatile__("yield")
+#else
+  #define SAF_CPU_RELAX()
+#endif
+
+struct _saf_pool;
+
+typedef struct _saf_pool_thread
+{
+    volatile int range;  /* task indices left to this thread */
+    char pad[64-sizeof(int)]; /* keep the ranges of different threads on different cache lines */
+#ifdef _WIN32
+    HANDLE thread;
+#else
+    pthread_t thread;
+#endif
+    struct _saf_pool* pool;
+    int index;
+    int core;            /* CPU core the thread is pinned to; -1: not pinned */
+
+}saf_pool_thread;
+
+typedef struct _saf_pool
+{
+    int nThreads;        /* number of worker threads */
+    int nSpins;          /* number of polls before going to sleep (none on a single core, where it would only delay the others) */
+    saf_pool_thread* threads; /* nThreads + 1; the last one is the calling thread of "saf_pool_run" */
+    saf_mutex lock;
+    saf_cond start;      /* signalled when a run starts, or the threads should exit */
+    saf_cond done;       /* signalled when the last worker thread has finished its part of a run */
+    volatile int generation; /* incremented for each run */
+    volatile int nBusy;  /* number of worker threads still taking part in the current run */
+    volatile int nParked; /* number of worker threads asleep on "start" */
+    volatile int joinParked; /* 1: the caller is asleep on "done" */
+    volatile int inUse;  /* 1: a run is in progress */
+    volatile int quit;   /* 1: threads should exit */
+    saf_pool_task task;  /* current run */
+    void* arg;
+    int taskOffset;      /* added to the task indices of the current run (for runs of more than SAF_POOL_MAX_NUM_TASKS) */
+
+}saf_pool;
+
+/* returns the number of CPU cores */
+static int saf_pool_getNumCores(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long nCores = sysconf(_SC_NPROCESSORS_ONLN);
+    return nCores > 0 ? (int)nCores : 1;
+#endif
+}
+
+/* pins the calling thread to a CPU core (modulo the number of cores); not supported on macOS */
+static void saf_pool_pin(int core)
+{
+#if defined(_WIN32)
+    SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << (core % saf_pool_getNumCores()));
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % saf_pool_getNumCores(), &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set);
+#else
+    (void)core;
+#endif
+}
+
+/* takes the next task index from the front of a thread's own range; returns 0 if it is empty */
+static int saf_pool_take(saf_pool_thread* self, int* taskIdx)
+{
+    int range;
+
+    for(;;){
+        range = saf_atomic_loadi(&(self->range));
+        if(SAF_POOL_FIRST(range) >= SAF_POOL_LAST(range))
+            return 0;
+        if(saf_atomic_casi(&(self->range), range, SAF_POOL_RANGE(SAF_POOL_FIRST(range)+1, SAF_POOL_LAST(range)))){
+            *taskIdx = SAF_POOL_FIRST(range);
+            return 1;
+        }
+    }
+}
+
+/* moves the back half of the range of another thread into a thread's own (empty) range; returns 0 if there was
+ * nothing left to steal */
+static int saf_pool_steal(saf_pool_thread* self)
+{
+    saf_pool* pool = self->pool;
+    saf_pool_thread* victim;
+    int i, range, first, last, split;
+
+    for(i=1; i<=pool->nThreads; i++){
+        victim = &(pool->threads[(self->index+i) % (pool->nThreads+1)]);
+        for(;;){
+            range = saf_atomic_loadi(&(victim->range));
+            first = SAF_POOL_FIRST(range);
+            last = SAF_POOL_LAST(range);
+            if(first >= last)
+                break;
+            split = last - (last-first+1)/2;
+            if(saf_atomic_casi(&(victim->range), range, SAF_POOL_RANGE(first, split))){
+                saf_atomic_storei(&(self->range), SAF_POOL_RANGE(split, last));
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/* carries out tasks until none are left in any range */
+static void saf_pool_work(saf_pool_thread* self)
+{
+    saf_pool* pool = self->pool;
+    int taskIdx;
+
+    do{
+        while(saf_pool_take(self, &taskIdx))
+            pool->task(pool->arg, pool->taskOffset + taskIdx);
+    } while(saf_pool_steal(self));
+}
+
+#ifdef _WIN32
+static DWORD WINAPI saf_pool_main(LPVOID hThread)
+#else
+static void* saf_pool_main(void* hThread)
+#endif
+{
+    saf_pool_thread* self = (saf_pool_thread*)hThread;
+    saf_pool* pool = self->pool;
+    int i, generation;
+
+    if(self->core >= 0)
+        saf_pool_pin(self->core);
+    utility_blasThreadsBegin(); /* tasks run BLAS on this thread only; never ended */
+    generation = saf_atomic_loadi(&(pool->generation));
+    for(;;){
+        /* spin for a while, then sleep until the next run. "nParked" is raised before "generation" is checked (and
+         * "generation" is raised before "nParked" is checked by "saf_pool_run"), so a wake-up cannot be missed */
+        for(i=0; i<pool->nSpins && saf_atomic_loadi(&(pool->generation)) == generation; i++)
+            SAF_CPU_RELAX();
+        if(saf_atomic_loadi(&(pool->generation)) == generation){
+            SAF_MUTEX_LOCK(&(pool->lock));
+            saf_atomic_fetch_addi(&(pool->nParked), 1);
+            while(saf_atomic_loadi(&(pool->generation)) == generation)
+                SAF_COND_WAIT(&(pool->start), &(pool->lock));
+            saf_atomic_fetch_addi(&(pool->nParked), -1);
+            SAF_MUTEX_UNLOCK(&(pool->lock));
+        }
+        generation = saf_atomic_loadi(&(pool->generation));
+        if(saf_atomic_loadi(&(pool->quit)))
+            break;
+        saf_pool_work(self);
+        if(saf_atomic_fetch_addi(&(pool->nBusy), -1) == 1 && saf_atomic_loadi(&(pool->joinParked))){
+            SAF_MUTEX_LOCK(&(pool->lock));
+            SAF_COND_BROADCAST(&(pool->done));
+            SAF_MUTEX_UNLOCK(&(pool->lock));
+        }
+    }
+    return 0;
+}
+
+void saf_pool_create
+(
+    void** const phPool,
+    int nThreads
+)
+{
+    saf_pool_createPinned(phPool, nThreads, -1);
+}
+
+void saf_pool_createPinned
+(
+    void** const phPool,
+    int nThreads,
+    int firstCore
+)
+{
+    saf_pool* pool = (saf_pool*)malloc(sizeof(saf_pool));
+    int i;
+
+    *phPool = (void*)pool;
+    if(pool == NULL) { return;/*error*/ }
+    nThreads = nThreads > 0 ? nThreads : 0;
+    pool->threads = (saf_pool_thread*)calloc(nThreads+1, sizeof(saf_pool_thread));
+    pool->nSpins = saf_pool_getNumCores() > 1 ? SAF_POOL_NUM_SPINS : 0;
+    pool->generation = pool->nBusy = pool->nParked = pool->joinParked = pool->inUse = pool->quit = 0;
+    pool->task = NULL;
+    pool->arg = NULL;
+    pool->taskOffset = 0;
+    SAF_MUTEX_INIT(&(pool->lock));
+    SAF_COND_INIT(&(pool->start));
+    SAF_COND_INIT(&(pool->done));
+    for(i=0; i<=nThreads; i++){
+        pool->threads[i].pool = pool;
+        pool->threads[i].index = i;
+        pool->threads[i].core = firstCore >= 0 && i < nThreads ? firstCore + i : -1;
+    }
+    for(pool->nThreads=0; pool->nThreads<nThreads; pool->nThreads++){
+#ifdef _WIN32
+        pool->threads[pool->nThreads].thread = CreateThread(NULL, 0, saf_pool_main, (LPVOID)&(pool->threads[pool->nThreads]), 0, NULL);
+        if(pool->threads[pool->nThreads].thread == NULL)
+#else
+        if(pthread_create(&(pool->threads[pool->nThreads].thread), NULL, saf_pool_main, (void*)&(pool->threads[pool->nThreads])) != 0)
+#endif
+            break; /* carry on with the threads created so far; the calling thread then takes the next slot */
+    }
+    pool->threads[pool->nThreads].core = -1; /* (the calling thread of "saf_pool_run" is never pinned) */
+}
+
+void saf_pool_destroy
+(
+    void** const phPool
+)
+{
+    saf_pool* pool = (saf_pool*)(*phPool);
+    int i;
+
+    if(pool != NULL){
+        saf_atomic_storei(&(pool->quit), 1);
+        SAF_MUTEX_LOCK(&(pool->lock));
+        saf_atomic_fetch_addi(&(pool->generation), 1);
+        SAF_COND_BROADCAST(&(pool->start));
+        SAF_MUTEX_UNLOCK(&(pool->lock));
+        for(i=0; i<pool->nThreads; i++){
+#ifdef _WIN32
+            WaitForSingleObject(pool->threads[i].thread, INFINITE);
+            CloseHandle(pool->threads[i].thread);
+#else
+            pthread_join(pool->threads[i].thread, NULL);
+#endif
+        }
+        SAF_COND_DESTROY(&(pool->done));
+        SAF_COND_DESTROY(&(pool->start));
+        SAF_MUTEX_DESTROY(&(pool->lock));
+        free(pool->threads);
+        free(pool);
+        *phPool = NULL;
+    }
+}
+
+void saf_pool_run
+(
+    void* const hPool,
+    saf_pool_task task,
+    void* arg,
+    int nTasks
+)
+{
+    saf_pool* pool = (saf_pool*)hPool;
+    int i, offset, n, nThreads;
+
+    /* no worker threads, nothing to share, or the pool is busy with another caller's run: use this thread alone */
+    if(pool == NULL || pool->nThreads == 0 || nTasks < 2 || !saf_atomic_casi(&(pool->inUse), 0, 1)){
+        for(i=0; i<nTasks; i++)
+            task(arg, i);
+        return;
+    }
+    nThreads = pool->nThreads+1;
+    for(offset=0; offset<nTasks; offset+=SAF_POOL_MAX_NUM_TASKS){
+        n = nTasks-offset < SAF_POOL_MAX_NUM_TASKS ? nTasks-offset : SAF_POOL_MAX_NUM_TASKS;
+        pool->task = task;
+        pool->arg = arg;
+        pool->taskOffset = offset;
+        /* hand each thread an equal share; the workers only start once all shares are in place */
+        for(i=0; i<nThreads; i++)
+            saf_atomic_storei(&(pool->threads[i].range), SAF_POOL_RANGE((i*n)/nThreads, ((i+1)*n)/nThreads));
+        saf_atomic_storei(&(pool->nBusy), pool->nThreads);
+        saf_atomic_fetch_addi(&(pool->generation), 1);
+        if(saf_atomic_loadi(&(pool->nParked)) > 0){
+            SAF_MUTEX_LOCK(&(pool->lock));
+            SAF_COND_BROADCAST(&(pool->start));
+            SAF_MUTEX_UNLOCK(&(pool->lock));
+        }
+        saf_pool_work(&(pool->threads[pool->nThreads]));
+        /* join (spinning first, then sleeping); no task may still be running when this returns */
+        for(i=0; i<pool->nSpins && saf_atomic_loadi(&(pool->nBusy)) > 0; i++)
+            SAF_CPU_RELAX();
+        if(saf_atomic_loadi(&(pool->nBusy)) > 0){
+            SAF_MUTEX_LOCK(&(pool->lock));
+            saf_atomic_storei(&(pool->joinParked), 1);
+            while(saf_atomic_loadi(&(pool->nBusy)) > 0)
+                SAF_COND_WAIT(&(pool->done), &(pool->lock));
+            saf_atomic_storei(&(pool->joinParked), 0);
+            SAF_MUTEX_UNLOCK(&(pool->lock));
+        }
+    }
+    saf_atomic_storei(&(pool->inUse), 0);
+}
+
+int saf_pool_getNumThreads(void* const hPool)
+{
+    saf_pool* pool = (saf_pool*)hPool;
+    return pool == NULL ? 0 : pool->nThreads;
+}
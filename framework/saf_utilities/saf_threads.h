@@ -0,0 +1,200 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     saf_threads.h
+ * Description:
+ *     Cross-platform atomic operations, triple-buffered parameter blocks, a simple worker
+ *     thread, which may be used to carry out expensive (re)initialisations away from the audio
+ *     thread, and a work-stealing thread pool for spreading independent tasks over several
+ *     cores. The atomic operations and parameter block reads are lock-free and may be called
+ *     from the audio thread; the worker thread functions may not.
+ * Dependencies:
+ *     Windows: Win32 threads (Vista or newer), otherwise: pthreads
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#ifndef SAF_THREADS_H_INCLUDED
+#define SAF_THREADS_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    
+#include <stddef.h>
+
+/* storage class of per-thread static variables */
+#ifdef _MSC_VER
+# define SAF_THREAD_LOCAL __declspec(thread)
+#else
+# define SAF_THREAD_LOCAL __thread
+#endif
+
+/*********************/
+/* Atomic operations */
+/*********************/
+
+/* All of the following are sequentially consistent. */
+
+/* atomically loads an integer */
+int saf_atomic_loadi(volatile int* ptr);                 /* integer to load */
+
+/* atomically stores an integer */
+void saf_atomic_storei(volatile int* ptr,                /* integer to overwrite */
+                       int val);                         /* new value */
+
+/* atomically replaces an integer, returning its previous value */
+int saf_atomic_exchangei(volatile int* ptr,              /* integer to overwrite */
+                         int val);                       /* new value */
+
+/* atomically replaces an integer only if it is equal to "expected"; returns 1 if it was replaced, 0 otherwise */
+int saf_atomic_casi(volatile int* ptr,                   /* integer to overwrite */
+                    int expected,                        /* value it must currently have */
+                    int desired);                        /* new value */
+
+/* atomically adds "val" to an integer, returning its previous value */
+int saf_atomic_fetch_addi(volatile int* ptr,             /* integer to increment */
+                          int val);                      /* value to add */
+
+/* atomically loads a pointer */
+void* saf_atomic_loadp(void* volatile* ptr);             /* pointer to load */
+
+/* atomically stores a pointer */
+void saf_atomic_storep(void* volatile* ptr,              /* pointer to overwrite */
+                       void* val);                       /* new value */
+
+/* atomically replaces a pointer, returning its previous value */
+void* saf_atomic_exchangep(void* volatile* ptr,          /* pointer to overwrite */
+                           void* val);                   /* new value */
+
+/* atomically replaces a pointer only if it is equal to "expected"; returns 1 if it was replaced, 0 otherwise */
+int saf_atomic_casp(void* volatile* ptr,                 /* pointer to overwrite */
+                    void* expected,                      /* value it must currently have */
+                    void* desired);                      /* new value */
+
+
+/*******************/
+/* Parameter block */
+/*******************/
+
+/* A parameter block holds a copy of a module's user parameters (any plain struct without pointers). A writer (e.g. the
+ * GUI/message thread, or a host automation thread) edits the working copy and publishes it; each reader (e.g. the audio
+ * thread) then picks up a consistent snapshot whenever it wants one. Every reader has its own set of three buffers,
+ * so reads are wait-free, never see a half-written update, and the buffer a reader holds is never overwritten.
+ * The triple buffers themselves only support a single writer at a time. Therefore, "saf_paramBlock_edit" takes a
+ * writer lock, which is held until the matching "saf_paramBlock_publish" or "saf_paramBlock_release"; writers on
+ * different threads may block each other, whereas the readers never take the lock. An edit must not be nested in
+ * another edit of the same parameter block, on the same thread */
+
+/* creates a parameter block; the working copy and all snapshots are zero initialised */
+void saf_paramBlock_create(void** const phPB,            /* & address of parameter block handle */
+                           size_t size,                  /* size of the parameter struct in bytes */
+                           int nReaders);                /* number of (independent) reader threads */
+
+/* frees a parameter block */
+void saf_paramBlock_destroy(void** const phPB);          /* & address of parameter block handle */
+
+/* acquires the writer lock and returns the working copy. Its address does not change over the lifetime of the
+ * parameter block, and changes made to it are not seen by the readers until "saf_paramBlock_publish" is called.
+ * Every call must be followed by one call to "saf_paramBlock_publish" or "saf_paramBlock_release", on the same
+ * thread. May block; not for the audio thread */
+void* saf_paramBlock_edit(void* const hPB);              /* parameter block handle */
+
+/* makes the current state of the working copy available to all readers, and releases the writer lock */
+void saf_paramBlock_publish(void* const hPB);            /* parameter block handle */
+
+/* releases the writer lock without publishing (changes made are published along with the next update) */
+void saf_paramBlock_release(void* const hPB);            /* parameter block handle */
+
+/* returns the working copy without taking the writer lock; for reading single values on a writer thread (e.g. in
+ * "get" functions). The values may be in the middle of being changed by another writer thread */
+const void* saf_paramBlock_peek(void* const hPB);        /* parameter block handle */
+
+/* returns the most recently published parameters for the given reader; the snapshot remains valid and unchanged
+ * until this reader calls "saf_paramBlock_read" again. Lock-free; safe for the audio thread */
+const void* saf_paramBlock_read(void* const hPB,         /* parameter block handle */
+                                int readerIdx);          /* reader index 0..nReaders-1 */
+
+
+/*****************/
+/* Worker thread */
+/*****************/
+
+/* function carried out by the worker thread */
+typedef void (*saf_worker_job)(void* arg);
+
+/* creates a worker thread, which sleeps until "saf_worker_post" is called and then runs "job(arg)" */
+void saf_worker_create(void** const phWorker,            /* & address of worker handle */
+                       saf_worker_job job,               /* function to run on the worker thread */
+                       void* arg);                       /* argument passed to "job" */
+
+/* stops and joins the worker thread (waiting for a running job to finish, a pending one is dropped), then frees it */
+void saf_worker_destroy(void** const phWorker);          /* & address of worker handle */
+
+/* requests that the job is run. Requests made before the job starts are coalesced into one run; a request made
+ * whilst the job is running causes it to run once more afterwards. Must not be called from the audio thread */
+void saf_worker_post(void* const hWorker);               /* worker handle */
+
+/* blocks until the worker thread has no pending or running job (e.g. for offline rendering) */
+void saf_worker_wait(void* const hWorker);               /* worker handle */
+
+/* returns 1 if the job is pending or running, 0 if the worker thread is idle */
+int saf_worker_isBusy(void* const hWorker);              /* worker handle */
+
+
+/***************/
+/* Thread pool */
+/***************/
+
+/* function carried out for each task of "saf_pool_run" */
+typedef void (*saf_pool_task)(void* arg,                 /* argument passed to "saf_pool_run" */
+                              int taskIdx);              /* task index 0..nTasks-1 */
+
+/* creates a pool of worker threads. Between runs, the threads poll for the next one for a short while before going to
+ * sleep, so that the stages of one "_process" call follow each other without wake-up latency */
+void saf_pool_create(void** const phPool,                /* & address of thread pool handle */
+                     int nThreads);                      /* number of worker threads (the calling thread of
+                                                          * "saf_pool_run" takes part as well); 0: none */
+
+/* as "saf_pool_create", but with worker thread i pinned to CPU core (firstCore + i), modulo the number of cores. The
+ * calling thread of "saf_pool_run" is left as it is. Pinning is not supported on macOS, where the threads are free */
+void saf_pool_createPinned(void** const phPool,          /* & address of thread pool handle */
+                           int nThreads,                 /* number of worker threads; 0: none */
+                           int firstCore);               /* core of the first worker thread; -1: do not pin */
+
+/* stops and joins the worker threads, then frees the pool */
+void saf_pool_destroy(void** const phPool);              /* & address of thread pool handle */
+
+/* runs "task(arg, i)" for i = 0..nTasks-1 on the worker threads and the calling thread, and returns once all tasks
+ * have been completed. Each thread starts on its own contiguous share of the task indices, and steals half of what
+ * is left of another thread's share once it has run out. The order in which the tasks are carried out is therefore
+ * not defined; each task should write only to its own part of the output. No memory is allocated, and no lock is
+ * taken unless a thread has gone to sleep. A NULL pool runs all tasks on the calling thread, as does a pool that is
+ * busy with a run for another thread; so one pool may be shared by several instances/modules */
+void saf_pool_run(void* const hPool,                     /* thread pool handle (may be NULL) */
+                  saf_pool_task task,                    /* function to run for each task */
+                  void* arg,                             /* argument passed to "task" */
+                  int nTasks);                           /* number of tasks */
+
+/* returns the number of worker threads of a pool (0 for NULL) */
+int saf_pool_getNumThreads(void* const hPool);           /* thread pool handle (may be NULL) */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SAF_THREADS_H_INCLUDED */
@@ -28,8 +28,10 @@
  */
 
 #include "saf_veclib.h"
+#include "saf_malloc.h" /* for the real-time allocation check */
 #include "saf_complex.h"
 #include "saf_sort.h"
+#include "saf_threads.h"
 
 #ifndef MIN
   #define MIN(a,b) (( (a) < (b) ) ? (a) : (b))
@@ -202,6 +204,29 @@ void utility_svssub(float* a, const float* s, const int len, float* c)
     for(i=0; i<len; i++)
         c[i] = a[i] - s[0];
 }
+
+/*------------------------------ BLAS threading (?blasThreads) ------------------------------*/
+
+#ifdef INTEL_MKL_VERSION
+static SAF_THREAD_LOCAL int utility_blasDepth = 0;       /* nesting depth of the calling thread */
+static SAF_THREAD_LOCAL int utility_blasPrevThreads = 0; /* previous local MKL setting (0: the global setting) */
+#endif
+
+void utility_blasThreadsBegin(void)
+{
+#ifdef INTEL_MKL_VERSION
+    if(utility_blasDepth++ == 0)
+        utility_blasPrevThreads = mkl_set_num_threads_local(1);
+#endif
+}
+
+void utility_blasThreadsEnd(void)
+{
+#ifdef INTEL_MKL_VERSION
+    if(--utility_blasDepth == 0)
+        mkl_set_num_threads_local(utility_blasPrevThreads);
+#endif
+}
 
 /*---------------------------- singular-value decomposition (?svd) --------------------------*/
 
@@ -316,84 +341,11 @@ void utility_sseig(const float* A, const int dim, int sortDecFLAG, float* V, flo
 
 void utility_ceig(const float_complex* A, const int dim, int sortDecFLAG, float_complex* VL, float_complex* VR, float_complex* D, float* eig)
 {
-    int i, j, n, lda, ldvl, ldvr, info, lwork;
-    float_complex wkopt;
-    float_complex* work, *w, *vl, *vr, *a;
-    float* rwork;
-    
-    n = lda = ldvl = ldvr = dim;
-    rwork = malloc(2*dim*sizeof(float));
-    w = malloc(dim*sizeof(float_complex));
-    vl = malloc(dim*dim*sizeof(float_complex));
-    vr = malloc(dim*dim*sizeof(float_complex));
-    a = malloc(dim*dim*sizeof(float_complex));
-    
-    /* store in column major order (i.e. transpose) */
-    for(i=0; i<dim; i++)
-        for(j=0; j<dim; j++)
-            a[i*dim+j] = A[j*dim+i];
-    
-    /* solve the eigenproblem */
-    lwork = -1;
-#ifdef __APPLE__
-    cgeev_( "Vectors", "Vectors", &n, (__CLPK_complex*)a, &lda, (__CLPK_complex*)w, (__CLPK_complex*)vl,
-           &ldvl, (__CLPK_complex*)vr, &ldvr, (__CLPK_complex*)&wkopt, &lwork, rwork, &info );
-#elif INTEL_MKL_VERSION
-    cgeev_( "Vectors", "Vectors", &n, (MKL_Complex8*)a, &lda, (MKL_Complex8*)w, (MKL_Complex8*)vl, &ldvl, (MKL_Complex8*)vr, &ldvr, (MKL_Complex8*)&wkopt, &lwork, rwork, &info );
-#endif
-    lwork = (int)crealf(wkopt);
-    work = (float_complex*)malloc( lwork*sizeof(float_complex) );
-#ifdef __APPLE__
-    cgeev_( "Vectors", "Vectors", &n, (__CLPK_complex*)a, &lda, (__CLPK_complex*)w, (__CLPK_complex*)vl,
-           &ldvl, (__CLPK_complex*)vr, &ldvr, (__CLPK_complex*)work, &lwork, rwork, &info );
-#elif INTEL_MKL_VERSION
-    cgeev_( "Vectors", "Vectors", &n, (MKL_Complex8*)a, &lda, (MKL_Complex8*)w, (MKL_Complex8*)vl, &ldvl, (MKL_Complex8*)vr, &ldvr, (MKL_Complex8*)work, &lwork, rwork, &info );
-#endif
-    
-    /* sort the eigenvalues */
-    float* wr;
-    int* sort_idx;
-    wr=malloc(dim*sizeof(float));
-    sort_idx=malloc(dim*sizeof(int));
-    for(i=0; i<dim; i++)
-        wr[i] = crealf(w[i]);
-    sortf(wr, NULL, sort_idx, dim, sortDecFLAG);
-    
-    /* output */
-    if(D!=NULL)
-        memset(D, 0, dim*dim*sizeof(float_complex));
-    if( info > 0 ) {
-        /* failed to converge and find the eigenvalues */
-        if(VL!=NULL)
-            memset(VL, 0, dim*dim*sizeof(float_complex));
-        if(VR!=NULL)
-            memset(VR, 0, dim*dim*sizeof(float_complex));
-        if(eig!=NULL)
-            memset(eig, 0, dim*sizeof(float));
-    }
-    else{
-        for(i=0; i<dim; i++){
-            if(VL!=NULL)
-                for(j=0; j<dim; j++)
-                    VL[i*dim+j] = vl[sort_idx[j]*dim+i]; /* transpose, back to row-major */
-            if(VR!=NULL)
-                for(j=0; j<dim; j++)
-                    VR[i*dim+j] = vr[sort_idx[j]*dim+i]; /* transpose, back to row-major */
-            if(D!=NULL)
-                D[i*dim+i] = cmplxf(wr[i], 0.0f); /* store along the diagonal */
-            if(eig!=NULL)
-                eig[i] = wr[i];
-        }
-    }
+    void* hWork;
     
-    free(rwork);
-    free(work);
-    free(w);
-    free(vl);
-    free(vr);
-    free(a);
-    free(wr);
-    free(sort_idx);
+    utility_cWorkspace_create(&hWork, dim, 1);
+    utility_ceig_ws(hWork, A, dim, sortDecFLAG, VL, VR, D, eig);
+    utility_cWorkspace_destroy(&hWork);
 }
 
 /*------------------------------ general linear solver (?glslv) -----------------------------*/
@@ -435,13 +387,22 @@ void utility_sglslv(const float* A, const int dim, float* B, int nCol, float* X)
 }
 
 void utility_cglslv(const float_complex* A, const int dim, float_complex* B, int nCol, float_complex* X)
+{
+    void* hWork;
+    
+    utility_cWorkspace_create(&hWork, dim, nCol);
+    utility_cglslv_ws(hWork, A, dim, B, nCol, X);
+    utility_cWorkspace_destroy(&hWork);
+}
+
+/*----------------------------- symmetric linear solver (?slslv) ----------------------------*/
+
+void utility_sslslv(const float* A, const int dim, float* B, int nCol, float* X)
 {
     int i, j, n = dim, nrhs = nCol, lda = dim, ldb = dim, info;
-    int* IPIV;
-    IPIV = malloc(dim*sizeof(int));
-    float_complex* a, *b;
-    a = malloc(dim*dim*sizeof(float_complex));
-    b = malloc(dim*nrhs*sizeof(float_complex));
+    float* a, *b;
+    a = malloc(dim*dim*sizeof(float));
+    b = malloc(dim*nrhs*sizeof(float));
     
     /* store in column major order */
     for(i=0; i<dim; i++)
@@ -452,15 +413,11 @@ void utility_cglslv(const float_complex* A, const int dim, float_complex* B, int
             b[j*dim+i] = B[i*nCol+j];
     
     /* solve Ax = b for each column in b (b is replaced by the solution: x) */
-#ifdef __APPLE__
-    cgesv_( &n, &nrhs, (__CLPK_complex*)a, &lda, IPIV, (__CLPK_complex*)b, &ldb, &info );
-#elif INTEL_MKL_VERSION
-    cgesv_( &n, &nrhs, (MKL_Complex8*)a, &lda, IPIV, (MKL_Complex8*)b, &ldb, &info );
-#endif
+    sposv_( "U", &n, &nrhs, a, &lda, b, &ldb, &info );
     
     if(info>0){
-        /* A is singular, solution not possible */
-        memset(X, 0, dim*nCol*sizeof(float_complex));
+        /* A is not positive definate, solution not possible */
+        memset(X, 0, dim*nCol*sizeof(float));
     }
     else{
         /* store solution in row-major order */
@@ -469,19 +426,177 @@ void utility_cglslv(const float_complex* A, const int dim, float_complex* B, int
                 X[i*nCol+j] = b[j*dim+i];
     }
     
-    free(IPIV);
     free(a);
     free(b);
 }
 
-/*----------------------------- symmetric linear solver (?slslv) ----------------------------*/
+void utility_cslslv(const float_complex* A, const int dim, float_complex* B, int nCol, float_complex* X)
+{
+    void* hWork;
+    
+    utility_cWorkspace_create(&hWork, dim, nCol);
+    utility_cslslv_ws(hWork, A, dim, B, nCol, X);
+    utility_cWorkspace_destroy(&hWork);
+}
 
-void utility_sslslv(const float* A, const int dim, float* B, int nCol, float* X)
+/*----------------------- preallocated workspace for the above (?_ws) -----------------------*/
+
+typedef struct _utility_cWorkspace {
+    int maxDim, maxNCol;
+    int lwork;                      /* size of "work" */
+    float_complex* a;               /* maxDim x maxDim */
+    float_complex* b;               /* maxDim x maxNCol */
+    float_complex* vl, *vr;         /* maxDim x maxDim */
+    float_complex* w;               /* maxDim x 1 */
+    float_complex* work;            /* lwork x 1 */
+    float* rwork;                   /* 2*maxDim x 1 */
+    float* wr;                      /* maxDim x 1 */
+    int* idx;                       /* maxDim x 1 */
+}utility_cWorkspace;
+
+void utility_cWorkspace_create(void** const phWork, int maxDim, int maxNCol)
+{
+    utility_cWorkspace* ws;
+    int n, lda, ldvl, ldvr, info, lwork;
+    float_complex wkopt;
+    
+    ws = (utility_cWorkspace*)malloc(sizeof(utility_cWorkspace));
+    *phWork = (void*)ws;
+    maxDim = MAX(maxDim, 1);
+    maxNCol = MAX(maxNCol, 1);
+    ws->maxDim = maxDim;
+    ws->maxNCol = maxNCol;
+    ws->a = malloc(maxDim*maxDim*sizeof(float_complex));
+    ws->b = malloc(maxDim*maxNCol*sizeof(float_complex));
+    ws->vl = malloc(maxDim*maxDim*sizeof(float_complex));
+    ws->vr = malloc(maxDim*maxDim*sizeof(float_complex));
+    ws->w = malloc(maxDim*sizeof(float_complex));
+    ws->rwork = malloc(2*maxDim*sizeof(float));
+    ws->wr = malloc(maxDim*sizeof(float));
+    ws->idx = malloc(maxDim*sizeof(int));
+    
+    /* query the optimal eigen-solver workspace size for the largest dimension; this is sufficient for smaller ones */
+    n = lda = ldvl = ldvr = maxDim;
+    lwork = -1;
+    wkopt = cmplxf(0.0f, 0.0f);
+#ifdef __APPLE__
+    cgeev_( "Vectors", "Vectors", &n, (__CLPK_complex*)ws->a, &lda, (__CLPK_complex*)ws->w, (__CLPK_complex*)ws->vl,
+           &ldvl, (__CLPK_complex*)ws->vr, &ldvr, (__CLPK_complex*)&wkopt, &lwork, ws->rwork, &info );
+#elif INTEL_MKL_VERSION
+    cgeev_( "Vectors", "Vectors", &n, (MKL_Complex8*)ws->a, &lda, (MKL_Complex8*)ws->w, (MKL_Complex8*)ws->vl, &ldvl, (MKL_Complex8*)ws->vr, &ldvr, (MKL_Complex8*)&wkopt, &lwork, ws->rwork, &info );
+#endif
+    ws->lwork = MAX((int)crealf(wkopt), 2*maxDim);
+    ws->work = malloc(ws->lwork*sizeof(float_complex));
+}
+
+void utility_cWorkspace_destroy(void** const phWork)
+{
+    utility_cWorkspace* ws = (utility_cWorkspace*)(*phWork);
+    
+    if(ws!=NULL){
+        free(ws->a);
+        free(ws->b);
+        free(ws->vl);
+        free(ws->vr);
+        free(ws->w);
+        free(ws->work);
+        free(ws->rwork);
+        free(ws->wr);
+        free(ws->idx);
+        free(ws);
+        ws = NULL;
+        *phWork = NULL;
+    }
+}
+
+void utility_ceig_ws(void* const hWork, const float_complex* A, const int dim, int sortDecFLAG, float_complex* VL, float_complex* VR, float_complex* D, float* eig)
+{
+    utility_cWorkspace* ws = (utility_cWorkspace*)(hWork);
+    int i, j, k, n, lda, ldvl, ldvr, info, lwork, tmp;
+    float_complex* a, *w, *vl, *vr;
+    float* wr;
+    int* sort_idx;
+    
+    if(dim>ws->maxDim){
+        utility_ceig(A, dim, sortDecFLAG, VL, VR, D, eig); /* workspace too small */
+        return;
+    }
+    n = lda = ldvl = ldvr = dim;
+    a = ws->a;
+    w = ws->w;
+    vl = ws->vl;
+    vr = ws->vr;
+    wr = ws->wr;
+    sort_idx = ws->idx;
+    
+    /* store in column major order (i.e. transpose) */
+    for(i=0; i<dim; i++)
+        for(j=0; j<dim; j++)
+            a[i*dim+j] = A[j*dim+i];
+    
+    /* solve the eigenproblem */
+    lwork = ws->lwork;
+#ifdef __APPLE__
+    cgeev_( "Vectors", "Vectors", &n, (__CLPK_complex*)a, &lda, (__CLPK_complex*)w, (__CLPK_complex*)vl,
+           &ldvl, (__CLPK_complex*)vr, &ldvr, (__CLPK_complex*)ws->work, &lwork, ws->rwork, &info );
+#elif INTEL_MKL_VERSION
+    cgeev_( "Vectors", "Vectors", &n, (MKL_Complex8*)a, &lda, (MKL_Complex8*)w, (MKL_Complex8*)vl, &ldvl, (MKL_Complex8*)vr, &ldvr, (MKL_Complex8*)ws->work, &lwork, ws->rwork, &info );
+#endif
+    
+    /* sort the eigenvalues (insertion sort of the indices, as dim is small and sortf would allocate) */
+    for(i=0; i<dim; i++){
+        wr[i] = crealf(w[i]);
+        sort_idx[i] = i;
+    }
+    for(i=1; i<dim; i++){
+        tmp = sort_idx[i];
+        for(k=i; k>0 && (sortDecFLAG ? wr[sort_idx[k-1]] < wr[tmp] : wr[sort_idx[k-1]] > wr[tmp]); k--)
+            sort_idx[k] = sort_idx[k-1];
+        sort_idx[k] = tmp;
+    }
+    
+    /* output */
+    if(D!=NULL)
+        memset(D, 0, dim*dim*sizeof(float_complex));
+    if( info > 0 ) {
+        /* failed to converge and find the eigenvalues */
+        if(VL!=NULL)
+            memset(VL, 0, dim*dim*sizeof(float_complex));
+        if(VR!=NULL)
+            memset(VR, 0, dim*dim*sizeof(float_complex));
+        if(eig!=NULL)
+            memset(eig, 0, dim*sizeof(float));
+    }
+    else{
+        for(i=0; i<dim; i++){
+            if(VL!=NULL)
+                for(j=0; j<dim; j++)
+                    VL[i*dim+j] = vl[sort_idx[j]*dim+i]; /* transpose, back to row-major */
+            if(VR!=NULL)
+                for(j=0; j<dim; j++)
+                    VR[i*dim+j] = vr[sort_idx[j]*dim+i]; /* transpose, back to row-major */
+            if(D!=NULL)
+                D[i*dim+i] = cmplxf(wr[sort_idx[i]], 0.0f); /* store along the diagonal */
+            if(eig!=NULL)
+                eig[i] = wr[sort_idx[i]];
+        }
+    }
+}
+
+void utility_cglslv_ws(void* const hWork, const float_complex* A, const int dim, float_complex* B, int nCol, float_complex* X)
 {
+    utility_cWorkspace* ws = (utility_cWorkspace*)(hWork);
     int i, j, n = dim, nrhs = nCol, lda = dim, ldb = dim, info;
-    float* a, *b;
-    a = malloc(dim*dim*sizeof(float));
-    b = malloc(dim*nrhs*sizeof(float));
+    int* IPIV;
+    float_complex* a, *b;
+    
+    if(dim>ws->maxDim || nCol>ws->maxNCol){
+        utility_cglslv(A, dim, B, nCol, X); /* workspace too small */
+        return;
+    }
+    IPIV = ws->idx;
+    a = ws->a;
+    b = ws->b;
     
     /* store in column major order */
     for(i=0; i<dim; i++)
@@ -492,11 +607,15 @@ void utility_sslslv(const float* A, const int dim, float* B, int nCol, float* X)
             b[j*dim+i] = B[i*nCol+j];
     
     /* solve Ax = b for each column in b (b is replaced by the solution: x) */
-    sposv_( "U", &n, &nrhs, a, &lda, b, &ldb, &info );
+#ifdef __APPLE__
+    cgesv_( &n, &nrhs, (__CLPK_complex*)a, &lda, IPIV, (__CLPK_complex*)b, &ldb, &info );
+#elif INTEL_MKL_VERSION
+    cgesv_( &n, &nrhs, (MKL_Complex8*)a, &lda, IPIV, (MKL_Complex8*)b, &ldb, &info );
+#endif
     
     if(info>0){
-        /* A is not positive definate, solution not possible */
-        memset(X, 0, dim*nCol*sizeof(float));
+        /* A is singular, solution not possible */
+        memset(X, 0, dim*nCol*sizeof(float_complex));
     }
     else{
         /* store solution in row-major order */
@@ -504,17 +623,20 @@ void utility_sslslv(const float* A, const int dim, float* B, int nCol, float* X)
             for(j=0; j<nCol; j++)
                 X[i*nCol+j] = b[j*dim+i];
     }
-    
-    free(a);
-    free(b);
 }
 
-void utility_cslslv(const float_complex* A, const int dim, float_complex* B, int nCol, float_complex* X)
+void utility_cslslv_ws(void* const hWork, const float_complex* A, const int dim, float_complex* B, int nCol, float_complex* X)
 {
+    utility_cWorkspace* ws = (utility_cWorkspace*)(hWork);
     int i, j, n = dim, nrhs = nCol, lda = dim, ldb = dim, info;
     float_complex* a, *b;
-    a = malloc(dim*dim*sizeof(float_complex));
-    b = malloc(dim*nrhs*sizeof(float_complex));
+    
+    if(dim>ws->maxDim || nCol>ws->maxNCol){
+        utility_cslslv(A, dim, B, nCol, X); /* workspace too small */
+        return;
+    }
+    a = ws->a;
+    b = ws->b;
     
     /* store in column major order */
     for(i=0; i<dim; i++)
@@ -541,9 +663,6 @@ void utility_cslslv(const float_complex* A, const int dim, float_complex* B, int
             for(j=0; j<nCol; j++)
                 X[i*nCol+j] = b[j*dim+i];
     }
-    
-    free(a);
-    free(b);
 }
 
 
@@ -45,6 +45,11 @@
   #include "mkl.h" 
 #endif
 #include "saf_complex.h"
+#ifdef _MSC_VER
+  #define SAF_FORCE_INLINE static __forceinline
+#else
+  #define SAF_FORCE_INLINE static inline __attribute__((always_inline))
+#endif
 #ifdef CBLAS_H
   #define NO_TRANSPOSE (CblasNoTrans)
   #define TRANSPOSE (CblasTrans)
@@ -135,6 +140,158 @@ void utility_svssub(float* a,
                     const int len,
                     float* c);
 
+/*-------------------------- matrix-matrix multiplication (?gemm) ---------------------------*/
+
+/* Row-major C = alpha*op(A)*op(B) + beta*C, where op(A) is M x K and op(B) is K x N (as cblas_?gemm with
+ * CblasRowMajor). Products of at most SAF_GEMM_BLAS_THRESHOLD multiply-adds (M*N*K) are computed by the inlined
+ * loops of "utility_?gemm_small"; larger products are handed to BLAS. Since both functions are always inlined, calls
+ * with constant dimensions (e.g. the 1 x 3 by 3 x 2 products of the HRTF interpolation) resolve the branch and
+ * unroll the loops at compile time, avoiding the call, argument checking and dispatch overhead of the BLAS library,
+ * which dominates for such tiny products. The crossover may be measured with "saf_bench -module gemm" (with
+ * OpenBLAS on x86-64, it lies between the 3x3x3 and 4x4x4 products, for both real and complex matrices), and the
+ * threshold may be overridden at compile time (0: always use BLAS) */
+#ifndef SAF_GEMM_BLAS_THRESHOLD
+  #define SAF_GEMM_BLAS_THRESHOLD ( 32 )
+#endif
+
+/* s, single-precision, row-major matrix-matrix product, always computed with inlined loops */
+SAF_FORCE_INLINE void utility_sgemm_small(const TRANS_FLAG transA,   /* NO_TRANSPOSE or TRANSPOSE */
+                                          const TRANS_FLAG transB,   /* NO_TRANSPOSE or TRANSPOSE */
+                                          const int M,               /* number of rows of op(A) and C */
+                                          const int N,               /* number of columns of op(B) and C */
+                                          const int K,               /* number of columns of op(A), rows of op(B) */
+                                          const float alpha,         /* scaling of op(A)*op(B) */
+                                          const float* A,            /* matrix A; flat: M x lda, or K x lda */
+                                          const int lda,             /* row stride of A */
+                                          const float* B,            /* matrix B; flat: K x ldb, or N x ldb */
+                                          const int ldb,             /* row stride of B */
+                                          const float beta,          /* scaling of C (0: C is overwritten) */
+                                          float* C,                  /* matrix C; flat: M x ldc */
+                                          const int ldc)             /* row stride of C */
+{
+    int i, j, k;
+    float sum;
+
+    for(i=0; i<M; i++){
+        for(j=0; j<N; j++){
+            sum = 0.0f;
+            for(k=0; k<K; k++)
+                sum += (transA==NO_TRANSPOSE ? A[i*lda+k] : A[k*lda+i]) *
+                       (transB==NO_TRANSPOSE ? B[k*ldb+j] : B[j*ldb+k]);
+            C[i*ldc+j] = beta==0.0f ? alpha*sum : alpha*sum + beta*C[i*ldc+j];
+        }
+    }
+}
+
+/* c, single-precision, complex, row-major matrix-matrix product, always computed with inlined loops */
+SAF_FORCE_INLINE void utility_cgemm_small(const TRANS_FLAG transA,   /* NO_TRANSPOSE, TRANSPOSE or CONJ_TRANSPOSE */
+                                          const TRANS_FLAG transB,   /* NO_TRANSPOSE, TRANSPOSE or CONJ_TRANSPOSE */
+                                          const int M,               /* number of rows of op(A) and C */
+                                          const int N,               /* number of columns of op(B) and C */
+                                          const int K,               /* number of columns of op(A), rows of op(B) */
+                                          const float_complex alpha, /* scaling of op(A)*op(B) */
+                                          const float_complex* A,    /* matrix A; flat: M x lda, or K x lda */
+                                          const int lda,             /* row stride of A */
+                                          const float_complex* B,    /* matrix B; flat: K x ldb, or N x ldb */
+                                          const int ldb,             /* row stride of B */
+                                          const float_complex beta,  /* scaling of C (0: C is overwritten) */
+                                          float_complex* C,          /* matrix C; flat: M x ldc */
+                                          const int ldc)             /* row stride of C */
+{
+    /* (interleaved real/imaginary parts are used directly, since the complex operators of saf_complex are not
+     * inlined on all compilers) */
+    const float* a = (const float*)A;
+    const float* b = (const float*)B;
+    float* c = (float*)C;
+    const float alpha_re = crealf(alpha), alpha_im = cimagf(alpha);
+    const float beta_re = crealf(beta), beta_im = cimagf(beta);
+    int i, j, k, ia, ib;
+    float a_re, a_im, b_re, b_im, sum_re, sum_im, c_re, c_im;
+
+    for(i=0; i<M; i++){
+        for(j=0; j<N; j++){
+            sum_re = sum_im = 0.0f;
+            for(k=0; k<K; k++){
+                ia = transA==NO_TRANSPOSE ? 2*(i*lda+k) : 2*(k*lda+i);
+                ib = transB==NO_TRANSPOSE ? 2*(k*ldb+j) : 2*(j*ldb+k);
+                a_re = a[ia];
+                a_im = transA==CONJ_TRANSPOSE ? -a[ia+1] : a[ia+1];
+                b_re = b[ib];
+                b_im = transB==CONJ_TRANSPOSE ? -b[ib+1] : b[ib+1];
+                sum_re += a_re*b_re - a_im*b_im;
+                sum_im += a_re*b_im + a_im*b_re;
+            }
+            c_re = alpha_re*sum_re - alpha_im*sum_im;
+            c_im = alpha_re*sum_im + alpha_im*sum_re;
+            if(beta_re!=0.0f || beta_im!=0.0f){
+                c_re += beta_re*c[2*(i*ldc+j)] - beta_im*c[2*(i*ldc+j)+1];
+                c_im += beta_re*c[2*(i*ldc+j)+1] + beta_im*c[2*(i*ldc+j)];
+            }
+            c[2*(i*ldc+j)] = c_re;
+            c[2*(i*ldc+j)+1] = c_im;
+        }
+    }
+}
+
+/* s, single-precision, row-major matrix-matrix product; small products are inlined, larger ones use BLAS */
+SAF_FORCE_INLINE void utility_sgemm(const TRANS_FLAG transA,         /* NO_TRANSPOSE or TRANSPOSE */
+                                    const TRANS_FLAG transB,         /* NO_TRANSPOSE or TRANSPOSE */
+                                    const int M,                     /* number of rows of op(A) and C */
+                                    const int N,                     /* number of columns of op(B) and C */
+                                    const int K,                     /* number of columns of op(A), rows of op(B) */
+                                    const float alpha,               /* scaling of op(A)*op(B) */
+                                    const float* A,                  /* matrix A; flat: M x lda, or K x lda */
+                                    const int lda,                   /* row stride of A */
+                                    const float* B,                  /* matrix B; flat: K x ldb, or N x ldb */
+                                    const int ldb,                   /* row stride of B */
+                                    const float beta,                /* scaling of C (0: C is overwritten) */
+                                    float* C,                        /* matrix C; flat: M x ldc */
+                                    const int ldc)                   /* row stride of C */
+{
+    if(M*N*K <= SAF_GEMM_BLAS_THRESHOLD)
+        utility_sgemm_small(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+    else
+        cblas_sgemm(CblasRowMajor, transA==NO_TRANSPOSE ? CblasNoTrans : CblasTrans,
+                    transB==NO_TRANSPOSE ? CblasNoTrans : CblasTrans, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+}
+
+/* c, single-precision, complex, row-major matrix-matrix product; small products are inlined, larger ones use BLAS */
+SAF_FORCE_INLINE void utility_cgemm(const TRANS_FLAG transA,         /* NO_TRANSPOSE, TRANSPOSE or CONJ_TRANSPOSE */
+                                    const TRANS_FLAG transB,         /* NO_TRANSPOSE, TRANSPOSE or CONJ_TRANSPOSE */
+                                    const int M,                     /* number of rows of op(A) and C */
+                                    const int N,                     /* number of columns of op(B) and C */
+                                    const int K,                     /* number of columns of op(A), rows of op(B) */
+                                    const float_complex alpha,       /* scaling of op(A)*op(B) */
+                                    const float_complex* A,          /* matrix A; flat: M x lda, or K x lda */
+                                    const int lda,                   /* row stride of A */
+                                    const float_complex* B,          /* matrix B; flat: K x ldb, or N x ldb */
+                                    const int ldb,                   /* row stride of B */
+                                    const float_complex beta,        /* scaling of C (0: C is overwritten) */
+                                    float_complex* C,                /* matrix C; flat: M x ldc */
+                                    const int ldc)                   /* row stride of C */
+{
+    if(M*N*K <= SAF_GEMM_BLAS_THRESHOLD)
+        utility_cgemm_small(transA, transB, M, N, K, alpha, A, lda, B, ldb, beta, C, ldc);
+    else
+        cblas_cgemm(CblasRowMajor,
+                    transA==NO_TRANSPOSE ? CblasNoTrans : (transA==TRANSPOSE ? CblasTrans : CblasConjTrans),
+                    transB==NO_TRANSPOSE ? CblasNoTrans : (transB==TRANSPOSE ? CblasTrans : CblasConjTrans),
+                    M, N, K, &alpha, A, lda, B, ldb, &beta, C, ldc);
+}
+
+/*------------------------------ BLAS threading (?blasThreads) ------------------------------*/
+
+/* Restricts the BLAS/LAPACK routines called from the calling thread to that thread, until the matching
+ * "utility_blasThreadsEnd" (calls may be nested). Performance libraries otherwise may fork their own worker
+ * threads from within a processing call, which then competes with the audio thread (and any saf_pool workers) for
+ * the CPU. The SAF_RT_SCOPE_BEGIN/SAF_RT_SCOPE_END regions of the examples call these, as do saf_pool workers.
+ * Intel MKL is limited per-thread (mkl_set_num_threads_local); Apple's Accelerate offers no per-thread control,
+ * and it is left as it is. */
+void utility_blasThreadsBegin(void);
+
+/* ends a "utility_blasThreadsBegin" region, restoring the previous BLAS/LAPACK threading of the calling thread */
+void utility_blasThreadsEnd(void);
+
 /*---------------------------- singular-value decomposition (?svd) --------------------------*/
 
 /* s, row-major, singular value decomposition: single precision */
@@ -197,6 +354,41 @@ void utility_cslslv(const float_complex* A,  /* square symmetric positive-defina
                     int nCol,                /* number of columns in right hand side matrix */
                     float_complex* X);       /* the solution; dim x nCol */
 
+/*----------------------- preallocated workspace for the above (?_ws) -----------------------*/
+
+/* The "_ws" variants of "utility_ceig", "utility_cglslv" and "utility_cslslv" take a preallocated workspace, and are
+ * otherwise identical. They do not allocate memory (as long as "dim" and "nCol" are within the maximums given to
+ * "utility_cWorkspace_create"), and may therefore be called from the audio thread. A workspace must not be used by
+ * more than one thread at a time. */
+void utility_cWorkspace_create(void** const phWork,   /* & address of workspace handle */
+                               int maxDim,             /* largest "dim" that the workspace will be used for */
+                               int maxNCol);           /* largest "nCol" that the workspace will be used for */
+
+void utility_cWorkspace_destroy(void** const phWork);  /* & address of workspace handle */
+
+void utility_ceig_ws(void* const hWork,                /* workspace handle */
+                     const float_complex* A,
+                     const int dim,
+                     int sortDecFLAG,
+                     float_complex* VL,
+                     float_complex* VR,
+                     float_complex* D,
+                     float* eig);
+
+void utility_cglslv_ws(void* const hWork,              /* workspace handle */
+                       const float_complex* A,
+                       const int dim,
+                       float_complex* B,
+                       int nCol,
+                       float_complex* X);
+
+void utility_cslslv_ws(void* const hWork,              /* workspace handle */
+                       const float_complex* A,
+                       const int dim,
+                       float_complex* B,
+                       int nCol,
+                       float_complex* X);
+
 /*------------------------------- matrix pseudo-inverse (?pinv) -----------------------------*/
 
 /* s, row-major, general matrix pseudo-inverse (the svd way): single precision */
@@ -255,10 +255,10 @@ void invertLsMtx3D
         
         /* get inverse of current group */
         utility_sinv(tempGroup,3);
-        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 3, 3, 3, 1.0,
-                    eye3, 3,
-                    tempGroup, 3, 0.0,
-                    tempInv, 3);
+        utility_sgemm(NO_TRANSPOSE, NO_TRANSPOSE, 3, 3, 3, 1.0,
+                      eye3, 3,
+                      tempGroup, 3, 0.0,
+                      tempInv, 3);
         
         /* store the vectorized inverse as a row the output */
         for(i=0; i<3; i++)
@@ -296,22 +296,22 @@ void vbap3D
         for(i=0; i<nFaces; i++){
             for(j=0; j<3; j++)
                 ls_invMtx_s[j] = layoutInvMtx[i*9+j];
-            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, 1, 1, 3, 1.0,
-                        ls_invMtx_s, 3,
-                        u, 3, 0.0,
-                        &g_tmp[0], 1);
+            utility_sgemm(NO_TRANSPOSE, TRANSPOSE, 1, 1, 3, 1.0,
+                          ls_invMtx_s, 3,
+                          u, 3, 0.0,
+                          &g_tmp[0], 1);
             for(j=0; j<3; j++)
                 ls_invMtx_s[j] = layoutInvMtx[i*9+j+3];
-            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, 1, 1, 3, 1.0,
-                        ls_invMtx_s, 3,
-                        u, 3, 0.0,
-                        &g_tmp[1], 1);
+            utility_sgemm(NO_TRANSPOSE, TRANSPOSE, 1, 1, 3, 1.0,
+                          ls_invMtx_s, 3,
+                          u, 3, 0.0,
+                          &g_tmp[1], 1);
             for(j=0; j<3; j++)
                 ls_invMtx_s[j] = layoutInvMtx[i*9+j+6];
-            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, 1, 1, 3, 1.0,
-                        ls_invMtx_s, 3,
-                        u, 3, 0.0,
-                        &g_tmp[2], 1);
+            utility_sgemm(NO_TRANSPOSE, TRANSPOSE, 1, 1, 3, 1.0,
+                          ls_invMtx_s, 3,
+                          u, 3, 0.0,
+                          &g_tmp[2], 1);
             min_val = 2.23e13f;
             g_tmp_rms = 0.0;
             for(j=0; j<3; j++){
@@ -395,10 +395,10 @@ void invertLsMtx2D
         
         /* get inverse of current group */
         utility_sinv(tempGroup,2);
-        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 2, 2, 2, 1.0,
-                    eye2, 2,
-                    tempGroup, 2, 0.0,
-                    tempInv, 2);
+        utility_sgemm(NO_TRANSPOSE, NO_TRANSPOSE, 2, 2, 2, 1.0,
+                      eye2, 2,
+                      tempGroup, 2, 0.0,
+                      tempInv, 2);
         
         /* store the vectorized inverse as a row the output */
         for(i=0; i<2; i++)
@@ -434,16 +434,16 @@ void vbap2D
         for(i=0; i<N_pairs; i++){
             for(j=0; j<2; j++)
                 ls_invMtx_s[j] = layoutInvMtx[i*4+j];
-            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, 1, 1, 2, 1.0,
-                        ls_invMtx_s, 2,
-                        u, 2, 0.0,
-                        &g_tmp[0], 1);
+            utility_sgemm(NO_TRANSPOSE, TRANSPOSE, 1, 1, 2, 1.0,
+                          ls_invMtx_s, 2,
+                          u, 2, 0.0,
+                          &g_tmp[0], 1);
             for(j=0; j<2; j++)
                 ls_invMtx_s[j] = layoutInvMtx[i*4+j+2];
-            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasTrans, 1, 1, 2, 1.0,
-                        ls_invMtx_s, 2,
-                        u, 2, 0.0,
-                        &g_tmp[1], 1);
+            utility_sgemm(NO_TRANSPOSE, TRANSPOSE, 1, 1, 2, 1.0,
+                          ls_invMtx_s, 2,
+                          u, 2, 0.0,
+                          &g_tmp[1], 1);
             min_val = 2.23e13f;
             g_tmp_rms = 0.0;
             for(j=0; j<2; j++){
@@ -0,0 +1,49 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     render_ambi_dec.c
+ * Description:
+ *     Renderer module: Ambisonic signals (order taken from the channel count) to the default loudspeaker layout.
+ * Dependencies:
+ *     ambi_dec
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include "saf_render_internal.h"
+#include "ambi_dec.h"
+
+static int render_ambi_dec_setup(void* hMod, int samplerate, int nInputs, const render_settings* settings)
+{
+    int order;
+
+    order = render_getOrderFromNumSH(nInputs);
+    if(order<1 || order>SH_ORDER)
+        return 0;
+    ambi_dec_init(hMod, samplerate);
+    ambi_dec_setDecOrderAllBands(hMod, order);
+    ambi_dec_waitForCodecInit(hMod);
+    return ambi_dec_getNumLoudspeakers(hMod);
+}
+
+static void render_ambi_dec_process(void* hMod, float** inputs, float** outputs, int nInputs, int nOutputs)
+{
+    ambi_dec_process(hMod, inputs, outputs, nInputs, nOutputs, FRAME_SIZE, 1);
+}
+
+const render_module render_ambi_dec = {
+    "ambi_dec", ambi_dec_create, ambi_dec_destroy, render_ambi_dec_setup, render_ambi_dec_process, ambi_dec_getProcessingDelay
+};
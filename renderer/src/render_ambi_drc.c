@@ -0,0 +1,49 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     render_ambi_drc.c
+ * Description:
+ *     Renderer module: dynamic range compression of Ambisonic signals (order taken from the channel count).
+ * Dependencies:
+ *     ambi_drc
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include "saf_render_internal.h"
+#include "ambi_drc.h"
+
+static int render_ambi_drc_setup(void* hMod, int samplerate, int nInputs, const render_settings* settings)
+{
+    int order;
+
+    order = render_getOrderFromNumSH(nInputs);
+    if(order<0 || order>RENDER_MAX_SH_ORDER)
+        return 0;
+    ambi_drc_init(hMod, samplerate);
+    ambi_drc_setInputPreset(hMod, (INPUT_ORDER)(order+1));
+    ambi_drc_waitForInit(hMod);
+    return nInputs;
+}
+
+static void render_ambi_drc_process(void* hMod, float** inputs, float** outputs, int nInputs, int nOutputs)
+{
+    ambi_drc_process(hMod, inputs, outputs, nInputs, FRAME_SIZE, 1);
+}
+
+const render_module render_ambi_drc = {
+    "ambi_drc", ambi_drc_create, ambi_drc_destroy, render_ambi_drc_setup, render_ambi_drc_process, ambi_drc_getProcessingDelay
+};
@@ -0,0 +1,50 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     render_ambi_enc.c
+ * Description:
+ *     Renderer module: one source per input channel (default directions) to Ambisonic signals.
+ * Dependencies:
+ *     ambi_enc
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include "saf_render_internal.h"
+#include "ambi_enc.h"
+
+static int render_ambi_enc_setup(void* hMod, int samplerate, int nInputs, const render_settings* settings)
+{
+    int order;
+
+    if(nInputs>ambi_enc_getMaxNumSources())
+        return 0;
+    ambi_enc_init(hMod, samplerate);
+    ambi_enc_setNumSources(hMod, nInputs);
+    if(settings->order>0)
+        ambi_enc_setOutputOrder(hMod, (settings->order<RENDER_MAX_SH_ORDER ? settings->order : RENDER_MAX_SH_ORDER)+1);
+    order = ambi_enc_getOutputOrder(hMod)-1; /* (the presets start with omni) */
+    return (order+1)*(order+1);
+}
+
+static void render_ambi_enc_process(void* hMod, float** inputs, float** outputs, int nInputs, int nOutputs)
+{
+    ambi_enc_process(hMod, inputs, outputs, nInputs, nOutputs, FRAME_SIZE, 1);
+}
+
+const render_module render_ambi_enc = {
+    "ambi_enc", ambi_enc_create, ambi_enc_destroy, render_ambi_enc_setup, render_ambi_enc_process, ambi_enc_getProcessingDelay
+};
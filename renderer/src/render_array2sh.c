@@ -0,0 +1,45 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     render_array2sh.c
+ * Description:
+ *     Renderer module: microphone array signals (default array) to Ambisonic signals of order SH_ORDER.
+ * Dependencies:
+ *     array2sh
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include "saf_render_internal.h"
+#include "array2sh.h"
+
+static int render_array2sh_setup(void* hMod, int samplerate, int nInputs, const render_settings* settings)
+{
+    array2sh_init(hMod, samplerate);
+    if(nInputs!=array2sh_getNumSensors(hMod))
+        return 0;
+    array2sh_waitForCodecInit(hMod);
+    return (SH_ORDER+1)*(SH_ORDER+1);
+}
+
+static void render_array2sh_process(void* hMod, float** inputs, float** outputs, int nInputs, int nOutputs)
+{
+    array2sh_process(hMod, inputs, outputs, nInputs, nOutputs, FRAME_SIZE, 1);
+}
+
+const render_module render_array2sh = {
+    "array2sh", array2sh_create, array2sh_destroy, render_array2sh_setup, render_array2sh_process, array2sh_getProcessingDelay
+};
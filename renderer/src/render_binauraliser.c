@@ -0,0 +1,46 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     render_binauraliser.c
+ * Description:
+ *     Renderer module: one source per input channel (default directions) to binaural.
+ * Dependencies:
+ *     binauraliser
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include "saf_render_internal.h"
+#include "binauraliser.h"
+
+static int render_binauraliser_setup(void* hMod, int samplerate, int nInputs, const render_settings* settings)
+{
+    if(nInputs>binauraliser_getMaxNumSources())
+        return 0;
+    binauraliser_init(hMod, samplerate);
+    binauraliser_setNumSources(hMod, nInputs);
+    binauraliser_waitForCodecInit(hMod);
+    return 2;
+}
+
+static void render_binauraliser_process(void* hMod, float** inputs, float** outputs, int nInputs, int nOutputs)
+{
+    binauraliser_process(hMod, inputs, outputs, nInputs, nOutputs, FRAME_SIZE, 1);
+}
+
+const render_module render_binauraliser = {
+    "binauraliser", binauraliser_create, binauraliser_destroy, render_binauraliser_setup, render_binauraliser_process, binauraliser_getProcessingDelay
+};
@@ -0,0 +1,44 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     render_mceq.c
+ * Description:
+ *     Renderer module: multi-channel equalisation (default filters).
+ * Dependencies:
+ *     mceq
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include "saf_render_internal.h"
+#include "mceq.h"
+
+static int render_mceq_setup(void* hMod, int samplerate, int nInputs, const render_settings* settings)
+{
+    mceq_init(hMod, samplerate);
+    mceq_setNumChannels(hMod, nInputs);
+    mceq_waitForInit(hMod);
+    return nInputs;
+}
+
+static void render_mceq_process(void* hMod, float** inputs, float** outputs, int nInputs, int nOutputs)
+{
+    mceq_process(hMod, inputs, outputs, nInputs, nOutputs, FRAME_SIZE, 1);
+}
+
+const render_module render_mceq = {
+    "mceq", mceq_create, mceq_destroy, render_mceq_setup, render_mceq_process, mceq_getProcessingDelay
+};
@@ -0,0 +1,51 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     render_rotator.c
+ * Description:
+ *     Renderer module: rotation of Ambisonic signals (order taken from the channel count).
+ * Dependencies:
+ *     rotator
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include "saf_render_internal.h"
+#include "rotator.h"
+
+static int render_rotator_setup(void* hMod, int samplerate, int nInputs, const render_settings* settings)
+{
+    int order;
+
+    order = render_getOrderFromNumSH(nInputs);
+    if(order<1 || order>RENDER_MAX_SH_ORDER)
+        return 0;
+    rotator_init(hMod, samplerate);
+    rotator_setOrder(hMod, order+1);
+    rotator_setYaw(hMod, settings->yaw);
+    rotator_setPitch(hMod, settings->pitch);
+    rotator_setRoll(hMod, settings->roll);
+    return nInputs;
+}
+
+static void render_rotator_process(void* hMod, float** inputs, float** outputs, int nInputs, int nOutputs)
+{
+    rotator_process(hMod, inputs, outputs, nInputs, nOutputs, FRAME_SIZE, 1);
+}
+
+const render_module render_rotator = {
+    "rotator", rotator_create, rotator_destroy, render_rotator_setup, render_rotator_process, rotator_getProcessingDelay
+};
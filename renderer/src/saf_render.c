@@ -0,0 +1,292 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     saf_render.c
+ * Description:
+ *     An offline renderer, which streams audio files through a chain of the examples.
+ * Dependencies:
+ *     saf_utilities, afSTFTlib, all examples with audio outputs
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include <string.h>
+#include "saf_render_internal.h"
+#include "saf.h"
+
+#define RENDER_MAX_CHAIN_LENGTH ( 256 )         /* maximum number of characters in a chain */
+#define RENDER_MAX_NUM_THREADS ( 64 )           /* maximum number of worker threads of "saf_render_files" */
+
+/* available modules; indexed by "saf_render_getModuleName" */
+static const render_module* render_modules[] = {
+    &render_ambi_bin,
+    &render_ambi_dec,
+    &render_ambi_drc,
+    &render_ambi_enc,
+    &render_array2sh,
+    &render_binauraliser,
+    &render_mceq,
+    &render_panner,
+    &render_rotator,
+    &render_upmix
+};
+#define RENDER_NUM_MODULES ( (int)(sizeof(render_modules)/sizeof(render_modules[0])) )
+
+/* work shared by the worker threads of "saf_render_files" */
+typedef struct _render_job {
+    const char* chain;
+    const char** inPaths;
+    const char** outPaths;
+    int nFiles;
+    const render_settings* settings;
+    RENDER_ERROR_CODES* errors;
+    volatile int nextFile;                      /* index of the next file to be rendered by any of the workers */
+
+}render_job;
+
+/* splits a chain into its modules; returns the number of modules, or 0 if the chain is not valid */
+static int render_parseChain(const char* chain, const render_module* modules[RENDER_MAX_NUM_MODULES])
+{
+    char buffer[RENDER_MAX_CHAIN_LENGTH];
+    char* name, *next, *end;
+    int i, nModules;
+
+    if(chain==NULL || strlen(chain)>=RENDER_MAX_CHAIN_LENGTH)
+        return 0;
+    strcpy(buffer, chain);
+    nModules = 0;
+    for(name = buffer; name!=NULL; name = next){
+        /* (strtok is avoided, since files may be rendered on several threads) */
+        next = strchr(name, ',');
+        if(next!=NULL)
+            *(next++) = '\0';
+        while(*name==' ')
+            name++;
+        for(end = name+strlen(name); end>name && end[-1]==' '; end--)
+            end[-1] = '\0';
+        if(*name=='\0' && next==NULL && nModules>0)
+            break; /* trailing comma */
+        if(nModules==RENDER_MAX_NUM_MODULES)
+            return 0;
+        for(i=0; i<RENDER_NUM_MODULES; i++)
+            if(!strcmp(name, render_modules[i]->name))
+                break;
+        if(i==RENDER_NUM_MODULES)
+            return 0;
+        modules[nModules++] = render_modules[i];
+    }
+    return nModules;
+}
+
+/* renders the files of a job, until none are left */
+static void render_worker(void* arg)
+{
+    render_job* job = (render_job*)arg;
+    int i;
+
+    while((i = saf_atomic_fetch_addi(&(job->nextFile), 1)) < job->nFiles)
+        job->errors[i] = saf_render_file(job->chain, job->inPaths[i], job->outPaths[i], job->settings);
+}
+
+int render_getOrderFromNumSH(int nSH)
+{
+    int order;
+
+    for(order=0; (order+1)*(order+1)<nSH; order++);
+    return (order+1)*(order+1)==nSH ? order : -1;
+}
+
+void saf_render_getDefaultSettings(render_settings* settings)
+{
+    settings->order = 0;
+    settings->yaw = 0.0f;
+    settings->pitch = 0.0f;
+    settings->roll = 0.0f;
+    settings->compensateDelay = 1;
+    settings->rawSamplerate = 48000;
+    settings->rawNumChannels = 1;
+}
+
+RENDER_ERROR_CODES saf_render_file
+(
+    const char* chain,
+    const char* inPath,
+    const char* outPath,
+    const render_settings* settings
+)
+{
+    const render_module* modules[RENDER_MAX_NUM_MODULES];
+    void* hModules[RENDER_MAX_NUM_MODULES];
+    int nChannels[RENDER_MAX_NUM_MODULES+1];
+    float* inputs[RENDER_MAX_NUM_CHANNELS];
+    float* outputs[RENDER_MAX_NUM_CHANNELS];
+    float** inChunk, **outChunk, **stageFrames[2];
+    render_audiofile in, out;
+    RENDER_ERROR_CODES error;
+    long long delay, nRead, nProduced, chunkStart, first, last;
+    int i, m, ch, frame, nModules, nFramesRead, endOfInput;
+    const int chunkLength = RENDER_NUM_FRAMES_PER_CHUNK*FRAME_SIZE;
+
+    nModules = render_parseChain(chain, modules);
+    if(nModules==0)
+        return RENDER_ERROR_CHAIN;
+    if(render_audiofile_openRead(&in, inPath, settings->rawSamplerate, settings->rawNumChannels))
+        return RENDER_ERROR_INPUT_FILE;
+
+    /* configure the chain; the output channels of each module are the input channels of the next */
+    error = RENDER_OK;
+    delay = 0;
+    nChannels[0] = in.nChannels;
+    for(m=0; m<nModules; m++)
+        hModules[m] = NULL;
+    for(m=0; m<nModules && error==RENDER_OK; m++){
+        modules[m]->create(&hModules[m]);
+        if(nChannels[m]>RENDER_MAX_NUM_CHANNELS)
+            nChannels[m+1] = 0;
+        else
+            nChannels[m+1] = modules[m]->setup(hModules[m], in.samplerate, nChannels[m], settings);
+        if(nChannels[m+1]<1 || nChannels[m+1]>RENDER_MAX_NUM_CHANNELS)
+            error = RENDER_ERROR_CHANNELS;
+        delay += (long long)modules[m]->getProcessingDelay();
+    }
+    if(!settings->compensateDelay)
+        delay = 0;
+    if(error==RENDER_OK && render_audiofile_openWrite(&out, outPath, in.samplerate, nChannels[nModules]))
+        error = RENDER_ERROR_OUTPUT_FILE;
+
+    if(error==RENDER_OK){
+        inChunk = (float**)calloc2d(in.nChannels, chunkLength, sizeof(float));
+        outChunk = (float**)calloc2d(nChannels[nModules], chunkLength, sizeof(float));
+        stageFrames[0] = (float**)calloc2d(RENDER_MAX_NUM_CHANNELS, FRAME_SIZE, sizeof(float));
+        stageFrames[1] = (float**)calloc2d(RENDER_MAX_NUM_CHANNELS, FRAME_SIZE, sizeof(float));
+        nRead = nProduced = 0;
+        endOfInput = 0;
+        while(error==RENDER_OK){
+            /* read the next chunk; once the input is exhausted, zeros are fed to flush out the delayed tail */
+            nFramesRead = endOfInput ? 0 : render_audiofile_read(&in, inChunk, chunkLength);
+            if(nFramesRead<chunkLength){
+                endOfInput = 1;
+                for(ch=0; ch<in.nChannels; ch++)
+                    memset(&inChunk[ch][nFramesRead], 0, (chunkLength-nFramesRead)*sizeof(float));
+            }
+            nRead += (long long)nFramesRead;
+
+            /* process the chunk frame by frame, exactly as in real-time; intermediate signals alternate between two
+             * frame buffers, and the last module writes directly into the output chunk */
+            for(frame=0; frame<RENDER_NUM_FRAMES_PER_CHUNK; frame++){
+                for(ch=0; ch<nChannels[0]; ch++)
+                    inputs[ch] = &inChunk[ch][frame*FRAME_SIZE];
+                for(m=0; m<nModules; m++){
+                    for(ch=0; ch<nChannels[m+1]; ch++)
+                        outputs[ch] = m==nModules-1 ? &outChunk[ch][frame*FRAME_SIZE] : stageFrames[m%2][ch];
+                    modules[m]->process(hModules[m], inputs, outputs, nChannels[m], nChannels[m+1]);
+                    for(ch=0; ch<nChannels[m+1]; ch++)
+                        inputs[ch] = outputs[ch];
+                }
+            }
+
+            /* write the part of the chunk that lies after the processing delay and within the length of the input */
+            chunkStart = nProduced;
+            nProduced += (long long)chunkLength;
+            first = MAX(delay, chunkStart);
+            last = MIN(nProduced, delay+nRead);
+            if(last>first && render_audiofile_write(&out, outChunk, (int)(first-chunkStart), (int)(last-first)))
+                error = RENDER_ERROR_OUTPUT_FILE;
+            if(endOfInput && nProduced>=delay+nRead)
+                break;
+        }
+        free2d((void**)inChunk, in.nChannels);
+        free2d((void**)outChunk, nChannels[nModules]);
+        for(i=0; i<2; i++)
+            free2d((void**)stageFrames[i], RENDER_MAX_NUM_CHANNELS);
+        if(render_audiofile_close(&out) && error==RENDER_OK)
+            error = RENDER_ERROR_OUTPUT_FILE;
+    }
+    render_audiofile_close(&in);
+    for(m=0; m<nModules; m++)
+        if(hModules[m]!=NULL)
+            modules[m]->destroy(&hModules[m]);
+
+    return error;
+}
+
+void saf_render_files
+(
+    const char* chain,
+    const char** inPaths,
+    const char** outPaths,
+    int nFiles,
+    const render_settings* settings,
+    int nThreads,
+    RENDER_ERROR_CODES* errors
+)
+{
+    void* hWorkers[RENDER_MAX_NUM_THREADS];
+    render_job job;
+    int i;
+
+    job.chain = chain;
+    job.inPaths = inPaths;
+    job.outPaths = outPaths;
+    job.nFiles = nFiles;
+    job.settings = settings;
+    job.errors = errors;
+    job.nextFile = 0;
+    nThreads = MIN(MAX(nThreads, 1), MIN(nFiles, RENDER_MAX_NUM_THREADS));
+
+    /* each worker keeps taking the next file that has not yet been started */
+    for(i=0; i<nThreads; i++){
+        saf_worker_create(&hWorkers[i], render_worker, (void*)&job);
+        saf_worker_post(hWorkers[i]);
+    }
+    for(i=0; i<nThreads; i++){
+        saf_worker_wait(hWorkers[i]);
+        saf_worker_destroy(&hWorkers[i]);
+    }
+}
+
+int saf_render_getChainDelay(const char* chain)
+{
+    const render_module* modules[RENDER_MAX_NUM_MODULES];
+    int m, nModules, delay;
+
+    nModules = render_parseChain(chain, modules);
+    if(nModules==0)
+        return -1;
+    delay = 0;
+    for(m=0; m<nModules; m++)
+        delay += modules[m]->getProcessingDelay();
+    return delay;
+}
+
+const char* saf_render_getModuleName(int index)
+{
+    if(index<0 || index>=RENDER_NUM_MODULES)
+        return NULL;
+    return render_modules[index]->name;
+}
+
+const char* saf_render_getErrorString(RENDER_ERROR_CODES error)
+{
+    switch(error){
+        case RENDER_OK:                return "no error";
+        case RENDER_ERROR_CHAIN:       return "the chain is empty, too long, or names an unknown module";
+        case RENDER_ERROR_INPUT_FILE:  return "the input file could not be opened, or its format is not supported";
+        case RENDER_ERROR_OUTPUT_FILE: return "the output file could not be created or written";
+        case RENDER_ERROR_CHANNELS:    return "a module does not support the number of channels fed to it";
+    }
+    return "unknown error";
+}
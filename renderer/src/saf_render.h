@@ -0,0 +1,114 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     saf_render.h (include header)
+ * Description:
+ *     An offline renderer, which streams audio files through a chain of the examples (e.g.
+ *     "ambi_enc,rotator,ambi_bin"). The modules are fed exactly as in real-time, i.e. one
+ *     FRAME_SIZE frame per "_process" call, so the output is identical to that of the
+ *     real-time path; optionally with the processing delay of the chain removed, such that
+ *     the output is aligned with (and has the same length as) the input. The files are
+ *     read and written in chunks of many frames, and independent files may be rendered in
+ *     parallel. Supported file types: WAV and CAF (16/24/32-bit integer or 32/64-bit float
+ *     in, 32-bit float out) and headerless raw 32-bit float.
+ *     The renderer is built in the same way as the benchmark (see benchmark/src/saf_bench.h);
+ *     i.e. together with the framework and all of the examples, plus saf_render_main.c for
+ *     the command-line driver, or renderer/test/saf_render_test.c for a test that the
+ *     processing delays of the modules are compensated correctly.
+ * Dependencies:
+ *     saf_utilities, afSTFTlib, all examples with audio outputs
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#ifndef __SAF_RENDER_H_INCLUDED__
+#define __SAF_RENDER_H_INCLUDED__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RENDER_MAX_NUM_CHANNELS ( 64 )          /* maximum number of channels at any point of a chain */
+#define RENDER_MAX_NUM_MODULES ( 8 )            /* maximum number of modules in a chain */
+#define RENDER_NUM_FRAMES_PER_CHUNK ( 64 )      /* number of FRAME_SIZE frames read/written at once */
+
+typedef enum _RENDER_FILE_TYPES{
+    RENDER_FILE_WAV = 1,                        /* RIFF/WAVE */
+    RENDER_FILE_CAF,                            /* Apple Core Audio Format */
+    RENDER_FILE_RAW                             /* headerless, interleaved 32-bit float, native byte order */
+
+}RENDER_FILE_TYPES;
+
+typedef enum _RENDER_ERROR_CODES{
+    RENDER_OK = 0,                              /* no error */
+    RENDER_ERROR_CHAIN,                         /* the chain is empty, too long, or names an unknown module */
+    RENDER_ERROR_INPUT_FILE,                    /* the input file could not be opened, or its format is not supported */
+    RENDER_ERROR_OUTPUT_FILE,                   /* the output file could not be created or written */
+    RENDER_ERROR_CHANNELS                       /* a module does not support the number of channels fed to it */
+
+}RENDER_ERROR_CODES;
+
+/* rendering settings; the module parameters not listed here keep their defaults */
+typedef struct _render_settings{
+    int order;                                  /* output order of ambi_enc; 0: module default. The input order of
+                                                 * the other Ambisonic modules follows their channel count */
+    float yaw, pitch, roll;                     /* rotation in degrees (rotator and ambi_bin) */
+    int compensateDelay;                        /* 1: remove the processing delay of the chain, 0: keep it */
+    int rawSamplerate;                          /* sample rate of raw input files */
+    int rawNumChannels;                         /* number of channels of raw input files */
+
+}render_settings;
+
+
+/******************/
+/* Main Functions */
+/******************/
+
+/* fills in the default settings (no rotation, delay compensation on, raw input: 48kHz mono) */
+void saf_render_getDefaultSettings(render_settings* settings);   /* & settings */
+
+/* renders one file through a chain of modules, given as a comma separated list of example names (see
+ * "saf_render_getModuleName"). The output file type follows the extension of "outPath" (".wav", ".caf", anything
+ * else: raw); the output has the same sample rate and length as the input */
+RENDER_ERROR_CODES saf_render_file(const char* chain,           /* e.g. "ambi_enc,rotator,ambi_bin" */
+                                   const char* inPath,          /* input file */
+                                   const char* outPath,         /* output file */
+                                   const render_settings* settings); /* rendering settings */
+
+/* renders several independent files through the same chain, using a pool of worker threads */
+void saf_render_files(const char* chain,                        /* e.g. "ambi_enc,rotator,ambi_bin" */
+                      const char** inPaths,                     /* input files; nFiles x 1 */
+                      const char** outPaths,                    /* output files; nFiles x 1 */
+                      int nFiles,                               /* number of files */
+                      const render_settings* settings,          /* rendering settings */
+                      int nThreads,                             /* number of worker threads (<1: one) */
+                      RENDER_ERROR_CODES* errors);              /* result per file; nFiles x 1 */
+
+/* returns the processing delay of a chain in samples; -1 if the chain is not valid */
+int saf_render_getChainDelay(const char* chain);                /* e.g. "ambi_enc,rotator,ambi_bin" */
+
+/* returns the name of the available module with the given index; NULL if the index is out of range */
+const char* saf_render_getModuleName(int index);                /* module index */
+
+/* returns a description of an error code */
+const char* saf_render_getErrorString(RENDER_ERROR_CODES error); /* error code */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SAF_RENDER_H_INCLUDED__ */
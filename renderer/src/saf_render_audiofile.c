@@ -0,0 +1,418 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     saf_render_audiofile.c
+ * Description:
+ *     Streamed reading and writing of WAV, CAF and raw audio files for the offline renderer.
+ *     Only the chunks needed to locate and interpret the samples are parsed; everything else
+ *     is skipped. Files are written as 32-bit float, and their headers are completed on
+ *     closing. The byte order is handled explicitly, so this works on any host.
+ * Dependencies:
+ *     none
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include "saf_render_internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+
+#define CHUNK_NUM_SAMPLES ( RENDER_NUM_FRAMES_PER_CHUNK * FRAME_SIZE )
+
+/* byte order helpers */
+
+static uint32_t af_getU16le(const unsigned char* b) { return (uint32_t)b[0] | ((uint32_t)b[1]<<8); }
+static uint32_t af_getU32le(const unsigned char* b) { return af_getU16le(b) | ((uint32_t)b[2]<<16) | ((uint32_t)b[3]<<24); }
+static uint32_t af_getU32be(const unsigned char* b) { return ((uint32_t)b[0]<<24) | ((uint32_t)b[1]<<16) | ((uint32_t)b[2]<<8) | (uint32_t)b[3]; }
+static uint64_t af_getU64be(const unsigned char* b) { return ((uint64_t)af_getU32be(b)<<32) | (uint64_t)af_getU32be(b+4); }
+
+static void af_putU16le(unsigned char* b, uint32_t v) { b[0] = (unsigned char)v; b[1] = (unsigned char)(v>>8); }
+static void af_putU32le(unsigned char* b, uint32_t v) { af_putU16le(b, v); af_putU16le(b+2, v>>16); }
+static void af_putU32be(unsigned char* b, uint32_t v) { b[0] = (unsigned char)(v>>24); b[1] = (unsigned char)(v>>16); b[2] = (unsigned char)(v>>8); b[3] = (unsigned char)v; }
+static void af_putU64be(unsigned char* b, uint64_t v) { af_putU32be(b, (uint32_t)(v>>32)); af_putU32be(b+4, (uint32_t)v); }
+
+/* decodes one sample */
+static float af_decodeSample(const unsigned char* b, RENDER_SAMPLE_FORMATS format, int bigEndian)
+{
+    unsigned char s[8];
+    int i, n;
+    uint32_t u;
+    uint64_t u64;
+    float f;
+    double d;
+
+    /* to little-endian */
+    n = format==RENDER_SAMPLE_INT16 ? 2 : format==RENDER_SAMPLE_INT24 ? 3 : format==RENDER_SAMPLE_FLOAT64 ? 8 : 4;
+    for(i=0; i<n; i++)
+        s[i] = bigEndian ? b[n-1-i] : b[i];
+    switch(format){
+        case RENDER_SAMPLE_INT16:
+            return (float)(int16_t)af_getU16le(s) / 32768.0f;
+        case RENDER_SAMPLE_INT24:
+            u = (uint32_t)s[0]<<8 | (uint32_t)s[1]<<16 | (uint32_t)s[2]<<24;
+            return (float)((int32_t)u>>8) / 8388608.0f;
+        case RENDER_SAMPLE_INT32:
+            return (float)((double)(int32_t)af_getU32le(s) / 2147483648.0);
+        case RENDER_SAMPLE_FLOAT32:
+            u = af_getU32le(s);
+            memcpy(&f, &u, 4);
+            return f;
+        case RENDER_SAMPLE_FLOAT64:
+            u64 = (uint64_t)af_getU32le(s) | ((uint64_t)af_getU32le(s+4)<<32);
+            memcpy(&d, &u64, 8);
+            return (float)d;
+    }
+    return 0.0f;
+}
+
+static int af_read(FILE* fid, unsigned char* b, size_t n)
+{
+    return fread(b, 1, n, fid) == n ? 0 : 1;
+}
+
+/* skips "n" bytes of the file */
+static int af_skip(FILE* fid, uint64_t n)
+{
+    while(n>0){
+        long step = n > 0x40000000 ? 0x40000000 : (long)n;
+        if(fseek(fid, step, SEEK_CUR)!=0)
+            return 1;
+        n -= (uint64_t)step;
+    }
+    return 0;
+}
+
+static int af_setFormat(render_audiofile* af, int isFloat, int bitsPerSample)
+{
+    if(isFloat && bitsPerSample==32)      af->format = RENDER_SAMPLE_FLOAT32;
+    else if(isFloat && bitsPerSample==64) af->format = RENDER_SAMPLE_FLOAT64;
+    else if(!isFloat && bitsPerSample==16) af->format = RENDER_SAMPLE_INT16;
+    else if(!isFloat && bitsPerSample==24) af->format = RENDER_SAMPLE_INT24;
+    else if(!isFloat && bitsPerSample==32) af->format = RENDER_SAMPLE_INT32;
+    else return 1;
+    af->bytesPerSample = bitsPerSample/8;
+    return 0;
+}
+
+static int af_parseWav(render_audiofile* af)
+{
+    unsigned char b[40];
+    uint32_t size, tag;
+    int haveFmt;
+
+    if(af_read(af->fid, b, 12) || memcmp(b, "RIFF", 4) || memcmp(b+8, "WAVE", 4))
+        return 1;
+    haveFmt = 0;
+    while(!af_read(af->fid, b, 8)){
+        size = af_getU32le(b+4);
+        if(!memcmp(b, "fmt ", 4)){
+            if(size<16 || af_read(af->fid, b, size<40 ? size : 40))
+                return 1;
+            tag = af_getU16le(b);
+            if(tag==0xFFFE && size>=26) /* WAVE_FORMAT_EXTENSIBLE: the format tag leads the sub-format GUID */
+                tag = af_getU16le(b+24);
+            if(tag!=1 && tag!=3)
+                return 1;
+            af->nChannels = (int)af_getU16le(b+2);
+            af->samplerate = (int)af_getU32le(b+4);
+            if(af_setFormat(af, tag==3, (int)af_getU16le(b+14)))
+                return 1;
+            if(size>40 && af_skip(af->fid, size-40))
+                return 1;
+            haveFmt = 1;
+        }
+        else if(!memcmp(b, "data", 4)){
+            if(!haveFmt)
+                return 1;
+            af->nFramesLeft = (long long)(size/(uint32_t)(af->nChannels*af->bytesPerSample));
+            return 0;
+        }
+        else if(af_skip(af->fid, (uint64_t)size + (size&1)))
+            return 1;
+    }
+    return 1;
+}
+
+static int af_parseCaf(render_audiofile* af)
+{
+    unsigned char b[32];
+    uint64_t size, fs_bits, bitsPerChannel, flags;
+    double fs;
+    int haveDesc;
+
+    if(af_read(af->fid, b, 8) || memcmp(b, "caff", 4))
+        return 1;
+    haveDesc = 0;
+    while(!af_read(af->fid, b, 12)){
+        size = af_getU64be(b+4);
+        if(!memcmp(b, "desc", 4)){
+            if(size<32 || af_read(af->fid, b, 32))
+                return 1;
+            fs_bits = af_getU64be(b);
+            memcpy(&fs, &fs_bits, 8);
+            if(memcmp(b+8, "lpcm", 4))
+                return 1;
+            flags = af_getU32be(b+12);
+            af->nChannels = (int)af_getU32be(b+24);
+            bitsPerChannel = af_getU32be(b+28);
+            af->samplerate = (int)(fs+0.5);
+            af->bigEndian = (flags & 2) ? 0 : 1;
+            if(af_setFormat(af, (int)(flags & 1), (int)bitsPerChannel) || af_skip(af->fid, size-32))
+                return 1;
+            haveDesc = 1;
+        }
+        else if(!memcmp(b, "data", 4)){
+            if(!haveDesc || af_read(af->fid, b, 4)) /* (edit count) */
+                return 1;
+            if(size==(uint64_t)-1)
+                af->nFramesLeft = -1;
+            else
+                af->nFramesLeft = (long long)((size-4)/(uint64_t)(af->nChannels*af->bytesPerSample));
+            return 0;
+        }
+        else if(af_skip(af->fid, size))
+            return 1;
+    }
+    return 1;
+}
+
+RENDER_FILE_TYPES render_audiofile_getTypeFromPath(const char* path)
+{
+    const char* ext;
+    char lower[5];
+    int i;
+
+    ext = strrchr(path, '.');
+    if(ext==NULL || strlen(ext)!=4)
+        return RENDER_FILE_RAW;
+    for(i=0; i<5; i++)
+        lower[i] = (char)tolower((unsigned char)ext[i]);
+    if(!strcmp(lower, ".wav"))
+        return RENDER_FILE_WAV;
+    if(!strcmp(lower, ".caf"))
+        return RENDER_FILE_CAF;
+    return RENDER_FILE_RAW;
+}
+
+int render_audiofile_openRead
+(
+    render_audiofile* af,
+    const char* path,
+    int rawSamplerate,
+    int rawNumChannels
+)
+{
+    int failed;
+
+    memset(af, 0, sizeof(render_audiofile));
+    af->type = render_audiofile_getTypeFromPath(path);
+    af->fid = fopen(path, "rb");
+    if(af->fid==NULL)
+        return 1;
+    switch(af->type){
+        case RENDER_FILE_WAV: failed = af_parseWav(af); break;
+        case RENDER_FILE_CAF: failed = af_parseCaf(af); break;
+        default:
+        case RENDER_FILE_RAW:
+            af->nChannels = rawNumChannels;
+            af->samplerate = rawSamplerate;
+            af->nFramesLeft = -1;
+            failed = af_setFormat(af, 1, 32);
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+            af->bigEndian = 1;
+#endif
+            break;
+    }
+    if(!failed && (af->nChannels<1 || af->nChannels>RENDER_MAX_NUM_CHANNELS || af->samplerate<1))
+        failed = 1;
+    if(!failed){
+        af->buffer = (unsigned char*)malloc((size_t)CHUNK_NUM_SAMPLES * af->nChannels * af->bytesPerSample);
+        failed = af->buffer==NULL;
+    }
+    if(failed){
+        fclose(af->fid);
+        af->fid = NULL;
+        return 1;
+    }
+    return 0;
+}
+
+int render_audiofile_openWrite
+(
+    render_audiofile* af,
+    const char* path,
+    int samplerate,
+    int nChannels
+)
+{
+    unsigned char b[80];
+    uint64_t fs_bits;
+    double fs;
+    size_t n;
+
+    memset(af, 0, sizeof(render_audiofile));
+    af->type = render_audiofile_getTypeFromPath(path);
+    af->format = RENDER_SAMPLE_FLOAT32;
+    af->bytesPerSample = 4;
+    af->nChannels = nChannels;
+    af->samplerate = samplerate;
+    af->fid = fopen(path, "wb");
+    if(af->fid==NULL)
+        return 1;
+
+    /* header, with the sizes filled in on closing */
+    n = 0;
+    switch(af->type){
+        case RENDER_FILE_WAV:
+            memcpy(b, "RIFF", 4); af_putU32le(b+4, 0); memcpy(b+8, "WAVE", 4);
+            memcpy(b+12, "fmt ", 4); af_putU32le(b+16, 18);
+            af_putU16le(b+20, 3); /* WAVE_FORMAT_IEEE_FLOAT */
+            af_putU16le(b+22, (uint32_t)nChannels);
+            af_putU32le(b+24, (uint32_t)samplerate);
+            af_putU32le(b+28, (uint32_t)(samplerate*nChannels*4));
+            af_putU16le(b+32, (uint32_t)(nChannels*4));
+            af_putU16le(b+34, 32);
+            af_putU16le(b+36, 0);
+            memcpy(b+38, "fact", 4); af_putU32le(b+42, 4); af_putU32le(b+46, 0);
+            memcpy(b+50, "data", 4); af_putU32le(b+54, 0);
+            af->sizeFieldPos[0] = 4;
+            af->sizeFieldPos[1] = 46;
+            af->sizeFieldPos[2] = 54;
+            n = 58;
+            break;
+        case RENDER_FILE_CAF:
+            memcpy(b, "caff", 4); b[4] = 0; b[5] = 1; b[6] = b[7] = 0; /* version 1, flags 0 */
+            memcpy(b+8, "desc", 4); af_putU64be(b+12, 32);
+            fs = (double)samplerate;
+            memcpy(&fs_bits, &fs, 8);
+            af_putU64be(b+20, fs_bits);
+            memcpy(b+28, "lpcm", 4);
+            af_putU32be(b+32, 1 | 2); /* float, little-endian */
+            af_putU32be(b+36, (uint32_t)(nChannels*4));
+            af_putU32be(b+40, 1);
+            af_putU32be(b+44, (uint32_t)nChannels);
+            af_putU32be(b+48, 32);
+            memcpy(b+52, "data", 4); af_putU64be(b+56, (uint64_t)-1);
+            af_putU32be(b+64, 0); /* edit count */
+            af->sizeFieldPos[0] = 56;
+            n = 68;
+            break;
+        default:
+        case RENDER_FILE_RAW:
+            break;
+    }
+    af->buffer = (unsigned char*)malloc((size_t)CHUNK_NUM_SAMPLES * nChannels * 4);
+    if(af->buffer==NULL || (n>0 && fwrite(b, 1, n, af->fid)!=n)){
+        free(af->buffer);
+        fclose(af->fid);
+        af->fid = NULL;
+        return 1;
+    }
+    return 0;
+}
+
+int render_audiofile_read
+(
+    render_audiofile* af,
+    float** data,
+    int nFrames
+)
+{
+    int i, ch, nRead;
+    const unsigned char* b;
+
+    if(af->nFramesLeft>=0 && (long long)nFrames > af->nFramesLeft)
+        nFrames = (int)af->nFramesLeft;
+    if(nFrames<=0)
+        return 0;
+    nRead = (int)(fread(af->buffer, (size_t)(af->nChannels*af->bytesPerSample), (size_t)nFrames, af->fid));
+    if(af->nFramesLeft>=0)
+        af->nFramesLeft -= nRead;
+    b = af->buffer;
+    for(i=0; i<nRead; i++)
+        for(ch=0; ch<af->nChannels; ch++, b+=af->bytesPerSample)
+            data[ch][i] = af_decodeSample(b, af->format, af->bigEndian);
+    return nRead;
+}
+
+int render_audiofile_write
+(
+    render_audiofile* af,
+    float** data,
+    int offset,
+    int nFrames
+)
+{
+    int i, ch;
+    uint32_t u;
+    unsigned char* b;
+
+    if(nFrames<=0)
+        return 0;
+    b = af->buffer;
+    for(i=offset; i<offset+nFrames; i++){
+        for(ch=0; ch<af->nChannels; ch++, b+=4){
+            if(af->type==RENDER_FILE_RAW)
+                memcpy(b, &(data[ch][i]), 4); /* native byte order */
+            else{
+                memcpy(&u, &(data[ch][i]), 4);
+                af_putU32le(b, u);
+            }
+        }
+    }
+    if(fwrite(af->buffer, (size_t)(af->nChannels*4), (size_t)nFrames, af->fid)!=(size_t)nFrames)
+        return 1;
+    af->nFramesWritten += nFrames;
+    return 0;
+}
+
+int render_audiofile_close(render_audiofile* af)
+{
+    unsigned char b[8];
+    uint64_t nBytes;
+    int failed;
+
+    if(af->fid==NULL)
+        return 1;
+    failed = 0;
+    nBytes = (uint64_t)af->nFramesWritten * (uint64_t)(af->nChannels*4);
+    if(af->sizeFieldPos[0]>0){
+        switch(af->type){
+            case RENDER_FILE_WAV:
+                failed = nBytes > 0xFFFFFFFFu - 58; /* too large for RIFF */
+                af_putU32le(b, (uint32_t)(nBytes + 50));
+                failed |= fseek(af->fid, af->sizeFieldPos[0], SEEK_SET)!=0 || fwrite(b, 1, 4, af->fid)!=4;
+                af_putU32le(b, (uint32_t)af->nFramesWritten);
+                failed |= fseek(af->fid, af->sizeFieldPos[1], SEEK_SET)!=0 || fwrite(b, 1, 4, af->fid)!=4;
+                af_putU32le(b, (uint32_t)nBytes);
+                failed |= fseek(af->fid, af->sizeFieldPos[2], SEEK_SET)!=0 || fwrite(b, 1, 4, af->fid)!=4;
+                break;
+            case RENDER_FILE_CAF:
+                af_putU64be(b, nBytes + 4);
+                failed |= fseek(af->fid, af->sizeFieldPos[0], SEEK_SET)!=0 || fwrite(b, 1, 8, af->fid)!=8;
+                break;
+            default:
+                break;
+        }
+    }
+    failed |= fclose(af->fid)!=0;
+    af->fid = NULL;
+    free(af->buffer);
+    af->buffer = NULL;
+    return failed;
+}
@@ -0,0 +1,134 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     saf_render_internal.h
+ * Description:
+ *     An offline renderer, which streams audio files through a chain of the examples.
+ *     Internal module interface and audio file reading/writing.
+ * Dependencies:
+ *     saf_utilities, afSTFTlib, all examples with audio outputs
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#ifndef __SAF_RENDER_INTERNAL_H_INCLUDED__
+#define __SAF_RENDER_INTERNAL_H_INCLUDED__
+
+#include <stdio.h>
+#include "saf_render.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************/
+/* Module interface */
+/********************/
+
+#define RENDER_MAX_SH_ORDER ( SH_ORDER < 7 ? SH_ORDER : 7 ) /* highest order supported by all Ambisonic modules */
+
+/* one example, as seen by the renderer (render_<name>.c) */
+typedef struct _render_module {
+    const char* name;                                           /* example name */
+    void (*create)(void** const phMod);                         /* the example's "_create" */
+    void (*destroy)(void** const phMod);                        /* the example's "_destroy" */
+    /* initialises and configures an instance; returns the number of output channels, or 0 if "nInputs" is not
+     * supported. Any initialisation that the example defers to another thread must be complete on return */
+    int (*setup)(void* hMod, int samplerate, int nInputs, const render_settings* settings);
+    /* processes one frame of FRAME_SIZE samples (with isPlaying=1) */
+    void (*process)(void* hMod, float** inputs, float** outputs, int nInputs, int nOutputs);
+    int (*getProcessingDelay)(void);                            /* the example's "_getProcessingDelay" */
+
+}render_module;
+
+extern const render_module render_ambi_bin;
+extern const render_module render_ambi_dec;
+extern const render_module render_ambi_drc;
+extern const render_module render_ambi_enc;
+extern const render_module render_array2sh;
+extern const render_module render_binauraliser;
+extern const render_module render_mceq;
+extern const render_module render_panner;
+extern const render_module render_rotator;
+extern const render_module render_upmix;
+
+/* returns the order of "nSH" spherical harmonic signals; -1 if "nSH" is not (order+1)^2 */
+int render_getOrderFromNumSH(int nSH);
+
+
+/**************/
+/* Audio file */
+/**************/
+
+typedef enum _RENDER_SAMPLE_FORMATS{
+    RENDER_SAMPLE_INT16 = 1,
+    RENDER_SAMPLE_INT24,
+    RENDER_SAMPLE_INT32,
+    RENDER_SAMPLE_FLOAT32,
+    RENDER_SAMPLE_FLOAT64
+
+}RENDER_SAMPLE_FORMATS;
+
+typedef struct _render_audiofile {
+    FILE* fid;
+    RENDER_FILE_TYPES type;
+    RENDER_SAMPLE_FORMATS format;
+    int bigEndian;                              /* 1: samples are stored big-endian */
+    int bytesPerSample;
+    int nChannels;
+    int samplerate;
+    long long nFramesLeft;                      /* reading: frames left in the data chunk (-1: until end of file) */
+    long long nFramesWritten;                   /* writing: frames written so far */
+    long sizeFieldPos[3];                       /* writing: header positions of the size fields patched on closing */
+    unsigned char* buffer;                      /* interleaved samples of one chunk */
+
+}render_audiofile;
+
+/* returns the file type implied by the extension of a path */
+RENDER_FILE_TYPES render_audiofile_getTypeFromPath(const char* path);
+
+/* opens an audio file for reading; returns 0 on success */
+int render_audiofile_openRead(render_audiofile* af,             /* & audio file */
+                              const char* path,                 /* file path */
+                              int rawSamplerate,                /* sample rate, if it is a raw file */
+                              int rawNumChannels);              /* number of channels, if it is a raw file */
+
+/* creates an audio file (32-bit float) for writing; returns 0 on success */
+int render_audiofile_openWrite(render_audiofile* af,            /* & audio file */
+                               const char* path,                /* file path */
+                               int samplerate,                  /* sample rate */
+                               int nChannels);                  /* number of channels */
+
+/* reads up to "nFrames" frames; returns the number of frames read (fewer at the end of the file) */
+int render_audiofile_read(render_audiofile* af,                 /* audio file */
+                          float** data,                         /* deinterleaved samples; nChannels x nFrames */
+                          int nFrames);                         /* number of frames (<= the chunk size) */
+
+/* writes "nFrames" frames; returns 0 on success */
+int render_audiofile_write(render_audiofile* af,                /* audio file */
+                           float** data,                        /* deinterleaved samples; nChannels x nFrames */
+                           int offset,                          /* index of the first frame in "data" to write */
+                           int nFrames);                        /* number of frames (<= the chunk size) */
+
+/* completes the header (if writing) and closes the file; returns 0 on success */
+int render_audiofile_close(render_audiofile* af);               /* audio file */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SAF_RENDER_INTERNAL_H_INCLUDED__ */
@@ -0,0 +1,115 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     saf_render_main.c
+ * Description:
+ *     Command-line driver of the offline renderer, e.g.:
+ *         saf_render -chain ambi_enc,rotator,ambi_bin -order 3 -yaw 90 -threads 4 \
+ *                    in1.wav out1.wav in2.caf out2.caf
+ * Dependencies:
+ *     saf_render
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "saf_render.h"
+
+static void saf_render_printUsage(const char* name)
+{
+    int i;
+
+    fprintf(stderr, "usage: %s -chain <module>[,<module>...] [-order <order>] [-yaw <deg>] [-pitch <deg>] [-roll <deg>]\n"
+                    "       [-nodelaycomp] [-rawrate <samplerate>] [-rawch <nChannels>] [-threads <nThreads>]\n"
+                    "       <input> <output> [<input> <output> ...]\n"
+                    "modules:", name);
+    for(i=0; saf_render_getModuleName(i)!=NULL; i++)
+        fprintf(stderr, " %s", saf_render_getModuleName(i));
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char** argv)
+{
+    render_settings settings;
+    RENDER_ERROR_CODES* errors;
+    const char** inPaths, **outPaths;
+    const char* chain;
+    int i, nFiles, nThreads, nFailed;
+
+    /* options */
+    saf_render_getDefaultSettings(&settings);
+    chain = NULL;
+    nThreads = 1;
+    for(i=1; i<argc && argv[i][0]=='-'; i+=2){
+        if(strcmp(argv[i], "-nodelaycomp")==0){
+            settings.compensateDelay = 0;
+            i--;
+        }
+        else if(i==argc-1)
+            break;
+        else if(strcmp(argv[i], "-chain")==0)
+            chain = argv[i+1];
+        else if(strcmp(argv[i], "-order")==0)
+            settings.order = atoi(argv[i+1]);
+        else if(strcmp(argv[i], "-yaw")==0)
+            settings.yaw = (float)atof(argv[i+1]);
+        else if(strcmp(argv[i], "-pitch")==0)
+            settings.pitch = (float)atof(argv[i+1]);
+        else if(strcmp(argv[i], "-roll")==0)
+            settings.roll = (float)atof(argv[i+1]);
+        else if(strcmp(argv[i], "-rawrate")==0)
+            settings.rawSamplerate = atoi(argv[i+1]);
+        else if(strcmp(argv[i], "-rawch")==0)
+            settings.rawNumChannels = atoi(argv[i+1]);
+        else if(strcmp(argv[i], "-threads")==0)
+            nThreads = atoi(argv[i+1]);
+        else
+            break;
+    }
+    nFiles = (argc-i)/2;
+    if(chain==NULL || nFiles<1 || (argc-i)%2!=0 || argv[i][0]=='-'){
+        saf_render_printUsage(argv[0]);
+        return 1;
+    }
+    if(saf_render_getChainDelay(chain)<0){
+        fprintf(stderr, "%s: %s\n", chain, saf_render_getErrorString(RENDER_ERROR_CHAIN));
+        return 1;
+    }
+
+    /* render */
+    inPaths = (const char**)malloc(nFiles*sizeof(const char*));
+    outPaths = (const char**)malloc(nFiles*sizeof(const char*));
+    errors = (RENDER_ERROR_CODES*)malloc(nFiles*sizeof(RENDER_ERROR_CODES));
+    for(i=0; i<nFiles; i++){
+        inPaths[i] = argv[argc-2*nFiles+2*i];
+        outPaths[i] = argv[argc-2*nFiles+2*i+1];
+    }
+    saf_render_files(chain, inPaths, outPaths, nFiles, &settings, nThreads, errors);
+    nFailed = 0;
+    for(i=0; i<nFiles; i++){
+        if(errors[i]!=RENDER_OK){
+            fprintf(stderr, "%s -> %s: %s\n", inPaths[i], outPaths[i], saf_render_getErrorString(errors[i]));
+            nFailed++;
+        }
+    }
+    free(inPaths);
+    free(outPaths);
+    free(errors);
+
+    return nFailed>0 ? 1 : 0;
+}
@@ -0,0 +1,168 @@
+/*
+ Copyright 2026 Spatial_Audio_Framework contributors
+
+ Permission to use, copy, modify, and/or distribute this software for any purpose with or
+ without fee is hereby granted, provided that the above copyright notice and this permission
+ notice appear in all copies.
+
+ THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO
+ THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT
+ SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR
+ ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE
+ OR PERFORMANCE OF THIS SOFTWARE.
+*/
+/*
+ * Filename:
+ *     saf_hrir_convert.c
+ * Description:
+ *     Converts the default HRIR data file from its old double-precision format (the symbols
+ *     "__default_hrirs" and "__default_hrir_dirs_deg") into the format declared in saf_hrir.h.
+ *     The tool is linked against the old data file, and writes a new "saf_default_hrirs.c",
+ *     which holds both a single-precision and an IEEE 754 half-precision copy of the HRIRs
+ *     (the latter selected by defining SAF_DEFAULT_HRIRS_FP16 when building the framework):
+ *         cc -O2 tools/src/saf_hrir_convert.c old/saf_default_hrirs.c -o saf_hrir_convert
+ *         ./saf_hrir_convert framework/saf_hrir/saf_default_hrirs.c
+ *     Half-precision values are rounded to nearest (ties to even); values beyond the
+ *     half-precision range are reported, and saturate to infinity.
+ * Dependencies:
+ *     none (only the old default HRIR data file)
+ * Author, date created:
+ *     Spatial_Audio_Framework contributors, 18.10.2026
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define N_HRIR_DIRS ( 217 )
+#define HRIR_LEN ( 1024 )
+#define NUM_EARS ( 2 )
+#define VALUES_PER_LINE ( 8 )
+
+/* old (double-precision) declarations of the default HRIR set */
+extern const double __default_hrirs[N_HRIR_DIRS][NUM_EARS][HRIR_LEN];
+extern const double __default_hrir_dirs_deg[N_HRIR_DIRS][2];
+extern const int __default_N_hrir_dirs;
+extern const int __default_hrir_len;
+extern const int __default_hrir_fs;
+
+/* converts a float to IEEE 754 half-precision, rounding to nearest (ties to even) */
+static unsigned short float2half(float x, int* overflow)
+{
+    unsigned int bits, sign, expo, mant, half, shift, rem, halfway;
+
+    memcpy(&bits, &x, sizeof(float));
+    sign = (bits >> 16) & 0x8000;
+    expo = (bits >> 23) & 0xFF;
+    mant = bits & 0x7FFFFF;
+    if(expo == 0xFF)                             /* inf/NaN */
+        return (unsigned short)(sign | 0x7C00 | (mant ? 0x200 : 0));
+    if(expo < 102)                               /* below half of the smallest subnormal */
+        return (unsigned short)sign;
+    if(expo < 113){                              /* subnormal */
+        mant |= 0x800000;
+        shift = 126 - expo;
+        half = mant >> shift;
+        rem = mant & ((1u << shift) - 1);
+        halfway = 1u << (shift - 1);
+        if(rem > halfway || (rem == halfway && (half & 1)))
+            half++;
+        return (unsigned short)(sign | half);
+    }
+    half = ((expo - 112) << 10) | (mant >> 13);  /* normal; a carry out of the mantissa rounds up the exponent */
+    rem = mant & 0x1FFF;
+    if(rem > 0x1000 || (rem == 0x1000 && (half & 1)))
+        half++;
+    if(half >= 0x7C00){
+        (*overflow)++;
+        half = 0x7C00;
+    }
+    return (unsigned short)(sign | half);
+}
+
+static void writeFloat(FILE* file, double x, int isLast, int* col)
+{
+    fprintf(file, "%.9ef%s", (float)x, isLast ? "" : ",");
+    if(!isLast)
+        fprintf(file, "%s", ++(*col) % VALUES_PER_LINE == 0 ? "\n" : " ");
+}
+
+int main(int argc, char** argv)
+{
+    FILE* file;
+    int i, j, k, col, overflow;
+
+    if(argc != 2){
+        fprintf(stderr, "usage: %s <output saf_default_hrirs.c>\n", argv[0]);
+        return 1;
+    }
+    if(__default_N_hrir_dirs != N_HRIR_DIRS || __default_hrir_len != HRIR_LEN){
+        fprintf(stderr, "error: expected %d x %d x %d HRIRs, but the data file has %d x %d x %d\n",
+                N_HRIR_DIRS, NUM_EARS, HRIR_LEN, __default_N_hrir_dirs, NUM_EARS, __default_hrir_len);
+        return 1;
+    }
+    file = fopen(argv[1], "w");
+    if(file == NULL){
+        fprintf(stderr, "error: could not open %s for writing\n", argv[1]);
+        return 1;
+    }
+
+    fprintf(file, "/*\n"
+                  " * Default HRIR set of the Spatial_Audio_Framework; see saf_hrir.h.\n"
+                  " * Generated by tools/src/saf_hrir_convert.c from the double-precision data; do not edit.\n"
+                  " */\n\n"
+                  "#include \"saf_hrir.h\"\n\n");
+    fprintf(file, "const int __default_N_hrir_dirs = %d;\n", __default_N_hrir_dirs);
+    fprintf(file, "const int __default_hrir_len = %d;\n", __default_hrir_len);
+    fprintf(file, "const int __default_hrir_fs = %d;\n\n", __default_hrir_fs);
+
+    /* directions */
+    fprintf(file, "const float __default_hrir_dirs_deg_f32[%d][2] = {\n", N_HRIR_DIRS);
+    for(i=0; i<N_HRIR_DIRS; i++)
+        fprintf(file, "{%.9ef, %.9ef}%s\n", (float)__default_hrir_dirs_deg[i][0], (float)__default_hrir_dirs_deg[i][1],
+                i<N_HRIR_DIRS-1 ? "," : "");
+    fprintf(file, "};\n\n");
+
+    /* HRIRs, in half-precision */
+    overflow = 0;
+    fprintf(file, "#ifdef SAF_DEFAULT_HRIRS_FP16\n");
+    fprintf(file, "const unsigned short __default_hrirs_fp16[%d][%d][%d] = {\n", N_HRIR_DIRS, NUM_EARS, HRIR_LEN);
+    for(i=0; i<N_HRIR_DIRS; i++){
+        fprintf(file, "{");
+        for(j=0; j<NUM_EARS; j++){
+            fprintf(file, "{\n");
+            for(k=0; k<HRIR_LEN; k++)
+                fprintf(file, "0x%04x%s", float2half((float)__default_hrirs[i][j][k], &overflow),
+                        k==HRIR_LEN-1 ? "" : ((k+1) % (2*VALUES_PER_LINE) == 0 ? ",\n" : ", "));
+            fprintf(file, "}%s", j<NUM_EARS-1 ? ",\n" : "");
+        }
+        fprintf(file, "}%s\n", i<N_HRIR_DIRS-1 ? "," : "");
+    }
+    fprintf(file, "};\n");
+
+    /* HRIRs, in single-precision */
+    fprintf(file, "#else\n");
+    fprintf(file, "const float __default_hrirs_f32[%d][%d][%d] = {\n", N_HRIR_DIRS, NUM_EARS, HRIR_LEN);
+    for(i=0; i<N_HRIR_DIRS; i++){
+        fprintf(file, "{");
+        for(j=0; j<NUM_EARS; j++){
+            fprintf(file, "{\n");
+            col = 0;
+            for(k=0; k<HRIR_LEN; k++)
+                writeFloat(file, __default_hrirs[i][j][k], k==HRIR_LEN-1, &col);
+            fprintf(file, "}%s", j<NUM_EARS-1 ? ",\n" : "");
+        }
+        fprintf(file, "}%s\n", i<N_HRIR_DIRS-1 ? "," : "");
+    }
+    fprintf(file, "};\n");
+    fprintf(file, "#endif\n");
+
+    if(fclose(file) != 0){
+        fprintf(stderr, "error: could not write %s\n", argv[1]);
+        return 1;
+    }
+    if(overflow > 0)
+        fprintf(stderr, "warning: %d HRIR samples exceed the half-precision range\n", overflow);
+    return 0;
+}